@@ -23,81 +23,149 @@ using namespace Microsoft::IndirectDisp;
 using namespace Microsoft::WRL;
 
 
-#pragma region SampleMonitors
+#pragma region VirtualMonitor
 
-static constexpr DWORD IDD_SAMPLE_MONITOR_COUNT = 1; // If monitor count > ARRAYSIZE(s_SampleMonitors), we create edid-less monitors
+static constexpr DWORD IDD_SAMPLE_MONITOR_COUNT = 1; // The one wide monitor rj_span spans over the physical panels
 
-// Default modes reported for edid-less monitors. The first mode is set as preferred
-static const struct IndirectSampleMonitor::SampleMonitorMode s_SampleDefaultModes[] = 
-{
-    { 7680, 1440, 120 },
-};
+// rj_span writes the config derived from the physical monitors here (see virtual_display.h).
+// It is read when the adapter initializes, so a change applies after the device restarts.
+static constexpr WCHAR VIRTUAL_DISPLAY_REG_KEY[] = L"SOFTWARE\\RjSpan\\VirtualDisplay";
+static constexpr WCHAR VIRTUAL_DISPLAY_REG_VALUE[] = L"Config";
+
+static VirtualMonitorDescription s_VirtualMonitor;
 
-// FOR SAMPLE PURPOSES ONLY, Static info about monitors that will be reported to OS
-static const struct IndirectSampleMonitor s_SampleMonitors[] =
+static bool ReadVirtualDisplayConfig(rj::VirtualDisplayConfig& Config)
 {
-    // Modified EDID from Dell S2719DGF
+    WCHAR Text[128] = {};
+    DWORD Size = sizeof(Text);
+    if (RegGetValueW(HKEY_LOCAL_MACHINE, VIRTUAL_DISPLAY_REG_KEY, VIRTUAL_DISPLAY_REG_VALUE, RRF_RT_REG_SZ, nullptr, Text, &Size) != ERROR_SUCCESS)
     {
+        return false;
+    }
+
+    // The config is plain ASCII ("3x2560x1440@144,120,60")
+    string Narrow;
+    for (const WCHAR* p = Text; *p; p++)
+    {
+        if (*p > 0x7F)
         {
-            0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,0x10,0xAC,0xE6,0xD0,0x55,0x5A,0x4A,0x30,0x24,0x1D,0x01,
-            0x04,0xA5,0x3C,0x22,0x78,0xFB,0x6C,0xE5,0xA5,0x55,0x50,0xA0,0x23,0x0B,0x50,0x54,0x00,0x02,0x00,
-            0xD1,0xC0,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x58,0xE3,0x00,
-            0xA0,0xA0,0xA0,0x29,0x50,0x30,0x20,0x35,0x00,0x55,0x50,0x21,0x00,0x00,0x1A,0x00,0x00,0x00,0xFF,
-            0x00,0x37,0x4A,0x51,0x58,0x42,0x59,0x32,0x0A,0x20,0x20,0x20,0x20,0x20,0x00,0x00,0x00,0xFC,0x00,
-            0x53,0x32,0x37,0x31,0x39,0x44,0x47,0x46,0x0A,0x20,0x20,0x20,0x20,0x00,0x00,0x00,0xFD,0x00,0x28,
-            0x9B,0xFA,0xFA,0x40,0x01,0x0A,0x20,0x20,0x20,0x20,0x20,0x20,0x00,0x2C
-        },
-        {
-            { 7680, 1440, 120 },
-        },
-        0
-    },
-};
+            return false;
+        }
+        Narrow.push_back(static_cast<char>(*p));
+    }
+    return rj::ParseVirtualDisplayConfig(Narrow, Config);
+}
+
+static void LoadVirtualMonitor()
+{
+    VirtualMonitorDescription Monitor;
+    if (!ReadVirtualDisplayConfig(Monitor.Config) || rj::BuildVirtualDisplayModes(Monitor.Config).empty())
+    {
+        Monitor.Config = rj::VirtualDisplayConfig{};
+    }
+
+    Monitor.Modes = rj::BuildVirtualDisplayModes(Monitor.Config);
+    Monitor.Edid = rj::BuildVirtualDisplayEdid(Monitor.Config);
+    s_VirtualMonitor = move(Monitor);
+}
 
 #pragma endregion
 
 #pragma region helpers
 
-static inline void FillSignalInfo(DISPLAYCONFIG_VIDEO_SIGNAL_INFO& Mode, DWORD Width, DWORD Height, DWORD VSync, bool bMonitorMode)
+static inline void FillSignalInfo(DISPLAYCONFIG_VIDEO_SIGNAL_INFO& Mode, const rj::DisplayTiming& Timing, bool bMonitorMode)
 {
-    Mode.totalSize.cx = Mode.activeSize.cx = Width;
-    Mode.totalSize.cy = Mode.activeSize.cy = Height;
+    // Active size plus the CVT-RB blanking, so the pixel rate and line rate are what a real
+    // link carries rather than active pixels x refresh
+    Mode.activeSize.cx = Timing.hActive;
+    Mode.activeSize.cy = Timing.vActive;
+    Mode.totalSize.cx = Timing.HTotal();
+    Mode.totalSize.cy = Timing.VTotal();
 
     // See https://docs.microsoft.com/en-us/windows/win32/api/wingdi/ns-wingdi-displayconfig_video_signal_info
     Mode.AdditionalSignalInfo.vSyncFreqDivider = bMonitorMode ? 0 : 1;
     Mode.AdditionalSignalInfo.videoStandard = 255;
 
-    Mode.vSyncFreq.Numerator = VSync;
-    Mode.vSyncFreq.Denominator = 1;
-    Mode.hSyncFreq.Numerator = VSync * Height;
-    Mode.hSyncFreq.Denominator = 1;
+    Mode.vSyncFreq.Numerator = static_cast<UINT32>(Timing.pixelClockHz);
+    Mode.vSyncFreq.Denominator = Timing.HTotal() * Timing.VTotal();
+    Mode.hSyncFreq.Numerator = static_cast<UINT32>(Timing.pixelClockHz);
+    Mode.hSyncFreq.Denominator = Timing.HTotal();
 
     Mode.scanLineOrdering = DISPLAYCONFIG_SCANLINE_ORDERING_PROGRESSIVE;
 
-    Mode.pixelRate = ((UINT64) VSync) * ((UINT64) Width) * ((UINT64) Height);
+    Mode.pixelRate = Timing.pixelClockHz;
 }
 
-static IDDCX_MONITOR_MODE CreateIddCxMonitorMode(DWORD Width, DWORD Height, DWORD VSync, IDDCX_MONITOR_MODE_ORIGIN Origin = IDDCX_MONITOR_MODE_ORIGIN_DRIVER)
+static IDDCX_MONITOR_MODE CreateIddCxMonitorMode(const rj::DisplayTiming& Timing, IDDCX_MONITOR_MODE_ORIGIN Origin = IDDCX_MONITOR_MODE_ORIGIN_DRIVER)
 {
     IDDCX_MONITOR_MODE Mode = {};
 
     Mode.Size = sizeof(Mode);
     Mode.Origin = Origin;
-    FillSignalInfo(Mode.MonitorVideoSignalInfo, Width, Height, VSync, true);
+    FillSignalInfo(Mode.MonitorVideoSignalInfo, Timing, true);
 
     return Mode;
 }
 
-static IDDCX_TARGET_MODE CreateIddCxTargetMode(DWORD Width, DWORD Height, DWORD VSync)
+static IDDCX_TARGET_MODE CreateIddCxTargetMode(const rj::DisplayTiming& Timing)
 {
     IDDCX_TARGET_MODE Mode = {};
 
     Mode.Size = sizeof(Mode);
-    FillSignalInfo(Mode.TargetVideoSignalInfo.targetVideoSignalInfo, Width, Height, VSync, false);
+    FillSignalInfo(Mode.TargetVideoSignalInfo.targetVideoSignalInfo, Timing, false);
 
     return Mode;
 }
 
+static LONGLONG QpcFrequency()
+{
+    static const LONGLONG s_Frequency = []()
+    {
+        LARGE_INTEGER Frequency = {};
+        QueryPerformanceFrequency(&Frequency);
+        return Frequency.QuadPart;
+    }();
+    return s_Frequency;
+}
+
+// Converts a QPC value to nanoseconds, the time base rj_span uses for the frame channel.
+static INT64 QpcToNs(LONGLONG Qpc)
+{
+    const LONGLONG Frequency = QpcFrequency();
+    if (Frequency <= 0)
+    {
+        return 0;
+    }
+    return (Qpc / Frequency) * 1000000000LL + (Qpc % Frequency) * 1000000000LL / Frequency;
+}
+
+// Converts nanoseconds on the QPC time base back to QPC ticks, for the frame statistics reported to the OS.
+static LONGLONG NsToQpc(INT64 Ns)
+{
+    const LONGLONG Frequency = QpcFrequency();
+    return (Ns / 1000000000LL) * Frequency + (Ns % 1000000000LL) * Frequency / 1000000000LL;
+}
+
+static INT64 QpcNowNs()
+{
+    LARGE_INTEGER Now = {};
+    QueryPerformanceCounter(&Now);
+    return QpcToNs(Now.QuadPart);
+}
+
+static UINT64 LuidToU64(LUID Luid)
+{
+    return (static_cast<UINT64>(static_cast<UINT32>(Luid.HighPart)) << 32) | Luid.LowPart;
+}
+
+static LUID U64ToLuid(UINT64 Value)
+{
+    LUID Luid = {};
+    Luid.LowPart = static_cast<DWORD>(Value);
+    Luid.HighPart = static_cast<LONG>(Value >> 32);
+    return Luid;
+}
+
 #pragma endregion
 
 extern "C" DRIVER_INITIALIZE DriverEntry;
@@ -269,8 +337,8 @@ Direct3DDevice::Direct3DDevice()
 
 HRESULT Direct3DDevice::Init()
 {
-    // The DXGI factory could be cached, but if a new render adapter appears on the system, a new factory needs to be
-    // created. If caching is desired, check DxgiFactory->IsCurrent() each time and recreate the factory if !IsCurrent.
+    // The factory lives as long as the device: s_DeviceCache reuses both until IsCurrent() reports that a render
+    // adapter appeared or went away (or the device was removed), and then creates a new device with a new factory.
     HRESULT hr = CreateDXGIFactory2(0, IID_PPV_ARGS(&DxgiFactory));
     if (FAILED(hr))
     {
@@ -296,12 +364,370 @@ HRESULT Direct3DDevice::Init()
     return S_OK;
 }
 
+bool Direct3DDevice::IsCurrent()
+{
+    return DxgiFactory && DxgiFactory->IsCurrent() && Device && Device->GetDeviceRemovedReason() == S_OK;
+}
+
+shared_ptr<rj::IRenderDevice> Direct3DDeviceFactory::Create(uint64_t AdapterLuid)
+{
+    auto Device = make_shared<Direct3DDevice>(U64ToLuid(AdapterLuid));
+    if (FAILED(Device->Init()))
+    {
+        return nullptr;
+    }
+    return Device;
+}
+
+// One warm device per render adapter, shared by the swap-chains assigned to it over time
+static Direct3DDeviceFactory s_DeviceFactory;
+static rj::DeviceCache s_DeviceCache(s_DeviceFactory);
+
+#pragma endregion
+
+#pragma region FrameChannelPublisher
+
+static_assert(sizeof(rj::Rect) == sizeof(RECT), "channel dirty rects are filled as RECTs");
+
+FrameChannelPublisher::FrameChannelPublisher(shared_ptr<Direct3DDevice> Device)
+    : m_Device(Device), m_Ready(false), m_FrameId(0), m_SurfaceDesc{}, m_SurfaceCount(0), m_SliceCount(0), m_Plan{}
+{
+    // The channel carries no CPU payload, only slot headers; the pixels live in the shared textures. If a consumer
+    // kept the block alive across a driver restart, the producer adopts it and bumps the generation.
+    m_Ready = m_Memory.Create(rj::kFrameChannelName, rj::FrameChannelBytes(0)) &&
+              m_Producer.Init(m_Memory.Data(), m_Memory.Size(), 0, LuidToU64(m_Device->AdapterLuid));
+}
+
+void FrameChannelPublisher::ReleaseSurfaces()
+{
+    for (UINT i = 0; i < rj::kFrameChannelSlots; i++)
+    {
+        for (UINT j = 0; j < rj::kMaxSliceOutputs; j++)
+        {
+            m_SurfaceMutexes[i][j].Reset();
+            m_Surfaces[i][j].Reset();
+            m_SurfaceHandles[i][j].Close();
+        }
+    }
+    m_SurfaceCount = 0;
+    m_SliceCount = 0;
+}
+
+HRESULT FrameChannelPublisher::EnsureSurfaces(const D3D11_TEXTURE2D_DESC& SourceDesc)
+{
+    // Write per-output slices when rj_span asks for them, but only if every output is an exact 1/N column of the
+    // frame: then a sub-rectangle copy is exactly what its slicing shader would sample.
+    UINT SliceCount = m_Producer.RequestedSlices();
+    rj::SlicePlan Plan = {};
+    if (SliceCount > 0)
+    {
+        rj::SlicePlanConfig PlanConfig;
+        PlanConfig.outputs = SliceCount;
+        Plan = rj::PlanSlices(SourceDesc.Width, SourceDesc.Height, PlanConfig);
+        if (Plan.outputs != SliceCount || !Plan.exact || !Plan.AllCopyable())
+        {
+            SliceCount = 0;
+        }
+    }
+
+    if (m_SurfaceCount > 0 && SourceDesc.Width == m_SurfaceDesc.Width && SourceDesc.Height == m_SurfaceDesc.Height &&
+        SourceDesc.Format == m_SurfaceDesc.Format && SliceCount == m_SliceCount)
+    {
+        return S_OK;
+    }
+
+    ReleaseSurfaces();
+
+    D3D11_TEXTURE2D_DESC Desc = {};
+    Desc.Width = SourceDesc.Width;
+    Desc.Height = SourceDesc.Height;
+    Desc.MipLevels = 1;
+    Desc.ArraySize = 1;
+    Desc.Format = SourceDesc.Format;
+    Desc.SampleDesc.Count = 1;
+    Desc.Usage = D3D11_USAGE_DEFAULT;
+    Desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+    Desc.MiscFlags = D3D11_RESOURCE_MISC_SHARED_NTHANDLE | D3D11_RESOURCE_MISC_SHARED_KEYEDMUTEX;
+
+    D3D11_TEXTURE2D_DESC SurfaceDesc = Desc;
+    if (SliceCount > 0)
+    {
+        SurfaceDesc.Width = Plan.regions[0].dstWidth;
+        SurfaceDesc.Height = Plan.regions[0].dstHeight;
+    }
+    const UINT SurfaceCount = SliceCount > 0 ? SliceCount : 1;
+
+    // Named so that rj_span, running as the interactive user in another session, can open them.
+    SECURITY_ATTRIBUTES Security = {};
+    Security.nLength = sizeof(Security);
+    if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(rj::kSharedObjectSddl, SDDL_REVISION_1, &Security.lpSecurityDescriptor, nullptr))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // New surfaces get the next generation's names; the consumer reopens them once the generation is bumped.
+    const UINT32 Generation = m_Producer.Generation() + 1;
+    HRESULT hr = S_OK;
+    for (UINT i = 0; i < rj::kFrameChannelSlots && SUCCEEDED(hr); i++)
+    {
+        for (UINT j = 0; j < SurfaceCount && SUCCEEDED(hr); j++)
+        {
+            hr = m_Device->Device->CreateTexture2D(&SurfaceDesc, nullptr, &m_Surfaces[i][j]);
+            if (FAILED(hr))
+            {
+                break;
+            }
+
+            ComPtr<IDXGIResource1> Resource;
+            hr = m_Surfaces[i][j].As(&Resource);
+            if (FAILED(hr))
+            {
+                break;
+            }
+
+            const string Name = SliceCount > 0 ? rj::FrameChannelSliceSurfaceName(Generation, i, j) : rj::FrameChannelSurfaceName(Generation, i);
+            const wstring WideName(Name.begin(), Name.end());
+            HANDLE Handle = nullptr;
+            hr = Resource->CreateSharedHandle(&Security, DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE, WideName.c_str(), &Handle);
+            if (FAILED(hr))
+            {
+                break;
+            }
+            m_SurfaceHandles[i][j].Attach(Handle);
+
+            hr = m_Surfaces[i][j].As(&m_SurfaceMutexes[i][j]);
+        }
+    }
+    LocalFree(Security.lpSecurityDescriptor);
+
+    if (FAILED(hr))
+    {
+        ReleaseSurfaces();
+        return hr;
+    }
+
+    m_SurfaceDesc = Desc;
+    m_SurfaceCount = SurfaceCount;
+    m_SliceCount = SliceCount;
+    m_Plan = Plan;
+    m_Producer.BumpGeneration(SliceCount);
+    return S_OK;
+}
+
+HRESULT FrameChannelPublisher::Publish(IDDCX_SWAPCHAIN hSwapChain, ID3D11Texture2D* pSurface, const rj::SwapChainBuffer& Buffer)
+{
+    if (!m_Ready)
+    {
+        return S_FALSE;
+    }
+
+    // Without rj_span attached nobody reads the slots: skip the GPU copy (a whole wide frame per present) but keep
+    // the heartbeat, so a consumer that attaches sees a live producer.
+    if (!m_Producer.ConsumerAttached())
+    {
+        m_Producer.Heartbeat(QpcNowNs());
+        return S_FALSE;
+    }
+
+    D3D11_TEXTURE2D_DESC SourceDesc = {};
+    pSurface->GetDesc(&SourceDesc);
+    HRESULT hr = EnsureSurfaces(SourceDesc);
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    // The write slot belongs to the producer until it is published, so the keyed mutexes are free; they only order
+    // the copy on this device before the consumer's reads on its own device. A timeout means a consumer broke the
+    // protocol, so skip the frame rather than stall the swap-chain, and say so: it's a dropped frame.
+    const UINT Slot = m_Producer.WriteSlot();
+    UINT Locked = 0;
+    for (; Locked < m_SurfaceCount; Locked++)
+    {
+        hr = m_SurfaceMutexes[Slot][Locked]->AcquireSync(0, 0);
+        if (hr != S_OK)
+        {
+            break;
+        }
+    }
+    if (Locked == m_SurfaceCount)
+    {
+        if (m_SliceCount == 0)
+        {
+            m_Device->DeviceContext->CopyResource(m_Surfaces[Slot][0].Get(), pSurface);
+        }
+        else
+        {
+            // Each output's column goes straight into its own surface, so rj_span only has to present it
+            for (UINT i = 0; i < m_SliceCount; i++)
+            {
+                const rj::Rect& Src = m_Plan.regions[i].src;
+                const D3D11_BOX Box = { static_cast<UINT>(Src.left), static_cast<UINT>(Src.top), 0, static_cast<UINT>(Src.right), static_cast<UINT>(Src.bottom), 1 };
+                m_Device->DeviceContext->CopySubresourceRegion(m_Surfaces[Slot][i].Get(), 0, 0, 0, 0, pSurface, 0, &Box);
+            }
+        }
+    }
+    for (UINT i = 0; i < Locked; i++)
+    {
+        m_SurfaceMutexes[Slot][i]->ReleaseSync(0);
+    }
+    if (Locked != m_SurfaceCount)
+    {
+        return FAILED(hr) ? hr : HRESULT_FROM_WIN32(WAIT_TIMEOUT);
+    }
+
+    rj::ChannelFrameInfo Info = {};
+    Info.frameId = ++m_FrameId;
+    Info.presentTimeNs = Buffer.presentTimeNs;
+    Info.width = m_SurfaceDesc.Width;
+    Info.height = m_SurfaceDesc.Height;
+    Info.format = static_cast<rj::PixelFormat>(m_SurfaceDesc.Format);
+    Info.accumulatedFrames = 1;
+    Info.sliceCount = m_SliceCount;
+
+    // Dirty rects are only exact without move regions; anything else is reported as a full-frame change.
+    if (Buffer.moveRegionCount == 0 && Buffer.dirtyRectCount > 0 && Buffer.dirtyRectCount <= rj::kFrameChannelMaxDirtyRects)
+    {
+        IDARG_IN_GETDIRTYRECTS DirtyIn = {};
+        DirtyIn.DirtyRectInCount = Buffer.dirtyRectCount;
+        DirtyIn.pDirtyRects = reinterpret_cast<RECT*>(Info.dirtyRects);
+        IDARG_OUT_GETDIRTYRECTS DirtyOut = {};
+        if (SUCCEEDED(IddCxSwapChainGetDirtyRects(hSwapChain, &DirtyIn, &DirtyOut)))
+        {
+            Info.dirtyRectCount = DirtyOut.DirtyRectOutCount;
+        }
+    }
+
+    Info.publishTimeNs = QpcNowNs();
+    m_Producer.Publish(Info);
+    m_Producer.Heartbeat(Info.publishTimeNs);
+    return S_OK;
+}
+
+void FrameChannelPublisher::Heartbeat()
+{
+    if (m_Ready)
+    {
+        m_Producer.Heartbeat(QpcNowNs());
+    }
+}
+
+void FrameChannelPublisher::ReportAssignment(const SwapChainAssignment& Assignment)
+{
+    if (m_Ready)
+    {
+        m_Producer.ReportAssignment(Assignment.DeviceReused, Assignment.DeviceAcquireNs);
+    }
+}
+
+void FrameChannelPublisher::ReportFirstFrame(INT64 SinceAssignmentNs)
+{
+    if (m_Ready)
+    {
+        m_Producer.ReportFirstFrame(SinceAssignmentNs);
+    }
+}
+
+#pragma endregion
+
+#pragma region IddCxSwapChainPort
+
+IddCxSwapChainPort::IddCxSwapChainPort(IDDCX_SWAPCHAIN hSwapChain, HANDLE hAvailableBufferEvent, HANDLE hTerminateEvent)
+    : m_hSwapChain(hSwapChain), m_hAvailableBufferEvent(hAvailableBufferEvent), m_hTerminateEvent(hTerminateEvent)
+{
+}
+
+rj::SwapChainAcquire IddCxSwapChainPort::ReleaseAndAcquire(rj::SwapChainBuffer& Out)
+{
+    // Ask for the next buffer from the producer
+    IDARG_OUT_RELEASEANDACQUIREBUFFER Buffer = {};
+    HRESULT hr = IddCxSwapChainReleaseAndAcquireBuffer(m_hSwapChain, &Buffer);
+
+    // AcquireBuffer immediately returns STATUS_PENDING if no buffer is yet available
+    if (hr == E_PENDING)
+    {
+        return rj::SwapChainAcquire::Pending;
+    }
+    else if (FAILED(hr))
+    {
+        // The swap-chain was likely abandoned (e.g. DXGI_ERROR_ACCESS_LOST)
+        return rj::SwapChainAcquire::Lost;
+    }
+
+    // The surface has a reference on it that the driver has to release
+    m_AcquiredBuffer.Attach(Buffer.MetaData.pSurface);
+
+    Out.frameNumber = Buffer.MetaData.PresentationFrameNumber;
+    Out.presentTimeNs = QpcToNs(Buffer.MetaData.PresentDisplayQPCTime);
+    Out.dirtyRectCount = Buffer.MetaData.DirtyRectCount;
+    Out.moveRegionCount = Buffer.MetaData.MoveRegionCount;
+    Out.surface = m_AcquiredBuffer.Get();
+    return rj::SwapChainAcquire::Acquired;
+}
+
+rj::SwapChainWait IddCxSwapChainPort::WaitForWork(int64_t TimeoutNs)
+{
+    HANDLE WaitHandles [] =
+    {
+        m_hAvailableBufferEvent,
+        m_hTerminateEvent
+    };
+    const DWORD TimeoutMs = TimeoutNs < 0 ? INFINITE : static_cast<DWORD>((TimeoutNs + 999999) / 1000000);
+    DWORD WaitResult = WaitForMultipleObjects(ARRAYSIZE(WaitHandles), WaitHandles, FALSE, TimeoutMs);
+    if (WaitResult == WAIT_OBJECT_0)
+    {
+        return rj::SwapChainWait::NewFrame;
+    }
+    else if (WaitResult == WAIT_OBJECT_0 + 1)
+    {
+        return rj::SwapChainWait::Terminate;
+    }
+    else if (WaitResult == WAIT_TIMEOUT)
+    {
+        return rj::SwapChainWait::Timeout;
+    }
+
+    // The wait was cancelled or something unexpected happened
+    return rj::SwapChainWait::Failed;
+}
+
+bool IddCxSwapChainPort::FinishedProcessing()
+{
+    // We have finished processing this frame hence we release the reference on it.
+    // If the driver forgets to release the reference to the surface, it will be leaked which results in the
+    // surfaces being left around after swapchain is destroyed.
+    m_AcquiredBuffer.Reset();
+
+    // Indicate to OS that we have finished inital processing of the frame, it is a hint that
+    // OS could start preparing another frame
+    return SUCCEEDED(IddCxSwapChainFinishedProcessingFrame(m_hSwapChain));
+}
+
+void IddCxSwapChainPort::ReportFrameStatistics(const rj::SwapChainFrameTiming& Timing)
+{
+    // Publishing is the "send": it starts when processing starts and the GPU copy is queued when it ends
+    IDARG_IN_REPORTFRAMESTATISTICS Args = {};
+    Args.FrameStatistics.Size = sizeof(Args.FrameStatistics);
+    Args.FrameStatistics.PresentationFrameNumber = static_cast<UINT>(Timing.frameNumber);
+    Args.FrameStatistics.FrameStatus =
+        Timing.status == rj::SwapChainFrameStatus::Completed ? IDDCX_FRAME_STATUS_COMPLETED : IDDCX_FRAME_STATUS_DROPPED;
+    Args.FrameStatistics.SendStartQpcTime = NsToQpc(Timing.processStartNs);
+    Args.FrameStatistics.SendStopQpcTime = NsToQpc(Timing.processEndNs);
+    Args.FrameStatistics.SendCompleteQpcTime = NsToQpc(Timing.processEndNs);
+    IddCxSwapChainReportFrameStatistics(m_hSwapChain, &Args);
+}
+
+int64_t IddCxSwapChainPort::NowNs()
+{
+    return QpcNowNs();
+}
+
 #pragma endregion
 
 #pragma region SwapChainProcessor
 
-SwapChainProcessor::SwapChainProcessor(IDDCX_SWAPCHAIN hSwapChain, shared_ptr<Direct3DDevice> Device, HANDLE NewFrameEvent)
-    : m_hSwapChain(hSwapChain), m_Device(Device), m_hAvailableBufferEvent(NewFrameEvent)
+SwapChainProcessor::SwapChainProcessor(IDDCX_SWAPCHAIN hSwapChain, shared_ptr<Direct3DDevice> Device, HANDLE NewFrameEvent, const SwapChainAssignment& Assignment)
+    : m_hSwapChain(hSwapChain), m_Device(Device), m_hAvailableBufferEvent(NewFrameEvent), m_Assignment(Assignment), m_FirstFrameReported(false)
 {
     m_hTerminateEvent.Attach(CreateEvent(nullptr, FALSE, FALSE, nullptr));
 
@@ -360,91 +786,50 @@ void SwapChainProcessor::RunCore()
     hr = IddCxSwapChainSetDevice(m_hSwapChain, &SetDevice);
     if (FAILED(hr))
     {
+        // Don't hand this device to the next swap-chain; it gets a fresh one
+        s_DeviceCache.Invalidate(LuidToU64(m_Device->AdapterLuid));
         return;
     }
 
-    // Acquire and release buffers in a loop
-    for (;;)
-    {
-        ComPtr<IDXGIResource> AcquiredBuffer;
+    // Created on this thread, which is the only one using the device context
+    m_Publisher = make_unique<FrameChannelPublisher>(m_Device);
+    m_Publisher->ReportAssignment(m_Assignment);
 
-        // Ask for the next buffer from the producer
-        IDARG_OUT_RELEASEANDACQUIREBUFFER Buffer = {};
-        hr = IddCxSwapChainReleaseAndAcquireBuffer(m_hSwapChain, &Buffer);
+    // Only acquire after a frame was processed or the OS signalled a new one; the idle timeout just keeps the frame
+    // channel heartbeat going, since the OS only presents on change.
+    IddCxSwapChainPort Port(m_hSwapChain, m_hAvailableBufferEvent, m_hTerminateEvent.Get());
+    rj::SwapChainLoop Loop(Port, *this);
+    Loop.Run();
 
-        // AcquireBuffer immediately returns STATUS_PENDING if no buffer is yet available
-        if (hr == E_PENDING)
-        {
-            // We must wait for a new buffer
-            HANDLE WaitHandles [] =
-            {
-                m_hAvailableBufferEvent,
-                m_hTerminateEvent.Get()
-            };
-            DWORD WaitResult = WaitForMultipleObjects(ARRAYSIZE(WaitHandles), WaitHandles, FALSE, 16);
-            if (WaitResult == WAIT_OBJECT_0 || WaitResult == WAIT_TIMEOUT)
-            {
-                // We have a new buffer, so try the AcquireBuffer again
-                continue;
-            }
-            else if (WaitResult == WAIT_OBJECT_0 + 1)
-            {
-                // We need to terminate
-                break;
-            }
-            else
-            {
-                // The wait was cancelled or something unexpected happened
-                hr = HRESULT_FROM_WIN32(WaitResult);
-                break;
-            }
-        }
-        else if (SUCCEEDED(hr))
-        {
-            // We have new frame to process, the surface has a reference on it that the driver has to release
-            AcquiredBuffer.Attach(Buffer.MetaData.pSurface);
-
-            // ==============================
-            // TODO: Process the frame here
-            //
-            // This is the most performance-critical section of code in an IddCx driver. It's important that whatever
-            // is done with the acquired surface be finished as quickly as possible. This operation could be:
-            //  * a GPU copy to another buffer surface for later processing (such as a staging surface for mapping to CPU memory)
-            //  * a GPU encode operation
-            //  * a GPU VPBlt to another surface
-            //  * a GPU custom compute shader encode operation
-            // ==============================
-
-            // We have finished processing this frame hence we release the reference on it.
-            // If the driver forgets to release the reference to the surface, it will be leaked which results in the
-            // surfaces being left around after swapchain is destroyed.
-            // NOTE: Although in this sample we release reference to the surface here; the driver still
-            // owns the Buffer.MetaData.pSurface surface until IddCxSwapChainReleaseAndAcquireBuffer returns
-            // S_OK and gives us a new frame, a driver may want to use the surface in future to re-encode the desktop 
-            // for better quality if there is no new frame for a while
-            AcquiredBuffer.Reset();
-            
-            // Indicate to OS that we have finished inital processing of the frame, it is a hint that
-            // OS could start preparing another frame
-            hr = IddCxSwapChainFinishedProcessingFrame(m_hSwapChain);
-            if (FAILED(hr))
-            {
-                break;
-            }
+    m_Publisher.reset();
+}
 
-            // ==============================
-            // TODO: Report frame statistics once the asynchronous encode/send work is completed
-            //
-            // Drivers should report information about sub-frame timings, like encode time, send time, etc.
-            // ==============================
-            // IddCxSwapChainReportFrameStatistics(m_hSwapChain, ...);
-        }
-        else
-        {
-            // The swap-chain was likely abandoned (e.g. DXGI_ERROR_ACCESS_LOST), so exit the processing loop
-            break;
-        }
+bool SwapChainProcessor::ProcessFrame(const rj::SwapChainBuffer& Buffer)
+{
+    // This is the most performance-critical section of code in an IddCx driver. The frame is copied on the GPU
+    // into the frame channel's write slot and published to rj_span together with its present time and dirty
+    // rects; a failure only costs the consumer this frame.
+    ComPtr<ID3D11Texture2D> AcquiredTexture;
+    HRESULT hr = static_cast<IDXGIResource*>(Buffer.surface)->QueryInterface(IID_PPV_ARGS(&AcquiredTexture));
+    if (FAILED(hr))
+    {
+        return false;
     }
+
+    // S_FALSE means nobody is listening yet, which is not a dropped frame. A frame skipped on a keyed-mutex timeout
+    // comes back as a failure code and is reported as dropped.
+    const bool Published = SUCCEEDED(m_Publisher->Publish(m_hSwapChain, AcquiredTexture.Get(), Buffer));
+    if (!m_FirstFrameReported)
+    {
+        m_FirstFrameReported = true;
+        m_Publisher->ReportFirstFrame(QpcNowNs() - m_Assignment.AssignedNs);
+    }
+    return Published;
+}
+
+void SwapChainProcessor::OnIdle(int64_t)
+{
+    m_Publisher->Heartbeat();
 }
 
 #pragma endregion
@@ -470,6 +855,9 @@ void IndirectDeviceContext::InitAdapter()
     // This is also where static per-adapter capabilities are determined.
     // ==============================
 
+    // Modes and EDID of the wide monitor, from the config rj_span wrote (or the default)
+    LoadVirtualMonitor();
+
     IDDCX_ADAPTER_CAPS AdapterCaps = {};
     AdapterCaps.Size = sizeof(AdapterCaps);
 
@@ -517,13 +905,8 @@ void IndirectDeviceContext::InitAdapter()
 
 void IndirectDeviceContext::FinishInit(UINT ConnectorIndex)
 {
-    // ==============================
-    // TODO: In a real driver, the EDID should be retrieved dynamically from a connected physical monitor. The EDIDs
-    // provided here are purely for demonstration.
-    // Monitor manufacturers are required to correctly fill in physical monitor attributes in order to allow the OS
-    // to optimize settings like viewing distance and scale factor. Manufacturers should also use a unique serial
-    // number every single device to ensure the OS can tell the monitors apart.
-    // ==============================
+    // The EDID is generated from the virtual display config: a base block plus DisplayID extensions carrying the
+    // wide CVT-RB2 timings, with a physical size that matches the panels so the OS picks a sensible scale factor.
 
     WDF_OBJECT_ATTRIBUTES Attr;
     WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&Attr, IndirectMonitorContextWrapper);
@@ -536,15 +919,15 @@ void IndirectDeviceContext::FinishInit(UINT ConnectorIndex)
 
     MonitorInfo.MonitorDescription.Size = sizeof(MonitorInfo.MonitorDescription);
     MonitorInfo.MonitorDescription.Type = IDDCX_MONITOR_DESCRIPTION_TYPE_EDID;
-    if (ConnectorIndex >= ARRAYSIZE(s_SampleMonitors))
+    if (ConnectorIndex >= IDD_SAMPLE_MONITOR_COUNT || s_VirtualMonitor.Edid.empty())
     {
         MonitorInfo.MonitorDescription.DataSize = 0;
         MonitorInfo.MonitorDescription.pData = nullptr;
     }
     else
     {
-        MonitorInfo.MonitorDescription.DataSize = IndirectSampleMonitor::szEdidBlock;
-        MonitorInfo.MonitorDescription.pData = const_cast<BYTE*>(s_SampleMonitors[ConnectorIndex].pEdidBlock);
+        MonitorInfo.MonitorDescription.DataSize = static_cast<UINT>(s_VirtualMonitor.Edid.size());
+        MonitorInfo.MonitorDescription.pData = s_VirtualMonitor.Edid.data();
     }
 
     // ==============================
@@ -591,8 +974,13 @@ void IndirectMonitorContext::AssignSwapChain(IDDCX_SWAPCHAIN SwapChain, LUID Ren
 {
     m_ProcessingThread.reset();
 
-    auto Device = make_shared<Direct3DDevice>(RenderAdapter);
-    if (FAILED(Device->Init()))
+    // Reuse the render adapter's warm device while it is still current instead of creating a DXGI factory and a
+    // D3D device on every mode change or fullscreen switch. The previous processor has stopped using it above.
+    SwapChainAssignment Assignment = {};
+    Assignment.AssignedNs = QpcNowNs();
+    auto Device = static_pointer_cast<Direct3DDevice>(s_DeviceCache.Acquire(LuidToU64(RenderAdapter), &Assignment.DeviceReused));
+    Assignment.DeviceAcquireNs = QpcNowNs() - Assignment.AssignedNs;
+    if (!Device)
     {
         // It's important to delete the swap-chain if D3D initialization fails, so that the OS knows to generate a new
         // swap-chain and try again.
@@ -601,7 +989,7 @@ void IndirectMonitorContext::AssignSwapChain(IDDCX_SWAPCHAIN SwapChain, LUID Ren
     else
     {
         // Create a new swap-chain processing thread
-        m_ProcessingThread.reset(new SwapChainProcessor(SwapChain, Device, NewFrameEvent));
+        m_ProcessingThread.reset(new SwapChainProcessor(SwapChain, Device, NewFrameEvent, Assignment));
     }
 }
 
@@ -653,53 +1041,37 @@ NTSTATUS IddSampleAdapterCommitModes(IDDCX_ADAPTER AdapterObject, const IDARG_IN
 _Use_decl_annotations_
 NTSTATUS IddSampleParseMonitorDescription(const IDARG_IN_PARSEMONITORDESCRIPTION* pInArgs, IDARG_OUT_PARSEMONITORDESCRIPTION* pOutArgs)
 {
-    // ==============================
-    // TODO: In a real driver, this function would be called to generate monitor modes for an EDID by parsing it. In
-    // this sample driver, we hard-code the EDID, so this function can generate known modes.
-    // ==============================
+    // Parse the EDID rather than matching it against a known block: the modes are whatever its detailed timings
+    // and DisplayID Type I timings describe, which for our own EDID is exactly s_VirtualMonitor.Modes.
+    if (pInArgs->MonitorDescription.Type != IDDCX_MONITOR_DESCRIPTION_TYPE_EDID)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    rj::EdidInfo Info;
+    if (!rj::ParseEdid(static_cast<const uint8_t*>(pInArgs->MonitorDescription.pData), pInArgs->MonitorDescription.DataSize, Info) ||
+        Info.modes.empty())
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
 
-    pOutArgs->MonitorModeBufferOutputCount = IndirectSampleMonitor::szModeList;
+    pOutArgs->MonitorModeBufferOutputCount = static_cast<UINT>(Info.modes.size());
 
-    if (pInArgs->MonitorModeBufferInputCount < IndirectSampleMonitor::szModeList)
+    if (pInArgs->MonitorModeBufferInputCount < Info.modes.size())
     {
         // Return success if there was no buffer, since the caller was only asking for a count of modes
         return (pInArgs->MonitorModeBufferInputCount > 0) ? STATUS_BUFFER_TOO_SMALL : STATUS_SUCCESS;
     }
-    else
-    {
-        // In the sample driver, we have reported some static information about connected monitors
-        // Check which of the reported monitors this call is for by comparing it to the pointer of
-        // our known EDID blocks.
 
-        if (pInArgs->MonitorDescription.DataSize != IndirectSampleMonitor::szEdidBlock)
-            return STATUS_INVALID_PARAMETER;
+    for (size_t ModeIndex = 0; ModeIndex < Info.modes.size(); ModeIndex++)
+    {
+        pInArgs->pMonitorModes[ModeIndex] = CreateIddCxMonitorMode(Info.modes[ModeIndex], IDDCX_MONITOR_MODE_ORIGIN_MONITORDESCRIPTOR);
+    }
 
-        DWORD SampleMonitorIdx = 0;
-        for(; SampleMonitorIdx < ARRAYSIZE(s_SampleMonitors); SampleMonitorIdx++)
-        {
-            if (memcmp(pInArgs->MonitorDescription.pData, s_SampleMonitors[SampleMonitorIdx].pEdidBlock, IndirectSampleMonitor::szEdidBlock) == 0)
-            {
-                // Copy the known modes to the output buffer
-                for (DWORD ModeIndex = 0; ModeIndex < IndirectSampleMonitor::szModeList; ModeIndex++)
-                {
-                    pInArgs->pMonitorModes[ModeIndex] = CreateIddCxMonitorMode(
-                        s_SampleMonitors[SampleMonitorIdx].pModeList[ModeIndex].Width,
-                        s_SampleMonitors[SampleMonitorIdx].pModeList[ModeIndex].Height,
-                        s_SampleMonitors[SampleMonitorIdx].pModeList[ModeIndex].VSync,
-                        IDDCX_MONITOR_MODE_ORIGIN_MONITORDESCRIPTOR
-                    );
-                }
-
-                // Set the preferred mode as represented in the EDID
-                pOutArgs->PreferredMonitorModeIdx = s_SampleMonitors[SampleMonitorIdx].ulPreferredModeIdx;
-        
-                return STATUS_SUCCESS;
-            }
-        }
+    // Set the preferred mode as represented in the EDID
+    pOutArgs->PreferredMonitorModeIdx = static_cast<UINT>(Info.preferred);
 
-        // This EDID block does not belong to the monitors we reported earlier
-        return STATUS_INVALID_PARAMETER;
-    }
+    return STATUS_SUCCESS;
 }
 
 _Use_decl_annotations_
@@ -707,30 +1079,25 @@ NTSTATUS IddSampleMonitorGetDefaultModes(IDDCX_MONITOR MonitorObject, const IDAR
 {
     UNREFERENCED_PARAMETER(MonitorObject);
 
-    // ==============================
-    // TODO: In a real driver, this function would be called to generate monitor modes for a monitor with no EDID.
-    // Drivers should report modes that are guaranteed to be supported by the transport protocol and by nearly all
-    // monitors (such 640x480, 800x600, or 1024x768). If the driver has access to monitor modes from a descriptor other
-    // than an EDID, those modes would also be reported here.
-    // ==============================
+    // Only used when the monitor was reported without an EDID: the configured modes, preferred first
+    const vector<rj::DisplayTiming>& Modes = s_VirtualMonitor.Modes;
 
     if (pInArgs->DefaultMonitorModeBufferInputCount == 0)
     {
-        pOutArgs->DefaultMonitorModeBufferOutputCount = ARRAYSIZE(s_SampleDefaultModes); 
+        pOutArgs->DefaultMonitorModeBufferOutputCount = static_cast<UINT>(Modes.size());
+    }
+    else if (pInArgs->DefaultMonitorModeBufferInputCount < Modes.size())
+    {
+        return STATUS_BUFFER_TOO_SMALL;
     }
     else
     {
-        for (DWORD ModeIndex = 0; ModeIndex < ARRAYSIZE(s_SampleDefaultModes); ModeIndex++)
+        for (size_t ModeIndex = 0; ModeIndex < Modes.size(); ModeIndex++)
         {
-            pInArgs->pDefaultMonitorModes[ModeIndex] = CreateIddCxMonitorMode(
-                s_SampleDefaultModes[ModeIndex].Width,
-                s_SampleDefaultModes[ModeIndex].Height,
-                s_SampleDefaultModes[ModeIndex].VSync,
-                IDDCX_MONITOR_MODE_ORIGIN_DRIVER
-            );
+            pInArgs->pDefaultMonitorModes[ModeIndex] = CreateIddCxMonitorMode(Modes[ModeIndex], IDDCX_MONITOR_MODE_ORIGIN_DRIVER);
         }
 
-        pOutArgs->DefaultMonitorModeBufferOutputCount = ARRAYSIZE(s_SampleDefaultModes); 
+        pOutArgs->DefaultMonitorModeBufferOutputCount = static_cast<UINT>(Modes.size());
         pOutArgs->PreferredMonitorModeIdx = 0;
     }
 
@@ -747,8 +1114,12 @@ NTSTATUS IddSampleMonitorQueryModes(IDDCX_MONITOR MonitorObject, const IDARG_IN_
     // Create a set of modes supported for frame processing and scan-out. These are typically not based on the
     // monitor's descriptor and instead are based on the static processing capability of the device. The OS will
     // report the available set of modes for a given output as the intersection of monitor modes with target modes.
+    // The target modes use the same timings as the EDID, so every configured mode survives the intersection.
 
-    TargetModes.push_back(CreateIddCxTargetMode(7680, 1440, 120));
+    for (const rj::DisplayTiming& Timing : s_VirtualMonitor.Modes)
+    {
+        TargetModes.push_back(CreateIddCxTargetMode(Timing));
+    }
 
     pOutArgs->TargetModeBufferOutputCount = (UINT) TargetModes.size();
 
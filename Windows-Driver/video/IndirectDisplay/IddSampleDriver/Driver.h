@@ -10,11 +10,22 @@
 #include <dxgi1_5.h>
 #include <d3d11_2.h>
 #include <avrt.h>
+#include <sddl.h>
 #include <wrl.h>
 
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "core/device_cache.h"
+#include "core/display_timing.h"
+#include "core/edid.h"
+#include "core/frame_channel.h"
+#include "core/shared_memory.h"
+#include "core/slice_plan.h"
+#include "core/swapchain_loop.h"
+#include "core/virtual_display.h"
+
 #include "Trace.h"
 
 namespace Microsoft
@@ -25,6 +36,9 @@ namespace Microsoft
         {
             // Adds a wrapper for thread handles to the existing set of WRL handle wrapper classes
             typedef HandleT<HandleTraits::HANDLENullTraits> Thread;
+
+            // Adds a wrapper for NT handles to shared resources (which keep the resource's name alive)
+            typedef HandleT<HandleTraits::HANDLENullTraits> SharedHandle;
         }
     }
 }
@@ -34,31 +48,27 @@ namespace Microsoft
     namespace IndirectDisp
     {
         /// <summary>
-        /// Manages the creation and lifetime of a Direct3D render device.
+        /// The wide virtual monitor: its modes and the EDID that advertises them, built from the
+        /// rj_span virtual display config when the adapter initializes.
         /// </summary>
-        struct IndirectSampleMonitor
+        struct VirtualMonitorDescription
         {
-            static constexpr size_t szEdidBlock = 128;
-            static constexpr size_t szModeList = 1;
-
-            const BYTE pEdidBlock[szEdidBlock];
-            const struct SampleMonitorMode {
-                DWORD Width;
-                DWORD Height;
-                DWORD VSync;
-            } pModeList[szModeList];
-            const DWORD ulPreferredModeIdx;
+            rj::VirtualDisplayConfig Config;
+            std::vector<rj::DisplayTiming> Modes; // Modes[0] is preferred
+            std::vector<BYTE> Edid;
         };
 
         /// <summary>
         /// Manages the creation and lifetime of a Direct3D render device.
         /// </summary>
-        struct Direct3DDevice
+        struct Direct3DDevice : public rj::IRenderDevice
         {
             Direct3DDevice(LUID AdapterLuid);
             Direct3DDevice();
             HRESULT Init();
 
+            bool IsCurrent() override;
+
             LUID AdapterLuid;
             Microsoft::WRL::ComPtr<IDXGIFactory5> DxgiFactory;
             Microsoft::WRL::ComPtr<IDXGIAdapter1> Adapter;
@@ -66,15 +76,97 @@ namespace Microsoft
             Microsoft::WRL::ComPtr<ID3D11DeviceContext> DeviceContext;
         };
 
+        /// <summary>
+        /// Creates Direct3DDevices for the device cache, which keeps one per render adapter across swap-chain
+        /// assignments.
+        /// </summary>
+        class Direct3DDeviceFactory : public rj::IRenderDeviceFactory
+        {
+        public:
+            std::shared_ptr<rj::IRenderDevice> Create(uint64_t AdapterLuid) override;
+        };
+
+        /// <summary>
+        /// When a swap-chain was assigned and how its device was obtained, reported through the frame channel
+        /// together with the time to its first processed frame.
+        /// </summary>
+        struct SwapChainAssignment
+        {
+            INT64 AssignedNs;
+            INT64 DeviceAcquireNs;
+            bool DeviceReused;
+        };
+
+        /// <summary>
+        /// Publishes swap-chain frames to rj_span through the shared frame channel (src/core/frame_channel.h), so the
+        /// desktop app can sample them directly instead of capturing the virtual monitor again with Desktop Duplication.
+        /// Each channel slot is a shared texture with a keyed mutex that the consumer opens by name, or, when rj_span asks
+        /// for slices, one such texture per output holding that output's column of the frame.
+        /// </summary>
+        class FrameChannelPublisher
+        {
+        public:
+            FrameChannelPublisher(std::shared_ptr<Direct3DDevice> Device);
+
+            // S_OK once published; S_FALSE while the channel isn't open or no consumer is attached (nothing is copied);
+            // HRESULT_FROM_WIN32(WAIT_TIMEOUT) when a slot's keyed mutex wasn't free and the frame was skipped.
+            HRESULT Publish(IDDCX_SWAPCHAIN hSwapChain, ID3D11Texture2D* pSurface, const rj::SwapChainBuffer& Buffer);
+            void Heartbeat();
+            void ReportAssignment(const SwapChainAssignment& Assignment);
+            void ReportFirstFrame(INT64 SinceAssignmentNs);
+
+        private:
+            HRESULT EnsureSurfaces(const D3D11_TEXTURE2D_DESC& SourceDesc);
+            void ReleaseSurfaces();
+
+            std::shared_ptr<Direct3DDevice> m_Device;
+            rj::SharedMemory m_Memory;
+            rj::FrameChannelProducer m_Producer;
+            bool m_Ready;
+            UINT64 m_FrameId;
+            D3D11_TEXTURE2D_DESC m_SurfaceDesc; // the whole frame, also when sliced
+            UINT m_SurfaceCount;                // surfaces per slot: 1, or m_SliceCount
+            UINT m_SliceCount;
+            rj::SlicePlan m_Plan;
+            Microsoft::WRL::ComPtr<ID3D11Texture2D> m_Surfaces[rj::kFrameChannelSlots][rj::kMaxSliceOutputs];
+            Microsoft::WRL::ComPtr<IDXGIKeyedMutex> m_SurfaceMutexes[rj::kFrameChannelSlots][rj::kMaxSliceOutputs];
+            Microsoft::WRL::Wrappers::SharedHandle m_SurfaceHandles[rj::kFrameChannelSlots][rj::kMaxSliceOutputs];
+        };
+
+        /// <summary>
+        /// Drives an indirect display swap-chain object for rj::SwapChainLoop (src/core/swapchain_loop.h) and reports
+        /// each frame's statistics back to the OS.
+        /// </summary>
+        class IddCxSwapChainPort : public rj::ISwapChainPort
+        {
+        public:
+            IddCxSwapChainPort(IDDCX_SWAPCHAIN hSwapChain, HANDLE hAvailableBufferEvent, HANDLE hTerminateEvent);
+
+            rj::SwapChainAcquire ReleaseAndAcquire(rj::SwapChainBuffer& Out) override;
+            rj::SwapChainWait WaitForWork(int64_t TimeoutNs) override;
+            bool FinishedProcessing() override;
+            void ReportFrameStatistics(const rj::SwapChainFrameTiming& Timing) override;
+            int64_t NowNs() override;
+
+        private:
+            IDDCX_SWAPCHAIN m_hSwapChain;
+            HANDLE m_hAvailableBufferEvent;
+            HANDLE m_hTerminateEvent;
+            Microsoft::WRL::ComPtr<IDXGIResource> m_AcquiredBuffer;
+        };
+
         /// <summary>
         /// Manages a thread that consumes buffers from an indirect display swap-chain object.
         /// </summary>
-        class SwapChainProcessor
+        class SwapChainProcessor : public rj::ISwapChainFrameSink
         {
         public:
-            SwapChainProcessor(IDDCX_SWAPCHAIN hSwapChain, std::shared_ptr<Direct3DDevice> Device, HANDLE NewFrameEvent);
+            SwapChainProcessor(IDDCX_SWAPCHAIN hSwapChain, std::shared_ptr<Direct3DDevice> Device, HANDLE NewFrameEvent, const SwapChainAssignment& Assignment);
             ~SwapChainProcessor();
 
+            bool ProcessFrame(const rj::SwapChainBuffer& Buffer) override;
+            void OnIdle(int64_t NowNs) override;
+
         private:
             static DWORD CALLBACK RunThread(LPVOID Argument);
 
@@ -84,6 +176,9 @@ namespace Microsoft
             IDDCX_SWAPCHAIN m_hSwapChain;
             std::shared_ptr<Direct3DDevice> m_Device;
             HANDLE m_hAvailableBufferEvent;
+            SwapChainAssignment m_Assignment;
+            bool m_FirstFrameReported;
+            std::unique_ptr<FrameChannelPublisher> m_Publisher;
             Microsoft::WRL::Wrappers::Thread m_hThread;
             Microsoft::WRL::Wrappers::Event m_hTerminateEvent;
         };
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#include "core/clock.h"
+#include "core/frame.h"
+
+namespace rj::bench {
+
+// Returns the value of `--name=value`, or `fallback` when absent.
+inline const char* ArgStr(int argc, char** argv, const char* name, const char* fallback) {
+    const size_t n = strlen(name);
+    for (int i = 0; i < argc; i++) {
+        if (strncmp(argv[i], name, n) == 0 && argv[i][n] == '=') return argv[i] + n + 1;
+    }
+    return fallback;
+}
+
+inline long long ArgInt(int argc, char** argv, const char* name, long long fallback) {
+    const char* v = ArgStr(argc, argv, name, nullptr);
+    return v ? strtoll(v, nullptr, 10) : fallback;
+}
+
+inline double ArgDouble(int argc, char** argv, const char* name, double fallback) {
+    const char* v = ArgStr(argc, argv, name, nullptr);
+    return v ? strtod(v, nullptr) : fallback;
+}
+
+inline bool ArgFlag(int argc, char** argv, const char* name) {
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+inline int64_t HostNowNs() {
+    static SteadyClock s_clock;
+    return s_clock.NowNs();
+}
+
+// Keeps the optimizer from discarding benchmark results: `p` escapes and memory is clobbered.
+inline void DoNotOptimize(const void* p) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    static const void* volatile s_sink;
+    s_sink = p;
+    (void)s_sink;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "g"(p) : "memory");
+#endif
+}
+
+// LCG for the simulations: the same 24-bit sequence on every compiler, unlike <random>'s
+// distributions.
+inline uint32_t NextRandom(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// FNV-1a over the visible bytes of a frame's rows; 0 without pixels.
+inline uint64_t HashPixels(const FrameDesc& f) {
+    if (!f.pixels) return 0;
+    uint64_t h = 1469598103934665603ull;
+    const size_t row = static_cast<size_t>(f.width) * BytesPerPixel(f.format);
+    for (uint32_t y = 0; y < f.height; y++) {
+        const uint8_t* p = f.pixels + static_cast<size_t>(y) * f.strideBytes;
+        for (size_t i = 0; i < row; i++) h = (h ^ p[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+// Benchmarks, one per core module. Each takes the arguments after its name.
+int BenchPipeline(int argc, char** argv);
+int BenchSlicer(int argc, char** argv);
+int BenchSlices(int argc, char** argv);
+int BenchCoalescer(int argc, char** argv);
+int BenchHandoff(int argc, char** argv);
+int BenchCapture(int argc, char** argv);
+int BenchCoherence(int argc, char** argv);
+int BenchHistogram(int argc, char** argv);
+int BenchTrace(int argc, char** argv);
+int BenchLatch(int argc, char** argv);
+int BenchChannel(int argc, char** argv);
+int BenchSwapchain(int argc, char** argv);
+int BenchEdid(int argc, char** argv);
+int BenchDeviceCache(int argc, char** argv);
+int BenchHeldFrame(int argc, char** argv);
+int BenchPresent(int argc, char** argv);
+int BenchTileHash(int argc, char** argv);
+int BenchCodec(int argc, char** argv);
+int BenchReplay(int argc, char** argv);
+int BenchReplayRing(int argc, char** argv);
+int BenchReadback(int argc, char** argv);
+int BenchPlaceholder(int argc, char** argv);
+int BenchBackends(int argc, char** argv);
+
+} // namespace rj::bench
@@ -0,0 +1,276 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/backend_probe.h"
+#include "core/mock_backend.h"
+
+namespace rj::bench {
+
+namespace {
+
+constexpr uint32_t kPlaceholderTrigger = 30;  // rj_span's PlaceholderDetector default
+
+struct ProbeRun {
+    bool haveChoice{};
+    CaptureBackend choice{};
+    int64_t durationNs{};
+    uint32_t starts{};
+    std::vector<BackendScore> scores;
+};
+
+// rj_span's render loop against simulated backends: one pass per output vblank. A pass
+// picks up the frames whose copy finished at least the script's render time before the
+// vblank, presents the newest, and feeds the probe what rj_span measures.
+ProbeRun RunProbe(const std::vector<MockBackendScript>& scripts, const BackendProbeConfig& cfg, uint32_t outputHz, uint32_t seed) {
+    ManualClock clock(0);
+    std::vector<MockCaptureBackend> backends;
+    std::vector<CaptureBackend> candidates;
+    for (size_t i = 0; i < scripts.size(); i++) {
+        backends.emplace_back(clock, scripts[i], seed + static_cast<uint32_t>(i));
+        candidates.push_back(scripts[i].backend);
+    }
+    ProbeRun run;
+    BackendProbe probe(cfg);
+    MockCaptureBackend* current = nullptr;
+    uint32_t placeholderStreak = 0;
+    // Starts whatever the probe says runs now; candidates that can't start are rejected.
+    auto switchBackend = [&]() {
+        for (MockCaptureBackend& b : backends) b.Stop();
+        current = nullptr;
+        placeholderStreak = 0;
+        while (probe.Active()) {
+            for (MockCaptureBackend& b : backends) {
+                if (b.Script().backend == probe.Current()) current = &b;
+            }
+            run.starts++;
+            if (current->Start()) return;
+            current = nullptr;
+            probe.Reject("start failed");
+            probe.Advance(clock.NowNs());
+        }
+    };
+
+    const int64_t periodNs = kNsPerSec / outputHz;
+    probe.Begin(candidates, clock.NowNs());
+    switchBackend();
+    while (probe.Active()) {
+        clock.SleepUntilNs((clock.NowNs() / periodNs + 1) * periodNs);
+        const int64_t vblankNs = clock.NowNs();
+        if (probe.Advance(vblankNs)) {
+            switchBackend();
+            continue;
+        }
+        if (!current) continue;
+        MockBackendFrame f;
+        MockBackendFrame newest;
+        bool any = false;
+        while (current->Next(vblankNs - current->Script().renderNs, f)) {
+            probe.OnFrame(vblankNs);
+            if (f.copyNs > 0) probe.OnCopies(vblankNs, 1, f.copyNs);
+            placeholderStreak = f.placeholder ? placeholderStreak + 1 : 0;
+            newest = f;
+            any = true;
+        }
+        if (any) probe.OnPresent(vblankNs, vblankNs - newest.readyNs);
+        if (placeholderStreak >= kPlaceholderTrigger) probe.Reject("placeholder frames");
+    }
+    run.haveChoice = probe.HasChoice();
+    run.choice = probe.Choice();
+    run.durationNs = clock.NowNs();
+    run.scores = probe.Scores();
+    return run;
+}
+
+MockBackendScript Script(CaptureBackend backend, double hz, int64_t copyNs) {
+    MockBackendScript s;
+    s.backend = backend;
+    s.arrivalHz = hz;
+    s.copyNs = copyNs;
+    s.arrivalJitterNs = 2 * kNsPerMs;
+    s.copyJitterNs = copyNs / 4;
+    return s;
+}
+
+struct Scenario {
+    const char* name;
+    std::vector<MockBackendScript> scripts;
+    bool expectChoice;
+    CaptureBackend expect;
+};
+
+std::vector<Scenario> MakeScenarios() {
+    constexpr CaptureBackend kWgc = CaptureBackend::Wgc;
+    constexpr CaptureBackend kWide = CaptureBackend::DdSingleWide;
+    constexpr CaptureBackend kTriple = CaptureBackend::DdTripleComposite;
+    std::vector<Scenario> s;
+    // WGC frames sampled in place beat a 600 us DD copy at the same rate.
+    s.push_back({"wgc zero-copy", {Script(kWgc, 120, 0), Script(kWide, 120, 600 * kNsPerUs)}, true, kWgc});
+    // A WGC session capped at 60 Hz loses to DD at 120 Hz whatever its copy costs.
+    s.push_back({"wgc 60 Hz cap", {Script(kWgc, 60, 0), Script(kWide, 120, 600 * kNsPerUs)}, true, kWide});
+    // WGC hands out placeholders: rejected, DD wins.
+    MockBackendScript green = Script(kWgc, 120, 0);
+    green.placeholderAfterNs = 0;
+    s.push_back({"wgc placeholders", {green, Script(kWide, 120, 600 * kNsPerUs)}, true, kWide});
+    // DD can't start (another duplication, a secure desktop): WGC.
+    MockBackendScript noDd = Script(kWide, 120, 600 * kNsPerUs);
+    noDd.startFails = true;
+    s.push_back({"dd start fails", {Script(kWgc, 120, 300 * kNsPerUs), noDd}, true, kWgc});
+    // Copies that often miss the vblank cost a frame of latency at p95.
+    MockBackendScript late = Script(kWide, 120, 5500 * kNsPerUs);
+    late.copyJitterNs = 3 * kNsPerMs;
+    s.push_back({"dd late copies", {Script(kWgc, 120, 1 * kNsPerMs), late}, true, kWgc});
+    // Three candidates: WGC at 90 Hz is dropping frames, the composite copies more.
+    s.push_back({"three candidates", {Script(kWgc, 90, 0), Script(kWide, 120, 600 * kNsPerUs), Script(kTriple, 120, 1800 * kNsPerUs)}, true, kWide});
+    // Nothing moves on screen: no measurement, no choice; rj_span keeps its default.
+    s.push_back({"static desktop", {Script(kWgc, 0, 0), Script(kWide, 0, 600 * kNsPerUs)}, false, kWgc});
+    return s;
+}
+
+bool CheckScenarios(const BackendProbeConfig& cfg, uint32_t outputHz, uint32_t seed) {
+    bool ok = true;
+    printf("  %-17s %-20s %6s %7s %8s %8s %8s %9s  %s\n", "scenario", "backend", "frames", "hz", "copy us", "p50 us", "p95 us", "cost us", "verdict");
+    for (const Scenario& sc : MakeScenarios()) {
+        const ProbeRun run = RunProbe(sc.scripts, cfg, outputHz, seed);
+        const bool good = run.haveChoice == sc.expectChoice && (!sc.expectChoice || run.choice == sc.expect) && run.scores.size() == sc.scripts.size();
+        ok = ok && good;
+        for (size_t i = 0; i < run.scores.size(); i++) {
+            const BackendScore& s = run.scores[i];
+            const bool chosen = run.haveChoice && s.backend == run.choice && !s.rejected;
+            printf("  %-17s %-20s %6llu %7.1f %8.1f %8.1f %8.1f %9.1f  %s\n",
+                   i == 0 ? sc.name : "",
+                   CaptureBackendName(s.backend),
+                   static_cast<unsigned long long>(s.frames),
+                   s.arrivalHz,
+                   s.copyAvgUs,
+                   s.latencyP50Us,
+                   s.latencyP95Us,
+                   s.costUs,
+                   s.rejected ? s.rejected : (chosen ? "chosen" : "-"));
+        }
+        printf("  %-17s probe took %.2f s, %u starts -> %s (expected %s)  %s\n",
+               "",
+               static_cast<double>(run.durationNs) / kNsPerSec,
+               run.starts,
+               run.haveChoice ? CaptureBackendName(run.choice) : "none",
+               sc.expectChoice ? CaptureBackendName(sc.expect) : "none",
+               good ? "ok" : "FAILED");
+    }
+    return ok;
+}
+
+bool CheckProbeRules(const BackendProbeConfig& cfg) {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  probe rules: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+    BackendProbe probe(cfg);
+    probe.Begin({}, 0);
+    expect(!probe.Active() && !probe.HasChoice() && !probe.Advance(0), "no candidates");
+
+    // Warm-up frames don't count, a window ends on time, Reject() ends it at once.
+    probe.Begin({CaptureBackend::Wgc, CaptureBackend::DdSingleWide}, 0);
+    int64_t t = 0;
+    for (; t < cfg.warmupNs; t += kNsPerMs) probe.OnFrame(t);
+    expect(!probe.Advance(cfg.warmupNs + cfg.windowNs - 1), "window still open");
+    for (uint32_t i = 0; i < cfg.minFrames; i++) {
+        probe.OnFrame(cfg.warmupNs + i);
+        probe.OnPresent(cfg.warmupNs + i, kNsPerMs);
+    }
+    expect(probe.Advance(cfg.warmupNs + cfg.windowNs) && probe.Active() && probe.Current() == CaptureBackend::DdSingleWide, "window closes on time");
+    expect(probe.Scores().size() == 1 && probe.Scores()[0].frames == cfg.minFrames && !probe.Scores()[0].rejected, "warm-up frames ignored");
+    probe.Reject("start failed");
+    probe.Reject("ignored");
+    const int64_t rejectedAt = cfg.warmupNs + cfg.windowNs + 1;
+    expect(probe.Advance(rejectedAt) && !probe.Active(), "reject ends the window");
+    expect(probe.Scores().size() == 2 && strcmp(probe.Scores()[1].rejected, "start failed") == 0, "first reason kept");
+    expect(probe.HasChoice() && probe.Choice() == CaptureBackend::Wgc && probe.ChosenScore() == &probe.Scores()[0], "the survivor is chosen");
+
+    // Frames but no presents: no latency to score.
+    probe.Begin({CaptureBackend::Wgc}, 0);
+    for (uint32_t i = 0; i < cfg.minFrames; i++) probe.OnFrame(cfg.warmupNs + i);
+    probe.Advance(cfg.warmupNs + cfg.windowNs);
+    expect(!probe.HasChoice() && strcmp(probe.Scores()[0].rejected, "nothing presented") == 0, "nothing presented");
+
+    probe.Begin({CaptureBackend::Wgc}, 0);
+    probe.Cancel();
+    expect(!probe.Active() && !probe.HasChoice() && !probe.Advance(kNsPerSec * 10), "cancel");
+    printf("  probe rules: warm-up, window end, reject, no presents, cancel  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+bool CheckCache() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  cache: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+    const TopologyMonitor wideSetup[4] = {{0, 0, 2560, 1440, 165}, {2560, 0, 2560, 1440, 165}, {5120, 0, 2560, 1440, 165}, {0, -1440, 7680, 1440, 120}};
+    const std::string a = TopologyKey(wideSetup, 4);
+    expect(a == "2560x1440@165(0,0);2560x1440@165(2560,0);2560x1440@165(5120,0);7680x1440@120(0,-1440)", "topology key");
+    TopologyMonitor changed[4];
+    memcpy(changed, wideSetup, sizeof(changed));
+    changed[3].hz = 144;
+    const std::string b = TopologyKey(changed, 4);
+    const std::string c = TopologyKey(wideSetup, 3);
+    expect(a != b && a != c, "a mode change is a new topology");
+
+    BackendChoiceCache cache(2);
+    BackendChoice found;
+    expect(!cache.Find(a, found), "empty");
+    cache.Store(a, {CaptureBackend::Wgc, 4100.0f});
+    cache.Store(b, {CaptureBackend::DdSingleWide, 5200.0f});
+    cache.Store(a, {CaptureBackend::DdSingleWide, 4900.0f});
+    expect(cache.Size() == 2 && cache.Find(a, found) && found.backend == CaptureBackend::DdSingleWide, "store replaces");
+    cache.Store(c, {CaptureBackend::DdTripleComposite, 6000.0f});
+    expect(cache.Size() == 2 && !cache.Find(b, found) && cache.Find(a, found) && cache.Find(c, found), "least recently stored evicted");
+
+    FILE* f = tmpfile();
+    expect(f && cache.Write(f), "write");
+    if (f) {
+        fputs("junk line\n7680x1440@120(0,0) bogus_backend 1.0\n", f);
+        rewind(f);
+        BackendChoiceCache loaded;
+        expect(loaded.Read(f) && loaded.Size() == 2, "read back, junk skipped");
+        expect(loaded.Find(c, found) && found.backend == CaptureBackend::DdTripleComposite && found.costUs == 6000.0f, "entry round-trips");
+        fclose(f);
+    }
+    f = tmpfile();
+    if (f) {
+        fputs("2560x1440@60(0,0) wgc 1.0\n", f);
+        rewind(f);
+        BackendChoiceCache loaded;
+        loaded.Store(a, {CaptureBackend::Wgc, 1.0f});
+        expect(!loaded.Read(f) && loaded.Size() == 0, "no header");
+        fclose(f);
+    }
+    expect(cache.Forget(a) && !cache.Forget(a) && !cache.Find(a, found), "forget");
+    printf("  cache: topology keys, replace, eviction, text round trip, forget  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+// Capture backend auto-selection against simulated backends with scripted timing: which
+// backend the probe picks in each scenario and why, the probe's window rules and the
+// per-topology choice cache.
+int BenchBackends(int argc, char** argv) {
+    BackendProbeConfig cfg;
+    cfg.warmupNs = static_cast<int64_t>(ArgInt(argc, argv, "--warmup-ms", 300)) * kNsPerMs;
+    cfg.windowNs = static_cast<int64_t>(ArgInt(argc, argv, "--window-ms", 1500)) * kNsPerMs;
+    cfg.minFrames = static_cast<uint32_t>(ArgInt(argc, argv, "--min-frames", 30));
+    const uint32_t hz = static_cast<uint32_t>(ArgInt(argc, argv, "--hz", 120));
+    const uint32_t seed = static_cast<uint32_t>(ArgInt(argc, argv, "--seed", 1));
+    printf("[rj_bench] backends: warm-up %lld ms, window %lld ms, outputs at %u Hz\n",
+           static_cast<long long>(cfg.warmupNs / kNsPerMs),
+           static_cast<long long>(cfg.windowNs / kNsPerMs),
+           hz);
+    bool ok = CheckScenarios(cfg, hz, seed);
+    ok = CheckProbeRules(cfg) && ok;
+    ok = CheckCache() && ok;
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/pipeline.h"
+#include "core/sinks.h"
+#include "core/synthetic_source.h"
+
+namespace rj::bench {
+
+namespace {
+
+struct CaptureRunConfig {
+    double seconds{};
+    uint32_t sourceHz{};
+    uint32_t vsyncHz{};
+    bool paced{};
+    uint32_t tiles{};
+    uint32_t outputs{};
+    uint32_t width{};
+    uint32_t height{};
+    int64_t acquireCostNs{};
+    int64_t presentCostNs{};
+    bool cpuPixels{};
+    uint32_t depth{};
+    int64_t phaseNs{};      // vblank phase step between tiles
+    int64_t slowTileNs{};   // extra acquire cost of the last tile
+    CoherenceConfig coherence{};
+
+    enum class Mode { Serial, Threaded, Parallel } mode{};
+};
+
+const char* ModeName(CaptureRunConfig::Mode m) {
+    switch (m) {
+        case CaptureRunConfig::Mode::Serial:
+            return "serial";
+        case CaptureRunConfig::Mode::Threaded:
+            return "threaded";
+        case CaptureRunConfig::Mode::Parallel:
+            return "parallel";
+    }
+    return "?";
+}
+
+struct CaptureRunResult {
+    double fps{};
+    double newFps{};
+    double latencyAvgUs{};
+    double latencyMaxUs{};
+    uint64_t stalls{};
+    uint64_t superseded{};
+    TileSkewStats skew{};
+    bool verified{true};
+};
+
+// After the last frame, the wide buffer must equal the tiles' latest content. Tiles whose
+// newest frame was acquired by a parallel worker but never published are skipped.
+bool VerifyComposite(const FramePipeline& pipeline, const std::vector<std::unique_ptr<SyntheticSource>>& sources) {
+    const FrameDesc& cur = pipeline.CurrentFrame();
+    if (!cur.pixels) return true;
+    for (size_t m = 0; m < sources.size(); m++) {
+        if (pipeline.UnpublishedTilesAtStop() & (1u << m)) continue;
+        const std::vector<uint8_t>& tile = sources[m]->Pixels();
+        const size_t rowBytes = static_cast<size_t>(cur.width / sources.size()) * 4u;
+        for (uint32_t y = 0; y < cur.height; y++) {
+            if (std::memcmp(cur.pixels + static_cast<size_t>(y) * cur.strideBytes + rowBytes * m, tile.data() + rowBytes * y, rowBytes) != 0) return false;
+        }
+    }
+    return true;
+}
+
+CaptureRunResult RunCapture(const CaptureRunConfig& c) {
+    SteadyClock clock;
+    PipelineConfig pcfg;
+    pcfg.outputWidth = c.width / c.outputs;
+    pcfg.outputHeight = c.height;
+    pcfg.paced = c.paced;
+    pcfg.vsyncHz = c.vsyncHz;
+    pcfg.captureThread = c.mode != CaptureRunConfig::Mode::Serial;
+    pcfg.captureThreadCfg.queueDepth = c.depth;
+    pcfg.parallelTiles = c.mode == CaptureRunConfig::Mode::Parallel;
+    pcfg.tileAcquireCfg.coherence = c.coherence;
+    FramePipeline pipeline(clock, pcfg);
+
+    std::vector<std::unique_ptr<SyntheticSource>> sources;
+    for (uint32_t t = 0; t < c.tiles; t++) {
+        SyntheticSourceConfig scfg;
+        scfg.width = c.width / c.tiles;
+        scfg.height = c.height;
+        scfg.hz = c.sourceHz;
+        scfg.patternWidth = c.width;
+        scfg.originX = scfg.width * t;
+        scfg.cpuPixels = c.cpuPixels;
+        scfg.acquireCostNs = c.acquireCostNs / c.tiles + (t + 1 == c.tiles ? c.slowTileNs : 0);
+        scfg.phaseNs = c.phaseNs * t;
+        sources.push_back(std::make_unique<SyntheticSource>(clock, scfg));
+        pipeline.AddSource(*sources.back());
+    }
+    std::vector<std::unique_ptr<NullSink>> sinks;
+    for (uint32_t i = 0; i < c.outputs; i++) {
+        sinks.push_back(std::make_unique<NullSink>(&clock, c.presentCostNs / c.outputs));
+        pipeline.AddSink(*sinks.back());
+    }
+
+    const int64_t start = clock.NowNs();
+    const int64_t end = start + static_cast<int64_t>(c.seconds * 1e9);
+    while (clock.NowNs() < end) pipeline.RunFrame();
+    const double elapsed = static_cast<double>(clock.NowNs() - start) / 1e9;
+
+    CaptureRunResult r;
+    r.fps = static_cast<double>(pipeline.RenderedFrames()) / elapsed;
+    r.newFps = static_cast<double>(pipeline.CopiedFrames()) / elapsed;
+    r.latencyAvgUs = pipeline.Latency().AvgUs();
+    r.latencyMaxUs = NsToUs(pipeline.Latency().maxNs);
+    if (const CaptureThread* t = pipeline.Thread()) {
+        r.stalls = t->QueueFullStalls();
+        r.superseded = t->FramesSuperseded();
+        r.skew = pipeline.TakeTileSkew();
+        pipeline.Stop();
+        pipeline.RunFrame();  // pick up whatever the thread queued last
+        r.verified = VerifyComposite(pipeline, sources);
+    } else {
+        r.verified = VerifyComposite(pipeline, sources);
+    }
+    return r;
+}
+
+// With the render thread not taking frames, exactly queueDepth frames wait and the capture
+// thread stalls instead of acquiring more.
+bool CheckQueueDepth(uint32_t depth) {
+    SteadyClock clock;
+    CaptureThreadConfig cfg;
+    cfg.queueDepth = depth;
+    CaptureThread thread(clock, cfg);
+    thread.Start([](uint32_t, uint32_t, CapturedFrame&) { return AcquireResult::NewFrame; });
+    auto settle = [] { std::this_thread::sleep_for(std::chrono::milliseconds(30)); };
+
+    settle();
+    const uint64_t queued = thread.FramesCaptured();
+    CapturedFrame f;
+    const bool took = thread.TakeLatest(f);
+    settle();
+    const uint64_t refilled = thread.FramesCaptured() - queued;
+    const uint64_t stalls = thread.QueueFullStalls();
+    thread.Stop();
+
+    const bool ok = queued == depth && took && thread.FramesSuperseded() == depth - 1 && refilled == depth && stalls > 0;
+    printf("  queue depth %u: %llu queued, %llu after a take, %llu stalls  %s\n", depth, static_cast<unsigned long long>(queued),
+           static_cast<unsigned long long>(refilled), static_cast<unsigned long long>(stalls), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+// Serial capture (acquire + copy inside RunFrame, like RenderFrame()) against a dedicated
+// capture thread feeding a bounded queue, and against per-tile acquire workers behind a
+// coherence policy, on the real clock. Acquire and present costs are slept, so they model
+// time spent blocked in DXGI rather than CPU work.
+int BenchCapture(int argc, char** argv) {
+    CaptureRunConfig c;
+    c.seconds = ArgDouble(argc, argv, "--seconds", 2.0);
+    c.sourceHz = static_cast<uint32_t>(ArgInt(argc, argv, "--hz", 120));
+    c.vsyncHz = static_cast<uint32_t>(ArgInt(argc, argv, "--vsync-hz", 120));
+    c.paced = !ArgFlag(argc, argv, "--unpaced");
+    c.tiles = static_cast<uint32_t>(ArgInt(argc, argv, "--tiles", 3));
+    c.outputs = static_cast<uint32_t>(ArgInt(argc, argv, "--outputs", 3));
+    c.width = static_cast<uint32_t>(ArgInt(argc, argv, "--width", 7680));
+    c.height = static_cast<uint32_t>(ArgInt(argc, argv, "--height", 1440));
+    c.acquireCostNs = ArgInt(argc, argv, "--acquire-cost-us", 3000) * kNsPerUs;
+    c.presentCostNs = ArgInt(argc, argv, "--present-cost-us", 4000) * kNsPerUs;
+    c.cpuPixels = !ArgFlag(argc, argv, "--no-pixels");
+    c.depth = static_cast<uint32_t>(ArgInt(argc, argv, "--depth", 2));
+    c.phaseNs = ArgInt(argc, argv, "--phase-us", 0) * kNsPerUs;
+    c.slowTileNs = ArgInt(argc, argv, "--slow-tile-us", 0) * kNsPerUs;
+    if (!ParseCoherencePolicy(ArgStr(argc, argv, "--coherence", "window"), c.coherence.policy)) {
+        fprintf(stderr, "--coherence must be all, window or partial\n");
+        return 2;
+    }
+    c.coherence.windowNs = ArgInt(argc, argv, "--window-us", 4000) * kNsPerUs;
+
+    printf("[rj_bench] capture source=%u Hz %s tiles=%u acquire=%.1f ms (+%.1f ms last tile) present=%.1f ms pixels=%s coherence=%s\n",
+           c.sourceHz, c.paced ? "paced" : "unpaced", c.tiles, NsToMs(c.acquireCostNs), NsToMs(c.slowTileNs), NsToMs(c.presentCostNs),
+           c.cpuPixels ? "on" : "off", CoherencePolicyName(c.coherence.policy));
+
+    bool ok = CheckQueueDepth(std::max(c.depth, 1u));
+    const CaptureRunConfig::Mode modes[] = {CaptureRunConfig::Mode::Serial, CaptureRunConfig::Mode::Threaded, CaptureRunConfig::Mode::Parallel};
+    for (CaptureRunConfig::Mode mode : modes) {
+        if (mode == CaptureRunConfig::Mode::Parallel && c.tiles < 2) continue;
+        c.mode = mode;
+        const CaptureRunResult r = RunCapture(c);
+        ok = ok && r.verified;
+        printf("  %-8s render=%6.1f fps  new=%6.1f fps  capture->present avg=%7.0f us max=%7.0f us  stalls=%llu superseded=%llu  %s\n",
+               ModeName(mode),
+               r.fps,
+               r.newFps,
+               r.latencyAvgUs,
+               r.latencyMaxUs,
+               static_cast<unsigned long long>(r.stalls),
+               static_cast<unsigned long long>(r.superseded),
+               r.verified ? "verified" : "MISMATCH");
+        if (r.skew.publishes > 0) {
+            printf("           tile skew avg=%6.0f us max=%6.0f us  wait avg=%6.0f us  incomplete=%.1f%%\n",
+                   r.skew.AvgSkewUs(),
+                   NsToUs(r.skew.skewMaxNs),
+                   r.skew.AvgWaitUs(),
+                   100.0 * static_cast<double>(r.skew.incomplete) / static_cast<double>(r.skew.publishes));
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,286 @@
+#include <memory>
+#include <thread>
+
+#include "bench/bench.h"
+#include "core/frame_channel.h"
+#include "core/latency_histogram.h"
+#include "core/shared_memory.h"
+
+#if defined(_WIN32)
+#include <atomic>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace rj::bench {
+
+namespace {
+
+struct ChannelBenchConfig {
+    std::string name;
+    uint32_t width{};
+    uint32_t height{};
+    uint64_t frames{};
+    uint32_t hz{};  // 0 = as fast as possible
+};
+
+uint64_t PatternWord(uint64_t frameId, uint64_t i) {
+    return (frameId * 0x9E3779B97F4A7C15ull) ^ i;
+}
+
+// The dirty rect each frame reports, derived from its id so the consumer can check it.
+Rect DirtyRectFor(uint64_t frameId, uint32_t width, uint32_t height) {
+    Rect r;
+    r.left = static_cast<int32_t>(frameId % (width / 2));
+    r.top = static_cast<int32_t>(frameId % (height / 2));
+    r.right = r.left + 64;
+    r.bottom = r.top + 32;
+    return r;
+}
+
+// Stand-in for the driver's swapchain processor: opens the channel by name in its own
+// mapping, adopts the layout and publishes `frames` frames with a checkable payload.
+int RunProducer(const ChannelBenchConfig& c) {
+    SharedMemory mem;
+    FrameChannelProducer producer;
+    const size_t payload = static_cast<size_t>(c.width) * c.height * 4u;
+    if (!mem.Open(c.name.c_str()) || !producer.Init(mem.Data(), mem.Size(), payload)) return 2;
+
+    const int64_t periodNs = c.hz ? kNsPerSec / c.hz : 0;
+    const int64_t start = HostNowNs();
+    const size_t words = payload / sizeof(uint64_t);
+    for (uint64_t f = 1; f <= c.frames; f++) {
+        if (periodNs) {
+            const int64_t due = start + static_cast<int64_t>(f) * periodNs;
+            while (HostNowNs() < due) std::this_thread::yield();
+        }
+        auto* p = reinterpret_cast<uint64_t*>(producer.Payload(producer.WriteSlot()));
+        for (size_t i = 0; i < words; i++) p[i] = PatternWord(f, i);
+
+        ChannelFrameInfo info;
+        info.frameId = f;
+        info.width = c.width;
+        info.height = c.height;
+        info.format = PixelFormat::Bgra8;
+        info.strideBytes = c.width * 4u;
+        info.dirtyRectCount = 1;
+        info.dirtyRects[0] = DirtyRectFor(f, c.width, c.height);
+        info.presentTimeNs = HostNowNs();
+        info.publishTimeNs = info.presentTimeNs;
+        producer.Publish(info);
+        producer.Heartbeat(info.publishTimeNs);
+    }
+    return 0;
+}
+
+// A producer in another process (a thread where fork() isn't available).
+class ProducerProcess {
+public:
+    explicit ProducerProcess(const ChannelBenchConfig& c) {
+#if defined(_WIN32)
+        m_thread = std::thread([this, c] {
+            m_rc = RunProducer(c);
+            m_done.store(true, std::memory_order_release);
+        });
+#else
+        m_pid = fork();
+        if (m_pid == 0) _exit(RunProducer(c));
+#endif
+    }
+
+    ~ProducerProcess() {
+        int rc = 0;
+        while (!Done(rc)) std::this_thread::yield();
+    }
+
+    bool Started() const {
+#if defined(_WIN32)
+        return true;
+#else
+        return m_pid > 0;
+#endif
+    }
+
+    // True once the producer exited; `rc` is its exit code.
+    bool Done(int& rc) {
+#if defined(_WIN32)
+        if (!m_done.load(std::memory_order_acquire)) return false;
+        if (m_thread.joinable()) m_thread.join();
+        rc = m_rc;
+        return true;
+#else
+        if (m_pid <= 0) {
+            rc = m_rc;
+            return true;
+        }
+        int status = 0;
+        if (waitpid(m_pid, &status, WNOHANG) != m_pid) return false;
+        m_rc = WIFEXITED(status) ? WEXITSTATUS(status) : 3;
+        m_pid = -1;
+        rc = m_rc;
+        return true;
+#endif
+    }
+
+private:
+#if defined(_WIN32)
+    std::thread m_thread;
+    std::atomic<bool> m_done{false};
+#else
+    pid_t m_pid{-1};
+#endif
+    int m_rc{};
+};
+
+struct ConsumeResult {
+    std::unique_ptr<LatencyHistogram> latency = std::make_unique<LatencyHistogram>();
+    uint64_t frames{};
+    uint64_t lastFrameId{};
+    uint64_t badPayload{};
+    uint64_t badHeader{};
+    uint64_t outOfOrder{};
+    uint64_t invalidated{};
+    int producerRc{};
+};
+
+void CheckCurrent(const FrameChannelConsumer& consumer, const ChannelBenchConfig& c, uint64_t prevId, ConsumeResult& r) {
+    const ChannelFrameInfo& info = consumer.Current();
+    r.frames++;
+    if (info.frameId <= prevId) r.outOfOrder++;
+    if (info.width != c.width || info.height != c.height || info.strideBytes != c.width * 4u) r.badHeader++;
+    if (info.dirtyRectCount == 1) {
+        const Rect want = DirtyRectFor(info.frameId, c.width, c.height);
+        const Rect& got = info.dirtyRects[0];
+        if (got.left != want.left || got.top != want.top || got.right != want.right || got.bottom != want.bottom) r.badHeader++;
+        if (prevId == 0 || info.frameId != prevId + 1) r.badHeader++;  // a skip must widen damage to the whole frame
+    }
+    const auto* p = reinterpret_cast<const uint64_t*>(consumer.Payload());
+    const size_t words = static_cast<size_t>(c.width) * c.height;  // 4-byte pixels, checked as pairs
+    bool ok = true;
+    for (size_t i = 0; i < words / 2; i++) {
+        if (p[i] != PatternWord(info.frameId, i)) {
+            ok = false;
+            break;
+        }
+    }
+    if (!consumer.StillValid()) {
+        r.invalidated++;
+    } else if (!ok) {
+        r.badPayload++;
+    }
+}
+
+// Consumes until the producer exits and the last frame was picked up.
+ConsumeResult Consume(FrameChannelConsumer& consumer, const ChannelBenchConfig& c) {
+    ConsumeResult r;
+    ProducerProcess producer(c);
+    if (!producer.Started()) {
+        r.producerRc = 4;
+        return r;
+    }
+    uint64_t prevId = 0;
+    bool done = false;
+    for (;;) {
+        if (consumer.Update()) {
+            r.latency->Record(HostNowNs() - consumer.Current().publishTimeNs);
+            CheckCurrent(consumer, c, prevId, r);
+            prevId = consumer.Current().frameId;
+            continue;
+        }
+        if (done) break;
+        done = producer.Done(r.producerRc);
+        std::this_thread::yield();
+    }
+    r.lastFrameId = prevId;
+    return r;
+}
+
+bool PrintConsume(const char* label, const ConsumeResult& r, const FrameChannelConsumer& consumer, uint64_t produced, uint64_t skippedBefore) {
+    const LatencyPercentiles p = SummarizeLatency(*r.latency);
+    const bool ok = r.producerRc == 0 && r.frames > 0 && r.lastFrameId == produced && r.badPayload == 0 && r.badHeader == 0 && r.outOfOrder == 0 &&
+                    r.invalidated == 0;
+    printf("  %-18s gen=%u produced=%llu consumed=%llu skipped=%llu publish->consume(us) p50=%.0f p99=%.0f max=%.0f  bad payload=%llu header=%llu order=%llu invalidated=%llu  %s\n",
+           label,
+           consumer.Generation(),
+           static_cast<unsigned long long>(produced),
+           static_cast<unsigned long long>(r.frames),
+           static_cast<unsigned long long>(consumer.SkippedFrames() - skippedBefore),
+           p.p50Us,
+           p.p99Us,
+           p.maxUs,
+           static_cast<unsigned long long>(r.badPayload),
+           static_cast<unsigned long long>(r.badHeader),
+           static_cast<unsigned long long>(r.outOfOrder),
+           static_cast<unsigned long long>(r.invalidated),
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+// Frame channel stress between processes: a paced producer, then a restarted unpaced one
+// under the same consumer, checking payload integrity, frame order and dirty info, plus
+// publish->consume latency and a late attach to an idle channel.
+int BenchChannel(int argc, char** argv) {
+    ChannelBenchConfig c;
+    c.width = static_cast<uint32_t>(ArgInt(argc, argv, "--width", 1280));
+    c.height = static_cast<uint32_t>(ArgInt(argc, argv, "--height", 720));
+    c.frames = static_cast<uint64_t>(ArgInt(argc, argv, "--frames", 480));
+    c.hz = static_cast<uint32_t>(ArgInt(argc, argv, "--hz", 240));
+    char name[64];
+    snprintf(name, sizeof(name), "rj_bench_channel_%lld", static_cast<long long>(HostNowNs() % 1000000007));
+    c.name = name;
+
+    printf("[rj_bench] channel %ux%u frames=%llu per producer, paced at %u Hz then unpaced\n",
+           c.width,
+           c.height,
+           static_cast<unsigned long long>(c.frames),
+           c.hz);
+
+    SharedMemory mem;
+    FrameChannelProducer creator;
+    const size_t payload = static_cast<size_t>(c.width) * c.height * 4u;
+    if (!mem.Create(c.name.c_str(), FrameChannelBytes(payload)) || !creator.Init(mem.Data(), mem.Size(), payload)) {
+        printf("  cannot create shared memory '%s'\n", c.name.c_str());
+        return 1;
+    }
+    FrameChannelConsumer consumer;
+    if (!consumer.Attach(mem.Data(), mem.Size())) {
+        printf("  cannot attach\n");
+        SharedMemory::Unlink(c.name.c_str());
+        return 1;
+    }
+
+    bool ok = true;
+    const ConsumeResult paced = Consume(consumer, c);
+    ok = PrintConsume("paced producer", paced, consumer, c.frames, 0) && ok;
+
+    // Restart: a new producer adopts the layout while the consumer holds its slot.
+    const uint32_t genBefore = consumer.Generation();
+    const uint64_t skippedBefore = consumer.SkippedFrames();
+    ChannelBenchConfig unpaced = c;
+    unpaced.hz = 0;
+    const ConsumeResult restarted = Consume(consumer, unpaced);
+    ok = PrintConsume("restarted unpaced", restarted, consumer, c.frames, skippedBefore) && ok;
+    const bool genOk = consumer.Generation() == genBefore + 1;
+    ok = ok && genOk && consumer.TornReads() == 0;
+
+    // A consumer attaching to an idle channel still gets the last frame.
+    consumer.Detach();
+    FrameChannelConsumer late;
+    const bool attached = late.Attach(mem.Data(), mem.Size());
+    if (attached) late.Update();
+    const bool lateOk = attached && late.Current().frameId == c.frames;
+    printf("  generation bump on restart %s, torn headers=%llu, late attach sees frame %llu  %s\n",
+           genOk ? "ok" : "missing",
+           static_cast<unsigned long long>(consumer.TornReads()),
+           static_cast<unsigned long long>(late.Current().frameId),
+           lateOk ? "ok" : "FAILED");
+    ok = ok && lateOk;
+
+    SharedMemory::Unlink(c.name.c_str());
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,215 @@
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/rect_coalescer.h"
+
+namespace rj::bench {
+
+namespace {
+
+struct RectFrame {
+    std::vector<MoveRect> moves;
+    std::vector<Rect> dirty;
+};
+
+// Rect stream file: one directive per line.
+//   f                       start a new frame
+//   d left top right bottom dirty rect
+//   m srcX srcY left top right bottom   move rect
+bool LoadStream(const char* path, std::vector<RectFrame>& frames) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) return false;
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        Rect r{};
+        MoveRect m{};
+        if (line[0] == 'f') {
+            frames.emplace_back();
+        } else if (sscanf(line, "d %d %d %d %d", &r.left, &r.top, &r.right, &r.bottom) == 4) {
+            if (frames.empty()) frames.emplace_back();
+            frames.back().dirty.push_back(r);
+        } else if (sscanf(line, "m %d %d %d %d %d %d", &m.srcX, &m.srcY, &m.dst.left, &m.dst.top, &m.dst.right, &m.dst.bottom) == 6) {
+            if (frames.empty()) frames.emplace_back();
+            frames.back().moves.push_back(m);
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+// Synthetic streams shaped like what DD reports for common desktop/game workloads on one
+// 2560x1440 monitor.
+void GenerateStream(const char* kind, uint32_t w, uint32_t h, uint32_t count, std::vector<RectFrame>& frames) {
+    std::mt19937 rng(42);
+    auto rnd = [&](int32_t lo, int32_t hi) { return std::uniform_int_distribution<int32_t>(lo, hi)(rng); };
+    const int32_t W = static_cast<int32_t>(w);
+    const int32_t H = static_cast<int32_t>(h);
+    int32_t caretX = 400;
+    int32_t caretY = 300;
+    for (uint32_t f = 0; f < count; f++) {
+        RectFrame fr;
+        if (strcmp(kind, "typing") == 0) {
+            // Caret blink plus a freshly typed glyph, now and then a toolbar repaint.
+            caretX += 9;
+            if (caretX > 1600) {
+                caretX = 400;
+                caretY += 22;
+                if (caretY > 1200) caretY = 300;
+            }
+            fr.dirty.push_back(Rect{caretX - 9, caretY, caretX + 2, caretY + 20});
+            if (f % 30 == 0) fr.dirty.push_back(Rect{0, 0, W, 48});
+        } else if (strcmp(kind, "scroll") == 0) {
+            // Browser-style scroll: content moves up 40px, the exposed strip is redrawn.
+            const Rect view{300, 120, 1800, 1320};
+            fr.moves.push_back(MoveRect{view.left, view.top + 40, Rect{view.left, view.top, view.right, view.bottom - 40}});
+            fr.dirty.push_back(Rect{view.left, view.bottom - 40, view.right, view.bottom});
+            fr.dirty.push_back(Rect{view.right, view.top, view.right + 16, view.bottom});  // scrollbar
+        } else if (strcmp(kind, "windows") == 0) {
+            // Dragging a 900x600 window: old position exposed, window moved.
+            const int32_t x = 200 + static_cast<int32_t>(f % 100) * 8;
+            const int32_t y = 200 + static_cast<int32_t>(f % 50) * 4;
+            fr.moves.push_back(MoveRect{x - 8, y - 4, Rect{x, y, x + 900, y + 600}});
+            fr.dirty.push_back(Rect{x - 8, y - 4, x + 900, y});
+            fr.dirty.push_back(Rect{x - 8, y, x, y + 600});
+        } else if (strcmp(kind, "video") == 0) {
+            fr.dirty.push_back(Rect{640, 360, 1920, 1080});
+            if (f % 8 == 0) fr.dirty.push_back(Rect{640, 1080, 1920, 1130});  // seek bar
+        } else {
+            // "hud": a light game / launcher with a few animated widgets and scattered updates.
+            fr.dirty.push_back(Rect{40, 40, 360, 100});
+            fr.dirty.push_back(Rect{W - 420, H - 160, W - 40, H - 40});
+            for (int i = 0; i < 6; i++) {
+                const int32_t x = rnd(0, W - 64);
+                const int32_t y = rnd(0, H - 64);
+                fr.dirty.push_back(Rect{x, y, x + rnd(8, 64), y + rnd(8, 64)});
+            }
+        }
+        frames.push_back(std::move(fr));
+    }
+}
+
+// Applies DD semantics (moves from the previous frame, then dirty content) to `prev` to
+// produce the expected next frame, and separately applies the coalescer's plan; both must
+// agree wherever the plan claims to be complete.
+bool VerifyStream(const std::vector<RectFrame>& frames, uint32_t w, uint32_t h) {
+    std::vector<uint32_t> truth(static_cast<size_t>(w) * h);
+    std::mt19937 rng(7);
+    for (auto& p : truth) p = rng();
+    std::vector<uint32_t> composed = truth;
+    std::vector<uint32_t> prev;
+    RectCoalescer coalescer;
+    coalescer.Resize(w, h);
+
+    for (size_t f = 0; f < frames.size(); f++) {
+        const RectFrame& fr = frames[f];
+        prev = truth;
+        for (const MoveRect& m : fr.moves) {
+            for (int32_t y = 0; y < m.dst.Height(); y++) {
+                for (int32_t x = 0; x < m.dst.Width(); x++) {
+                    truth[static_cast<size_t>(m.dst.top + y) * w + static_cast<size_t>(m.dst.left + x)] =
+                        prev[static_cast<size_t>(m.srcY + y) * w + static_cast<size_t>(m.srcX + x)];
+                }
+            }
+        }
+        const uint32_t stamp = static_cast<uint32_t>(f) * 2654435761u;
+        for (const Rect& d : fr.dirty) {
+            const Rect c = IntersectRect(d, Rect{0, 0, static_cast<int32_t>(w), static_cast<int32_t>(h)});
+            for (int32_t y = c.top; y < c.bottom; y++) {
+                for (int32_t x = c.left; x < c.right; x++) truth[static_cast<size_t>(y) * w + static_cast<size_t>(x)] = stamp ^ static_cast<uint32_t>(x * 31 + y);
+            }
+        }
+
+        const CompositePlan& plan = coalescer.Build(fr.moves.data(), static_cast<uint32_t>(fr.moves.size()), fr.dirty.data(), static_cast<uint32_t>(fr.dirty.size()));
+        if (plan.fullCopy) {
+            composed = truth;
+            continue;
+        }
+        for (const BlitOp& b : plan.moves) {
+            for (int32_t y = 0; y < b.src.Height(); y++) {
+                std::memmove(&composed[static_cast<size_t>(b.dstY + y) * w + static_cast<size_t>(b.dstX)],
+                             &composed[static_cast<size_t>(b.src.top + y) * w + static_cast<size_t>(b.src.left)],
+                             static_cast<size_t>(b.src.Width()) * 4u);
+            }
+        }
+        for (const Rect& c : plan.copies) {
+            for (int32_t y = c.top; y < c.bottom; y++) {
+                std::memcpy(&composed[static_cast<size_t>(y) * w + static_cast<size_t>(c.left)],
+                            &truth[static_cast<size_t>(y) * w + static_cast<size_t>(c.left)], static_cast<size_t>(c.Width()) * 4u);
+            }
+        }
+        if (composed != truth) {
+            printf("  verify: mismatch at frame %zu\n", f);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// Measures coalescing cost and the copy bandwidth saved versus copying every acquired tile
+// whole. Streams come from --stream=<file> or a synthetic --workload.
+int BenchCoalescer(int argc, char** argv) {
+    const uint32_t w = static_cast<uint32_t>(ArgInt(argc, argv, "--width", 2560));
+    const uint32_t h = static_cast<uint32_t>(ArgInt(argc, argv, "--height", 1440));
+    const uint32_t count = static_cast<uint32_t>(ArgInt(argc, argv, "--frames", 2000));
+    const char* stream = ArgStr(argc, argv, "--stream", nullptr);
+    const bool verify = !ArgFlag(argc, argv, "--no-verify");
+
+    std::vector<const char*> kinds;
+    if (stream) {
+        kinds.push_back(stream);
+    } else {
+        const char* only = ArgStr(argc, argv, "--workload", nullptr);
+        if (only) {
+            kinds.push_back(only);
+        } else {
+            kinds = {"typing", "scroll", "windows", "video", "hud"};
+        }
+    }
+
+    int failures = 0;
+    printf("[rj_bench] coalescer tile=%ux%u\n", w, h);
+    for (const char* kind : kinds) {
+        std::vector<RectFrame> frames;
+        if (stream) {
+            if (!LoadStream(stream, frames)) {
+                printf("  cannot read %s\n", stream);
+                return 1;
+            }
+        } else {
+            GenerateStream(kind, w, h, count, frames);
+        }
+
+        RectCoalescer coalescer;
+        coalescer.Resize(w, h);
+        uint64_t copied = 0;
+        uint64_t ops = 0;
+        uint64_t fulls = 0;
+        const int64_t t0 = HostNowNs();
+        for (const RectFrame& fr : frames) {
+            const CompositePlan& plan = coalescer.Build(fr.moves.data(), static_cast<uint32_t>(fr.moves.size()), fr.dirty.data(), static_cast<uint32_t>(fr.dirty.size()));
+            copied += plan.copiedPixels;
+            ops += plan.fullCopy ? 1 : plan.moves.size() + plan.copies.size();
+            fulls += plan.fullCopy ? 1 : 0;
+        }
+        const double nsPerFrame = static_cast<double>(HostNowNs() - t0) / static_cast<double>(frames.size());
+        const double full = static_cast<double>(w) * h * static_cast<double>(frames.size());
+        const bool ok = !verify || VerifyStream(frames, w, h);
+        if (!ok) failures++;
+        printf("  %-8s %6.2f us/frame  copy=%6.2f%% of full (%5.1fx less)  ops/frame=%.1f  full_copies=%llu  %s\n",
+               stream ? "file" : kind,
+               nsPerFrame / 1000.0,
+               100.0 * static_cast<double>(copied) / full,
+               copied ? full / static_cast<double>(copied) : 0.0,
+               static_cast<double>(ops) / static_cast<double>(frames.size()),
+               static_cast<unsigned long long>(fulls),
+               verify ? (ok ? "verified" : "MISMATCH") : "");
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/frame_codec.h"
+#include "core/tile_hash.h"
+
+namespace rj::bench {
+
+namespace {
+
+enum class Content {
+    Static,    // the same frame every time
+    Desktop,   // flat windows and text, one 512x256 region redrawn per frame
+    Gradient,  // a smooth full-frame gradient that shifts every frame
+    Noise,     // random bytes every frame
+};
+
+const char* ContentName(Content c) {
+    switch (c) {
+    case Content::Static: return "static";
+    case Content::Desktop: return "desktop";
+    case Content::Gradient: return "gradient";
+    case Content::Noise: return "noise";
+    }
+    return "?";
+}
+
+void FillRandom(std::vector<uint8_t>& px, uint32_t seed) {
+    std::mt19937 rng(seed);
+    for (size_t i = 0; i + 4 <= px.size(); i += 4) {
+        const uint32_t v = rng();
+        std::memcpy(px.data() + i, &v, 4);
+    }
+}
+
+void FillGradient(std::vector<uint8_t>& px, uint32_t stride, uint32_t w, uint32_t h, uint32_t shift) {
+    for (uint32_t y = 0; y < h; y++) {
+        uint8_t* row = px.data() + static_cast<size_t>(y) * stride;
+        for (uint32_t x = 0; x < w; x++) {
+            row[x * 4u + 0] = static_cast<uint8_t>((x + shift) / 8);
+            row[x * 4u + 1] = static_cast<uint8_t>((y + shift) / 4);
+            row[x * 4u + 2] = static_cast<uint8_t>((x + y) / 16);
+            row[x * 4u + 3] = 0xFF;
+        }
+    }
+}
+
+// Window-like flat rects with dark "text": short runs of a few pixels on every other row.
+void DrawDesktop(std::vector<uint8_t>& px, uint32_t stride, uint32_t x0, uint32_t y0, uint32_t w, uint32_t h, uint32_t seed) {
+    std::mt19937 rng(seed);
+    const uint32_t bg = 0xFF000000u | (rng() & 0x3F3F3Fu) | 0xC0C0C0u;
+    for (uint32_t y = y0; y < y0 + h; y++) {
+        uint8_t* row = px.data() + static_cast<size_t>(y) * stride;
+        for (uint32_t x = x0; x < x0 + w; x++) std::memcpy(row + x * 4u, &bg, 4);
+        if ((y - y0) % 16 < 10 && (y - y0) % 2 == 0) {
+            for (uint32_t x = x0 + 8; x + 6 < x0 + w; x += 7 + rng() % 4) {
+                const uint32_t ink = 0xFF202020u | (rng() & 0x0F0F0Fu);
+                for (uint32_t i = 0; i < 1 + rng() % 4; i++) std::memcpy(row + (x + i) * 4u, &ink, 4);
+            }
+        }
+    }
+}
+
+class ContentSource {
+public:
+    ContentSource(Content content, uint32_t w, uint32_t h) : m_content(content), m_w(w), m_h(h), m_px(static_cast<size_t>(w) * h * 4u) {
+        if (content == Content::Gradient) {
+            FillGradient(m_px, w * 4u, w, h, 0);
+        } else if (content == Content::Noise) {
+            FillRandom(m_px, 1);
+        } else {
+            for (uint32_t y = 0; y < h; y += 256) DrawDesktop(m_px, w * 4u, 0, y, w, std::min(256u, h - y), y + 1);
+        }
+    }
+
+    const std::vector<uint8_t>& Next() {
+        m_frame++;
+        switch (m_content) {
+        case Content::Static: break;
+        case Content::Desktop: {
+            const uint32_t rw = std::min(512u, m_w);
+            const uint32_t rh = std::min(256u, m_h);
+            DrawDesktop(m_px, m_w * 4u, (m_frame * 136) % (m_w - rw + 1), (m_frame * 40) % (m_h - rh + 1), rw, rh, m_frame);
+            break;
+        }
+        case Content::Gradient: FillGradient(m_px, m_w * 4u, m_w, m_h, m_frame); break;
+        case Content::Noise: FillRandom(m_px, m_frame + 1); break;
+        }
+        return m_px;
+    }
+
+private:
+    Content m_content;
+    uint32_t m_w;
+    uint32_t m_h;
+    uint32_t m_frame{};
+    std::vector<uint8_t> m_px;
+};
+
+bool RoundTrip(FrameEncoder& enc, FrameDecoder& dec, const std::vector<uint8_t>& px, uint32_t stride, uint32_t w, uint32_t h, std::vector<uint8_t>& data, EncodeStats* stats = nullptr) {
+    if (!enc.Encode(px.data(), stride, w, h, data, stats) || !dec.Decode(data.data(), data.size())) return false;
+    for (uint32_t y = 0; y < h; y++) {
+        if (std::memcmp(dec.Frame().data() + static_cast<size_t>(y) * w * 4u, px.data() + static_cast<size_t>(y) * stride, static_cast<size_t>(w) * 4u) != 0) return false;
+    }
+    return true;
+}
+
+bool CheckCodec() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  codec: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+
+    // Odd size and padded rows: partial edge tiles and SIMD tails.
+    const uint32_t w = 1000;
+    const uint32_t h = 333;
+    const uint32_t stride = w * 4u + 64u;
+    std::vector<uint8_t> px(static_cast<size_t>(stride) * h);
+    FillGradient(px, stride, w, h, 7);
+    DrawDesktop(px, stride, 100, 50, 400, 200, 3);
+    std::vector<uint8_t> data;
+    EncodeStats stats;
+
+    FrameEncoder enc;
+    FrameDecoder dec;
+    expect(RoundTrip(enc, dec, px, stride, w, h, data, &stats) && stats.keyframe && stats.skipped == 0, "keyframe round trip");
+    expect(stats.bytes < static_cast<size_t>(w) * h, "smooth content compresses (< 1 byte/pixel)");
+    expect(RoundTrip(enc, dec, px, stride, w, h, data, &stats) && !stats.keyframe && stats.skipped == stats.tiles, "an unchanged frame skips every tile");
+    expect(data.size() == sizeof(CodecFrameHeader) + stats.tiles * 4u, "skipped tiles cost their size entry");
+    px[static_cast<size_t>(200) * stride + 700 * 4 + 1] ^= 1;
+    px[static_cast<size_t>(h - 1) * stride + (w - 1) * 4] ^= 0x80;
+    expect(RoundTrip(enc, dec, px, stride, w, h, data, &stats) && stats.skipped == stats.tiles - 2, "two changed pixels, two tiles");
+
+    // Random content does not compress: raw tiles, still lossless.
+    std::vector<uint8_t> noise(static_cast<size_t>(stride) * h);
+    FillRandom(noise, 5);
+    expect(RoundTrip(enc, dec, noise, stride, w, h, data, &stats) && stats.raw == stats.tiles, "noise is stored raw");
+    expect(RoundTrip(enc, dec, px, stride, w, h, data, &stats) && stats.raw == 0, "and coded again after");
+
+    // Same bytes at every SIMD level and thread count.
+    CodecConfig scalarCfg;
+    scalarCfg.level = SimdLevel::Scalar;
+    CodecConfig threadedCfg;
+    threadedCfg.threads = 4;
+    FrameEncoder scalarEnc(scalarCfg);
+    FrameEncoder simdEnc;
+    FrameEncoder threadedEnc(threadedCfg);
+    FrameDecoder scalarDec(scalarCfg);
+    FrameDecoder threadedDec(threadedCfg);
+    std::vector<uint8_t> a;
+    std::vector<uint8_t> b;
+    std::vector<uint8_t> c;
+    bool same = true;
+    for (const std::vector<uint8_t>* frame : {&px, &noise, &px}) {
+        same = same && RoundTrip(scalarEnc, scalarDec, *frame, stride, w, h, a) && simdEnc.Encode(frame->data(), stride, w, h, b) &&
+               RoundTrip(threadedEnc, threadedDec, *frame, stride, w, h, c) && a == b && a == c;
+    }
+    expect(same, "scalar, SIMD and 4 threads encode the same bytes");
+
+    // Tile sizes that are not a multiple of the SIMD width, tiny frames.
+    for (uint32_t ts : {8u, 24u, 100u, 256u}) {
+        CodecConfig cfg;
+        cfg.tileSize = ts;
+        FrameEncoder e(cfg);
+        FrameDecoder d(cfg);
+        expect(RoundTrip(e, d, px, stride, w, h, data) && RoundTrip(e, d, noise, stride, w, h, data), ("tile size " + std::to_string(ts)).c_str());
+    }
+    {
+        FrameEncoder e;
+        FrameDecoder d;
+        expect(RoundTrip(e, d, noise, stride, 1, 1, data) && RoundTrip(e, d, px, stride, 3, 17, data), "1x1 and 3x17 frames");
+    }
+
+    // Keyframes.
+    CodecConfig keyCfg;
+    keyCfg.keyframeInterval = 3;
+    FrameEncoder keyEnc(keyCfg);
+    std::vector<bool> keys;
+    for (int i = 0; i < 7; i++) {
+        if (i == 5) keyEnc.ForceKeyframe();
+        (void)keyEnc.Encode(px.data(), stride, w, h, data, &stats);
+        keys.push_back(stats.keyframe);
+    }
+    expect(keys == std::vector<bool>{true, false, false, true, false, true, false}, "keyframe interval and ForceKeyframe()");
+    (void)keyEnc.Encode(px.data(), stride, w - 1, h, data, &stats);
+    expect(stats.keyframe, "a size change is a keyframe");
+
+    // The decoder refuses what it cannot reconstruct.
+    FrameEncoder e2;
+    std::vector<uint8_t> key;
+    (void)e2.Encode(px.data(), stride, w, h, key);
+    (void)e2.Encode(noise.data(), stride, w, h, data);
+    FrameDecoder fresh;
+    expect(!fresh.Decode(data.data(), data.size()), "a delta frame without its keyframe");
+    expect(fresh.Decode(key.data(), key.size()) && fresh.Decode(data.data(), data.size()), "after the keyframe");
+    expect(!fresh.Decode(key.data(), key.size() - 1), "a truncated frame");
+    std::vector<uint8_t> corrupt = key;
+    corrupt[sizeof(CodecFrameHeader) + 4u * TileCols(w, 64) * TileRows(h, 64) + 1] = 0xFF;  // first tile, width nibbles 15
+    expect(!fresh.Decode(corrupt.data(), corrupt.size()), "a corrupt tile");
+    CodecFrameInfo info;
+    expect(ReadCodecFrameInfo(data.data(), data.size(), info) && !info.keyframe && info.width == w && info.raw == info.tiles, "frame info");
+
+    printf("  codec: lossless round trips, skips, raw fallback, scalar == %s == threads, tile sizes, keyframes, bad input  %s\n",
+           SimdLevelName(DetectSimdLevel()),
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+struct Throughput {
+    double ratio{};
+    double encodeMs{};
+    double decodeMs{};
+    bool lossless = true;
+};
+
+// Encodes and decodes `frames` frames of `content` after a keyframe; ms per frame.
+Throughput Measure(Content content, const CodecConfig& cfg, uint32_t w, uint32_t h, int frames) {
+    ContentSource source(content, w, h);
+    FrameEncoder enc(cfg);
+    FrameDecoder dec(cfg);
+    std::vector<uint8_t> data;
+    (void)enc.Encode(source.Next().data(), w * 4u, w, h, data);
+    (void)dec.Decode(data.data(), data.size());
+    Throughput t;
+    int64_t encodeNs = 0;
+    int64_t decodeNs = 0;
+    size_t bytes = 0;
+    for (int f = 0; f < frames; f++) {
+        const std::vector<uint8_t>& px = source.Next();
+        const int64_t t0 = HostNowNs();
+        (void)enc.Encode(px.data(), w * 4u, w, h, data);
+        const int64_t t1 = HostNowNs();
+        t.lossless = dec.Decode(data.data(), data.size()) && t.lossless;
+        decodeNs += HostNowNs() - t1;
+        encodeNs += t1 - t0;
+        bytes += data.size();
+        t.lossless = t.lossless && dec.Frame() == px;
+    }
+    t.ratio = static_cast<double>(w) * h * 4.0 * frames / static_cast<double>(std::max<size_t>(bytes, 1));
+    t.encodeMs = NsToMs(encodeNs) / frames;
+    t.decodeMs = NsToMs(decodeNs) / frames;
+    return t;
+}
+
+} // namespace
+
+// Lossless frame codec: round-trip and bitstream rules, then compression ratio and encode /
+// decode ms per 7680x1440 frame for typical content, for the scalar and SIMD kernels on one
+// and on --threads threads. Frames at or under 1000 / --fps ms are reported, not required.
+int BenchCodec(int argc, char** argv) {
+    const uint32_t w = static_cast<uint32_t>(ArgInt(argc, argv, "--width", 7680));
+    const uint32_t h = static_cast<uint32_t>(ArgInt(argc, argv, "--height", 1440));
+    const uint32_t hw = std::max(1u, std::thread::hardware_concurrency());
+    const uint32_t threads = static_cast<uint32_t>(ArgInt(argc, argv, "--threads", std::min(hw, 8u)));
+    const int frames = static_cast<int>(ArgInt(argc, argv, "--frames", 10));
+    const double fps = ArgDouble(argc, argv, "--fps", 120.0);
+
+    const SimdLevel best = DetectSimdLevel();
+    printf("[rj_bench] codec %ux%u, 64x64 tiles, cpu=%s, %u hardware threads, target %.0f fps\n", w, h, SimdLevelName(best), hw, fps);
+    bool ok = CheckCodec();
+
+    std::vector<uint32_t> threadCounts{1};
+    if (threads > 1) threadCounts.push_back(threads);
+    std::vector<SimdLevel> levels{SimdLevel::Scalar};
+    if (best == SimdLevel::Avx2) levels.push_back(SimdLevel::Avx2);
+    printf("  %-9s %-7s %7s %8s %10s %8s %10s %8s\n", "content", "kernel", "threads", "ratio", "enc ms", "fps", "dec ms", "fps");
+    for (Content content : {Content::Static, Content::Desktop, Content::Gradient, Content::Noise}) {
+        for (SimdLevel level : levels) {
+            for (uint32_t t : threadCounts) {
+                if (level != best && t > 1) continue;
+                CodecConfig cfg;
+                cfg.level = level;
+                cfg.threads = t;
+                const Throughput r = Measure(content, cfg, w, h, frames);
+                printf("  %-9s %-7s %7u %8.2f %10.3f %8.0f %10.3f %8.0f%s\n",
+                       ContentName(content),
+                       SimdLevelName(level),
+                       t,
+                       r.ratio,
+                       r.encodeMs,
+                       1000.0 / r.encodeMs,
+                       r.decodeMs,
+                       1000.0 / r.decodeMs,
+                       r.lossless ? (r.encodeMs <= 1000.0 / fps ? "" : "  (under target on this machine)") : "  LOSSY, FAILED");
+                ok = ok && r.lossless;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/latency_histogram.h"
+#include "core/tile_coherence.h"
+
+namespace rj::bench {
+
+namespace {
+
+struct CoherenceSimConfig {
+    double seconds{};
+    uint32_t tiles{};
+    uint32_t hz{};
+    int64_t phaseStepNs{};  // vblank phase of tile t is t * phaseStepNs
+    int64_t baseDelayNs{};  // vblank -> frame available to AcquireNextFrame
+    int64_t jitterNs{};     // extra uniform delay per frame
+    int32_t slowTile{};     // this tile's frames arrive `slowNs` later (-1: none)
+    int64_t slowNs{};
+    int32_t idleTile{};     // this tile delivers one frame and then nothing (-1: none)
+};
+
+struct CoherenceSimResult {
+    double publishesPerSec{};
+    double completePercent{};
+    LatencyHistogram skew;
+    LatencyHistogram wait;
+    uint64_t framesDelivered{};
+    uint64_t framesFolded{};  // accumulated while the tile's previous frame was held
+    bool ok{true};
+};
+
+// Simulated duplication for one monitor: frame k is presented at its vblank and becomes
+// acquirable a little later. While the previous frame is held, new ones accumulate.
+struct SimTile {
+    int64_t periodNs{};
+    int64_t phaseNs{};
+    int64_t lateNs{};
+    bool idle{};
+    uint64_t nextFrame{};
+    bool held{};
+
+    int64_t VblankNs(uint64_t k) const { return phaseNs + static_cast<int64_t>(k) * periodNs; }
+};
+
+CoherenceSimResult RunSim(const CoherenceSimConfig& c, const CoherenceConfig& policy) {
+    ManualClock clock;
+    TileCoherence coherence(policy);
+    coherence.Reset(c.tiles);
+
+    const int64_t periodNs = kNsPerSec / static_cast<int64_t>(c.hz);
+    std::vector<SimTile> tiles(c.tiles);
+    std::vector<int64_t> arrival(c.tiles);
+    uint32_t rng = 12345;
+    auto scheduleNext = [&](uint32_t t) {
+        SimTile& tile = tiles[t];
+        if (tile.idle && tile.nextFrame > 0) {
+            arrival[t] = INT64_MAX;
+            return;
+        }
+        const int64_t jitter = c.jitterNs > 0 ? static_cast<int64_t>(NextRandom(rng) % static_cast<uint32_t>(c.jitterNs)) : 0;
+        arrival[t] = tile.VblankNs(tile.nextFrame) + c.baseDelayNs + jitter + tile.lateNs;
+    };
+    for (uint32_t t = 0; t < c.tiles; t++) {
+        tiles[t].periodNs = periodNs;
+        tiles[t].phaseNs = c.phaseStepNs * t;
+        tiles[t].lateNs = static_cast<int32_t>(t) == c.slowTile ? c.slowNs : 0;
+        tiles[t].idle = static_cast<int32_t>(t) == c.idleTile;
+        scheduleNext(t);
+    }
+
+    CoherenceSimResult r;
+    uint64_t complete = 0;
+    const int64_t endNs = static_cast<int64_t>(c.seconds * 1e9);
+    while (clock.NowNs() < endNs) {
+        const int64_t now = clock.NowNs();
+
+        // Workers whose frame was recycled acquire again; everything that arrived meanwhile
+        // is folded into one frame, like DXGI_OUTDUPL_FRAME_INFO::AccumulatedFrames.
+        for (uint32_t t = 0; t < c.tiles; t++) {
+            SimTile& tile = tiles[t];
+            if (tile.held || arrival[t] > now) continue;
+            uint64_t k = tile.nextFrame;
+            tile.nextFrame++;
+            scheduleNext(t);
+            while (arrival[t] <= now) {
+                k = tile.nextFrame++;
+                r.framesFolded++;
+                scheduleNext(t);
+            }
+            coherence.OnTileReady(t, tile.VblankNs(k), now);
+            tile.held = true;
+            r.framesDelivered++;
+        }
+
+        int64_t wakeNs = INT64_MAX;
+        if (coherence.ShouldPublish(now, wakeNs)) {
+            const TilePublish& p = coherence.Publish(now);
+            r.skew.Record(p.skewNs);
+            r.wait.Record(p.waitNs);
+            if (p.complete) complete++;
+            for (uint32_t t = 0; t < c.tiles; t++) {
+                if (p.tileMask & (1u << t)) tiles[t].held = false;
+            }
+
+            // The policy's own bounds.
+            const int64_t limit = policy.policy == CoherencePolicy::Window     ? policy.windowNs
+                                  : policy.policy == CoherencePolicy::AllTiles ? policy.maxWaitNs
+                                                                              : 0;
+            if (p.waitNs > limit) r.ok = false;
+            continue;
+        }
+
+        int64_t next = wakeNs;
+        for (uint32_t t = 0; t < c.tiles; t++) {
+            if (!tiles[t].held) next = std::min(next, arrival[t]);
+        }
+        if (next == INT64_MAX) break;
+        clock.SleepUntilNs(next);
+    }
+
+    const double seconds = NsToMs(clock.NowNs()) / 1000.0;
+    r.publishesPerSec = seconds > 0.0 ? static_cast<double>(r.skew.Count()) / seconds : 0.0;
+    r.completePercent = r.skew.Count() == 0 ? 0.0 : 100.0 * static_cast<double>(complete) / static_cast<double>(r.skew.Count());
+    return r;
+}
+
+} // namespace
+
+// Coherence policies for per-monitor acquisition, driven by simulated duplications on a
+// ManualClock: phase-shifted vblanks, delivery jitter, a slow output and an idle output.
+// Deterministic, so results compare across runs and machines.
+int BenchCoherence(int argc, char** argv) {
+    CoherenceSimConfig c;
+    c.seconds = ArgDouble(argc, argv, "--seconds", 10.0);
+    c.tiles = static_cast<uint32_t>(std::min<int64_t>(32, ArgInt(argc, argv, "--tiles", 3)));
+    c.hz = static_cast<uint32_t>(ArgInt(argc, argv, "--hz", 120));
+    if (c.tiles == 0 || c.hz == 0) {
+        fprintf(stderr, "--tiles and --hz must be > 0\n");
+        return 2;
+    }
+    c.phaseStepNs = ArgInt(argc, argv, "--phase-us", 1000000 / (c.hz * c.tiles)) * kNsPerUs;
+    c.baseDelayNs = ArgInt(argc, argv, "--delay-us", 500) * kNsPerUs;
+    c.jitterNs = ArgInt(argc, argv, "--jitter-us", 500) * kNsPerUs;
+    c.slowTile = static_cast<int32_t>(ArgInt(argc, argv, "--slow-tile", -1));
+    c.slowNs = ArgInt(argc, argv, "--slow-us", 6000) * kNsPerUs;
+    c.idleTile = static_cast<int32_t>(ArgInt(argc, argv, "--idle-tile", -1));
+
+    CoherenceConfig base;
+    base.windowNs = ArgInt(argc, argv, "--window-us", base.windowNs / kNsPerUs) * kNsPerUs;
+    base.maxWaitNs = ArgInt(argc, argv, "--max-wait-us", base.maxWaitNs / kNsPerUs) * kNsPerUs;
+    base.idleAfterNs = ArgInt(argc, argv, "--idle-after-us", base.idleAfterNs / kNsPerUs) * kNsPerUs;
+
+    printf("[rj_bench] coherence tiles=%u %u Hz phase step=%.0f us jitter=%.0f us slow tile=%d (+%.0f us) idle tile=%d window=%.0f us\n",
+           c.tiles, c.hz, NsToUs(c.phaseStepNs), NsToUs(c.jitterNs), c.slowTile, NsToUs(c.slowNs), c.idleTile, NsToUs(base.windowNs));
+
+    bool ok = true;
+    const CoherencePolicy policies[] = {CoherencePolicy::AllTiles, CoherencePolicy::Window, CoherencePolicy::Partial};
+    for (CoherencePolicy policy : policies) {
+        CoherenceConfig cfg = base;
+        cfg.policy = policy;
+        const CoherenceSimResult r = RunSim(c, cfg);
+        ok = ok && r.ok;
+        printf("  %-8s publish=%6.1f/s complete=%5.1f%%  skew p50=%6lld p99=%6lld max=%6lld us  wait p50=%6lld max=%6lld us  folded=%llu  %s\n",
+               CoherencePolicyName(policy),
+               r.publishesPerSec,
+               r.completePercent,
+               static_cast<long long>(r.skew.ValueAtPercentileNs(50.0) / kNsPerUs),
+               static_cast<long long>(r.skew.ValueAtPercentileNs(99.0) / kNsPerUs),
+               static_cast<long long>(r.skew.MaxNs() / kNsPerUs),
+               static_cast<long long>(r.wait.ValueAtPercentileNs(50.0) / kNsPerUs),
+               static_cast<long long>(r.wait.MaxNs() / kNsPerUs),
+               static_cast<unsigned long long>(r.framesFolded),
+               r.ok ? "ok" : "BOUND EXCEEDED");
+    }
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
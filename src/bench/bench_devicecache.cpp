@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/clock.h"
+#include "core/device_cache.h"
+#include "core/frame_channel.h"
+#include "core/latency_histogram.h"
+#include "core/mock_device.h"
+
+namespace rj::bench {
+
+namespace {
+
+constexpr uint64_t kIgpu = 0x0000000100001234ull;
+constexpr uint64_t kDgpu = 0x0000000100005678ull;
+
+// Passes the factory straight through: what AssignSwapChain did before the cache.
+class Uncached {
+public:
+    explicit Uncached(IRenderDeviceFactory& factory) : m_factory(factory) {}
+    std::shared_ptr<IRenderDevice> Acquire(uint64_t luid, bool* reused) {
+        *reused = false;
+        return m_factory.Create(luid);
+    }
+
+private:
+    IRenderDeviceFactory& m_factory;
+};
+
+bool CheckPolicy() {
+    ManualClock clock;
+    MockRenderDeviceFactory factory(clock);
+    DeviceCache cache(factory, 2);
+    bool reused = false;
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  policy: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+
+    auto first = cache.Acquire(kDgpu, &reused);
+    expect(first && !reused, "first acquire creates");
+    auto again = cache.Acquire(kDgpu, &reused);
+    expect(again == first && reused, "reassignment reuses the warm device");
+
+    factory.ChangeAdapterSet();
+    auto afterHotplug = cache.Acquire(kDgpu, &reused);
+    expect(afterHotplug && afterHotplug != first && !reused, "adapter set change recreates");
+
+    factory.RemoveDevice(kDgpu);
+    auto afterRemoval = cache.Acquire(kDgpu, &reused);
+    expect(afterRemoval && afterRemoval != afterHotplug && !reused, "removed device recreates");
+
+    cache.Invalidate(kDgpu);
+    expect(cache.Size() == 0, "invalidate drops the entry");
+    expect(cache.Acquire(kDgpu, &reused) && !reused, "invalidated adapter recreates");
+
+    factory.SetAdapterPresent(kIgpu, false);
+    expect(!cache.Acquire(kIgpu, &reused) && cache.Size() == 1, "failed creation is not cached");
+    factory.SetAdapterPresent(kIgpu, true);
+    auto igpu = cache.Acquire(kIgpu, &reused);
+    expect(igpu && !reused && cache.Size() == 2, "second adapter gets its own device");
+
+    // Capacity 2: a third adapter evicts the least recently used (kDgpu, since kIgpu is newer).
+    const uint64_t third = 0x42;
+    (void)cache.Acquire(kIgpu, &reused);
+    (void)cache.Acquire(third, &reused);
+    expect(cache.Size() == 2 && cache.Stats().evictions == 1, "capacity evicts one entry");
+    expect(cache.Acquire(kIgpu, &reused) && reused, "most recently used adapter survives eviction");
+
+    const DeviceCacheStats s = cache.Stats();
+    expect(s.stale == 2 && s.failures == 1, "stale and failure counters");
+
+    // Assignments racing on one adapter share one device.
+    SteadyClock steady;
+    MockDeviceConfig fast;
+    fast.deviceCostNs = 2 * kNsPerMs;
+    MockRenderDeviceFactory threadedFactory(steady, fast);
+    DeviceCache threaded(threadedFactory);
+    std::vector<std::thread> threads;
+    std::vector<std::shared_ptr<IRenderDevice>> got(8);
+    for (size_t i = 0; i < got.size(); i++) {
+        threads.emplace_back([&, i] { got[i] = threaded.Acquire(kDgpu); });
+    }
+    for (auto& t : threads) t.join();
+    expect(threadedFactory.Counters().created == 1 && std::all_of(got.begin(), got.end(), [&](const auto& d) { return d == got[0]; }),
+           "concurrent acquires share one device");
+
+    printf("  policy: reuse, hot-plug, removal, invalidate, failure, LRU eviction, concurrent acquire  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// The driver exports each assignment through the frame channel; rj_span reads it back for
+// its stats line. Stats survive a producer restart on the same block.
+bool CheckExport() {
+    const size_t bytes = FrameChannelBytes(0);
+    void* mem = ::operator new(bytes, std::align_val_t{4096});
+    memset(mem, 0, bytes);
+    bool ok = true;
+    {
+        FrameChannelProducer producer;
+        FrameChannelConsumer consumer;
+        ok = producer.Init(mem, bytes, 0) && consumer.Attach(mem, bytes);
+        producer.ReportAssignment(false, 45 * kNsPerMs);
+        ok = ok && consumer.ProducerStats().assignments == 1 && consumer.ProducerStats().firstFrameNs == 0;
+        producer.ReportFirstFrame(52 * kNsPerMs);
+
+        FrameChannelProducer restarted;
+        ok = ok && restarted.Init(mem, bytes, 0);
+        restarted.ReportAssignment(true, 20 * kNsPerUs);
+        restarted.ReportFirstFrame(6 * kNsPerMs);
+        const ChannelProducerStats st = consumer.ProducerStats();
+        ok = ok && st.assignments == 2 && st.deviceReuses == 1 && st.deviceAcquireNs == 20 * kNsPerUs && st.firstFrameNs == 6 * kNsPerMs;
+    }
+    ::operator delete(mem, std::align_val_t{4096});
+    printf("  export: assignment stats through the frame channel, kept across a producer restart  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+struct SessionResult {
+    LatencyHistogram firstFrame;
+    uint64_t created{};
+    uint64_t reused{};
+    uint64_t failed{};
+};
+
+// A session of swap-chain assignments: mostly mode changes and fullscreen switches on the
+// same adapter, sometimes a switch to the other GPU, a GPU hot-plug or a removed device. Each
+// assignment then binds the device, creates the channel surfaces and waits for the next OS
+// present; assign-to-first-frame is measured on the simulated clock.
+SessionResult RunSession(int assignments, uint32_t hz, int64_t bindCostNs, uint32_t seed, bool cached) {
+    ManualClock clock;
+    MockRenderDeviceFactory factory(clock);
+    DeviceCache cache(factory);
+    Uncached uncached(factory);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> event(0, 99);
+    const int64_t periodNs = kNsPerSec / hz;
+    SessionResult r;
+    uint64_t luid = kDgpu;
+
+    for (int i = 0; i < assignments; i++) {
+        const int e = event(rng);
+        if (e < 8) {
+            luid = luid == kDgpu ? kIgpu : kDgpu;
+        } else if (e < 11) {
+            factory.ChangeAdapterSet();
+        } else if (e < 14) {
+            factory.RemoveDevice(luid);
+        }
+        clock.AdvanceNs(static_cast<int64_t>(rng() % 500) * kNsPerMs);
+
+        const int64_t assignedNs = clock.NowNs();
+        bool reused = false;
+        std::shared_ptr<IRenderDevice> device = cached ? cache.Acquire(luid, &reused) : uncached.Acquire(luid, &reused);
+        if (!device) {
+            r.failed++;
+            continue;
+        }
+        r.reused += reused ? 1 : 0;
+        clock.SleepForNs(bindCostNs);
+        // The first frame is the next present after the processor is ready.
+        const int64_t next = (clock.NowNs() / periodNs + 1) * periodNs;
+        clock.SleepUntilNs(next);
+        r.firstFrame.Record(clock.NowNs() - assignedNs);
+    }
+    r.created = factory.Counters().created;
+    return r;
+}
+
+double AvgMs(const LatencyHistogram& h) {
+    return h.MeanNs() / 1e6;
+}
+
+} // namespace
+
+// IDD render device cache: the per-LUID reuse policy against a mock device factory, then the
+// time from swap-chain assignment to first processed frame with and without the cache over a
+// simulated session of mode changes, GPU switches, hot-plugs and device removals.
+int BenchDeviceCache(int argc, char** argv) {
+    const int assignments = static_cast<int>(ArgInt(argc, argv, "--assignments", 500));
+    const uint32_t hz = static_cast<uint32_t>(ArgInt(argc, argv, "--hz", 120));
+    const int64_t bindCostNs = static_cast<int64_t>(ArgDouble(argc, argv, "--bind-ms", 1.5) * kNsPerMs);
+    const uint32_t seed = static_cast<uint32_t>(ArgInt(argc, argv, "--seed", 7));
+
+    printf("[rj_bench] devicecache %d assignments at %u Hz, bind %.1f ms\n", assignments, hz, NsToMs(bindCostNs));
+    bool ok = CheckPolicy();
+    ok = CheckExport() && ok;
+
+    const SessionResult plain = RunSession(assignments, hz, bindCostNs, seed, false);
+    const SessionResult warm = RunSession(assignments, hz, bindCostNs, seed, true);
+    printf("  %-9s %8s %8s %8s %8s %9s %8s\n", "source", "created", "reused", "avg ms", "p50 ms", "p99 ms", "max ms");
+    auto row = [&](const char* name, const SessionResult& r) {
+        printf("  %-9s %8llu %8llu %8.2f %8.2f %9.2f %8.2f\n",
+               name,
+               static_cast<unsigned long long>(r.created),
+               static_cast<unsigned long long>(r.reused),
+               AvgMs(r.firstFrame),
+               NsToMs(r.firstFrame.ValueAtPercentileNs(50.0)),
+               NsToMs(r.firstFrame.ValueAtPercentileNs(99.0)),
+               NsToMs(r.firstFrame.MaxNs()));
+    };
+    row("uncached", plain);
+    row("cached", warm);
+
+    // Same events, so the same assignments; the cache only creates when the device went
+    // stale or the adapter changed, and never serves more slowly.
+    const bool sessionOk = plain.firstFrame.Count() == warm.firstFrame.Count() && warm.created + warm.reused == warm.firstFrame.Count() &&
+                           warm.created < plain.created && AvgMs(warm.firstFrame) < AvgMs(plain.firstFrame);
+    printf("  assign->first frame avg %.2f ms -> %.2f ms  %s\n", AvgMs(plain.firstFrame), AvgMs(warm.firstFrame), sessionOk ? "ok" : "FAILED");
+    ok = ok && sessionOk;
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,186 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/display_timing.h"
+#include "core/edid.h"
+#include "core/virtual_display.h"
+
+namespace rj::bench {
+
+namespace {
+
+// Published VESA CVT 1.2 reduced-blanking timings.
+struct KnownTiming {
+    CvtBlanking blanking;
+    uint32_t width, height, hz;
+    uint64_t pixelClockHz;
+    uint32_t hTotal, vTotal, vFrontPorch, vSync, vBackPorch;
+};
+
+const KnownTiming kKnown[] = {
+    {CvtBlanking::ReducedV1, 1920, 1080, 60, 138500000, 2080, 1111, 3, 5, 23},
+    {CvtBlanking::ReducedV1, 2560, 1440, 60, 241500000, 2720, 1481, 3, 5, 33},
+    {CvtBlanking::ReducedV1, 2560, 1600, 60, 268500000, 2720, 1646, 3, 6, 37},
+    {CvtBlanking::ReducedV2, 1920, 1080, 60, 133320000, 2000, 1111, 17, 8, 6},
+    {CvtBlanking::ReducedV2, 3840, 2160, 60, 522614000, 3920, 2222, 48, 8, 6},
+};
+
+bool CheckKnownTimings() {
+    bool ok = true;
+    for (const KnownTiming& k : kKnown) {
+        DisplayTiming t;
+        const bool good = ComputeCvtTiming(k.width, k.height, k.hz, k.blanking, t) && t.pixelClockHz == k.pixelClockHz && t.HTotal() == k.hTotal &&
+                          t.VTotal() == k.vTotal && t.vFrontPorch == k.vFrontPorch && t.vSync == k.vSync && t.vBackPorch == k.vBackPorch &&
+                          t.hSyncPositive && !t.vSyncPositive;
+        printf("  %-4s %4ux%-4u@%3u  %8.3f MHz  %ux%u  vfp/sync/bp %u/%u/%u  %s\n",
+               k.blanking == CvtBlanking::ReducedV1 ? "rb" : "rb2",
+               k.width,
+               k.height,
+               k.hz,
+               static_cast<double>(t.pixelClockHz) / 1e6,
+               t.HTotal(),
+               t.VTotal(),
+               t.vFrontPorch,
+               t.vSync,
+               t.vBackPorch,
+               good ? "ok" : "FAILED");
+        ok = ok && good;
+    }
+    DisplayTiming t;
+    const bool rejects = !ComputeCvtTiming(0, 1440, 60, CvtBlanking::ReducedV2, t) && !ComputeCvtTiming(2560, 1440, 0, CvtBlanking::ReducedV2, t) &&
+                         !ComputeCvtTiming(2560, 1440, 3000, CvtBlanking::ReducedV2, t);
+    if (!rejects) printf("  invalid sizes/rates accepted  FAILED\n");
+    return ok && rejects;
+}
+
+bool CheckConfigText() {
+    struct Case {
+        const char* text;
+        bool valid;
+        const char* canonical;
+    };
+    const Case cases[] = {
+        {"3x2560x1440@165,144,120,60", true, "3x2560x1440@165,144,120,60"},
+        {"3x2560x1440@144,144,60", true, "3x2560x1440@144,60"},
+        {"1x3840x2160@60", true, "1x3840x2160@60"},
+        {"3x2560x1440@", false, nullptr},
+        {"3x2560x1440", false, nullptr},
+        {"3x2560x1440@60;120", false, nullptr},
+        {"7x2560x1440@60", false, nullptr},   // 17920 px, past the texture limit
+        {"9x1280x1024@60", false, nullptr},   // more panels than slices
+        {"3x2560x1440@1000", false, nullptr}, // rate out of range
+    };
+    bool ok = true;
+    for (const Case& c : cases) {
+        VirtualDisplayConfig cfg;
+        const bool parsed = ParseVirtualDisplayConfig(c.text, cfg);
+        const bool good = parsed == c.valid && (!parsed || FormatVirtualDisplayConfig(cfg) == c.canonical);
+        if (!good) printf("  config \"%s\"  FAILED\n", c.text);
+        ok = ok && good;
+    }
+
+    // Three 165 Hz panels, one of which lacks 100 Hz: the common rates, best first.
+    std::vector<PanelModes> panels(3, PanelModes{2560, 1440, 165, {60, 100, 120, 144, 165}});
+    panels[2].ratesHz = {60, 120, 144, 165};
+    VirtualDisplayConfig derived;
+    bool good = DeriveVirtualDisplayConfig(panels, derived) && FormatVirtualDisplayConfig(derived) == "3x2560x1440@165,144,120,60";
+    // Mixed resolutions can't form one wide mode.
+    panels[1].width = 1920;
+    good = good && !DeriveVirtualDisplayConfig(panels, derived);
+    if (!good) printf("  derive from panels  FAILED\n");
+    printf("  config: %zu parse cases, derive from panels  %s\n", sizeof(cases) / sizeof(cases[0]), ok && good ? "ok" : "FAILED");
+    return ok && good;
+}
+
+bool SameTiming(const DisplayTiming& a, const DisplayTiming& b) {
+    return a.hActive == b.hActive && a.hFrontPorch == b.hFrontPorch && a.hSync == b.hSync && a.hBackPorch == b.hBackPorch && a.vActive == b.vActive &&
+           a.vFrontPorch == b.vFrontPorch && a.vSync == b.vSync && a.vBackPorch == b.vBackPorch && a.pixelClockHz == b.pixelClockHz &&
+           a.hSyncPositive == b.hSyncPositive && a.vSyncPositive == b.vSyncPositive;
+}
+
+// Builds the EDID for `text`, parses it back and checks every mode survives, the preferred
+// one is first, and a flipped bit anywhere is caught by a checksum.
+bool CheckEdid(const char* text, int iters) {
+    VirtualDisplayConfig cfg;
+    if (!ParseVirtualDisplayConfig(text, cfg)) return false;
+    const std::vector<DisplayTiming> modes = BuildVirtualDisplayModes(cfg);
+    std::vector<uint8_t> edid = BuildVirtualDisplayEdid(cfg);
+
+    EdidInfo info;
+    bool ok = edid.size() == kEdidBlockSize * (1 + (modes.size() + kDisplayIdTimingsPerBlock - 1) / kDisplayIdTimingsPerBlock) &&
+              ParseEdid(edid.data(), edid.size(), info) && info.modes.size() == modes.size() && info.preferred == 0 &&
+              std::string(info.manufacturer) == "RJS" && info.name == "rj_span";
+    for (size_t i = 0; ok && i < modes.size(); i++) ok = SameTiming(info.modes[i], modes[i]);
+
+    bool corruptionCaught = true;
+    for (size_t i = 0; i < edid.size(); i += 7) {
+        edid[i] ^= 0x10;
+        EdidInfo scratch;
+        corruptionCaught = corruptionCaught && !ParseEdid(edid.data(), edid.size(), scratch);
+        edid[i] ^= 0x10;
+    }
+
+    const int64_t t0 = HostNowNs();
+    for (int it = 0; it < iters; it++) {
+        const std::vector<uint8_t> built = BuildVirtualDisplayEdid(cfg);
+        DoNotOptimize(built.data());
+    }
+    const double usPerBuild = static_cast<double>(HostNowNs() - t0) / 1000.0 / iters;
+
+    printf("  edid %-28s %zu bytes, %zu modes, preferred %ux%u@%.3f, %.2f us/build  %s\n",
+           text,
+           edid.size(),
+           info.modes.size(),
+           modes.empty() ? 0 : modes[0].hActive,
+           modes.empty() ? 0 : modes[0].vActive,
+           modes.empty() ? 0.0 : modes[0].RefreshHz(),
+           usPerBuild,
+           ok && corruptionCaught ? "ok" : "FAILED");
+    return ok && corruptionCaught;
+}
+
+} // namespace
+
+// Virtual display timings: the CVT-RB calculator against published VESA values, the mode
+// config text and its derivation from physical panels, and EDID/DisplayID round trips. Also
+// shows the signal the driver used to report (pixel rate = active pixels x refresh, no
+// blanking) next to the CVT-RB2 signal it reports now.
+int BenchEdid(int argc, char** argv) {
+    const char* config = ArgStr(argc, argv, "--config", "3x2560x1440@165,144,120,60");
+    const int iters = static_cast<int>(ArgInt(argc, argv, "--iters", 2000));
+
+    printf("[rj_bench] edid %s\n", config);
+    bool ok = CheckKnownTimings();
+    ok = CheckConfigText() && ok;
+    ok = CheckEdid(config, iters) && ok;
+    ok = CheckEdid("3x2560x1440@240,165,144,120,100,75,60,30", iters) && ok;
+    ok = CheckEdid("1x1920x1080@60", iters) && ok;
+
+    VirtualDisplayConfig cfg;
+    if (!ParseVirtualDisplayConfig(config, cfg)) {
+        printf("  --config=%s does not parse  FAILED\n", config);
+        return 1;
+    }
+    printf("  %-18s %12s %12s %11s %11s\n", "mode", "old MHz", "cvt-rb2 MHz", "old hsync", "hsync kHz");
+    for (const DisplayTiming& t : BuildVirtualDisplayModes(cfg)) {
+        const uint32_t hz = t.NominalHz();
+        const double oldClock = static_cast<double>(hz) * t.hActive * t.vActive;
+        const bool good = std::fabs(t.RefreshHz() - hz) < 0.01 && static_cast<double>(t.pixelClockHz) > oldClock;
+        printf("  %5ux%-4u@%-3u     %12.3f %12.3f %11.3f %11.3f  %s\n",
+               t.hActive,
+               t.vActive,
+               hz,
+               oldClock / 1e6,
+               static_cast<double>(t.pixelClockHz) / 1e6,
+               static_cast<double>(hz) * t.vActive / 1e3,
+               static_cast<double>(t.pixelClockHz) / t.HTotal() / 1e3,
+               good ? "ok" : "FAILED");
+        ok = ok && good;
+    }
+    printf("  %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/triple_buffer.h"
+
+namespace rj::bench {
+
+namespace {
+
+// Same shape as the descriptor rj_span hands from the WGC callback to the render thread,
+// padded with check words so torn reads are detectable.
+struct HandoffFrame {
+    uint64_t sequence{};
+    int64_t captureTimeNs{};
+    uint32_t width{};
+    uint32_t height{};
+    uint32_t format{};
+    uint64_t check[8]{};
+};
+
+void FillFrame(HandoffFrame& f, uint64_t seq) {
+    f.sequence = seq;
+    f.captureTimeNs = static_cast<int64_t>(seq) * 1000;
+    f.width = 7680;
+    f.height = 1440;
+    f.format = 87;
+    for (uint64_t i = 0; i < 8; i++) f.check[i] = seq * 0x9E3779B97F4A7C15ull + i;
+}
+
+bool FrameIsConsistent(const HandoffFrame& f) {
+    if (f.sequence == 0) return true;  // nothing published yet
+    if (f.captureTimeNs != static_cast<int64_t>(f.sequence) * 1000) return false;
+    for (uint64_t i = 0; i < 8; i++) {
+        if (f.check[i] != f.sequence * 0x9E3779B97F4A7C15ull + i) return false;
+    }
+    return true;
+}
+
+// The pre-existing scheme: one mutex around the latest value.
+class MutexLatest {
+public:
+    void Write(const HandoffFrame& f, int64_t holdNs) {
+        std::scoped_lock lk(m_mutex);
+        m_value = f;
+        if (holdNs > 0) {
+            const int64_t until = HostNowNs() + holdNs;
+            while (HostNowNs() < until) {
+            }
+        }
+    }
+    HandoffFrame Read() {
+        std::scoped_lock lk(m_mutex);
+        return m_value;
+    }
+
+private:
+    std::mutex m_mutex;
+    HandoffFrame m_value{};
+};
+
+struct ReadLatency {
+    std::vector<int64_t> samples;
+    uint64_t newFrames{};
+    uint64_t torn{};
+    uint64_t backwards{};
+};
+
+void PrintLatency(const char* name, ReadLatency& r) {
+    std::sort(r.samples.begin(), r.samples.end());
+    const size_t n = r.samples.size();
+    if (n == 0) return;
+    double sum = 0.0;
+    for (int64_t s : r.samples) sum += static_cast<double>(s);
+    printf("  %-13s reads=%zu new=%llu  avg=%6.0f ns  p50=%6lld  p99=%6lld  p99.9=%7lld  max=%8lld ns  %s\n",
+           name,
+           n,
+           static_cast<unsigned long long>(r.newFrames),
+           sum / static_cast<double>(n),
+           static_cast<long long>(r.samples[n / 2]),
+           static_cast<long long>(r.samples[std::min(n - 1, n * 99 / 100)]),
+           static_cast<long long>(r.samples[std::min(n - 1, n * 999 / 1000)]),
+           static_cast<long long>(r.samples[n - 1]),
+           (r.torn || r.backwards) ? "INCONSISTENT" : "consistent");
+}
+
+// Producer publishes flat out (or at `hz`); the consumer does `readsPerFrame` reads per
+// simulated render frame, like RenderFrame() which looked at the capture size once per
+// output window.
+template <typename PublishFn, typename ReadFn>
+ReadLatency RunContention(double seconds, double hz, int readsPerFrame, PublishFn publish, ReadFn read) {
+    std::atomic<bool> stop{false};
+    std::thread producer([&] {
+        const int64_t periodNs = hz > 0.0 ? static_cast<int64_t>(1e9 / hz) : 0;
+        int64_t next = HostNowNs();
+        for (uint64_t seq = 1; !stop.load(std::memory_order_relaxed); seq++) {
+            publish(seq);
+            if (periodNs > 0) {
+                next += periodNs;
+                while (HostNowNs() < next && !stop.load(std::memory_order_relaxed)) std::this_thread::yield();
+            }
+        }
+    });
+
+    ReadLatency r;
+    r.samples.reserve(1 << 20);
+    uint64_t lastSeq = 0;
+    const int64_t end = HostNowNs() + static_cast<int64_t>(seconds * 1e9);
+    while (HostNowNs() < end && r.samples.size() < (1u << 24)) {
+        for (int i = 0; i < readsPerFrame; i++) {
+            const int64_t t0 = HostNowNs();
+            const HandoffFrame f = read();
+            r.samples.push_back(HostNowNs() - t0);
+            if (!FrameIsConsistent(f)) r.torn++;
+            if (f.sequence < lastSeq) r.backwards++;
+            if (f.sequence != lastSeq) r.newFrames++;
+            lastSeq = f.sequence;
+        }
+    }
+    stop.store(true, std::memory_order_relaxed);
+    producer.join();
+    return r;
+}
+
+// Hammers the triple buffer from both sides and checks every value the consumer sees is
+// complete and never older than the previous one. Run a -DRJ_SANITIZER=thread build for TSAN.
+bool RunStress(uint64_t iterations) {
+    TripleBuffer<HandoffFrame> buffer;
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        for (uint64_t seq = 1; seq <= iterations; seq++) {
+            FillFrame(buffer.WriteSlot(), seq);
+            buffer.Publish();
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint64_t lastSeq = 0;
+    uint64_t updates = 0;
+    uint64_t failures = 0;
+    for (;;) {
+        const bool finished = done.load(std::memory_order_acquire);
+        if (buffer.Update()) {
+            const HandoffFrame& f = buffer.Read();
+            updates++;
+            if (!FrameIsConsistent(f) || f.sequence <= lastSeq) failures++;
+            lastSeq = f.sequence;
+        }
+        if (finished && !buffer.HasNew()) break;
+    }
+    producer.join();
+
+    const bool ok = failures == 0 && lastSeq == iterations;
+    printf("  stress        published=%llu observed=%llu last=%llu failures=%llu  %s\n",
+           static_cast<unsigned long long>(iterations),
+           static_cast<unsigned long long>(updates),
+           static_cast<unsigned long long>(lastSeq),
+           static_cast<unsigned long long>(failures),
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// Reset() with values left in every slot: nothing may survive to the next Read().
+bool RunReset() {
+    TripleBuffer<HandoffFrame> buffer;
+    for (uint64_t seq = 1; seq <= 3; seq++) {
+        FillFrame(buffer.WriteSlot(), seq);
+        buffer.Publish();
+        if (seq == 2) buffer.Update();
+    }
+    buffer.Reset();
+    bool ok = !buffer.HasNew() && !buffer.Update() && buffer.Read().sequence == 0;
+    // Rotate every slot through both sides without writing: all must come back empty.
+    for (int i = 0; i < 3 && ok; i++) {
+        ok = buffer.WriteSlot().sequence == 0;
+        buffer.Publish();
+        ok = ok && buffer.Update() && buffer.Read().sequence == 0;
+    }
+    FillFrame(buffer.WriteSlot(), 12);
+    buffer.Publish();
+    ok = ok && buffer.Update() && buffer.Read().sequence == 12;
+    printf("  reset         stale values dropped, handoff works after  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+// Latest-frame handoff between a capture callback thread and the render thread: lock-free
+// triple buffer vs. the old mutex, plus a consistency stress run.
+int BenchHandoff(int argc, char** argv) {
+    const double seconds = ArgDouble(argc, argv, "--seconds", 1.0);
+    const double hz = ArgDouble(argc, argv, "--hz", 0.0);
+    const int readsPerFrame = static_cast<int>(ArgInt(argc, argv, "--reads", 5));
+    const int64_t holdNs = ArgInt(argc, argv, "--hold-ns", 200);
+    const uint64_t iterations = static_cast<uint64_t>(ArgInt(argc, argv, "--stress-iters", 2000000));
+
+    printf("[rj_bench] handoff producer=%s reads/frame=%d mutex hold=%lld ns\n",
+           hz > 0.0 ? "paced" : "flat-out", readsPerFrame, static_cast<long long>(holdNs));
+
+    bool ok = RunStress(iterations);
+    ok = RunReset() && ok;
+
+    TripleBuffer<HandoffFrame> triple;
+    ReadLatency t = RunContention(
+        seconds, hz, readsPerFrame,
+        [&](uint64_t seq) {
+            FillFrame(triple.WriteSlot(), seq);
+            triple.Publish();
+        },
+        [&] {
+            triple.Update();
+            return triple.Read();
+        });
+    PrintLatency("triple_buffer", t);
+
+    MutexLatest locked;
+    ReadLatency m = RunContention(
+        seconds, hz, readsPerFrame,
+        [&](uint64_t seq) {
+            HandoffFrame f;
+            FillFrame(f, seq);
+            locked.Write(f, holdNs);
+        },
+        [&] { return locked.Read(); });
+    PrintLatency("mutex", m);
+
+    ok = ok && t.torn == 0 && t.backwards == 0 && m.torn == 0 && m.backwards == 0;
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/clock.h"
+#include "core/held_frame.h"
+
+namespace rj::bench {
+
+namespace {
+
+bool CheckPolicy() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  policy: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+
+    HeldFrameTracker t(3);
+    expect(t.BeginSample() == 0 && t.Poll(0) == HoldDecision::Hold, "nothing held");
+    expect(!t.Publish(0, 0, 100), "frame id 0 is rejected");
+
+    // Every output draws it in one pass: released without a copy.
+    expect(t.Publish(1, 0, 1000), "publish");
+    expect(!t.Publish(2, 0, 1000), "one frame at a time");
+    expect(t.Poll(10) == HoldDecision::Hold, "held until drawn");
+    const uint64_t id = t.BeginSample();
+    expect(id == 1, "sample the held frame");
+    expect(t.Poll(20) == HoldDecision::Hold, "never released while sampled");
+    t.EndSample(id, 0x7);
+    expect(t.Poll(30) == HoldDecision::ReleaseDrawn, "drawn by every output");
+    expect(t.BeginSample() == 0, "no sample once revoked");
+    t.Released(31);
+
+    // Two passes drawing different outputs add up.
+    expect(t.Publish(2, 100, 1100), "publish 2");
+    t.EndSample(t.BeginSample(), 0x1);
+    expect(t.Poll(200) == HoldDecision::Hold, "partially drawn");
+    t.EndSample(t.BeginSample(), 0x6);
+    expect(t.Poll(300) == HoldDecision::ReleaseDrawn, "drawn over two passes");
+    t.Released(300);
+
+    // Deadline with one output missing: the caller copies.
+    expect(t.Publish(3, 1000, 2000), "publish 3");
+    t.EndSample(t.BeginSample(), 0x3);
+    expect(t.Poll(1999) == HoldDecision::Hold && t.Poll(2000) == HoldDecision::ReleaseDeadline, "deadline");
+    t.Released(2000);
+
+    // Deadline while a pass samples it: held until the pass ends, counted as an overrun.
+    expect(t.Publish(4, 3000, 4000), "publish 4");
+    const uint64_t late = t.BeginSample();
+    expect(t.Poll(4500) == HoldDecision::Hold, "overrun waits for the pass");
+    t.EndSample(late, 0x7);
+    expect(t.Poll(4600) == HoldDecision::ReleaseDrawn, "released when the pass ends");
+    t.Released(4600);
+
+    // A stale EndSample (frame already replaced) changes nothing.
+    expect(t.Publish(5, 5000, 6000), "publish 5");
+    t.EndSample(4, 0x7);
+    expect(t.Poll(5100) == HoldDecision::Hold, "stale end ignored");
+    expect(t.Poll(6000) == HoldDecision::ReleaseDeadline, "undrawn frame copied");
+    t.Released(6000);
+    expect(!t.Publish(5, 7000, 8000), "ids only increase");
+
+    const HeldFrameStats s = t.TakeStats();
+    expect(s.published == 5 && s.releasedDrawn == 3 && s.releasedDeadline == 2, "release counters");
+    expect(s.overruns == 1 && s.maxOverrunNs == 600 && s.revokedSamples == 1 && s.maxHoldNs == 1600, "overrun and hold stats");
+
+    printf("  policy: draw-complete, partial passes, deadline, overrun, revoke, stale end  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// A capture and a render thread on the real clock. The render thread checks that the frame
+// it samples is never released underneath it.
+bool CheckThreaded(int frames) {
+    SteadyClock clock;
+    HeldFrameTracker t(3);
+    std::atomic<uint64_t> surface{0};  // frame id currently acquired, 0 = released
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> violations{0};
+    std::atomic<uint64_t> samples{0};
+
+    std::thread render([&] {
+        std::mt19937 rng(3);
+        while (!done.load(std::memory_order_acquire)) {
+            const uint64_t id = t.BeginSample();
+            if (id == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (surface.load(std::memory_order_acquire) != id) violations++;
+            for (uint32_t spin = rng() % 2000; spin > 0; spin--) DoNotOptimize(&spin);
+            if (surface.load(std::memory_order_acquire) != id) violations++;
+            t.EndSample(id, (rng() % 4 == 0) ? 0x3u : 0x7u);
+            samples++;
+            // Passes are paced by vblank, not back to back.
+            std::this_thread::sleep_for(std::chrono::microseconds(20 + rng() % 60));
+        }
+    });
+
+    for (int i = 1; i <= frames; i++) {
+        const uint64_t id = static_cast<uint64_t>(i);
+        surface.store(id, std::memory_order_release);
+        const int64_t now = clock.NowNs();
+        (void)t.Publish(id, now, now + 200 * kNsPerUs);
+        while (t.Wait(clock.NowNs()) == HoldDecision::Hold) {}
+        surface.store(0, std::memory_order_release);
+        t.Released(clock.NowNs());
+    }
+    done.store(true, std::memory_order_release);
+    render.join();
+
+    const HeldFrameStats s = t.TakeStats();
+    const bool ok = violations.load() == 0 && s.published == static_cast<uint64_t>(frames) && s.releasedDrawn + s.releasedDeadline == s.published;
+    printf("  threaded: %d frames, %llu passes, %llu drawn / %llu deadline, released under a pass %llu  %s\n",
+           frames,
+           static_cast<unsigned long long>(samples.load()),
+           static_cast<unsigned long long>(s.releasedDrawn),
+           static_cast<unsigned long long>(s.releasedDeadline),
+           static_cast<unsigned long long>(violations.load()),
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// Wait() on the real clock: woken by an EndSample() that completes the frame, at the
+// deadline when nothing draws it, and by the end of a pass that overran the deadline.
+bool CheckWait() {
+    SteadyClock clock;
+    HeldFrameTracker t(2);
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  wait: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+    auto waitLoop = [&](HoldDecision& decision) {
+        const int64_t start = clock.NowNs();
+        while ((decision = t.Wait(clock.NowNs())) == HoldDecision::Hold) {}
+        return clock.NowNs() - start;
+    };
+    HoldDecision decision = HoldDecision::Hold;
+
+    int64_t now = clock.NowNs();
+    (void)t.Publish(1, now, now + 10 * kNsPerSec);
+    std::thread draw([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        t.EndSample(t.BeginSample(), 0x1u);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        t.EndSample(t.BeginSample(), 0x2u);
+    });
+    const int64_t drawnNs = waitLoop(decision);
+    draw.join();
+    t.Released(clock.NowNs());
+    expect(decision == HoldDecision::ReleaseDrawn && drawnNs < 2 * kNsPerSec, "woken when drawn");
+
+    now = clock.NowNs();
+    (void)t.Publish(2, now, now + 20 * kNsPerMs);
+    const int64_t deadlineNs = waitLoop(decision);
+    t.Released(clock.NowNs());
+    expect(decision == HoldDecision::ReleaseDeadline && deadlineNs >= 20 * kNsPerMs, "deadline");
+
+    now = clock.NowNs();
+    (void)t.Publish(3, now, now + 5 * kNsPerMs);
+    const uint64_t id = t.BeginSample();
+    std::thread overrun([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        t.EndSample(id, 0x1u);
+    });
+    const int64_t overrunNs = waitLoop(decision);
+    overrun.join();
+    t.Released(clock.NowNs());
+    expect(decision == HoldDecision::ReleaseDeadline && overrunNs >= 30 * kNsPerMs, "overrun waits for the pass");
+
+    printf("  wait: drawn after %.1f ms, deadline after %.1f ms, overrun after %.1f ms  %s\n",
+           NsToMs(drawnNs), NsToMs(deadlineNs), NsToMs(overrunNs), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+struct SimConfig {
+    uint64_t frameBytes{};
+    uint32_t hz{};
+    int seconds{};
+    double activity{};      // share of compositions that change the desktop
+    int64_t acquireNs{};    // composition -> frame acquired
+    int64_t renderNs{};     // vblank -> render pass start
+    int64_t passNs{};       // pass duration
+    int64_t pollNs{};       // capture thread poll step
+    uint32_t seed{};
+};
+
+struct SimResult {
+    uint64_t bytes{};
+    uint64_t frames{};
+    uint64_t drawnReleased{};
+    uint64_t deadlineCopies{};
+    uint64_t skippedPasses{};
+    uint64_t sampledAfterRelease{};
+    int64_t maxHoldNs{};
+    int64_t latencySumNs{};
+    uint64_t latencyCount{};
+};
+
+// single_wide on a 50 us grid. Copy mode copies every frame into a slot and releases it;
+// each pass samples the newest slot. Zero-copy holds the frame for the passes and copies
+// only at the deadline; once a drawn frame is released and nothing newer arrived, passes
+// skip their present. Bytes count the slot copy (read + write) and the shader's reads and
+// writes.
+SimResult Simulate(const SimConfig& cfg, bool zeroCopy) {
+    constexpr int64_t kStepNs = 50 * kNsPerUs;
+    const int64_t periodNs = kNsPerSec / cfg.hz;
+    const int64_t endNs = static_cast<int64_t>(cfg.seconds) * kNsPerSec;
+    std::mt19937 rng(cfg.seed);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    HeldFrameTracker tracker(3);
+    SimResult r;
+
+    bool pending = false;             // an update the source has not handed out yet
+    int64_t pendingComposedNs = 0;    // oldest composition in it
+    bool acquiring = false;
+    int64_t acquiredAtNs = 0;
+    uint64_t nextId = 1;
+    bool holding = false;             // zero-copy: a frame is acquired
+    uint64_t heldId = 0;
+    int64_t heldComposedNs = 0;
+    int64_t nextPollNs = 0;
+    uint64_t slotId = 0;              // newest frame in a slot
+    int64_t slotComposedNs = 0;
+    uint64_t shownId = 0;             // newest frame a pass drew
+    bool shownReleased = false;       // and its content is gone
+    uint64_t passId = 0;              // frame the running pass samples (zero-copy)
+    int64_t passEndNs = -1;
+    int64_t nextVblankNs = 0;
+    int64_t nextPassNs = cfg.renderNs;
+
+    for (int64_t now = 0; now < endNs; now += kStepNs) {
+        // Composition at every vblank; the source defers updates while a frame is held.
+        if (now >= nextVblankNs) {
+            nextVblankNs += periodNs;
+            if (coin(rng) < cfg.activity && !pending) {
+                pending = true;
+                pendingComposedNs = now;
+            }
+        }
+        if (pending && !holding && !acquiring) {
+            acquiring = true;
+            acquiredAtNs = std::max(now, pendingComposedNs + cfg.acquireNs);
+        }
+        if (acquiring && now >= acquiredAtNs) {
+            acquiring = false;
+            pending = false;
+            const uint64_t id = nextId++;
+            r.frames++;
+            if (zeroCopy) {
+                (void)tracker.Publish(id, now, pendingComposedNs + periodNs + periodNs / 4);
+                holding = true;
+                heldId = id;
+                heldComposedNs = pendingComposedNs;
+                nextPollNs = now;
+            } else {
+                r.bytes += 2 * cfg.frameBytes;
+                slotId = id;
+                slotComposedNs = pendingComposedNs;
+            }
+        }
+
+        // Render pass: starts at vblank + renderNs and samples for passNs.
+        if (passEndNs >= 0 && now >= passEndNs) {
+            if (passId != 0) tracker.EndSample(passId, 0x7);
+            passEndNs = -1;
+        }
+        if (now >= nextPassNs && passEndNs < 0) {
+            nextPassNs += periodNs;
+            passId = zeroCopy ? tracker.BeginSample() : 0;
+            uint64_t drawId = 0;
+            int64_t composedNs = 0;
+            if (passId != 0) {
+                if (!holding || heldId != passId) r.sampledAfterRelease++;
+                drawId = passId;
+                composedNs = heldComposedNs;
+                shownReleased = false;
+            } else if (slotId != 0 && !(zeroCopy && shownReleased && slotId <= shownId)) {
+                drawId = slotId;
+                composedNs = slotComposedNs;
+                shownReleased = false;
+            }
+            if (drawId == 0) {
+                r.skippedPasses++;
+            } else {
+                r.bytes += 2 * cfg.frameBytes;
+                if (drawId != shownId) {
+                    r.latencySumNs += now + cfg.passNs - composedNs;
+                    r.latencyCount++;
+                    shownId = drawId;
+                }
+                passEndNs = now + cfg.passNs;
+            }
+        }
+
+        // Capture thread polls the held frame.
+        if (holding && now >= nextPollNs) {
+            nextPollNs = now + cfg.pollNs;
+            const HoldDecision d = tracker.Poll(now);
+            if (d != HoldDecision::Hold) {
+                if (d == HoldDecision::ReleaseDeadline) {
+                    r.bytes += 2 * cfg.frameBytes;
+                    slotId = heldId;
+                    slotComposedNs = heldComposedNs;
+                } else if (shownId == heldId) {
+                    shownReleased = true;
+                }
+                holding = false;
+                tracker.Released(now);
+            }
+        }
+    }
+    const HeldFrameStats s = tracker.TakeStats();
+    r.drawnReleased = s.releasedDrawn;
+    r.deadlineCopies = s.releasedDeadline;
+    r.maxHoldNs = s.maxHoldNs;
+    return r;
+}
+
+} // namespace
+
+// Zero-copy Desktop Duplication: the held-frame ownership rules on a simulated clock, a
+// two-thread stress run on the real one, then single_wide copy vs. zero-copy traffic at a
+// few desktop activity levels and render phases.
+int BenchHeldFrame(int argc, char** argv) {
+    const uint32_t width = static_cast<uint32_t>(ArgInt(argc, argv, "--width", 7680));
+    const uint32_t height = static_cast<uint32_t>(ArgInt(argc, argv, "--height", 1440));
+    const uint32_t hz = static_cast<uint32_t>(ArgInt(argc, argv, "--hz", 120));
+    const int seconds = static_cast<int>(ArgInt(argc, argv, "--seconds", 5));
+    const int threadedFrames = static_cast<int>(ArgInt(argc, argv, "--frames", 5000));
+
+    printf("[rj_bench] heldframe %ux%u@%u, %d s simulated\n", width, height, hz, seconds);
+    bool ok = CheckPolicy();
+    ok = CheckWait() && ok;
+    ok = CheckThreaded(threadedFrames) && ok;
+
+    SimConfig cfg;
+    cfg.frameBytes = static_cast<uint64_t>(width) * height * 4u;
+    cfg.hz = hz;
+    cfg.seconds = seconds;
+    cfg.acquireNs = 500 * kNsPerUs;
+    cfg.passNs = 1 * kNsPerMs;
+    cfg.pollNs = 250 * kNsPerUs;
+    cfg.seed = 11;
+    const int64_t periodNs = kNsPerSec / hz;
+
+    struct Scenario {
+        const char* name;
+        double activity;
+        int64_t renderNs;
+    };
+    const Scenario scenarios[] = {
+        {"busy, render after acquire", 1.0, 1 * kNsPerMs},
+        {"busy, render before acquire", 1.0, 200 * kNsPerUs},
+        {"half the vblanks change", 0.5, 1 * kNsPerMs},
+        {"idle desktop", 0.0, 1 * kNsPerMs},
+    };
+    const double gb = 1024.0 * 1024.0 * 1024.0;
+    printf("  %-28s %-5s %7s %7s %7s %7s %8s %9s %9s\n", "scenario", "mode", "frames", "drawn", "copied", "skipped", "GB/s", "hold ms", "lat ms");
+    for (const Scenario& sc : scenarios) {
+        cfg.activity = sc.activity;
+        cfg.renderNs = sc.renderNs;
+        const SimResult copy = Simulate(cfg, false);
+        const SimResult zero = Simulate(cfg, true);
+        auto row = [&](const char* mode, const SimResult& r) {
+            printf("  %-28s %-5s %7llu %7llu %7llu %7llu %8.2f %9.2f %9.2f\n",
+                   sc.name,
+                   mode,
+                   static_cast<unsigned long long>(r.frames),
+                   static_cast<unsigned long long>(r.drawnReleased),
+                   static_cast<unsigned long long>(r.deadlineCopies),
+                   static_cast<unsigned long long>(r.skippedPasses),
+                   static_cast<double>(r.bytes) / gb / seconds,
+                   NsToMs(r.maxHoldNs),
+                   r.latencyCount ? NsToMs(r.latencySumNs) / static_cast<double>(r.latencyCount) : 0.0);
+        };
+        row("copy", copy);
+        row("zero", zero);
+        // Never sampled after release, never held past the deadline by more than a poll step
+        // (one pass at most), and never more traffic than copying.
+        const bool good = zero.sampledAfterRelease == 0 && zero.maxHoldNs <= periodNs + periodNs / 4 + cfg.pollNs + cfg.passNs &&
+                          zero.bytes <= copy.bytes;
+        if (!good) printf("  %s  FAILED\n", sc.name);
+        ok = ok && good;
+    }
+
+    // The headline case: busy desktop, pass after the acquire. Zero-copy drops the slot copy.
+    cfg.activity = 1.0;
+    cfg.renderNs = 1 * kNsPerMs;
+    const SimResult copy = Simulate(cfg, false);
+    const SimResult zero = Simulate(cfg, true);
+    const double ratio = copy.bytes ? static_cast<double>(zero.bytes) / static_cast<double>(copy.bytes) : 1.0;
+    const bool halved = ratio <= 0.55;
+    printf("  single_wide busy: %.1f -> %.1f GB/s (%.0f%%)  %s\n",
+           static_cast<double>(copy.bytes) / gb / seconds,
+           static_cast<double>(zero.bytes) / gb / seconds,
+           100.0 * ratio,
+           halved ? "ok" : "FAILED");
+    ok = ok && halved;
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
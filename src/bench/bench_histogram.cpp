@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/latency_histogram.h"
+
+namespace rj::bench {
+
+namespace {
+
+// Frame-time-like samples: ~8.3 ms with jitter, a 1% tail of hitches up to 50 ms and a few
+// sub-microsecond values.
+std::vector<int64_t> MakeSamples(size_t n) {
+    std::vector<int64_t> v(n);
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    auto next = [&] {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    for (size_t i = 0; i < n; i++) {
+        const uint64_t r = next();
+        const double u = static_cast<double>(r >> 11) / static_cast<double>(1ull << 53);
+        if (i % 100 == 0) {
+            v[i] = 10 * kNsPerMs + static_cast<int64_t>(u * 40.0 * kNsPerMs);
+        } else if (i % 1000 == 1) {
+            v[i] = static_cast<int64_t>(u * 900.0);
+        } else {
+            v[i] = 8333 * kNsPerUs + static_cast<int64_t>((u - 0.5) * 1.5 * kNsPerMs);
+        }
+    }
+    return v;
+}
+
+int64_t ExactPercentile(const std::vector<int64_t>& sorted, double p) {
+    const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size()))));
+    return sorted[target - 1];
+}
+
+bool CheckAccuracy(const std::vector<int64_t>& samples) {
+    auto hist = std::make_unique<LatencyHistogram>();
+    for (int64_t s : samples) hist->Record(s);
+    std::vector<int64_t> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    // The reported value is the bucket's upper bound: never below the exact one and at most
+    // one bucket width above it.
+    const double bound = 1.0 / static_cast<double>(LatencyBuckets::kSubBucketHalf);
+    bool ok = hist->Count() == samples.size() && hist->MaxNs() == sorted.back();
+    double worst = 0.0;
+    for (double p : {0.1, 1.0, 50.0, 90.0, 99.0, 99.9, 99.99, 100.0}) {
+        const int64_t exact = ExactPercentile(sorted, p);
+        const int64_t got = hist->ValueAtPercentileNs(p);
+        const double err = exact > 0 ? static_cast<double>(got - exact) / static_cast<double>(exact) : static_cast<double>(got);
+        worst = std::max(worst, err);
+        if (got < exact || err > bound) ok = false;
+    }
+
+    // Merging per-thread histograms gives the same answer as one histogram.
+    auto merged = std::make_unique<LatencyHistogram>();
+    auto part = std::make_unique<LatencyHistogram>();
+    for (size_t chunk = 0; chunk < 4; chunk++) {
+        part->Reset();
+        for (size_t i = chunk; i < samples.size(); i += 4) part->Record(samples[i]);
+        merged->Merge(*part);
+    }
+    for (double p : {50.0, 99.0, 99.9}) {
+        if (merged->ValueAtPercentileNs(p) != hist->ValueAtPercentileNs(p)) ok = false;
+    }
+
+    printf("  accuracy      samples=%zu buckets=%u (%zu KB) worst rel. error=%.3f%% (bound %.3f%%) merge=%s  %s\n",
+           samples.size(),
+           LatencyBuckets::kCount,
+           sizeof(LatencyHistogram) / 1024,
+           worst * 100.0,
+           bound * 100.0,
+           merged->Count() == hist->Count() ? "equal" : "DIFFERENT",
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+template <typename Fn>
+double NsPerSample(const std::vector<int64_t>& samples, int rounds, Fn record) {
+    const int64_t t0 = HostNowNs();
+    for (int r = 0; r < rounds; r++) {
+        for (int64_t s : samples) record(s);
+    }
+    return static_cast<double>(HostNowNs() - t0) / static_cast<double>(samples.size() * static_cast<size_t>(rounds));
+}
+
+// `writers` threads record into one recorder while this thread takes an interval snapshot
+// every `intervalUs`. Checks that no sample is lost or counted twice.
+bool RunConcurrent(const std::vector<int64_t>& samples, int writers, int rounds, int64_t intervalUs) {
+    auto recorder = std::make_unique<LatencyRecorder>();
+    auto total = std::make_unique<LatencyHistogram>();
+    std::atomic<int> running{writers};
+    std::vector<double> nsPerSample(static_cast<size_t>(writers));
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; w++) {
+        threads.emplace_back([&, w] {
+            nsPerSample[static_cast<size_t>(w)] = NsPerSample(samples, rounds, [&](int64_t s) { recorder->Record(s); });
+            running.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    uint64_t snapshots = 0;
+    int64_t snapshotNs = 0;
+    while (running.load(std::memory_order_acquire) > 0) {
+        const int64_t t0 = HostNowNs();
+        recorder->TakeInterval(*total);
+        snapshotNs += HostNowNs() - t0;
+        snapshots++;
+        std::this_thread::sleep_for(std::chrono::microseconds(intervalUs));
+    }
+    for (std::thread& t : threads) t.join();
+    recorder->TakeInterval(*total);
+
+    double avg = 0.0;
+    for (double ns : nsPerSample) avg += ns;
+    avg /= static_cast<double>(writers);
+    const uint64_t expected = samples.size() * static_cast<uint64_t>(rounds) * static_cast<uint64_t>(writers);
+    const bool ok = total->Count() == expected;
+    printf("  recorder x%d   %6.1f ns/sample  snapshots=%llu (%.1f us each)  recorded=%llu/%llu  %s\n",
+           writers,
+           avg,
+           static_cast<unsigned long long>(snapshots),
+           snapshots ? NsToUs(snapshotNs) / static_cast<double>(snapshots) : 0.0,
+           static_cast<unsigned long long>(total->Count()),
+           static_cast<unsigned long long>(expected),
+           ok ? "ok" : "LOST SAMPLES");
+    return ok;
+}
+
+} // namespace
+
+// Log-linear latency histograms behind the stats line: percentile accuracy against exact
+// sorted samples, merge equivalence, and per-sample recording cost with and without
+// concurrent interval snapshots.
+int BenchHistogram(int argc, char** argv) {
+    const size_t count = static_cast<size_t>(ArgInt(argc, argv, "--samples", 1000000));
+    const int rounds = static_cast<int>(ArgInt(argc, argv, "--rounds", 20));
+    const int writers = static_cast<int>(std::max<int64_t>(1, ArgInt(argc, argv, "--threads", 2)));
+    const int64_t intervalUs = ArgInt(argc, argv, "--snapshot-us", 1000);
+
+    printf("[rj_bench] histogram samples=%zu rounds=%d writers=%d snapshot every %lld us\n",
+           count, rounds, writers, static_cast<long long>(intervalUs));
+    const std::vector<int64_t> samples = MakeSamples(count);
+
+    bool ok = CheckAccuracy(samples);
+
+    auto hist = std::make_unique<LatencyHistogram>();
+    const double plainNs = NsPerSample(samples, rounds, [&](int64_t s) { hist->Record(s); });
+    DoNotOptimize(hist.get());
+    auto recorder = std::make_unique<LatencyRecorder>();
+    const double recorderNs = NsPerSample(samples, rounds, [&](int64_t s) { recorder->Record(s); });
+    DoNotOptimize(recorder.get());
+    printf("  histogram     %6.1f ns/sample (single owner)\n", plainNs);
+    printf("  recorder      %6.1f ns/sample (atomic, uncontended)\n", recorderNs);
+
+    ok = RunConcurrent(samples, 1, rounds, intervalUs) && ok;
+    if (writers > 1) ok = RunConcurrent(samples, writers, rounds / writers + 1, intervalUs) && ok;
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/late_latch.h"
+#include "core/pipeline.h"
+
+namespace rj::bench {
+
+namespace {
+
+// Uniform in [0, 1).
+double NextUnit(uint32_t& state) {
+    return static_cast<double>(NextRandom(state)) / static_cast<double>(1u << 24);
+}
+
+// Capture source whose frames land on a fixed grid of the simulated clock (the captured
+// display's vblanks), independent of when the pipeline first asks.
+class GridSource final : public ICaptureSource {
+public:
+    GridSource(Clock& clock, int64_t periodNs, int64_t phaseNs) : m_clock(clock), m_periodNs(periodNs), m_phaseNs(phaseNs) {}
+
+    const char* Name() const override { return "grid"; }
+    AcquireResult Acquire(uint32_t, FrameDesc& out) override {
+        const int64_t now = m_clock.NowNs();
+        if (now < m_phaseNs) return AcquireResult::Timeout;
+        const int64_t latest = m_phaseNs + (now - m_phaseNs) / m_periodNs * m_periodNs;
+        if (latest == m_lastNs) return AcquireResult::Timeout;
+        m_lastNs = latest;
+        out = FrameDesc{};
+        out.sequence = static_cast<uint64_t>((latest - m_phaseNs) / m_periodNs) + 1;
+        out.captureTimeNs = latest;
+        out.width = 7680;
+        out.height = 1440;
+        out.format = PixelFormat::Bgra8;
+        out.strideBytes = out.width * 4u;
+        return AcquireResult::NewFrame;
+    }
+    void Release() override {}
+
+private:
+    Clock& m_clock;
+    int64_t m_periodNs;
+    int64_t m_phaseNs;
+    int64_t m_lastNs{-1};
+};
+
+// Output whose Present() burns a jittered amount of simulated time, with rare long stalls.
+class JitterSink final : public IOutputSink {
+public:
+    JitterSink(Clock& clock, int64_t costNs, int64_t jitterNs, double spikeRate, int64_t spikeNs, uint32_t seed)
+        : m_clock(clock), m_costNs(costNs), m_jitterNs(jitterNs), m_spikeRate(spikeRate), m_spikeNs(spikeNs), m_rng(seed) {}
+
+    const char* Name() const override { return "jitter"; }
+    void Present(const OutputSlice&) override {
+        int64_t ns = m_costNs + static_cast<int64_t>(NextUnit(m_rng) * static_cast<double>(m_jitterNs));
+        if (NextUnit(m_rng) < m_spikeRate) ns += m_spikeNs;
+        m_clock.SleepForNs(ns);
+    }
+
+private:
+    Clock& m_clock;
+    int64_t m_costNs;
+    int64_t m_jitterNs;
+    double m_spikeRate;
+    int64_t m_spikeNs;
+    uint32_t m_rng;
+};
+
+struct LatchSimConfig {
+    uint64_t frames{};
+    uint32_t hz{};
+    uint32_t contentHz{};
+    uint32_t outputs{};
+    int64_t presentCostNs{};  // per output
+    int64_t jitterNs{};
+    double spikeRate{};
+    int64_t spikeNs{};
+};
+
+struct LatchSimResult {
+    std::unique_ptr<LatencyHistogram> scanout = std::make_unique<LatencyHistogram>();
+    uint64_t frames{};
+    uint64_t misses{};
+    int64_t lastMarginNs{};
+};
+
+// One pipeline run per capture phase; the scanout latency histograms are merged.
+LatchSimResult RunLatchSim(const LatchSimConfig& c, bool lateLatch, const LateLatchConfig& latchCfg, uint32_t phases) {
+    LatchSimResult result;
+    const int64_t contentPeriod = kNsPerSec / static_cast<int64_t>(c.contentHz);
+    for (uint32_t p = 0; p < phases; p++) {
+        ManualClock clock(kNsPerSec);
+        PipelineConfig pcfg;
+        pcfg.vsyncHz = c.hz;
+        pcfg.copyToOwned = false;
+        pcfg.lateLatch = lateLatch;
+        pcfg.lateLatchCfg = latchCfg;
+        FramePipeline pipeline(clock, pcfg);
+        GridSource source(clock, contentPeriod, kNsPerSec + contentPeriod * p / phases);
+        pipeline.AddSource(source);
+        std::vector<std::unique_ptr<JitterSink>> sinks;
+        for (uint32_t i = 0; i < c.outputs; i++) {
+            sinks.push_back(std::make_unique<JitterSink>(clock, c.presentCostNs, c.jitterNs, c.spikeRate, c.spikeNs, 7 + p * 31 + i));
+            pipeline.AddSink(*sinks.back());
+        }
+        for (uint64_t f = 0; f < c.frames; f++) pipeline.RunFrame();
+
+        const LateLatchStats s = pipeline.TakeLateLatchStats();
+        result.frames += s.frames;
+        result.misses += s.misses;
+        result.lastMarginNs = s.marginNs;
+        result.scanout->Merge(pipeline.ScanoutHistogram());
+    }
+    return result;
+}
+
+void PrintLatchResult(const char* label, const LatchSimResult& r, bool lateLatch) {
+    const LatencyPercentiles p = SummarizeLatency(*r.scanout);
+    printf("  %-22s capture->scanout(ms) avg=%.2f p50=%.2f p99=%.2f max=%.2f",
+           label,
+           p.avgUs / 1000.0,
+           p.p50Us / 1000.0,
+           p.p99Us / 1000.0,
+           p.maxUs / 1000.0);
+    if (lateLatch) {
+        printf("  miss=%.2f%% margin=%.0fus", r.frames ? 100.0 * static_cast<double>(r.misses) / static_cast<double>(r.frames) : 0.0, NsToUs(r.lastMarginNs));
+    }
+    printf("\n");
+}
+
+// Display at 119.88 Hz observed through noisy, sometimes missing or late wakeups; the
+// predictor is told 120 Hz.
+bool CheckPredictor(uint32_t seed) {
+    const double truePeriod = 1e9 / 119.88;
+    const int64_t start = 5 * kNsPerSec;
+    VblankPredictor predictor(kNsPerSec / 120);
+    uint32_t rng = seed;
+    double worstUs = 0.0;
+    uint64_t checked = 0;
+    for (uint64_t k = 0; k < 3000; k++) {
+        const int64_t vblank = start + std::llround(static_cast<double>(k) * truePeriod);
+        if (k >= 200) {
+            // Predict this vblank from half a period before it.
+            const int64_t from = vblank - std::llround(truePeriod / 2.0);
+            const double errUs = NsToUs(std::llabs(predictor.NextVblankAfterNs(from) - vblank));
+            worstUs = std::max(worstUs, errUs);
+            checked++;
+        }
+        const double u = NextUnit(rng);
+        // 10% of vblanks go unobserved, wakeups land up to 100 us late and 1% are scheduler
+        // hiccups 3 ms late.
+        if (u < 0.10) continue;
+        int64_t observed = vblank + static_cast<int64_t>(NextUnit(rng) * 100.0 * kNsPerUs);
+        if (u > 0.99) observed += 3 * kNsPerMs;
+        predictor.AddVblank(observed);
+    }
+    const double periodErrPpm = std::fabs(predictor.PeriodNs() - truePeriod) / truePeriod * 1e6;
+    const bool ok = worstUs < 150.0 && periodErrPpm < 100.0;
+    printf("  predictor              119.88 Hz vs nominal 120: period err=%.0f ppm jitter=%.0fus worst next-vblank err=%.0fus over %llu  %s\n",
+           periodErrPpm,
+           predictor.JitterNs() / 1000.0,
+           worstUs,
+           static_cast<unsigned long long>(checked),
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+// Late-latch scheduling vs. today's fixed order (wait for vblank, capture, present) on a
+// simulated display: capture->scanout latency distribution and vblank misses, plus the
+// vblank predictor on a display running off its nominal rate.
+int BenchLatch(int argc, char** argv) {
+    LatchSimConfig c;
+    c.frames = static_cast<uint64_t>(ArgInt(argc, argv, "--frames", 2400));
+    c.hz = static_cast<uint32_t>(ArgInt(argc, argv, "--hz", 120));
+    c.contentHz = static_cast<uint32_t>(ArgInt(argc, argv, "--content-hz", 120));
+    c.outputs = static_cast<uint32_t>(ArgInt(argc, argv, "--outputs", 3));
+    c.presentCostNs = ArgInt(argc, argv, "--present-us", 150) * kNsPerUs;
+    c.jitterNs = ArgInt(argc, argv, "--jitter-us", 100) * kNsPerUs;
+    c.spikeRate = ArgDouble(argc, argv, "--spike-rate", 0.002);
+    c.spikeNs = ArgInt(argc, argv, "--spike-us", 2000) * kNsPerUs;
+    const uint32_t phases = static_cast<uint32_t>(std::max<int64_t>(1, ArgInt(argc, argv, "--phases", 8)));
+    const int64_t marginUs = ArgInt(argc, argv, "--margin-us", 1000);
+
+    printf("[rj_bench] latch hz=%u content=%uHz outputs=%u present=%lldus+%lldus spikes=%.1f%%x%lldus frames=%llu x %u phases\n",
+           c.hz,
+           c.contentHz,
+           c.outputs,
+           static_cast<long long>(c.presentCostNs / kNsPerUs),
+           static_cast<long long>(c.jitterNs / kNsPerUs),
+           c.spikeRate * 100.0,
+           static_cast<long long>(c.spikeNs / kNsPerUs),
+           static_cast<unsigned long long>(c.frames),
+           phases);
+
+    bool ok = CheckPredictor(99);
+
+    const LatchSimResult fixed = RunLatchSim(c, false, LateLatchConfig{}, phases);
+    PrintLatchResult("fixed (wait->capture)", fixed, false);
+
+    LateLatchConfig staticCfg;
+    staticCfg.adaptive = false;
+    staticCfg.marginNs = marginUs * kNsPerUs;
+    const LatchSimResult latchStatic = RunLatchSim(c, true, staticCfg, phases);
+    char label[64];
+    snprintf(label, sizeof(label), "late latch %lldus", static_cast<long long>(marginUs));
+    PrintLatchResult(label, latchStatic, true);
+
+    LateLatchConfig adaptiveCfg;
+    adaptiveCfg.marginNs = marginUs * kNsPerUs;
+    const LatchSimResult latchAdaptive = RunLatchSim(c, true, adaptiveCfg, phases);
+    PrintLatchResult("late latch adaptive", latchAdaptive, true);
+
+    // Latching late must pay off on the median without turning into missed vblanks.
+    const double fixedP50 = static_cast<double>(fixed.scanout->ValueAtPercentileNs(50.0));
+    const double latchP50 = static_cast<double>(latchAdaptive.scanout->ValueAtPercentileNs(50.0));
+    const double missRate = latchAdaptive.frames ? static_cast<double>(latchAdaptive.misses) / static_cast<double>(latchAdaptive.frames) : 1.0;
+    const bool better = latchP50 < fixedP50 && missRate < 0.02;
+    printf("  adaptive vs fixed      p50 %.2f -> %.2f ms, miss rate %.2f%%  %s\n",
+           fixedP50 / 1e6,
+           latchP50 / 1e6,
+           missRate * 100.0,
+           better ? "ok" : "FAILED");
+    ok = ok && better;
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
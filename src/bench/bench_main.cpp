@@ -0,0 +1,63 @@
+// rj_bench: headless benchmarks for rj_core. Runs on any platform without a GPU.
+//
+// Usage: rj_bench <name> [--option=value ...]
+
+#include <cstdio>
+#include <cstring>
+
+#include "bench/bench.h"
+
+namespace {
+
+struct BenchEntry {
+    const char* name;
+    int (*fn)(int argc, char** argv);
+    const char* help;
+};
+
+const BenchEntry kBenches[] = {
+    {"pipeline", rj::bench::BenchPipeline, "headless frame pipeline (--frames --hz --outputs --tiles --sink=null|memory --realtime --late-latch --present-on-change --partial-outputs --hash-tiles --trace=file --record=base --replay=base --replay-fast)"},
+    {"slicer", rj::bench::BenchSlicer, "CPU slicer kernels vs. the shader model (--width --height --outputs --iters)"},
+    {"slices", rj::bench::BenchSlices, "slice and blit planner checks, bytes moved per frame: shader vs. blit per capture path, driver-side slices (--width --height --hz --outputs --iters)"},
+    {"coalescer", rj::bench::BenchCoalescer, "dirty/move rect coalescing on rect streams (--workload=typing|scroll|windows|video|hud --stream=file)"},
+    {"handoff", rj::bench::BenchHandoff, "latest-frame handoff: triple buffer vs. mutex, plus stress check (--seconds --hz --reads --hold-ns)"},
+    {"capture", rj::bench::BenchCapture, "serial vs. threaded vs. per-tile capture (--tiles --acquire-cost-us --present-cost-us --unpaced --depth --slow-tile-us --coherence)"},
+    {"coherence", rj::bench::BenchCoherence, "tile coherence policies on simulated outputs (--tiles --hz --jitter-us --slow-tile --idle-tile --window-us)"},
+    {"histogram", rj::bench::BenchHistogram, "latency histogram accuracy and per-sample cost (--samples --rounds --threads --snapshot-us)"},
+    {"trace", rj::bench::BenchTrace, "trace ring per-event cost, concurrent snapshots and dump round trip (--events --threads --capacity)"},
+    {"latch", rj::bench::BenchLatch, "late-latch scheduling vs. fixed order on a simulated display (--hz --content-hz --present-us --jitter-us --spike-rate --margin-us --phases)"},
+    {"channel", rj::bench::BenchChannel, "IDD frame channel across processes: integrity, restart, latency (--width --height --frames --hz)"},
+    {"swapchain", rj::bench::BenchSwapchain, "IDD swap-chain loop: event-driven state machine vs. 16 ms polling on a mock swap-chain (--seconds --process-us --idle-ms)"},
+    {"edid", rj::bench::BenchEdid, "CVT-RB timings, virtual display mode config and EDID/DisplayID round trips (--config=NxWxH@hz,... --iters)"},
+    {"devicecache", rj::bench::BenchDeviceCache, "IDD render device cache: reuse policy on a mock factory, assign->first frame with and without it (--assignments --hz --bind-ms --seed)"},
+    {"heldframe", rj::bench::BenchHeldFrame, "zero-copy Desktop Duplication: held-frame ownership rules, threaded stress, single_wide copy vs. in-place traffic (--width --height --hz --seconds --frames)"},
+    {"present", rj::bench::BenchPresent, "damage-driven presentation: policy and damage mapping rules, draw/present work per second at idle, 60 and 120 fps content, whole vs. partial (--hz --seconds --outputs --draw-us --keepalive-ms)"},
+    {"tilehash", rj::bench::BenchTileHash, "64x64 tile content hashes for sources without dirty rects: hash and change-mask rules, scalar vs. SIMD vs. threaded ms/frame hot and cold, partial updates from hashes (--width --height --threads --buffers --iters --budget-ms --seconds)"},
+    {"codec", rj::bench::BenchCodec, "lossless frame codec: round trips, skip/raw/keyframe rules, scalar vs. SIMD vs. threaded, ratio and encode/decode ms per frame by content (--width --height --threads --frames --fps)"},
+    {"replay", rj::bench::BenchReplay, "capture recorder and replay source: pipeline session record/replay equivalence, segment rollover and recovery, record/write/replay cost per frame (--width --height --frames --threads --base --keep)"},
+    {"replayring", rj::bench::BenchReplayRing, "instant-replay ring: window, budget and keyframe-group eviction, RAM+spill, save/replay, submit cost and fps held per GiB (--width --height --hz --frames --threads --memory-mb --spill-mb --base)"},
+    {"readback", rj::bench::BenchReadback, "async GPU readback ring: plan and box-filter rules, in-order delayed results on a mock GPU, per-frame readback sync vs. ring in a simulated render loop (--width --height --hz --frames --cpu-us --gpu-us)"},
+    {"placeholder", rj::bench::BenchPlaceholder, "placeholder-frame detector: scalar/SIMD agreement, labelled corpus at full size and as the 1/16 probe, firing rule, us per frame by kernel and size (--width --height --iters --budget-us --verbose --file=frame.bgra)"},
+    {"backends", rj::bench::BenchBackends, "capture backend auto-selection: probe scenarios on simulated backends with scripted timing, window rules, per-topology choice cache (--hz --warmup-ms --window-ms --min-frames --seed)"},
+};
+
+void PrintUsage() {
+    printf("usage: rj_bench <name> [--option=value ...]\n");
+    for (const auto& b : kBenches) {
+        printf("  %-12s %s\n", b.name, b.help);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        PrintUsage();
+        return 1;
+    }
+    for (const auto& b : kBenches) {
+        if (strcmp(argv[1], b.name) == 0) return b.fn(argc - 2, argv + 2);
+    }
+    PrintUsage();
+    return 1;
+}
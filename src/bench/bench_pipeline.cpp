@@ -0,0 +1,220 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/capture_recorder.h"
+#include "core/pipeline.h"
+#include "core/replay_source.h"
+#include "core/sinks.h"
+#include "core/synthetic_source.h"
+#include "core/trace_ring.h"
+
+namespace rj::bench {
+
+// Runs the headless pipeline against the synthetic 7680x1440 source and prints the same
+// 1 Hz stats line as rj_span, plus the host CPU cost per frame. By default the clock is
+// simulated so results do not depend on the machine's timer slack; --realtime uses the
+// steady clock and really sleeps. --late-latch captures just before the predicted vblank
+// instead of right after it. --present-on-change skips passes without a new frame
+// (PresentPolicy), --partial-outputs also skips the outputs it did not change, and
+// --hash-tiles (implies --partial-outputs) drops the source's dirty rects and finds the
+// changes from tile hashes like a WGC/IDD source would need. --trace=<file> writes the
+// frame trace as an rj_trace dump. --record=<base> records what the sources hand out
+// (CaptureRecorder); --replay=<base> feeds such a recording, or one made by rj_span, back
+// in place of the synthetic sources with its original timing (--replay-fast: as fast as
+// possible). With several --tiles, tile t uses <base>_tile<t>.
+int BenchPipeline(int argc, char** argv) {
+    const uint64_t frames = static_cast<uint64_t>(ArgInt(argc, argv, "--frames", 1200));
+    const uint32_t hz = static_cast<uint32_t>(ArgInt(argc, argv, "--hz", 120));
+    const uint32_t outputs = static_cast<uint32_t>(ArgInt(argc, argv, "--outputs", 3));
+    const uint32_t tiles = static_cast<uint32_t>(ArgInt(argc, argv, "--tiles", 1));
+    const uint32_t wideW = static_cast<uint32_t>(ArgInt(argc, argv, "--width", 7680));
+    const uint32_t wideH = static_cast<uint32_t>(ArgInt(argc, argv, "--height", 1440));
+    const char* sinkKind = ArgStr(argc, argv, "--sink", "null");
+    const bool realtime = ArgFlag(argc, argv, "--realtime");
+    const bool noPixels = ArgFlag(argc, argv, "--no-pixels");
+    const bool lateLatch = ArgFlag(argc, argv, "--late-latch");
+    const bool hashTiles = ArgFlag(argc, argv, "--hash-tiles");
+    const bool partialOutputs = hashTiles || ArgFlag(argc, argv, "--partial-outputs");
+    const bool presentOnChange = partialOutputs || ArgFlag(argc, argv, "--present-on-change");
+    const char* tracePath = ArgStr(argc, argv, "--trace", nullptr);
+    const char* recordBase = ArgStr(argc, argv, "--record", nullptr);
+    const char* replayBase = ArgStr(argc, argv, "--replay", nullptr);
+    const bool replayFast = ArgFlag(argc, argv, "--replay-fast");
+
+    SteadyClock steady;
+    ManualClock manual;
+    Clock& clock = realtime ? static_cast<Clock&>(steady) : static_cast<Clock&>(manual);
+
+    PipelineConfig pcfg;
+    pcfg.outputWidth = wideW / outputs;
+    pcfg.outputHeight = wideH;
+    pcfg.vsyncHz = hz;
+    pcfg.lateLatch = lateLatch;
+    pcfg.presentOnNewContent = presentOnChange;
+    pcfg.partialOutputs = partialOutputs;
+    pcfg.hashTiles = hashTiles;
+    std::unique_ptr<TraceRing> trace;
+    if (tracePath) {
+        trace = std::make_unique<TraceRing>();
+        pcfg.trace = trace.get();
+    }
+    FramePipeline pipeline(clock, pcfg);
+
+    auto tileBase = [&](const char* base, uint32_t t) { return tiles > 1 ? std::string(base) + "_tile" + std::to_string(t) : std::string(base); };
+    std::vector<std::unique_ptr<SyntheticSource>> sources;
+    std::vector<std::unique_ptr<ReplaySource>> replays;
+    std::vector<std::unique_ptr<CaptureRecorder>> recorders;
+    std::vector<std::unique_ptr<RecordingSource>> recordings;
+    for (uint32_t t = 0; t < tiles; t++) {
+        ICaptureSource* source = nullptr;
+        if (replayBase) {
+            ReplayConfig rcfg;
+            rcfg.timing = replayFast ? ReplayTiming::AsFastAsPossible : ReplayTiming::Original;
+            replays.push_back(std::make_unique<ReplaySource>(clock, rcfg));
+            const std::string base = tileBase(replayBase, t);
+            if (!replays.back()->Open(base.c_str())) {
+                printf("[rj_bench] no recording at %s\n", RecordingSegmentPath(base, 0).c_str());
+                return 1;
+            }
+            source = replays.back().get();
+        } else {
+            SyntheticSourceConfig scfg;
+            scfg.width = wideW / tiles;
+            scfg.height = wideH;
+            scfg.hz = hz;
+            scfg.patternWidth = wideW;
+            scfg.originX = scfg.width * t;
+            scfg.cpuPixels = !noPixels;
+            scfg.dirtyRects = !hashTiles;
+            sources.push_back(std::make_unique<SyntheticSource>(clock, scfg));
+            source = sources.back().get();
+        }
+        if (recordBase) {
+            // Simulated time runs ahead of the writer; only real time may drop frames.
+            RecorderConfig rcfg;
+            rcfg.dropWhenFull = realtime;
+            recorders.push_back(std::make_unique<CaptureRecorder>(rcfg));
+            const std::string base = tileBase(recordBase, t);
+            if (!recorders.back()->Start(base.c_str())) {
+                printf("[rj_bench] cannot record to %s\n", RecordingSegmentPath(base, 0).c_str());
+                return 1;
+            }
+            recordings.push_back(std::make_unique<RecordingSource>(clock, *source, *recorders.back()));
+            source = recordings.back().get();
+        }
+        pipeline.AddSource(*source);
+    }
+
+    std::vector<std::unique_ptr<IOutputSink>> sinks;
+    for (uint32_t i = 0; i < outputs; i++) {
+        if (strcmp(sinkKind, "memory") == 0) {
+            sinks.push_back(std::make_unique<MemorySink>(pcfg.outputWidth, pcfg.outputHeight));
+        } else {
+            sinks.push_back(std::make_unique<NullSink>());
+        }
+        pipeline.AddSink(*sinks.back());
+    }
+
+    int64_t hostTotalNs = 0;
+    int64_t hostMaxNs = 0;
+    int64_t lastLogNs = clock.NowNs();
+    uint64_t lastLogFrames = 0;
+    uint64_t lastLogOutputs = 0;
+    for (uint64_t f = 0; f < frames; f++) {
+        const int64_t h0 = HostNowNs();
+        if (!pipeline.RunFrame()) {
+            printf("[rj_bench] source reported access lost or an error\n");
+            return 1;
+        }
+        const int64_t dt = HostNowNs() - h0;
+        hostTotalNs += dt;
+        if (dt > hostMaxNs) hostMaxNs = dt;
+
+        const int64_t now = clock.NowNs();
+        if (now - lastLogNs >= kNsPerSec || f + 1 == frames) {
+            StatsLineInfo info;
+            info.backend = replayBase ? "REPLAY" : "SYNTH";
+            info.ddMode = pipeline.ModeName();
+            info.fps = static_cast<float>(static_cast<double>(pipeline.RenderedFrames() - lastLogFrames) * 1e9 / static_cast<double>(now - lastLogNs));
+            info.latencyUs = pipeline.LastCopyToPresentUs();
+            info.width = pipeline.CaptureWidth();
+            info.height = pipeline.CaptureHeight();
+            info.expectedW = wideW;
+            info.expectedH = wideH;
+            info.expectedHz = hz;
+            info.summary = pipeline.Stats().TakeAndReset();
+            if (lateLatch) {
+                const LateLatchStats latch = pipeline.TakeLateLatchStats();
+                info.latchMarginUs = static_cast<float>(NsToUs(latch.marginNs));
+                info.latchSlackMinUs = static_cast<float>(NsToUs(latch.slackMinNs));
+                info.latchMisses = latch.misses;
+            }
+            if (presentOnChange) {
+                const PresentPolicyStats present = pipeline.TakePresentStats();
+                info.presents = present.presents;
+                info.passes = present.passes;
+                info.keepAlives = present.keepAlives;
+                if (present.presents > 0) {
+                    info.presentOutputsAvg = static_cast<float>(static_cast<double>(pipeline.PresentedOutputs() - lastLogOutputs) /
+                                                                static_cast<double>(present.presents));
+                    info.outputs = outputs;
+                }
+                lastLogOutputs = pipeline.PresentedOutputs();
+            }
+            char buf[kStatsLineBytes];
+            FormatStatsLine(buf, sizeof(buf), info);
+            fputs(buf, stdout);
+            lastLogNs = now;
+            lastLogFrames = pipeline.RenderedFrames();
+        }
+    }
+
+    uint64_t skipped = 0;
+    for (const auto& s : sources) skipped += s->FramesSkipped();
+    printf("[rj_bench] pipeline frames=%llu copied=%llu source_skipped=%llu host(us/frame) avg=%.1f max=%.1f\n",
+           static_cast<unsigned long long>(frames),
+           static_cast<unsigned long long>(pipeline.CopiedFrames()),
+           static_cast<unsigned long long>(skipped),
+           NsToUs(hostTotalNs) / static_cast<double>(frames ? frames : 1),
+           NsToUs(hostMaxNs));
+    for (const auto& r : replays) {
+        printf("[rj_bench] replay: %llu of %zu recorded frames in %u segments\n",
+               static_cast<unsigned long long>(r->FramesReplayed()),
+               r->Reader().FrameCount(),
+               r->Reader().Segments());
+    }
+    for (auto& r : recorders) {
+        r->Stop();
+        const RecorderStats rs = r->Stats();
+        printf("[rj_bench] record: %llu frames (%llu dropped) in %u segments, %.1f MB -> %s_NNNN.rjr%s\n",
+               static_cast<unsigned long long>(rs.frames),
+               static_cast<unsigned long long>(rs.dropped),
+               rs.segments,
+               static_cast<double>(rs.bytes) / 1e6,
+               r->BasePath().c_str(),
+               rs.failed ? " (write FAILED)" : "");
+        if (rs.failed) return 1;
+    }
+    const CaptureLatency& scanout = pipeline.ScanoutLatency();
+    if (scanout.frames > 0) {
+        printf("[rj_bench] capture->scanout(ms) avg=%.2f p99=%.2f max=%.2f\n",
+               scanout.AvgUs() / 1000.0,
+               NsToMs(pipeline.ScanoutHistogram().ValueAtPercentileNs(99.0)),
+               NsToMs(scanout.maxNs));
+    }
+
+    if (trace) {
+        std::vector<TraceRecord> records;
+        trace->Snapshot(records);
+        FILE* f = fopen(tracePath, "wb");
+        const bool ok = f && WriteTraceDump(f, records, trace->ThreadNames());
+        if (f && fclose(f) != 0) return 1;
+        printf("[rj_bench] trace: %zu events -> %s%s\n", records.size(), tracePath, ok ? "" : " (write FAILED)");
+        if (!ok) return 1;
+    }
+    return 0;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,401 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/cpu_features.h"
+#include "core/placeholder_detector.h"
+#include "core/readback.h"
+
+namespace rj::bench {
+
+namespace {
+
+struct Image {
+    uint32_t width{};
+    uint32_t height{};
+    uint32_t strideBytes{};
+    std::vector<uint8_t> pixels;
+
+    Image(uint32_t w, uint32_t h, uint32_t padBytes = 0) : width(w), height(h), strideBytes(w * 4u + padBytes), pixels(static_cast<size_t>(strideBytes) * h) {}
+
+    uint8_t* At(uint32_t x, uint32_t y) { return pixels.data() + static_cast<size_t>(y) * strideBytes + x * 4u; }
+    void Set(uint32_t x, uint32_t y, int b, int g, int r) {
+        uint8_t* p = At(x, y);
+        p[0] = static_cast<uint8_t>(std::clamp(b, 0, 255));
+        p[1] = static_cast<uint8_t>(std::clamp(g, 0, 255));
+        p[2] = static_cast<uint8_t>(std::clamp(r, 0, 255));
+        p[3] = 255;
+    }
+    void Fill(int b, int g, int r) {
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) Set(x, y, b, g, r);
+        }
+    }
+    void FillRect(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, int b, int g, int r) {
+        for (uint32_t y = y0; y < std::min(y1, height); y++) {
+            for (uint32_t x = x0; x < std::min(x1, width); x++) Set(x, y, b, g, r);
+        }
+    }
+};
+
+// Lines of "text": short runs of `ink` on the rows of each line, `coverage` of the line.
+void DrawText(Image& img, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, uint32_t lineH, double coverage, int b, int g, int r, std::mt19937& rng) {
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (uint32_t y = y0; y + lineH <= y1; y += lineH) {
+        const uint32_t end = x0 + static_cast<uint32_t>((x1 - x0) * (0.3 + 0.7 * u(rng)));
+        for (uint32_t x = x0; x < end; x += 3) {
+            if (u(rng) >= coverage * 3.0) continue;
+            for (uint32_t dy = lineH / 4; dy < lineH * 3 / 4; dy++) img.Set(x, y + dy, b, g, r);
+        }
+    }
+}
+
+// Smooth noise in [-1, 1]: random values on a `cell`-pixel lattice, bilinearly interpolated.
+class ValueNoise {
+public:
+    ValueNoise(uint32_t w, uint32_t h, uint32_t cell, uint32_t seed) : m_cell(cell), m_cols(w / cell + 2), m_values(static_cast<size_t>(m_cols) * (h / cell + 2)) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> u(-1.0, 1.0);
+        for (double& v : m_values) v = u(rng);
+    }
+    double At(uint32_t x, uint32_t y) const {
+        const uint32_t cx = x / m_cell, cy = y / m_cell;
+        const double fx = static_cast<double>(x % m_cell) / m_cell, fy = static_cast<double>(y % m_cell) / m_cell;
+        auto v = [&](uint32_t i, uint32_t j) { return m_values[static_cast<size_t>(j) * m_cols + i]; };
+        const double top = v(cx, cy) * (1 - fx) + v(cx + 1, cy) * fx;
+        const double bottom = v(cx, cy + 1) * (1 - fx) + v(cx + 1, cy + 1) * fx;
+        return top * (1 - fy) + bottom * fy;
+    }
+
+private:
+    uint32_t m_cell;
+    uint32_t m_cols;
+    std::vector<double> m_values;
+};
+
+Image MakeDesktop(uint32_t w, uint32_t h, uint32_t seed) {
+    Image img(w, h);
+    const ValueNoise wallpaper(w, h, 256, seed);
+    for (uint32_t y = 0; y < h; y++) {
+        for (uint32_t x = 0; x < w; x++) {
+            const double n = wallpaper.At(x, y);
+            img.Set(x, y, 140 + static_cast<int>(60 * n), 90 + static_cast<int>(40 * n), 40 + static_cast<int>(30 * n));
+        }
+    }
+    std::mt19937 rng(seed);
+    for (int win = 0; win < 4; win++) {
+        const uint32_t x0 = rng() % (w / 2), y0 = rng() % (h / 2);
+        const uint32_t x1 = x0 + w / 4 + rng() % (w / 4), y1 = y0 + h / 4 + rng() % (h / 4);
+        img.FillRect(x0, y0, x1, y0 + 32, 60, 60, 60);
+        img.FillRect(x0, y0 + 32, x1, y1, 250, 250, 250);
+        DrawText(img, x0 + 8, y0 + 40, x1 - 8, y1, 18, 0.25, 20, 20, 20, rng);
+    }
+    img.FillRect(0, h - 48, w, h, 30, 30, 30);  // taskbar
+    return img;
+}
+
+Image MakeDarkIde(uint32_t w, uint32_t h, uint32_t seed) {
+    Image img(w, h);
+    img.Fill(0x1e, 0x1e, 0x1e);
+    img.FillRect(0, 0, w / 6, h, 0x25, 0x25, 0x25);  // sidebar
+    std::mt19937 rng(seed);
+    DrawText(img, 8, 8, w / 6 - 8, h, 22, 0.2, 0xcc, 0xcc, 0xcc, rng);
+    DrawText(img, w / 6 + 40, 8, w, h - 24, 20, 0.3, 0xd4, 0xd4, 0xd4, rng);
+    DrawText(img, w / 6 + 40, 18, w * 2 / 3, h - 24, 40, 0.15, 0xd6, 0x9c, 0x56, rng);  // keywords
+    img.FillRect(0, h - 24, w, h, 0xcc, 0x7a, 0x00);                                     // status bar
+    return img;
+}
+
+Image MakeDocument(uint32_t w, uint32_t h, uint32_t seed) {
+    Image img(w, h);
+    img.Fill(255, 255, 255);
+    std::mt19937 rng(seed);
+    for (uint32_t y = h / 12; y < h - h / 12; y += h / 6) DrawText(img, w / 8, y, w - w / 8, y + h / 8, 16, 0.2, 0, 0, 0, rng);
+    return img;
+}
+
+Image MakePhoto(uint32_t w, uint32_t h, uint32_t seed) {
+    Image img(w, h);
+    const ValueNoise coarse(w, h, 160, seed), fine(w, h, 12, seed + 1);
+    for (uint32_t y = 0; y < h; y++) {
+        for (uint32_t x = 0; x < w; x++) {
+            const double c = coarse.At(x, y), f = fine.At(x, y);
+            img.Set(x, y, 90 + static_cast<int>(70 * c + 20 * f), 120 + static_cast<int>(60 * c - 25 * f), 150 + static_cast<int>(80 * c + 15 * f));
+        }
+    }
+    return img;
+}
+
+// A grassy game scene: mostly green, with lighting that changes over tens of pixels.
+Image MakeGreenScene(uint32_t w, uint32_t h, uint32_t seed) {
+    Image img(w, h);
+    const ValueNoise light(w, h, 48, seed), detail(w, h, 6, seed + 1);
+    std::mt19937 rng(seed);
+    for (uint32_t y = 0; y < h; y++) {
+        for (uint32_t x = 0; x < w; x++) {
+            const double l = light.At(x, y), d = detail.At(x, y);
+            img.Set(x, y, 30 + static_cast<int>(20 * l), 150 + static_cast<int>(60 * l + 25 * d), 50 + static_cast<int>(30 * l + 10 * d));
+        }
+    }
+    img.FillRect(0, 0, w, h / 4, 235, 180, 120);  // sky
+    return img;
+}
+
+Image MakeNoisySolid(uint32_t w, uint32_t h, int b, int g, int r, int amplitude, uint32_t seed) {
+    Image img(w, h);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> n(-amplitude, amplitude);
+    for (uint32_t y = 0; y < h; y++) {
+        for (uint32_t x = 0; x < w; x++) img.Set(x, y, b + n(rng), g + n(rng), r + n(rng));
+    }
+    return img;
+}
+
+// A gold placeholder with a vertical shading gradient.
+Image MakeGoldGradient(uint32_t w, uint32_t h) {
+    Image img(w, h);
+    for (uint32_t y = 0; y < h; y++) {
+        const int t = static_cast<int>(24 * y / h);
+        for (uint32_t x = 0; x < w; x++) img.Set(x, y, t, 170 + t, 255);
+    }
+    return img;
+}
+
+// The desktop seen through a 90% green overlay.
+Image MakeTintedDesktop(uint32_t w, uint32_t h, uint32_t seed) {
+    Image img = MakeDesktop(w, h, seed);
+    for (uint32_t y = 0; y < h; y++) {
+        for (uint32_t x = 0; x < w; x++) {
+            uint8_t* p = img.At(x, y);
+            img.Set(x, y, p[0] / 10, 180 + p[1] / 10, p[2] / 10);
+        }
+    }
+    return img;
+}
+
+struct CorpusFrame {
+    const char* name;
+    FrameContent expect;
+    Image image;
+};
+
+std::vector<CorpusFrame> MakeCorpus(uint32_t w, uint32_t h) {
+    std::vector<CorpusFrame> c;
+    Image green(w, h), gold(w, h), black(w, h);
+    green.Fill(0, 200, 0);
+    gold.Fill(0, 191, 255);
+    black.Fill(0, 0, 0);
+    c.push_back({"wgc green", FrameContent::Constant, std::move(green)});
+    c.push_back({"wgc gold", FrameContent::Constant, std::move(gold)});
+    c.push_back({"green +-2", FrameContent::NearConstant, MakeNoisySolid(w, h, 0, 200, 0, 2, 5)});
+    c.push_back({"gold shade", FrameContent::Tinted, MakeGoldGradient(w, h)});
+    c.push_back({"green tint", FrameContent::Tinted, MakeTintedDesktop(w, h, 6)});
+    c.push_back({"desktop", FrameContent::Content, MakeDesktop(w, h, 7)});
+    c.push_back({"dark ide", FrameContent::Content, MakeDarkIde(w, h, 8)});
+    c.push_back({"document", FrameContent::Content, MakeDocument(w, h, 9)});
+    c.push_back({"photo", FrameContent::Content, MakePhoto(w, h, 10)});
+    c.push_back({"green scene", FrameContent::Content, MakeGreenScene(w, h, 11)});
+    c.push_back({"black", FrameContent::Dark, std::move(black)});
+    c.push_back({"black +-1", FrameContent::Dark, MakeNoisySolid(w, h, 0, 0, 0, 1, 12)});
+    return c;
+}
+
+// What rj_span's content probe sees: the frame box-filtered by `factor`.
+Image Downsample(const Image& src, uint32_t factor) {
+    ReadbackPlan plan;
+    PlanReadback(src.width, src.height, Rect{}, factor, plan);
+    Image out(plan.width, plan.height);
+    DownsampleBox(src.pixels.data(), src.strideBytes, plan, out.pixels.data(), out.strideBytes);
+    return out;
+}
+
+bool SameStats(const SampleStats& a, const SampleStats& b) {
+    return a.samples == b.samples && memcmp(a.sum, b.sum, sizeof(a.sum)) == 0 && memcmp(a.sumSq, b.sumSq, sizeof(a.sumSq)) == 0 &&
+           memcmp(a.lumaHist, b.lumaHist, sizeof(a.lumaHist)) == 0;
+}
+
+FrameContent Classify(const Image& img, const PlaceholderConfig& cfg, ContentStats* stats = nullptr) {
+    SampleStats s;
+    if (!SampleFrameStats(img.pixels.data(), img.strideBytes, img.width, img.height, cfg.gridCols, cfg.gridRows, s)) return FrameContent::Unknown;
+    const ContentStats c = SummarizeSamples(s);
+    if (stats) *stats = c;
+    return ClassifyContent(c, cfg);
+}
+
+bool CheckCorpus(const std::vector<CorpusFrame>& corpus, uint32_t probeFactor, bool verbose) {
+    const PlaceholderConfig cfg;
+    bool ok = true;
+    if (verbose) printf("  %-12s %-14s %-14s %7s %7s %7s %7s\n", "frame", "full", "probe", "stddev", "chroma", "luma", "entropy");
+    for (const CorpusFrame& f : corpus) {
+        ContentStats full{}, probe{};
+        const FrameContent a = Classify(f.image, cfg, &full);
+        const Image small = Downsample(f.image, probeFactor);
+        const FrameContent b = Classify(small, cfg, &probe);
+        // The box filter averages noise away, so a probe may see a different placeholder kind.
+        const bool good = a == f.expect && (b == f.expect || (IsPlaceholder(b) && IsPlaceholder(f.expect)));
+        ok = ok && good;
+        if (verbose || !good) {
+            printf("  %-12s %-14s %-14s %7.2f %7.1f %7.1f %7.2f%s\n",
+                   f.name,
+                   FrameContentName(a),
+                   FrameContentName(b),
+                   static_cast<double>(probe.maxStddev),
+                   static_cast<double>(probe.chroma),
+                   static_cast<double>(probe.meanLuma),
+                   static_cast<double>(probe.lumaEntropyBits),
+                   good ? "" : "  FAILED");
+        }
+    }
+    printf("  corpus: %zu labelled frames classified at full size and as a 1/%u probe  %s\n", corpus.size(), probeFactor, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+bool CheckKernels(const std::vector<CorpusFrame>& corpus) {
+    bool ok = true;
+    auto same = [&](const Image& img, uint32_t cols, uint32_t rows) {
+        SampleStats scalar, simd;
+        const bool a = SampleFrameStats(img.pixels.data(), img.strideBytes, img.width, img.height, cols, rows, scalar, SimdLevel::Scalar);
+        const bool b = SampleFrameStats(img.pixels.data(), img.strideBytes, img.width, img.height, cols, rows, simd, SimdLevel::Avx2);
+        ok = ok && a == b && SameStats(scalar, simd);
+    };
+    for (const CorpusFrame& f : corpus) same(f.image, 64, 32);
+    // Odd sizes, padded rows, one run, more runs than fit.
+    Image odd(37, 5, 12);
+    std::mt19937 rng(3);
+    for (uint8_t& b : odd.pixels) b = static_cast<uint8_t>(rng());
+    same(odd, 64, 32);
+    same(odd, 1, 1);
+    same(corpus[5].image, 1000, 1000);
+    SampleStats s;
+    const bool narrow = !SampleFrameStats(odd.pixels.data(), odd.strideBytes, kSampleRun - 1, 5, 64, 32, s) && s.samples == 0;
+    printf("  kernels: scalar and %s sums and histograms identical, narrow frames rejected  %s\n", SimdLevelName(DetectSimdLevel()),
+           ok && narrow ? "ok" : "FAILED");
+    return ok && narrow;
+}
+
+bool CheckDetector(const std::vector<CorpusFrame>& corpus) {
+    PlaceholderConfig cfg;
+    cfg.triggerFrames = 5;
+    PlaceholderDetector d(cfg);
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  detector: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+    auto feed = [&](const Image& img) { return d.Update(img.pixels.data(), img.strideBytes, img.width, img.height); };
+    const Image& green = corpus[0].image;
+    const Image& desktop = corpus[5].image;
+    const Image& black = corpus[10].image;
+    for (int i = 0; i < 4; i++) feed(green);
+    expect(!d.Fired() && d.Streak() == 4, "fewer than triggerFrames placeholders don't fire");
+    feed(desktop);
+    expect(d.Streak() == 0 && d.Last() == FrameContent::Content, "content resets the streak");
+    for (int i = 0; i < 4; i++) feed(black);
+    expect(!d.Fired() && d.Streak() == 0, "dark frames are not placeholders");
+    for (int i = 0; i < 5; i++) feed(i % 2 ? corpus[3].image : green);
+    expect(d.Fired(), "placeholders in a row fire, whatever their kind");
+    feed(desktop);
+    expect(d.Fired(), "fired stays fired");
+    d.Reset();
+    expect(!d.Fired() && d.Last() == FrameContent::Unknown, "reset");
+    expect(d.Update(green.pixels.data(), green.strideBytes, 4, 4) == FrameContent::Unknown && d.Streak() == 0, "too small to sample");
+    printf("  detector: streak, reset by content, dark ignored, latch, reset  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+double MedianUs(std::vector<int64_t>& ns) {
+    std::sort(ns.begin(), ns.end());
+    return NsToUs(ns[ns.size() / 2]);
+}
+
+double TimeUs(const Image& img, const PlaceholderConfig& cfg, SimdLevel level, int iters) {
+    std::vector<int64_t> ns;
+    ns.reserve(iters);
+    PlaceholderDetector d(cfg, level);
+    for (int i = 0; i < iters; i++) {
+        const int64_t t0 = HostNowNs();
+        d.Update(img.pixels.data(), img.strideBytes, img.width, img.height);
+        ns.push_back(HostNowNs() - t0);
+        DoNotOptimize(&d);
+    }
+    return MedianUs(ns);
+}
+
+int ClassifyFile(const char* path, uint32_t width, uint32_t height) {
+    Image img(width, height);
+    FILE* f = fopen(path, "rb");
+    const bool read = f && fread(img.pixels.data(), 1, img.pixels.size(), f) == img.pixels.size();
+    if (f) fclose(f);
+    if (!read) {
+        printf("[rj_bench] placeholder: can't read %ux%u BGRA from %s\n", width, height, path);
+        return 1;
+    }
+    ContentStats s{};
+    const FrameContent c = Classify(img, PlaceholderConfig{}, &s);
+    printf("[rj_bench] placeholder %s: %s mean(bgr)=%.1f/%.1f/%.1f stddev(bgr)=%.2f/%.2f/%.2f chroma=%.1f luma=%.1f entropy=%.2f bits\n",
+           path,
+           FrameContentName(c),
+           static_cast<double>(s.mean[0]),
+           static_cast<double>(s.mean[1]),
+           static_cast<double>(s.mean[2]),
+           static_cast<double>(s.stddev[0]),
+           static_cast<double>(s.stddev[1]),
+           static_cast<double>(s.stddev[2]),
+           static_cast<double>(s.chroma),
+           static_cast<double>(s.meanLuma),
+           static_cast<double>(s.lumaEntropyBits));
+    return 0;
+}
+
+} // namespace
+
+// Placeholder-frame detector: scalar/SIMD agreement, a labelled corpus of placeholder and
+// real frames classified at full size and as rj_span's 1/16 probe, the detector's firing
+// rule, then the cost per frame by kernel and frame size.
+int BenchPlaceholder(int argc, char** argv) {
+    const uint32_t width = static_cast<uint32_t>(ArgInt(argc, argv, "--width", 1920));
+    const uint32_t height = static_cast<uint32_t>(ArgInt(argc, argv, "--height", 1080));
+    const int iters = static_cast<int>(ArgInt(argc, argv, "--iters", 2000));
+    const double budgetUs = ArgDouble(argc, argv, "--budget-us", 100.0);
+    if (const char* file = ArgStr(argc, argv, "--file", nullptr)) return ClassifyFile(file, width, height);
+
+    printf("[rj_bench] placeholder corpus %ux%u, %s\n", width, height, SimdLevelName(DetectSimdLevel()));
+    const std::vector<CorpusFrame> corpus = MakeCorpus(width, height);
+    bool ok = CheckKernels(corpus);
+    ok = CheckCorpus(corpus, 16, ArgFlag(argc, argv, "--verbose")) && ok;
+    ok = CheckDetector(corpus) && ok;
+
+    // rj_span's probe of a 7680x1440 desktop is 480x90; a CPU-side frame is full size.
+    const Image probe = Downsample(MakeDesktop(7680, 1440, 21), 16);
+    const Image full = MakeDesktop(7680, 1440, 21);
+    const PlaceholderConfig cfg;
+    PlaceholderConfig dense = cfg;
+    dense.gridCols = 256;
+    dense.gridRows = 128;
+    printf("  %-16s %-10s %9s %9s\n", "frame", "grid", "scalar us", "simd us");
+    double probeUs = 0.0;
+    auto row = [&](const char* name, const Image& img, const PlaceholderConfig& c, int n) {
+        const double scalar = TimeUs(img, c, SimdLevel::Scalar, n);
+        const double simd = TimeUs(img, c, DetectSimdLevel(), n);
+        char grid[32];
+        snprintf(grid, sizeof(grid), "%ux%u", c.gridCols, c.gridRows);
+        printf("  %-16s %-10s %9.1f %9.1f\n", name, grid, scalar, simd);
+        return simd;
+    };
+    probeUs = row("probe 480x90", probe, cfg, iters);
+    row("full 7680x1440", full, cfg, iters);
+    row("full 7680x1440", full, dense, std::max(iters / 16, 10));
+#ifdef NDEBUG
+    const bool fast = probeUs < budgetUs;
+    printf("  probe classification %.1f us/frame, budget %.0f us  %s\n", probeUs, budgetUs, fast ? "ok" : "FAILED");
+    ok = ok && fast;
+#else
+    printf("  probe classification %.1f us/frame, budget %.0f us not enforced in an unoptimized build\n", probeUs, budgetUs);
+#endif
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/output_damage.h"
+#include "core/pipeline.h"
+#include "core/present_policy.h"
+#include "core/sinks.h"
+#include "core/synthetic_source.h"
+
+namespace rj::bench {
+
+namespace {
+
+bool CheckPolicy() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  policy: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+
+    PresentPolicyConfig cfg;
+    cfg.keepAliveNs = 1000;
+    PresentPolicy p(cfg);
+    expect(p.Decide(0, 0) == PresentReason::NewContent, "the first pass presents");
+    expect(p.Decide(10, 0) == PresentReason::Skip && !p.WaitableArmed(), "no new content: skip, waitable not armed");
+    expect(p.Decide(20, 1) == PresentReason::NewContent && p.WaitableArmed(), "new content presents");
+    expect(p.Decide(500, 1) == PresentReason::Skip, "still nothing new");
+    expect(p.Decide(1020, 1) == PresentReason::KeepAlive, "keep-alive after the interval");
+    expect(p.Decide(1030, 1) == PresentReason::Skip, "keep-alive restarts the interval");
+    p.Force();
+    expect(p.Decide(1040, 1) == PresentReason::Forced && p.Decide(1050, 1) == PresentReason::Skip, "forced once");
+    p.Force();
+    expect(p.Decide(1060, 1, false) == PresentReason::Skip, "content gone: forced pass waits");
+    expect(p.Decide(3000, 1, false) == PresentReason::Skip, "content gone: no keep-alive");
+    expect(p.Decide(3010, 2, false) == PresentReason::NewContent, "content gone: new content presents");
+
+    cfg.onNewContent = false;
+    p.SetConfig(cfg);
+    expect(p.Decide(3020, 2) == PresentReason::Always && p.Decide(3030, 2) == PresentReason::Always, "policy off presents every pass");
+    expect(PresentPolicy::NextPassNs(100, 50, 120) == 150 && PresentPolicy::NextPassNs(100, 50, 400) == 400, "pacing without the waitable");
+
+    const PresentPolicyStats s = p.TakeStats();
+    expect(s.passes == 13 && s.presents == 7 && s.keepAlives == 1 && s.forced == 1, "stats");
+    printf("  policy: new content, skip, keep-alive, force, released content, off, pacing  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+bool CheckDamage() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  damage: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+
+    SlicePlanConfig cfg;
+    cfg.outputs = 3;
+    const SlicePlan exact = PlanSlices(7680, 1440, cfg);
+    const Rect hud{100, 1300, 400, 1400};
+    const Rect seam{2500, 0, 2600, 50};
+    const Rect edge{2400, 0, 2560, 50};
+    expect(OutputsTouched(exact, &hud, 1) == 0x1, "a rect inside one column");
+    expect(OutputsTouched(exact, &seam, 1) == 0x3, "a rect across a seam");
+    expect(OutputsTouched(exact, &edge, 1) == 0x1, "1:1 columns don't bleed");
+    expect(OutputsTouched(exact, nullptr, 0) == 0x7, "no rects: everything changed");
+    const Rect both[2] = {hud, Rect{7000, 0, 7100, 10}};
+    expect(OutputsTouched(exact, both, 2) == 0x5, "several rects");
+
+    cfg.outputWidth = 1920;
+    cfg.outputHeight = 1080;
+    cfg.expectedWideW = 7680;
+    const SlicePlan scaled = PlanSlices(7680, 1440, cfg);
+    expect(OutputsTouched(scaled, &edge, 1) == 0x3, "scaled columns pick up a texel of the neighbour");
+    const SlicePlan unsliced = PlanSlices(2560, 1440, cfg);
+    expect(OutputsTouched(unsliced, &hud, 1) == 0x7, "unsliced: every output shows every change");
+
+    OutputDamageTracker t(3);
+    expect(t.Pending() == 0x7, "everything pending after reset");
+    t.Drawn(0x7, 1);
+    expect(t.Pending() == 0, "drawn");
+    t.MarkChanged(2, 0x1);
+    t.MarkChanged(3, 0x4);  // frame 2 is superseded by 3 in the ring
+    expect(t.Pending() == 0x5, "superseded frames still count");
+    t.Drawn(0x5, 3);
+    t.MarkChanged(5, 0x2);  // recorded before frame 5 is taken
+    expect(t.Pending() == 0x2, "a change in flight");
+    t.Drawn(0x2, 4);
+    expect(t.Pending() == 0x2, "drawing an older frame keeps it pending");
+    t.Drawn(0x2, 5);
+    t.Invalidate(0x4);
+    expect(t.Pending() == 0x4, "invalidate");
+    t.Drawn(0x4, 5);
+    expect(t.Pending() == 0, "all shown");
+    printf("  damage: rects onto outputs (1:1, scaled, unsliced), tracker with superseded and in-flight frames  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+struct RunResult {
+    uint64_t passes{};
+    uint64_t presents{};
+    uint64_t keepAlives{};
+    uint64_t copied{};
+    uint64_t lastShown{};  // frame sequence the sinks show at the end
+    uint64_t outputPresents{};
+    int64_t renderNs{};    // simulated draw + present time (the GPU side)
+    int64_t hostNs{};      // host CPU time in RunFrame()
+    double scanoutAvgMs{};
+};
+
+// `contentHz` 0 is an idle desktop: one frame, then nothing.
+// `partial`: only the outputs the source's moving band touched are redrawn.
+RunResult Run(uint32_t hz, uint32_t contentHz, int seconds, bool policy, bool partial, uint32_t outputs, int64_t drawCostNs, int64_t keepAliveNs) {
+    ManualClock clock;
+    PipelineConfig pcfg;
+    pcfg.outputWidth = 7680 / outputs;
+    pcfg.outputHeight = 1440;
+    pcfg.vsyncHz = hz;
+    pcfg.presentOnNewContent = policy;
+    pcfg.presentCfg.keepAliveNs = keepAliveNs;
+    pcfg.partialOutputs = partial;
+    FramePipeline pipeline(clock, pcfg);
+
+    SyntheticSourceConfig scfg;
+    scfg.hz = contentHz > 0 ? contentHz : hz;
+    scfg.frameLimit = contentHz > 0 ? 0 : 1;
+    scfg.cpuPixels = false;
+    SyntheticSource source(clock, scfg);
+    pipeline.AddSource(source);
+
+    std::vector<std::unique_ptr<NullSink>> sinks;
+    for (uint32_t i = 0; i < outputs; i++) {
+        sinks.push_back(std::make_unique<NullSink>(&clock, drawCostNs));
+        pipeline.AddSink(*sinks.back());
+    }
+
+    RunResult r;
+    // Every pass starts at a vblank either way, so both runs see the same content.
+    const uint64_t passes = static_cast<uint64_t>(seconds) * hz;
+    for (uint64_t f = 0; f < passes; f++) {
+        const int64_t h0 = HostNowNs();
+        (void)pipeline.RunFrame();
+        r.hostNs += HostNowNs() - h0;
+    }
+    const PresentPolicyStats ps = pipeline.TakePresentStats();
+    const FrameStatsSummary sum = pipeline.Stats().TakeAndReset();
+    r.passes = pipeline.RenderedFrames();
+    r.presents = pipeline.PresentedFrames();
+    r.keepAlives = ps.keepAlives;
+    r.copied = pipeline.CopiedFrames();
+    for (const auto& sink : sinks) r.lastShown = std::max(r.lastShown, sink->LastSequence());
+    r.outputPresents = pipeline.PresentedOutputs();
+    r.renderNs = static_cast<int64_t>(sum.avgRenderMs * static_cast<double>(sum.frames) * static_cast<double>(kNsPerMs));
+    r.scanoutAvgMs = pipeline.ScanoutLatency().AvgUs() / 1000.0;
+    return r;
+}
+
+} // namespace
+
+// Damage-driven presentation: the PresentPolicy rules and the mapping of dirty rects onto
+// outputs, then the headless pipeline at idle, 60 and 120 fps content on a 120 Hz display:
+// every pass presents, passes without a new frame skip, and only the outputs the frame
+// changed are redrawn (the synthetic source moves a 64 px band, so one output at a time).
+// The sinks burn --draw-us of simulated time per output, standing in for the shader draw
+// and Present().
+int BenchPresent(int argc, char** argv) {
+    const uint32_t hz = static_cast<uint32_t>(ArgInt(argc, argv, "--hz", 120));
+    const int seconds = static_cast<int>(ArgInt(argc, argv, "--seconds", 10));
+    const uint32_t outputs = static_cast<uint32_t>(ArgInt(argc, argv, "--outputs", 3));
+    const int64_t drawCostNs = static_cast<int64_t>(ArgDouble(argc, argv, "--draw-us", 400.0) * kNsPerUs);
+    const int64_t keepAliveNs = static_cast<int64_t>(ArgDouble(argc, argv, "--keepalive-ms", 1000.0) * kNsPerMs);
+
+    printf("[rj_bench] present %u Hz display, %u outputs, %d s simulated, draw %.0f us/output, keep-alive %.0f ms\n",
+           hz,
+           outputs,
+           seconds,
+           NsToUs(drawCostNs),
+           NsToMs(keepAliveNs));
+    bool ok = CheckPolicy();
+    ok = CheckDamage() && ok;
+
+    const uint32_t contentRates[] = {0, 60, hz};
+    printf("  %-8s %-8s %9s %10s %10s %9s %12s %12s %12s\n",
+           "content",
+           "policy",
+           "passes/s",
+           "presents/s",
+           "keepalive",
+           "outputs",
+           "gpu(ms/s)",
+           "cpu(us/s)",
+           "scanout ms");
+    for (uint32_t contentHz : contentRates) {
+        const RunResult off = Run(hz, contentHz, seconds, false, false, outputs, drawCostNs, keepAliveNs);
+        const RunResult on = Run(hz, contentHz, seconds, true, false, outputs, drawCostNs, keepAliveNs);
+        const RunResult partial = Run(hz, contentHz, seconds, true, true, outputs, drawCostNs, keepAliveNs);
+        char name[16];
+        snprintf(name, sizeof(name), contentHz ? "%u fps" : "idle", contentHz);
+        auto row = [&](const char* policy, const RunResult& r) {
+            printf("  %-8s %-8s %9.1f %10.1f %10llu %9.2f %12.1f %12.1f %12.2f\n",
+                   name,
+                   policy,
+                   static_cast<double>(r.passes) / seconds,
+                   static_cast<double>(r.presents) / seconds,
+                   static_cast<unsigned long long>(r.keepAlives),
+                   r.presents ? static_cast<double>(r.outputPresents) / static_cast<double>(r.presents) : 0.0,
+                   NsToMs(r.renderNs) / seconds,
+                   NsToUs(r.hostNs) / seconds,
+                   r.scanoutAvgMs);
+        };
+        row("off", off);
+        row("on", on);
+        row("partial", partial);
+
+        // Same content shown, no added latency, and no presents beyond content + keep-alive.
+        const uint64_t keepAliveBudget = keepAliveNs > 0 ? static_cast<uint64_t>(seconds * kNsPerSec / keepAliveNs) + 1 : 0;
+        const bool good = on.copied == off.copied && on.lastShown == on.copied && on.presents <= on.copied + keepAliveBudget + 1 &&
+                          on.scanoutAvgMs <= off.scanoutAvgMs + 0.01 && on.renderNs <= off.renderNs;
+        // Partial: the same frames, fewer outputs drawn once content moves.
+        const bool partialGood = partial.copied == on.copied && partial.lastShown == partial.copied && partial.presents == on.presents &&
+                                 partial.scanoutAvgMs <= on.scanoutAvgMs + 0.01 &&
+                                 (contentHz == 0 || partial.outputPresents * 2 < on.outputPresents);
+        if (!good || !partialGood) printf("  %-8s  FAILED\n", name);
+        ok = ok && good && partialGood;
+    }
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
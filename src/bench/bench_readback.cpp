@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/clock.h"
+#include "core/mock_readback.h"
+#include "core/readback.h"
+
+namespace rj::bench {
+
+namespace {
+
+struct TestImage {
+    std::vector<uint8_t> pixels;
+    FrameDesc desc{};
+
+    TestImage(uint32_t w, uint32_t h, uint32_t seed) : pixels(static_cast<size_t>(w) * h * 4u) {
+        std::mt19937 rng(seed);
+        for (uint8_t& b : pixels) b = static_cast<uint8_t>(rng());
+        desc.pixels = pixels.data();
+        desc.width = w;
+        desc.height = h;
+        desc.strideBytes = w * 4u;
+        desc.format = PixelFormat::Bgra8;
+    }
+};
+
+// Straight from the definition: the rounded mean of each box, channel by channel.
+uint8_t BoxReference(const FrameDesc& f, const ReadbackPlan& p, uint32_t x, uint32_t y, int c) {
+    uint32_t sum = 0;
+    for (uint32_t by = 0; by < p.downsample; by++) {
+        for (uint32_t bx = 0; bx < p.downsample; bx++) {
+            const uint32_t sx = p.rect.left + x * p.downsample + bx;
+            const uint32_t sy = p.rect.top + y * p.downsample + by;
+            sum += f.pixels[static_cast<size_t>(sy) * f.strideBytes + sx * 4u + c];
+        }
+    }
+    const uint32_t n = p.downsample * p.downsample;
+    return static_cast<uint8_t>((sum + n / 2) / n);
+}
+
+bool MatchesReference(const FrameDesc& f, const ReadbackPlan& p, const uint8_t* pixels, uint32_t stride) {
+    for (uint32_t y = 0; y < p.height; y++) {
+        for (uint32_t x = 0; x < p.width; x++) {
+            for (int c = 0; c < 4; c++) {
+                if (pixels[static_cast<size_t>(y) * stride + x * 4u + c] != BoxReference(f, p, x, y, c)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool CheckPlan() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  plan: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+    ReadbackPlan p;
+    expect(PlanReadback(100, 50, Rect{}, 1, p) && p.rect.right == 100 && p.rect.bottom == 50 && p.width == 100 && p.height == 50,
+           "empty region reads the whole source");
+    expect(PlanReadback(100, 50, Rect{-10, 40, 30, 90}, 1, p) && p.rect.left == 0 && p.rect.top == 40 && p.width == 30 && p.height == 10,
+           "region clamped to the source");
+    expect(PlanReadback(100, 50, Rect{}, 8, p) && p.width == 12 && p.height == 6 && p.rect.right == 96 && p.rect.bottom == 48,
+           "downsampled read trimmed to whole boxes");
+    expect(PlanReadback(100, 50, Rect{10, 10, 13, 30}, 8, p) && p.downsample == 3 && p.width == 1 && p.height == 6,
+           "box shrinks to fit a small region");
+    expect(PlanReadback(100, 50, Rect{}, 0, p) && p.downsample == 1, "downsample 0 reads at full size");
+    expect(!PlanReadback(100, 50, Rect{100, 0, 120, 10}, 1, p) && !PlanReadback(0, 0, Rect{}, 1, p), "region off the source fails");
+
+    TestImage img(67, 45, 3);
+    std::vector<uint8_t> out(67 * 45 * 4);
+    for (uint32_t ds : {1u, 2u, 3u, 8u}) {
+        PlanReadback(67, 45, Rect{5, 3, 66, 44}, ds, p);
+        DownsampleBox(img.desc.pixels, img.desc.strideBytes, p, out.data(), p.width * 4u);
+        expect(MatchesReference(img.desc, p, out.data(), p.width * 4u), "box filter matches the reference");
+    }
+    printf("  plan: whole, clamped, box-trimmed and shrunk regions; box filter at 1x, 2x, 3x, 8x  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+bool CheckQueue() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  queue: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+    ManualClock clock;
+    MockReadbackDevice device(clock);
+    ReadbackConfig cfg;
+    cfg.slots = 3;
+    cfg.mapDelayFrames = 2;
+    ReadbackQueue queue(device, cfg);
+
+    // Every frame shows different content; each result must be the frame it was requested on.
+    std::vector<TestImage> frames;
+    for (uint32_t i = 0; i < 12; i++) frames.emplace_back(96, 64, 100 + i);
+    const Rect regions[] = {Rect{}, Rect{16, 8, 80, 56}, Rect{}};
+    const uint32_t factors[] = {1, 1, 4};
+    uint64_t expectTag = 0;
+    bool inOrder = true;
+    bool matches = true;
+    bool delayed = true;
+    for (uint32_t i = 0; i < frames.size() + cfg.mapDelayFrames; i++) {
+        clock.AdvanceNs(8 * kNsPerMs);
+        queue.Poll(clock.NowNs());
+        ReadbackResult r;
+        while (queue.Take(r)) {
+            inOrder = inOrder && r.tag == expectTag++;
+            matches = matches && MatchesReference(frames[r.tag].desc, r.plan, r.pixels, r.strideBytes);
+            delayed = delayed && r.latencyFrames >= cfg.mapDelayFrames && r.readyNs > r.requestNs;
+            queue.Release(r.id);
+        }
+        if (i < frames.size()) {
+            device.SetSource(frames[i].desc);
+            expect(queue.Request(96, 64, regions[i % 3], factors[i % 3], i, clock.NowNs()) != 0, "request with a free slot succeeds");
+        }
+    }
+    const ReadbackStats s = queue.Stats();
+    expect(inOrder && expectTag == frames.size(), "every request completes, in order");
+    expect(matches, "results hold the requested frame's pixels");
+    expect(delayed && s.latencyFramesMax == cfg.mapDelayFrames, "results arrive after the map delay");
+    expect(s.dropped == 0 && device.Counters().stalledMaps == 0 && device.Counters().mapped == 0, "no drops, stalls or leaked maps");
+
+    // All slots in flight: the next request drops instead of waiting.
+    ReadbackQueue small(device, ReadbackConfig{2, 2});
+    const uint64_t a = small.Request(96, 64, Rect{}, 1, 0, clock.NowNs());
+    small.Request(96, 64, Rect{}, 1, 0, clock.NowNs());
+    expect(a != 0 && small.Request(96, 64, Rect{}, 1, 0, clock.NowNs()) == 0 && small.Stats().dropped == 1, "exhausted ring drops");
+    small.Release(a);
+    expect(small.Request(96, 64, Rect{}, 1, 0, clock.NowNs()) != 0, "released slot is reused");
+
+    // A GPU still busy when the delay is up: Poll leaves the copy in flight without waiting.
+    device.QueueGpuWork(50 * kNsPerMs);
+    const uint64_t late = queue.Request(96, 64, Rect{}, 1, 0, clock.NowNs());
+    uint32_t polls = 0;
+    ReadbackResult r{};
+    while (!queue.Take(r) && polls < 20) {
+        clock.AdvanceNs(8 * kNsPerMs);
+        queue.Poll(clock.NowNs());
+        polls++;
+    }
+    expect(r.id == late && polls > cfg.mapDelayFrames && queue.Stats().busyMaps > 0 && device.Counters().stalledMaps == 0,
+           "busy copy is retried, never waited for");
+
+    // Teardown unmaps what the caller still holds and forgets copies in flight.
+    queue.Request(96, 64, Rect{}, 1, 0, clock.NowNs());
+    queue.Reset();
+    small.Reset();
+    expect(device.Counters().mapped == 0 && queue.InFlight() == 0 && small.InFlight() == 0, "reset unmaps everything");
+
+    printf("  queue: in-order results equal to the source, map delay, exhaustion drops, busy retries, reset  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+struct LoopParams {
+    uint32_t hz{};
+    uint32_t frames{};
+    int64_t cpuNs{};
+    int64_t gpuNs{};
+};
+
+struct LoopResult {
+    int64_t maxTotalNs{};
+    int64_t sumTotalNs{};
+    uint32_t frames{};
+    ReadbackStats stats{};
+    uint64_t stalledMaps{};
+};
+
+enum class Mode { None, Sync, Async };
+
+// A render loop on a simulated 120 Hz display: each frame does its CPU work, queues its GPU
+// work and reads back `region`. Sync copies into one staging texture and maps it at once, the
+// way the 1x1 debug readback did; async goes through a ReadbackQueue. "total" is vblank to
+// the end of the frame's work, as in the rj_span stats line.
+LoopResult RunLoop(const LoopParams& lp, const FrameDesc& source, Mode mode, const ReadbackConfig& cfg, const Rect& region, uint32_t downsample) {
+    ManualClock clock;
+    VsyncPacer pacer(clock, lp.hz);
+    MockReadbackConfig mc;
+    mc.pixels = false;
+    MockReadbackDevice device(clock, mc);
+    device.SetSource(source);
+    ReadbackQueue queue(device, cfg);
+    ReadbackPlan plan;
+    PlanReadback(source.width, source.height, region, downsample, plan);
+    LoopResult r;
+    for (uint32_t i = 0; i < lp.frames; i++) {
+        const int64_t start = pacer.WaitForVblank();
+        if (mode == Mode::Async) {
+            queue.Poll(clock.NowNs());
+            ReadbackResult res;
+            while (queue.Take(res)) {
+                DoNotOptimize(res.pixels);
+                queue.Release(res.id);
+            }
+        }
+        clock.SleepForNs(lp.cpuNs);
+        device.QueueGpuWork(lp.gpuNs);
+        if (mode == Mode::Sync) {
+            ReadbackMapping m;
+            r.stats.requested++;
+            if (device.Copy(0, plan) && device.Map(0, true, m) == ReadbackMapResult::Mapped) {
+                DoNotOptimize(m.pixels);
+                device.Unmap(0);
+                r.stats.completed++;
+            }
+        } else if (mode == Mode::Async) {
+            queue.Request(source.width, source.height, region, downsample, i, clock.NowNs());
+        }
+        const int64_t total = clock.NowNs() - start;
+        r.maxTotalNs = std::max(r.maxTotalNs, total);
+        r.sumTotalNs += total;
+        r.frames++;
+    }
+    if (mode == Mode::Async) r.stats = queue.Stats();
+    r.stalledMaps = device.Counters().stalledMaps;
+    return r;
+}
+
+} // namespace
+
+// Readback manager: plan/box-filter rules and queue behaviour against a mock GPU, then a
+// simulated render loop reading back every frame, synchronously vs. through the ring.
+int BenchReadback(int argc, char** argv) {
+    const uint32_t width = static_cast<uint32_t>(ArgInt(argc, argv, "--width", 5760));
+    const uint32_t height = static_cast<uint32_t>(ArgInt(argc, argv, "--height", 1080));
+    LoopParams lp;
+    lp.hz = static_cast<uint32_t>(ArgInt(argc, argv, "--hz", 120));
+    lp.frames = static_cast<uint32_t>(ArgInt(argc, argv, "--frames", 240));
+    lp.cpuNs = static_cast<int64_t>(ArgDouble(argc, argv, "--cpu-us", 1500) * kNsPerUs);
+    lp.gpuNs = static_cast<int64_t>(ArgDouble(argc, argv, "--gpu-us", 3000) * kNsPerUs);
+
+    printf("[rj_bench] readback %ux%u at %u Hz, %u frames, frame cpu %.1f ms gpu %.1f ms\n", width, height, lp.hz, lp.frames, NsToMs(lp.cpuNs),
+           NsToMs(lp.gpuNs));
+    bool ok = CheckPlan();
+    ok = CheckQueue() && ok;
+
+    const TestImage img(width, height, 1);
+    const LoopResult none = RunLoop(lp, img.desc, Mode::None, ReadbackConfig{}, Rect{}, 1);
+    struct Read {
+        const char* name;
+        Rect region;
+        uint32_t downsample;
+    };
+    const Read reads[] = {
+        {"full", Rect{}, 1},
+        {"1/8", Rect{}, 8},
+        {"256x256", Rect{0, 0, 256, 256}, 1},
+    };
+    struct Variant {
+        const char* name;
+        Mode mode;
+        ReadbackConfig cfg;
+    };
+    const Variant variants[] = {
+        {"sync", Mode::Sync, ReadbackConfig{1, 0}},
+        {"ring 2/1", Mode::Async, ReadbackConfig{2, 1}},
+        {"ring 3/2", Mode::Async, ReadbackConfig{3, 2}},
+        {"ring 4/3", Mode::Async, ReadbackConfig{4, 3}},
+    };
+    printf("  %-8s %-9s %9s %9s %7s %7s %8s %7s\n", "read", "mode", "max ms", "avg ms", "lat fr", "lat ms", "dropped", "stalls");
+    printf("  %-8s %-9s %9.3f %9.3f\n", "-", "none", NsToMs(none.maxTotalNs), NsToMs(none.sumTotalNs) / none.frames);
+    bool flat = true;
+    for (const Read& rd : reads) {
+        for (const Variant& v : variants) {
+            const LoopResult r = RunLoop(lp, img.desc, v.mode, v.cfg, rd.region, rd.downsample);
+            const double completed = static_cast<double>(std::max<uint64_t>(r.stats.completed, 1));
+            printf("  %-8s %-9s %9.3f %9.3f %7.2f %7.2f %8llu %7llu\n",
+                   rd.name,
+                   v.name,
+                   NsToMs(r.maxTotalNs),
+                   NsToMs(r.sumTotalNs) / r.frames,
+                   v.mode == Mode::Sync ? 0.0 : static_cast<double>(r.stats.latencyFramesSum) / completed,
+                   v.mode == Mode::Sync ? 0.0 : NsToMs(r.stats.latencyNsSum) / completed,
+                   static_cast<unsigned long long>(r.stats.dropped),
+                   static_cast<unsigned long long>(r.stalledMaps));
+            // Through the ring a per-frame readback costs the frame only the copy and map calls.
+            if (v.mode == Mode::Async) flat = flat && r.stalledMaps == 0 && r.maxTotalNs - none.maxTotalNs <= 50 * kNsPerUs;
+        }
+    }
+    printf("  ring readback every frame keeps max total within 0.05 ms of no readback  %s\n", flat ? "ok" : "FAILED");
+    ok = ok && flat;
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
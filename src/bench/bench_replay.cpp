@@ -0,0 +1,417 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/capture_recorder.h"
+#include "core/pipeline.h"
+#include "core/replay_source.h"
+#include "core/sinks.h"
+#include "core/synthetic_source.h"
+
+namespace rj::bench {
+
+namespace {
+
+// What a source handed to the pipeline for one frame.
+struct FrameLog {
+    uint64_t sequence{};
+    int64_t captureTimeNs{};
+    uint32_t width{};
+    uint32_t height{};
+    uint32_t accumulated{};
+    uint64_t hash{};  // 0 without pixels
+    std::vector<Rect> dirty;
+};
+
+bool SameContent(const FrameLog& a, const FrameLog& b) {
+    if (a.sequence != b.sequence || a.width != b.width || a.height != b.height || a.accumulated != b.accumulated || a.hash != b.hash) return false;
+    if (a.dirty.size() != b.dirty.size()) return false;
+    for (size_t i = 0; i < a.dirty.size(); i++) {
+        const Rect& x = a.dirty[i];
+        const Rect& y = b.dirty[i];
+        if (x.left != y.left || x.top != y.top || x.right != y.right || x.bottom != y.bottom) return false;
+    }
+    return true;
+}
+
+bool SameLogs(const std::vector<FrameLog>& a, const std::vector<FrameLog>& b, bool timing, bool pixels) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        FrameLog x = a[i];
+        if (!pixels) x.hash = b[i].hash;
+        if (!SameContent(x, b[i]) || (timing && x.captureTimeNs != b[i].captureTimeNs)) return false;
+    }
+    return true;
+}
+
+// Logs every frame the wrapped source hands out.
+class LoggingSource final : public ICaptureSource {
+public:
+    explicit LoggingSource(ICaptureSource& inner) : m_inner(inner) {}
+
+    const char* Name() const override { return m_inner.Name(); }
+    AcquireResult Acquire(uint32_t timeoutMs, FrameDesc& out) override {
+        const AcquireResult r = m_inner.Acquire(timeoutMs, out);
+        if (r == AcquireResult::NewFrame) {
+            FrameLog l;
+            l.sequence = out.sequence;
+            l.captureTimeNs = out.captureTimeNs;
+            l.width = out.width;
+            l.height = out.height;
+            l.accumulated = out.accumulatedFrames;
+            l.hash = HashPixels(out);
+            l.dirty.assign(out.dirtyRects, out.dirtyRects + (out.dirtyRects ? out.dirtyRectCount : 0));
+            log.push_back(std::move(l));
+        }
+        return r;
+    }
+    void Release() override { m_inner.Release(); }
+
+    std::vector<FrameLog> log;
+
+private:
+    ICaptureSource& m_inner;
+};
+
+struct Session {
+    std::vector<FrameLog> log;
+    uint64_t copied{};
+    uint64_t presented{};
+    uint64_t presentedOutputs{};
+    int64_t latencySumNs{};
+    int64_t scanoutSumNs{};
+
+    // `o` may present up to `extraOutputs` more outputs: frames a replay reports as fully
+    // changed redraw every output.
+    bool SameRun(const Session& o, uint64_t extraOutputs = 0) const {
+        return copied == o.copied && presented == o.presented && o.presentedOutputs >= presentedOutputs &&
+               o.presentedOutputs <= presentedOutputs + extraOutputs && latencySumNs == o.latencySumNs && scanoutSumNs == o.scanoutSumNs;
+    }
+};
+
+// `frames` passes of a paced 60 Hz pipeline with three outputs that only redraws what
+// changed, fed by `source` on `clock`.
+Session RunSession(Clock& clock, ICaptureSource& source, uint32_t w, uint32_t h, int frames) {
+    PipelineConfig pcfg;
+    pcfg.outputWidth = w / 3;
+    pcfg.outputHeight = h;
+    pcfg.vsyncHz = 60;
+    pcfg.presentOnNewContent = true;
+    pcfg.partialOutputs = true;
+    FramePipeline pipeline(clock, pcfg);
+    LoggingSource logged(source);
+    pipeline.AddSource(logged);
+    NullSink sinks[3];
+    for (NullSink& s : sinks) pipeline.AddSink(s);
+    for (int f = 0; f < frames; f++) (void)pipeline.RunFrame();
+
+    Session s;
+    s.log = std::move(logged.log);
+    s.copied = pipeline.CopiedFrames();
+    s.presented = pipeline.PresentedFrames();
+    s.presentedOutputs = pipeline.PresentedOutputs();
+    s.latencySumNs = pipeline.Latency().sumNs;
+    s.scanoutSumNs = pipeline.ScanoutLatency().sumNs;
+    return s;
+}
+
+SyntheticSourceConfig SessionSource(uint32_t w, uint32_t h) {
+    SyntheticSourceConfig scfg;
+    scfg.width = w;
+    scfg.height = h;
+    scfg.hz = 120;  // two frames per pass: accumulatedFrames = 2
+    return scfg;
+}
+
+// Records a synthetic session through the pipeline.
+Session RecordSession(const char* base, const RecorderConfig& rcfg, uint32_t w, uint32_t h, int frames, RecorderStats& stats) {
+    ManualClock clock;
+    SyntheticSource synth(clock, SessionSource(w, h));
+    CaptureRecorder recorder(rcfg);
+    if (!recorder.Start(base)) return Session{};
+    RecordingSource recording(clock, synth, recorder);
+    Session s = RunSession(clock, recording, w, h, frames);
+    recorder.Stop();
+    stats = recorder.Stats();
+    return s;
+}
+
+Session ReplaySession(const char* base, ReplayTiming timing, uint32_t w, uint32_t h, int frames) {
+    ManualClock clock;
+    ReplayConfig cfg;
+    cfg.timing = timing;
+    ReplaySource replay(clock, cfg);
+    if (!replay.Open(base)) return Session{};
+    return RunSession(clock, replay, w, h, frames);
+}
+
+void RemoveSession(const std::string& base) {
+    for (uint32_t s = 0; std::remove(RecordingSegmentPath(base, s).c_str()) == 0; s++) {
+    }
+}
+
+// Outputs a 3-output partial pipeline may redraw on top of `recorded` when fed `replayed`.
+uint64_t ExtraOutputs(const std::vector<FrameLog>& recorded, const std::vector<FrameLog>& replayed) {
+    uint64_t n = 0;
+    for (size_t i = 0; i < std::min(recorded.size(), replayed.size()); i++) {
+        if (!recorded[i].dirty.empty() && replayed[i].dirty.empty()) n += 2;
+    }
+    return n;
+}
+
+// What a replay of the session at `base` hands out for `recorded`: the same frames, fully
+// changed where playback (re)starts decoding, i.e. the first frame, segment starts and
+// keyframes.
+std::vector<FrameLog> ExpectedReplay(const char* base, std::vector<FrameLog> recorded) {
+    RecordingReader reader;
+    if (!reader.Open(base) || reader.FrameCount() != recorded.size()) return {};
+    for (size_t i = 0; i < recorded.size(); i++) {
+        const RecordedFrame f = reader.Frame(i);
+        CodecFrameInfo info;
+        const bool keyframe = f.header->payload == static_cast<uint8_t>(RecordPayload::Codec) &&
+                              ReadCodecFrameInfo(f.payload, f.header->payloadBytes, info) && info.keyframe;
+        if (i == 0 || f.segmentStart || keyframe) recorded[i].dirty.clear();
+    }
+    return recorded;
+}
+
+// Drops the index of segment `segment`, as if the recorder had died before closing it.
+bool DropIndex(const std::string& base, uint32_t segment) {
+    FILE* f = fopen(RecordingSegmentPath(base, segment).c_str(), "r+b");
+    if (!f) return false;
+    const uint64_t zero = 0;
+    const bool ok = fseek(f, offsetof(RecordSegmentHeader, indexOffset), SEEK_SET) == 0 && fwrite(&zero, sizeof(zero), 1, f) == 1;
+    return fclose(f) == 0 && ok;
+}
+
+bool CheckReplay(const std::string& base) {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  replay: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+    const uint32_t w = 640;
+    const uint32_t h = 360;
+    const int frames = 240;
+    const char* path = base.c_str();
+
+    RecorderConfig rcfg;
+    rcfg.segmentBytes = 512u << 10;
+    rcfg.dropWhenFull = false;
+    RecorderStats stats;
+    const Session recorded = RecordSession(path, rcfg, w, h, frames, stats);
+    RecordingReader reader;
+    expect(!recorded.log.empty() && stats.frames == recorded.log.size() && stats.dropped == 0 && !stats.failed, "every frame recorded");
+    expect(stats.segments > 1 && reader.Open(path) && reader.Segments() == stats.segments && reader.FrameCount() == stats.frames &&
+               reader.RecoveredSegments() == 0,
+           "segments rolled over and indexed");
+    bool accumulated = recorded.log.size() > 1;
+    for (size_t i = 1; i < recorded.log.size(); i++) accumulated = accumulated && recorded.log[i].accumulated == 2;
+    expect(accumulated, "accumulated frames recorded");
+
+    const std::vector<FrameLog> expected = ExpectedReplay(path, recorded.log);
+    const Session original = ReplaySession(path, ReplayTiming::Original, w, h, frames);
+    expect(SameLogs(expected, original.log, true, true) && recorded.SameRun(original, ExtraOutputs(recorded.log, expected)),
+           "original timing: same frames, timestamps, dirty rects, presents and latencies");
+
+    {
+        ManualClock clock;
+        ReplayConfig cfg;
+        cfg.timing = ReplayTiming::AsFastAsPossible;
+        ReplaySource replay(clock, cfg);
+        LoggingSource logged(replay);
+        FrameDesc f{};
+        const bool opened = replay.Open(path);
+        while (opened && logged.Acquire(0, f) == AcquireResult::NewFrame) logged.Release();
+        expect(SameLogs(expected, logged.log, false, true) && clock.NowNs() == 0, "as fast as possible: same frames without waiting");
+    }
+    {
+        ManualClock clock;
+        ReplayConfig cfg;
+        cfg.timing = ReplayTiming::AsFastAsPossible;
+        cfg.loop = true;
+        ReplaySource replay(clock, cfg);
+        FrameDesc f{};
+        uint64_t last = 0;
+        bool increasing = replay.Open(path);
+        bool restartsFull = true;
+        for (size_t i = 0; increasing && i < 2 * recorded.log.size() + 1; i++) {
+            increasing = replay.Acquire(0, f) == AcquireResult::NewFrame && f.sequence > last;
+            last = f.sequence;
+            if (i % recorded.log.size() == 0) restartsFull = restartsFull && f.dirtyRectCount == 0 && !f.dirtyRects;
+        }
+        expect(increasing && replay.Loops() == 2, "looping keeps sequences increasing");
+        expect(restartsFull, "first frame of each pass is fully changed");
+    }
+
+    // Recovery: the last segment loses its index and is found by walking its records.
+    expect(DropIndex(base, stats.segments - 1) && reader.Open(path) && reader.RecoveredSegments() == 1 && reader.FrameCount() == stats.frames &&
+               SameLogs(expected, ReplaySession(path, ReplayTiming::Original, w, h, frames).log, true, true),
+           "a segment without index is recovered");
+    reader.Close();
+    RemoveSession(base);
+
+    RecorderConfig raw = rcfg;
+    raw.compress = false;
+    raw.segmentBytes = 4u << 20;
+    const Session rawRecorded = RecordSession(path, raw, w, h, frames, stats);
+    expect(reader.Open(path) && reader.FrameCount() == stats.frames && reader.Frame(0).header->payload == static_cast<uint8_t>(RecordPayload::Raw) &&
+               SameLogs(ExpectedReplay(path, rawRecorded.log), ReplaySession(path, ReplayTiming::Original, w, h, frames).log, true, true),
+           "raw pixels replay from the mapping");
+    reader.Close();
+    RemoveSession(base);
+
+    RecorderConfig timing = rcfg;
+    timing.pixels = false;
+    const Session timingRecorded = RecordSession(path, timing, w, h, frames, stats);
+    const Session timingReplayed = ReplaySession(path, ReplayTiming::Original, w, h, frames);
+    bool noPixels = !timingReplayed.log.empty();
+    for (const FrameLog& l : timingReplayed.log) noPixels = noPixels && l.hash == 0;
+    expect(stats.segments == 1 && noPixels && SameLogs(ExpectedReplay(path, timingRecorded.log), timingReplayed.log, true, false) && timingRecorded.SameRun(timingReplayed, ExtraOutputs(timingRecorded.log, timingReplayed.log)),
+           "timing-only recordings replay the same schedule");
+    RemoveSession(base);
+
+    // A full queue drops whole frames before they are coded; what was written still decodes.
+    {
+        ManualClock clock;
+        SyntheticSource synth(clock, SessionSource(1920, 1080));
+        RecorderConfig burst;
+        burst.queueFrames = 1;
+        CaptureRecorder recorder(burst);
+        FrameDesc f{};
+        const int n = 60;
+        bool started = recorder.Start(path);
+        for (int i = 0; started && i < n; i++) {
+            clock.AdvanceNs(kNsPerSec / 120);
+            if (synth.Acquire(0, f) == AcquireResult::NewFrame) recorder.Record(f, clock.NowNs());
+        }
+        recorder.Stop();
+        stats = recorder.Stats();
+        ReplayConfig cfg;
+        cfg.timing = ReplayTiming::AsFastAsPossible;
+        ReplaySource replay(clock, cfg);
+        uint64_t replayed = 0;
+        if (replay.Open(path)) {
+            while (replay.Acquire(0, f) == AcquireResult::NewFrame) replayed++;
+        }
+        expect(started && stats.frames + stats.dropped == static_cast<uint64_t>(n) && !stats.failed && replayed == stats.frames, "a full queue drops frames, the rest replays");
+        printf("  replay: burst of %d 1920x1080 frames into a 1-frame queue: %llu written, %llu dropped\n",
+               n,
+               static_cast<unsigned long long>(stats.frames),
+               static_cast<unsigned long long>(stats.dropped));
+        RemoveSession(base);
+    }
+
+    {
+        ManualClock clock;
+        SyntheticSource synth(clock, SessionSource(w, h));
+        RecorderConfig tiny;
+        tiny.segmentBytes = 4096;
+        tiny.dropWhenFull = false;
+        CaptureRecorder recorder(tiny);
+        FrameDesc f{};
+        bool started = recorder.Start(path);
+        bool refused = false;
+        for (int i = 0; started && i < 8 && !refused; i++) {
+            clock.AdvanceNs(kNsPerSec / 120);
+            if (synth.Acquire(0, f) == AcquireResult::NewFrame) refused = !recorder.Record(f, clock.NowNs());
+            // Let the writer take the frame before the next one.
+            while (!refused && recorder.Stats().frames + recorder.Stats().dropped < static_cast<uint64_t>(i + 1)) std::this_thread::yield();
+        }
+        recorder.Stop();
+        expect(started && recorder.Stats().failed && refused, "a frame larger than a segment stops the recording");
+        RemoveSession(base);
+    }
+
+    ManualClock clock;
+    ReplaySource missing(clock);
+    FrameDesc f{};
+    expect(!missing.Open((base + "_missing").c_str()) && missing.Acquire(0, f) == AcquireResult::Error, "a missing recording");
+
+    printf("  replay: recorder segments, index recovery, original-timing and as-fast-as-possible replay, raw and timing-only sessions  %s\n",
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+// Capture recorder and replay source: a synthetic session recorded through the headless
+// pipeline must replay with the same frames, timestamps, dirty rects and presents. Then a
+// real-time 120 Hz source of --width x --height records --frames frames with the default
+// drop-when-full queue: capture thread cost per frame, frames the writer kept up with, and
+// the cost of replaying them as fast as possible. Segment files go to --base (removed
+// afterwards unless --keep).
+int BenchReplay(int argc, char** argv) {
+    const uint32_t w = static_cast<uint32_t>(ArgInt(argc, argv, "--width", 7680));
+    const uint32_t h = static_cast<uint32_t>(ArgInt(argc, argv, "--height", 1440));
+    const int frames = static_cast<int>(ArgInt(argc, argv, "--frames", 240));
+    const uint32_t threads = static_cast<uint32_t>(ArgInt(argc, argv, "--threads", 1));
+    const std::string base = ArgStr(argc, argv, "--base", "rj_bench_replay");
+    const bool keep = ArgFlag(argc, argv, "--keep");
+
+    printf("[rj_bench] replay %ux%u at 120 Hz, %d frames, %u codec threads, segments at %s_NNNN.rjr\n", w, h, frames, threads, base.c_str());
+    bool ok = CheckReplay(base);
+
+    printf("  %-6s %14s %8s %8s %10s %8s %12s %8s\n", "pixels", "record us/frm", "written", "dropped", "MB/s", "ratio", "replay ms", "fps");
+    for (bool compress : {false, true}) {
+        SteadyClock clock;
+        SyntheticSource synth(clock, SessionSource(w, h));
+        RecorderConfig rcfg;
+        rcfg.compress = compress;
+        rcfg.codec.threads = threads;
+        rcfg.segmentBytes = 1ull << 30;
+        CaptureRecorder recorder(rcfg);
+        if (!recorder.Start(base.c_str())) {
+            printf("  cannot create %s\n", RecordingSegmentPath(base, 0).c_str());
+            return 1;
+        }
+        FrameDesc f{};
+        int64_t recordNs = 0;
+        const int64_t t0 = HostNowNs();
+        for (int i = 0; i < frames;) {
+            if (synth.Acquire(100, f) != AcquireResult::NewFrame) continue;
+            const int64_t r0 = HostNowNs();
+            recorder.Record(f, clock.NowNs());
+            recordNs += HostNowNs() - r0;
+            i++;
+        }
+        recorder.Stop();
+        const double seconds = NsToMs(HostNowNs() - t0) / 1000.0;
+        const RecorderStats stats = recorder.Stats();
+
+        ReplayConfig cfg;
+        cfg.timing = ReplayTiming::AsFastAsPossible;
+        cfg.threads = threads;
+        ReplaySource replay(clock, cfg);
+        uint64_t replayed = 0;
+        const int64_t p0 = HostNowNs();
+        if (replay.Open(base.c_str())) {
+            while (replay.Acquire(0, f) == AcquireResult::NewFrame) {
+                DoNotOptimize(f.pixels);
+                replayed++;
+            }
+        }
+        const double replayMs = NsToMs(HostNowNs() - p0);
+        const double written = static_cast<double>(std::max<uint64_t>(stats.frames, 1));
+        const bool complete = !stats.failed && replayed == stats.frames && stats.frames + stats.dropped == static_cast<uint64_t>(frames);
+        printf("  %-6s %14.1f %8llu %8llu %10.0f %8.2f %12.3f %8.0f%s\n",
+               compress ? "coded" : "raw",
+               NsToUs(recordNs) / frames,
+               static_cast<unsigned long long>(stats.frames),
+               static_cast<unsigned long long>(stats.dropped),
+               static_cast<double>(stats.bytes) / 1e6 / seconds,
+               static_cast<double>(stats.rawBytes) / static_cast<double>(std::max<uint64_t>(stats.bytes, 1)),
+               replayMs / written,
+               1000.0 * written / replayMs,
+               complete ? (stats.dropped == 0 ? "" : "  (writer behind on this machine)") : "  INCOMPLETE, FAILED");
+        ok = ok && complete;
+        if (!keep || !compress) RemoveSession(base);
+    }
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
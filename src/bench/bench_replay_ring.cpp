@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/instant_replay.h"
+#include "core/replay_source.h"
+#include "core/synthetic_source.h"
+
+namespace rj::bench {
+
+namespace {
+
+constexpr uint32_t kCheckW = 640;
+constexpr uint32_t kCheckH = 360;
+constexpr uint32_t kCheckHz = 60;
+
+SyntheticSourceConfig RingSource(uint32_t w, uint32_t h, uint32_t hz) {
+    SyntheticSourceConfig scfg;
+    scfg.width = w;
+    scfg.height = h;
+    scfg.hz = hz;
+    scfg.motionStepPx = 24;  // the band crosses the check frame in about half a second
+    return scfg;
+}
+
+// Feeds `frames` synthetic frames through `ring` one at a time, waiting for each to be
+// stored. Returns the pixel hash of every frame by sequence.
+std::map<uint64_t, uint64_t> Feed(InstantReplayRing& ring, int frames, InstantReplayStats* peak = nullptr) {
+    ManualClock clock;
+    SyntheticSource synth(clock, RingSource(kCheckW, kCheckH, kCheckHz));
+    std::map<uint64_t, uint64_t> hashes;
+    FrameDesc f{};
+    for (int i = 0; i < frames; i++) {
+        clock.AdvanceNs(kNsPerSec / kCheckHz);
+        if (synth.Acquire(0, f) != AcquireResult::NewFrame) continue;
+        hashes[f.sequence] = HashPixels(f);
+        (void)ring.Submit(f, clock.NowNs());
+        ring.WaitIdle();
+        if (peak) {
+            const InstantReplayStats st = ring.Stats();
+            peak->memoryBytes = std::max(peak->memoryBytes, st.memoryBytes);
+            peak->spillBytes = std::max(peak->spillBytes, st.spillBytes);
+        }
+    }
+    return hashes;
+}
+
+InstantReplaySave SaveAndWait(InstantReplayRing& ring, const std::string& base) {
+    InstantReplaySave r;
+    if (!ring.Save(base.c_str())) return r;
+    while (!ring.TakeSaveResult(r)) std::this_thread::yield();
+    return r;
+}
+
+// The saved session replays every held frame, in order, with the pixels that were fed and
+// ending with the newest one.
+bool ReplaysHeld(const std::string& base, const std::map<uint64_t, uint64_t>& hashes, uint64_t held) {
+    ManualClock clock;
+    ReplayConfig cfg;
+    cfg.timing = ReplayTiming::AsFastAsPossible;
+    ReplaySource replay(clock, cfg);
+    if (!replay.Open(base.c_str()) || hashes.empty()) return false;
+    FrameDesc f{};
+    uint64_t frames = 0;
+    uint64_t last = 0;
+    bool same = true;
+    while (replay.Acquire(0, f) == AcquireResult::NewFrame) {
+        const auto it = hashes.find(f.sequence);
+        same = same && it != hashes.end() && it->second == HashPixels(f) && (frames == 0 || f.sequence == last + 1);
+        last = f.sequence;
+        frames++;
+    }
+    return same && frames == held && last == hashes.rbegin()->first;
+}
+
+void RemoveSave(const std::string& base) {
+    std::remove(RecordingSegmentPath(base, 0).c_str());
+}
+
+bool CheckRing(const std::string& base) {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  replayring: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+    const int64_t period = kNsPerSec / kCheckHz;
+    const std::string spill = base + ".spill";
+
+    {
+        InstantReplayConfig cfg;
+        cfg.windowNs = 2 * kNsPerSec;
+        cfg.memoryBytes = 64u << 20;
+        cfg.keyframeInterval = 30;
+        InstantReplayRing ring(cfg);
+        const bool started = ring.Start();
+        const auto hashes = Feed(ring, 5 * kCheckHz);
+        const InstantReplayStats st = ring.Stats();
+        expect(started && st.frames == hashes.size() && st.dropped == 0 && st.spanNs >= cfg.windowNs && st.spanNs < cfg.windowNs + cfg.keyframeInterval * period &&
+                   st.frames - st.evicted == st.heldFrames && st.spillBytes == 0,
+               "the window is kept, in whole keyframe groups");
+        const InstantReplaySave saved = SaveAndWait(ring, base);
+        expect(saved.ok && saved.frames == st.heldFrames && saved.spanNs == st.spanNs && ReplaysHeld(base, hashes, st.heldFrames),
+               "a save replays the window from its keyframe");
+        RemoveSave(base);
+    }
+
+    {
+        InstantReplayConfig cfg;
+        cfg.windowNs = 3600 * kNsPerSec;
+        cfg.memoryBytes = 1u << 20;
+        cfg.spillBytes = 1u << 20;
+        cfg.spillPath = spill;
+        cfg.keyframeInterval = 20;
+        InstantReplayRing ring(cfg);
+        InstantReplayStats peak;
+        const bool started = ring.Start();
+        const auto hashes = Feed(ring, 10 * kCheckHz, &peak);
+        const InstantReplayStats st = ring.Stats();
+        expect(started && st.evicted > 0 && st.heldFrames > 0 && st.memoryBytes + st.spillBytes <= cfg.memoryBytes + cfg.spillBytes &&
+                   peak.memoryBytes > cfg.memoryBytes / 2 && peak.spillBytes > cfg.spillBytes / 2,
+               "the byte budget evicts, across RAM and the spill file");
+        const InstantReplaySave saved = SaveAndWait(ring, base);
+        expect(saved.ok && saved.frames == st.heldFrames && ReplaysHeld(base, hashes, st.heldFrames), "RAM and spilled records save and replay");
+        RemoveSave(base);
+        ring.Stop();
+        FILE* f = fopen(spill.c_str(), "rb");
+        expect(!f, "Stop() removes the spill file");
+        if (f) fclose(f);
+    }
+
+    {
+        // Smaller than one group: frames restart groups as their keyframe is evicted.
+        InstantReplayConfig cfg;
+        cfg.memoryBytes = 256u << 10;
+        cfg.keyframeInterval = 1000;
+        InstantReplayRing ring(cfg);
+        const bool started = ring.Start();
+        const auto hashes = Feed(ring, 2 * kCheckHz);
+        const InstantReplayStats st = ring.Stats();
+        const InstantReplaySave saved = SaveAndWait(ring, base);
+        expect(started && st.heldFrames > 0 && st.oversized == 0 && saved.frames == st.heldFrames && ReplaysHeld(base, hashes, st.heldFrames),
+               "a ring shorter than a keyframe group still starts at a keyframe");
+        RemoveSave(base);
+    }
+
+    {
+        InstantReplayConfig cfg;
+        cfg.memoryBytes = 4096;
+        InstantReplayRing ring(cfg);
+        const bool started = ring.Start();
+        const auto hashes = Feed(ring, 10);
+        const InstantReplayStats st = ring.Stats();
+        expect(started && st.oversized == hashes.size() && st.heldFrames == 0 && !SaveAndWait(ring, base).ok, "frames larger than the ring are refused");
+    }
+
+    {
+        // A 7680x1440 frame takes milliseconds to code; the next one arrives meanwhile.
+        ManualClock clock;
+        SyntheticSource synth(clock, RingSource(7680, 1440, 120));
+        InstantReplayRing ring;
+        FrameDesc f{};
+        clock.AdvanceNs(kNsPerSec / 120);
+        const bool acquired = synth.Acquire(0, f) == AcquireResult::NewFrame;
+        const bool notRunning = !ring.Submit(f, 0) && !ring.Save(base.c_str());
+        const bool first = ring.Start() && ring.Submit(f, 0);
+        const bool second = ring.Submit(f, 1);
+        ring.WaitIdle();
+        expect(acquired && notRunning && first && !second && ring.Stats().dropped == 1 && ring.Stats().frames == 1, "a busy ring drops instead of waiting");
+    }
+
+    printf("  replayring: window and budget eviction by keyframe group, RAM+spill, save/replay, oversized and busy frames  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+// Instant-replay ring: eviction and save rules on a 640x360 synthetic session, then a
+// real-time --hz source of --width x --height fed the way rj_span feeds it (a frame is
+// copied in, like a mapped readback, only while the ring is idle) into a RAM ring and a
+// RAM+spill ring: submit cost, frames kept per second, bytes per frame, how long the
+// budget lasts at that rate, and the cost of saving it.
+int BenchReplayRing(int argc, char** argv) {
+    const uint32_t w = static_cast<uint32_t>(ArgInt(argc, argv, "--width", 7680));
+    const uint32_t h = static_cast<uint32_t>(ArgInt(argc, argv, "--height", 1440));
+    const uint32_t hz = static_cast<uint32_t>(ArgInt(argc, argv, "--hz", 120));
+    const int frames = static_cast<int>(ArgInt(argc, argv, "--frames", 240));
+    const uint32_t threads = static_cast<uint32_t>(ArgInt(argc, argv, "--threads", 1));
+    const uint64_t memoryMb = static_cast<uint64_t>(ArgInt(argc, argv, "--memory-mb", 512));
+    const uint64_t spillMb = static_cast<uint64_t>(ArgInt(argc, argv, "--spill-mb", 1024));
+    const std::string base = ArgStr(argc, argv, "--base", "rj_bench_replayring");
+
+    printf("[rj_bench] replayring %ux%u at %u Hz, %d frames, %u codec threads\n", w, h, hz, frames, threads);
+    bool ok = CheckRing(base);
+
+    printf("  %-10s %10s %10s %8s %8s %8s %10s %12s %10s %10s\n",
+           "ring", "MB", "submit us", "max us", "kept/s", "dropped", "KB/frame", "s per GiB", "save ms", "save GB/s");
+    for (bool spill : {false, true}) {
+        InstantReplayConfig cfg;
+        cfg.windowNs = 3600 * kNsPerSec;  // the budget decides
+        cfg.memoryBytes = (spill ? memoryMb / 4 : memoryMb) << 20;
+        cfg.spillBytes = spill ? spillMb << 20 : 0;
+        cfg.spillPath = base + ".spill";
+        cfg.keyframeInterval = hz;
+        cfg.codec.threads = threads;
+        InstantReplayRing ring(cfg);
+        if (!ring.Start()) {
+            printf("  cannot allocate the ring or create %s\n", cfg.spillPath.c_str());
+            return 1;
+        }
+        SteadyClock clock;
+        SyntheticSource synth(clock, RingSource(w, h, hz));
+        std::vector<uint8_t> readback;
+        FrameDesc f{};
+        int64_t submitNs = 0;
+        int64_t submitMaxNs = 0;
+        uint64_t submitted = 0;
+        const int64_t t0 = HostNowNs();
+        for (int i = 0; i < frames;) {
+            if (synth.Acquire(100, f) != AcquireResult::NewFrame) continue;
+            i++;
+            if (!ring.Idle()) {
+                (void)ring.Submit(f, clock.NowNs());  // counted as dropped; the pixels are not taken
+                continue;
+            }
+            readback.assign(f.pixels, f.pixels + static_cast<size_t>(f.strideBytes) * f.height);
+            FrameDesc copy = f;
+            copy.pixels = readback.data();
+            const int64_t s0 = HostNowNs();
+            if (ring.Submit(copy, clock.NowNs())) submitted++;
+            const int64_t s = HostNowNs() - s0;
+            submitNs += s;
+            submitMaxNs = std::max(submitMaxNs, s);
+        }
+        ring.WaitIdle();
+        const double seconds = NsToMs(HostNowNs() - t0) / 1000.0;
+        const InstantReplayStats st = ring.Stats();
+        const int64_t s0 = HostNowNs();
+        const InstantReplaySave saved = SaveAndWait(ring, base);
+        const double saveMs = NsToMs(HostNowNs() - s0);
+        ring.Stop();
+        RemoveSave(base);
+
+        const double keptPerSec = static_cast<double>(st.frames) / seconds;
+        const double frameBytes = static_cast<double>(st.memoryBytes + st.spillBytes) / static_cast<double>(std::max<uint64_t>(st.heldFrames, 1));
+        const bool complete = saved.ok && saved.frames == st.heldFrames && st.frames == submitted && st.oversized == 0;
+        printf("  %-10s %10llu %10.1f %8.1f %8.1f %8llu %10.1f %12.1f %10.1f %10.2f%s\n",
+               spill ? "ram+spill" : "ram",
+               static_cast<unsigned long long>((cfg.memoryBytes + cfg.spillBytes) >> 20),
+               NsToUs(submitNs) / static_cast<double>(std::max<uint64_t>(submitted, 1)),
+               NsToUs(submitMaxNs),
+               keptPerSec,
+               static_cast<unsigned long long>(st.dropped),
+               frameBytes / 1024.0,
+               static_cast<double>(1ull << 30) / std::max(frameBytes * keptPerSec, 1.0),
+               saveMs,
+               static_cast<double>(saved.bytes) / 1e6 / std::max(saveMs, 1e-3),
+               complete ? "" : "  FAILED");
+        ok = ok && complete;
+    }
+    if (std::thread::hardware_concurrency() <= 1) printf("  (one CPU: submit times include the worker thread's time slice)\n");
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
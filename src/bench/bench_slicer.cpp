@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/slicer.h"
+
+namespace rj::bench {
+
+namespace {
+
+// Per-pixel model of kPsSrc with sliceEnabled=1: compute uv from the pixel centre, slice,
+// flip, then pick the texel the linear sample lands on.
+void ShaderReference(const std::vector<uint8_t>& src, uint32_t srcW, uint32_t srcH, uint32_t outW, uint32_t outH,
+                     const SliceParams& p, std::vector<std::vector<uint8_t>>& out) {
+    for (uint32_t s = 0; s < p.outputs; s++) {
+        for (uint32_t y = 0; y < outH; y++) {
+            for (uint32_t x = 0; x < outW; x++) {
+                float u = (static_cast<float>(x) + 0.5f) / static_cast<float>(outW);
+                float v = (static_cast<float>(y) + 0.5f) / static_cast<float>(outH);
+                if (p.flipX) u = 1.0f - u;
+                u = (u + static_cast<float>(s)) / static_cast<float>(p.outputs);
+                if (p.flipY) v = 1.0f - v;
+                const uint32_t tx = std::min(srcW - 1, static_cast<uint32_t>(std::floor(u * static_cast<float>(srcW))));
+                const uint32_t ty = std::min(srcH - 1, static_cast<uint32_t>(std::floor(v * static_cast<float>(srcH))));
+                const uint8_t* t = &src[(static_cast<size_t>(ty) * srcW + tx) * 4u];
+                uint8_t* d = &out[s][(static_cast<size_t>(y) * outW + x) * 4u];
+                d[0] = p.swizzle ? t[2] : t[0];
+                d[1] = t[1];
+                d[2] = p.swizzle ? t[0] : t[2];
+                d[3] = t[3];
+            }
+        }
+    }
+}
+
+} // namespace
+
+// Times every kernel level/variant on a 7680x1440 frame split 3 ways and checks that all
+// of them match the per-pixel shader model bit for bit. Each timing is the best of --reps
+// batches. --target-hz is reported only: the kernels are bandwidth-bound, so the gate (in
+// optimized builds) is the dispatched kernel's slowest variant against memcpy in the same
+// run, at least --min-memcpy-ratio of its frame rate.
+int BenchSlicer(int argc, char** argv) {
+    const uint32_t srcW = static_cast<uint32_t>(ArgInt(argc, argv, "--width", 7680));
+    const uint32_t srcH = static_cast<uint32_t>(ArgInt(argc, argv, "--height", 1440));
+    const uint32_t outputs = static_cast<uint32_t>(ArgInt(argc, argv, "--outputs", 3));
+    const int iters = static_cast<int>(ArgInt(argc, argv, "--iters", 60));
+    const int reps = std::max(1, static_cast<int>(ArgInt(argc, argv, "--reps", 5)));
+    const double targetHz = ArgDouble(argc, argv, "--target-hz", 120.0);
+    const double minMemcpyRatio = ArgDouble(argc, argv, "--min-memcpy-ratio", 0.5);
+    const uint32_t outW = srcW / outputs;
+    const uint32_t outH = srcH;
+
+    std::vector<uint8_t> src(static_cast<size_t>(srcW) * srcH * 4u);
+    std::mt19937 rng(1234);
+    for (auto& b : src) b = static_cast<uint8_t>(rng());
+
+    std::vector<std::vector<uint8_t>> ref(outputs, std::vector<uint8_t>(static_cast<size_t>(outW) * outH * 4u));
+    std::vector<std::vector<uint8_t>> out(outputs, std::vector<uint8_t>(static_cast<size_t>(outW) * outH * 4u));
+    std::vector<SliceTarget> targets(outputs);
+    for (uint32_t i = 0; i < outputs; i++) targets[i] = SliceTarget{out[i].data(), outW * 4u};
+
+    const SimdLevel best = DetectSimdLevel();
+    printf("[rj_bench] slicer %ux%u -> %ux %ux%u, cpu=%s, target=%.0f fps\n", srcW, srcH, outputs, outW, outH, SimdLevelName(best), targetHz);
+
+    // Fastest of `reps` batches splitting `iters` runs, in ms per frame.
+    const int batch = std::max(1, iters / reps);
+    auto bestMsPerFrame = [&](auto&& run) {
+        double fastest = 0.0;
+        for (int r = 0; r < reps; r++) {
+            const int64_t t0 = HostNowNs();
+            for (int it = 0; it < batch; it++) run();
+            const double ms = NsToMs(HostNowNs() - t0) / batch;
+            if (r == 0 || ms < fastest) fastest = ms;
+        }
+        return fastest;
+    };
+
+    // Memory-bandwidth ceiling for reference: one plain copy of the whole frame.
+    double memcpyFps = 0.0;
+    {
+        std::vector<uint8_t> dst(src.size());
+        const double msPerFrame = bestMsPerFrame([&] {
+            std::memcpy(dst.data(), src.data(), src.size());
+            DoNotOptimize(dst.data());
+        });
+        memcpyFps = 1000.0 / msPerFrame;
+        printf("  memcpy  (baseline)                 %.3f ms/frame  %7.1f fps\n", msPerFrame, memcpyFps);
+    }
+
+    int failures = 0;
+    double slowestFps = 0.0;  // dispatched kernel, slowest variant
+    for (int variant = 0; variant < 8; variant++) {
+        SliceParams p;
+        p.outputs = outputs;
+        p.flipX = (variant & 4) != 0;
+        p.flipY = (variant & 2) != 0;
+        p.swizzle = (variant & 1) != 0;
+        ShaderReference(src, srcW, srcH, outW, outH, p, ref);
+
+        for (int lvl = 0; lvl <= static_cast<int>(best); lvl++) {
+            const SimdLevel level = static_cast<SimdLevel>(lvl);
+            for (auto& o : out) std::fill(o.begin(), o.end(), 0);
+            SliceFrame(src.data(), srcW * 4u, srcW, srcH, outW, outH, p, targets.data(), level);
+            bool exact = true;
+            for (uint32_t i = 0; i < outputs; i++) exact = exact && out[i] == ref[i];
+            if (!exact) failures++;
+
+            const double msPerFrame = bestMsPerFrame([&] {
+                SliceFrame(src.data(), srcW * 4u, srcW, srcH, outW, outH, p, targets.data(), level);
+                DoNotOptimize(out[0].data());
+            });
+            const double fps = 1000.0 / msPerFrame;
+            if (level == best && (slowestFps == 0.0 || fps < slowestFps)) slowestFps = fps;
+            const double gbps = (static_cast<double>(src.size()) * 2.0 / 1e9) * fps;
+            printf("  %-7s flipX=%d flipY=%d swizzle=%d  %.3f ms/frame  %7.1f fps  %5.1f GB/s  %s%s\n",
+                   SimdLevelName(level), p.flipX, p.flipY, p.swizzle, msPerFrame, fps, gbps,
+                   exact ? "exact" : "MISMATCH",
+                   fps >= targetHz ? "" : "  (below target on this machine)");
+        }
+    }
+
+    // The kernels are bandwidth-bound: when even memcpy can't reach the target, no kernel will,
+    // so only the ratio to memcpy on the same machine and run is enforced.
+    const double ratio = memcpyFps > 0.0 ? slowestFps / memcpyFps : 0.0;
+    printf("  %s slowest variant %.1f fps, %.2fx memcpy (%.1f fps), target %.0f fps%s\n", SimdLevelName(best), slowestFps,
+           ratio, memcpyFps, targetHz, slowestFps >= targetHz ? "" : " (below target on this machine)");
+#ifdef NDEBUG
+    const bool fast = ratio >= minMemcpyRatio;
+    printf("  memcpy ratio %.2f, minimum %.2f  %s\n", ratio, minMemcpyRatio, fast ? "ok" : "FAILED");
+    if (!fast) failures++;
+#else
+    printf("  memcpy ratio %.2f, minimum %.2f not enforced in an unoptimized build\n", ratio, minMemcpyRatio);
+#endif
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/slice_plan.h"
+#include "core/slicer.h"
+
+namespace rj::bench {
+
+namespace {
+
+// Bytes a path reads and writes per frame, by the step that moves them.
+struct Traffic {
+    uint64_t osCopy{};      // OS copy into the Desktop Duplication or WGC frame surface
+    uint64_t driverCopy{};  // IDD driver copy into the channel slot (wide or slices)
+    uint64_t spanCopy{};    // rj_span copies (into its slot or capture texture, or into a backbuffer)
+    uint64_t clear{};       // ClearRenderTargetView of the backbuffers
+    uint64_t draw{};        // slicing pixel shader: sampled texels + written pixels
+
+    uint64_t Total() const { return osCopy + driverCopy + spanCopy + clear + draw; }
+};
+
+// CPU stand-in for CopyResource / CopySubresourceRegion; counts the read and the write.
+void CopyRect(uint8_t* dst, uint32_t dstStride, const uint8_t* src, uint32_t srcStride, const Rect& r, uint64_t& bytes) {
+    const size_t rowBytes = static_cast<size_t>(r.Width()) * 4u;
+    for (int32_t y = r.top; y < r.bottom; y++) {
+        memcpy(dst + static_cast<size_t>(y - r.top) * dstStride, src + static_cast<size_t>(y) * srcStride + static_cast<size_t>(r.left) * 4u, rowBytes);
+    }
+    bytes += 2u * rowBytes * static_cast<uint64_t>(r.Height());
+}
+
+void Clear(std::vector<uint8_t>& dst, uint64_t& bytes) {
+    std::fill(dst.begin(), dst.end(), uint8_t{5});
+    bytes += dst.size();
+}
+
+// The regions must tile the frame left to right, full height, and match the formula the
+// pipeline and the shader used before the planner existed.
+bool CheckPlans() {
+    bool ok = true;
+    const uint32_t widths[] = {7680, 7681, 7679, 5760, 1, 13};
+    for (uint32_t n = 1; n <= kMaxSliceOutputs; n++) {
+        for (uint32_t w : widths) {
+            SlicePlanConfig cfg;
+            cfg.outputs = n;
+            const SlicePlan plan = PlanSlices(w, 1440, cfg);
+            bool good = plan.outputs == n && plan.sliceEnabled && plan.exact == (w % n == 0) && (plan.AllCopyable() == (w % n == 0));
+            int32_t x = 0;
+            for (uint32_t i = 0; i < n; i++) {
+                const Rect& r = plan.regions[i].src;
+                const int32_t legacyLeft = static_cast<int32_t>(i) * static_cast<int32_t>(w) / static_cast<int32_t>(n);
+                good = good && r.left == x && r.left == legacyLeft && r.top == 0 && r.bottom == 1440 && r.right >= r.left;
+                x = r.right;
+            }
+            good = good && x == static_cast<int32_t>(w);
+            if (!good) printf("  plan outputs=%u width=%u FAILED\n", n, w);
+            ok = ok && good;
+        }
+    }
+
+    // Too narrow for the outputs: every output shows the whole frame.
+    SlicePlanConfig narrow;
+    narrow.outputWidth = 2560;
+    const SlicePlan whole = PlanSlices(2560, 1440, narrow);
+    bool good = !whole.sliceEnabled && !whole.exact && whole.regions[2].src.Width() == 2560;
+    // Within the slack it still slices, but no longer 1:1.
+    const SlicePlan slack = PlanSlices(7680 - 16, 1440, narrow);
+    good = good && slack.sliceEnabled && !slack.exact && !slack.AllCopyable();
+    // Flips need the shader.
+    SlicePlanConfig flipped;
+    flipped.flipX = true;
+    good = good && PlanSlices(7680, 1440, flipped).exact && !PlanSlices(7680, 1440, flipped).AllCopyable();
+    // A dirty rect across the first seam lands in both slices, in slice coordinates.
+    const SlicePlan plan = PlanSlices(7680, 1440, SlicePlanConfig{});
+    Rect a, b, c;
+    good = good && MapRectToSlice(plan.regions[0], Rect{2500, 10, 2600, 20}, a) && MapRectToSlice(plan.regions[1], Rect{2500, 10, 2600, 20}, b) &&
+           !MapRectToSlice(plan.regions[2], Rect{2500, 10, 2600, 20}, c) && a.left == 2500 && a.right == 2560 && b.left == 0 && b.right == 40 && b.top == 10;
+    if (!good) printf("  plan edge cases FAILED\n");
+    printf("  planner: %u output counts x %zu widths, narrow/slack/flip/dirty-rect cases  %s\n",
+           kMaxSliceOutputs,
+           sizeof(widths) / sizeof(widths[0]),
+           ok && good ? "ok" : "FAILED");
+    return ok && good;
+}
+
+// The copy path is taken exactly when the shader's output would be a plain copy of the region.
+bool CheckBlits() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("  blit: %s  FAILED\n", what);
+        ok = ok && cond;
+    };
+
+    const SlicePlan plan = PlanSlices(7680, 1440, SlicePlanConfig{});
+    for (uint32_t i = 0; i < 3; i++) {
+        const OutputBlit b = PlanOutputBlit(plan, i, 2560, 1440, true);
+        expect(b.Copy() && b.src.left == static_cast<int32_t>(i * 2560) && b.src.Width() == 2560 && b.src.Height() == 1440, "identity copies each column");
+    }
+    expect(PlanOutputBlit(plan, 3, 2560, 1440, true).fallback == BlitFallback::NoSource, "output without a region");
+    expect(PlanOutputBlit(SlicePlan{}, 0, 2560, 1440, true).fallback == BlitFallback::NoSource, "empty plan");
+    expect(PlanOutputBlit(plan, 0, 2560, 1440, false).fallback == BlitFallback::Format, "format mismatch");
+    expect(PlanOutputBlit(plan, 1, 1920, 1080, true).fallback == BlitFallback::Scaled, "smaller backbuffer");
+    expect(PlanOutputBlit(plan, 1, 2560, 1439, true).fallback == BlitFallback::Scaled, "one row short");
+
+    SlicePlanConfig flipped;
+    flipped.flipY = true;
+    expect(PlanOutputBlit(PlanSlices(7680, 1440, flipped), 0, 2560, 1440, true).fallback == BlitFallback::Flipped, "flipped");
+
+    // Within the slack: sliced, but the columns are not 2560 wide.
+    SlicePlanConfig slackCfg;
+    slackCfg.expectedWideW = 7680;
+    const SlicePlan slack = PlanSlices(7680 - 16, 1440, slackCfg);
+    expect(PlanOutputBlit(slack, 0, 2560, 1440, true).fallback == BlitFallback::Scaled, "frame within the slack");
+    // A single monitor captured for three outputs: each shows the whole frame, scaled.
+    SlicePlanConfig narrow;
+    narrow.expectedWideW = 7680;
+    expect(PlanOutputBlit(PlanSlices(2560, 1440, narrow), 1, 2560, 1440, true).fallback == BlitFallback::Unsliced, "unsliced frame");
+
+    // A driver-side slice is its own single-output plan.
+    SlicePlanConfig one;
+    one.outputs = 1;
+    const OutputBlit slice = PlanOutputBlit(PlanSlices(2560, 1440, one), 0, 2560, 1440, true);
+    expect(slice.Copy() && slice.src.left == 0 && slice.src.Width() == 2560, "driver slice copies whole");
+    expect(PlanOutputBlit(PlanSlices(2560, 1440, one), 0, 3840, 2160, true).fallback == BlitFallback::Scaled, "driver slice on a larger output");
+
+    // An uneven frame never copies, not even the columns that happen to be 2560 wide: the
+    // shader stretches 7681 texels over 7680 pixels.
+    const SlicePlan uneven = PlanSlices(7681, 1440, SlicePlanConfig{});
+    uint32_t copies = 0;
+    for (uint32_t i = 0; i < 3; i++) copies += PlanOutputBlit(uneven, i, 2560, 1440, true).Copy() ? 1u : 0u;
+    expect(copies == 0, "uneven frame draws every output");
+
+    printf("  blit planner: identity, no-source, format, scaled, flipped, slack, unsliced, driver slice, uneven  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+// Driver-side slicing: the planner's invariants, then the bytes each presentation path moves
+// per frame on a wide frame, replayed on CPU buffers (memcpy for copies, the slicer kernels
+// for the shader) so the counts come from executed operations and the outputs can be
+// compared bit for bit.
+int BenchSlices(int argc, char** argv) {
+    const uint32_t srcW = static_cast<uint32_t>(ArgInt(argc, argv, "--width", 7680));
+    const uint32_t srcH = static_cast<uint32_t>(ArgInt(argc, argv, "--height", 1440));
+    const uint32_t outputs = static_cast<uint32_t>(ArgInt(argc, argv, "--outputs", 3));
+    const int iters = static_cast<int>(ArgInt(argc, argv, "--iters", 30));
+    const uint32_t hz = static_cast<uint32_t>(ArgInt(argc, argv, "--hz", 120));
+
+    printf("[rj_bench] slices %ux%u@%u over %u outputs, %d iterations\n", srcW, srcH, hz, outputs, iters);
+    bool ok = CheckPlans();
+    ok = CheckBlits() && ok;
+
+    SlicePlanConfig cfg;
+    cfg.outputs = outputs;
+    const SlicePlan plan = PlanSlices(srcW, srcH, cfg);
+    if (!plan.exact || plan.outputs != outputs) {
+        printf("  %ux%u does not split 1:1 over %u outputs  FAILED\n", srcW, srcH, outputs);
+        return 1;
+    }
+    const uint32_t outW = plan.regions[0].dstWidth;
+    const uint32_t outH = plan.regions[0].dstHeight;
+    const uint32_t srcStride = srcW * 4u;
+    const uint32_t outStride = outW * 4u;
+    const Rect whole{0, 0, static_cast<int32_t>(srcW), static_cast<int32_t>(srcH)};
+
+    std::vector<uint8_t> desktop(static_cast<size_t>(srcStride) * srcH);
+    std::mt19937 rng(99);
+    for (auto& b : desktop) b = static_cast<uint8_t>(rng());
+    std::vector<uint8_t> dupSurface(desktop.size());
+    std::vector<uint8_t> slot(desktop.size());
+    std::vector<std::vector<uint8_t>> slices(outputs, std::vector<uint8_t>(static_cast<size_t>(outStride) * outH));
+    std::vector<std::vector<uint8_t>> backbuffers(outputs, std::vector<uint8_t>(static_cast<size_t>(outStride) * outH));
+    std::vector<SliceTarget> targets(outputs);
+    for (uint32_t i = 0; i < outputs; i++) targets[i] = SliceTarget{backbuffers[i].data(), outStride};
+
+    // The shader samples every texel of its column once and writes every backbuffer pixel.
+    auto draw = [&](const uint8_t* src, Traffic& t) {
+        SliceFrame(src, srcStride, srcW, srcH, outW, outH, SliceParams{outputs, false, false, false}, targets.data());
+        t.draw += desktop.size() + static_cast<uint64_t>(outStride) * outH * outputs;
+    };
+
+    // Columns of a wide source copied straight into the backbuffers (the blit fast path).
+    auto blitColumns = [&](const uint8_t* src, Traffic& t) {
+        for (uint32_t i = 0; i < outputs; i++) {
+            const OutputBlit b = PlanOutputBlit(plan, i, outW, outH, true);
+            CopyRect(backbuffers[i].data(), outStride, src, srcStride, b.src, t.spanCopy);
+        }
+    };
+
+    enum class Path { Wgc, WgcBlit, Dd, DdBlit, IddWide, IddWideBlit, IddSliced };
+    auto runFrame = [&](Path path, Traffic& t) {
+        switch (path) {
+            case Path::Wgc:
+                // Frame pool surface -> rj_span's capture texture -> clear + slicing draw.
+                CopyRect(dupSurface.data(), srcStride, desktop.data(), srcStride, whole, t.osCopy);
+                CopyRect(slot.data(), srcStride, dupSurface.data(), srcStride, whole, t.spanCopy);
+                for (auto& bb : backbuffers) Clear(bb, t.clear);
+                draw(slot.data(), t);
+                break;
+            case Path::WgcBlit:
+                // No capture texture: each column goes from the frame pool surface to its backbuffer.
+                CopyRect(dupSurface.data(), srcStride, desktop.data(), srcStride, whole, t.osCopy);
+                blitColumns(dupSurface.data(), t);
+                break;
+            case Path::DdBlit:
+                CopyRect(dupSurface.data(), srcStride, desktop.data(), srcStride, whole, t.osCopy);
+                CopyRect(slot.data(), srcStride, dupSurface.data(), srcStride, whole, t.spanCopy);
+                blitColumns(slot.data(), t);
+                break;
+            case Path::IddWideBlit:
+                CopyRect(slot.data(), srcStride, desktop.data(), srcStride, whole, t.driverCopy);
+                blitColumns(slot.data(), t);
+                break;
+            case Path::Dd:
+                // Duplication surface -> rj_span's slot -> clear + slicing draw per output.
+                CopyRect(dupSurface.data(), srcStride, desktop.data(), srcStride, whole, t.osCopy);
+                CopyRect(slot.data(), srcStride, dupSurface.data(), srcStride, whole, t.spanCopy);
+                for (auto& bb : backbuffers) Clear(bb, t.clear);
+                draw(slot.data(), t);
+                break;
+            case Path::IddWide:
+                // Driver copies the swap-chain surface into the channel slot; rj_span samples it.
+                CopyRect(slot.data(), srcStride, desktop.data(), srcStride, whole, t.driverCopy);
+                for (auto& bb : backbuffers) Clear(bb, t.clear);
+                draw(slot.data(), t);
+                break;
+            case Path::IddSliced:
+                // Driver copies each column into its slice surface; rj_span copies each slice
+                // into its backbuffer. No clear, no draw.
+                for (uint32_t i = 0; i < outputs; i++) {
+                    CopyRect(slices[i].data(), outStride, desktop.data(), srcStride, plan.regions[i].src, t.driverCopy);
+                }
+                for (uint32_t i = 0; i < outputs; i++) {
+                    const Rect local{0, 0, static_cast<int32_t>(outW), static_cast<int32_t>(outH)};
+                    CopyRect(backbuffers[i].data(), outStride, slices[i].data(), outStride, local, t.spanCopy);
+                }
+                break;
+        }
+    };
+
+    // Reference: what the shader shows on each output.
+    std::vector<std::vector<uint8_t>> ref(outputs, std::vector<uint8_t>(static_cast<size_t>(outStride) * outH));
+    std::vector<SliceTarget> refTargets(outputs);
+    for (uint32_t i = 0; i < outputs; i++) refTargets[i] = SliceTarget{ref[i].data(), outStride};
+    SliceFrame(desktop.data(), srcStride, srcW, srcH, outW, outH, SliceParams{outputs, false, false, false}, refTargets.data(), SimdLevel::Scalar);
+
+    struct PathInfo {
+        Path path;
+        const char* name;
+    };
+    const PathInfo paths[] = {
+        {Path::Wgc, "wgc"},
+        {Path::WgcBlit, "wgc-blit"},
+        {Path::Dd, "dd"},
+        {Path::DdBlit, "dd-blit"},
+        {Path::IddWide, "idd-wide"},
+        {Path::IddWideBlit, "idd-blit"},
+        {Path::IddSliced, "idd-sliced"},
+    };
+    const double mb = 1024.0 * 1024.0;
+    const double gb = mb * 1024.0;
+    uint64_t totals[sizeof(paths) / sizeof(paths[0])]{};
+    double cpuMs[sizeof(paths) / sizeof(paths[0])]{};
+    printf("  %-11s %9s %9s %9s %9s %9s %10s %8s %10s\n", "path", "os MB", "driver MB", "span MB", "clear MB", "draw MB", "total MB", "GB/s", "cpu ms");
+    for (size_t pi = 0; pi < sizeof(paths) / sizeof(paths[0]); pi++) {
+        const PathInfo& p = paths[pi];
+        for (auto& bb : backbuffers) std::fill(bb.begin(), bb.end(), uint8_t{0});
+        Traffic t;
+        runFrame(p.path, t);
+        bool exact = true;
+        for (uint32_t i = 0; i < outputs; i++) exact = exact && backbuffers[i] == ref[i];
+
+        const int64_t t0 = HostNowNs();
+        for (int it = 0; it < iters; it++) {
+            Traffic scratch;
+            runFrame(p.path, scratch);
+            DoNotOptimize(backbuffers[0].data());
+        }
+        const double msPerFrame = NsToMs(HostNowNs() - t0) / iters;
+
+        totals[pi] = t.Total();
+        cpuMs[pi] = msPerFrame;
+        printf("  %-11s %9.1f %9.1f %9.1f %9.1f %9.1f %10.1f %8.1f %10.2f  %s\n",
+               p.name,
+               static_cast<double>(t.osCopy) / mb,
+               static_cast<double>(t.driverCopy) / mb,
+               static_cast<double>(t.spanCopy) / mb,
+               static_cast<double>(t.clear) / mb,
+               static_cast<double>(t.draw) / mb,
+               static_cast<double>(t.Total()) / mb,
+               static_cast<double>(t.Total()) * hz / gb,
+               msPerFrame,
+               exact ? "exact" : "MISMATCH");
+        ok = ok && exact;
+    }
+
+    // Before/after per capture path, at the output rate: the blit path drops the capture
+    // texture copy (WGC), the clears and the shader.
+    auto index = [&](Path path) {
+        size_t i = 0;
+        while (paths[i].path != path) i++;
+        return i;
+    };
+    const std::pair<Path, Path> pairs[] = {{Path::Wgc, Path::WgcBlit}, {Path::Dd, Path::DdBlit}, {Path::IddWide, Path::IddWideBlit}};
+    for (const auto& [before, after] : pairs) {
+        const size_t b = index(before);
+        const size_t a = index(after);
+        const bool less = totals[a] < totals[b];
+        printf("  %-8s -> %-10s %6.1f -> %6.1f GB/s at %u Hz, cpu replay %.2f -> %.2f ms  %s\n",
+               paths[b].name,
+               paths[a].name,
+               static_cast<double>(totals[b]) * hz / gb,
+               static_cast<double>(totals[a]) * hz / gb,
+               hz,
+               cpuMs[b],
+               cpuMs[a],
+               less ? "ok" : "FAILED");
+        ok = ok && less;
+    }
+    const uint64_t ddTotal = totals[index(Path::Dd)];
+    const uint64_t slicedTotal = totals[index(Path::IddSliced)];
+    ok = ok && slicedTotal < ddTotal;
+    printf("  driver-side slicing moves %.1f MB less per frame than Desktop Duplication  %s\n",
+           static_cast<double>(ddTotal - std::min(ddTotal, slicedTotal)) / mb,
+           ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,219 @@
+#include <memory>
+#include <string>
+
+#include "bench/bench.h"
+#include "core/latency_histogram.h"
+#include "core/mock_swapchain.h"
+#include "core/swapchain_loop.h"
+
+namespace rj::bench {
+
+namespace {
+
+// Publishing to the frame channel: burns simulated time and records present->process.
+class CostSink final : public ISwapChainFrameSink {
+public:
+    CostSink(Clock& clock, int64_t costNs) : m_clock(clock), m_costNs(costNs) {}
+
+    bool ProcessFrame(const SwapChainBuffer& buffer) override {
+        m_latency->Record(m_clock.NowNs() - buffer.presentTimeNs);
+        m_clock.SleepForNs(m_costNs);
+        m_frames++;
+        return true;
+    }
+    void OnIdle(int64_t) override { m_idleCalls++; }
+
+    const LatencyHistogram& Latency() const { return *m_latency; }
+    uint64_t Frames() const { return m_frames; }
+    uint64_t IdleCalls() const { return m_idleCalls; }
+
+private:
+    Clock& m_clock;
+    int64_t m_costNs;
+    std::unique_ptr<LatencyHistogram> m_latency = std::make_unique<LatencyHistogram>();
+    uint64_t m_frames{};
+    uint64_t m_idleCalls{};
+};
+
+// The sample driver's original loop: retry the acquire after every wakeup, including the
+// 16 ms timeout, and report nothing.
+void RunLegacyLoop(ISwapChainPort& port, ISwapChainFrameSink& sink) {
+    for (;;) {
+        SwapChainBuffer buffer;
+        const SwapChainAcquire a = port.ReleaseAndAcquire(buffer);
+        if (a == SwapChainAcquire::Pending) {
+            const SwapChainWait w = port.WaitForWork(16 * kNsPerMs);
+            if (w == SwapChainWait::NewFrame || w == SwapChainWait::Timeout) continue;
+            break;
+        }
+        if (a == SwapChainAcquire::Lost) break;
+        sink.ProcessFrame(buffer);
+        if (!port.FinishedProcessing()) break;
+    }
+}
+
+enum class Content { Idle, Paced, Bursty };
+
+struct Scenario {
+    const char* name;
+    Content content;
+    uint32_t hz;
+};
+
+void Schedule(MockSwapChain& chain, const Scenario& s, int64_t startNs, int64_t endNs, uint32_t seed) {
+    uint32_t rng = seed;
+    if (s.content == Content::Paced) {
+        const int64_t period = kNsPerSec / s.hz;
+        for (int64_t t = startNs + period; t < endNs; t += period) chain.PresentAt(t);
+    } else if (s.content == Content::Bursty) {
+        // Typing-like: bursts of 2-6 frames at the display rate, about 8 bursts a second.
+        const int64_t period = kNsPerSec / s.hz;
+        int64_t t = startNs;
+        for (;;) {
+            t += static_cast<int64_t>(NextRandom(rng) % 250) * kNsPerMs;
+            const uint32_t n = 2 + NextRandom(rng) % 5;
+            for (uint32_t i = 0; i < n; i++, t += period) {
+                if (t >= endNs) return;
+                chain.PresentAt(t);
+            }
+        }
+    }
+}
+
+struct RunResult {
+    double wakeupsPerSec{};
+    double acquireCallsPerFrame{};
+    uint64_t frames{};
+    uint64_t reported{};
+    uint64_t acquireCalls{};
+    LatencyPercentiles latency{};
+    SwapChainLoopStats stats{};
+    SwapChainExit exit{SwapChainExit::None};
+};
+
+RunResult RunScenario(const Scenario& s, bool eventDriven, int64_t seconds, int64_t processNs, const SwapChainLoopConfig& cfg) {
+    const int64_t start = kNsPerSec;
+    const int64_t end = start + seconds * kNsPerSec;
+    ManualClock clock(start);
+    MockSwapChainConfig mcfg;
+    mcfg.terminateAtNs = end;
+    MockSwapChain chain(clock, mcfg);
+    Schedule(chain, s, start, end, 12345);
+    CostSink sink(clock, processNs);
+
+    RunResult r;
+    if (eventDriven) {
+        SwapChainLoop loop(chain, sink, cfg);
+        r.exit = loop.Run();
+        r.stats = loop.Stats();
+    } else {
+        RunLegacyLoop(chain, sink);
+    }
+    const MockSwapChainCounters& c = chain.Counters();
+    r.wakeupsPerSec = static_cast<double>(c.waits) / static_cast<double>(seconds);
+    r.frames = sink.Frames();
+    r.reported = chain.Reported().size();
+    r.acquireCalls = c.acquireCalls;
+    r.acquireCallsPerFrame = r.frames ? static_cast<double>(c.acquireCalls) / static_cast<double>(r.frames) : static_cast<double>(c.acquireCalls);
+    r.latency = SummarizeLatency(sink.Latency());
+    return r;
+}
+
+void PrintRun(const char* scenario, const char* loop, const RunResult& r) {
+    printf("  %-8s %-7s frames=%-5llu wakeups/s=%-6.1f acquire calls=%-6llu (%.2f/frame) present->process(us) p50=%.0f p99=%.0f",
+           scenario,
+           loop,
+           static_cast<unsigned long long>(r.frames),
+           r.wakeupsPerSec,
+           static_cast<unsigned long long>(r.acquireCalls),
+           r.acquireCallsPerFrame,
+           r.latency.p50Us,
+           r.latency.p99Us);
+    if (r.stats.frames > 0) {
+        const double n = static_cast<double>(r.stats.frames);
+        printf(" acquire/process/finish(us) avg=%.0f/%.0f/%.0f reported=%llu",
+               NsToUs(r.stats.acquireSumNs) / n,
+               NsToUs(r.stats.processSumNs) / n,
+               NsToUs(r.stats.finishSumNs) / n,
+               static_cast<unsigned long long>(r.reported));
+    }
+    printf("\n");
+}
+
+// The loop must leave on each exit condition, having reported every frame it acquired.
+bool CheckExits() {
+    bool ok = true;
+    {
+        ManualClock clock(kNsPerSec);
+        MockSwapChainConfig mcfg;
+        mcfg.loseAfterFrames = 10;
+        MockSwapChain chain(clock, mcfg);
+        for (int i = 1; i <= 50; i++) chain.PresentAt(kNsPerSec + i * 8 * kNsPerMs);
+        CostSink sink(clock, 100 * kNsPerUs);
+        SwapChainLoop loop(chain, sink);
+        const SwapChainExit exit = loop.Run();
+        const bool lostOk = exit == SwapChainExit::Lost && chain.Reported().size() == 10;
+        printf("  exit on lost swap-chain after 10 frames: reported=%zu  %s\n", chain.Reported().size(), lostOk ? "ok" : "FAILED");
+        ok = ok && lostOk;
+    }
+    {
+        ManualClock clock(kNsPerSec);
+        MockSwapChainConfig mcfg;
+        mcfg.terminateAtNs = 2 * kNsPerSec;
+        MockSwapChain chain(clock, mcfg);
+        CostSink sink(clock, 100 * kNsPerUs);
+        SwapChainLoopConfig cfg;
+        cfg.idleTimeoutNs = -1;
+        SwapChainLoop loop(chain, sink, cfg);
+        const SwapChainExit exit = loop.Run();
+        const bool termOk = exit == SwapChainExit::Terminated && chain.Counters().waits == 1 && clock.NowNs() >= 2 * kNsPerSec;
+        printf("  exit on terminate with no idle timeout: waits=%llu  %s\n",
+               static_cast<unsigned long long>(chain.Counters().waits),
+               termOk ? "ok" : "FAILED");
+        ok = ok && termOk;
+    }
+    return ok;
+}
+
+} // namespace
+
+// IDD swap-chain processing: the event-driven state machine vs. the sample's 16 ms polling
+// loop on a simulated swap-chain, for an idle desktop, paced content and bursts.
+int BenchSwapchain(int argc, char** argv) {
+    const int64_t seconds = ArgInt(argc, argv, "--seconds", 10);
+    const int64_t processNs = ArgInt(argc, argv, "--process-us", 150) * kNsPerUs;
+    SwapChainLoopConfig cfg;
+    cfg.idleTimeoutNs = ArgInt(argc, argv, "--idle-ms", 250) * kNsPerMs;
+
+    printf("[rj_bench] swapchain %llds simulated per run, process=%lldus idle timeout=%lldms\n",
+           static_cast<long long>(seconds),
+           static_cast<long long>(processNs / kNsPerUs),
+           static_cast<long long>(cfg.idleTimeoutNs / kNsPerMs));
+
+    const Scenario scenarios[] = {
+        {"idle", Content::Idle, 0},
+        {"60Hz", Content::Paced, 60},
+        {"120Hz", Content::Paced, 120},
+        {"bursty", Content::Bursty, 120},
+    };
+
+    bool ok = true;
+    for (const Scenario& s : scenarios) {
+        const RunResult legacy = RunScenario(s, false, seconds, processNs, cfg);
+        const RunResult event = RunScenario(s, true, seconds, processNs, cfg);
+        PrintRun(s.name, "poll16", legacy);
+        PrintRun(s.name, "event", event);
+
+        // Same frames, every one reported, no acquire without a reason, no extra latency.
+        const double maxIdleWakeups = static_cast<double>(kNsPerSec) / static_cast<double>(cfg.idleTimeoutNs) + 1.0;
+        bool good = event.exit == SwapChainExit::Terminated && event.frames == legacy.frames && event.reported == event.frames &&
+                    event.acquireCalls <= 2 * event.frames + 1 && event.latency.p99Us <= legacy.latency.p99Us + 1.0;
+        if (s.content == Content::Idle) good = good && event.wakeupsPerSec <= maxIdleWakeups && event.acquireCalls == 1;
+        if (!good) printf("  %-8s FAILED\n", s.name);
+        ok = ok && good;
+    }
+    ok = CheckExits() && ok;
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/trace_ring.h"
+
+namespace rj::bench {
+
+namespace {
+
+// Every record a writer emits carries the same value three ways (time, frame id, arg), so a
+// torn read shows up as a mismatch.
+int64_t EncodeTime(uint32_t writer, uint64_t seq) {
+    return static_cast<int64_t>((static_cast<uint64_t>(writer) << 40) | seq);
+}
+
+// Checks one snapshot: records are whole, and each writer's records are in the order it
+// wrote them.
+bool CheckSnapshot(const std::vector<TraceRecord>& records, uint32_t writers) {
+    std::vector<int64_t> lastSeq(writers, -1);
+    for (const TraceRecord& r : records) {
+        if (r.arg >= writers || r.event != TraceEvent::Copy || r.phase != TracePhase::Instant) return false;
+        if (r.timeNs != EncodeTime(r.arg, r.frameId)) return false;
+        const int64_t seq = static_cast<int64_t>(r.frameId);
+        if (seq <= lastSeq[r.arg]) return false;
+        lastSeq[r.arg] = seq;
+    }
+    return true;
+}
+
+// The interleavings a thread scheduler only produces by chance, stepped through on one slot
+// of an 8-slot ring: record 3's writer preempted between taking its index and writing, while
+// record 11's writer wraps onto the same slot.
+bool CheckSlotInterleavings() {
+    auto record = [](uint64_t v) {
+        TraceRecord r;
+        r.timeNs = EncodeTime(1, v);
+        r.frameId = v;
+        r.event = TraceEvent::Copy;
+        r.phase = TracePhase::Instant;
+        r.arg = 1;
+        return r;
+    };
+    auto holds = [](const detail::TraceSlot& s, uint64_t index, uint64_t v) {
+        TraceRecord r;
+        return s.Read(index, r) && r.frameId == v && r.timeNs == EncodeTime(1, v);
+    };
+    bool ok = true;
+    TraceRecord r;
+
+    // Old writer claims first: the new one can't take the slot while it's being written.
+    {
+        detail::TraceSlot s;
+        ok = ok && s.Claim(3) && !s.Claim(11) && !s.Read(3, r) && !s.Read(11, r);
+        s.Publish(3, record(3));
+        ok = ok && holds(s, 3, 3) && !s.Read(11, r);
+        // A later lap takes it once it's complete; record 3 is gone from then on.
+        ok = ok && s.Claim(11) && !s.Read(3, r);
+        s.Publish(11, record(11));
+        ok = ok && holds(s, 11, 11) && !s.Read(3, r);
+    }
+    // New writer claims first: the preempted old one resumes and must not write over it.
+    {
+        detail::TraceSlot s;
+        ok = ok && s.Claim(11);
+        ok = ok && !s.Claim(3);
+        s.Publish(11, record(11));
+        ok = ok && !s.Claim(3) && holds(s, 11, 11) && !s.Read(3, r);
+    }
+    // Each record is claimed once.
+    {
+        detail::TraceSlot s;
+        ok = ok && s.Claim(3) && !s.Claim(3);
+        s.Publish(3, record(3));
+        ok = ok && !s.Claim(3) && holds(s, 3, 3);
+    }
+
+    printf("  interleavings writer preempted across a wrap, both orders  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// Writers and a snapshotting thread on one ring. The checks hold for any interleaving, so
+// the verdict doesn't depend on scheduling; a small capacity makes writers a lap apart meet
+// on the same slot constantly.
+bool RunConcurrent(uint32_t writers, uint64_t perWriter, uint32_t capacity) {
+    auto ring = std::make_unique<TraceRing>(capacity);
+    std::atomic<uint32_t> running{writers};
+    std::vector<double> nsPerEvent(writers);
+    std::vector<std::thread> threads;
+    for (uint32_t w = 0; w < writers; w++) {
+        threads.emplace_back([&, w] {
+            const int64_t t0 = HostNowNs();
+            for (uint64_t i = 0; i < perWriter; i++) {
+                ring->Instant(TraceEvent::Copy, i, EncodeTime(w, i), w);
+            }
+            nsPerEvent[w] = static_cast<double>(HostNowNs() - t0) / static_cast<double>(perWriter);
+            running.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    std::vector<TraceRecord> snap;
+    uint64_t snapshots = 0;
+    uint64_t snapshotRecords = 0;
+    bool ok = true;
+    while (running.load(std::memory_order_acquire) > 0) {
+        ring->Snapshot(snap);
+        snapshots++;
+        snapshotRecords += snap.size();
+        if (!CheckSnapshot(snap, writers)) ok = false;
+        std::this_thread::yield();
+    }
+    for (std::thread& t : threads) t.join();
+
+    // Once the writers are done every slot is complete; a slot is only missing its newest
+    // record when that writer dropped it.
+    ring->Snapshot(snap);
+    const uint64_t total = perWriter * writers;
+    const uint64_t expected = std::min<uint64_t>(total, ring->Capacity());
+    const bool full = snap.size() <= expected && snap.size() + ring->Dropped() >= expected && ring->Recorded() == total &&
+                      (writers > 1 || ring->Dropped() == 0);
+    ok = ok && full && CheckSnapshot(snap, writers);
+
+    double avg = 0.0;
+    for (double ns : nsPerEvent) avg += ns;
+    avg /= static_cast<double>(writers);
+    printf("  ring x%u       %6.1f ns/event  snapshots=%llu (avg %llu records)  final=%zu/%u dropped=%llu  %s\n",
+           writers,
+           avg,
+           static_cast<unsigned long long>(snapshots),
+           static_cast<unsigned long long>(snapshots ? snapshotRecords / snapshots : 0),
+           snap.size(),
+           ring->Capacity(),
+           static_cast<unsigned long long>(ring->Dropped()),
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// Dump -> read back -> Chrome JSON, through temporary files.
+bool CheckRoundTrip() {
+    TraceRing ring(64);
+    ring.NameThread("render");
+    for (uint64_t frame = 1; frame <= 40; frame++) {
+        const int64_t t = static_cast<int64_t>(frame) * 8333 * kNsPerUs;
+        ring.Begin(TraceEvent::Frame, frame, t);
+        ring.Begin(TraceEvent::Present, frame, t + 100 * kNsPerUs, 2);
+        ring.End(TraceEvent::Present, frame, t + 900 * kNsPerUs, 2);
+        ring.End(TraceEvent::Frame, frame, t + 1000 * kNsPerUs);
+    }
+    std::vector<TraceRecord> records;
+    ring.Snapshot(records);
+
+    FILE* f = tmpfile();
+    if (!f) return false;
+    bool ok = WriteTraceDump(f, records, ring.ThreadNames());
+    rewind(f);
+    std::vector<TraceRecord> back;
+    std::vector<std::string> names;
+    ok = ok && ReadTraceDump(f, back, names);
+    fclose(f);
+    ok = ok && back.size() == records.size() && names.size() == TraceRing::kMaxThreads;
+    for (size_t i = 0; ok && i < back.size(); i++) {
+        ok = back[i].timeNs == records[i].timeNs && back[i].frameId == records[i].frameId && back[i].event == records[i].event &&
+             back[i].phase == records[i].phase && back[i].arg == records[i].arg;
+    }
+    ok = ok && std::find(names.begin(), names.end(), "render") != names.end();
+
+    // The ring kept the last 64 of 160 events, starting on a frame boundary; the JSON must
+    // still balance every Begin with an End.
+    f = tmpfile();
+    if (!f) return false;
+    WriteChromeTraceJson(f, back, names);
+    const long bytes = ftell(f);
+    rewind(f);
+    std::vector<char> json(static_cast<size_t>(std::max(bytes, 0L)) + 1, '\0');
+    const size_t got = fread(json.data(), 1, json.size() - 1, f);
+    fclose(f);
+    size_t begins = 0;
+    size_t ends = 0;
+    for (const char* p = json.data(); (p = strstr(p, "\"ph\":\"")) != nullptr; p += 6) {
+        if (p[6] == 'B') begins++;
+        if (p[6] == 'E') ends++;
+    }
+    ok = ok && got == static_cast<size_t>(bytes) && begins == ends && begins == back.size() / 2;
+
+    printf("  round trip    records=%zu dump=%zu bytes json=%ld bytes B/E=%zu/%zu  %s\n",
+           back.size(),
+           back.size() * sizeof(TraceRecord),
+           bytes,
+           begins,
+           ends,
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+// Per-frame trace ring: recording cost (the request budget is a few hundred ns per event,
+// timestamp included), snapshot consistency while several threads record, and the
+// dump/JSON round trip rj_trace relies on.
+int BenchTrace(int argc, char** argv) {
+    const uint64_t events = static_cast<uint64_t>(ArgInt(argc, argv, "--events", 4000000));
+    const uint32_t writers = static_cast<uint32_t>(std::max<int64_t>(1, ArgInt(argc, argv, "--threads", 3)));
+    const uint32_t capacity = static_cast<uint32_t>(ArgInt(argc, argv, "--capacity", 1 << 16));
+
+    printf("[rj_bench] trace events=%llu writers=%u capacity=%u\n", static_cast<unsigned long long>(events), writers, capacity);
+
+    auto ring = std::make_unique<TraceRing>(capacity);
+    int64_t t0 = HostNowNs();
+    for (uint64_t i = 0; i < events; i++) ring->Instant(TraceEvent::Draw, i, static_cast<int64_t>(i));
+    const double recordNs = static_cast<double>(HostNowNs() - t0) / static_cast<double>(events);
+    t0 = HostNowNs();
+    for (uint64_t i = 0; i < events; i++) ring->Instant(TraceEvent::Draw, i, HostNowNs());
+    const double stampedNs = static_cast<double>(HostNowNs() - t0) / static_cast<double>(events);
+    DoNotOptimize(ring.get());
+    printf("  record        %6.1f ns/event (caller timestamp)  %6.1f ns/event (with steady clock)\n", recordNs, stampedNs);
+
+    bool ok = CheckRoundTrip();
+    ok = CheckSlotInterleavings() && ok;
+    ok = RunConcurrent(1, events / 4, capacity) && ok;
+    if (writers > 1) ok = RunConcurrent(writers, events / (4 * writers) + 1, capacity) && ok;
+    ok = RunConcurrent(std::max(writers, 4u), events / 16 + 1, 16) && ok;
+    return ok ? 0 : 1;
+}
+
+} // namespace rj::bench
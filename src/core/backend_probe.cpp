@@ -0,0 +1,200 @@
+#include "core/backend_probe.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace rj {
+
+namespace {
+
+constexpr char kCacheHeader[] = "rj_backend_cache 1";
+
+} // namespace
+
+const char* CaptureBackendName(CaptureBackend b) {
+    switch (b) {
+    case CaptureBackend::Wgc:
+        return "wgc";
+    case CaptureBackend::DdSingleWide:
+        return "dd_single_wide";
+    case CaptureBackend::DdTripleComposite:
+        return "dd_triple_composite";
+    }
+    return "unknown";
+}
+
+bool ParseCaptureBackend(const char* name, CaptureBackend& out) {
+    for (CaptureBackend b : {CaptureBackend::Wgc, CaptureBackend::DdSingleWide, CaptureBackend::DdTripleComposite}) {
+        if (strcmp(name, CaptureBackendName(b)) == 0) {
+            out = b;
+            return true;
+        }
+    }
+    return false;
+}
+
+BackendProbe::BackendProbe(const BackendProbeConfig& cfg) : m_cfg(cfg) {
+    m_cfg.minFrames = std::max(m_cfg.minFrames, 1u);
+}
+
+void BackendProbe::Begin(const std::vector<CaptureBackend>& candidates, int64_t nowNs) {
+    m_candidates = candidates;
+    m_scores.clear();
+    m_haveChoice = false;
+    m_index = 0;
+    m_active = !m_candidates.empty();
+    m_windowStartNs = nowNs;
+    m_rejected = nullptr;
+    m_frames = 0;
+    m_copies = 0;
+    m_copyNs = 0;
+    m_latency.Reset();
+}
+
+void BackendProbe::Cancel() {
+    m_active = false;
+    m_haveChoice = false;
+}
+
+bool BackendProbe::Advance(int64_t nowNs) {
+    if (!m_active) return false;
+    if (!m_rejected && nowNs < m_windowStartNs + m_cfg.warmupNs + m_cfg.windowNs) return false;
+    FinishWindow(nowNs);
+    if (++m_index < m_candidates.size()) {
+        m_windowStartNs = nowNs;
+        m_rejected = nullptr;
+        m_frames = 0;
+        m_copies = 0;
+        m_copyNs = 0;
+        m_latency.Reset();
+    } else {
+        m_active = false;
+        Choose();
+    }
+    return true;
+}
+
+void BackendProbe::Reject(const char* reason) {
+    if (m_active && !m_rejected) m_rejected = reason;
+}
+
+void BackendProbe::OnFrame(int64_t nowNs) {
+    if (Measuring(nowNs)) m_frames++;
+}
+
+void BackendProbe::OnCopies(int64_t nowNs, uint64_t copies, int64_t totalNs) {
+    if (!Measuring(nowNs)) return;
+    m_copies += copies;
+    m_copyNs += totalNs;
+}
+
+void BackendProbe::OnPresent(int64_t nowNs, int64_t copyToPresentNs) {
+    if (Measuring(nowNs)) m_latency.Record(copyToPresentNs);
+}
+
+const BackendScore* BackendProbe::ChosenScore() const {
+    if (!m_haveChoice) return nullptr;
+    for (const BackendScore& s : m_scores) {
+        if (s.backend == m_choice && !s.rejected) return &s;
+    }
+    return nullptr;
+}
+
+void BackendProbe::FinishWindow(int64_t nowNs) {
+    BackendScore s;
+    s.backend = m_candidates[m_index];
+    s.frames = m_frames;
+    const int64_t measuredNs = std::max<int64_t>(nowNs - (m_windowStartNs + m_cfg.warmupNs), 1);
+    s.arrivalHz = static_cast<double>(m_frames) * static_cast<double>(kNsPerSec) / static_cast<double>(measuredNs);
+    s.copies = m_copies;
+    s.copyAvgUs = m_copies ? NsToUs(m_copyNs) / static_cast<double>(m_copies) : 0.0;
+    s.latencyP50Us = NsToUs(m_latency.ValueAtPercentileNs(50.0));
+    s.latencyP95Us = NsToUs(m_latency.ValueAtPercentileNs(95.0));
+    if (m_rejected) s.rejected = m_rejected;
+    else if (m_frames < m_cfg.minFrames) s.rejected = "too few frames";
+    else if (m_latency.Count() == 0) s.rejected = "nothing presented";
+    if (!s.rejected) s.costUs = 0.5e6 / s.arrivalHz + s.latencyP95Us + 2.0 * s.copyAvgUs;
+    m_scores.push_back(s);
+}
+
+void BackendProbe::Choose() {
+    double bestHz = 0.0;
+    for (const BackendScore& s : m_scores) {
+        if (!s.rejected) bestHz = std::max(bestHz, s.arrivalHz);
+    }
+    const BackendScore* best = nullptr;
+    for (BackendScore& s : m_scores) {
+        if (s.rejected) continue;
+        if (s.arrivalHz < bestHz * m_cfg.minRateFraction) {
+            s.rejected = "slow arrival";
+            continue;
+        }
+        if (!best || s.costUs < best->costUs) best = &s;
+    }
+    m_haveChoice = best != nullptr;
+    if (best) m_choice = best->backend;
+}
+
+std::string TopologyKey(const TopologyMonitor* monitors, size_t count) {
+    std::string key;
+    for (size_t i = 0; i < count; i++) {
+        const TopologyMonitor& m = monitors[i];
+        char part[64];
+        snprintf(part, sizeof(part), "%s%ux%u@%u(%d,%d)", i ? ";" : "", m.width, m.height, m.hz, m.x, m.y);
+        key += part;
+    }
+    return key;
+}
+
+BackendChoiceCache::BackendChoiceCache(size_t capacity) : m_capacity(std::max<size_t>(capacity, 1)) {}
+
+bool BackendChoiceCache::Find(const std::string& topology, BackendChoice& out) const {
+    for (const Entry& e : m_entries) {
+        if (e.topology == topology) {
+            out = e.choice;
+            return true;
+        }
+    }
+    return false;
+}
+
+void BackendChoiceCache::Store(const std::string& topology, const BackendChoice& choice) {
+    Forget(topology);
+    m_entries.insert(m_entries.begin(), Entry{topology, choice});
+    if (m_entries.size() > m_capacity) m_entries.resize(m_capacity);
+}
+
+bool BackendChoiceCache::Forget(const std::string& topology) {
+    const auto it = std::find_if(m_entries.begin(), m_entries.end(), [&](const Entry& e) { return e.topology == topology; });
+    if (it == m_entries.end()) return false;
+    m_entries.erase(it);
+    return true;
+}
+
+bool BackendChoiceCache::Write(FILE* f) const {
+    if (fprintf(f, "%s\n", kCacheHeader) < 0) return false;
+    for (const Entry& e : m_entries) {
+        if (fprintf(f, "%s %s %.1f\n", e.topology.c_str(), CaptureBackendName(e.choice.backend), static_cast<double>(e.choice.costUs)) < 0) return false;
+    }
+    return true;
+}
+
+bool BackendChoiceCache::Read(FILE* f) {
+    m_entries.clear();
+    char line[512];
+    if (!fgets(line, sizeof(line), f) || strncmp(line, kCacheHeader, sizeof(kCacheHeader) - 1) != 0) return false;
+    while (fgets(line, sizeof(line), f) && m_entries.size() < m_capacity) {
+        char topology[384];
+        char backend[32];
+        float costUs = 0.0f;
+        Entry e;
+        if (sscanf(line, "%383s %31s %f", topology, backend, &costUs) != 3 || !ParseCaptureBackend(backend, e.choice.backend)) continue;
+        e.topology = topology;
+        e.choice.costUs = costUs;
+        BackendChoice seen;
+        if (!Find(e.topology, seen)) m_entries.push_back(e);
+    }
+    return true;
+}
+
+} // namespace rj
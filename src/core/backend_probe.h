@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "core/clock.h"
+#include "core/latency_histogram.h"
+
+namespace rj {
+
+enum class CaptureBackend : uint8_t {
+    Wgc,                // Windows.Graphics.Capture of the wide display
+    DdSingleWide,       // Desktop Duplication of the wide display
+    DdTripleComposite,  // Desktop Duplication of each output monitor, composited
+};
+
+const char* CaptureBackendName(CaptureBackend b);  // "wgc", "dd_single_wide", "dd_triple_composite"
+bool ParseCaptureBackend(const char* name, CaptureBackend& out);
+
+struct BackendProbeConfig {
+    // After a backend starts: first frames, texture creation, DWM catching up. Nothing
+    // measured in it counts.
+    int64_t warmupNs = 300 * kNsPerMs;
+    // Measured time per backend after the warm-up.
+    int64_t windowNs = 1500 * kNsPerMs;
+    // Fewer frames than this in the window (a static desktop, a stalled backend): no score.
+    uint32_t minFrames = 30;
+    // Arrival rate below this fraction of the best candidate's: rejected as dropping frames.
+    double minRateFraction = 0.8;
+};
+
+// One candidate's measurement window and what it scored. Lower costUs is better:
+// half the mean arrival interval (how stale the newest frame is on average), plus the
+// p95 copy-to-present latency and the mean copy (together, arrival to present), plus the
+// mean copy again for the GPU time it takes from the output draws.
+struct BackendScore {
+    CaptureBackend backend{};
+    uint64_t frames{};
+    double arrivalHz{};
+    uint64_t copies{};
+    double copyAvgUs{};
+    double latencyP50Us{};
+    double latencyP95Us{};
+    double costUs{};
+    const char* rejected{};  // why it can't be chosen, nullptr when it can
+};
+
+// Render-thread state machine that runs each candidate backend for a short window, measures
+// frame arrival rate, copy cost and copy-to-present latency, and picks the cheapest.
+//
+// After Begin() and whenever Advance() returns true the caller switches capture: to
+// Current() while Active(), otherwise to Choice() when HasChoice(), else to its default.
+// A backend that fails to start or turns out unusable is Reject()ed; the next Advance()
+// moves on. Measurements made during a backend's warm-up are ignored.
+class BackendProbe {
+public:
+    explicit BackendProbe(const BackendProbeConfig& cfg = BackendProbeConfig{});
+
+    void Begin(const std::vector<CaptureBackend>& candidates, int64_t nowNs);
+    void Cancel();
+
+    // Call once a frame. True when the backend to run changed.
+    bool Advance(int64_t nowNs);
+    void Reject(const char* reason);
+
+    void OnFrame(int64_t nowNs);                                   // a new frame arrived
+    void OnCopies(int64_t nowNs, uint64_t copies, int64_t totalNs);  // copies made since the last call
+    void OnPresent(int64_t nowNs, int64_t copyToPresentNs);        // a new frame was first presented
+
+    bool Active() const { return m_active; }
+    CaptureBackend Current() const { return m_candidates[m_index]; }
+    // Done and at least one candidate could be chosen.
+    bool HasChoice() const { return m_haveChoice; }
+    CaptureBackend Choice() const { return m_choice; }
+    const BackendScore* ChosenScore() const;
+    // Every candidate probed so far, in probe order.
+    const std::vector<BackendScore>& Scores() const { return m_scores; }
+    const BackendProbeConfig& Config() const { return m_cfg; }
+
+private:
+    bool Measuring(int64_t nowNs) const { return m_active && nowNs >= m_windowStartNs + m_cfg.warmupNs; }
+    void FinishWindow(int64_t nowNs);
+    void Choose();
+
+    BackendProbeConfig m_cfg;
+    std::vector<CaptureBackend> m_candidates;
+    size_t m_index{};
+    bool m_active{};
+    int64_t m_windowStartNs{};
+    const char* m_rejected{};
+    uint64_t m_frames{};
+    uint64_t m_copies{};
+    int64_t m_copyNs{};
+    LatencyHistogram m_latency;
+    std::vector<BackendScore> m_scores;
+    bool m_haveChoice{};
+    CaptureBackend m_choice{};
+};
+
+struct TopologyMonitor {
+    int32_t x{};
+    int32_t y{};
+    uint32_t width{};
+    uint32_t height{};
+    uint32_t hz{};
+};
+
+// "2560x1440@165(0,0);7680x1440@120(2560,-1440)": monitors in the given order, no spaces.
+std::string TopologyKey(const TopologyMonitor* monitors, size_t count);
+
+struct BackendChoice {
+    CaptureBackend backend{};
+    float costUs{};
+};
+
+// The probe's choice per display topology, most recently stored first, so a known setup
+// starts on its backend without probing again. Persisted as text: a header line, then
+// "<topology> <backend> <cost us>" per entry.
+class BackendChoiceCache {
+public:
+    explicit BackendChoiceCache(size_t capacity = 16);
+
+    bool Find(const std::string& topology, BackendChoice& out) const;
+    void Store(const std::string& topology, const BackendChoice& choice);
+    bool Forget(const std::string& topology);
+    void Clear() { m_entries.clear(); }
+    size_t Size() const { return m_entries.size(); }
+
+    bool Write(FILE* f) const;
+    // Replaces the contents with the file's entries. Unreadable entries are skipped; false
+    // (and empty) when the header is missing.
+    bool Read(FILE* f);
+
+private:
+    struct Entry {
+        std::string topology;
+        BackendChoice choice;
+    };
+
+    size_t m_capacity;
+    std::vector<Entry> m_entries;
+};
+
+} // namespace rj
@@ -0,0 +1,268 @@
+#include "core/capture_recorder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace rj {
+
+namespace {
+
+constexpr size_t kMaxCarryRects = 4096;
+
+} // namespace
+
+CaptureRecorder::CaptureRecorder(const RecorderConfig& cfg) : m_cfg(cfg), m_encoder(cfg.codec) {
+    m_cfg.queueFrames = std::max(m_cfg.queueFrames, 1u);
+}
+
+CaptureRecorder::~CaptureRecorder() {
+    Stop();
+}
+
+bool CaptureRecorder::Start(const char* basePath) {
+    Stop();
+    m_base = basePath;
+    m_slots.resize(m_cfg.queueFrames);
+    m_free.clear();
+    for (uint32_t i = 0; i < m_cfg.queueFrames; i++) m_free.push_back(i);
+    m_pending.clear();
+    m_stats = RecorderStats{};
+    m_segmentIndex = 0;
+    m_needFull = true;
+    m_carry.clear();
+    if (!OpenSegment()) return false;
+    m_stop = false;
+    m_writer = std::thread([this] { WriterMain(); });
+    return true;
+}
+
+void CaptureRecorder::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_writer.joinable()) return;
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_freeCv.notify_all();
+    m_writer.join();
+}
+
+RecorderStats CaptureRecorder::Stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+bool CaptureRecorder::Record(const FrameDesc& f, int64_t acquireTimeNs, uint8_t flags) {
+    uint32_t index = UINT32_MAX;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_cfg.dropWhenFull) m_freeCv.wait(lock, [&] { return m_stop || m_stats.failed || !m_free.empty(); });
+        if (m_stop) return false;
+        if (m_stats.failed || m_free.empty()) {
+            m_stats.dropped++;
+        } else {
+            index = m_free.back();
+            m_free.pop_back();
+        }
+    }
+    if (index == UINT32_MAX) {
+        CarryDamage(f);
+        return false;
+    }
+
+    Slot& s = m_slots[index];
+    RecordHeader& h = s.header;
+    h = RecordHeader{};
+    h.sequence = f.sequence;
+    h.captureTimeNs = f.captureTimeNs;
+    h.acquireTimeNs = acquireTimeNs;
+    h.width = f.width;
+    h.height = f.height;
+    h.format = static_cast<uint32_t>(f.format);
+    h.accumulatedFrames = f.accumulatedFrames;
+    h.dirtyRectCount = f.dirtyRects ? f.dirtyRectCount : 0;
+    h.flags = flags;
+    s.dirty.assign(f.dirtyRects, f.dirtyRects + h.dirtyRectCount);
+
+    if (m_cfg.pixels && f.pixels && f.width > 0 && f.height > 0 && BytesPerPixel(f.format) == 4) {
+        const size_t row = static_cast<size_t>(f.width) * 4u;
+        const size_t frameBytes = row * f.height;
+        CarryDamage(f);
+        s.full = m_needFull;
+        s.copied.swap(m_carry);
+        m_carry.clear();
+        size_t bytes = 0;
+        for (size_t i = 0; !s.full && i < s.copied.size(); i++) {
+            const Rect& r = s.copied[i];
+            bytes += static_cast<size_t>(r.Width()) * 4u * static_cast<size_t>(r.Height());
+            s.full = bytes >= frameBytes / 2;
+        }
+
+        if (s.full) {
+            if (s.pixels.size() != frameBytes) s.pixels.resize(frameBytes);
+            if (f.strideBytes == row) {
+                std::memcpy(s.pixels.data(), f.pixels, frameBytes);
+            } else {
+                for (uint32_t y = 0; y < f.height; y++) std::memcpy(s.pixels.data() + y * row, f.pixels + static_cast<size_t>(y) * f.strideBytes, row);
+            }
+        } else {
+            if (s.pixels.size() < bytes) s.pixels.resize(bytes);
+            uint8_t* dst = s.pixels.data();
+            for (const Rect& r : s.copied) {
+                const size_t w = static_cast<size_t>(r.Width()) * 4u;
+                for (int32_t y = r.top; y < r.bottom; y++, dst += w) std::memcpy(dst, f.pixels + static_cast<size_t>(y) * f.strideBytes + r.left * 4u, w);
+            }
+        }
+        h.payload = static_cast<uint8_t>(m_cfg.compress ? RecordPayload::Codec : RecordPayload::Raw);
+        h.strideBytes = static_cast<uint32_t>(row);
+        m_needFull = false;
+    } else {
+        m_needFull = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(index);
+    }
+    m_cv.notify_one();
+    return true;
+}
+
+// Adds what `f` changed to the damage the next queued frame must carry, so dropped frames
+// do not force it to copy everything.
+void CaptureRecorder::CarryDamage(const FrameDesc& f) {
+    const uint32_t count = f.dirtyRects ? f.dirtyRectCount : 0;
+    if (count == 0 || f.width != m_lastW || f.height != m_lastH || m_carry.size() + count > kMaxCarryRects) m_needFull = true;
+    m_lastW = f.width;
+    m_lastH = f.height;
+    if (m_needFull) {
+        m_carry.clear();
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        const Rect& d = f.dirtyRects[i];
+        const Rect r{std::max(d.left, 0),
+                     std::max(d.top, 0),
+                     std::min(d.right, static_cast<int32_t>(f.width)),
+                     std::min(d.bottom, static_cast<int32_t>(f.height))};
+        if (!r.Empty()) m_carry.push_back(r);
+    }
+}
+
+void CaptureRecorder::WriterMain() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_cv.wait(lock, [&] { return m_stop || !m_pending.empty(); });
+        if (m_pending.empty()) break;
+        const uint32_t index = m_pending.front();
+        m_pending.pop_front();
+        lock.unlock();
+        Write(m_slots[index]);
+        lock.lock();
+        m_free.push_back(index);
+        m_freeCv.notify_one();
+    }
+    lock.unlock();
+    CloseSegment();
+}
+
+bool CaptureRecorder::OpenSegment() {
+    if (!m_segment.Create(RecordingSegmentPath(m_base, m_segmentIndex).c_str(), static_cast<size_t>(m_cfg.segmentBytes))) return false;
+    if (m_segment.Size() < sizeof(RecordSegmentHeader)) {
+        m_segment.Close();
+        return false;
+    }
+    RecordSegmentHeader h{};
+    std::memcpy(h.magic, kRecordSegmentMagic, sizeof(h.magic));
+    h.version = kRecordingVersion;
+    h.segment = m_segmentIndex;
+    std::memcpy(m_segment.Data(), &h, sizeof(h));
+    m_used = sizeof(h);
+    m_index.clear();
+    // Every segment decodes on its own.
+    m_encoder.ForceKeyframe();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.segments++;
+    return true;
+}
+
+void CaptureRecorder::CloseSegment() {
+    if (!m_segment.Valid()) return;
+    const size_t indexBytes = m_index.size() * sizeof(RecordIndexEntry);
+    std::memcpy(m_segment.Data() + m_used, m_index.data(), indexBytes);
+    RecordSegmentHeader h{};
+    std::memcpy(&h, m_segment.Data(), sizeof(h));
+    h.indexOffset = m_used;
+    h.frameCount = static_cast<uint32_t>(m_index.size());
+    std::memcpy(m_segment.Data(), &h, sizeof(h));
+    m_segment.Finish(static_cast<size_t>(m_used) + indexBytes);
+    m_segmentIndex++;
+}
+
+// Brings m_frame up to date with the slot's pixels.
+void CaptureRecorder::ApplyPixels(Slot& s) {
+    if (s.full) {
+        m_frame.swap(s.pixels);
+        return;
+    }
+    const size_t row = s.header.strideBytes;
+    const uint8_t* src = s.pixels.data();
+    for (const Rect& r : s.copied) {
+        const size_t w = static_cast<size_t>(r.Width()) * 4u;
+        for (int32_t y = r.top; y < r.bottom; y++, src += w) std::memcpy(m_frame.data() + static_cast<size_t>(y) * row + r.left * 4u, src, w);
+    }
+}
+
+void CaptureRecorder::Write(Slot& s) {
+    RecordHeader h = s.header;
+    const bool coded = h.payload == static_cast<uint8_t>(RecordPayload::Codec);
+    const size_t pixelBytes = h.payload == static_cast<uint8_t>(RecordPayload::None) ? 0 : static_cast<size_t>(h.strideBytes) * h.height;
+    if (pixelBytes) ApplyPixels(s);
+    const uint8_t* payload = m_frame.data();
+    size_t payloadBytes = pixelBytes;
+    auto encode = [&] {
+        // What changed since the frame coded before is known unless the slot is whole.
+        const Rect* damage = s.full ? nullptr : s.copied.data();
+        if (!m_encoder.Encode(m_frame.data(), h.strideBytes, h.width, h.height, m_coded, nullptr, damage, static_cast<uint32_t>(s.copied.size()))) return false;
+        payload = m_coded.data();
+        payloadBytes = m_coded.size();
+        return true;
+    };
+
+    bool ok = !coded || encode();
+    const uint64_t rectBytes = static_cast<uint64_t>(h.dirtyRectCount) * sizeof(Rect);
+    auto recordBytes = [&] { return (sizeof(RecordHeader) + rectBytes + payloadBytes + 7) & ~uint64_t{7}; };
+    auto fits = [&] {
+        return m_segment.Valid() && recordBytes() <= UINT32_MAX &&
+               m_used + recordBytes() + (m_index.size() + 1) * sizeof(RecordIndexEntry) <= m_segment.Size();
+    };
+    if (ok && !fits() && !m_index.empty()) {
+        CloseSegment();
+        ok = OpenSegment() && (!coded || encode());
+    }
+    if (!ok || !fits()) {
+        // A coded frame that is not stored breaks the chain of deltas: stop recording.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.failed = true;
+        m_stats.dropped++;
+        return;
+    }
+
+    // Body first, header last: a record is only visible once it is complete.
+    uint8_t* dst = m_segment.Data() + m_used;
+    if (rectBytes) std::memcpy(dst + sizeof(RecordHeader), s.dirty.data(), rectBytes);
+    if (payloadBytes) std::memcpy(dst + sizeof(RecordHeader) + rectBytes, payload, payloadBytes);
+    h.magic = kRecordMagic;
+    h.bytes = static_cast<uint32_t>(recordBytes());
+    h.payloadBytes = static_cast<uint32_t>(payloadBytes);
+    std::memcpy(dst, &h, sizeof(h));
+    m_index.push_back(RecordIndexEntry{m_used, h.acquireTimeNs});
+    m_used += h.bytes;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.frames++;
+    m_stats.bytes += h.bytes;
+    m_stats.rawBytes += pixelBytes;
+}
+
+} // namespace rj
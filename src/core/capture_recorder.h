@@ -0,0 +1,136 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/capture_source.h"
+#include "core/clock.h"
+#include "core/frame_codec.h"
+#include "core/mapped_file.h"
+#include "core/recording.h"
+
+namespace rj {
+
+struct RecorderConfig {
+    // Size each segment file is created at; a frame that does not fit starts the next one.
+    uint64_t segmentBytes = 256ull << 20;
+    // Frames waiting for the writer thread. While all are in use, Record() drops frames
+    // rather than stall the capture thread, or with dropWhenFull off waits for one.
+    uint32_t queueFrames = 4;
+    bool dropWhenFull = true;
+    // Store CPU pixels of 4-byte formats, delta-coded with FrameEncoder (raw with compress
+    // off). Off records timing and damage only.
+    bool pixels = true;
+    bool compress = true;
+    CodecConfig codec{};
+};
+
+struct RecorderStats {
+    uint64_t frames{};    // written
+    uint64_t dropped{};   // queue full, or the writer failed
+    uint64_t bytes{};     // records written, headers included
+    uint64_t rawBytes{};  // pixels of the frames written, before coding
+    uint32_t segments{};
+    bool failed{};  // a segment could not be created or a frame did not fit one
+};
+
+// Records what a capture source handed out (frames, timestamps, DD frame info) into
+// memory-mapped segment files (see recording.h). Record() only copies the frame into a
+// queue slot, just its dirty rects when it has them; a writer thread codes it and stores
+// it through the mapping.
+class CaptureRecorder {
+public:
+    explicit CaptureRecorder(const RecorderConfig& cfg = RecorderConfig{});
+    ~CaptureRecorder();
+
+    CaptureRecorder(const CaptureRecorder&) = delete;
+    CaptureRecorder& operator=(const CaptureRecorder&) = delete;
+
+    // Starts a session at <basePath>_0000.rjr. Fails if that segment can't be created.
+    bool Start(const char* basePath);
+    // Queues one frame; everything it points to is copied before returning. One thread at
+    // a time. Returns false if the frame was dropped.
+    bool Record(const FrameDesc& f, int64_t acquireTimeNs, uint8_t flags = 0);
+    // Writes what is queued, indexes and closes the last segment.
+    void Stop();
+
+    bool Recording() const { return m_writer.joinable(); }
+    const std::string& BasePath() const { return m_base; }
+    RecorderStats Stats() const;
+
+private:
+    // A frame with dirty rects only carries the pixels inside them (`copied`, rows packed
+    // rect by rect); the writer patches them into m_frame. Otherwise `full` and pixels holds
+    // the whole frame, rows packed to width * 4.
+    struct Slot {
+        RecordHeader header{};
+        std::vector<Rect> dirty;
+        std::vector<Rect> copied;
+        std::vector<uint8_t> pixels;
+        bool full{};
+    };
+
+    void WriterMain();
+    void CarryDamage(const FrameDesc& f);
+    void ApplyPixels(Slot& slot);
+    void Write(Slot& slot);
+    bool OpenSegment();
+    void CloseSegment();
+
+    RecorderConfig m_cfg;
+    std::string m_base;
+    std::vector<Slot> m_slots;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_freeCv;
+    std::vector<uint32_t> m_free;
+    std::deque<uint32_t> m_pending;
+    bool m_stop{true};
+    RecorderStats m_stats;
+    std::thread m_writer;
+
+    // Recording thread: damage since the last frame queued with pixels, or m_needFull when
+    // the writer's m_frame can't be patched up to the next one.
+    bool m_needFull{true};
+    std::vector<Rect> m_carry;
+    uint32_t m_lastW{};
+    uint32_t m_lastH{};
+
+    // Writer thread.
+    std::vector<uint8_t> m_frame;
+    FrameEncoder m_encoder;
+    std::vector<uint8_t> m_coded;
+    MappedFile m_segment;
+    uint32_t m_segmentIndex{};
+    uint64_t m_used{};
+    std::vector<RecordIndexEntry> m_index;
+};
+
+// Passes another source through and records every frame it hands out, stamped with the
+// clock when Acquire() returns.
+class RecordingSource final : public ICaptureSource {
+public:
+    RecordingSource(Clock& clock, ICaptureSource& inner, CaptureRecorder& recorder)
+        : m_clock(clock), m_inner(inner), m_recorder(recorder) {}
+
+    const char* Name() const override { return m_inner.Name(); }
+    AcquireResult Acquire(uint32_t timeoutMs, FrameDesc& out) override {
+        const AcquireResult r = m_inner.Acquire(timeoutMs, out);
+        if (r == AcquireResult::NewFrame) m_recorder.Record(out, m_clock.NowNs());
+        return r;
+    }
+    void Release() override { m_inner.Release(); }
+
+private:
+    Clock& m_clock;
+    ICaptureSource& m_inner;
+    CaptureRecorder& m_recorder;
+};
+
+} // namespace rj
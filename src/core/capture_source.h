@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/frame.h"
+
+namespace rj {
+
+enum class AcquireResult {
+    NewFrame,
+    Timeout,     // DXGI_ERROR_WAIT_TIMEOUT
+    AccessLost,  // DXGI_ERROR_ACCESS_LOST: the caller must recreate the source
+    Error,       // any other failure; handled like AccessLost
+};
+
+// A capture backend (WGC, Desktop Duplication, IDD, synthetic, replay).
+//
+// Mirrors the Desktop Duplication contract: Acquire() hands out at most one frame at a
+// time and the frame stays valid until Release(). A timeout of 0 polls. Consumers treat
+// Error exactly like AccessLost: acquiring stops (FramePipeline::RunFrame() returns false,
+// the capture thread and tile workers exit) and the caller recreates the source.
+class ICaptureSource {
+public:
+    virtual ~ICaptureSource() = default;
+
+    virtual const char* Name() const = 0;
+    virtual AcquireResult Acquire(uint32_t timeoutMs, FrameDesc& out) = 0;
+    virtual void Release() = 0;
+};
+
+} // namespace rj
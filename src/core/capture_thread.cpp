@@ -0,0 +1,97 @@
+#include "core/capture_thread.h"
+
+namespace rj {
+
+namespace {
+
+// How long the capture thread backs off while queueDepth frames wait for the render thread.
+constexpr int64_t kQueueFullBackoffNs = 500 * kNsPerUs;
+
+} // namespace
+
+CaptureThread::CaptureThread(Clock& clock, const CaptureThreadConfig& cfg) : m_clock(clock), m_cfg(cfg) {
+    if (m_cfg.queueDepth == 0) m_cfg.queueDepth = 1;
+}
+
+CaptureThread::~CaptureThread() {
+    Stop();
+}
+
+void CaptureThread::Start(CaptureFn fn) {
+    Stop();
+    m_fn = std::move(fn);
+    m_free.Reset(SlotCount());
+    m_ready.Reset(m_cfg.queueDepth);
+    for (uint32_t s = 0; s < SlotCount(); s++) m_free.TryPush(s);
+    m_holding = false;
+    m_failed.store(false, std::memory_order_relaxed);
+    m_failure = AcquireResult::NewFrame;
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread([this] { Run(); });
+}
+
+void CaptureThread::Stop() {
+    m_running.store(false, std::memory_order_release);
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void CaptureThread::Run() {
+    uint32_t slot = 0;
+    bool haveSlot = false;
+    while (m_running.load(std::memory_order_acquire)) {
+        // Only the render thread shrinks the queue, so the count is never low here.
+        if (m_ready.SizeApprox() >= m_cfg.queueDepth) {
+            m_stalls.fetch_add(1, std::memory_order_relaxed);
+            m_clock.SleepForNs(kQueueFullBackoffNs);
+            continue;
+        }
+        if (!haveSlot) {
+            if (!m_free.TryPop(slot)) {
+                m_stalls.fetch_add(1, std::memory_order_relaxed);
+                m_clock.SleepForNs(kQueueFullBackoffNs);
+                continue;
+            }
+            haveSlot = true;
+        }
+
+        CapturedFrame frame{};
+        frame.slot = slot;
+        const AcquireResult r = m_fn(m_cfg.acquireTimeoutMs, slot, frame);
+        if (r == AcquireResult::AccessLost || r == AcquireResult::Error) {
+            m_failure = r;
+            m_failed.store(true, std::memory_order_release);
+            return;
+        }
+        if (r != AcquireResult::NewFrame) continue;
+
+        frame.slot = slot;
+        frame.readyNs = m_clock.NowNs();
+        // Cannot fail: the queue had room before the acquire and only this thread pushes.
+        m_ready.TryPush(frame);
+        haveSlot = false;
+        m_captured.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool CaptureThread::TakeLatest(CapturedFrame& out) {
+    CapturedFrame latest{};
+    bool got = false;
+    CapturedFrame f{};
+    while (m_ready.TryPop(f)) {
+        if (got) {
+            m_free.TryPush(latest.slot);
+            m_superseded++;
+        }
+        latest = f;
+        got = true;
+    }
+    if (!got) return false;
+
+    if (m_holding) m_free.TryPush(m_heldSlot);
+    m_heldSlot = latest.slot;
+    m_holding = true;
+    out = latest;
+    return true;
+}
+
+} // namespace rj
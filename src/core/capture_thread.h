@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "core/capture_source.h"
+#include "core/clock.h"
+#include "core/spsc_queue.h"
+
+namespace rj {
+
+struct CaptureThreadConfig {
+    // Frames that may wait for the render thread. Once that many are ready the capture thread
+    // stops acquiring (the source accumulates, as DD does) rather than overwrite them.
+    uint32_t queueDepth = 2;
+
+    // Timeout for each blocking acquire. Also bounds how long Stop() takes.
+    uint32_t acquireTimeoutMs = 16;
+};
+
+// A frame copied into one of the capture ring's slots.
+struct CapturedFrame {
+    uint32_t slot{};
+    FrameDesc desc{};   // pixels/handle point at the slot's storage
+    int64_t readyNs{};  // when the copy into the slot finished
+};
+
+// Runs acquisition on its own thread so frame N+1 is acquired and copied while frame N is
+// presented. The caller owns SlotCount() frame buffers (CPU buffers or textures); the
+// capture callback fills one slot per frame and the render thread takes the newest one.
+//
+// Slots circulate through two SPSC queues (free: render -> capture, ready: capture ->
+// render), so a slot is only ever written by the capture thread while nobody reads it.
+class CaptureThread {
+public:
+    // Runs on the capture thread. Waits up to `timeoutMs` for a frame, copies it into
+    // `slot`, fills `out.desc` and returns NewFrame. Timeout means nothing arrived;
+    // AccessLost/Error stop the thread.
+    using CaptureFn = std::function<AcquireResult(uint32_t timeoutMs, uint32_t slot, CapturedFrame& out)>;
+
+    // `clock` must be thread-safe (SteadyClock).
+    explicit CaptureThread(Clock& clock, const CaptureThreadConfig& cfg = CaptureThreadConfig{});
+    ~CaptureThread();
+
+    CaptureThread(const CaptureThread&) = delete;
+    CaptureThread& operator=(const CaptureThread&) = delete;
+
+    // Queued frames + the one being presented + the one being written.
+    uint32_t SlotCount() const { return m_cfg.queueDepth + 2; }
+
+    void Start(CaptureFn fn);
+    void Stop();
+    bool Running() const { return m_thread.joinable(); }
+
+    // Render thread. Returns the newest queued frame and recycles the previously taken one
+    // plus any that were superseded. Returns false when nothing new was queued; the frame
+    // from the last successful call stays valid.
+    bool TakeLatest(CapturedFrame& out);
+
+    // Set when the callback reported AccessLost/Error; the thread has exited.
+    bool Failed() const { return m_failed.load(std::memory_order_acquire); }
+    AcquireResult FailureReason() const { return m_failure; }
+
+    uint64_t FramesCaptured() const { return m_captured.load(std::memory_order_relaxed); }
+    uint64_t QueueFullStalls() const { return m_stalls.load(std::memory_order_relaxed); }
+    uint64_t FramesSuperseded() const { return m_superseded; }
+
+private:
+    void Run();
+
+    Clock& m_clock;
+    CaptureThreadConfig m_cfg;
+    CaptureFn m_fn;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_failed{false};
+    AcquireResult m_failure{AcquireResult::NewFrame};
+
+    SpscQueue<uint32_t> m_free;
+    SpscQueue<CapturedFrame> m_ready;
+
+    // Render thread only.
+    bool m_holding{};
+    uint32_t m_heldSlot{};
+    uint64_t m_superseded{};
+
+    std::atomic<uint64_t> m_captured{0};
+    std::atomic<uint64_t> m_stalls{0};
+};
+
+} // namespace rj
@@ -0,0 +1,39 @@
+#include "core/clock.h"
+
+#include <chrono>
+#include <thread>
+
+namespace rj {
+
+int64_t SteadyClock::NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SteadyClock::SleepUntilNs(int64_t deadlineNs) {
+    const std::chrono::steady_clock::time_point deadline{std::chrono::nanoseconds(deadlineNs)};
+    std::this_thread::sleep_until(deadline);
+}
+
+void ManualClock::SleepUntilNs(int64_t deadlineNs) {
+    int64_t cur = m_nowNs.load(std::memory_order_relaxed);
+    while (cur < deadlineNs && !m_nowNs.compare_exchange_weak(cur, deadlineNs, std::memory_order_relaxed)) {
+    }
+}
+
+VsyncPacer::VsyncPacer(Clock& clock, uint32_t hz, int64_t phaseNs)
+    : m_clock(clock), m_periodNs(kNsPerSec / static_cast<int64_t>(hz > 0 ? hz : 60)), m_phaseNs(phaseNs) {}
+
+int64_t VsyncPacer::NextVblankAfterNs(int64_t tNs) const {
+    const int64_t rel = tNs - m_phaseNs;
+    int64_t n = rel / m_periodNs;
+    if (rel < 0 && (rel % m_periodNs) != 0) n--;
+    return m_phaseNs + (n + 1) * m_periodNs;
+}
+
+int64_t VsyncPacer::WaitForVblank() {
+    const int64_t vblank = NextVblankAfterNs(m_clock.NowNs());
+    m_clock.SleepUntilNs(vblank);
+    return vblank;
+}
+
+} // namespace rj
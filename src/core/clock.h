@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace rj {
+
+constexpr int64_t kNsPerUs = 1000;
+constexpr int64_t kNsPerMs = 1000000;
+constexpr int64_t kNsPerSec = 1000000000;
+
+inline double NsToMs(int64_t ns) { return static_cast<double>(ns) / 1e6; }
+inline double NsToUs(int64_t ns) { return static_cast<double>(ns) / 1e3; }
+
+// Monotonic time source. Everything in rj_core takes time from a Clock so the same code
+// can run against the real steady clock or a simulated one on machines with no display.
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual int64_t NowNs() = 0;
+    virtual void SleepUntilNs(int64_t deadlineNs) = 0;
+
+    void SleepForNs(int64_t dtNs) { SleepUntilNs(NowNs() + dtNs); }
+};
+
+class SteadyClock final : public Clock {
+public:
+    int64_t NowNs() override;
+    void SleepUntilNs(int64_t deadlineNs) override;
+};
+
+// Simulated clock: sleeping jumps straight to the deadline. Meant for a single simulated
+// thread; the counter is atomic only so other threads can read it for reporting.
+class ManualClock final : public Clock {
+public:
+    explicit ManualClock(int64_t startNs = 0) : m_nowNs(startNs) {}
+
+    int64_t NowNs() override { return m_nowNs.load(std::memory_order_relaxed); }
+    void SleepUntilNs(int64_t deadlineNs) override;
+    void AdvanceNs(int64_t dtNs) { m_nowNs.fetch_add(dtNs, std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_nowNs;
+};
+
+// Models the swapchain frame-latency waitable: the render loop blocks until the next
+// vblank of a display refreshing at `hz`.
+class VsyncPacer {
+public:
+    VsyncPacer(Clock& clock, uint32_t hz, int64_t phaseNs = 0);
+
+    // Blocks until the next vblank and returns its timestamp.
+    int64_t WaitForVblank();
+
+    int64_t NextVblankAfterNs(int64_t tNs) const;
+    int64_t PeriodNs() const { return m_periodNs; }
+
+private:
+    Clock& m_clock;
+    int64_t m_periodNs;
+    int64_t m_phaseNs;
+};
+
+} // namespace rj
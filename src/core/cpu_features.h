@@ -0,0 +1,22 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define RJ_X86 1
+#else
+#define RJ_X86 0
+#endif
+
+namespace rj {
+
+enum class SimdLevel {
+    Scalar = 0,
+    Sse41 = 1,
+    Avx2 = 2,
+};
+
+// Best SIMD level this CPU supports (always Scalar on non-x86 builds).
+SimdLevel DetectSimdLevel();
+
+const char* SimdLevelName(SimdLevel level);
+
+} // namespace rj
@@ -0,0 +1,108 @@
+#include "core/damage_ring.h"
+
+namespace rj {
+
+DamageRing::DamageRing(const CoalescerConfig& cfg) : m_catchUp(cfg), m_source(cfg) {}
+
+void DamageRing::Reset(uint32_t slots, uint32_t width, uint32_t height) {
+    m_width = width;
+    m_height = height;
+    m_catchUp.Resize(width, height);
+    m_source.Resize(width, height);
+    m_valid.assign(slots, false);
+    m_pending.resize(slots);
+    Invalidate();
+}
+
+void DamageRing::Invalidate() {
+    for (size_t s = 0; s < m_valid.size(); s++) {
+        m_valid[s] = false;
+        m_pending[s].clear();
+    }
+    m_newest = -1;
+}
+
+void DamageRing::Commit(uint32_t slot, const Rect* damage, uint32_t damageCount, bool damageKnown) {
+    for (uint32_t s = 0; s < m_valid.size(); s++) {
+        if (s == slot || !m_valid[s]) continue;
+        std::vector<Rect>& pending = m_pending[s];
+        if (!damageKnown || pending.size() + damageCount > kMaxPendingRects) {
+            m_valid[s] = false;
+            pending.clear();
+            continue;
+        }
+        pending.insert(pending.end(), damage, damage + damageCount);
+    }
+    m_pending[slot].clear();
+    m_valid[slot] = true;
+    m_newest = static_cast<int32_t>(slot);
+}
+
+const SlotUpdatePlan& DamageRing::BuildFull(uint32_t slot) {
+    m_plan = SlotUpdatePlan{};
+    m_plan.fullCopy = true;
+    m_plan.copiedPixels = static_cast<uint64_t>(m_width) * m_height;
+    Commit(slot, nullptr, 0, false);
+    return m_plan;
+}
+
+const SlotUpdatePlan& DamageRing::Build(uint32_t slot, const MoveRect* moves, uint32_t moveCount, const Rect* dirty, uint32_t dirtyCount) {
+    if (slot >= m_valid.size() || !m_valid[slot]) {
+        // A fresh slot: whatever the metadata says, only a full copy defines it. The other
+        // slots still only miss this frame's damage.
+        m_damage.assign(dirty, dirty + dirtyCount);
+        for (uint32_t i = 0; i < moveCount; i++) m_damage.push_back(moves[i].dst);
+        m_plan = SlotUpdatePlan{};
+        m_plan.fullCopy = true;
+        m_plan.copiedPixels = static_cast<uint64_t>(m_width) * m_height;
+        if (slot < m_valid.size()) Commit(slot, m_damage.data(), static_cast<uint32_t>(m_damage.size()), true);
+        return m_plan;
+    }
+
+    m_damage.assign(dirty, dirty + dirtyCount);
+    for (uint32_t i = 0; i < moveCount; i++) m_damage.push_back(moves[i].dst);
+
+    m_plan = SlotUpdatePlan{};
+    const bool isNewest = static_cast<int32_t>(slot) == m_newest;
+    if (!isNewest && !m_pending[slot].empty()) {
+        m_plan.catchUpSlot = m_newest;
+        m_plan.catchUp = &m_catchUp.Build(nullptr, 0, m_pending[slot].data(), static_cast<uint32_t>(m_pending[slot].size()));
+    }
+    if (isNewest) {
+        m_plan.fromSource = &m_source.Build(moves, moveCount, dirty, dirtyCount);
+    } else {
+        m_plan.fromSource = &m_source.Build(nullptr, 0, m_damage.data(), static_cast<uint32_t>(m_damage.size()));
+    }
+
+    if ((m_plan.catchUp && m_plan.catchUp->fullCopy) || m_plan.fromSource->fullCopy) {
+        m_plan = SlotUpdatePlan{};
+        m_plan.fullCopy = true;
+        m_plan.copiedPixels = static_cast<uint64_t>(m_width) * m_height;
+    } else {
+        m_plan.copiedPixels = m_plan.fromSource->copiedPixels + (m_plan.catchUp ? m_plan.catchUp->copiedPixels : 0);
+    }
+    Commit(slot, m_damage.data(), static_cast<uint32_t>(m_damage.size()), true);
+    return m_plan;
+}
+
+const SlotUpdatePlan& DamageRing::BuildIdle(uint32_t slot) {
+    m_plan = SlotUpdatePlan{};
+    if (slot >= m_valid.size() || m_newest < 0 || static_cast<int32_t>(slot) == m_newest) return m_plan;
+
+    m_plan.catchUpSlot = m_newest;
+    if (m_valid[slot]) {
+        if (m_pending[slot].empty()) return m_plan;
+        m_plan.catchUp = &m_catchUp.Build(nullptr, 0, m_pending[slot].data(), static_cast<uint32_t>(m_pending[slot].size()));
+    } else {
+        m_plan.catchUp = &m_catchUp.BuildFull();
+    }
+    m_plan.copiedPixels = m_plan.catchUp->copiedPixels;
+
+    // Same content as the newest slot now; no new damage for anyone else.
+    m_pending[slot].clear();
+    m_valid[slot] = true;
+    m_newest = static_cast<int32_t>(slot);
+    return m_plan;
+}
+
+} // namespace rj
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/rect_coalescer.h"
+
+namespace rj {
+
+// How to bring one ring slot up to date. Apply `catchUp` first, copying from slot
+// `catchUpSlot` (the newest one; `catchUp->fullCopy` means the whole surface), then
+// `fromSource` from the acquired frame. `fullCopy` replaces both with a whole-surface copy
+// from the source. Null plans mean nothing to copy.
+struct SlotUpdatePlan {
+    bool fullCopy{};
+    int32_t catchUpSlot{-1};
+    const CompositePlan* catchUp{};
+    const CompositePlan* fromSource{};
+    uint64_t copiedPixels{};
+};
+
+// Dirty-rect updates for a ring of composite buffers (buffer age). A slot written N frames
+// ago misses the damage of the frames that went to other slots since; that damage is
+// re-copied from the newest slot before this frame's own damage comes from the source.
+//
+// Moves are only replayed when the slot being written is the newest one (its content is
+// the previous frame); otherwise their destinations count as damage.
+class DamageRing {
+public:
+    explicit DamageRing(const CoalescerConfig& cfg = CoalescerConfig{});
+
+    // Sets the ring size and surface size. Every slot needs a full copy afterwards.
+    void Reset(uint32_t slots, uint32_t width, uint32_t height);
+    void Invalidate();
+
+    // `slot` receives a new source frame with the given metadata.
+    const SlotUpdatePlan& Build(uint32_t slot, const MoveRect* moves, uint32_t moveCount, const Rect* dirty, uint32_t dirtyCount);
+
+    // `slot` receives a new source frame whose changes are unknown.
+    const SlotUpdatePlan& BuildFull(uint32_t slot);
+
+    // The source had no new frame but `slot` must still show the newest content.
+    const SlotUpdatePlan& BuildIdle(uint32_t slot);
+
+    int32_t NewestSlot() const { return m_newest; }
+
+private:
+    // Damage longer than this per slot is dropped in favour of a full copy.
+    static constexpr size_t kMaxPendingRects = 256;
+
+    void Commit(uint32_t slot, const Rect* damage, uint32_t damageCount, bool damageKnown);
+
+    RectCoalescer m_catchUp;
+    RectCoalescer m_source;
+    uint32_t m_width{};
+    uint32_t m_height{};
+    int32_t m_newest{-1};
+    std::vector<bool> m_valid;
+    std::vector<std::vector<Rect>> m_pending;  // per slot: damage since the slot was written
+    std::vector<Rect> m_damage;
+    SlotUpdatePlan m_plan;
+};
+
+} // namespace rj
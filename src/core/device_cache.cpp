@@ -0,0 +1,61 @@
+#include "core/device_cache.h"
+
+#include <algorithm>
+
+namespace rj {
+
+DeviceCache::DeviceCache(IRenderDeviceFactory& factory, size_t capacity) : m_factory(factory), m_capacity(std::max<size_t>(capacity, 1)) {}
+
+std::shared_ptr<IRenderDevice> DeviceCache::Acquire(uint64_t adapterLuid, bool* reused) {
+    if (reused) *reused = false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = std::find_if(m_entries.begin(), m_entries.end(), [&](const Entry& e) { return e.luid == adapterLuid; });
+    if (it != m_entries.end()) {
+        if (it->device->IsCurrent()) {
+            it->lastUse = ++m_useCounter;
+            m_stats.hits++;
+            if (reused) *reused = true;
+            return it->device;
+        }
+        m_entries.erase(it);
+        m_stats.stale++;
+    }
+
+    // Created under the lock: concurrent assignments for one adapter share a single device.
+    m_stats.misses++;
+    std::shared_ptr<IRenderDevice> device = m_factory.Create(adapterLuid);
+    if (!device) {
+        m_stats.failures++;
+        return nullptr;
+    }
+    if (m_entries.size() >= m_capacity) {
+        auto lru = std::min_element(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+        m_entries.erase(lru);
+        m_stats.evictions++;
+    }
+    m_entries.push_back(Entry{adapterLuid, device, ++m_useCounter});
+    return device;
+}
+
+void DeviceCache::Invalidate(uint64_t adapterLuid) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [&](const Entry& e) { return e.luid == adapterLuid; }), m_entries.end());
+}
+
+void DeviceCache::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+size_t DeviceCache::Size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+DeviceCacheStats DeviceCache::Stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace rj
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rj {
+
+// A render device as the IDD driver's swap-chain processors use it (Direct3DDevice there).
+class IRenderDevice {
+public:
+    virtual ~IRenderDevice() = default;
+
+    // False once the device must not be handed out again: the adapter set changed
+    // (IDXGIFactory::IsCurrent) or the device was removed.
+    virtual bool IsCurrent() = 0;
+};
+
+class IRenderDeviceFactory {
+public:
+    virtual ~IRenderDeviceFactory() = default;
+
+    // A ready device on the adapter, or nullptr (adapter gone, transient failure).
+    virtual std::shared_ptr<IRenderDevice> Create(uint64_t adapterLuid) = 0;
+};
+
+struct DeviceCacheStats {
+    uint64_t hits{};       // served a cached, still current device
+    uint64_t misses{};     // created a device (none cached, or the cached one was stale)
+    uint64_t stale{};      // cached devices dropped because IsCurrent() failed
+    uint64_t failures{};   // factory returned nullptr
+    uint64_t evictions{};  // dropped to stay within capacity
+};
+
+// One warm device per render adapter LUID, so a swap-chain reassignment (mode change,
+// fullscreen switch, driver recovery) reuses it instead of creating a DXGI factory,
+// enumerating the adapter and creating a D3D device again. A cached device is checked with
+// IsCurrent() before it is handed out; failed creations are not cached. Callers must not use
+// one device from two threads at once (the driver hands it to one processor at a time).
+class DeviceCache {
+public:
+    explicit DeviceCache(IRenderDeviceFactory& factory, size_t capacity = 4);
+
+    // Cached device for the adapter, or a new one. `reused` tells which.
+    std::shared_ptr<IRenderDevice> Acquire(uint64_t adapterLuid, bool* reused = nullptr);
+
+    // Drops the adapter's device, e.g. after the swap-chain couldn't be bound to it.
+    void Invalidate(uint64_t adapterLuid);
+    void Clear();
+
+    size_t Size() const;
+    DeviceCacheStats Stats() const;
+
+private:
+    struct Entry {
+        uint64_t luid{};
+        std::shared_ptr<IRenderDevice> device;
+        uint64_t lastUse{};
+    };
+
+    IRenderDeviceFactory& m_factory;
+    size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+    uint64_t m_useCounter{};
+    DeviceCacheStats m_stats{};
+};
+
+} // namespace rj
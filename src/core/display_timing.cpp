@@ -0,0 +1,86 @@
+#include "core/display_timing.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rj {
+
+namespace {
+
+constexpr double kMinVBlankUs = 460.0;
+constexpr uint32_t kCellGranularity = 8;
+
+// CVT-RB v1 sizes the vertical sync by aspect ratio (non-standard ratios get 10 lines).
+uint32_t VSyncForAspect(uint32_t width, uint32_t height) {
+    struct Aspect {
+        uint32_t w, h, lines;
+    };
+    static const Aspect kAspects[] = {{4, 3, 4}, {16, 9, 5}, {16, 10, 6}, {5, 4, 7}, {15, 9, 7}};
+    for (const Aspect& a : kAspects) {
+        if (height * a.w / a.h == width) return a.lines;
+    }
+    return 10;
+}
+
+} // namespace
+
+double DisplayTiming::RefreshHz() const {
+    const uint64_t total = uint64_t{HTotal()} * VTotal();
+    return total ? static_cast<double>(pixelClockHz) / static_cast<double>(total) : 0.0;
+}
+
+uint32_t DisplayTiming::NominalHz() const {
+    return static_cast<uint32_t>(std::lround(RefreshHz()));
+}
+
+bool ComputeCvtTiming(uint32_t width, uint32_t height, double refreshHz, CvtBlanking blanking, DisplayTiming& out) {
+    if (width < kCellGranularity || height == 0 || !(refreshHz > 0.0)) return false;
+
+    const uint32_t hActive = width / kCellGranularity * kCellGranularity;
+    const double framePeriodUs = 1000000.0 / refreshHz;
+    if (framePeriodUs <= kMinVBlankUs) return false;
+    const double hPeriodEstUs = (framePeriodUs - kMinVBlankUs) / static_cast<double>(height);
+    const uint32_t vbiLines = static_cast<uint32_t>(std::floor(kMinVBlankUs / hPeriodEstUs)) + 1;
+
+    DisplayTiming t;
+    t.hActive = hActive;
+    t.vActive = height;
+    t.hSyncPositive = true;
+    t.vSyncPositive = false;
+
+    uint32_t vBlank = 0;
+    double clockStepHz = 0.0;
+    if (blanking == CvtBlanking::ReducedV1) {
+        t.hFrontPorch = 48;
+        t.hSync = 32;
+        t.hBackPorch = 80;
+        t.vFrontPorch = 3;
+        t.vSync = VSyncForAspect(hActive, height);
+        const uint32_t minVbi = t.vFrontPorch + t.vSync + 6;
+        vBlank = std::max(vbiLines, minVbi);
+        t.vBackPorch = vBlank - t.vFrontPorch - t.vSync;
+        clockStepHz = 250000.0;
+    } else {
+        t.hFrontPorch = 8;
+        t.hSync = 32;
+        t.hBackPorch = 40;
+        t.vSync = 8;
+        t.vBackPorch = 6;
+        const uint32_t minVbi = 1 + t.vSync + t.vBackPorch;
+        vBlank = std::max(vbiLines, minVbi);
+        t.vFrontPorch = vBlank - t.vSync - t.vBackPorch;
+        clockStepHz = 1000.0;
+    }
+
+    const double clockHz = refreshHz * static_cast<double>(t.VTotal()) * static_cast<double>(t.HTotal());
+    t.pixelClockHz = static_cast<uint64_t>(std::floor(clockHz / clockStepHz)) * static_cast<uint64_t>(clockStepHz);
+    out = t;
+    return true;
+}
+
+void QuantizePixelClock(DisplayTiming& timing, uint64_t stepHz) {
+    if (stepHz == 0) return;
+    timing.pixelClockHz = (timing.pixelClockHz + stepHz / 2) / stepHz * stepHz;
+}
+
+} // namespace rj
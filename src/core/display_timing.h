@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+namespace rj {
+
+// Video timing of one mode: active area plus blanking, as EDID/DisplayID and
+// DISPLAYCONFIG_VIDEO_SIGNAL_INFO describe it.
+struct DisplayTiming {
+    uint32_t hActive{};
+    uint32_t hFrontPorch{};
+    uint32_t hSync{};
+    uint32_t hBackPorch{};
+    uint32_t vActive{};
+    uint32_t vFrontPorch{};
+    uint32_t vSync{};
+    uint32_t vBackPorch{};
+    uint64_t pixelClockHz{};
+    bool hSyncPositive{};
+    bool vSyncPositive{};
+
+    uint32_t HBlank() const { return hFrontPorch + hSync + hBackPorch; }
+    uint32_t VBlank() const { return vFrontPorch + vSync + vBackPorch; }
+    uint32_t HTotal() const { return hActive + HBlank(); }
+    uint32_t VTotal() const { return vActive + VBlank(); }
+    double RefreshHz() const;
+    // Refresh rounded to the nearest Hz, as mode lists show it.
+    uint32_t NominalHz() const;
+};
+
+enum class CvtBlanking {
+    ReducedV1,  // CVT-RB: 160 pixel horizontal blank, 0.25 MHz clock steps
+    ReducedV2,  // CVT-RB2: 80 pixel horizontal blank, 1 kHz clock steps
+};
+
+// VESA CVT 1.2 reduced-blanking timing for a progressive mode. Fails for empty sizes or
+// refresh rates the minimum vertical blank (460 us) doesn't fit in.
+bool ComputeCvtTiming(uint32_t width, uint32_t height, double refreshHz, CvtBlanking blanking, DisplayTiming& out);
+
+// Rounds the pixel clock to `stepHz` (e.g. the 10 kHz EDID and DisplayID Type I units).
+void QuantizePixelClock(DisplayTiming& timing, uint64_t stepHz);
+
+} // namespace rj
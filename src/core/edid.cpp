@@ -0,0 +1,317 @@
+#include "core/edid.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace rj {
+
+namespace {
+
+constexpr uint8_t kEdidHeader[8] = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
+constexpr size_t kDescriptorOffset = 54;
+constexpr size_t kDescriptorSize = 18;
+constexpr uint8_t kDisplayIdExtensionTag = 0x70;
+constexpr uint8_t kDisplayIdVersion = 0x12;
+constexpr uint8_t kDisplayIdTypeITimingTag = 0x03;
+constexpr size_t kDisplayIdTimingSize = 20;
+constexpr uint64_t kClockUnitHz = 10000;
+
+uint8_t Checksum(const uint8_t* data, size_t size) {
+    uint8_t sum = 0;
+    for (size_t i = 0; i < size; i++) sum = static_cast<uint8_t>(sum + data[i]);
+    return static_cast<uint8_t>(0x100 - sum);
+}
+
+void Put16(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+uint32_t Get16(const uint8_t* p) {
+    return p[0] | (uint32_t{p[1]} << 8);
+}
+
+bool FitsDetailedTiming(const DisplayTiming& t) {
+    return t.pixelClockHz / kClockUnitHz <= 0xFFFF && t.hActive <= 0xFFF && t.HBlank() <= 0xFFF && t.vActive <= 0xFFF && t.VBlank() <= 0xFFF &&
+           t.hFrontPorch <= 0x3FF && t.hSync <= 0x3FF && t.vFrontPorch <= 0x3F && t.vSync <= 0x3F;
+}
+
+void WriteDetailedTiming(uint8_t* d, const DisplayTiming& t, const EdidIdentity& id) {
+    const uint32_t hBlank = t.HBlank();
+    const uint32_t vBlank = t.VBlank();
+    Put16(d, static_cast<uint32_t>(t.pixelClockHz / kClockUnitHz));
+    d[2] = static_cast<uint8_t>(t.hActive);
+    d[3] = static_cast<uint8_t>(hBlank);
+    d[4] = static_cast<uint8_t>(((t.hActive >> 8) << 4) | (hBlank >> 8));
+    d[5] = static_cast<uint8_t>(t.vActive);
+    d[6] = static_cast<uint8_t>(vBlank);
+    d[7] = static_cast<uint8_t>(((t.vActive >> 8) << 4) | (vBlank >> 8));
+    d[8] = static_cast<uint8_t>(t.hFrontPorch);
+    d[9] = static_cast<uint8_t>(t.hSync);
+    d[10] = static_cast<uint8_t>(((t.vFrontPorch & 0xF) << 4) | (t.vSync & 0xF));
+    d[11] = static_cast<uint8_t>(((t.hFrontPorch >> 8) << 6) | ((t.hSync >> 8) << 4) | ((t.vFrontPorch >> 4) << 2) | (t.vSync >> 4));
+    const uint32_t wMm = std::min(id.widthMm, 0xFFFu);
+    const uint32_t hMm = std::min(id.heightMm, 0xFFFu);
+    d[12] = static_cast<uint8_t>(wMm);
+    d[13] = static_cast<uint8_t>(hMm);
+    d[14] = static_cast<uint8_t>(((wMm >> 8) << 4) | (hMm >> 8));
+    // Digital separate sync with the CVT-RB polarities.
+    d[17] = static_cast<uint8_t>(0x18 | (t.vSyncPositive ? 0x04 : 0) | (t.hSyncPositive ? 0x02 : 0));
+}
+
+DisplayTiming ReadDetailedTiming(const uint8_t* d) {
+    DisplayTiming t;
+    t.pixelClockHz = uint64_t{Get16(d)} * kClockUnitHz;
+    t.hActive = d[2] | (uint32_t{d[4]} >> 4 << 8);
+    const uint32_t hBlank = d[3] | (uint32_t{d[4]} & 0xF) << 8;
+    t.vActive = d[5] | (uint32_t{d[7]} >> 4 << 8);
+    const uint32_t vBlank = d[6] | (uint32_t{d[7]} & 0xF) << 8;
+    t.hFrontPorch = d[8] | ((uint32_t{d[11]} >> 6) & 3) << 8;
+    t.hSync = d[9] | ((uint32_t{d[11]} >> 4) & 3) << 8;
+    t.vFrontPorch = (d[10] >> 4) | ((uint32_t{d[11]} >> 2) & 3) << 4;
+    t.vSync = (d[10] & 0xF) | (uint32_t{d[11]} & 3) << 4;
+    t.hBackPorch = hBlank - std::min(hBlank, t.hFrontPorch + t.hSync);
+    t.vBackPorch = vBlank - std::min(vBlank, t.vFrontPorch + t.vSync);
+    t.hSyncPositive = (d[17] & 0x02) != 0;
+    t.vSyncPositive = (d[17] & 0x04) != 0;
+    return t;
+}
+
+void WriteTextDescriptor(uint8_t* d, uint8_t tag, const std::string& text) {
+    d[3] = tag;
+    const size_t n = std::min<size_t>(text.size(), 13);
+    memcpy(d + 5, text.data(), n);
+    if (n < 13) {
+        d[5 + n] = 0x0A;
+        for (size_t i = n + 1; i < 13; i++) d[5 + i] = 0x20;
+    }
+}
+
+// Display range limits: the refresh and line rates every mode stays inside, with the
+// EDID 1.4 +255 offsets once maxima pass a byte.
+void WriteRangeLimits(uint8_t* d, const DisplayTiming* modes, size_t count) {
+    uint32_t minV = 0xFFFF, maxV = 0, minH = 0xFFFF, maxH = 0;
+    uint64_t maxClock = 0;
+    for (size_t i = 0; i < count; i++) {
+        const DisplayTiming& t = modes[i];
+        const double hz = t.RefreshHz();
+        minV = std::min(minV, static_cast<uint32_t>(hz));
+        maxV = std::max(maxV, static_cast<uint32_t>(hz) + 1);
+        const uint32_t lineKHz = t.HTotal() ? static_cast<uint32_t>(t.pixelClockHz / t.HTotal() / 1000) : 0;
+        minH = std::min(minH, lineKHz);
+        maxH = std::max(maxH, lineKHz + 1);
+        maxClock = std::max(maxClock, t.pixelClockHz);
+    }
+    d[3] = 0xFD;
+    uint8_t offsets = 0;
+    if (maxV > 255) {
+        offsets |= 0x02;
+        maxV -= 255;
+    }
+    if (maxH > 255) {
+        offsets |= 0x08;
+        maxH -= 255;
+    }
+    d[4] = offsets;
+    d[5] = static_cast<uint8_t>(std::clamp(minV, 1u, 255u));
+    d[6] = static_cast<uint8_t>(std::min(maxV, 255u));
+    d[7] = static_cast<uint8_t>(std::clamp(minH, 1u, 255u));
+    d[8] = static_cast<uint8_t>(std::min(maxH, 255u));
+    d[9] = static_cast<uint8_t>(std::min<uint64_t>((maxClock + 9999999) / 10000000, 255));
+    d[10] = 0x01;  // range limits only, no GTF/CVT formula
+    d[11] = 0x0A;
+    for (size_t i = 12; i < kDescriptorSize; i++) d[i] = 0x20;
+}
+
+uint8_t AspectCode(uint32_t w, uint32_t h) {
+    struct Aspect {
+        uint32_t w, h;
+        uint8_t code;
+    };
+    static const Aspect kAspects[] = {{1, 1, 0}, {5, 4, 1}, {4, 3, 2}, {15, 9, 3}, {16, 9, 4}, {16, 10, 5}, {64, 27, 6}, {256, 135, 7}};
+    for (const Aspect& a : kAspects) {
+        if (uint64_t{w} * a.h == uint64_t{h} * a.w) return a.code;
+    }
+    return 8;  // undefined: computed from the active size
+}
+
+void WriteTypeITiming(uint8_t* d, const DisplayTiming& t, bool preferred) {
+    const uint32_t clock = static_cast<uint32_t>(t.pixelClockHz / kClockUnitHz) - 1;
+    d[0] = static_cast<uint8_t>(clock);
+    d[1] = static_cast<uint8_t>(clock >> 8);
+    d[2] = static_cast<uint8_t>(clock >> 16);
+    d[3] = static_cast<uint8_t>((preferred ? 0x80 : 0) | AspectCode(t.hActive, t.vActive));
+    Put16(d + 4, t.hActive - 1);
+    Put16(d + 6, t.HBlank() - 1);
+    Put16(d + 8, ((t.hFrontPorch - 1) & 0x7FFF) | (t.hSyncPositive ? 0x8000 : 0));
+    Put16(d + 10, t.hSync - 1);
+    Put16(d + 12, t.vActive - 1);
+    Put16(d + 14, t.VBlank() - 1);
+    Put16(d + 16, ((t.vFrontPorch - 1) & 0x7FFF) | (t.vSyncPositive ? 0x8000 : 0));
+    Put16(d + 18, t.vSync - 1);
+}
+
+DisplayTiming ReadTypeITiming(const uint8_t* d) {
+    DisplayTiming t;
+    t.pixelClockHz = (uint64_t{d[0]} | uint64_t{d[1]} << 8 | uint64_t{d[2]} << 16) * kClockUnitHz + kClockUnitHz;
+    t.hActive = Get16(d + 4) + 1;
+    const uint32_t hBlank = Get16(d + 6) + 1;
+    t.hFrontPorch = (Get16(d + 8) & 0x7FFF) + 1;
+    t.hSyncPositive = (d[9] & 0x80) != 0;
+    t.hSync = Get16(d + 10) + 1;
+    t.vActive = Get16(d + 12) + 1;
+    const uint32_t vBlank = Get16(d + 14) + 1;
+    t.vFrontPorch = (Get16(d + 16) & 0x7FFF) + 1;
+    t.vSyncPositive = (d[17] & 0x80) != 0;
+    t.vSync = Get16(d + 18) + 1;
+    t.hBackPorch = hBlank - std::min(hBlank, t.hFrontPorch + t.hSync);
+    t.vBackPorch = vBlank - std::min(vBlank, t.vFrontPorch + t.vSync);
+    return t;
+}
+
+bool SameTiming(const DisplayTiming& a, const DisplayTiming& b) {
+    return a.hActive == b.hActive && a.vActive == b.vActive && a.HBlank() == b.HBlank() && a.VBlank() == b.VBlank() && a.pixelClockHz == b.pixelClockHz;
+}
+
+// Adds `t` unless already listed; returns its index.
+size_t AddMode(std::vector<DisplayTiming>& modes, const DisplayTiming& t) {
+    for (size_t i = 0; i < modes.size(); i++) {
+        if (SameTiming(modes[i], t)) return i;
+    }
+    modes.push_back(t);
+    return modes.size() - 1;
+}
+
+// One DisplayID section in an EDID extension block: header, Type I timings, checksums.
+bool ParseDisplayIdBlock(const uint8_t* block, EdidInfo& out, bool& havePreferred) {
+    const uint8_t* section = block + 1;
+    const size_t payload = section[1];
+    if (5 + payload > kEdidBlockSize - 2) return false;
+    if (Checksum(section, 5 + payload) != 0) return false;
+
+    const uint8_t* p = section + 4;
+    const uint8_t* end = p + payload;
+    while (p + 3 <= end) {
+        const uint8_t tag = p[0];
+        const size_t len = p[2];
+        if (tag == 0 || p + 3 + len > end) break;
+        if (tag == kDisplayIdTypeITimingTag) {
+            for (size_t off = 0; off + kDisplayIdTimingSize <= len; off += kDisplayIdTimingSize) {
+                const uint8_t* d = p + 3 + off;
+                const size_t index = AddMode(out.modes, ReadTypeITiming(d));
+                if ((d[3] & 0x80) && !havePreferred) {
+                    out.preferred = index;
+                    havePreferred = true;
+                }
+            }
+        }
+        p += 3 + len;
+    }
+    return true;
+}
+
+} // namespace
+
+std::vector<uint8_t> BuildEdid(const EdidIdentity& identity, const DisplayTiming* modes, size_t count) {
+    const size_t extensions = (count + kDisplayIdTimingsPerBlock - 1) / kDisplayIdTimingsPerBlock;
+    std::vector<uint8_t> edid((1 + extensions) * kEdidBlockSize, 0);
+    uint8_t* base = edid.data();
+
+    memcpy(base, kEdidHeader, sizeof(kEdidHeader));
+    const auto letter = [&](int i) { return static_cast<uint32_t>((identity.manufacturer[i] - 'A' + 1) & 0x1F); };
+    const uint32_t vendor = (letter(0) << 10) | (letter(1) << 5) | letter(2);
+    base[8] = static_cast<uint8_t>(vendor >> 8);
+    base[9] = static_cast<uint8_t>(vendor);
+    Put16(base + 10, identity.productCode);
+    Put16(base + 12, identity.serial);
+    Put16(base + 14, identity.serial >> 16);
+    base[16] = 1;   // week
+    base[17] = 35;  // 2025
+    base[18] = 1;
+    base[19] = 4;
+    base[20] = 0xA5;  // digital, 8 bits per colour, DisplayPort
+    base[21] = static_cast<uint8_t>(std::min((identity.widthMm + 5) / 10, 255u));
+    base[22] = static_cast<uint8_t>(std::min((identity.heightMm + 5) / 10, 255u));
+    base[23] = 120;   // gamma 2.2
+    base[24] = 0x04;  // RGB 4:4:4, sRGB default
+    static const uint8_t kSrgbChromaticity[10] = {0xEE, 0x91, 0xA3, 0x54, 0x4C, 0x99, 0x26, 0x0F, 0x50, 0x54};
+    memcpy(base + 25, kSrgbChromaticity, sizeof(kSrgbChromaticity));
+    for (size_t i = 38; i < 54; i++) base[i] = 0x01;  // no standard timings
+
+    uint8_t* desc = base + kDescriptorOffset;
+    const DisplayTiming* dtd = nullptr;
+    for (size_t i = 0; i < count && !dtd; i++) {
+        if (FitsDetailedTiming(modes[i])) dtd = &modes[i];
+    }
+    if (dtd) {
+        WriteDetailedTiming(desc, *dtd, identity);
+        base[24] |= 0x02;  // the preferred timing is native
+    } else {
+        desc[3] = 0x10;  // dummy descriptor: every mode lives in DisplayID
+    }
+    if (count) WriteRangeLimits(desc + kDescriptorSize, modes, count);
+    else desc[kDescriptorSize + 3] = 0x10;
+    WriteTextDescriptor(desc + 2 * kDescriptorSize, 0xFC, identity.name);
+    WriteTextDescriptor(desc + 3 * kDescriptorSize, 0xFF, std::to_string(identity.serial));
+    base[126] = static_cast<uint8_t>(extensions);
+    base[127] = Checksum(base, kEdidBlockSize - 1);
+
+    for (size_t e = 0; e < extensions; e++) {
+        uint8_t* block = edid.data() + (1 + e) * kEdidBlockSize;
+        const size_t first = e * kDisplayIdTimingsPerBlock;
+        const size_t n = std::min(kDisplayIdTimingsPerBlock, count - first);
+        const size_t blockBytes = n * kDisplayIdTimingSize;
+
+        block[0] = kDisplayIdExtensionTag;
+        uint8_t* section = block + 1;
+        section[0] = kDisplayIdVersion;
+        section[1] = static_cast<uint8_t>(3 + blockBytes);
+        section[2] = 0;  // extension section: product type comes from the base EDID
+        section[3] = 0;
+        uint8_t* data = section + 4;
+        data[0] = kDisplayIdTypeITimingTag;
+        data[1] = 0;
+        data[2] = static_cast<uint8_t>(blockBytes);
+        for (size_t i = 0; i < n; i++) {
+            WriteTypeITiming(data + 3 + i * kDisplayIdTimingSize, modes[first + i], first + i == 0);
+        }
+        section[4 + section[1]] = Checksum(section, 4 + section[1]);
+        block[kEdidBlockSize - 1] = Checksum(block, kEdidBlockSize - 1);
+    }
+    return edid;
+}
+
+bool ParseEdid(const uint8_t* data, size_t size, EdidInfo& out) {
+    out = EdidInfo{};
+    if (!data || size < kEdidBlockSize || memcmp(data, kEdidHeader, sizeof(kEdidHeader)) != 0) return false;
+    if (Checksum(data, kEdidBlockSize - 1) != data[kEdidBlockSize - 1]) return false;
+
+    const uint32_t vendor = (uint32_t{data[8]} << 8) | data[9];
+    out.manufacturer[0] = static_cast<char>('A' - 1 + ((vendor >> 10) & 0x1F));
+    out.manufacturer[1] = static_cast<char>('A' - 1 + ((vendor >> 5) & 0x1F));
+    out.manufacturer[2] = static_cast<char>('A' - 1 + (vendor & 0x1F));
+    out.productCode = static_cast<uint16_t>(Get16(data + 10));
+
+    for (size_t i = 0; i < 4; i++) {
+        const uint8_t* d = data + kDescriptorOffset + i * kDescriptorSize;
+        if (Get16(d) != 0) {
+            AddMode(out.modes, ReadDetailedTiming(d));
+        } else if (d[3] == 0xFC) {
+            const uint8_t* text = d + 5;
+            size_t n = 0;
+            while (n < 13 && text[n] != 0x0A) n++;
+            out.name.assign(reinterpret_cast<const char*>(text), n);
+        }
+    }
+
+    bool havePreferred = false;
+    const size_t extensions = std::min<size_t>(data[126], size / kEdidBlockSize - 1);
+    for (size_t e = 0; e < extensions; e++) {
+        const uint8_t* block = data + (1 + e) * kEdidBlockSize;
+        if (Checksum(block, kEdidBlockSize - 1) != block[kEdidBlockSize - 1]) return false;
+        if (block[0] == kDisplayIdExtensionTag && !ParseDisplayIdBlock(block, out, havePreferred)) return false;
+    }
+    return true;
+}
+
+} // namespace rj
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/display_timing.h"
+
+namespace rj {
+
+constexpr size_t kEdidBlockSize = 128;
+// DisplayID Type I descriptors that fit one extension block next to its headers.
+constexpr size_t kDisplayIdTimingsPerBlock = 5;
+
+struct EdidIdentity {
+    char manufacturer[4] = "RJS";  // three-letter PNP ID
+    uint16_t productCode = 0x5350;
+    uint32_t serial = 1;
+    std::string name = "rj_span";  // monitor name descriptor, at most 13 characters
+    uint32_t widthMm{};            // 0 = unknown
+    uint32_t heightMm{};
+};
+
+// EDID 1.4 base block plus one DisplayID 1.2 extension per kDisplayIdTimingsPerBlock modes.
+// Every mode goes into a DisplayID Type I descriptor, since a base-block detailed timing
+// stops at 4095 active pixels and 655.35 MHz; the first mode that fits also becomes the
+// base block's preferred detailed timing. modes[0] is flagged preferred. Pixel clocks are
+// stored in 10 kHz units, so pass timings already quantized to that.
+std::vector<uint8_t> BuildEdid(const EdidIdentity& identity, const DisplayTiming* modes, size_t count);
+
+struct EdidInfo {
+    char manufacturer[4]{};
+    uint16_t productCode{};
+    std::string name;
+    std::vector<DisplayTiming> modes;  // base-block detailed timings, then DisplayID Type I
+    size_t preferred{};                // index into modes
+};
+
+// Reads what BuildEdid writes (and any EDID 1.x with detailed timings and DisplayID Type I
+// extensions). Fails on a bad header, a bad block or section checksum, or a short buffer.
+// Duplicate timings are reported once.
+bool ParseEdid(const uint8_t* data, size_t size, EdidInfo& out);
+
+} // namespace rj
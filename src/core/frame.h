@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+namespace rj {
+
+// Pixel formats the pipeline understands. Values match the DXGI_FORMAT enum so the
+// Windows backends can pass formats through without a translation table.
+enum class PixelFormat : uint32_t {
+    Unknown = 0,
+    Rgba8 = 28,  // DXGI_FORMAT_R8G8B8A8_UNORM
+    Bgra8 = 87,  // DXGI_FORMAT_B8G8R8A8_UNORM
+    Nv12 = 103,  // DXGI_FORMAT_NV12
+};
+
+// Same layout as a Win32 RECT (left/top inclusive, right/bottom exclusive).
+struct Rect {
+    int32_t left{};
+    int32_t top{};
+    int32_t right{};
+    int32_t bottom{};
+
+    int32_t Width() const { return right - left; }
+    int32_t Height() const { return bottom - top; }
+    bool Empty() const { return right <= left || bottom <= top; }
+};
+
+// Describes one captured frame as it travels from a capture source to the outputs.
+//
+// A frame always has a size/format/timestamp. CPU-visible sources also provide
+// `pixels`; GPU backends leave it null and carry their texture in `handle`
+// (an ID3D11Texture2D* on Windows).
+struct FrameDesc {
+    uint64_t sequence{};
+    int64_t captureTimeNs{};
+    uint32_t width{};
+    uint32_t height{};
+    PixelFormat format{PixelFormat::Unknown};
+    uint32_t strideBytes{};
+    const uint8_t* pixels{};
+    void* handle{};
+
+    // Regions that changed since the previous frame of the same source. A frame with
+    // no dirty rects is treated as fully changed.
+    const Rect* dirtyRects{};
+    uint32_t dirtyRectCount{};
+
+    // Number of source frames folded into this one (DXGI_OUTDUPL_FRAME_INFO::AccumulatedFrames).
+    uint32_t accumulatedFrames{1};
+};
+
+inline uint32_t BytesPerPixel(PixelFormat fmt) {
+    switch (fmt) {
+        case PixelFormat::Rgba8:
+        case PixelFormat::Bgra8:
+            return 4;
+        case PixelFormat::Nv12:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+} // namespace rj
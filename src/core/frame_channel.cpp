@@ -0,0 +1,326 @@
+#include "core/frame_channel.h"
+
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace rj {
+
+namespace {
+
+constexpr uint32_t kIndexMask = 0x3;
+constexpr uint32_t kFreshBit = 0x4;
+constexpr size_t kPageBytes = 4096;
+
+size_t AlignUp(size_t v, size_t a) {
+    return (v + a - 1) / a * a;
+}
+
+} // namespace
+
+struct alignas(kCacheLineBytes) FrameChannelSlotHeader {
+    std::atomic<uint32_t> seq{};  // odd while the producer rewrites the header
+    ChannelFrameInfo info{};
+};
+
+// Fixed layout at the start of the shared block; the payload slots follow at payloadOffset.
+// Both sides must be built from the same definition (checked through version).
+struct FrameChannelLayout {
+    std::atomic<uint32_t> magic{};  // written last when formatting
+    uint32_t version{};
+    uint32_t slotCount{};
+    uint32_t reserved{};
+    uint64_t payloadOffset{};
+    uint64_t payloadSlotBytes{};
+    std::atomic<uint64_t> adapterLuid{};
+
+    alignas(kCacheLineBytes) std::atomic<uint32_t> state{};  // middle slot index | fresh bit
+    alignas(kCacheLineBytes) std::atomic<uint32_t> consumerSlot{};
+    std::atomic<uint32_t> consumerAttached{};
+    std::atomic<uint32_t> sliceRequest{};  // written by the consumer
+    alignas(kCacheLineBytes) std::atomic<uint32_t> generation{};
+    std::atomic<uint32_t> surfaceSlices{};  // stored before the generation it belongs to
+    std::atomic<int64_t> heartbeatNs{};
+    alignas(kCacheLineBytes) std::atomic<uint64_t> assignments{};
+    std::atomic<uint64_t> deviceReuses{};
+    std::atomic<int64_t> deviceAcquireNs{};
+    std::atomic<int64_t> firstFrameNs{};
+
+    FrameChannelSlotHeader slots[kFrameChannelSlots];
+};
+
+// The layout is shared between processes, so every atomic in it must be a plain memory
+// word rather than a lock living in one process.
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<int64_t>::is_always_lock_free,
+              "frame channel atomics must be lock-free");
+static_assert(std::is_trivially_copyable_v<ChannelFrameInfo>, "ChannelFrameInfo is copied through shared memory");
+
+namespace {
+
+// Seqlock read of a slot header. Returns false when the producer was writing it.
+bool ReadHeader(const FrameChannelSlotHeader& slot, ChannelFrameInfo& out, uint32_t& seq) {
+    const uint32_t s1 = slot.seq.load(std::memory_order_acquire);
+    if (s1 & 1u) return false;
+    memcpy(&out, &slot.info, sizeof(out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint32_t s2 = slot.seq.load(std::memory_order_relaxed);
+    if (s1 != s2) return false;
+    if (out.dirtyRectCount > kFrameChannelMaxDirtyRects) out.dirtyRectCount = 0;
+    seq = s1;
+    return true;
+}
+
+} // namespace
+
+size_t FrameChannelBytes(size_t payloadSlotBytes) {
+    return AlignUp(sizeof(FrameChannelLayout), kPageBytes) + kFrameChannelSlots * AlignUp(payloadSlotBytes, kCacheLineBytes);
+}
+
+std::string FrameChannelSurfaceName(uint32_t generation, uint32_t slot) {
+    char name[96];
+    snprintf(name, sizeof(name), "Global\\%s_%u_%u", kFrameChannelName, generation, slot);
+    return name;
+}
+
+std::string FrameChannelSliceSurfaceName(uint32_t generation, uint32_t slot, uint32_t slice) {
+    char name[96];
+    snprintf(name, sizeof(name), "Global\\%s_%u_%u_%u", kFrameChannelName, generation, slot, slice);
+    return name;
+}
+
+bool FrameChannelProducer::Init(void* mem, size_t bytes, size_t payloadSlotBytes, uint64_t adapterLuid) {
+    if (!mem || bytes < FrameChannelBytes(payloadSlotBytes)) return false;
+    auto* layout = static_cast<FrameChannelLayout*>(mem);
+    const size_t slotBytes = AlignUp(payloadSlotBytes, kCacheLineBytes);
+
+    const bool adopt = layout->magic.load(std::memory_order_acquire) == kFrameChannelMagic && layout->version == kFrameChannelVersion &&
+                       layout->slotCount == kFrameChannelSlots && layout->payloadSlotBytes == slotBytes;
+    if (adopt) {
+        // Keep the consumer's slot; the write slot is whichever is neither the middle nor
+        // the consumer's.
+        const uint32_t middle = layout->state.load(std::memory_order_acquire) & kIndexMask;
+        uint32_t consumer = layout->consumerSlot.load(std::memory_order_acquire);
+        if (consumer >= kFrameChannelSlots || consumer == middle || middle >= kFrameChannelSlots) {
+            layout->state.store(1, std::memory_order_release);
+            layout->consumerSlot.store(2, std::memory_order_release);
+            m_back = 0;
+        } else {
+            m_back = 3 - middle - consumer;
+        }
+        layout->adapterLuid.store(adapterLuid, std::memory_order_relaxed);
+        layout->surfaceSlices.store(0, std::memory_order_relaxed);
+        layout->generation.fetch_add(1, std::memory_order_acq_rel);
+    } else {
+        layout->magic.store(0, std::memory_order_relaxed);
+        new (mem) FrameChannelLayout();
+        layout->version = kFrameChannelVersion;
+        layout->slotCount = kFrameChannelSlots;
+        layout->payloadOffset = AlignUp(sizeof(FrameChannelLayout), kPageBytes);
+        layout->payloadSlotBytes = slotBytes;
+        layout->adapterLuid.store(adapterLuid, std::memory_order_relaxed);
+        layout->state.store(1, std::memory_order_relaxed);
+        layout->consumerSlot.store(2, std::memory_order_relaxed);
+        layout->generation.store(1, std::memory_order_relaxed);
+        layout->magic.store(kFrameChannelMagic, std::memory_order_release);
+        m_back = 0;
+    }
+    m_layout = layout;
+    m_base = static_cast<uint8_t*>(mem);
+    m_payloadSlotBytes = slotBytes;
+    m_published = 0;
+    return true;
+}
+
+uint8_t* FrameChannelProducer::Payload(uint32_t slot) const {
+    if (!m_layout || m_payloadSlotBytes == 0 || slot >= kFrameChannelSlots) return nullptr;
+    return m_base + m_layout->payloadOffset + slot * m_payloadSlotBytes;
+}
+
+void FrameChannelProducer::Publish(const ChannelFrameInfo& info) {
+    FrameChannelSlotHeader& slot = m_layout->slots[m_back];
+    // Odd while writing; `| 1` also recovers a sequence a crashed producer left odd.
+    const uint32_t seq = (slot.seq.load(std::memory_order_relaxed) + 1) | 1u;
+    slot.seq.store(seq, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&slot.info, &info, sizeof(info));
+    slot.seq.store(seq + 1, std::memory_order_release);
+
+    const uint32_t prev = m_layout->state.exchange(m_back | kFreshBit, std::memory_order_acq_rel);
+    m_back = prev & kIndexMask;
+    m_published++;
+}
+
+uint32_t FrameChannelProducer::BumpGeneration(uint32_t surfaceSlices) {
+    m_layout->surfaceSlices.store(surfaceSlices, std::memory_order_relaxed);
+    return m_layout->generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+}
+
+uint32_t FrameChannelProducer::Generation() const {
+    return m_layout ? m_layout->generation.load(std::memory_order_acquire) : 0;
+}
+
+void FrameChannelProducer::Heartbeat(int64_t nowNs) {
+    m_layout->heartbeatNs.store(nowNs, std::memory_order_release);
+}
+
+void FrameChannelProducer::ReportAssignment(bool deviceReused, int64_t deviceAcquireNs) {
+    m_layout->firstFrameNs.store(0, std::memory_order_relaxed);
+    m_layout->deviceAcquireNs.store(deviceAcquireNs, std::memory_order_relaxed);
+    if (deviceReused) m_layout->deviceReuses.fetch_add(1, std::memory_order_relaxed);
+    m_layout->assignments.fetch_add(1, std::memory_order_release);
+}
+
+void FrameChannelProducer::ReportFirstFrame(int64_t sinceAssignmentNs) {
+    m_layout->firstFrameNs.store(sinceAssignmentNs, std::memory_order_release);
+}
+
+uint32_t FrameChannelProducer::RequestedSlices() const {
+    return m_layout ? m_layout->sliceRequest.load(std::memory_order_relaxed) : 0;
+}
+
+bool FrameChannelProducer::ConsumerAttached() const {
+    return m_layout && m_layout->consumerAttached.load(std::memory_order_acquire) != 0;
+}
+
+bool FrameChannelConsumer::Attach(void* mem, size_t bytes) {
+    Detach();
+    if (!mem || bytes < sizeof(FrameChannelLayout)) return false;
+    auto* layout = static_cast<FrameChannelLayout*>(mem);
+    if (layout->magic.load(std::memory_order_acquire) != kFrameChannelMagic || layout->version != kFrameChannelVersion ||
+        layout->slotCount != kFrameChannelSlots || layout->payloadOffset + kFrameChannelSlots * layout->payloadSlotBytes > bytes) {
+        return false;
+    }
+    const uint32_t front = layout->consumerSlot.load(std::memory_order_acquire);
+    if (front >= kFrameChannelSlots) return false;
+
+    m_layout = layout;
+    m_base = static_cast<uint8_t*>(mem);
+    m_front = front;
+    m_current = ChannelFrameInfo{};
+    m_frontSeq = 0;
+    m_lastFrameId = 0;
+    m_torn = 0;
+    m_skipped = 0;
+    m_generation = layout->generation.load(std::memory_order_acquire);
+    layout->consumerAttached.store(1, std::memory_order_release);
+
+    // The display may be idle (the OS only presents on change), so start from whatever the
+    // previous consumer left in our slot rather than waiting for the next frame.
+    ChannelFrameInfo info;
+    uint32_t seq = 0;
+    if (ReadHeader(layout->slots[front], info, seq) && info.frameId != 0) {
+        m_current = info;
+        m_current.dirtyRectCount = 0;
+        m_frontSeq = seq;
+        m_lastFrameId = info.frameId;
+    }
+    return true;
+}
+
+void FrameChannelConsumer::Detach() {
+    if (m_layout) {
+        m_layout->sliceRequest.store(0, std::memory_order_relaxed);
+        m_layout->consumerAttached.store(0, std::memory_order_release);
+    }
+    m_layout = nullptr;
+    m_base = nullptr;
+}
+
+bool FrameChannelConsumer::Update() {
+    if (!m_layout || !(m_layout->state.load(std::memory_order_relaxed) & kFreshBit)) return false;
+    const uint32_t prev = m_layout->state.exchange(m_front, std::memory_order_acq_rel);
+    m_front = prev & kIndexMask;
+    m_layout->consumerSlot.store(m_front, std::memory_order_release);
+
+    ChannelFrameInfo info;
+    uint32_t seq = 0;
+    if (!ReadHeader(m_layout->slots[m_front], info, seq)) {
+        // The previous frame's slot is gone too; StillValid() stays false until the next
+        // successful Update().
+        m_torn++;
+        m_frontSeq = 0;
+        return false;
+    }
+    // Dirty rects only describe the step from the previous frame of the same producer; a
+    // restarted producer counts from 1 again on new surfaces.
+    const uint32_t generation = m_layout->generation.load(std::memory_order_acquire);
+    if (generation != m_generation || info.frameId <= m_lastFrameId) m_lastFrameId = 0;
+    m_generation = generation;
+    if (m_lastFrameId == 0) {
+        info.dirtyRectCount = 0;
+    } else if (info.frameId > m_lastFrameId + 1) {
+        m_skipped += info.frameId - m_lastFrameId - 1;
+        info.accumulatedFrames = static_cast<uint32_t>(info.frameId - m_lastFrameId);
+        info.dirtyRectCount = 0;
+    }
+    m_current = info;
+    m_frontSeq = seq;
+    m_lastFrameId = info.frameId;
+    return true;
+}
+
+bool FrameChannelConsumer::StillValid() const {
+    if (!m_layout || m_frontSeq == 0) return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return m_layout->slots[m_front].seq.load(std::memory_order_relaxed) == m_frontSeq;
+}
+
+const uint8_t* FrameChannelConsumer::Payload() const {
+    if (!m_layout || m_layout->payloadSlotBytes == 0) return nullptr;
+    return m_base + m_layout->payloadOffset + m_front * m_layout->payloadSlotBytes;
+}
+
+size_t FrameChannelConsumer::PayloadSlotBytes() const {
+    return m_layout ? m_layout->payloadSlotBytes : 0;
+}
+
+FrameDesc FrameChannelConsumer::Frame() const {
+    FrameDesc d;
+    d.sequence = m_current.frameId;
+    d.captureTimeNs = m_current.presentTimeNs;
+    d.width = m_current.width;
+    d.height = m_current.height;
+    d.format = m_current.format;
+    d.strideBytes = m_current.strideBytes;
+    d.pixels = Payload();
+    d.dirtyRects = m_current.dirtyRectCount ? m_current.dirtyRects : nullptr;
+    d.dirtyRectCount = m_current.dirtyRectCount;
+    d.accumulatedFrames = m_current.accumulatedFrames;
+    return d;
+}
+
+uint32_t FrameChannelConsumer::Generation() const {
+    return m_layout ? m_layout->generation.load(std::memory_order_acquire) : 0;
+}
+
+uint32_t FrameChannelConsumer::SurfaceSlices() const {
+    return m_layout ? m_layout->surfaceSlices.load(std::memory_order_acquire) : 0;
+}
+
+void FrameChannelConsumer::RequestSlices(uint32_t outputs) {
+    if (m_layout) m_layout->sliceRequest.store(outputs, std::memory_order_relaxed);
+}
+
+uint64_t FrameChannelConsumer::AdapterLuid() const {
+    return m_layout ? m_layout->adapterLuid.load(std::memory_order_relaxed) : 0;
+}
+
+ChannelProducerStats FrameChannelConsumer::ProducerStats() const {
+    ChannelProducerStats s;
+    if (!m_layout) return s;
+    s.assignments = m_layout->assignments.load(std::memory_order_acquire);
+    s.deviceReuses = m_layout->deviceReuses.load(std::memory_order_relaxed);
+    s.deviceAcquireNs = m_layout->deviceAcquireNs.load(std::memory_order_relaxed);
+    s.firstFrameNs = m_layout->firstFrameNs.load(std::memory_order_acquire);
+    return s;
+}
+
+bool FrameChannelConsumer::ProducerAlive(int64_t nowNs, int64_t timeoutNs) const {
+    if (!m_layout) return false;
+    const int64_t hb = m_layout->heartbeatNs.load(std::memory_order_acquire);
+    return hb != 0 && nowNs - hb <= timeoutNs;
+}
+
+} // namespace rj
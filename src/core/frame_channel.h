@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "core/frame.h"
+#include "core/triple_buffer.h"
+
+namespace rj {
+
+// Cross-process "latest frame" channel between the IDD driver's swapchain processor and
+// rj_span, laid out in a SharedMemory block.
+//
+// It is TripleBuffer split across two processes: three slots rotate between the producer
+// (back), the consumer (front) and a shared middle slot through one atomic state word, so
+// neither side blocks and the consumer always gets the newest complete frame. Each slot has
+// a header (frame id, present time, dirty rects) behind a seqlock and, optionally, a CPU
+// payload region. The Windows driver uses no payload: its pixels live in one shared D3D
+// texture per slot, named by FrameChannelSurfaceName(), or, when the consumer asks for
+// slices, in one texture per output per slot (see RequestSlices()).
+
+constexpr const char* kFrameChannelName = "RjSpanFrameChannel";
+constexpr uint32_t kFrameChannelMagic = 0x43464A52;  // 'RJFC'
+constexpr uint32_t kFrameChannelVersion = 3;
+constexpr uint32_t kFrameChannelSlots = 3;
+constexpr uint32_t kFrameChannelMaxDirtyRects = 32;
+
+struct ChannelFrameInfo {
+    uint64_t frameId{};        // producer's frame counter, starts at 1
+    int64_t presentTimeNs{};   // when the OS presented the frame (producer clock)
+    int64_t publishTimeNs{};   // when the producer published it
+    uint32_t width{};
+    uint32_t height{};
+    PixelFormat format{PixelFormat::Unknown};
+    uint32_t strideBytes{};
+    uint32_t accumulatedFrames{1};
+    // Per-output slice surfaces the producer wrote this frame into (PlanSlices() of
+    // width x height over this many outputs); 0 = one wide surface.
+    uint32_t sliceCount{};
+    // Changes since the previous frame; 0 means the whole frame. Producers with more rects
+    // than fit report the whole frame.
+    uint32_t dirtyRectCount{};
+    Rect dirtyRects[kFrameChannelMaxDirtyRects]{};
+};
+
+// Swap-chain assignments the producer reports, for rj_span's stats line. Kept across
+// producer restarts on an adopted layout.
+struct ChannelProducerStats {
+    uint64_t assignments{};     // swap-chains assigned since the block was formatted
+    uint64_t deviceReuses{};    // of those, served by a cached render device
+    int64_t deviceAcquireNs{};  // latest assignment: getting its device
+    int64_t firstFrameNs{};     // latest assignment: until its first processed frame; 0 = not yet
+};
+
+// Bytes to map for a channel with `payloadSlotBytes` of CPU payload per slot.
+size_t FrameChannelBytes(size_t payloadSlotBytes);
+
+// Name of the shared texture holding `slot` for a producer generation ("Global\..." so the
+// session-0 driver host and the desktop can share it), or output `slice` of it.
+std::string FrameChannelSurfaceName(uint32_t generation, uint32_t slot);
+std::string FrameChannelSliceSurfaceName(uint32_t generation, uint32_t slot, uint32_t slice);
+
+struct FrameChannelLayout;
+
+class FrameChannelProducer {
+public:
+    // Formats `mem` as a channel, or adopts the layout a previous producer left there (a
+    // driver restart under a running consumer): the consumer keeps its slot and the
+    // generation is bumped. `adapterLuid` identifies the GPU the surfaces live on.
+    bool Init(void* mem, size_t bytes, size_t payloadSlotBytes, uint64_t adapterLuid = 0);
+
+    // Slot to fill before Publish(); only the producer touches it until then.
+    uint32_t WriteSlot() const { return m_back; }
+    uint8_t* Payload(uint32_t slot) const;
+    size_t PayloadSlotBytes() const { return m_payloadSlotBytes; }
+
+    // Writes the slot header and hands the write slot to the consumer. `info.publishTimeNs`
+    // is taken as given.
+    void Publish(const ChannelFrameInfo& info);
+
+    // Announces that the per-slot surfaces were recreated (size, format or slicing change)
+    // as `surfaceSlices` per-output surfaces per slot (0 = one wide surface); the consumer
+    // reopens them.
+    uint32_t BumpGeneration(uint32_t surfaceSlices = 0);
+    uint32_t Generation() const;
+
+    // Outputs the consumer wants the frame sliced into; 0 = a wide surface.
+    uint32_t RequestedSlices() const;
+
+    // Liveness signal; call at least every few hundred ms, also when no frames arrive.
+    void Heartbeat(int64_t nowNs);
+
+    // A swap-chain was assigned; its first processed frame follows with ReportFirstFrame().
+    void ReportAssignment(bool deviceReused, int64_t deviceAcquireNs);
+    void ReportFirstFrame(int64_t sinceAssignmentNs);
+
+    bool ConsumerAttached() const;
+    uint64_t Published() const { return m_published; }
+
+private:
+    FrameChannelLayout* m_layout{};
+    uint8_t* m_base{};
+    size_t m_payloadSlotBytes{};
+    uint32_t m_back{};
+    uint64_t m_published{};
+};
+
+class FrameChannelConsumer {
+public:
+    ~FrameChannelConsumer() { Detach(); }
+
+    // Validates the layout in `mem` and claims the consumer side.
+    bool Attach(void* mem, size_t bytes);
+    void Detach();
+    bool Attached() const { return m_layout != nullptr; }
+
+    // Makes the newest published frame current. Returns false (and keeps the current frame)
+    // when nothing new was published or the new slot's header was torn.
+    bool Update();
+
+    // True while the producer hasn't written into the current slot since Update() took it.
+    // Only a producer restart racing Update() can break this; check after reading a payload.
+    bool StillValid() const;
+
+    // Current frame. When frames were skipped since the previous Update(), or the producer
+    // restarted, the dirty rects are dropped (whole frame); accumulatedFrames counts the
+    // skipped frames.
+    const ChannelFrameInfo& Current() const { return m_current; }
+    uint32_t Slot() const { return m_front; }
+    const uint8_t* Payload() const;
+    size_t PayloadSlotBytes() const;
+
+    // Current frame as a FrameDesc (pixels from the payload, if any).
+    FrameDesc Frame() const;
+
+    uint32_t Generation() const;
+    // Surface layout of the current generation, see BumpGeneration().
+    uint32_t SurfaceSlices() const;
+    uint64_t AdapterLuid() const;
+
+    // Asks the producer to write per-output slice surfaces for `outputs` outputs (0 = stop).
+    // It may decline (e.g. when the frame can't be sliced 1:1); SurfaceSlices() tells.
+    void RequestSlices(uint32_t outputs);
+    bool ProducerAlive(int64_t nowNs, int64_t timeoutNs) const;
+    ChannelProducerStats ProducerStats() const;
+
+    uint64_t TornReads() const { return m_torn; }
+    uint64_t SkippedFrames() const { return m_skipped; }
+
+private:
+    FrameChannelLayout* m_layout{};
+    uint8_t* m_base{};
+    uint32_t m_front{};
+    uint32_t m_frontSeq{};
+    ChannelFrameInfo m_current{};
+    uint64_t m_lastFrameId{};
+    uint32_t m_generation{};
+    uint64_t m_torn{};
+    uint64_t m_skipped{};
+};
+
+} // namespace rj
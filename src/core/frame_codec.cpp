@@ -0,0 +1,460 @@
+#include "core/frame_codec.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/frame_codec_impl.h"
+#include "core/tile_hash.h"
+
+#if RJ_X86
+#include <xmmintrin.h>
+#endif
+
+namespace rj {
+
+namespace detail {
+
+void TileResidualsScalar(const uint8_t* pixels, uint32_t strideBytes, uint32_t w, uint32_t h, int16_t* planes) {
+    const uint32_t values = CodecPlaneValues(w, h);
+    for (uint32_t y = 0; y < h; y++) {
+        const size_t row = static_cast<size_t>(y) * w;
+        ForwardPixels(pixels + static_cast<size_t>(y) * strideBytes, 0, w, planes + row, planes + values + row, planes + 2 * values + row, planes + 3 * values + row);
+    }
+    for (uint32_t p = 0; p < kCodecPlanes; p++) {
+        int16_t* plane = planes + static_cast<size_t>(p) * values;
+        // Bottom up, so the row above is still the original when it is subtracted.
+        for (uint32_t y = h; y-- > 1;) ResidualUp(plane + static_cast<size_t>(y) * w, plane + static_cast<size_t>(y - 1) * w, 0, w, kCodecPlaneBits[p]);
+        ResidualLeft(plane, w, kCodecPlaneBits[p]);
+    }
+    ZeroPadding(planes, w, h);
+}
+
+void TileReconstructScalar(int16_t* planes, uint32_t w, uint32_t h, uint8_t* pixels, uint32_t strideBytes) {
+    const uint32_t values = CodecPlaneValues(w, h);
+    for (uint32_t p = 0; p < kCodecPlanes; p++) {
+        int16_t* plane = planes + static_cast<size_t>(p) * values;
+        ReconstructLeft(plane, w, kCodecPlaneBits[p]);
+        for (uint32_t y = 1; y < h; y++) ReconstructUp(plane + static_cast<size_t>(y) * w, plane + static_cast<size_t>(y - 1) * w, 0, w, kCodecPlaneBits[p]);
+    }
+    for (uint32_t y = 0; y < h; y++) {
+        const size_t row = static_cast<size_t>(y) * w;
+        InversePixels(planes + row, planes + values + row, planes + 2 * values + row, planes + 3 * values + row, 0, w, pixels + static_cast<size_t>(y) * strideBytes);
+    }
+}
+
+size_t GroupWidthsScalar(const int16_t* values, uint32_t groups, uint8_t* widths) {
+    size_t bytes = 0;
+    for (uint32_t g = 0; g < groups; g++, values += kCodecGroup) {
+        uint16_t any = 0;
+        for (uint32_t i = 0; i < kCodecGroup; i++) any = static_cast<uint16_t>(any | values[i]);
+        widths[g] = kBitLengths.bits[any];
+        bytes += 2u * widths[g];
+    }
+    return bytes;
+}
+
+void PackGroupsScalar(const int16_t* values, uint32_t groups, const uint8_t* widths, uint8_t* out) {
+    for (uint32_t g = 0; g < groups; g++, values += kCodecGroup) {
+        for (uint32_t k = 0; k < widths[g]; k++, out += 2) {
+            uint32_t mask = 0;
+            for (uint32_t i = 0; i < kCodecGroup; i++) mask |= ((static_cast<uint32_t>(values[i]) >> k) & 1u) << i;
+            out[0] = static_cast<uint8_t>(mask);
+            out[1] = static_cast<uint8_t>(mask >> 8);
+        }
+    }
+}
+
+void UnpackGroupsScalar(const uint8_t* in, uint32_t groups, const uint8_t* widths, int16_t* values) {
+    for (uint32_t g = 0; g < groups; g++, values += kCodecGroup) {
+        uint32_t v[kCodecGroup]{};
+        for (uint32_t k = 0; k < widths[g]; k++, in += 2) {
+            const uint32_t mask = in[0] | (in[1] << 8);
+            for (uint32_t i = 0; i < kCodecGroup; i++) v[i] |= ((mask >> i) & 1u) << k;
+        }
+        for (uint32_t i = 0; i < kCodecGroup; i++) values[i] = static_cast<int16_t>(v[i]);
+    }
+}
+
+} // namespace detail
+
+namespace {
+
+constexpr char kFrameMagic[4] = {'R', 'J', 'F', 'C'};
+constexpr uint16_t kFrameVersion = 1;
+constexpr char kStreamMagic[8] = {'R', 'J', 'C', 'O', 'D', 'E', 'C', '1'};
+constexpr uint32_t kMaxDimension = 32768;
+constexpr uint32_t kMaxStreamFrameBytes = 1u << 30;
+
+using detail::kCodecGroup;
+using detail::kCodecPlanes;
+
+SimdLevel ClampLevel(SimdLevel level) {
+    return static_cast<int>(level) > static_cast<int>(DetectSimdLevel()) ? DetectSimdLevel() : level;
+}
+
+// Rows of a tile about to be written: its rows are a frame stride apart, too far for the
+// hardware prefetcher.
+void PrefetchRows(const uint8_t* p, size_t stride, size_t rowBytes, uint32_t rows) {
+#if RJ_X86
+    for (uint32_t y = 0; y < rows; y++) {
+        for (size_t x = 0; x < rowBytes; x += 64) _mm_prefetch(reinterpret_cast<const char*>(p + y * stride + x), _MM_HINT_T0);
+    }
+#else
+    (void)p;
+    (void)stride;
+    (void)rowBytes;
+    (void)rows;
+#endif
+}
+
+struct Kernels {
+    detail::TileResidualsFn residuals;
+    detail::TileReconstructFn reconstruct;
+    detail::GroupWidthsFn widths;
+    detail::PackGroupsFn pack;
+    detail::UnpackGroupsFn unpack;
+};
+
+Kernels SelectKernels(SimdLevel level) {
+    if (ClampLevel(level) == SimdLevel::Avx2) {
+        return {detail::TileResidualsAvx2, detail::TileReconstructAvx2, detail::GroupWidthsAvx2, detail::PackGroupsAvx2, detail::UnpackGroupsAvx2};
+    }
+    return {detail::TileResidualsScalar, detail::TileReconstructScalar, detail::GroupWidthsScalar, detail::PackGroupsScalar, detail::UnpackGroupsScalar};
+}
+
+uint32_t ClampTileSize(uint32_t tileSize) {
+    return std::clamp<uint32_t>(tileSize, 8, 256);
+}
+
+size_t PlaneScratch(uint32_t tileSize) {
+    return static_cast<size_t>(kCodecPlanes) * detail::CodecPlaneValues(tileSize, tileSize);
+}
+
+bool ReadFrameHeader(const uint8_t* data, size_t size, CodecFrameHeader& h) {
+    if (!data || size < sizeof(h)) return false;
+    std::memcpy(&h, data, sizeof(h));
+    if (std::memcmp(h.magic, kFrameMagic, sizeof(h.magic)) != 0 || h.version != kFrameVersion) return false;
+    if (h.width == 0 || h.height == 0 || h.width > kMaxDimension || h.height > kMaxDimension) return false;
+    if (h.tileSize != ClampTileSize(h.tileSize)) return false;
+    if (h.tileCount != TileCols(h.width, h.tileSize) * TileRows(h.height, h.tileSize)) return false;
+    return size - sizeof(h) >= static_cast<size_t>(h.tileCount) * 4u;
+}
+
+} // namespace
+
+FrameEncoder::FrameEncoder(const CodecConfig& cfg) : m_cfg(cfg), m_pool(cfg.threads) {
+    m_cfg.tileSize = ClampTileSize(m_cfg.tileSize);
+    m_bands.resize(m_pool.Threads());
+    for (Band& b : m_bands) {
+        b.planes.assign(PlaneScratch(m_cfg.tileSize), 0);
+        b.widths.assign(PlaneScratch(m_cfg.tileSize) / kCodecGroup, 0);
+    }
+}
+
+void FrameEncoder::EncodeBand(const Job& job, uint32_t band) {
+    Band& b = m_bands[band];
+    b.out.clear();
+    b.raw = 0;
+    const Kernels kernels = SelectKernels(m_cfg.level);
+    const uint32_t ts = m_cfg.tileSize;
+    const size_t refStride = static_cast<size_t>(m_width) * 4u;
+    const uint32_t bands = static_cast<uint32_t>(m_bands.size());
+    for (uint32_t tr = BandBegin(m_rows, band, bands); tr < BandBegin(m_rows, band + 1, bands); tr++) {
+        const uint32_t y0 = tr * ts;
+        const uint32_t th = std::min(ts, m_height - y0);
+        // Which tiles changed: whole rows first, in memory order; only rows that differ are
+        // compared tile by tile. With damage, only the damaged tiles are compared.
+        b.changed.assign(m_cols, job.keyframe ? 1 : 0);
+        const uint8_t* damaged = job.damaged ? job.damaged + static_cast<size_t>(tr) * m_cols : nullptr;
+        for (uint32_t y = 0; y < th && damaged && !job.keyframe; y++) {
+            const uint8_t* srcRow = job.pixels + static_cast<size_t>(y0 + y) * job.strideBytes;
+            const uint8_t* refRow = m_reference.data() + static_cast<size_t>(y0 + y) * refStride;
+            for (uint32_t c = 0; c < m_cols; c++) {
+                const size_t x = static_cast<size_t>(c) * ts * 4u;
+                if (damaged[c] && !b.changed[c]) b.changed[c] = std::memcmp(srcRow + x, refRow + x, std::min<size_t>(ts * 4u, refStride - x)) != 0;
+            }
+        }
+        for (uint32_t y = 0; y < th && !damaged && !job.keyframe; y++) {
+            const uint8_t* srcRow = job.pixels + static_cast<size_t>(y0 + y) * job.strideBytes;
+            const uint8_t* refRow = m_reference.data() + static_cast<size_t>(y0 + y) * refStride;
+            if (std::memcmp(srcRow, refRow, refStride) == 0) continue;
+            for (uint32_t c = 0; c < m_cols; c++) {
+                const size_t x = static_cast<size_t>(c) * ts * 4u;
+                if (!b.changed[c]) b.changed[c] = std::memcmp(srcRow + x, refRow + x, std::min<size_t>(ts * 4u, refStride - x)) != 0;
+            }
+        }
+        // Changed tiles go to the reference row by row, runs of them at a time: memory order
+        // for the prefetcher, and the tiles are then coded from there.
+        for (uint32_t y = 0; y < th; y++) {
+            const uint8_t* srcRow = job.pixels + static_cast<size_t>(y0 + y) * job.strideBytes;
+            uint8_t* refRow = m_reference.data() + static_cast<size_t>(y0 + y) * refStride;
+            for (uint32_t c = 0; c < m_cols;) {
+                if (!b.changed[c]) {
+                    c++;
+                    continue;
+                }
+                const uint32_t begin = c;
+                while (c < m_cols && b.changed[c]) c++;
+                const size_t x = static_cast<size_t>(begin) * ts * 4u;
+                std::memcpy(refRow + x, srcRow + x, std::min<size_t>(static_cast<size_t>(c) * ts * 4u, refStride) - x);
+            }
+        }
+        for (uint32_t c = 0; c < m_cols; c++) {
+            const uint32_t x0 = c * ts;
+            const uint32_t tw = std::min(ts, m_width - x0);
+            const size_t rowBytes = static_cast<size_t>(tw) * 4u;
+            const uint8_t* ref = m_reference.data() + static_cast<size_t>(y0) * refStride + static_cast<size_t>(x0) * 4u;
+            uint32_t& tileBytes = m_tileBytes[static_cast<size_t>(tr) * m_cols + c];
+            if (!b.changed[c]) {
+                tileBytes = 0;
+                continue;
+            }
+
+            kernels.residuals(ref, static_cast<uint32_t>(refStride), tw, th, b.planes.data());
+            const uint32_t groups = kCodecPlanes * detail::CodecPlaneValues(tw, th) / kCodecGroup;
+            const size_t widthBytes = (groups + 1) / 2;
+            const size_t payload = kernels.widths(b.planes.data(), groups, b.widths.data());
+            const size_t rawBytes = rowBytes * th;
+            const size_t start = b.out.size();
+            if (widthBytes + payload >= rawBytes) {
+                b.out.resize(start + 1 + rawBytes);
+                uint8_t* dst = b.out.data() + start;
+                *dst++ = static_cast<uint8_t>(CodecTileMode::Raw);
+                for (uint32_t y = 0; y < th; y++, dst += rowBytes) std::memcpy(dst, ref + y * refStride, rowBytes);
+                b.raw++;
+            } else {
+                b.out.resize(start + 1 + widthBytes + payload + detail::kCodecPackSlack);
+                uint8_t* dst = b.out.data() + start;
+                *dst++ = static_cast<uint8_t>(CodecTileMode::Coded);
+                std::memset(dst, 0, widthBytes);
+                for (uint32_t g = 0; g < groups; g++) dst[g / 2] |= static_cast<uint8_t>(b.widths[g] << ((g & 1) * 4));
+                kernels.pack(b.planes.data(), groups, b.widths.data(), dst + widthBytes);
+                b.out.resize(start + 1 + widthBytes + payload);
+            }
+            tileBytes = static_cast<uint32_t>(b.out.size() - start);
+        }
+    }
+}
+
+bool FrameEncoder::Encode(const uint8_t* pixels,
+                          uint32_t strideBytes,
+                          uint32_t width,
+                          uint32_t height,
+                          std::vector<uint8_t>& out,
+                          EncodeStats* stats,
+                          const Rect* damage,
+                          uint32_t damageCount) {
+    if (!pixels || width == 0 || height == 0 || width > kMaxDimension || height > kMaxDimension || strideBytes < width * 4u) return false;
+    if (width != m_width || height != m_height) {
+        m_width = width;
+        m_height = height;
+        m_cols = TileCols(width, m_cfg.tileSize);
+        m_rows = TileRows(height, m_cfg.tileSize);
+        m_reference.assign(static_cast<size_t>(width) * height * 4u, 0);
+        m_tileBytes.assign(static_cast<size_t>(m_cols) * m_rows, 0);
+        m_forceKey = true;
+    }
+    const bool keyframe = m_forceKey || (m_cfg.keyframeInterval != 0 && m_frames >= m_cfg.keyframeInterval);
+
+    Job job{pixels, strideBytes, keyframe};
+    if (damage && !keyframe) {
+        m_damaged.assign(m_tileBytes.size(), 0);
+        const int32_t ts = static_cast<int32_t>(m_cfg.tileSize);
+        for (uint32_t i = 0; i < damageCount; i++) {
+            const Rect& r = damage[i];
+            const int32_t x0 = std::max(r.left, 0);
+            const int32_t y0 = std::max(r.top, 0);
+            const int32_t x1 = std::min(r.right, static_cast<int32_t>(width));
+            const int32_t y1 = std::min(r.bottom, static_cast<int32_t>(height));
+            if (x1 <= x0 || y1 <= y0) continue;
+            for (int32_t tr = y0 / ts; tr <= (y1 - 1) / ts; tr++) {
+                std::memset(m_damaged.data() + static_cast<size_t>(tr) * m_cols + x0 / ts, 1, static_cast<size_t>((x1 - 1) / ts - x0 / ts + 1));
+            }
+        }
+        job.damaged = m_damaged.data();
+    }
+    m_pool.Run([&](uint32_t band) { EncodeBand(job, band); });
+
+    CodecFrameHeader h{};
+    std::memcpy(h.magic, kFrameMagic, sizeof(h.magic));
+    h.version = kFrameVersion;
+    h.flags = keyframe ? kCodecKeyframe : 0;
+    h.width = width;
+    h.height = height;
+    h.tileSize = m_cfg.tileSize;
+    h.tileCount = static_cast<uint32_t>(m_tileBytes.size());
+    size_t bytes = sizeof(h) + m_tileBytes.size() * 4u;
+    for (const Band& b : m_bands) bytes += b.out.size();
+    out.resize(bytes);
+    uint8_t* dst = out.data();
+    std::memcpy(dst, &h, sizeof(h));
+    dst += sizeof(h);
+    std::memcpy(dst, m_tileBytes.data(), m_tileBytes.size() * 4u);
+    dst += m_tileBytes.size() * 4u;
+    for (const Band& b : m_bands) {
+        if (b.out.empty()) continue;
+        std::memcpy(dst, b.out.data(), b.out.size());
+        dst += b.out.size();
+    }
+
+    if (stats) {
+        *stats = EncodeStats{};
+        stats->keyframe = keyframe;
+        stats->tiles = h.tileCount;
+        for (uint32_t size : m_tileBytes) stats->skipped += size == 0;
+        for (const Band& b : m_bands) stats->raw += b.raw;
+        stats->bytes = bytes;
+    }
+    m_forceKey = false;
+    m_frames = keyframe ? 1 : m_frames + 1;
+    return true;
+}
+
+FrameDecoder::FrameDecoder(const CodecConfig& cfg) : m_cfg(cfg), m_pool(cfg.threads) {
+    m_bands.resize(m_pool.Threads());
+}
+
+void FrameDecoder::DecodeBand(const uint8_t* data, uint32_t band) {
+    Band& b = m_bands[band];
+    b.ok = true;
+    const Kernels kernels = SelectKernels(m_cfg.level);
+    const uint32_t ts = m_tileSize;
+    const size_t frameStride = static_cast<size_t>(m_width) * 4u;
+    const uint32_t bands = static_cast<uint32_t>(m_bands.size());
+    for (uint32_t tr = BandBegin(m_rows, band, bands); tr < BandBegin(m_rows, band + 1, bands); tr++) {
+        const uint32_t y0 = tr * ts;
+        const uint32_t th = std::min(ts, m_height - y0);
+        for (uint32_t c = 0; c < m_cols; c++) {
+            const size_t index = static_cast<size_t>(tr) * m_cols + c;
+            if (m_tileBytes[index] == 0) continue;
+            const uint8_t* src = data + m_offsets[index];
+            const uint8_t* end = src + m_tileBytes[index];
+            const uint32_t x0 = c * ts;
+            const uint32_t tw = std::min(ts, m_width - x0);
+            const size_t rowBytes = static_cast<size_t>(tw) * 4u;
+            uint8_t* dst = m_frame.data() + static_cast<size_t>(y0) * frameStride + static_cast<size_t>(x0) * 4u;
+
+            const uint8_t mode = *src++;
+            if (mode == static_cast<uint8_t>(CodecTileMode::Raw)) {
+                if (static_cast<size_t>(end - src) != rowBytes * th) {
+                    b.ok = false;
+                    return;
+                }
+                for (uint32_t y = 0; y < th; y++, src += rowBytes) std::memcpy(dst + y * frameStride, src, rowBytes);
+                continue;
+            }
+            const uint32_t groups = kCodecPlanes * detail::CodecPlaneValues(tw, th) / kCodecGroup;
+            const size_t widthBytes = (groups + 1) / 2;
+            if (mode != static_cast<uint8_t>(CodecTileMode::Coded) || static_cast<size_t>(end - src) < widthBytes) {
+                b.ok = false;
+                return;
+            }
+            size_t payload = 0;
+            for (uint32_t g = 0; g < groups; g++) {
+                b.widths[g] = static_cast<uint8_t>((src[g / 2] >> ((g & 1) * 4)) & 0xF);
+                payload += 2u * b.widths[g];
+                if (b.widths[g] > detail::kCodecMaxBits) {
+                    b.ok = false;
+                    return;
+                }
+            }
+            src += widthBytes;
+            if (static_cast<size_t>(end - src) != payload) {
+                b.ok = false;
+                return;
+            }
+            kernels.unpack(src, groups, b.widths.data(), b.planes.data());
+            if (c + 1 < m_cols) PrefetchRows(dst + rowBytes, frameStride, rowBytes, th);
+            kernels.reconstruct(b.planes.data(), tw, th, dst, static_cast<uint32_t>(frameStride));
+        }
+    }
+}
+
+bool FrameDecoder::Decode(const uint8_t* data, size_t size) {
+    CodecFrameHeader h{};
+    const bool valid = m_valid;
+    m_valid = false;
+    if (!ReadFrameHeader(data, size, h)) return false;
+    const bool keyframe = (h.flags & kCodecKeyframe) != 0;
+    const bool sameSize = h.width == m_width && h.height == m_height && h.tileSize == m_tileSize;
+    if (!keyframe && !(valid && sameSize)) return false;
+    if (!sameSize) {
+        m_width = h.width;
+        m_height = h.height;
+        m_tileSize = h.tileSize;
+        m_cols = TileCols(h.width, h.tileSize);
+        m_rows = TileRows(h.height, h.tileSize);
+        m_frame.assign(static_cast<size_t>(h.width) * h.height * 4u, 0);
+        m_offsets.assign(h.tileCount, 0);
+        m_tileBytes.assign(h.tileCount, 0);
+        for (Band& b : m_bands) {
+            b.planes.assign(PlaneScratch(h.tileSize), 0);
+            b.widths.assign(PlaneScratch(h.tileSize) / kCodecGroup, 0);
+        }
+    }
+
+    std::memcpy(m_tileBytes.data(), data + sizeof(h), m_tileBytes.size() * 4u);
+    size_t offset = sizeof(h) + m_tileBytes.size() * 4u;
+    for (size_t i = 0; i < m_tileBytes.size(); i++) {
+        if (keyframe && m_tileBytes[i] == 0) return false;
+        m_offsets[i] = offset;
+        offset += m_tileBytes[i];
+        if (offset > size) return false;
+    }
+
+    m_pool.Run([&](uint32_t band) { DecodeBand(data, band); });
+    for (const Band& b : m_bands) {
+        if (!b.ok) return false;
+    }
+    m_valid = true;
+    m_keyframe = keyframe;
+    return true;
+}
+
+bool ReadCodecFrameInfo(const uint8_t* data, size_t size, CodecFrameInfo& info) {
+    CodecFrameHeader h{};
+    if (!ReadFrameHeader(data, size, h)) return false;
+    info = CodecFrameInfo{};
+    info.keyframe = (h.flags & kCodecKeyframe) != 0;
+    info.width = h.width;
+    info.height = h.height;
+    info.tileSize = h.tileSize;
+    info.tiles = h.tileCount;
+    size_t offset = sizeof(h) + static_cast<size_t>(h.tileCount) * 4u;
+    for (uint32_t i = 0; i < h.tileCount; i++) {
+        uint32_t bytes = 0;
+        std::memcpy(&bytes, data + sizeof(h) + static_cast<size_t>(i) * 4u, 4);
+        if (bytes == 0) {
+            info.skipped++;
+            continue;
+        }
+        if (offset + bytes > size) return false;
+        info.raw += data[offset] == static_cast<uint8_t>(CodecTileMode::Raw);
+        offset += bytes;
+    }
+    return true;
+}
+
+bool WriteCodecStreamHeader(FILE* f) {
+    return fwrite(kStreamMagic, sizeof(kStreamMagic), 1, f) == 1;
+}
+
+bool ReadCodecStreamHeader(FILE* f) {
+    char magic[sizeof(kStreamMagic)];
+    return fread(magic, sizeof(magic), 1, f) == 1 && std::memcmp(magic, kStreamMagic, sizeof(magic)) == 0;
+}
+
+bool WriteCodecFrame(FILE* f, const std::vector<uint8_t>& frame) {
+    const uint32_t size = static_cast<uint32_t>(frame.size());
+    if (frame.size() > kMaxStreamFrameBytes || fwrite(&size, sizeof(size), 1, f) != 1) return false;
+    return frame.empty() || fwrite(frame.data(), frame.size(), 1, f) == 1;
+}
+
+bool ReadCodecFrame(FILE* f, std::vector<uint8_t>& frame) {
+    uint32_t size = 0;
+    if (fread(&size, sizeof(size), 1, f) != 1 || size > kMaxStreamFrameBytes) return false;
+    frame.resize(size);
+    return size == 0 || fread(frame.data(), size, 1, f) == 1;
+}
+
+} // namespace rj
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "core/cpu_features.h"
+#include "core/frame.h"
+#include "core/worker_pool.h"
+
+namespace rj {
+
+// Lossless codec for captured frames (4-byte BGRA pixels), fast enough to record the whole
+// wide frame at display rate. A frame is cut into tiles; a tile that is byte-identical to
+// the previous frame costs 4 bytes, every other tile is coded on its own:
+//   YCoCg-R color transform, up/left prediction, zigzagged residuals bit-packed in groups
+//   of 16 (0..9 bits each), or the raw pixels when that is not smaller.
+// Tiles are independent, so both sides split a frame into bands of tile rows over a
+// WorkerPool. Output is identical at every SIMD level and thread count.
+//
+// Frame layout (little-endian):
+//   CodecFrameHeader
+//   uint32 bytes[tileCount]   0: unchanged since the previous frame (never in a keyframe)
+//   tile payloads in order    uint8 mode (CodecTileMode), then the mode's data
+struct CodecConfig {
+    uint32_t tileSize = 64;  // 8..256
+    // Threads coding one frame, the caller included. Each takes a band of tile rows.
+    uint32_t threads = 1;
+    // Frames between keyframes; 0 = the first frame, size changes and ForceKeyframe() only.
+    uint32_t keyframeInterval = 0;
+    SimdLevel level = DetectSimdLevel();
+};
+
+enum class CodecTileMode : uint8_t {
+    Coded = 1,
+    Raw = 2,
+};
+
+struct CodecFrameHeader {
+    char magic[4];  // "RJFC"
+    uint16_t version;
+    uint16_t flags;  // kCodecKeyframe
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileSize;
+    uint32_t tileCount;
+};
+
+constexpr uint16_t kCodecKeyframe = 1;
+
+struct EncodeStats {
+    bool keyframe{};
+    uint32_t tiles{};
+    uint32_t skipped{};  // unchanged since the previous frame
+    uint32_t raw{};      // stored uncompressed
+    size_t bytes{};
+};
+
+class FrameEncoder {
+public:
+    explicit FrameEncoder(const CodecConfig& cfg = CodecConfig{});
+
+    // Encodes one frame into `out` (replacing its contents). Returns false on bad arguments.
+    // With `damage` (DD dirty rects), the frame differs from the previous one only inside
+    // those rects and the tiles outside them are not compared; nullptr means anywhere.
+    bool Encode(const uint8_t* pixels,
+                uint32_t strideBytes,
+                uint32_t width,
+                uint32_t height,
+                std::vector<uint8_t>& out,
+                EncodeStats* stats = nullptr,
+                const Rect* damage = nullptr,
+                uint32_t damageCount = 0);
+    // The next frame is a keyframe.
+    void ForceKeyframe() { m_forceKey = true; }
+
+private:
+    struct Job {
+        const uint8_t* pixels{};
+        uint32_t strideBytes{};
+        bool keyframe{};
+        const uint8_t* damaged{};  // per tile, from the damage rects; null: compare all
+    };
+    struct Band {
+        std::vector<uint8_t> out;
+        std::vector<int16_t> planes;
+        std::vector<uint8_t> widths;   // bits per residual group
+        std::vector<uint8_t> changed;  // per tile of the current tile row
+        uint32_t raw{};
+    };
+
+    void EncodeBand(const Job& job, uint32_t band);
+
+    CodecConfig m_cfg;
+    uint32_t m_width{};
+    uint32_t m_height{};
+    uint32_t m_cols{};
+    uint32_t m_rows{};
+    uint64_t m_frames{};  // since the last keyframe
+    bool m_forceKey = true;
+    std::vector<uint8_t> m_reference;  // the previous frame, width * 4 bytes per row
+    std::vector<uint32_t> m_tileBytes;
+    std::vector<uint8_t> m_damaged;
+    std::vector<Band> m_bands;
+    WorkerPool m_pool;
+};
+
+class FrameDecoder {
+public:
+    // tileSize and keyframeInterval are taken from the stream.
+    explicit FrameDecoder(const CodecConfig& cfg = CodecConfig{});
+
+    // Decodes one frame onto the previous one. Returns false, leaving Frame() undefined
+    // until the next keyframe, if the data is malformed or a delta frame does not follow a
+    // frame of the same size.
+    bool Decode(const uint8_t* data, size_t size);
+    void Reset() { m_valid = false; }
+    // The last successful Decode() was a keyframe: nothing of the previous frame survived.
+    bool Keyframe() const { return m_keyframe; }
+
+    // width * 4 bytes per row.
+    const std::vector<uint8_t>& Frame() const { return m_frame; }
+    uint32_t Width() const { return m_width; }
+    uint32_t Height() const { return m_height; }
+
+private:
+    struct Band {
+        std::vector<int16_t> planes;
+        std::vector<uint8_t> widths;
+        bool ok{};
+    };
+
+    void DecodeBand(const uint8_t* data, uint32_t band);
+
+    CodecConfig m_cfg;
+    uint32_t m_width{};
+    uint32_t m_height{};
+    uint32_t m_tileSize{};
+    uint32_t m_cols{};
+    uint32_t m_rows{};
+    bool m_valid{};
+    bool m_keyframe{};
+    std::vector<uint8_t> m_frame;
+    std::vector<size_t> m_offsets;  // tile payload offsets in the current frame, 0 = unchanged
+    std::vector<uint32_t> m_tileBytes;
+    std::vector<Band> m_bands;
+    WorkerPool m_pool;
+};
+
+struct CodecFrameInfo {
+    bool keyframe{};
+    uint32_t width{};
+    uint32_t height{};
+    uint32_t tileSize{};
+    uint32_t tiles{};
+    uint32_t skipped{};
+    uint32_t raw{};
+};
+
+// Header and tile summary of an encoded frame without decoding it.
+bool ReadCodecFrameInfo(const uint8_t* data, size_t size, CodecFrameInfo& info);
+
+// Codec stream files (.rjc): a stream header, then each frame prefixed with its uint32 size.
+bool WriteCodecStreamHeader(FILE* f);
+bool ReadCodecStreamHeader(FILE* f);
+bool WriteCodecFrame(FILE* f, const std::vector<uint8_t>& frame);
+// False at the end of the stream or on a truncated frame.
+bool ReadCodecFrame(FILE* f, std::vector<uint8_t>& frame);
+
+} // namespace rj
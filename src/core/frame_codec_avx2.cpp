@@ -0,0 +1,252 @@
+// AVX2 frame codec kernels. Built with -mavx2 (/arch:AVX2 on MSVC); only called after
+// DetectSimdLevel() reported AVX2.
+
+#include <cstring>
+
+#include "core/cpu_features.h"
+#include "core/frame_codec_impl.h"
+
+#if RJ_X86
+#include <immintrin.h>
+#endif
+
+namespace rj::detail {
+
+#if RJ_X86
+
+namespace {
+
+template <uint32_t Bits>
+inline __m256i SignExtend16(__m256i v) {
+    return _mm256_srai_epi16(_mm256_slli_epi16(v, 16 - Bits), 16 - Bits);
+}
+
+template <uint32_t Bits>
+inline __m256i Wrap16(__m256i v) {
+    if constexpr (Bits == 8) return _mm256_and_si256(v, _mm256_set1_epi16(0xFF));
+    return SignExtend16<Bits>(v);
+}
+
+template <uint32_t Bits>
+inline __m256i ZigZag16(__m256i d) {
+    const __m256i s = SignExtend16<Bits>(d);
+    return _mm256_xor_si256(_mm256_slli_epi16(s, 1), _mm256_srai_epi16(s, 15));
+}
+
+inline __m256i UnZigZag16(__m256i z) {
+    return _mm256_xor_si256(_mm256_srli_epi16(z, 1), _mm256_sub_epi16(_mm256_setzero_si256(), _mm256_and_si256(z, _mm256_set1_epi16(1))));
+}
+
+inline __m256i Load16(const int16_t* src) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+}
+
+inline void Store16(int16_t* dst, __m256i v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v);
+}
+
+// 16 pixels to YCoCg-R in 16-bit lanes, in pixel order.
+inline void Forward16(const uint8_t* src, __m256i& y, __m256i& co, __m256i& cg, __m256i& a) {
+    const __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    const __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+    const __m256i low = _mm256_set1_epi32(0xFFFF);
+    // B | G << 8 and R | A << 8 per pixel; packus interleaves the 128-bit lanes, the
+    // permute puts them back in order.
+    const __m256i bg = _mm256_permute4x64_epi64(_mm256_packus_epi32(_mm256_and_si256(p0, low), _mm256_and_si256(p1, low)), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256i ra = _mm256_permute4x64_epi64(_mm256_packus_epi32(_mm256_srli_epi32(p0, 16), _mm256_srli_epi32(p1, 16)), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256i byteMask = _mm256_set1_epi16(0xFF);
+    const __m256i b = _mm256_and_si256(bg, byteMask);
+    const __m256i g = _mm256_srli_epi16(bg, 8);
+    a = _mm256_srli_epi16(ra, 8);
+    co = _mm256_sub_epi16(_mm256_and_si256(ra, byteMask), b);
+    const __m256i t = _mm256_add_epi16(b, _mm256_srai_epi16(co, 1));
+    cg = _mm256_sub_epi16(g, t);
+    y = _mm256_add_epi16(t, _mm256_srai_epi16(cg, 1));
+}
+
+inline void Inverse16(__m256i y, __m256i co, __m256i cg, __m256i a, uint8_t* dst) {
+    const __m256i byteMask = _mm256_set1_epi16(0xFF);
+    const __m256i t = _mm256_sub_epi16(y, _mm256_srai_epi16(cg, 1));
+    const __m256i g = _mm256_add_epi16(cg, t);
+    const __m256i b = _mm256_sub_epi16(t, _mm256_srai_epi16(co, 1));
+    const __m256i r = _mm256_add_epi16(b, co);
+    const __m256i bg = _mm256_or_si256(_mm256_and_si256(b, byteMask), _mm256_slli_epi16(g, 8));
+    const __m256i ra = _mm256_or_si256(_mm256_and_si256(r, byteMask), _mm256_slli_epi16(a, 8));
+    // unpacklo: pixels 0-3 | 8-11, unpackhi: 4-7 | 12-15.
+    const __m256i lo = _mm256_unpacklo_epi16(bg, ra);
+    const __m256i hi = _mm256_unpackhi_epi16(bg, ra);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+} // namespace
+
+// One pass in memory order. The transform of the row above is kept in `up` for the
+// prediction; the first row is stored untransformed for ResidualLeft().
+void TileResidualsAvx2(const uint8_t* pixels, uint32_t strideBytes, uint32_t w, uint32_t h, int16_t* planes) {
+    const uint32_t values = CodecPlaneValues(w, h);
+    const uint32_t wide = w & ~15u;
+    int16_t* py = planes;
+    int16_t* pco = planes + values;
+    int16_t* pcg = planes + 2 * values;
+    int16_t* pa = planes + 3 * values;
+    alignas(32) int16_t up[kCodecPlanes][256];
+    for (uint32_t x = 0; x < wide; x += 16) {
+        __m256i vy, vco, vcg, va;
+        Forward16(pixels + x * 4u, vy, vco, vcg, va);
+        Store16(py + x, vy);
+        Store16(pco + x, vco);
+        Store16(pcg + x, vcg);
+        Store16(pa + x, va);
+        Store16(up[0] + x, vy);
+        Store16(up[1] + x, vco);
+        Store16(up[2] + x, vcg);
+        Store16(up[3] + x, va);
+    }
+    for (uint32_t y = 1; y < h; y++) {
+        const uint8_t* src = pixels + static_cast<size_t>(y) * strideBytes;
+        const size_t row = static_cast<size_t>(y) * w;
+        for (uint32_t x = 0; x < wide; x += 16) {
+            __m256i vy, vco, vcg, va;
+            Forward16(src + x * 4u, vy, vco, vcg, va);
+            Store16(py + row + x, ZigZag16<8>(_mm256_sub_epi16(vy, Load16(up[0] + x))));
+            Store16(pco + row + x, ZigZag16<9>(_mm256_sub_epi16(vco, Load16(up[1] + x))));
+            Store16(pcg + row + x, ZigZag16<9>(_mm256_sub_epi16(vcg, Load16(up[2] + x))));
+            Store16(pa + row + x, ZigZag16<8>(_mm256_sub_epi16(va, Load16(up[3] + x))));
+            Store16(up[0] + x, vy);
+            Store16(up[1] + x, vco);
+            Store16(up[2] + x, vcg);
+            Store16(up[3] + x, va);
+        }
+    }
+    if (wide < w) {
+        for (uint32_t y = 0; y < h; y++) {
+            const size_t row = static_cast<size_t>(y) * w;
+            ForwardPixels(pixels + static_cast<size_t>(y) * strideBytes, wide, w, py + row, pco + row, pcg + row, pa + row);
+        }
+        for (uint32_t p = 0; p < kCodecPlanes; p++) {
+            int16_t* plane = planes + static_cast<size_t>(p) * values;
+            for (uint32_t y = h; y-- > 1;) ResidualUp(plane + static_cast<size_t>(y) * w, plane + static_cast<size_t>(y - 1) * w, wide, w, kCodecPlaneBits[p]);
+        }
+    }
+    for (uint32_t p = 0; p < kCodecPlanes; p++) ResidualLeft(planes + static_cast<size_t>(p) * values, w, kCodecPlaneBits[p]);
+    ZeroPadding(planes, w, h);
+}
+
+// In memory order: each row is reconstructed in place from the one above and written out.
+void TileReconstructAvx2(int16_t* planes, uint32_t w, uint32_t h, uint8_t* pixels, uint32_t strideBytes) {
+    const uint32_t values = CodecPlaneValues(w, h);
+    const uint32_t wide = w & ~15u;
+    int16_t* py = planes;
+    int16_t* pco = planes + values;
+    int16_t* pcg = planes + 2 * values;
+    int16_t* pa = planes + 3 * values;
+    for (uint32_t p = 0; p < kCodecPlanes; p++) ReconstructLeft(planes + static_cast<size_t>(p) * values, w, kCodecPlaneBits[p]);
+    for (uint32_t x = 0; x < wide; x += 16) Inverse16(Load16(py + x), Load16(pco + x), Load16(pcg + x), Load16(pa + x), pixels + x * 4u);
+    for (uint32_t y = 1; y < h; y++) {
+        uint8_t* dst = pixels + static_cast<size_t>(y) * strideBytes;
+        const size_t row = static_cast<size_t>(y) * w;
+        for (uint32_t x = 0; x < wide; x += 16) {
+            const size_t i = row + x;
+            const __m256i vy = Wrap16<8>(_mm256_add_epi16(Load16(py + i - w), UnZigZag16(Load16(py + i))));
+            const __m256i vco = Wrap16<9>(_mm256_add_epi16(Load16(pco + i - w), UnZigZag16(Load16(pco + i))));
+            const __m256i vcg = Wrap16<9>(_mm256_add_epi16(Load16(pcg + i - w), UnZigZag16(Load16(pcg + i))));
+            const __m256i va = Wrap16<8>(_mm256_add_epi16(Load16(pa + i - w), UnZigZag16(Load16(pa + i))));
+            Store16(py + i, vy);
+            Store16(pco + i, vco);
+            Store16(pcg + i, vcg);
+            Store16(pa + i, va);
+            Inverse16(vy, vco, vcg, va, dst + x * 4u);
+        }
+        if (wide < w) {
+            for (uint32_t p = 0; p < kCodecPlanes; p++) {
+                int16_t* cur = planes + static_cast<size_t>(p) * values + row;
+                ReconstructUp(cur, cur - w, wide, w, kCodecPlaneBits[p]);
+            }
+        }
+    }
+    if (wide < w) {
+        for (uint32_t y = 0; y < h; y++) {
+            const size_t row = static_cast<size_t>(y) * w;
+            InversePixels(py + row, pco + row, pcg + row, pa + row, wide, w, pixels + static_cast<size_t>(y) * strideBytes);
+        }
+    }
+}
+
+size_t GroupWidthsAvx2(const int16_t* values, uint32_t groups, uint8_t* widths) {
+    size_t bytes = 0;
+    for (uint32_t g = 0; g < groups; g++, values += kCodecGroup) {
+        const __m256i v = Load16(values);
+        __m128i any = _mm_or_si128(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        any = _mm_or_si128(any, _mm_srli_si128(any, 8));
+        any = _mm_or_si128(any, _mm_srli_si128(any, 4));
+        any = _mm_or_si128(any, _mm_srli_si128(any, 2));
+        widths[g] = kBitLengths.bits[_mm_extract_epi16(any, 0) & ((1 << kCodecMaxBits) - 1)];
+        bytes += 2u * widths[g];
+    }
+    return bytes;
+}
+
+// Bit k of all 16 values is the movemask of the bytes shifted so bit k is each byte's top bit.
+void PackGroupsAvx2(const int16_t* values, uint32_t groups, const uint8_t* widths, uint8_t* out) {
+    const __m128i byteMask = _mm_set1_epi16(0xFF);
+    for (uint32_t g = 0; g < groups; g++, values += kCodecGroup) {
+        const uint32_t bits = widths[g];
+        if (bits == 0) continue;
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + 8));
+        const __m128i low = _mm_packus_epi16(_mm_and_si128(lo, byteMask), _mm_and_si128(hi, byteMask));
+        uint16_t masks[kCodecMaxBits]{};
+        masks[0] = static_cast<uint16_t>(_mm_movemask_epi8(_mm_slli_epi16(low, 7)));
+        masks[1] = static_cast<uint16_t>(_mm_movemask_epi8(_mm_slli_epi16(low, 6)));
+        masks[2] = static_cast<uint16_t>(_mm_movemask_epi8(_mm_slli_epi16(low, 5)));
+        masks[3] = static_cast<uint16_t>(_mm_movemask_epi8(_mm_slli_epi16(low, 4)));
+        masks[4] = static_cast<uint16_t>(_mm_movemask_epi8(_mm_slli_epi16(low, 3)));
+        masks[5] = static_cast<uint16_t>(_mm_movemask_epi8(_mm_slli_epi16(low, 2)));
+        masks[6] = static_cast<uint16_t>(_mm_movemask_epi8(_mm_slli_epi16(low, 1)));
+        masks[7] = static_cast<uint16_t>(_mm_movemask_epi8(low));
+        if (bits > 8) masks[8] = static_cast<uint16_t>(_mm_movemask_epi8(_mm_slli_epi16(_mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)), 7)));
+        std::memcpy(out, masks, sizeof(masks));  // the caller leaves kCodecPackSlack bytes
+        out += 2u * bits;
+    }
+}
+
+// Each mask is broadcast and compared against the lane's bit.
+void UnpackGroupsAvx2(const uint8_t* in, uint32_t groups, const uint8_t* widths, int16_t* values) {
+    const __m256i laneBit = _mm256_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, static_cast<int16_t>(0x8000));
+    for (uint32_t g = 0; g < groups; g++, values += kCodecGroup) {
+        __m256i v = _mm256_setzero_si256();
+        for (uint32_t k = 0; k < widths[g]; k++, in += 2) {
+            const __m256i mask = _mm256_set1_epi16(static_cast<int16_t>(in[0] | (in[1] << 8)));
+            const __m256i set = _mm256_cmpeq_epi16(_mm256_and_si256(mask, laneBit), laneBit);
+            v = _mm256_or_si256(v, _mm256_and_si256(set, _mm256_set1_epi16(static_cast<int16_t>(1 << k))));
+        }
+        Store16(values, v);
+    }
+}
+
+#else
+
+void TileResidualsAvx2(const uint8_t* pixels, uint32_t strideBytes, uint32_t w, uint32_t h, int16_t* planes) {
+    TileResidualsScalar(pixels, strideBytes, w, h, planes);
+}
+
+void TileReconstructAvx2(int16_t* planes, uint32_t w, uint32_t h, uint8_t* pixels, uint32_t strideBytes) {
+    TileReconstructScalar(planes, w, h, pixels, strideBytes);
+}
+
+size_t GroupWidthsAvx2(const int16_t* values, uint32_t groups, uint8_t* widths) {
+    return GroupWidthsScalar(values, groups, widths);
+}
+
+void PackGroupsAvx2(const int16_t* values, uint32_t groups, const uint8_t* widths, uint8_t* out) {
+    PackGroupsScalar(values, groups, widths, out);
+}
+
+void UnpackGroupsAvx2(const uint8_t* in, uint32_t groups, const uint8_t* widths, int16_t* values) {
+    UnpackGroupsScalar(in, groups, widths, values);
+}
+
+#endif
+
+} // namespace rj::detail
@@ -0,0 +1,151 @@
+#pragma once
+
+// Internal to the frame codec: the tile transform shared by the kernel TUs. Every kernel
+// must produce the same residuals and pixels as the scalar one.
+//
+// A tile of BGRA pixels becomes four planes of int16, w * h values each, padded with zeros
+// to a multiple of kCodecGroup:
+//   YCoCg-R (lossless): Co = R - B, t = B + (Co >> 1), Cg = G - t, Y = t + (Cg >> 1)
+//   Y and A are 8-bit, Co and Cg 9-bit signed.
+// Each value is predicted from the one above it (from the one to its left on the first row,
+// 0 for the first pixel); the residual wraps to the plane's bit width and is zigzagged, so
+// it is 0..255 (Y, A) or 0..511 (Co, Cg) and small when the content is smooth.
+//
+// The planes are then coded in groups of kCodecGroup consecutive values. A group's width is
+// the bit length of its largest residual (0..9); its payload is one little-endian uint16
+// per bit, bit i of mask k being bit k of value i (bit planes: movemask on the way in,
+// compare on the way out), so 2 * width bytes.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace rj::detail {
+
+constexpr uint32_t kCodecPlanes = 4;  // Y, Co, Cg, A
+constexpr uint32_t kCodecGroup = 16;  // residuals sharing one bit width
+constexpr uint32_t kCodecPlaneBits[kCodecPlanes] = {8, 9, 9, 8};
+constexpr uint32_t kCodecMaxBits = 9;
+constexpr uint32_t kCodecPackSlack = 2 * kCodecMaxBits;
+
+// Values per plane, padded to whole groups.
+inline uint32_t CodecPlaneValues(uint32_t w, uint32_t h) {
+    return (w * h + kCodecGroup - 1) / kCodecGroup * kCodecGroup;
+}
+
+// Residual planes of one tile: planes holds kCodecPlanes * CodecPlaneValues(w, h) values.
+using TileResidualsFn = void (*)(const uint8_t* pixels, uint32_t strideBytes, uint32_t w, uint32_t h, int16_t* planes);
+// The inverse; consumes (overwrites) the planes.
+using TileReconstructFn = void (*)(int16_t* planes, uint32_t w, uint32_t h, uint8_t* pixels, uint32_t strideBytes);
+
+// Widths of `groups` groups of residuals; returns their payload bytes.
+using GroupWidthsFn = size_t (*)(const int16_t* values, uint32_t groups, uint8_t* widths);
+// May write up to kCodecPackSlack bytes past the end of the payload.
+using PackGroupsFn = void (*)(const int16_t* values, uint32_t groups, const uint8_t* widths, uint8_t* out);
+// widths must be <= kCodecMaxBits.
+using UnpackGroupsFn = void (*)(const uint8_t* in, uint32_t groups, const uint8_t* widths, int16_t* values);
+
+void TileResidualsScalar(const uint8_t* pixels, uint32_t strideBytes, uint32_t w, uint32_t h, int16_t* planes);
+void TileResidualsAvx2(const uint8_t* pixels, uint32_t strideBytes, uint32_t w, uint32_t h, int16_t* planes);
+void TileReconstructScalar(int16_t* planes, uint32_t w, uint32_t h, uint8_t* pixels, uint32_t strideBytes);
+void TileReconstructAvx2(int16_t* planes, uint32_t w, uint32_t h, uint8_t* pixels, uint32_t strideBytes);
+size_t GroupWidthsScalar(const int16_t* values, uint32_t groups, uint8_t* widths);
+size_t GroupWidthsAvx2(const int16_t* values, uint32_t groups, uint8_t* widths);
+void PackGroupsScalar(const int16_t* values, uint32_t groups, const uint8_t* widths, uint8_t* out);
+void PackGroupsAvx2(const int16_t* values, uint32_t groups, const uint8_t* widths, uint8_t* out);
+void UnpackGroupsScalar(const uint8_t* in, uint32_t groups, const uint8_t* widths, int16_t* values);
+void UnpackGroupsAvx2(const uint8_t* in, uint32_t groups, const uint8_t* widths, int16_t* values);
+
+struct BitLengths {
+    uint8_t bits[1u << kCodecMaxBits];
+};
+
+constexpr BitLengths MakeBitLengths() {
+    BitLengths t{};
+    for (uint32_t v = 1; v < (1u << kCodecMaxBits); v++) t.bits[v] = static_cast<uint8_t>(t.bits[v / 2] + 1);
+    return t;
+}
+
+// Bit length of every residual value.
+inline constexpr BitLengths kBitLengths = MakeBitLengths();
+
+// Low `bits` of v as a signed value.
+inline int32_t SignExtend(int32_t v, uint32_t bits) {
+    const int32_t sign = 1 << (bits - 1);
+    return ((v & ((1 << bits) - 1)) ^ sign) - sign;
+}
+
+inline int32_t Wrap(int32_t v, uint32_t bits) {
+    return bits == 8 ? (v & 0xFF) : SignExtend(v, bits);
+}
+
+inline int16_t ZigZag(int32_t d, uint32_t bits) {
+    const int32_t s = SignExtend(d, bits);
+    return static_cast<int16_t>((s * 2) ^ (s >> 31));
+}
+
+inline int32_t UnZigZag(int32_t z) {
+    return (z >> 1) ^ -(z & 1);
+}
+
+// Scalar pieces, also the tails of the SIMD kernels.
+
+inline void ForwardPixels(const uint8_t* src, uint32_t xBegin, uint32_t xEnd, int16_t* y, int16_t* co, int16_t* cg, int16_t* a) {
+    for (uint32_t x = xBegin; x < xEnd; x++) {
+        const int32_t b = src[x * 4u + 0];
+        const int32_t g = src[x * 4u + 1];
+        const int32_t r = src[x * 4u + 2];
+        const int32_t c = r - b;
+        const int32_t t = b + (c >> 1);
+        const int32_t d = g - t;
+        y[x] = static_cast<int16_t>(t + (d >> 1));
+        co[x] = static_cast<int16_t>(c);
+        cg[x] = static_cast<int16_t>(d);
+        a[x] = static_cast<int16_t>(src[x * 4u + 3]);
+    }
+}
+
+inline void InversePixels(const int16_t* y, const int16_t* co, const int16_t* cg, const int16_t* a, uint32_t xBegin, uint32_t xEnd, uint8_t* dst) {
+    for (uint32_t x = xBegin; x < xEnd; x++) {
+        const int32_t t = y[x] - (cg[x] >> 1);
+        const int32_t g = cg[x] + t;
+        const int32_t b = t - (co[x] >> 1);
+        dst[x * 4u + 0] = static_cast<uint8_t>(b);
+        dst[x * 4u + 1] = static_cast<uint8_t>(g);
+        dst[x * 4u + 2] = static_cast<uint8_t>(b + co[x]);
+        dst[x * 4u + 3] = static_cast<uint8_t>(a[x]);
+    }
+}
+
+// cur[x] -= up[x] as zigzagged residuals.
+inline void ResidualUp(int16_t* cur, const int16_t* up, uint32_t xBegin, uint32_t xEnd, uint32_t bits) {
+    for (uint32_t x = xBegin; x < xEnd; x++) cur[x] = ZigZag(cur[x] - up[x], bits);
+}
+
+inline void ReconstructUp(int16_t* cur, const int16_t* up, uint32_t xBegin, uint32_t xEnd, uint32_t bits) {
+    for (uint32_t x = xBegin; x < xEnd; x++) cur[x] = static_cast<int16_t>(Wrap(up[x] + UnZigZag(cur[x]), bits));
+}
+
+// The first row, predicted from the left; right to left so it works in place.
+inline void ResidualLeft(int16_t* row, uint32_t w, uint32_t bits) {
+    for (uint32_t x = w; x-- > 1;) row[x] = ZigZag(row[x] - row[x - 1], bits);
+    row[0] = ZigZag(row[0], bits);
+}
+
+inline void ReconstructLeft(int16_t* row, uint32_t w, uint32_t bits) {
+    int32_t prev = 0;
+    for (uint32_t x = 0; x < w; x++) {
+        prev = Wrap(prev + UnZigZag(row[x]), bits);
+        row[x] = static_cast<int16_t>(prev);
+    }
+}
+
+inline void ZeroPadding(int16_t* planes, uint32_t w, uint32_t h) {
+    const uint32_t n = w * h;
+    const uint32_t values = CodecPlaneValues(w, h);
+    for (uint32_t p = 0; p < kCodecPlanes; p++) {
+        std::memset(planes + static_cast<size_t>(p) * values + n, 0, (values - n) * sizeof(int16_t));
+    }
+}
+
+} // namespace rj::detail
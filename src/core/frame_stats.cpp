@@ -0,0 +1,188 @@
+#include "core/frame_stats.h"
+
+#include <cstdio>
+
+namespace rj {
+
+namespace {
+
+int64_t MsToNs(double ms) {
+    return static_cast<int64_t>(ms * 1e6);
+}
+
+LatencyPercentiles TakePercentiles(LatencyRecorder& recorder, LatencyHistogram& scratch) {
+    scratch.Reset();
+    recorder.TakeInterval(scratch);
+    return SummarizeLatency(scratch);
+}
+
+} // namespace
+
+void FrameStatsWindow::Add(const FrameTimings& t) {
+    m_wait.Record(MsToNs(t.waitMs));
+    m_capture.Record(MsToNs(t.captureMs));
+    m_render.Record(MsToNs(t.renderMs));
+    m_present.Record(MsToNs(t.presentMs));
+    m_total.Record(MsToNs(t.totalMs));
+}
+
+void FrameStatsWindow::AddCopyToPresent(int64_t ns) {
+    m_copyToPresent.Record(ns);
+}
+
+FrameStatsSummary FrameStatsWindow::TakeAndReset() {
+    FrameStatsSummary s{};
+    s.wait = TakePercentiles(m_wait, m_snapshot);
+    s.capture = TakePercentiles(m_capture, m_snapshot);
+    s.render = TakePercentiles(m_render, m_snapshot);
+    s.present = TakePercentiles(m_present, m_snapshot);
+    s.total = TakePercentiles(m_total, m_snapshot);
+    s.copyToPresent = TakePercentiles(m_copyToPresent, m_snapshot);
+
+    s.frames = s.total.count;
+    s.avgTotalMs = s.total.avgUs / 1000.0;
+    s.avgWaitMs = s.wait.avgUs / 1000.0;
+    s.avgCaptureMs = s.capture.avgUs / 1000.0;
+    s.avgRenderMs = s.render.avgUs / 1000.0;
+    s.avgPresentMs = s.present.avgUs / 1000.0;
+    s.maxWaitMs = s.wait.maxUs / 1000.0;
+    s.maxPresentMs = s.present.maxUs / 1000.0;
+    s.maxTotalMs = s.total.maxUs / 1000.0;
+    return s;
+}
+
+int FormatStatsLine(char* buf, size_t bufSize, const StatsLineInfo& info) {
+    const FrameStatsSummary& s = info.summary;
+    const int n = snprintf(
+        buf,
+        bufSize,
+        "[rj_span] backend=%s ddmode=%s fps=%.1f Latency(uS)=%.0f size=%ux%u expected=%ux%u@%u avg(ms) total=%.2f wait=%.2f cap=%.2f render=%.2f present=%.2f max(ms) wait=%.2f present=%.2f total=%.2f",
+        info.backend,
+        info.ddMode,
+        static_cast<double>(info.fps),
+        static_cast<double>(info.latencyUs),
+        static_cast<unsigned>(info.width),
+        static_cast<unsigned>(info.height),
+        static_cast<unsigned>(info.expectedW),
+        static_cast<unsigned>(info.expectedH),
+        static_cast<unsigned>(info.expectedHz),
+        s.avgTotalMs,
+        s.avgWaitMs,
+        s.avgCaptureMs,
+        s.avgRenderMs,
+        s.avgPresentMs,
+        s.maxWaitMs,
+        s.maxPresentMs,
+        s.maxTotalMs);
+    if (n < 0 || static_cast<size_t>(n) >= bufSize) return n;
+
+    int total = n;
+    auto append = [&](int k) {
+        if (k < 0) return false;
+        total += k;
+        return static_cast<size_t>(total) < bufSize;
+    };
+    if (s.frames > 0) {
+        auto ms = [](double us) { return us / 1000.0; };
+        const size_t used = static_cast<size_t>(total);
+        const int k = snprintf(buf + used,
+                               bufSize - used,
+                               " p50/p99/p99.9(ms) wait=%.2f/%.2f/%.2f cap=%.2f/%.2f/%.2f render=%.2f/%.2f/%.2f present=%.2f/%.2f/%.2f total=%.2f/%.2f/%.2f",
+                               ms(s.wait.p50Us), ms(s.wait.p99Us), ms(s.wait.p999Us),
+                               ms(s.capture.p50Us), ms(s.capture.p99Us), ms(s.capture.p999Us),
+                               ms(s.render.p50Us), ms(s.render.p99Us), ms(s.render.p999Us),
+                               ms(s.present.p50Us), ms(s.present.p99Us), ms(s.present.p999Us),
+                               ms(s.total.p50Us), ms(s.total.p99Us), ms(s.total.p999Us));
+        if (!append(k)) return total;
+    }
+    if (s.copyToPresent.count > 0) {
+        const size_t used = static_cast<size_t>(total);
+        const int k = snprintf(buf + used, bufSize - used, " c2p(uS)=%.0f/%.0f/%.0f", s.copyToPresent.p50Us, s.copyToPresent.p99Us, s.copyToPresent.p999Us);
+        if (!append(k)) return total;
+    }
+    if (info.copyPercent >= 0.0f) {
+        const size_t used = static_cast<size_t>(total);
+        if (!append(snprintf(buf + used, bufSize - used, " copy(%%)=%.1f", static_cast<double>(info.copyPercent)))) return total;
+    }
+    if (info.tileSkewAvgUs >= 0.0f) {
+        const size_t used = static_cast<size_t>(total);
+        if (!append(snprintf(buf + used, bufSize - used, " skew(uS)=%.0f/%.0f", static_cast<double>(info.tileSkewAvgUs), static_cast<double>(info.tileSkewMaxUs)))) {
+            return total;
+        }
+    }
+    if (info.latchMarginUs >= 0.0f) {
+        const size_t used = static_cast<size_t>(total);
+        const int k = snprintf(buf + used,
+                               bufSize - used,
+                               " latch(uS)=%.0f/%.0f miss=%llu",
+                               static_cast<double>(info.latchMarginUs),
+                               static_cast<double>(info.latchSlackMinUs),
+                               static_cast<unsigned long long>(info.latchMisses));
+        if (!append(k)) return total;
+    }
+    if (info.assignFirstFrameMs >= 0.0f) {
+        const size_t used = static_cast<size_t>(total);
+        const int k = snprintf(buf + used,
+                               bufSize - used,
+                               " assign(ms)=%.1f/%.1f reuse=%llu/%llu",
+                               static_cast<double>(info.assignFirstFrameMs),
+                               static_cast<double>(info.assignDeviceMs),
+                               static_cast<unsigned long long>(info.deviceReuses),
+                               static_cast<unsigned long long>(info.assignments));
+        if (!append(k)) return total;
+    }
+    if (info.blitOutputsAvg >= 0.0f) {
+        const size_t used = static_cast<size_t>(total);
+        if (!append(snprintf(buf + used, bufSize - used, " blit=%.1f/%u", static_cast<double>(info.blitOutputsAvg), info.outputs))) return total;
+    }
+    if (info.gpuAvgMs >= 0.0f) {
+        const size_t used = static_cast<size_t>(total);
+        if (!append(snprintf(buf + used, bufSize - used, " gpu(ms)=%.2f/%.2f", static_cast<double>(info.gpuAvgMs), static_cast<double>(info.gpuMaxMs)))) {
+            return total;
+        }
+    }
+    if (info.holdMaxMs >= 0.0f) {
+        const size_t used = static_cast<size_t>(total);
+        const int k = snprintf(buf + used,
+                               bufSize - used,
+                               " hold(ms)=%.2f drawn=%llu copied=%llu overrun=%llu",
+                               static_cast<double>(info.holdMaxMs),
+                               static_cast<unsigned long long>(info.holdDrawn),
+                               static_cast<unsigned long long>(info.holdCopied),
+                               static_cast<unsigned long long>(info.holdOverruns));
+        if (!append(k)) return total;
+    }
+    if (info.passes > 0) {
+        const size_t used = static_cast<size_t>(total);
+        const int k = snprintf(buf + used,
+                               bufSize - used,
+                               " presented=%llu/%llu keepalive=%llu",
+                               static_cast<unsigned long long>(info.presents),
+                               static_cast<unsigned long long>(info.passes),
+                               static_cast<unsigned long long>(info.keepAlives));
+        if (!append(k)) return total;
+    }
+    if (info.presentOutputsAvg >= 0.0f) {
+        const size_t used = static_cast<size_t>(total);
+        if (!append(snprintf(buf + used, bufSize - used, " outputs=%.2f/%u", static_cast<double>(info.presentOutputsAvg), info.outputs))) {
+            return total;
+        }
+    }
+    if (info.readbacks > 0) {
+        const size_t used = static_cast<size_t>(total);
+        const int k = snprintf(buf + used,
+                               bufSize - used,
+                               " probe=%llu lat(fr)=%.1f/%llu drop=%llu colors=%u placeholder=%llu",
+                               static_cast<unsigned long long>(info.readbacks),
+                               static_cast<double>(info.readbackLatencyAvg),
+                               static_cast<unsigned long long>(info.readbackLatencyMax),
+                               static_cast<unsigned long long>(info.readbackDrops),
+                               info.probeColors,
+                               static_cast<unsigned long long>(info.placeholderProbes));
+        if (!append(k)) return total;
+    }
+    const size_t used = static_cast<size_t>(total);
+    return total + snprintf(buf + used, bufSize - used, "\n");
+}
+
+} // namespace rj
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/latency_histogram.h"
+
+namespace rj {
+
+// Per-frame timings measured by the render loop, in milliseconds.
+struct FrameTimings {
+    double waitMs{};
+    double captureMs{};
+    double renderMs{};
+    double presentMs{};
+    double totalMs{};
+};
+
+struct FrameStatsSummary {
+    uint64_t frames{};
+    double avgTotalMs{};
+    double avgWaitMs{};
+    double avgCaptureMs{};
+    double avgRenderMs{};
+    double avgPresentMs{};
+    double maxWaitMs{};
+    double maxPresentMs{};
+    double maxTotalMs{};
+
+    // Distributions over the window; copyToPresent only counts frames that showed a new copy.
+    LatencyPercentiles wait{};
+    LatencyPercentiles capture{};
+    LatencyPercentiles render{};
+    LatencyPercentiles present{};
+    LatencyPercentiles total{};
+    LatencyPercentiles copyToPresent{};
+};
+
+// Accumulates frame timings between two 1 Hz log lines in fixed-size latency histograms,
+// so the line can report tail percentiles and not just averages and maxima. Recording is
+// lock-free and allocation-free; any thread may record while another takes the window.
+class FrameStatsWindow {
+public:
+    void Add(const FrameTimings& t);
+    void AddCopyToPresent(int64_t ns);
+
+    // Returns the distributions of the samples added since the last call and starts a new window.
+    FrameStatsSummary TakeAndReset();
+
+private:
+    LatencyRecorder m_wait;
+    LatencyRecorder m_capture;
+    LatencyRecorder m_render;
+    LatencyRecorder m_present;
+    LatencyRecorder m_total;
+    LatencyRecorder m_copyToPresent;
+    LatencyHistogram m_snapshot;  // scratch for TakeAndReset(), kept to avoid a large stack frame
+};
+
+// Everything the once-per-second "[rj_span] backend=..." line prints.
+struct StatsLineInfo {
+    const char* backend{"-"};
+    const char* ddMode{"-"};
+    float fps{};
+    float latencyUs{-1.0f};
+    uint32_t width{};
+    uint32_t height{};
+    uint32_t expectedW{};
+    uint32_t expectedH{};
+    uint32_t expectedHz{};
+    FrameStatsSummary summary{};
+
+    // Share of captured pixels actually copied into the composite texture; omitted when < 0.
+    float copyPercent{-1.0f};
+
+    // Capture-timestamp spread between the tiles of the composites published this window
+    // (parallel per-monitor acquisition); omitted when < 0.
+    float tileSkewAvgUs{-1.0f};
+    float tileSkewMaxUs{};
+
+    // Late-latch scheduling: current safety margin, smallest slack to the vblank and missed
+    // vblanks this window; omitted when latchMarginUs < 0.
+    float latchMarginUs{-1.0f};
+    float latchSlackMinUs{};
+    uint64_t latchMisses{};
+
+    // IDD swap-chain assignment: latest assignment to its first processed frame, the device
+    // acquisition part of it, and assignments that reused a cached device; omitted when
+    // assignFirstFrameMs < 0.
+    float assignFirstFrameMs{-1.0f};
+    float assignDeviceMs{};
+    uint64_t assignments{};
+    uint64_t deviceReuses{};
+
+    // Outputs presented with a plain copy instead of the slicing shader, averaged per frame
+    // over the window, out of `outputs`; omitted when < 0.
+    float blitOutputsAvg{-1.0f};
+    uint32_t outputs{};
+
+    // GPU time of the per-output copies and draws (timestamp queries), average and worst
+    // frame this window; omitted when < 0.
+    float gpuAvgMs{-1.0f};
+    float gpuMaxMs{};
+
+    // Zero-copy Desktop Duplication: longest hold, frames released after every output drew
+    // them, frames copied at their deadline and holds that overran it; omitted when
+    // holdMaxMs < 0.
+    float holdMaxMs{-1.0f};
+    uint64_t holdDrawn{};
+    uint64_t holdCopied{};
+    uint64_t holdOverruns{};
+
+    // Present policy: passes that drew and presented out of all render loop passes, and
+    // how many of them were keep-alives without new content; omitted when passes == 0.
+    uint64_t presents{};
+    uint64_t passes{};
+    uint64_t keepAlives{};
+
+    // Outputs drawn and presented per presenting pass, out of `outputs` (per-output partial
+    // update); omitted when < 0.
+    float presentOutputsAvg{-1.0f};
+
+    // Per-frame content probe read back through a ReadbackQueue: results this window, their
+    // average and worst latency in frames, requests dropped for want of a free staging
+    // texture, distinct colours in the latest probe, and probes classified as placeholder
+    // frames; omitted when readbacks == 0.
+    uint64_t readbacks{};
+    float readbackLatencyAvg{};
+    uint64_t readbackLatencyMax{};
+    uint64_t readbackDrops{};
+    uint32_t probeColors{};
+    uint64_t placeholderProbes{};
+};
+
+// Enough for every optional field of the stats line.
+constexpr size_t kStatsLineBytes = 1024;
+
+// Formats the stats line (with trailing newline) into `buf`. Returns the snprintf result.
+int FormatStatsLine(char* buf, size_t bufSize, const StatsLineInfo& info);
+
+} // namespace rj
@@ -0,0 +1,126 @@
+#include "core/held_frame.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace rj {
+
+HeldFrameTracker::HeldFrameTracker(uint32_t outputs) : m_outputs(std::clamp<uint32_t>(outputs, 1, 32)) {}
+
+void HeldFrameTracker::SetOutputs(uint32_t outputs) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_outputs = std::clamp<uint32_t>(outputs, 1, 32);
+    }
+    m_changed.notify_all();
+}
+
+uint32_t HeldFrameTracker::Outputs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_outputs;
+}
+
+uint32_t HeldFrameTracker::FullMask() const {
+    return m_outputs >= 32 ? 0xFFFFFFFFu : ((1u << m_outputs) - 1u);
+}
+
+bool HeldFrameTracker::Publish(uint64_t frameId, int64_t nowNs, int64_t releaseByNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state != State::Empty || frameId == 0 || frameId <= m_frameId) return false;
+    m_state = State::Held;
+    m_frameId = frameId;
+    m_publishedNs = nowNs;
+    m_releaseByNs = releaseByNs;
+    m_drawnMask = 0;
+    m_overrunStartNs = -1;
+    m_stats.published++;
+    return true;
+}
+
+HoldDecision HeldFrameTracker::Poll(int64_t nowNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return PollLocked(nowNs);
+}
+
+HoldDecision HeldFrameTracker::Wait(int64_t nowNs) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const HoldDecision decision = PollLocked(nowNs);
+    if (decision != HoldDecision::Hold || m_state != State::Held) return decision;
+    if (m_sampling && nowNs >= m_releaseByNs) {
+        // Overrun: only the end of the pass can release it.
+        m_changed.wait(lock);
+    } else {
+        m_changed.wait_for(lock, std::chrono::nanoseconds(m_releaseByNs - nowNs));
+    }
+    return HoldDecision::Hold;
+}
+
+HoldDecision HeldFrameTracker::PollLocked(int64_t nowNs) {
+    if (m_state != State::Held) return HoldDecision::Hold;
+    if (m_sampling) {
+        // A pass is drawing it; never pull the frame from under it.
+        if (nowNs >= m_releaseByNs && m_overrunStartNs < 0) m_overrunStartNs = m_releaseByNs;
+        return HoldDecision::Hold;
+    }
+    const uint32_t full = FullMask();
+    if ((m_drawnMask & full) == full) {
+        m_state = State::Revoked;
+        m_stats.releasedDrawn++;
+        return HoldDecision::ReleaseDrawn;
+    }
+    if (nowNs >= m_releaseByNs) {
+        m_state = State::Revoked;
+        m_stats.releasedDeadline++;
+        return HoldDecision::ReleaseDeadline;
+    }
+    return HoldDecision::Hold;
+}
+
+void HeldFrameTracker::Released(int64_t nowNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state == State::Empty) return;
+    m_stats.maxHoldNs = std::max(m_stats.maxHoldNs, nowNs - m_publishedNs);
+    if (m_overrunStartNs >= 0 || nowNs > m_releaseByNs) {
+        m_stats.overruns++;
+        m_stats.maxOverrunNs = std::max(m_stats.maxOverrunNs, nowNs - m_releaseByNs);
+    }
+    m_state = State::Empty;
+    m_overrunStartNs = -1;
+}
+
+bool HeldFrameTracker::Holding() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_state != State::Empty;
+}
+
+uint64_t HeldFrameTracker::BeginSample() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state != State::Held) {
+        if (m_state == State::Revoked) m_stats.revokedSamples++;
+        return 0;
+    }
+    m_sampling = true;
+    return m_frameId;
+}
+
+void HeldFrameTracker::EndSample(uint64_t frameId, uint32_t drawnMask) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (frameId == 0 || frameId != m_frameId) return;
+        m_sampling = false;
+        m_drawnMask |= drawnMask;
+        const uint32_t full = FullMask();
+        wake = (m_drawnMask & full) == full || m_overrunStartNs >= 0;
+    }
+    if (wake) m_changed.notify_all();
+}
+
+HeldFrameStats HeldFrameTracker::TakeStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const HeldFrameStats s = m_stats;
+    m_stats = HeldFrameStats{};
+    return s;
+}
+
+} // namespace rj
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "core/clock.h"
+
+namespace rj {
+
+enum class HoldDecision {
+    Hold,             // keep the frame
+    ReleaseDrawn,     // every output drew it: release without a copy
+    ReleaseDeadline,  // the deadline came first: copy it somewhere durable, then release
+};
+
+struct HeldFrameStats {
+    uint64_t published{};
+    uint64_t releasedDrawn{};
+    uint64_t releasedDeadline{};
+    uint64_t revokedSamples{};  // BeginSample() calls that found the frame gone or going
+    uint64_t overruns{};        // frames held past the deadline because a draw was in flight
+    int64_t maxHoldNs{};
+    int64_t maxOverrunNs{};
+};
+
+// Ownership of a source frame that is sampled in place instead of being copied first, such
+// as an acquired Desktop Duplication frame: the capture thread holds it, the render thread
+// draws it, and it has to be released before the source wants to write the next update.
+//
+// The capture thread publishes the frame with a release deadline and waits. The render
+// thread brackets every pass that samples it with BeginSample()/EndSample(). The tracker
+// guarantees:
+// - no sample starts once the capture thread was told to release;
+// - the frame is never released while a pass samples it (the deadline waits for the pass,
+//   counted as an overrun);
+// - a frame every output drew is released right away, one that missed the deadline is
+//   released with ReleaseDeadline so the caller keeps its content.
+//
+// Both sides take `nowNs` from the caller, so Poll() runs the policy on a simulated clock.
+// Wait() blocks in real time and needs `nowNs` from a steady clock.
+class HeldFrameTracker {
+public:
+    // Outputs that must draw a frame before it counts as drawn (at most 32).
+    explicit HeldFrameTracker(uint32_t outputs = 3);
+
+    void SetOutputs(uint32_t outputs);
+    uint32_t Outputs() const;
+
+    // Capture thread. `frameId` must be nonzero and increasing. Returns false while the
+    // previous frame has not been Released().
+    bool Publish(uint64_t frameId, int64_t nowNs, int64_t releaseByNs);
+    // Once Poll() returns a release, the frame is revoked: the caller must release it and
+    // then call Released().
+    HoldDecision Poll(int64_t nowNs);
+    // Poll(), but on Hold first blocks until EndSample() may have changed the answer or the
+    // release deadline passes, then returns Hold: call it in a loop with a fresh `nowNs`.
+    HoldDecision Wait(int64_t nowNs);
+    void Released(int64_t nowNs);
+    bool Holding() const;
+
+    // Render thread. Returns the id of the held frame and starts sampling it, or 0 when there
+    // is none or it is being released. Every nonzero id needs an EndSample().
+    uint64_t BeginSample();
+    // `drawnMask`: bit i set when output i drew the frame in this pass.
+    void EndSample(uint64_t frameId, uint32_t drawnMask);
+
+    // Stats since the last call.
+    HeldFrameStats TakeStats();
+
+private:
+    enum class State { Empty, Held, Revoked };
+
+    uint32_t FullMask() const;
+    HoldDecision PollLocked(int64_t nowNs);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;  // the frame became drawn, or an overrun pass ended
+    uint32_t m_outputs;
+    State m_state{State::Empty};
+    uint64_t m_frameId{};
+    int64_t m_publishedNs{};
+    int64_t m_releaseByNs{};
+    uint32_t m_drawnMask{};
+    bool m_sampling{};
+    int64_t m_overrunStartNs{-1};
+    HeldFrameStats m_stats{};
+};
+
+} // namespace rj
@@ -0,0 +1,295 @@
+#include "core/instant_replay.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+namespace rj {
+
+namespace {
+
+constexpr uint64_t kNoRoom = UINT64_MAX;
+
+InstantReplayConfig Normalized(const InstantReplayConfig& cfg) {
+    InstantReplayConfig c = cfg;
+    // Records are 8-byte aligned and never straddle the two parts.
+    c.memoryBytes &= ~uint64_t{7};
+    c.spillBytes &= ~uint64_t{7};
+    c.keyframeInterval = std::max(c.keyframeInterval, 1u);
+    c.codec.keyframeInterval = c.keyframeInterval;
+    return c;
+}
+
+} // namespace
+
+InstantReplayRing::InstantReplayRing(const InstantReplayConfig& cfg) : m_cfg(Normalized(cfg)), m_encoder(m_cfg.codec) {}
+
+InstantReplayRing::~InstantReplayRing() {
+    Stop();
+}
+
+bool InstantReplayRing::Start() {
+    Stop();
+    m_capacity = m_cfg.memoryBytes + m_cfg.spillBytes;
+    if (m_capacity == 0) return false;
+    if (m_cfg.memoryBytes != 0) {
+        // Not zero-filled: pages are only committed as the ring first reaches them.
+        m_memory.reset(new (std::nothrow) uint8_t[m_cfg.memoryBytes]);
+        if (!m_memory) return false;
+    }
+    if (m_cfg.spillBytes != 0 && !m_spill.Create(m_cfg.spillPath.c_str(), static_cast<size_t>(m_cfg.spillBytes))) {
+        m_memory.reset();
+        return false;
+    }
+    m_tail = 0;
+    m_entries.clear();
+    m_held = InstantReplayStats{};
+    m_encoder.ForceKeyframe();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats = InstantReplayStats{};
+        m_stop = false;
+        m_hasFrame = false;
+        m_lastAccepted = false;
+        m_saveBase.clear();
+        m_haveResult = false;
+    }
+    m_worker = std::thread([this] { WorkerMain(); });
+    m_running.store(true, std::memory_order_release);
+    return true;
+}
+
+void InstantReplayRing::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_worker.joinable()) return;
+        m_stop = true;
+    }
+    m_running.store(false, std::memory_order_release);
+    m_cv.notify_all();
+    m_worker.join();
+    m_entries.clear();
+    m_memory.reset();
+    if (m_spill.Valid()) {
+        m_spill.Close();
+        std::remove(m_cfg.spillPath.c_str());
+    }
+}
+
+bool InstantReplayRing::Submit(const FrameDesc& f, int64_t acquireTimeNs) {
+    if (!f.pixels || f.width == 0 || f.height == 0 || BytesPerPixel(f.format) != 4) return false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) return false;
+        if (m_borrowed.load(std::memory_order_relaxed) || !m_saveBase.empty()) {
+            m_stats.dropped++;
+            m_lastAccepted = false;
+            return false;
+        }
+        const uint32_t count = f.dirtyRects ? f.dirtyRectCount : 0;
+        m_frame = f;
+        m_frameRects.assign(f.dirtyRects, f.dirtyRects + count);
+        m_frameAcquireNs = acquireTimeNs;
+        // The rects only describe the change from the frame the encoder saw last.
+        m_damageKnown = m_lastAccepted && count != 0;
+        m_lastAccepted = true;
+        m_hasFrame = true;
+        m_borrowed.store(true, std::memory_order_release);
+    }
+    m_cv.notify_one();
+    return true;
+}
+
+void InstantReplayRing::WaitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCv.wait(lock, [&] { return !m_borrowed.load(std::memory_order_relaxed); });
+}
+
+bool InstantReplayRing::Save(const char* basePath) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop || !m_saveBase.empty()) return false;
+        m_saveBase = basePath;
+    }
+    m_cv.notify_one();
+    return true;
+}
+
+bool InstantReplayRing::TakeSaveResult(InstantReplaySave& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_haveResult) return false;
+    out = m_result;
+    m_haveResult = false;
+    return true;
+}
+
+InstantReplayStats InstantReplayRing::Stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void InstantReplayRing::WorkerMain() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_cv.wait(lock, [&] { return m_stop || m_hasFrame || !m_saveBase.empty(); });
+        if (m_stop) break;
+        if (m_hasFrame) {
+            m_hasFrame = false;
+            lock.unlock();
+            Store();
+            m_held.heldFrames = m_entries.size();
+            m_held.spanNs = m_entries.empty() ? 0 : m_entries.back().acquireTimeNs - m_entries.front().acquireTimeNs;
+            lock.lock();
+            const uint64_t dropped = m_stats.dropped;
+            m_stats = m_held;
+            m_stats.dropped = dropped;
+            m_borrowed.store(false, std::memory_order_release);
+            m_idleCv.notify_all();
+            continue;
+        }
+        const std::string base = m_saveBase;
+        lock.unlock();
+        InstantReplaySave result = WriteSave(base);
+        lock.lock();
+        m_result = std::move(result);
+        m_haveResult = true;
+        m_saveBase.clear();
+    }
+    m_hasFrame = false;
+    m_borrowed.store(false, std::memory_order_release);
+    m_idleCv.notify_all();
+}
+
+uint8_t* InstantReplayRing::At(uint64_t offset) const {
+    return offset < m_cfg.memoryBytes ? m_memory.get() + offset : m_spill.Data() + (offset - m_cfg.memoryBytes);
+}
+
+// Where a record of `bytes` goes: at the tail, or at the start of the next part when the
+// rest of the tail's part is too short.
+uint64_t InstantReplayRing::Place(uint64_t bytes) const {
+    uint64_t pos = m_tail >= m_capacity ? 0 : m_tail;
+    for (int tries = 0; tries < 3; tries++) {
+        const uint64_t end = pos < m_cfg.memoryBytes ? m_cfg.memoryBytes : m_capacity;
+        if (end - pos >= bytes) return pos;
+        pos = end == m_capacity ? 0 : end;
+    }
+    return kNoRoom;
+}
+
+// Drops the oldest keyframe group, so the held records still start at a keyframe.
+void InstantReplayRing::EvictGroup() {
+    do {
+        const Entry& e = m_entries.front();
+        (e.offset < m_cfg.memoryBytes ? m_held.memoryBytes : m_held.spillBytes) -= e.bytes;
+        m_held.evicted++;
+        m_entries.pop_front();
+    } while (!m_entries.empty() && !m_entries.front().keyframe);
+}
+
+void InstantReplayRing::Store() {
+    const FrameDesc& f = m_frame;
+    const uint32_t rectCount = static_cast<uint32_t>(m_frameRects.size());
+
+    // Groups that ended before the window are gone.
+    for (;;) {
+        size_t next = 1;
+        while (next < m_entries.size() && !m_entries[next].keyframe) next++;
+        if (next >= m_entries.size() || m_entries[next].acquireTimeNs > m_frameAcquireNs - m_cfg.windowNs) break;
+        EvictGroup();
+    }
+
+    if (m_entries.empty()) m_encoder.ForceKeyframe();
+    EncodeStats es;
+    auto encode = [&] {
+        const Rect* damage = m_damageKnown ? m_frameRects.data() : nullptr;
+        return m_encoder.Encode(f.pixels, f.strideBytes, f.width, f.height, m_coded, &es, damage, damage ? rectCount : 0);
+    };
+    if (!encode()) return;
+    const uint64_t rectBytes = static_cast<uint64_t>(rectCount) * sizeof(Rect);
+    auto recordBytes = [&] { return (sizeof(RecordHeader) + rectBytes + m_coded.size() + 7) & ~uint64_t{7}; };
+
+    uint64_t pos = kNoRoom;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        pos = recordBytes() <= UINT32_MAX ? Place(recordBytes()) : kNoRoom;
+        if (pos == kNoRoom) break;
+        // Evict everything between the tail and the end of the record, padding included.
+        const uint64_t end = pos + recordBytes();
+        const uint64_t used = pos >= m_tail ? end - m_tail : m_capacity - m_tail + end;
+        while (!m_entries.empty()) {
+            const uint64_t o = m_entries.front().offset;
+            if ((o >= m_tail ? o - m_tail : m_capacity - m_tail + o) >= used) break;
+            EvictGroup();
+        }
+        if (!m_entries.empty() || es.keyframe) break;
+        // The group this frame belongs to is gone; it has to start a new one.
+        m_encoder.ForceKeyframe();
+        if (!encode()) return;
+    }
+    if (pos == kNoRoom) {
+        // Not stored, so the next frame can't be coded against it.
+        m_held.oversized++;
+        m_encoder.ForceKeyframe();
+        return;
+    }
+
+    const uint64_t bytes = recordBytes();
+    uint8_t* dst = At(pos);
+    RecordHeader h{};
+    h.magic = kRecordMagic;
+    h.bytes = static_cast<uint32_t>(bytes);
+    h.sequence = f.sequence;
+    h.captureTimeNs = f.captureTimeNs;
+    h.acquireTimeNs = m_frameAcquireNs;
+    h.width = f.width;
+    h.height = f.height;
+    h.format = static_cast<uint32_t>(f.format);
+    h.accumulatedFrames = f.accumulatedFrames;
+    h.dirtyRectCount = rectCount;
+    h.strideBytes = f.width * 4u;
+    h.payloadBytes = static_cast<uint32_t>(m_coded.size());
+    h.payload = static_cast<uint8_t>(RecordPayload::Codec);
+    std::memcpy(dst, &h, sizeof(h));
+    if (rectBytes) std::memcpy(dst + sizeof(h), m_frameRects.data(), rectBytes);
+    std::memcpy(dst + sizeof(h) + rectBytes, m_coded.data(), m_coded.size());
+
+    m_entries.push_back(Entry{pos, h.bytes, es.keyframe, m_frameAcquireNs});
+    m_tail = pos + bytes;
+    (pos < m_cfg.memoryBytes ? m_held.memoryBytes : m_held.spillBytes) += bytes;
+    m_held.frames++;
+}
+
+// One indexed segment holding the records in order; they are already in the file layout.
+InstantReplaySave InstantReplayRing::WriteSave(const std::string& basePath) const {
+    InstantReplaySave r;
+    r.basePath = basePath;
+    if (m_entries.empty()) return r;
+    uint64_t bytes = sizeof(RecordSegmentHeader) + m_entries.size() * sizeof(RecordIndexEntry);
+    for (const Entry& e : m_entries) bytes += e.bytes;
+    MappedFile file;
+    if (!file.Create(RecordingSegmentPath(basePath, 0).c_str(), static_cast<size_t>(bytes))) return r;
+
+    std::vector<RecordIndexEntry> index;
+    index.reserve(m_entries.size());
+    uint64_t used = sizeof(RecordSegmentHeader);
+    for (const Entry& e : m_entries) {
+        std::memcpy(file.Data() + used, At(e.offset), e.bytes);
+        index.push_back(RecordIndexEntry{used, e.acquireTimeNs});
+        used += e.bytes;
+    }
+    std::memcpy(file.Data() + used, index.data(), index.size() * sizeof(RecordIndexEntry));
+    RecordSegmentHeader h{};
+    std::memcpy(h.magic, kRecordSegmentMagic, sizeof(h.magic));
+    h.version = kRecordingVersion;
+    h.segment = 0;
+    h.indexOffset = used;
+    h.frameCount = static_cast<uint32_t>(m_entries.size());
+    std::memcpy(file.Data(), &h, sizeof(h));
+    r.ok = file.Finish(static_cast<size_t>(bytes));
+    r.frames = m_entries.size();
+    r.bytes = bytes;
+    r.spanNs = m_entries.back().acquireTimeNs - m_entries.front().acquireTimeNs;
+    return r;
+}
+
+} // namespace rj
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/clock.h"
+#include "core/frame.h"
+#include "core/frame_codec.h"
+#include "core/mapped_file.h"
+#include "core/recording.h"
+
+namespace rj {
+
+struct InstantReplayConfig {
+    // Frames further than this behind the newest are evicted, a keyframe group at a time.
+    int64_t windowNs = 30 * kNsPerSec;
+    // The ring is `memoryBytes` of RAM followed by `spillBytes` of a file created at
+    // `spillPath` when the ring starts (0: RAM only). Both are allocated once; the oldest
+    // groups are evicted when a frame does not fit.
+    uint64_t memoryBytes = 512ull << 20;
+    uint64_t spillBytes = 0;
+    std::string spillPath = "rj_replay_ring.spill";
+    // Frames per keyframe group. Eviction drops whole groups, so a saved span can be up to
+    // one group longer than the window.
+    uint32_t keyframeInterval = 60;
+    CodecConfig codec{};
+};
+
+struct InstantReplayStats {
+    uint64_t frames{};     // stored
+    uint64_t dropped{};    // Submit() while the previous frame or a save was in progress
+    uint64_t evicted{};
+    uint64_t oversized{};  // coded larger than either part of the ring
+    uint64_t heldFrames{};
+    uint64_t memoryBytes{};  // of the held records, in RAM
+    uint64_t spillBytes{};   // and in the spill file
+    int64_t spanNs{};        // oldest to newest held acquire time
+};
+
+struct InstantReplaySave {
+    bool ok{};
+    std::string basePath;
+    uint64_t frames{};
+    uint64_t bytes{};
+    int64_t spanNs{};
+};
+
+// Keeps the last InstantReplayConfig::windowNs of captured frames, delta-coded with
+// FrameEncoder, in a fixed-size ring, and saves them as a recording (see recording.h)
+// when asked. Submit() lends the frame's pixels to a worker thread instead of copying
+// them and never waits: a frame that arrives while the worker is busy is dropped. The held
+// records always start at a keyframe, so a save replays with ReplaySource on its own.
+class InstantReplayRing {
+public:
+    explicit InstantReplayRing(const InstantReplayConfig& cfg = InstantReplayConfig{});
+    ~InstantReplayRing();
+
+    InstantReplayRing(const InstantReplayRing&) = delete;
+    InstantReplayRing& operator=(const InstantReplayRing&) = delete;
+
+    // Allocates the ring and the spill file. Fails if the spill file can't be created.
+    bool Start();
+    // Drops what is held, frees the ring and removes the spill file.
+    void Stop();
+    bool Running() const { return m_running.load(std::memory_order_acquire); }
+
+    // One feeding thread. `f.pixels` (4-byte format) must stay valid until Idle(); dirty
+    // rects, if any, are relative to the previously submitted frame and copied. Returns
+    // false if the frame was dropped.
+    bool Submit(const FrameDesc& f, int64_t acquireTimeNs);
+    // The last submitted frame's pixels are no longer used.
+    bool Idle() const { return !m_borrowed.load(std::memory_order_acquire); }
+    void WaitIdle();
+
+    // Writes what is held to <basePath>_0000.rjr on the worker thread. False if the ring
+    // is not running or a save is already pending.
+    bool Save(const char* basePath);
+    // The outcome of the last save, once.
+    bool TakeSaveResult(InstantReplaySave& out);
+
+    InstantReplayStats Stats() const;
+    const InstantReplayConfig& Config() const { return m_cfg; }
+
+private:
+    struct Entry {
+        uint64_t offset{};
+        uint32_t bytes{};
+        bool keyframe{};
+        int64_t acquireTimeNs{};
+    };
+
+    void WorkerMain();
+    void Store();
+    uint64_t Place(uint64_t bytes) const;
+    void EvictGroup();
+    uint8_t* At(uint64_t offset) const;
+    InstantReplaySave WriteSave(const std::string& basePath) const;
+
+    InstantReplayConfig m_cfg;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_borrowed{false};
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_idleCv;
+    bool m_stop{true};
+    bool m_hasFrame{};
+    std::string m_saveBase;
+    bool m_haveResult{};
+    InstantReplaySave m_result;
+    InstantReplayStats m_stats;
+    std::thread m_worker;
+
+    // Handed from Submit() to the worker.
+    FrameDesc m_frame{};
+    int64_t m_frameAcquireNs{};
+    std::vector<Rect> m_frameRects;
+    bool m_damageKnown{};
+    bool m_lastAccepted{};
+
+    // Worker thread.
+    std::unique_ptr<uint8_t[]> m_memory;
+    MappedFile m_spill;
+    uint64_t m_capacity{};
+    uint64_t m_tail{};  // where the next record goes
+    std::deque<Entry> m_entries;
+    InstantReplayStats m_held;  // published to m_stats after each frame, but for `dropped`
+    FrameEncoder m_encoder;
+    std::vector<uint8_t> m_coded;
+};
+
+} // namespace rj
@@ -0,0 +1,171 @@
+#include "core/late_latch.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rj {
+
+namespace {
+
+// Observations further than this share of a period from the fitted grid are treated as
+// late wakeups, not vblanks; this many in a row means the grid itself moved.
+constexpr double kOutlierFraction = 0.25;
+constexpr uint32_t kOutliersBeforeReset = 3;
+
+// Fitted periods outside nominal +-5% are rejected (the observations skipped too much to
+// assign vblank indices reliably).
+constexpr double kMaxPeriodError = 0.05;
+
+} // namespace
+
+VblankPredictor::VblankPredictor(int64_t nominalPeriodNs) : m_nominalNs(nominalPeriodNs), m_periodNs(static_cast<double>(nominalPeriodNs)) {}
+
+void VblankPredictor::Reset(int64_t nominalPeriodNs) {
+    m_nominalNs = nominalPeriodNs;
+    m_periodNs = static_cast<double>(nominalPeriodNs);
+    m_anchorNs = 0;
+    m_jitterNs = 0.0;
+    m_next = 0;
+    m_count = 0;
+    m_outliers = 0;
+}
+
+void VblankPredictor::AddVblank(int64_t vblankNs) {
+    if (m_count > 0) {
+        const int64_t last = m_samples[(m_next + kWindow - 1) % kWindow];
+        if (vblankNs <= last) return;
+
+        const double rel = static_cast<double>(vblankNs - m_anchorNs) / m_periodNs;
+        const double offGrid = std::fabs(rel - std::round(rel)) * m_periodNs;
+        if (m_count >= 2 && offGrid > kOutlierFraction * m_periodNs) {
+            if (++m_outliers < kOutliersBeforeReset) return;
+            Reset(m_nominalNs);
+        }
+    }
+    m_outliers = 0;
+    m_samples[m_next] = vblankNs;
+    m_next = (m_next + 1) % kWindow;
+    m_count = std::min(m_count + 1, kWindow);
+    Refit();
+}
+
+void VblankPredictor::Refit() {
+    const uint32_t first = (m_next + kWindow - m_count) % kWindow;
+    const int64_t t0 = m_samples[first];
+    const int64_t last = m_samples[(m_next + kWindow - 1) % kWindow];
+    if (m_count < 2) {
+        m_anchorNs = last;
+        return;
+    }
+
+    // Least squares t = a + b * k over (vblank index, time since the oldest sample).
+    double sk = 0.0, sx = 0.0, skk = 0.0, skx = 0.0;
+    for (uint32_t i = 0; i < m_count; i++) {
+        const double x = static_cast<double>(m_samples[(first + i) % kWindow] - t0);
+        const double k = std::round(x / m_periodNs);
+        sk += k;
+        sx += x;
+        skk += k * k;
+        skx += k * x;
+    }
+    const double n = static_cast<double>(m_count);
+    const double den = n * skk - sk * sk;
+    if (den <= 0.0) {
+        m_anchorNs = last;
+        return;
+    }
+    const double b = (n * skx - sk * sx) / den;
+    const double nominal = static_cast<double>(m_nominalNs);
+    if (std::fabs(b - nominal) > kMaxPeriodError * nominal) {
+        // Keep the newest observation as the phase and start over from the nominal period.
+        m_periodNs = nominal;
+        m_samples[first] = last;
+        m_next = (first + 1) % kWindow;
+        m_count = 1;
+        m_anchorNs = last;
+        m_jitterNs = 0.0;
+        return;
+    }
+    const double a = (sx - b * sk) / n;
+
+    double sq = 0.0;
+    double kLast = 0.0;
+    for (uint32_t i = 0; i < m_count; i++) {
+        const double x = static_cast<double>(m_samples[(first + i) % kWindow] - t0);
+        const double k = std::round(x / m_periodNs);
+        const double r = x - (a + b * k);
+        sq += r * r;
+        kLast = k;
+    }
+    m_periodNs = b;
+    m_jitterNs = std::sqrt(sq / n);
+    m_anchorNs = t0 + std::llround(a + b * kLast);
+}
+
+int64_t VblankPredictor::NextVblankAfterNs(int64_t tNs) const {
+    const double n = std::floor(static_cast<double>(tNs - m_anchorNs) / m_periodNs) + 1.0;
+    int64_t v = m_anchorNs + std::llround(n * m_periodNs);
+    // Rounding can land on or just before `tNs`.
+    while (v <= tNs) v += std::llround(m_periodNs);
+    return v;
+}
+
+LateLatchScheduler::LateLatchScheduler(int64_t nominalPeriodNs, const LateLatchConfig& cfg)
+    : m_cfg(cfg), m_predictor(nominalPeriodNs), m_marginNs(cfg.marginNs) {}
+
+void LateLatchScheduler::Reset(int64_t nominalPeriodNs) {
+    m_predictor.Reset(nominalPeriodNs);
+    m_marginNs = m_cfg.marginNs;
+    m_cleanFrames = 0;
+    m_costs.fill(0);
+    m_costNext = 0;
+}
+
+int64_t LateLatchScheduler::SubmitCostNs() const {
+    return *std::max_element(m_costs.begin(), m_costs.end());
+}
+
+LatchPlan LateLatchScheduler::Plan(int64_t nowNs) const {
+    LatchPlan plan;
+    if (!m_predictor.HasSamples()) {
+        plan.vblankNs = nowNs + m_predictor.NominalPeriodNs();
+        plan.latchNs = nowNs;
+        return plan;
+    }
+    const int64_t lead = m_marginNs + SubmitCostNs();
+    plan.vblankNs = m_predictor.NextVblankAfterNs(nowNs);
+    while (plan.vblankNs - lead < nowNs) plan.vblankNs = m_predictor.NextVblankAfterNs(plan.vblankNs);
+    plan.latchNs = plan.vblankNs - lead;
+    return plan;
+}
+
+bool LateLatchScheduler::OnSubmitted(const LatchPlan& plan, int64_t latchedNs, int64_t submittedNs) {
+    m_costs[m_costNext] = std::max<int64_t>(0, submittedNs - latchedNs);
+    m_costNext = (m_costNext + 1) % kCostWindow;
+
+    const bool miss = submittedNs >= plan.vblankNs;
+    m_stats.frames++;
+    if (miss) {
+        m_stats.misses++;
+        m_cleanFrames = 0;
+        if (m_cfg.adaptive) m_marginNs = std::min(m_marginNs + m_cfg.marginStepNs, m_cfg.maxMarginNs);
+    } else {
+        const int64_t slack = plan.vblankNs - submittedNs;
+        if (m_stats.frames - m_stats.misses == 1 || slack < m_stats.slackMinNs) m_stats.slackMinNs = slack;
+        m_stats.slackSumNs += slack;
+        if (m_cfg.adaptive && ++m_cleanFrames >= m_cfg.decayFrames) {
+            m_marginNs = std::max(m_marginNs - m_cfg.marginStepNs / 4, m_cfg.minMarginNs);
+            m_cleanFrames = 0;
+        }
+    }
+    return miss;
+}
+
+LateLatchStats LateLatchScheduler::TakeStats() {
+    LateLatchStats s = m_stats;
+    s.marginNs = m_marginNs;
+    m_stats = LateLatchStats{};
+    return s;
+}
+
+} // namespace rj
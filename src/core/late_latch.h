@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "core/clock.h"
+
+namespace rj {
+
+// Estimates the display's vblank grid (period and phase) from observed vblank times, such
+// as when the frame-latency waitable fired or DXGI_FRAME_STATISTICS::SyncQPCTime.
+// Observations may skip vblanks. The grid is a least-squares fit over the last kWindow
+// observations, so it tracks displays that run slightly off their nominal rate (119.88 Hz).
+class VblankPredictor {
+public:
+    static constexpr uint32_t kWindow = 64;
+
+    explicit VblankPredictor(int64_t nominalPeriodNs);
+
+    // Forgets every observation, e.g. after a mode change.
+    void Reset(int64_t nominalPeriodNs);
+    void AddVblank(int64_t vblankNs);
+
+    // First vblank strictly after `tNs`. Only meaningful once HasSamples().
+    int64_t NextVblankAfterNs(int64_t tNs) const;
+
+    bool HasSamples() const { return m_count > 0; }
+    double PeriodNs() const { return m_periodNs; }
+    int64_t NominalPeriodNs() const { return m_nominalNs; }
+    // RMS distance of the observations from the fitted grid.
+    double JitterNs() const { return m_jitterNs; }
+
+private:
+    void Refit();
+
+    int64_t m_nominalNs;
+    double m_periodNs;
+    int64_t m_anchorNs{};  // a vblank on the fitted grid
+    double m_jitterNs{};
+    std::array<int64_t, kWindow> m_samples{};
+    uint32_t m_next{};
+    uint32_t m_count{};
+    uint32_t m_outliers{};
+};
+
+struct LateLatchConfig {
+    // Gap kept between the end of submission and the predicted vblank. With `adaptive` it
+    // grows by `marginStepNs` on every miss and shrinks by a quarter step after
+    // `decayFrames` frames in a row without one.
+    int64_t marginNs = 1 * kNsPerMs;
+    bool adaptive = true;
+    int64_t minMarginNs = 250 * kNsPerUs;
+    int64_t maxMarginNs = 6 * kNsPerMs;
+    int64_t marginStepNs = 500 * kNsPerUs;
+    uint32_t decayFrames = 240;
+};
+
+struct LatchPlan {
+    int64_t vblankNs{};  // vblank this frame is meant to be shown at
+    int64_t latchNs{};   // take the newest capture at this time, then draw and present
+};
+
+struct LateLatchStats {
+    uint64_t frames{};
+    uint64_t misses{};     // submission finished at or after the targeted vblank
+    int64_t marginNs{};    // current margin
+    int64_t slackSumNs{};  // targeted vblank - submission end, over frames that made it
+    int64_t slackMinNs{};
+
+    double AvgSlackUs() const { return frames > misses ? NsToUs(slackSumNs) / static_cast<double>(frames - misses) : 0.0; }
+};
+
+// Late-latch scheduling: instead of taking the latest capture right after the frame-latency
+// wait and then idling until the vblank, sleep until just before the predicted vblank and
+// take it then. The latch time is vblank - margin - submit cost, where the submit cost is
+// the slowest latch-to-submitted time of the last kCostWindow frames.
+class LateLatchScheduler {
+public:
+    static constexpr uint32_t kCostWindow = 32;
+
+    explicit LateLatchScheduler(int64_t nominalPeriodNs, const LateLatchConfig& cfg = {});
+
+    void Reset(int64_t nominalPeriodNs);
+    void OnVblank(int64_t vblankNs) { m_predictor.AddVblank(vblankNs); }
+
+    // Picks the earliest vblank that can still be made from `nowNs`. Before the first
+    // observation the plan is to latch immediately.
+    LatchPlan Plan(int64_t nowNs) const;
+
+    // Reports how the planned frame went. `latchedNs` is when the capture was taken,
+    // `submittedNs` when the last Present() returned. Returns true on a miss.
+    bool OnSubmitted(const LatchPlan& plan, int64_t latchedNs, int64_t submittedNs);
+
+    int64_t MarginNs() const { return m_marginNs; }
+    int64_t SubmitCostNs() const;
+    const VblankPredictor& Predictor() const { return m_predictor; }
+
+    // Stats since the last call.
+    LateLatchStats TakeStats();
+
+private:
+    LateLatchConfig m_cfg;
+    VblankPredictor m_predictor;
+    int64_t m_marginNs;
+    uint32_t m_cleanFrames{};
+    std::array<int64_t, kCostWindow> m_costs{};
+    uint32_t m_costNext{};
+    LateLatchStats m_stats{};
+};
+
+} // namespace rj
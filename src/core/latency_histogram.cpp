@@ -0,0 +1,123 @@
+#include "core/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "core/clock.h"
+
+namespace rj {
+
+namespace {
+
+uint32_t HighestBit(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanReverse64(&index, v);
+    return static_cast<uint32_t>(index);
+#else
+    return 63u - static_cast<uint32_t>(__builtin_clzll(v));
+#endif
+}
+
+uint64_t ClampSample(int64_t valueNs) {
+    if (valueNs < 0) return 0;
+    return std::min(static_cast<uint64_t>(valueNs), LatencyBuckets::kMaxValue);
+}
+
+} // namespace
+
+uint32_t LatencyBuckets::IndexOf(uint64_t v) {
+    if (v > kMaxValue) v = kMaxValue;
+    if (v < kSubBucketCount) return static_cast<uint32_t>(v);
+    const uint32_t msb = HighestBit(v);
+    const uint32_t shift = msb - kSubBucketBits + 1;
+    return kSubBucketCount + (msb - kSubBucketBits) * kSubBucketHalf + static_cast<uint32_t>((v >> shift) - kSubBucketHalf);
+}
+
+uint64_t LatencyBuckets::LowestValueAt(uint32_t index) {
+    if (index < kSubBucketCount) return index;
+    const uint32_t j = index - kSubBucketCount;
+    const uint32_t shift = j / kSubBucketHalf + 1;
+    return static_cast<uint64_t>(j % kSubBucketHalf + kSubBucketHalf) << shift;
+}
+
+uint64_t LatencyBuckets::HighestValueAt(uint32_t index) {
+    if (index < kSubBucketCount) return index;
+    const uint32_t shift = (index - kSubBucketCount) / kSubBucketHalf + 1;
+    return LowestValueAt(index) + (uint64_t{1} << shift) - 1;
+}
+
+void LatencyHistogram::Record(int64_t valueNs) {
+    const uint64_t v = ClampSample(valueNs);
+    m_counts[LatencyBuckets::IndexOf(v)]++;
+    m_count++;
+    m_sum += v;
+    m_max = std::max(m_max, v);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+    for (uint32_t i = 0; i < LatencyBuckets::kCount; i++) m_counts[i] += other.m_counts[i];
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_max = std::max(m_max, other.m_max);
+}
+
+void LatencyHistogram::Reset() {
+    m_counts.fill(0);
+    m_count = 0;
+    m_sum = 0;
+    m_max = 0;
+}
+
+int64_t LatencyHistogram::ValueAtPercentileNs(double percentile) const {
+    if (m_count == 0) return 0;
+    const double p = std::min(std::max(percentile, 0.0), 100.0);
+    uint64_t target = static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(m_count)));
+    target = std::max<uint64_t>(target, 1);
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < LatencyBuckets::kCount; i++) {
+        seen += m_counts[i];
+        if (seen >= target) return static_cast<int64_t>(std::min(LatencyBuckets::HighestValueAt(i), m_max));
+    }
+    return static_cast<int64_t>(m_max);
+}
+
+void LatencyRecorder::Record(int64_t valueNs) {
+    const uint64_t v = ClampSample(valueNs);
+    m_counts[LatencyBuckets::IndexOf(v)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(v, std::memory_order_relaxed);
+    uint64_t prev = m_max.load(std::memory_order_relaxed);
+    while (v > prev && !m_max.compare_exchange_weak(prev, v, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyRecorder::TakeInterval(LatencyHistogram& out) {
+    for (uint32_t i = 0; i < LatencyBuckets::kCount; i++) {
+        // Most buckets are empty; only pay for the exchange on the ones that are not.
+        if (m_counts[i].load(std::memory_order_relaxed) == 0) continue;
+        const uint64_t n = m_counts[i].exchange(0, std::memory_order_relaxed);
+        out.m_counts[i] += n;
+        out.m_count += n;
+    }
+    out.m_sum += m_sum.exchange(0, std::memory_order_relaxed);
+    out.m_max = std::max(out.m_max, m_max.exchange(0, std::memory_order_relaxed));
+}
+
+LatencyPercentiles SummarizeLatency(const LatencyHistogram& h) {
+    LatencyPercentiles s;
+    s.count = h.Count();
+    if (s.count == 0) return s;
+    s.avgUs = h.MeanNs() / 1e3;
+    s.p50Us = NsToUs(h.ValueAtPercentileNs(50.0));
+    s.p99Us = NsToUs(h.ValueAtPercentileNs(99.0));
+    s.p999Us = NsToUs(h.ValueAtPercentileNs(99.9));
+    s.maxUs = NsToUs(h.MaxNs());
+    return s;
+}
+
+} // namespace rj
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace rj {
+
+// Bucket layout shared by LatencyHistogram and LatencyRecorder (HdrHistogram-style
+// log-linear). Values are nanoseconds. Below 2^kSubBucketBits every value has its own
+// bucket; above, each power of two is split into 2^(kSubBucketBits-1) equal buckets, so
+// the relative error stays below 2^(1-kSubBucketBits) (~1.6%). Values at or above
+// 2^kMaxValueBits (~68 s) land in the last bucket.
+struct LatencyBuckets {
+    static constexpr uint32_t kSubBucketBits = 7;
+    static constexpr uint32_t kMaxValueBits = 36;
+    static constexpr uint32_t kSubBucketCount = 1u << kSubBucketBits;
+    static constexpr uint32_t kSubBucketHalf = kSubBucketCount / 2;
+    static constexpr uint32_t kCount = kSubBucketCount + (kMaxValueBits - kSubBucketBits) * kSubBucketHalf;
+    static constexpr uint64_t kMaxValue = (uint64_t{1} << kMaxValueBits) - 1;
+
+    static uint32_t IndexOf(uint64_t v);
+    static uint64_t LowestValueAt(uint32_t index);
+    static uint64_t HighestValueAt(uint32_t index);
+};
+
+// Fixed-size histogram with plain counters: one owner, or a snapshot taken from a
+// LatencyRecorder. Never allocates.
+class LatencyHistogram {
+public:
+    void Record(int64_t valueNs);
+    void Merge(const LatencyHistogram& other);
+    void Reset();
+
+    uint64_t Count() const { return m_count; }
+    int64_t MaxNs() const { return static_cast<int64_t>(m_max); }
+    double MeanNs() const { return m_count ? static_cast<double>(m_sum) / static_cast<double>(m_count) : 0.0; }
+
+    // Smallest recorded value such that `percentile`% of samples are at or below it, up to
+    // bucket precision (the bucket's upper bound, capped at the exact maximum).
+    int64_t ValueAtPercentileNs(double percentile) const;
+
+private:
+    friend class LatencyRecorder;
+
+    std::array<uint64_t, LatencyBuckets::kCount> m_counts{};
+    uint64_t m_count{};
+    uint64_t m_sum{};
+    uint64_t m_max{};
+};
+
+// Concurrent version for hot paths: Record() is wait-free and allocation-free (relaxed
+// atomic increments, a CAS only when a new maximum is seen) and may be called from any
+// number of threads while another one takes interval snapshots.
+class LatencyRecorder {
+public:
+    void Record(int64_t valueNs);
+
+    // Moves everything recorded since the previous call into `out` (merged, not replaced).
+    // Each sample ends up in exactly one interval; a sample racing with the snapshot may
+    // have its bucket in this interval and its sum/max in the next.
+    void TakeInterval(LatencyHistogram& out);
+
+private:
+    std::array<std::atomic<uint64_t>, LatencyBuckets::kCount> m_counts{};  // the count is their sum
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+// The percentiles the stats line prints, in microseconds.
+struct LatencyPercentiles {
+    uint64_t count{};
+    double avgUs{};
+    double p50Us{};
+    double p99Us{};
+    double p999Us{};
+    double maxUs{};
+};
+
+LatencyPercentiles SummarizeLatency(const LatencyHistogram& h);
+
+} // namespace rj
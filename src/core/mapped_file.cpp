@@ -0,0 +1,163 @@
+#include "core/mapped_file.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rj {
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Create(const char* path, size_t bytes) {
+    Close();
+    if (bytes == 0) return false;
+    HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    // Mapping past the end grows the file to `bytes` with allocated, zeroed clusters.
+    const uint64_t size = bytes;
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, bytes) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<uint8_t*>(view);
+    m_size = bytes;
+    m_writable = true;
+    return true;
+}
+
+bool MappedFile::Open(const char* path) {
+    Close();
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size{};
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<uint8_t*>(view);
+    m_size = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+bool MappedFile::Finish(size_t usedBytes) {
+    if (!m_data) return false;
+    HANDLE file = static_cast<HANDLE>(m_file);
+    const bool cut = m_writable && usedBytes < m_size;
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+    m_data = nullptr;
+    m_mapping = nullptr;
+    bool ok = true;
+    if (cut) {
+        LARGE_INTEGER end{};
+        end.QuadPart = static_cast<LONGLONG>(usedBytes);
+        ok = SetFilePointerEx(file, end, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+    }
+    CloseHandle(file);
+    m_file = nullptr;
+    m_size = 0;
+    m_writable = false;
+    return ok;
+}
+
+void MappedFile::Close() {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(static_cast<HANDLE>(m_mapping));
+    if (m_file) CloseHandle(static_cast<HANDLE>(m_file));
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+    m_writable = false;
+}
+
+#else
+
+bool MappedFile::Create(const char* path, size_t bytes) {
+    Close();
+    if (bytes == 0) return false;
+    const int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    // Reserve the blocks: a store into a sparse mapping on a full disk is a SIGBUS, not an
+    // error code. Filesystems without fallocate get a sparse file.
+    const int err = posix_fallocate(fd, 0, static_cast<off_t>(bytes));
+    bool ok = err == 0 || ((err == EINVAL || err == EOPNOTSUPP) && ftruncate(fd, static_cast<off_t>(bytes)) == 0);
+    void* p = ok ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if (p == MAP_FAILED) {
+        close(fd);
+        unlink(path);
+        return false;
+    }
+    m_fd = fd;
+    m_data = static_cast<uint8_t*>(p);
+    m_size = bytes;
+    m_writable = true;
+    return true;
+}
+
+bool MappedFile::Open(const char* path) {
+    Close();
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    m_data = static_cast<uint8_t*>(p);
+    m_size = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+bool MappedFile::Finish(size_t usedBytes) {
+    if (!m_data) return false;
+    const bool cut = m_writable && usedBytes < m_size;
+    munmap(m_data, m_size);
+    bool ok = true;
+    if (cut) ok = ftruncate(m_fd, static_cast<off_t>(usedBytes)) == 0;
+    if (m_fd >= 0) close(m_fd);
+    m_fd = -1;
+    m_data = nullptr;
+    m_size = 0;
+    m_writable = false;
+    return ok;
+}
+
+void MappedFile::Close() {
+    if (m_data) munmap(m_data, m_size);
+    if (m_fd >= 0) close(m_fd);
+    m_fd = -1;
+    m_data = nullptr;
+    m_size = 0;
+    m_writable = false;
+}
+
+#endif
+
+} // namespace rj
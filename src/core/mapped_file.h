@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rj {
+
+// A file mapped into memory. Create() reserves the whole file up front and maps it
+// read/write, so writers just memcpy into Data() and the OS writes the pages back in the
+// background; what was written survives the process dying. Open() maps an existing file
+// read-only.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Creates (or truncates) `path` at `bytes`, zero-filled.
+    bool Create(const char* path, size_t bytes);
+    // Maps an existing, non-empty file read-only.
+    bool Open(const char* path);
+    // Unmaps; a file from Create() is cut to its first `usedBytes`.
+    bool Finish(size_t usedBytes);
+    void Close();
+
+    // Read-only after Open().
+    uint8_t* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+    bool Valid() const { return m_data != nullptr; }
+    bool Writable() const { return m_writable; }
+
+private:
+    uint8_t* m_data{};
+    size_t m_size{};
+    bool m_writable{};
+#if defined(_WIN32)
+    void* m_file{};     // HANDLE
+    void* m_mapping{};  // HANDLE
+#else
+    int m_fd{-1};  // kept open by Create() for Finish()
+#endif
+};
+
+} // namespace rj
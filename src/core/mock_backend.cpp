@@ -0,0 +1,41 @@
+#include "core/mock_backend.h"
+
+namespace rj {
+
+MockCaptureBackend::MockCaptureBackend(Clock& clock, const MockBackendScript& script, uint32_t seed)
+    : m_clock(clock), m_script(script), m_rng(seed) {}
+
+bool MockCaptureBackend::Start() {
+    m_running = !m_script.startFails;
+    if (!m_running) return false;
+    m_startNs = m_clock.NowNs();
+    m_arrivals = 0;
+    Schedule();
+    return true;
+}
+
+bool MockCaptureBackend::Next(int64_t nowNs, MockBackendFrame& out) {
+    if (!m_running || m_script.arrivalHz <= 0.0 || m_pending.readyNs > nowNs) return false;
+    out = m_pending;
+    Schedule();
+    return true;
+}
+
+int64_t MockCaptureBackend::PresentNs(int64_t readyNs, int64_t periodNs) const {
+    const int64_t t = readyNs + m_script.renderNs;
+    return (t + periodNs - 1) / periodNs * periodNs;
+}
+
+// Arrivals sit on the nominal grid plus jitter, so jitter doesn't change the rate.
+void MockCaptureBackend::Schedule() {
+    auto jitter = [&](int64_t range) { return range > 0 ? static_cast<int64_t>(m_rng() % static_cast<uint64_t>(range)) : 0; };
+    if (m_script.arrivalHz <= 0.0) return;
+    const int64_t intervalNs = static_cast<int64_t>(static_cast<double>(kNsPerSec) / m_script.arrivalHz);
+    m_arrivals++;
+    m_pending.arrivalNs = m_startNs + static_cast<int64_t>(m_arrivals) * intervalNs + jitter(m_script.arrivalJitterNs);
+    m_pending.copyNs = m_script.copyNs + jitter(m_script.copyJitterNs);
+    m_pending.readyNs = m_pending.arrivalNs + m_pending.copyNs;
+    m_pending.placeholder = m_script.placeholderAfterNs >= 0 && m_pending.arrivalNs - m_startNs >= m_script.placeholderAfterNs;
+}
+
+} // namespace rj
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+#include "core/backend_probe.h"
+#include "core/clock.h"
+
+namespace rj {
+
+// Scripted timing of one capture backend. Jitters are uniform in [0, jitter).
+struct MockBackendScript {
+    CaptureBackend backend{};
+    bool startFails = false;
+    double arrivalHz = 120.0;          // new frames per second while content changes; 0 = none
+    int64_t arrivalJitterNs = 0;
+    int64_t copyNs = 500 * kNsPerUs;   // arrival -> the frame is in a texture the outputs sample; 0 = zero-copy
+    int64_t copyJitterNs = 0;
+    int64_t renderNs = 1 * kNsPerMs;   // the frame must be this far ahead of a vblank to make it
+    int64_t placeholderAfterNs = -1;   // from start, frames are placeholders; < 0 = never
+};
+
+struct MockBackendFrame {
+    int64_t arrivalNs{};
+    int64_t copyNs{};
+    int64_t readyNs{};                 // arrival + copy
+    bool placeholder{};
+};
+
+// A simulated capture backend on a Clock: frames arrive at the scripted rate from Start()
+// on and are handed out in order by Next(). Deterministic for a given seed.
+class MockCaptureBackend {
+public:
+    MockCaptureBackend(Clock& clock, const MockBackendScript& script, uint32_t seed = 1);
+
+    // False when the script says the backend can't start.
+    bool Start();
+    void Stop() { m_running = false; }
+    bool Running() const { return m_running; }
+
+    // The next frame whose copy finished by `nowNs`, if any.
+    bool Next(int64_t nowNs, MockBackendFrame& out);
+
+    // The first vblank (every `periodNs` from 0) a frame ready at `readyNs` can be
+    // presented on, given the script's render time.
+    int64_t PresentNs(int64_t readyNs, int64_t periodNs) const;
+
+    const MockBackendScript& Script() const { return m_script; }
+
+private:
+    void Schedule();
+
+    Clock& m_clock;
+    MockBackendScript m_script;
+    std::mt19937 m_rng;
+    bool m_running{};
+    int64_t m_startNs{};
+    uint64_t m_arrivals{};
+    MockBackendFrame m_pending{};
+};
+
+} // namespace rj
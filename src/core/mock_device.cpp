@@ -0,0 +1,59 @@
+#include "core/mock_device.h"
+
+#include <algorithm>
+
+namespace rj {
+
+class MockRenderDeviceFactory::Device final : public IRenderDevice {
+public:
+    Device(MockRenderDeviceFactory& factory, uint64_t luid) : m_factory(factory), m_luid(luid), m_epoch(factory.m_adapterEpoch) {}
+
+    bool IsCurrent() override {
+        m_factory.m_counters.isCurrentCalls++;
+        m_factory.m_clock.SleepForNs(m_factory.m_cfg.isCurrentCostNs);
+        return !m_removed && m_epoch == m_factory.m_adapterEpoch;
+    }
+
+    uint64_t Luid() const { return m_luid; }
+    void MarkRemoved() { m_removed = true; }
+
+private:
+    MockRenderDeviceFactory& m_factory;
+    uint64_t m_luid;
+    uint64_t m_epoch;
+    bool m_removed{};
+};
+
+MockRenderDeviceFactory::MockRenderDeviceFactory(Clock& clock, const MockDeviceConfig& cfg) : m_clock(clock), m_cfg(cfg) {}
+
+std::shared_ptr<IRenderDevice> MockRenderDeviceFactory::Create(uint64_t adapterLuid) {
+    m_clock.SleepForNs(m_cfg.factoryCostNs + m_cfg.enumCostNs);
+    if (std::find(m_missingAdapters.begin(), m_missingAdapters.end(), adapterLuid) != m_missingAdapters.end()) {
+        m_counters.failed++;
+        return nullptr;
+    }
+    m_clock.SleepForNs(m_cfg.deviceCostNs);
+    auto device = std::make_shared<Device>(*this, adapterLuid);
+    m_devices.push_back(device);
+    m_counters.created++;
+    return device;
+}
+
+void MockRenderDeviceFactory::SetAdapterPresent(uint64_t adapterLuid, bool present) {
+    m_missingAdapters.erase(std::remove(m_missingAdapters.begin(), m_missingAdapters.end(), adapterLuid), m_missingAdapters.end());
+    if (!present) {
+        m_missingAdapters.push_back(adapterLuid);
+        m_adapterEpoch++;
+    }
+}
+
+void MockRenderDeviceFactory::RemoveDevice(uint64_t adapterLuid) {
+    for (auto it = m_devices.rbegin(); it != m_devices.rend(); ++it) {
+        if (auto device = it->lock(); device && device->Luid() == adapterLuid) {
+            device->MarkRemoved();
+            return;
+        }
+    }
+}
+
+} // namespace rj
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/clock.h"
+#include "core/device_cache.h"
+
+namespace rj {
+
+// Cost of bringing up a device, split like Direct3DDevice::Init().
+struct MockDeviceConfig {
+    int64_t factoryCostNs = 2 * kNsPerMs;  // CreateDXGIFactory2
+    int64_t enumCostNs = 1 * kNsPerMs;     // EnumAdapterByLuid
+    int64_t deviceCostNs = 40 * kNsPerMs;  // D3D11CreateDevice (driver load, shader cache)
+    int64_t isCurrentCostNs = 2 * kNsPerUs;
+};
+
+struct MockDeviceCounters {
+    uint64_t created{};
+    uint64_t failed{};
+    uint64_t isCurrentCalls{};
+};
+
+// Simulated render devices on a Clock: creation sleeps the configured costs, adapters can
+// disappear, the adapter set can change (every existing device stops being current, like
+// IDXGIFactory::IsCurrent after a GPU hot-plug) and single devices can be removed.
+class MockRenderDeviceFactory final : public IRenderDeviceFactory {
+public:
+    MockRenderDeviceFactory(Clock& clock, const MockDeviceConfig& cfg = {});
+
+    std::shared_ptr<IRenderDevice> Create(uint64_t adapterLuid) override;
+
+    void SetAdapterPresent(uint64_t adapterLuid, bool present);
+    void ChangeAdapterSet() { m_adapterEpoch++; }
+    // The newest device created on the adapter reports removal.
+    void RemoveDevice(uint64_t adapterLuid);
+
+    const MockDeviceCounters& Counters() const { return m_counters; }
+
+private:
+    class Device;
+
+    Clock& m_clock;
+    MockDeviceConfig m_cfg;
+    uint64_t m_adapterEpoch{};
+    std::vector<uint64_t> m_missingAdapters;
+    std::vector<std::weak_ptr<Device>> m_devices;
+    MockDeviceCounters m_counters{};
+};
+
+} // namespace rj
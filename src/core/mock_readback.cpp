@@ -0,0 +1,67 @@
+#include "core/mock_readback.h"
+
+#include <algorithm>
+
+namespace rj {
+
+MockReadbackDevice::MockReadbackDevice(Clock& clock, const MockReadbackConfig& cfg) : m_clock(clock), m_cfg(cfg) {}
+
+void MockReadbackDevice::QueueGpuWork(int64_t ns) {
+    m_gpuIdleAtNs = std::max(m_gpuIdleAtNs, m_clock.NowNs()) + ns;
+}
+
+bool MockReadbackDevice::Copy(uint32_t slot, const ReadbackPlan& plan) {
+    if (!m_source.pixels || BytesPerPixel(m_source.format) != 4 || plan.rect.right > static_cast<int32_t>(m_source.width) ||
+        plan.rect.bottom > static_cast<int32_t>(m_source.height)) {
+        return false;
+    }
+    if (slot >= m_staging.size()) m_staging.resize(slot + 1);
+    Staging& s = m_staging[slot];
+    // The runtime would refuse to copy into a mapped texture.
+    if (s.mapped) return false;
+    s.strideBytes = plan.width * 4u;
+    s.pixels.resize(static_cast<size_t>(s.strideBytes) * plan.height);
+    if (m_cfg.pixels) DownsampleBox(m_source.pixels, m_source.strideBytes, plan, s.pixels.data(), s.strideBytes);
+
+    m_clock.SleepForNs(m_cfg.copyCallNs);
+    int64_t gpuNs = m_cfg.copyFixedNs + static_cast<int64_t>(static_cast<double>(s.pixels.size()) / m_cfg.copyBytesPerNs);
+    if (plan.downsample > 1) {
+        const double read = static_cast<double>(plan.rect.Width()) * plan.rect.Height() * 4.0;
+        gpuNs += static_cast<int64_t>(read / m_cfg.filterBytesPerNs);
+    }
+    QueueGpuWork(gpuNs);
+    s.doneNs = m_gpuIdleAtNs;
+    s.copied = true;
+    m_counters.copies++;
+    return true;
+}
+
+ReadbackMapResult MockReadbackDevice::Map(uint32_t slot, bool wait, ReadbackMapping& out) {
+    if (slot >= m_staging.size() || !m_staging[slot].copied || m_staging[slot].mapped) return ReadbackMapResult::Failed;
+    Staging& s = m_staging[slot];
+    m_clock.SleepForNs(m_cfg.mapCallNs);
+    const int64_t now = m_clock.NowNs();
+    if (now < s.doneNs) {
+        if (!wait) {
+            m_counters.busyMaps++;
+            return ReadbackMapResult::Busy;
+        }
+        m_counters.stalledMaps++;
+        m_counters.stallNs += s.doneNs - now;
+        m_clock.SleepUntilNs(s.doneNs);
+    }
+    s.mapped = true;
+    out.pixels = s.pixels.data();
+    out.strideBytes = s.strideBytes;
+    m_counters.maps++;
+    m_counters.mapped++;
+    return ReadbackMapResult::Mapped;
+}
+
+void MockReadbackDevice::Unmap(uint32_t slot) {
+    if (slot >= m_staging.size() || !m_staging[slot].mapped) return;
+    m_staging[slot].mapped = false;
+    m_counters.mapped--;
+}
+
+} // namespace rj
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/clock.h"
+#include "core/frame.h"
+#include "core/readback.h"
+
+namespace rj {
+
+// GPU costs, split like a D3D11 CopySubresourceRegion (plus a downsampling draw) into a
+// staging texture followed by Map.
+struct MockReadbackConfig {
+    int64_t copyCallNs = 5 * kNsPerUs;     // CPU side of queuing the copy
+    int64_t copyFixedNs = 30 * kNsPerUs;   // GPU side, per copy
+    double copyBytesPerNs = 12.0;          // into system memory, of the copied pixels
+    double filterBytesPerNs = 200.0;       // downsampling pass, of the source pixels read
+    int64_t mapCallNs = 10 * kNsPerUs;
+    bool pixels = true;  // false: timing only, mapped surfaces hold no content
+};
+
+struct MockReadbackCounters {
+    uint64_t copies{};
+    uint64_t maps{};
+    uint64_t busyMaps{};
+    uint64_t stalledMaps{};  // waited for the GPU
+    int64_t stallNs{};
+    uint32_t mapped{};       // currently
+};
+
+// Simulated readback on a Clock: the GPU runs queued work in order (QueueGpuWork() stands
+// for the frame's rendering), a copy snapshots the source through DownsampleBox when it is
+// queued, and a waiting Map sleeps the clock until the GPU is done with it.
+class MockReadbackDevice final : public IReadbackDevice {
+public:
+    MockReadbackDevice(Clock& clock, const MockReadbackConfig& cfg = {});
+
+    // 4-byte pixels, read when copies are queued.
+    void SetSource(const FrameDesc& source) { m_source = source; }
+    // Puts `ns` of other work on the GPU queue.
+    void QueueGpuWork(int64_t ns);
+    int64_t GpuIdleAtNs() const { return m_gpuIdleAtNs; }
+
+    bool Copy(uint32_t slot, const ReadbackPlan& plan) override;
+    ReadbackMapResult Map(uint32_t slot, bool wait, ReadbackMapping& out) override;
+    void Unmap(uint32_t slot) override;
+
+    const MockReadbackCounters& Counters() const { return m_counters; }
+
+private:
+    struct Staging {
+        std::vector<uint8_t> pixels;
+        uint32_t strideBytes{};
+        int64_t doneNs{};
+        bool copied{};
+        bool mapped{};
+    };
+
+    Clock& m_clock;
+    MockReadbackConfig m_cfg;
+    FrameDesc m_source{};
+    int64_t m_gpuIdleAtNs{};
+    std::vector<Staging> m_staging;
+    MockReadbackCounters m_counters{};
+};
+
+} // namespace rj
@@ -0,0 +1,70 @@
+#include "core/mock_swapchain.h"
+
+#include <algorithm>
+
+namespace rj {
+
+MockSwapChain::MockSwapChain(Clock& clock, const MockSwapChainConfig& cfg) : m_clock(clock), m_cfg(cfg) {}
+
+void MockSwapChain::PresentAt(int64_t tNs) {
+    m_schedule.push_back(tNs);
+}
+
+void MockSwapChain::Pump() {
+    const int64_t now = m_clock.NowNs();
+    while (!m_schedule.empty() && m_schedule.front() <= now) {
+        if (m_haveFrame) m_counters.superseded++;
+        m_frame = SwapChainBuffer{};
+        m_frame.frameNumber = m_nextFrameNumber++;
+        m_frame.presentTimeNs = m_schedule.front();
+        m_haveFrame = true;
+        m_signaled = true;
+        m_counters.presented++;
+        m_schedule.pop_front();
+    }
+}
+
+SwapChainAcquire MockSwapChain::ReleaseAndAcquire(SwapChainBuffer& out) {
+    m_counters.acquireCalls++;
+    m_clock.SleepForNs(m_cfg.acquireCostNs);
+    if (m_cfg.loseAfterFrames != 0 && m_counters.acquired >= m_cfg.loseAfterFrames) return SwapChainAcquire::Lost;
+    Pump();
+    if (!m_haveFrame) return SwapChainAcquire::Pending;
+    out = m_frame;
+    m_haveFrame = false;
+    m_counters.acquired++;
+    return SwapChainAcquire::Acquired;
+}
+
+SwapChainWait MockSwapChain::WaitForWork(int64_t timeoutNs) {
+    m_counters.waits++;
+    Pump();
+    const int64_t now = m_clock.NowNs();
+    const bool terminates = m_cfg.terminateAtNs >= 0;
+    if (terminates && now >= m_cfg.terminateAtNs) return SwapChainWait::Terminate;
+    if (!m_signaled) {
+        int64_t wakeAt = timeoutNs >= 0 ? now + timeoutNs : INT64_MAX;
+        if (!m_schedule.empty()) wakeAt = std::min(wakeAt, m_schedule.front());
+        if (terminates) wakeAt = std::min(wakeAt, m_cfg.terminateAtNs);
+        // Nothing could ever wake this wait; a real driver would hang here.
+        if (wakeAt == INT64_MAX) return SwapChainWait::Failed;
+        m_clock.SleepUntilNs(wakeAt);
+        Pump();
+        if (terminates && m_clock.NowNs() >= m_cfg.terminateAtNs) return SwapChainWait::Terminate;
+        if (!m_signaled) return SwapChainWait::Timeout;
+    }
+    m_signaled = false;
+    m_clock.SleepForNs(m_cfg.wakeupCostNs);
+    return SwapChainWait::NewFrame;
+}
+
+bool MockSwapChain::FinishedProcessing() {
+    m_clock.SleepForNs(m_cfg.finishCostNs);
+    return true;
+}
+
+void MockSwapChain::ReportFrameStatistics(const SwapChainFrameTiming& timing) {
+    m_reported.push_back(timing);
+}
+
+} // namespace rj
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "core/clock.h"
+#include "core/swapchain_loop.h"
+
+namespace rj {
+
+struct MockSwapChainConfig {
+    int64_t acquireCostNs = 20 * kNsPerUs;  // per ReleaseAndAcquire call, found a frame or not
+    int64_t finishCostNs = 5 * kNsPerUs;
+    int64_t wakeupCostNs = 10 * kNsPerUs;   // from the event firing to the waiter running
+    uint64_t loseAfterFrames = 0;           // ReleaseAndAcquire reports Lost after this many frames; 0 = never
+    int64_t terminateAtNs = -1;             // the terminate event fires at this time; < 0 = never
+};
+
+struct MockSwapChainCounters {
+    uint64_t presented{};
+    uint64_t acquired{};
+    uint64_t superseded{};  // presented but replaced by a newer frame before anyone acquired it
+    uint64_t acquireCalls{};
+    uint64_t waits{};       // WaitForWork calls, i.e. thread wakeups
+};
+
+// Simulated IddCx swap-chain on a Clock (normally a ManualClock): the OS presents frames at
+// scheduled times, the new-frame event is an auto-reset flag and ReleaseAndAcquire hands out
+// the newest presented frame. Waits sleep the clock, so a whole session runs instantly and
+// deterministically on one thread.
+class MockSwapChain final : public ISwapChainPort {
+public:
+    MockSwapChain(Clock& clock, const MockSwapChainConfig& cfg = {});
+
+    // Schedules an OS present; times must not decrease.
+    void PresentAt(int64_t tNs);
+
+    SwapChainAcquire ReleaseAndAcquire(SwapChainBuffer& out) override;
+    SwapChainWait WaitForWork(int64_t timeoutNs) override;
+    bool FinishedProcessing() override;
+    void ReportFrameStatistics(const SwapChainFrameTiming& timing) override;
+    int64_t NowNs() override { return m_clock.NowNs(); }
+
+    const MockSwapChainCounters& Counters() const { return m_counters; }
+    const std::vector<SwapChainFrameTiming>& Reported() const { return m_reported; }
+
+private:
+    // Moves presents that are due into the surface slot and signals the event.
+    void Pump();
+
+    Clock& m_clock;
+    MockSwapChainConfig m_cfg;
+    std::deque<int64_t> m_schedule;
+    bool m_haveFrame{};
+    SwapChainBuffer m_frame{};
+    bool m_signaled{};
+    uint64_t m_nextFrameNumber{1};
+    MockSwapChainCounters m_counters{};
+    std::vector<SwapChainFrameTiming> m_reported;
+};
+
+} // namespace rj
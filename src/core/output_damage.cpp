@@ -0,0 +1,72 @@
+#include "core/output_damage.h"
+
+#include <algorithm>
+
+namespace rj {
+
+uint32_t OutputsTouched(const SlicePlan& plan, const Rect* rects, uint32_t count) {
+    const uint32_t outputs = std::min(plan.outputs, kMaxSliceOutputs);
+    const uint32_t all = AllOutputsMask(outputs);
+    if (!rects || count == 0 || !plan.sliceEnabled) return all;
+
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < outputs; i++) {
+        const SliceRegion& region = plan.regions[i];
+        // The shader samples linearly; off a 1:1 mapping the edge pixels blend a neighbour.
+        const int32_t grow = region.Copyable() ? 0 : 1;
+        const Rect reach{region.src.left - grow, region.src.top - grow, region.src.right + grow, region.src.bottom + grow};
+        for (uint32_t r = 0; r < count; r++) {
+            const Rect& d = rects[r];
+            if (d.left < reach.right && reach.left < d.right && d.top < reach.bottom && reach.top < d.bottom) {
+                mask |= 1u << i;
+                break;
+            }
+        }
+    }
+    return mask;
+}
+
+OutputDamageTracker::OutputDamageTracker(uint32_t outputs) {
+    Reset(outputs);
+}
+
+void OutputDamageTracker::Reset(uint32_t outputs) {
+    m_outputs = std::min(outputs, kMaxSliceOutputs);
+    for (uint32_t i = 0; i < kMaxSliceOutputs; i++) {
+        m_changedAt[i].store(0, std::memory_order_relaxed);
+        m_shown[i] = 0;
+    }
+    m_invalid = AllOutputsMask(m_outputs);
+}
+
+void OutputDamageTracker::MarkChanged(uint64_t sequence, uint32_t mask) {
+    for (uint32_t i = 0; i < m_outputs; i++) {
+        if (!(mask & (1u << i))) continue;
+        // Sequences only grow; a relaxed max is enough since the frame itself is published
+        // with release semantics afterwards.
+        uint64_t cur = m_changedAt[i].load(std::memory_order_relaxed);
+        while (cur < sequence && !m_changedAt[i].compare_exchange_weak(cur, sequence, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+uint32_t OutputDamageTracker::Pending() const {
+    uint32_t mask = m_invalid;
+    for (uint32_t i = 0; i < m_outputs; i++) {
+        if (m_changedAt[i].load(std::memory_order_relaxed) > m_shown[i]) mask |= 1u << i;
+    }
+    return mask;
+}
+
+void OutputDamageTracker::Drawn(uint32_t mask, uint64_t sequence) {
+    for (uint32_t i = 0; i < m_outputs; i++) {
+        if (mask & (1u << i)) m_shown[i] = std::max(m_shown[i], sequence);
+    }
+    m_invalid &= ~mask;
+}
+
+void OutputDamageTracker::Invalidate(uint32_t mask) {
+    m_invalid |= mask & AllOutputsMask(m_outputs);
+}
+
+} // namespace rj
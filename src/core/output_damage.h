@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "core/frame.h"
+#include "core/slice_plan.h"
+
+namespace rj {
+
+// Outputs of `plan` that a change to `rects` (wide-frame coordinates) shows up on. No rects
+// means the whole frame changed. An unsliced plan shows the whole frame on every output, and
+// a scaled region also picks up changes one texel outside it (bilinear taps).
+uint32_t OutputsTouched(const SlicePlan& plan, const Rect* rects, uint32_t count);
+
+inline uint32_t AllOutputsMask(uint32_t outputs) {
+    return outputs >= 32 ? 0xFFFFFFFFu : ((1u << outputs) - 1u);
+}
+
+// Which outputs still show older content than the newest frame that changed them.
+//
+// The capture side stamps each frame with an increasing sequence and records the outputs it
+// changed before publishing it; the render side remembers the sequence each output last
+// drew. An output needs a redraw while its last change is newer than what it shows. Frames
+// the render thread never takes (superseded in the ring) still count, and a change recorded
+// for a frame that is not taken yet at worst redraws an output one pass early.
+class OutputDamageTracker {
+public:
+    explicit OutputDamageTracker(uint32_t outputs = 3);
+
+    // Every output needs a redraw afterwards. Not concurrent with MarkChanged().
+    void Reset(uint32_t outputs);
+    uint32_t Outputs() const { return m_outputs; }
+
+    // Capture side: frame `sequence` changed the outputs in `mask`.
+    void MarkChanged(uint64_t sequence, uint32_t mask);
+
+    // Render side: outputs whose last change is newer than what they show.
+    uint32_t Pending() const;
+    // Outputs in `mask` now show frame `sequence`.
+    void Drawn(uint32_t mask, uint64_t sequence);
+    // Outputs in `mask` need a redraw whatever changes say (resize, lost content).
+    void Invalidate(uint32_t mask);
+
+private:
+    uint32_t m_outputs;
+    std::atomic<uint64_t> m_changedAt[kMaxSliceOutputs]{};
+    uint64_t m_shown[kMaxSliceOutputs]{};
+    uint32_t m_invalid{};
+};
+
+} // namespace rj
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/frame.h"
+
+namespace rj {
+
+// What one output window shows for one frame: a rectangle of the wide frame plus the
+// flip/slice state that RenderFrame() feeds to the pixel shader.
+struct OutputSlice {
+    uint32_t index{};  // slice index, same as OutputWindow::sliceIndex
+    uint32_t count{};  // number of outputs the wide frame is split across
+    uint64_t frameSequence{};
+    int64_t captureTimeNs{};
+    bool hasContent{};  // false until the first frame was copied (shader useCapture=0)
+    bool sliceEnabled{};
+    bool flipX{};
+    bool flipY{};
+
+    Rect srcRect{};  // region of the wide frame shown on this output
+    uint32_t srcWidth{};
+    uint32_t srcHeight{};
+    PixelFormat format{PixelFormat::Unknown};
+    uint32_t strideBytes{};
+    const uint8_t* pixels{};  // wide frame origin; null for GPU-only frames
+};
+
+// An output window. Present() may block, like IDXGISwapChain::Present(1, 0).
+class IOutputSink {
+public:
+    virtual ~IOutputSink() = default;
+
+    virtual const char* Name() const = 0;
+    virtual void Present(const OutputSlice& slice) = 0;
+};
+
+} // namespace rj
@@ -0,0 +1,502 @@
+#include "core/pipeline.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "core/slice_plan.h"
+
+namespace rj {
+
+namespace {
+
+PresentPolicyConfig EffectivePresentConfig(const PipelineConfig& cfg) {
+    PresentPolicyConfig p = cfg.presentCfg;
+    p.onNewContent = p.onNewContent && cfg.presentOnNewContent;
+    return p;
+}
+
+} // namespace
+
+FramePipeline::FramePipeline(Clock& clock, const PipelineConfig& cfg)
+    : m_clock(clock),
+      m_cfg(cfg),
+      m_pacer(clock, cfg.vsyncHz),
+      m_present(EffectivePresentConfig(cfg)),
+      m_tileHasher(cfg.tileHashCfg),
+      m_latch(m_pacer.PeriodNs(), cfg.lateLatchCfg) {}
+
+FramePipeline::~FramePipeline() {
+    Stop();
+}
+
+void FramePipeline::Stop() {
+    // The capture thread consumes the tile workers' frames; stop it first.
+    if (m_captureThread) m_captureThread->Stop();
+    if (m_tileGroup) {
+        m_tileGroup->Stop();
+        m_unpublishedAtStop = m_tileGroup->DroppedAtStop();
+    }
+}
+
+TileSkewStats FramePipeline::TakeTileSkew() {
+    return m_tileGroup ? m_tileGroup->TakeStats() : TileSkewStats{};
+}
+
+void FramePipeline::AddSource(ICaptureSource& source) {
+    m_sources.push_back(&source);
+}
+
+void FramePipeline::AddSink(IOutputSink& sink) {
+    m_sinks.push_back(&sink);
+    m_damage.Reset(static_cast<uint32_t>(m_sinks.size()));
+}
+
+SlicePlanConfig FramePipeline::PlanConfig(uint32_t outputs) const {
+    SlicePlanConfig planCfg;
+    planCfg.outputs = outputs;
+    planCfg.outputWidth = m_cfg.outputWidth;
+    planCfg.outputHeight = m_cfg.outputHeight;
+    planCfg.expectedWideW = m_cfg.expectedWideW;
+    planCfg.flipX = m_cfg.flipX;
+    planCfg.flipY = m_cfg.flipY;
+    return planCfg;
+}
+
+const SlicePlan& FramePipeline::Plan(uint32_t width, uint32_t height, uint32_t outputs) const {
+    if (!m_planValid || width != m_planWidth || height != m_planHeight || outputs != m_planOutputs) {
+        m_plan = PlanSlices(width, height, PlanConfig(outputs));
+        m_planWidth = width;
+        m_planHeight = height;
+        m_planOutputs = outputs;
+        m_planValid = true;
+    }
+    return m_plan;
+}
+
+// Outputs single-wide frame `f` changed: its dirty rects, or with hashTiles the tiles whose
+// content differs from the previous frame.
+uint32_t FramePipeline::OutputsChanged(const FrameDesc& f, uint32_t outputs) {
+    const SlicePlan& plan = Plan(f.width, f.height, outputs);
+    if (m_cfg.partialOutputs && m_cfg.hashTiles && f.dirtyRectCount == 0 && f.pixels && BytesPerPixel(f.format) == 4) {
+        if (m_tileHasher.Update(f.pixels, f.strideBytes, f.width, f.height) == 0) return 0;
+        m_tileHasher.ChangedRects(m_hashRects);
+        return OutputsTouched(plan, m_hashRects.data(), static_cast<uint32_t>(m_hashRects.size()));
+    }
+    return OutputsTouched(plan, f.dirtyRects, f.dirtyRectCount);
+}
+
+void FramePipeline::MarkCopied(const FrameDesc& src, int64_t copyNs) {
+    m_copiedFrames++;
+    m_lastCopyNs = copyNs;
+    m_current.sequence = m_copiedFrames;
+    m_current.captureTimeNs = src.captureTimeNs;
+}
+
+bool FramePipeline::CaptureSingle() {
+    ICaptureSource* src = m_sources[0];
+    FrameDesc f{};
+    const uint64_t traceId = CaptureTraceId();
+    Trace(TraceEvent::Acquire, TracePhase::Begin, traceId);
+    const AcquireResult r = src->Acquire(0, f);
+    Trace(TraceEvent::Acquire, TracePhase::End, traceId);
+    if (r == AcquireResult::AccessLost || r == AcquireResult::Error) return false;
+    if (r != AcquireResult::NewFrame) return true;
+
+    Trace(TraceEvent::Copy, TracePhase::Begin, traceId);
+    const size_t bytes = static_cast<size_t>(f.strideBytes) * f.height;
+    if (m_cfg.copyToOwned && f.pixels) {
+        if (m_owned.size() != bytes) m_owned.resize(bytes);
+        std::memcpy(m_owned.data(), f.pixels, bytes);
+        m_current = f;
+        m_current.pixels = m_owned.data();
+    } else {
+        m_current = f;
+    }
+    m_current.dirtyRects = nullptr;
+    m_current.dirtyRectCount = 0;
+    MarkCopied(f, m_clock.NowNs());
+    const uint32_t outputs = static_cast<uint32_t>(m_sinks.size());
+    m_damage.MarkChanged(m_copiedFrames, OutputsChanged(f, outputs));
+    src->Release();
+    Trace(TraceEvent::Copy, TracePhase::End, traceId);
+    return true;
+}
+
+bool FramePipeline::CaptureComposite() {
+    bool accessLost = false;
+    bool anyFrame = false;
+    FrameDesc last{};
+    const uint32_t tiles = static_cast<uint32_t>(m_sources.size());
+    const uint64_t traceId = CaptureTraceId();
+    uint32_t damaged = 0;
+    std::vector<Rect> wideRects;
+
+    for (uint32_t m = 0; m < tiles; m++) {
+        FrameDesc f{};
+        Trace(TraceEvent::Acquire, TracePhase::Begin, traceId, m);
+        const AcquireResult r = m_sources[m]->Acquire(0, f);
+        Trace(TraceEvent::Acquire, TracePhase::End, traceId, m);
+        if (r == AcquireResult::AccessLost || r == AcquireResult::Error) accessLost = true;
+        if (r != AcquireResult::NewFrame) continue;
+
+        Trace(TraceEvent::Copy, TracePhase::Begin, traceId, m);
+        // Size the wide buffer from the actual tile size, not the output window size.
+        const uint32_t wideW = f.width * tiles;
+        const uint32_t wideH = f.height;
+        const uint32_t wideStride = wideW * 4u;
+        if (m_current.width != wideW || m_current.height != wideH || m_owned.size() != static_cast<size_t>(wideStride) * wideH) {
+            m_owned.assign(static_cast<size_t>(wideStride) * wideH, 0);
+            m_current.width = wideW;
+            m_current.height = wideH;
+            m_current.strideBytes = wideStride;
+            m_current.format = f.format;
+        }
+        if (f.pixels && BytesPerPixel(f.format) == 4) {
+            const size_t rowBytes = static_cast<size_t>(f.width) * 4u;
+            uint8_t* dst = m_owned.data() + static_cast<size_t>(f.width) * m * 4u;
+            for (uint32_t y = 0; y < f.height; y++) {
+                std::memcpy(dst + static_cast<size_t>(y) * wideStride, f.pixels + static_cast<size_t>(y) * f.strideBytes, rowBytes);
+            }
+            m_current.pixels = m_owned.data();
+        }
+        // The tile's damage in wide-frame coordinates; no rects means the whole tile.
+        const int32_t tileX = static_cast<int32_t>(f.width * m);
+        wideRects.clear();
+        for (uint32_t i = 0; i < f.dirtyRectCount; i++) {
+            const Rect& r = f.dirtyRects[i];
+            wideRects.push_back(Rect{r.left + tileX, r.top, r.right + tileX, r.bottom});
+        }
+        if (wideRects.empty()) wideRects.push_back(Rect{tileX, 0, tileX + static_cast<int32_t>(f.width), static_cast<int32_t>(f.height)});
+        damaged |= OutputsTouched(Plan(wideW, wideH, static_cast<uint32_t>(m_sinks.size())),
+                                  wideRects.data(),
+                                  static_cast<uint32_t>(wideRects.size()));
+        last = f;
+        anyFrame = true;
+        m_sources[m]->Release();
+        Trace(TraceEvent::Copy, TracePhase::End, traceId, m);
+    }
+
+    if (anyFrame) {
+        MarkCopied(last, m_clock.NowNs());
+        m_damage.MarkChanged(m_copiedFrames, damaged);
+    }
+    return !accessLost;
+}
+
+bool FramePipeline::CaptureThreaded() {
+    if (!m_captureThread) {
+        m_captureThread = std::make_unique<CaptureThread>(m_clock, m_cfg.captureThreadCfg);
+        m_slots.assign(m_captureThread->SlotCount(), std::vector<uint8_t>{});
+        m_tileDamage.assign(m_sources.size(), DamageRing{});
+        m_tileFrames.assign(m_sources.size(), FrameDesc{});
+        m_tileHave.assign(m_sources.size(), 0);
+        m_tileW = 0;
+        m_tileH = 0;
+        m_captureThread->Start([this](uint32_t timeoutMs, uint32_t slot, CapturedFrame& out) {
+            return CaptureIntoSlot(timeoutMs, slot, out);
+        });
+    }
+
+    CapturedFrame frame;
+    if (m_captureThread->TakeLatest(frame)) {
+        m_current = frame.desc;
+        MarkCopied(frame.desc, frame.readyNs);
+        m_damage.MarkChanged(m_copiedFrames, AllOutputsMask(static_cast<uint32_t>(m_sinks.size())));
+    }
+    return !m_captureThread->Failed();
+}
+
+// Polls every tile and only if none had a frame blocks on one of them (rotating), so the
+// thread sleeps inside the source instead of spinning.
+AcquireResult FramePipeline::AcquireTilesSerial(uint32_t timeoutMs) {
+    const uint32_t tiles = static_cast<uint32_t>(m_sources.size());
+    bool any = false;
+    bool accessLost = false;
+    const uint64_t traceId = CaptureTraceId();
+    auto acquire = [&](uint32_t m, uint32_t timeout) {
+        Trace(TraceEvent::Acquire, TracePhase::Begin, traceId, m);
+        const AcquireResult r = m_sources[m]->Acquire(timeout, m_tileFrames[m]);
+        Trace(TraceEvent::Acquire, TracePhase::End, traceId, m);
+        if (r == AcquireResult::AccessLost || r == AcquireResult::Error) accessLost = true;
+        if (r == AcquireResult::NewFrame) {
+            m_tileHave[m] = 1;
+            any = true;
+        }
+    };
+
+    if (tiles > 1) {
+        for (uint32_t m = 0; m < tiles && !accessLost; m++) acquire(m, 0);
+    }
+    if (!any && !accessLost) {
+        m_blockTile = (m_blockTile + 1) % tiles;
+        acquire(m_blockTile, timeoutMs);
+    }
+    if (accessLost) {
+        for (uint32_t m = 0; m < tiles; m++) {
+            if (m_tileHave[m]) m_sources[m]->Release();
+        }
+        return AcquireResult::AccessLost;
+    }
+    return any ? AcquireResult::NewFrame : AcquireResult::Timeout;
+}
+
+AcquireResult FramePipeline::AcquireTilesParallel(uint32_t timeoutMs) {
+    if (!m_tileGroup) {
+        m_tileGroup = std::make_unique<TileAcquireGroup>(m_clock, m_cfg.tileAcquireCfg);
+        m_tileGroup->Start(
+            static_cast<uint32_t>(m_sources.size()),
+            [this](uint32_t tile, uint32_t timeout, int64_t& captureTimeNs) {
+                static thread_local bool t_named = false;
+                if (m_cfg.trace && !t_named) {
+                    const std::string name = "tile " + std::to_string(tile);
+                    m_cfg.trace->NameThread(name.c_str());
+                    t_named = true;
+                }
+                const uint64_t traceId = CaptureTraceId();
+                Trace(TraceEvent::Acquire, TracePhase::Begin, traceId, tile);
+                const AcquireResult r = m_sources[tile]->Acquire(timeout, m_tileFrames[tile]);
+                Trace(TraceEvent::Acquire, TracePhase::End, traceId, tile);
+                captureTimeNs = m_tileFrames[tile].captureTimeNs;
+                return r;
+            },
+            [this](uint32_t tile) { m_sources[tile]->Release(); });
+    }
+
+    TilePublish pub;
+    const AcquireResult r = m_tileGroup->Collect(timeoutMs, pub);
+    if (r != AcquireResult::NewFrame) return r == AcquireResult::Timeout ? r : AcquireResult::AccessLost;
+    Trace(TraceEvent::Publish, TracePhase::Instant, CaptureTraceId(), pub.tileMask);
+    for (uint32_t m = 0; m < m_sources.size(); m++) m_tileHave[m] = (pub.tileMask >> m) & 1u;
+    return AcquireResult::NewFrame;
+}
+
+AcquireResult FramePipeline::CaptureIntoSlot(uint32_t timeoutMs, uint32_t slot, CapturedFrame& out) {
+    if (m_cfg.trace && !m_captureTraceNamed) {
+        m_cfg.trace->NameThread("capture");
+        m_captureTraceNamed = true;
+    }
+    const uint32_t tiles = static_cast<uint32_t>(m_sources.size());
+    const bool parallel = m_cfg.parallelTiles && tiles > 1;
+    std::vector<FrameDesc>& frames = m_tileFrames;
+    std::vector<uint8_t>& have = m_tileHave;
+    std::fill(have.begin(), have.end(), 0);
+    const AcquireResult r = parallel ? AcquireTilesParallel(timeoutMs) : AcquireTilesSerial(timeoutMs);
+    if (r != AcquireResult::NewFrame) return r;
+
+    const FrameDesc* last = nullptr;
+    for (uint32_t m = 0; m < tiles; m++) {
+        if (have[m]) last = &frames[m];
+    }
+    if (last->width != m_tileW || last->height != m_tileH) {
+        m_tileW = last->width;
+        m_tileH = last->height;
+        for (DamageRing& ring : m_tileDamage) ring.Reset(static_cast<uint32_t>(m_slots.size()), m_tileW, m_tileH);
+    }
+    const uint32_t wideStride = m_tileW * tiles * 4u;
+    const size_t bytes = static_cast<size_t>(wideStride) * m_tileH;
+    const bool cpuPixels = last->pixels != nullptr && BytesPerPixel(last->format) == 4;
+    if (cpuPixels && m_slots[slot].size() != bytes) m_slots[slot].assign(bytes, 0);
+
+    const uint64_t traceId = CaptureTraceId();
+    for (uint32_t m = 0; m < tiles; m++) {
+        Trace(TraceEvent::Copy, TracePhase::Begin, traceId, m);
+        CopyTileIntoSlot(slot, m, have[m] ? &frames[m] : nullptr);
+        Trace(TraceEvent::Copy, TracePhase::End, traceId, m);
+    }
+
+    out.desc = *last;
+    out.desc.width = m_tileW * tiles;
+    out.desc.height = m_tileH;
+    out.desc.strideBytes = wideStride;
+    out.desc.pixels = cpuPixels ? m_slots[slot].data() : nullptr;
+    out.desc.dirtyRects = nullptr;
+    out.desc.dirtyRectCount = 0;
+    uint32_t mask = 0;
+    for (uint32_t m = 0; m < tiles; m++) {
+        if (!have[m]) continue;
+        if (frames[m].captureTimeNs > out.desc.captureTimeNs) out.desc.captureTimeNs = frames[m].captureTimeNs;
+        mask |= 1u << m;
+        if (!parallel) m_sources[m]->Release();
+    }
+    if (parallel) m_tileGroup->Recycle(mask);
+    return AcquireResult::NewFrame;
+}
+
+void FramePipeline::CopyTileIntoSlot(uint32_t slot, uint32_t tile, const FrameDesc* f) {
+    DamageRing& ring = m_tileDamage[tile];
+    const SlotUpdatePlan* plan = nullptr;
+    if (!f) {
+        plan = &ring.BuildIdle(slot);
+    } else if (f->width != m_tileW || f->height != m_tileH || f->dirtyRectCount == 0) {
+        plan = &ring.BuildFull(slot);
+    } else {
+        plan = &ring.Build(slot, nullptr, 0, f->dirtyRects, f->dirtyRectCount);
+    }
+
+    std::vector<uint8_t>& dstBuf = m_slots[slot];
+    if (dstBuf.empty()) return;
+    uint8_t* dst = dstBuf.data();
+    const size_t wideStride = static_cast<size_t>(m_tileW) * m_sources.size() * 4u;
+    const size_t tileOffset = static_cast<size_t>(m_tileW) * tile * 4u;
+    auto copyRect = [&](const uint8_t* src, size_t srcStride, size_t srcOffset, const Rect& r) {
+        const size_t rowBytes = static_cast<size_t>(r.Width()) * 4u;
+        for (int32_t y = r.top; y < r.bottom; y++) {
+            std::memcpy(dst + static_cast<size_t>(y) * wideStride + tileOffset + static_cast<size_t>(r.left) * 4u,
+                        src + static_cast<size_t>(y) * srcStride + srcOffset + static_cast<size_t>(r.left) * 4u,
+                        rowBytes);
+        }
+    };
+    const Rect whole{0, 0, static_cast<int32_t>(m_tileW), static_cast<int32_t>(m_tileH)};
+
+    if (plan->catchUp && plan->catchUpSlot >= 0 && m_slots[plan->catchUpSlot].size() == dstBuf.size()) {
+        const uint8_t* from = m_slots[plan->catchUpSlot].data();
+        if (plan->catchUp->fullCopy) {
+            copyRect(from, wideStride, tileOffset, whole);
+        } else {
+            for (const Rect& r : plan->catchUp->copies) copyRect(from, wideStride, tileOffset, r);
+        }
+    }
+    if (!f || !f->pixels || BytesPerPixel(f->format) != 4) return;
+    if (plan->fullCopy) {
+        copyRect(f->pixels, f->strideBytes, 0, whole);
+    } else if (plan->fromSource) {
+        // Moves never show up here: sources only report dirty rects.
+        for (const Rect& r : plan->fromSource->copies) copyRect(f->pixels, f->strideBytes, 0, r);
+    }
+}
+
+OutputSlice FramePipeline::MakeSlice(uint32_t index) const {
+    const uint32_t count = static_cast<uint32_t>(m_sinks.size());
+    OutputSlice s{};
+    s.index = index;
+    s.count = count;
+    s.frameSequence = m_current.sequence;
+    s.captureTimeNs = m_current.captureTimeNs;
+    s.hasContent = m_copiedFrames > 0;
+    s.flipX = m_cfg.flipX;
+    s.flipY = m_cfg.flipY;
+    s.srcWidth = m_current.width;
+    s.srcHeight = m_current.height;
+    s.format = m_current.format;
+    s.strideBytes = m_current.strideBytes;
+    s.pixels = m_current.pixels;
+
+    // Only slice when the captured surface is actually ~N outputs wide.
+    const SlicePlan& plan = Plan(m_current.width, m_current.height, count);
+    s.sliceEnabled = plan.sliceEnabled;
+    s.srcRect = index < plan.outputs ? plan.regions[index].src
+                                     : Rect{0, 0, static_cast<int32_t>(m_current.width), static_cast<int32_t>(m_current.height)};
+    return s;
+}
+
+bool FramePipeline::RunFrame() {
+    const int64_t frameStart = m_clock.NowNs();
+    const uint64_t traceId = m_renderedFrames + 1;
+    if (m_cfg.trace) {
+        if (m_renderedFrames == 0) m_cfg.trace->NameThread("render");
+        m_cfg.trace->Begin(TraceEvent::Frame, traceId, frameStart);
+    }
+
+    int64_t waitNs = 0;
+    LatchPlan plan{};
+    if (m_cfg.paced && m_cfg.lateLatch) {
+        // Frame-latency waitable: wait until the previous frame is on screen, which is also
+        // the vblank observation the predictor learns from.
+        Trace(TraceEvent::Wait, TracePhase::Begin, traceId);
+        if (m_pendingScanoutNs > 0) {
+            m_clock.SleepUntilNs(m_pendingScanoutNs);
+            m_latch.OnVblank(m_pendingScanoutNs);
+        }
+        Trace(TraceEvent::Wait, TracePhase::End, traceId);
+        plan = m_latch.Plan(m_clock.NowNs());
+        Trace(TraceEvent::Wait, TracePhase::Begin, traceId, 1);
+        m_clock.SleepUntilNs(plan.latchNs);
+        Trace(TraceEvent::Wait, TracePhase::End, traceId, 1);
+        waitNs = m_clock.NowNs() - frameStart;
+    } else if (m_cfg.paced) {
+        Trace(TraceEvent::Wait, TracePhase::Begin, traceId);
+        m_pacer.WaitForVblank();
+        waitNs = m_clock.NowNs() - frameStart;
+        Trace(TraceEvent::Wait, TracePhase::End, traceId);
+    }
+    const int64_t latchedNs = m_clock.NowNs();
+    const uint64_t copiedBefore = m_copiedFrames;
+
+    bool ok = true;
+    if (m_cfg.captureThread && !m_sources.empty()) {
+        ok = CaptureThreaded();
+    } else if (m_sources.size() == 1) {
+        ok = CaptureSingle();
+    } else if (m_sources.size() > 1) {
+        ok = CaptureComposite();
+    }
+    const int64_t afterCapture = m_clock.NowNs();
+    const uint32_t allOutputs = AllOutputsMask(static_cast<uint32_t>(m_sinks.size()));
+    const uint32_t damaged = m_cfg.partialOutputs ? m_damage.Pending() & allOutputs : allOutputs;
+    // A frame that changed no output is no new content to present.
+    if (damaged != 0) m_contentSequence = m_copiedFrames;
+    const PresentReason reason = m_present.Decide(afterCapture, m_contentSequence);
+    const bool present = Presents(reason);
+    const uint32_t drawMask = !present ? 0u : (reason == PresentReason::NewContent ? damaged : allOutputs);
+
+    int64_t presentNs = 0;
+    bool presentedOne = false;
+    for (uint32_t i = 0; present && i < m_sinks.size(); i++) {
+        if (!(drawMask & (1u << i))) continue;
+        const OutputSlice slice = MakeSlice(i);
+        const int64_t beforePresent = m_clock.NowNs();
+        if (m_cfg.trace) m_cfg.trace->Begin(TraceEvent::Present, traceId, beforePresent, i);
+        m_sinks[i]->Present(slice);
+        const int64_t afterPresent = m_clock.NowNs();
+        if (m_cfg.trace) m_cfg.trace->End(TraceEvent::Present, traceId, afterPresent, i);
+        presentNs += afterPresent - beforePresent;
+        m_presentedOutputs++;
+
+        // Copy-to-present latency, only updated when a new copy was observed.
+        const bool first = !presentedOne;
+        presentedOne = true;
+        if (first && m_lastCopyNs > 0 && m_lastCopyNs != m_lastLatencySeenCopyNs) {
+            double us = NsToUs(afterPresent - m_lastCopyNs);
+            if (us < 0.0) us = 0.0;
+            if (us > 50000.0) us = 50000.0;
+            m_lastCopyToPresentUs = static_cast<float>(us);
+            m_lastLatencySeenCopyNs = m_lastCopyNs;
+            m_stats.AddCopyToPresent(afterPresent - m_lastCopyNs);
+
+            const int64_t captureToPresentNs = afterPresent - m_current.captureTimeNs;
+            m_latency.frames++;
+            m_latency.sumNs += captureToPresentNs;
+            if (captureToPresentNs > m_latency.maxNs) m_latency.maxNs = captureToPresentNs;
+        }
+    }
+
+    m_damage.Drawn(drawMask, m_copiedFrames);
+    const int64_t frameEnd = m_clock.NowNs();
+    if (m_cfg.paced) {
+        // A skipped pass has no frame-latency signal to wait for; the next one starts at the
+        // following vblank all the same.
+        m_pendingScanoutNs = m_pacer.NextVblankAfterNs(frameEnd);
+        if (m_cfg.lateLatch && present) m_latch.OnSubmitted(plan, latchedNs, frameEnd);
+        if (present && m_copiedFrames != copiedBefore && m_copiedFrames > 0) {
+            const int64_t ns = m_pendingScanoutNs - m_current.captureTimeNs;
+            m_scanout.frames++;
+            m_scanout.sumNs += ns;
+            m_scanout.maxNs = std::max(m_scanout.maxNs, ns);
+            m_scanoutHist.Record(ns);
+        }
+    }
+    FrameTimings t{};
+    t.waitMs = NsToMs(waitNs);
+    t.captureMs = NsToMs(afterCapture - frameStart);
+    t.renderMs = NsToMs(frameEnd - afterCapture);
+    t.presentMs = NsToMs(presentNs);
+    t.totalMs = NsToMs(frameEnd - frameStart);
+    m_stats.Add(t);
+    m_renderedFrames++;
+    if (present) m_presentedFrames++;
+    if (m_cfg.trace) m_cfg.trace->End(TraceEvent::Frame, traceId, frameEnd);
+    return ok;
+}
+
+} // namespace rj
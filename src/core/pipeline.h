@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/capture_source.h"
+#include "core/capture_thread.h"
+#include "core/clock.h"
+#include "core/damage_ring.h"
+#include "core/frame_stats.h"
+#include "core/late_latch.h"
+#include "core/output_damage.h"
+#include "core/output_sink.h"
+#include "core/present_policy.h"
+#include "core/tile_acquire.h"
+#include "core/tile_hash.h"
+#include "core/trace_ring.h"
+
+namespace rj {
+
+struct PipelineConfig {
+    // Size of each output window.
+    uint32_t outputWidth = 2560;
+    uint32_t outputHeight = 1440;
+
+    // Width the capture must reach before slicing kicks in (g_expectedWideW).
+    // 0 means outputs * outputWidth.
+    uint32_t expectedWideW = 0;
+
+    // Wait for the next vblank at the start of each frame, like the frame-latency waitable.
+    bool paced = true;
+    uint32_t vsyncHz = 120;
+
+    // With `paced`: instead of capturing right after the vblank wait, sleep until just
+    // before the predicted next vblank and capture then (LateLatchScheduler).
+    bool lateLatch = false;
+    LateLatchConfig lateLatchCfg{};
+
+    bool flipX = false;
+    bool flipY = false;
+
+    // Copy single-wide frames into a pipeline-owned buffer (the CopyResource into
+    // g_captureTex). When off, outputs sample the source frame directly, which is only
+    // valid for sources whose pixels outlive Release() (synthetic, replay).
+    bool copyToOwned = true;
+
+    // Acquire and copy on a dedicated thread (CaptureThread) instead of polling inside
+    // RunFrame(). Needs a thread-safe clock. Frames always go through owned ring slots.
+    bool captureThread = false;
+    CaptureThreadConfig captureThreadCfg{};
+
+    // With several sources and captureThread: acquire each source on its own worker and
+    // publish composites as decided by `tileAcquireCfg.coherence`.
+    bool parallelTiles = false;
+    TileAcquireConfig tileAcquireCfg{};
+
+    // Skip drawing and presenting passes without new content (PresentPolicy). Off: every
+    // pass presents.
+    bool presentOnNewContent = false;
+    PresentPolicyConfig presentCfg{};
+    // With presentOnNewContent: a new frame only redraws the outputs its dirty rects touch
+    // (OutputDamageTracker). The capture thread path reports whole frames.
+    bool partialOutputs = false;
+    // With partialOutputs and a single source: frames without dirty rects (WGC, IDD) that
+    // have CPU pixels get their damage from tile content hashes (TileHasher) instead of
+    // counting as changed everywhere.
+    bool hashTiles = false;
+    TileHashConfig tileHashCfg{};
+
+    // Optional event trace (frame/wait/acquire/copy/draw/present spans). Must outlive the
+    // pipeline.
+    TraceRing* trace = nullptr;
+};
+
+// Capture timestamp -> first present, over the frames presented so far.
+struct CaptureLatency {
+    uint64_t frames{};
+    int64_t sumNs{};
+    int64_t maxNs{};
+
+    double AvgUs() const { return frames ? NsToUs(sumNs) / static_cast<double>(frames) : 0.0; }
+};
+
+// Platform-neutral version of RenderFrame(): wait -> capture/composite -> slice -> present
+// -> stats. With one source the frame is used as-is (ddmode=single_wide); with several,
+// their frames are composited left to right into a wide buffer (ddmode=triple_composite).
+class FramePipeline {
+public:
+    FramePipeline(Clock& clock, const PipelineConfig& cfg);
+    ~FramePipeline();
+
+    void AddSource(ICaptureSource& source);
+    void AddSink(IOutputSink& sink);
+
+    // Runs one render loop iteration. Returns false if a source reported AccessLost or
+    // Error; the caller is expected to recreate its sources, as RenderFrame() does for DD.
+    bool RunFrame();
+
+    // Slice state for output `index` given the current capture, as fed to the shader.
+    OutputSlice MakeSlice(uint32_t index) const;
+
+    FrameStatsWindow& Stats() { return m_stats; }
+    const char* ModeName() const { return m_sources.size() > 1 ? "triple_composite" : "single_wide"; }
+    uint64_t RenderedFrames() const { return m_renderedFrames; }
+    // Passes that drew and presented; equal to RenderedFrames() unless presentOnNewContent.
+    uint64_t PresentedFrames() const { return m_presentedFrames; }
+    PresentPolicyStats TakePresentStats() { return m_present.TakeStats(); }
+    // Sink presents summed over all passes.
+    uint64_t PresentedOutputs() const { return m_presentedOutputs; }
+    uint64_t CopiedFrames() const { return m_copiedFrames; }
+    uint32_t CaptureWidth() const { return m_current.width; }
+    uint32_t CaptureHeight() const { return m_current.height; }
+    float LastCopyToPresentUs() const { return m_lastCopyToPresentUs; }
+    const CaptureLatency& Latency() const { return m_latency; }
+
+    // Paced only: capture timestamp -> vblank the frame was scanned out at on the simulated
+    // display (a present is shown at the first vblank after it completes).
+    const CaptureLatency& ScanoutLatency() const { return m_scanout; }
+    const LatencyHistogram& ScanoutHistogram() const { return m_scanoutHist; }
+    LateLatchStats TakeLateLatchStats() { return m_latch.TakeStats(); }
+    const FrameDesc& CurrentFrame() const { return m_current; }
+    const CaptureThread* Thread() const { return m_captureThread.get(); }
+
+    // Skew of the composites published since the last call (parallelTiles only).
+    TileSkewStats TakeTileSkew();
+
+    // Tiles a parallel worker had acquired but that were never published when Stop() ran.
+    uint32_t UnpublishedTilesAtStop() const { return m_unpublishedAtStop; }
+
+    // Stops the capture thread, if any. Sources may be destroyed afterwards.
+    void Stop();
+
+private:
+    bool CaptureSingle();
+    bool CaptureComposite();
+    bool CaptureThreaded();
+    void MarkCopied(const FrameDesc& src, int64_t copyNs);
+    SlicePlanConfig PlanConfig(uint32_t outputs) const;
+    // PlanSlices() for a width x height frame, recomputed only when the size or the output
+    // count changes (the rest of the config is fixed). Render thread.
+    const SlicePlan& Plan(uint32_t width, uint32_t height, uint32_t outputs) const;
+    uint32_t OutputsChanged(const FrameDesc& f, uint32_t outputs);
+
+    // Capture thread side of CaptureThreaded().
+    AcquireResult CaptureIntoSlot(uint32_t timeoutMs, uint32_t slot, CapturedFrame& out);
+    AcquireResult AcquireTilesSerial(uint32_t timeoutMs);
+    AcquireResult AcquireTilesParallel(uint32_t timeoutMs);
+    void CopyTileIntoSlot(uint32_t slot, uint32_t tile, const FrameDesc* f);
+
+    // Records into m_cfg.trace, if set, stamped with m_clock.
+    void Trace(TraceEvent event, TracePhase phase, uint64_t frameId, uint32_t arg = 0) {
+        if (m_cfg.trace) m_cfg.trace->Record(event, phase, frameId, m_clock.NowNs(), arg);
+    }
+    uint64_t CaptureTraceId() const { return m_captureThread ? m_captureThread->FramesCaptured() + 1 : m_copiedFrames + 1; }
+
+    Clock& m_clock;
+    PipelineConfig m_cfg;
+    VsyncPacer m_pacer;
+    std::vector<ICaptureSource*> m_sources;
+    std::vector<IOutputSink*> m_sinks;
+
+    std::vector<uint8_t> m_owned;  // g_captureTex
+    FrameDesc m_current{};         // what the outputs sample this frame
+    uint64_t m_copiedFrames{};
+    uint64_t m_renderedFrames{};
+    uint64_t m_presentedFrames{};
+    uint64_t m_presentedOutputs{};
+    uint64_t m_contentSequence{};  // copied frame count as of the last frame that changed an output
+    PresentPolicy m_present;
+    OutputDamageTracker m_damage;
+    TileHasher m_tileHasher;
+    std::vector<Rect> m_hashRects;
+    mutable SlicePlan m_plan{};  // Plan()
+    mutable uint32_t m_planWidth{};
+    mutable uint32_t m_planHeight{};
+    mutable uint32_t m_planOutputs{};
+    mutable bool m_planValid{};
+    int64_t m_lastCopyNs{};
+    int64_t m_lastLatencySeenCopyNs{};
+    float m_lastCopyToPresentUs{-1.0f};
+    CaptureLatency m_latency;
+    FrameStatsWindow m_stats;
+
+    LateLatchScheduler m_latch;
+    int64_t m_pendingScanoutNs{};  // vblank the previous frame is shown at
+    CaptureLatency m_scanout;
+    LatencyHistogram m_scanoutHist;
+
+    // Capture thread mode. Slot buffers are only resized by the capture thread while it
+    // writes that slot; the render thread only reads the slot it holds.
+    std::unique_ptr<CaptureThread> m_captureThread;
+    std::vector<std::vector<uint8_t>> m_slots;
+    std::vector<DamageRing> m_tileDamage;
+    std::vector<FrameDesc> m_tileFrames;
+    std::vector<uint8_t> m_tileHave;
+    uint32_t m_tileW{};
+    uint32_t m_tileH{};
+    uint32_t m_blockTile{};
+    bool m_captureTraceNamed{};  // capture thread only
+
+    // Parallel tile workers. Worker m writes m_tileFrames[m] only while it does not hold
+    // tile m; the capture thread reads it only while it does.
+    std::unique_ptr<TileAcquireGroup> m_tileGroup;
+    uint32_t m_unpublishedAtStop{};
+};
+
+} // namespace rj
@@ -0,0 +1,137 @@
+#include "core/placeholder_detector.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/placeholder_detector_impl.h"
+
+namespace rj {
+
+namespace detail {
+
+void SampleStatsScalar(const SampleGrid& grid, SampleStats& out) {
+    for (uint32_t r = 0; r < grid.rows; r++) {
+        const uint8_t* row = grid.pixels + static_cast<size_t>(GridRowY(grid, r)) * grid.strideBytes;
+        for (uint32_t c = 0; c < grid.cols; c++) {
+            const uint8_t* p = row + static_cast<size_t>(GridRunX(grid, c)) * 4u;
+            for (uint32_t i = 0; i < kSampleRun; i++, p += 4) {
+                for (int ch = 0; ch < 3; ch++) {
+                    out.sum[ch] += p[ch];
+                    out.sumSq[ch] += static_cast<uint32_t>(p[ch]) * p[ch];
+                }
+                out.lumaHist[Luma(p[0], p[1], p[2]) >> kLumaBinShift]++;
+            }
+        }
+    }
+    out.samples = grid.rows * grid.cols * kSampleRun;
+}
+
+} // namespace detail
+
+namespace {
+
+detail::SampleStatsFn SelectKernel(SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(DetectSimdLevel())) level = DetectSimdLevel();
+    return level == SimdLevel::Avx2 ? detail::SampleStatsAvx2 : detail::SampleStatsScalar;
+}
+
+} // namespace
+
+const char* FrameContentName(FrameContent c) {
+    switch (c) {
+    case FrameContent::Content:
+        return "content";
+    case FrameContent::Dark:
+        return "dark";
+    case FrameContent::Constant:
+        return "constant";
+    case FrameContent::NearConstant:
+        return "near_constant";
+    case FrameContent::Tinted:
+        return "tinted";
+    default:
+        return "unknown";
+    }
+}
+
+bool SampleFrameStats(const uint8_t* pixels,
+                      uint32_t strideBytes,
+                      uint32_t width,
+                      uint32_t height,
+                      uint32_t cols,
+                      uint32_t rows,
+                      SampleStats& out,
+                      SimdLevel level) {
+    out = SampleStats{};
+    if (!pixels || width < kSampleRun || height == 0 || cols == 0 || rows == 0) return false;
+    detail::SampleGrid grid;
+    grid.pixels = pixels;
+    grid.strideBytes = strideBytes;
+    grid.width = width;
+    grid.height = height;
+    grid.cols = std::min(cols, width / kSampleRun);
+    grid.rows = std::min(rows, height);
+    SelectKernel(level)(grid, out);
+    return true;
+}
+
+ContentStats SummarizeSamples(const SampleStats& s) {
+    ContentStats c;
+    if (s.samples == 0) return c;
+    const double n = static_cast<double>(s.samples);
+    for (int ch = 0; ch < 3; ch++) {
+        const double mean = static_cast<double>(s.sum[ch]) / n;
+        const double var = std::max(static_cast<double>(s.sumSq[ch]) / n - mean * mean, 0.0);
+        c.mean[ch] = static_cast<float>(mean);
+        c.stddev[ch] = static_cast<float>(std::sqrt(var));
+        c.maxStddev = std::max(c.maxStddev, c.stddev[ch]);
+    }
+    c.chroma = std::max({c.mean[0], c.mean[1], c.mean[2]}) - std::min({c.mean[0], c.mean[1], c.mean[2]});
+    c.meanLuma = (29.0f * c.mean[0] + 150.0f * c.mean[1] + 77.0f * c.mean[2]) / 256.0f;
+    double entropy = 0.0;
+    for (uint32_t b = 0; b < kLumaBins; b++) {
+        if (s.lumaHist[b] == 0) continue;
+        const double p = static_cast<double>(s.lumaHist[b]) / n;
+        entropy -= p * std::log2(p);
+    }
+    c.lumaEntropyBits = static_cast<float>(entropy);
+    return c;
+}
+
+FrameContent ClassifyContent(const ContentStats& s, const PlaceholderConfig& cfg) {
+    const bool dark = s.meanLuma <= cfg.darkMaxLuma;
+    if (s.maxStddev <= cfg.constantStddev) return dark ? FrameContent::Dark : FrameContent::Constant;
+    if (s.maxStddev <= cfg.nearConstantStddev && s.lumaEntropyBits <= cfg.nearConstantEntropy) {
+        return dark ? FrameContent::Dark : FrameContent::NearConstant;
+    }
+    if (s.chroma >= cfg.tintMinChroma && s.maxStddev <= cfg.tintMaxStddev && s.lumaEntropyBits <= cfg.tintMaxEntropy) return FrameContent::Tinted;
+    return FrameContent::Content;
+}
+
+PlaceholderDetector::PlaceholderDetector(const PlaceholderConfig& cfg, SimdLevel level) : m_cfg(cfg), m_level(level) {
+    m_cfg.triggerFrames = std::max(m_cfg.triggerFrames, 1u);
+}
+
+FrameContent PlaceholderDetector::Update(const uint8_t* pixels, uint32_t strideBytes, uint32_t width, uint32_t height) {
+    SampleStats samples;
+    if (!SampleFrameStats(pixels, strideBytes, width, height, m_cfg.gridCols, m_cfg.gridRows, samples, m_level)) {
+        m_last = FrameContent::Unknown;
+        m_stats = ContentStats{};
+        m_streak = 0;
+        return m_last;
+    }
+    m_stats = SummarizeSamples(samples);
+    m_last = ClassifyContent(m_stats, m_cfg);
+    m_streak = IsPlaceholder(m_last) ? m_streak + 1 : 0;
+    if (m_streak >= m_cfg.triggerFrames) m_fired = true;
+    return m_last;
+}
+
+void PlaceholderDetector::Reset() {
+    m_last = FrameContent::Unknown;
+    m_stats = ContentStats{};
+    m_streak = 0;
+    m_fired = false;
+}
+
+} // namespace rj
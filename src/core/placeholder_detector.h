@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/cpu_features.h"
+
+namespace rj {
+
+// Pixels per sampled run: one 32-byte load of BGRA.
+constexpr uint32_t kSampleRun = 8;
+constexpr uint32_t kLumaBins = 32;
+
+// Integer statistics of the sampled pixels of a BGRA frame, identical at every SIMD level.
+struct SampleStats {
+    uint32_t samples{};
+    uint64_t sum[3]{};    // B, G, R
+    uint64_t sumSq[3]{};
+    uint32_t lumaHist[kLumaBins]{};
+};
+
+// What the classifier looks at, derived from SampleStats.
+struct ContentStats {
+    float mean[3]{};    // B, G, R
+    float stddev[3]{};
+    float maxStddev{};
+    float chroma{};     // spread of the channel means: 0 for greys
+    float meanLuma{};
+    float lumaEntropyBits{};  // of the kLumaBins histogram, 0..5
+};
+
+enum class FrameContent {
+    Unknown,       // too small to sample
+    Content,
+    Dark,          // flat and black: a blanked screen or a black scene, not flagged
+    Constant,      // one colour
+    NearConstant,  // one colour give or take a few levels
+    Tinted,        // a saturated colour with little variation around it
+};
+
+const char* FrameContentName(FrameContent c);
+
+inline bool IsPlaceholder(FrameContent c) {
+    return c == FrameContent::Constant || c == FrameContent::NearConstant || c == FrameContent::Tinted;
+}
+
+struct PlaceholderConfig {
+    // Sampling grid: gridRows pixel rows, each at gridCols runs of kSampleRun pixels
+    // (16384 samples by default), clamped to the frame.
+    uint32_t gridCols = 64;
+    uint32_t gridRows = 32;
+    // Every channel's standard deviation at most this: Constant.
+    float constantStddev = 0.5f;
+    // Within this and the luma entropy at most nearConstantEntropy bits: NearConstant.
+    float nearConstantStddev = 2.0f;
+    float nearConstantEntropy = 1.0f;
+    // Channel means at least tintMinChroma apart, deviations and entropy below these: Tinted.
+    float tintMinChroma = 48.0f;
+    float tintMaxStddev = 12.0f;
+    float tintMaxEntropy = 2.5f;
+    // Flat frames no brighter than this are Dark.
+    float darkMaxLuma = 16.0f;
+    // Consecutive placeholder frames before the detector fires.
+    uint32_t triggerFrames = 30;
+};
+
+// Samples a BGRA frame on a cols x rows grid of kSampleRun-pixel runs. False (and `out`
+// empty) when the frame is narrower than one run. `level` is clamped to what the CPU
+// supports (SSE4.1 uses the scalar kernel).
+bool SampleFrameStats(const uint8_t* pixels,
+                      uint32_t strideBytes,
+                      uint32_t width,
+                      uint32_t height,
+                      uint32_t cols,
+                      uint32_t rows,
+                      SampleStats& out,
+                      SimdLevel level = DetectSimdLevel());
+
+ContentStats SummarizeSamples(const SampleStats& s);
+FrameContent ClassifyContent(const ContentStats& s, const PlaceholderConfig& cfg);
+
+// Flags capture backends that hand out placeholder frames (WGC's solid green or gold, a
+// constant tinted frame) instead of the desktop: classifies each frame from a sampled grid
+// and fires after PlaceholderConfig::triggerFrames placeholders in a row. Once fired it
+// stays fired until Reset(). Meant for small readbacks (a downsampled probe); one thread.
+class PlaceholderDetector {
+public:
+    explicit PlaceholderDetector(const PlaceholderConfig& cfg = PlaceholderConfig{}, SimdLevel level = DetectSimdLevel());
+
+    FrameContent Update(const uint8_t* pixels, uint32_t strideBytes, uint32_t width, uint32_t height);
+    bool Fired() const { return m_fired; }
+    void Reset();
+
+    FrameContent Last() const { return m_last; }
+    const ContentStats& LastStats() const { return m_stats; }
+    uint32_t Streak() const { return m_streak; }
+    const PlaceholderConfig& Config() const { return m_cfg; }
+
+private:
+    PlaceholderConfig m_cfg;
+    SimdLevel m_level;
+    FrameContent m_last{FrameContent::Unknown};
+    ContentStats m_stats{};
+    uint32_t m_streak{};
+    bool m_fired{};
+};
+
+} // namespace rj
@@ -0,0 +1,73 @@
+// AVX2 placeholder statistics kernel. Built with -mavx2 (/arch:AVX2 on MSVC); only called
+// after DetectSimdLevel() reported AVX2.
+
+#include "core/cpu_features.h"
+#include "core/placeholder_detector_impl.h"
+
+#if RJ_X86
+#include <immintrin.h>
+#endif
+
+namespace rj::detail {
+
+#if RJ_X86
+
+namespace {
+
+inline uint64_t SumLanes(__m256i v) {
+    alignas(32) uint32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+    uint64_t s = 0;
+    for (uint32_t l : lanes) s += l;
+    return s;
+}
+
+} // namespace
+
+// One run is one load of eight pixels, a channel per 32-bit lane group. Channels are < 256,
+// so madd_epi16 against (k, 0) pairs multiplies them exactly. Sums stay in 32-bit lanes for
+// one grid row and are widened after it.
+void SampleStatsAvx2(const SampleGrid& grid, SampleStats& out) {
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    const __m256i kB = _mm256_set1_epi32(29);
+    const __m256i kG = _mm256_set1_epi32(150);
+    const __m256i kR = _mm256_set1_epi32(77);
+    const __m256i round = _mm256_set1_epi32(128);
+    alignas(32) uint32_t bins[kSampleRun];
+    for (uint32_t r = 0; r < grid.rows; r++) {
+        const uint8_t* row = grid.pixels + static_cast<size_t>(GridRowY(grid, r)) * grid.strideBytes;
+        __m256i sum[3] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+        __m256i sq[3] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+        for (uint32_t c = 0; c < grid.cols; c++) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + static_cast<size_t>(GridRunX(grid, c)) * 4u));
+            const __m256i b = _mm256_and_si256(v, mask);
+            const __m256i g = _mm256_and_si256(_mm256_srli_epi32(v, 8), mask);
+            const __m256i rr = _mm256_and_si256(_mm256_srli_epi32(v, 16), mask);
+            sum[0] = _mm256_add_epi32(sum[0], b);
+            sum[1] = _mm256_add_epi32(sum[1], g);
+            sum[2] = _mm256_add_epi32(sum[2], rr);
+            sq[0] = _mm256_add_epi32(sq[0], _mm256_madd_epi16(b, b));
+            sq[1] = _mm256_add_epi32(sq[1], _mm256_madd_epi16(g, g));
+            sq[2] = _mm256_add_epi32(sq[2], _mm256_madd_epi16(rr, rr));
+            __m256i luma = _mm256_add_epi32(_mm256_madd_epi16(b, kB), _mm256_madd_epi16(g, kG));
+            luma = _mm256_add_epi32(luma, _mm256_add_epi32(_mm256_madd_epi16(rr, kR), round));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(bins), _mm256_srli_epi32(luma, 8 + kLumaBinShift));
+            for (uint32_t bin : bins) out.lumaHist[bin]++;
+        }
+        for (int ch = 0; ch < 3; ch++) {
+            out.sum[ch] += SumLanes(sum[ch]);
+            out.sumSq[ch] += SumLanes(sq[ch]);
+        }
+    }
+    out.samples = grid.rows * grid.cols * kSampleRun;
+}
+
+#else
+
+void SampleStatsAvx2(const SampleGrid& grid, SampleStats& out) {
+    SampleStatsScalar(grid, out);
+}
+
+#endif
+
+} // namespace rj::detail
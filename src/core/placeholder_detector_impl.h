@@ -0,0 +1,46 @@
+#pragma once
+
+// Internal to the placeholder detector: the sampling grid shared by the kernel TUs. Every
+// kernel must produce the same sums and histogram as the scalar one.
+//
+// The grid is `rows` sampled pixel rows, evenly spread from the first row to the last, each
+// sampled at `cols` runs of kSampleRun consecutive pixels evenly spread from the left edge
+// to the right one (runs may overlap on narrow frames). Per sampled pixel (alpha ignored):
+//   sum[c] += v, sumSq[c] += v * v for B, G, R
+//   luma = (29 * B + 150 * G + 77 * R + 128) >> 8, lumaHist[luma >> kLumaBinShift]++
+
+#include <cstdint>
+
+#include "core/placeholder_detector.h"
+
+namespace rj::detail {
+
+constexpr uint32_t kLumaBinShift = 3;
+
+struct SampleGrid {
+    const uint8_t* pixels{};
+    uint32_t strideBytes{};
+    uint32_t width{};
+    uint32_t height{};
+    uint32_t cols{};
+    uint32_t rows{};
+};
+
+inline uint32_t GridRowY(const SampleGrid& g, uint32_t r) {
+    return g.rows > 1 ? static_cast<uint32_t>(static_cast<uint64_t>(r) * (g.height - 1) / (g.rows - 1)) : 0;
+}
+
+inline uint32_t GridRunX(const SampleGrid& g, uint32_t c) {
+    return g.cols > 1 ? static_cast<uint32_t>(static_cast<uint64_t>(c) * (g.width - kSampleRun) / (g.cols - 1)) : 0;
+}
+
+inline uint32_t Luma(uint32_t b, uint32_t g, uint32_t r) {
+    return (29 * b + 150 * g + 77 * r + 128) >> 8;
+}
+
+using SampleStatsFn = void (*)(const SampleGrid& grid, SampleStats& out);
+
+void SampleStatsScalar(const SampleGrid& grid, SampleStats& out);
+void SampleStatsAvx2(const SampleGrid& grid, SampleStats& out);
+
+} // namespace rj::detail
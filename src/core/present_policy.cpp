@@ -0,0 +1,54 @@
+#include "core/present_policy.h"
+
+#include <algorithm>
+
+namespace rj {
+
+PresentPolicy::PresentPolicy(const PresentPolicyConfig& cfg) : m_cfg(cfg) {}
+
+void PresentPolicy::SetConfig(const PresentPolicyConfig& cfg) {
+    m_cfg = cfg;
+    m_forced = true;
+}
+
+PresentReason PresentPolicy::Decide(int64_t nowNs, uint64_t contentSequence, bool canRedraw) {
+    m_stats.passes++;
+    const bool newContent = !m_haveSequence || contentSequence != m_lastSequence;
+    m_haveSequence = true;
+    m_lastSequence = contentSequence;
+
+    PresentReason r = PresentReason::Skip;
+    if (newContent) {
+        r = PresentReason::NewContent;
+    } else if (!canRedraw) {
+        r = PresentReason::Skip;
+    } else if (!m_cfg.onNewContent) {
+        r = PresentReason::Always;
+    } else if (m_forced) {
+        r = PresentReason::Forced;
+    } else if (m_cfg.keepAliveNs > 0 && nowNs - m_lastPresentNs >= m_cfg.keepAliveNs) {
+        r = PresentReason::KeepAlive;
+    }
+
+    m_lastPresented = Presents(r);
+    if (m_lastPresented) {
+        m_forced = false;
+        m_lastPresentNs = nowNs;
+        m_stats.presents++;
+        if (r == PresentReason::KeepAlive) m_stats.keepAlives++;
+        if (r == PresentReason::Forced) m_stats.forced++;
+    }
+    return r;
+}
+
+int64_t PresentPolicy::NextPassNs(int64_t lastWakeNs, int64_t periodNs, int64_t nowNs) {
+    return std::max(nowNs, lastWakeNs + periodNs);
+}
+
+PresentPolicyStats PresentPolicy::TakeStats() {
+    const PresentPolicyStats s = m_stats;
+    m_stats = PresentPolicyStats{};
+    return s;
+}
+
+} // namespace rj
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/clock.h"
+
+namespace rj {
+
+struct PresentPolicyConfig {
+    // Present only passes that have something new to show. Off: every pass presents, as
+    // the render loop did before.
+    bool onNewContent = true;
+    // Present at least this often without new content, so the swap-chains and the stats
+    // keep moving on a static desktop. 0 disables it.
+    int64_t keepAliveNs = 1 * kNsPerSec;
+};
+
+enum class PresentReason : uint8_t {
+    Skip,        // nothing new: keep the last present on screen
+    NewContent,  // the content sequence moved
+    KeepAlive,   // nothing new for keepAliveNs
+    Forced,      // Force(): resize, mode or toggle change, swap-chain recreation
+    Always,      // policy off
+};
+
+struct PresentPolicyStats {
+    uint64_t passes{};
+    uint64_t presents{};
+    uint64_t keepAlives{};
+    uint64_t forced{};
+};
+
+// Decides, once per render loop pass, whether the outputs are drawn and presented. New
+// content is whatever moves `contentSequence` (g_captureCopiedFrameCounter in rj_span,
+// the copied frame count in FramePipeline).
+//
+// A pass that does not present leaves the frame-latency waitable unsignaled: the next
+// wait would time out instead of returning at the vblank. WaitableArmed() tells the
+// caller which one to use, and NextPassNs() is where to wake up instead.
+class PresentPolicy {
+public:
+    explicit PresentPolicy(const PresentPolicyConfig& cfg = {});
+
+    void SetConfig(const PresentPolicyConfig& cfg);
+    const PresentPolicyConfig& Config() const { return m_cfg; }
+
+    // The next pass presents whatever the content sequence says.
+    void Force() { m_forced = true; }
+
+    // `canRedraw`: the last content can be drawn again. False when it is gone (a zero-copy
+    // frame that was already released); such passes never present without new content.
+    PresentReason Decide(int64_t nowNs, uint64_t contentSequence, bool canRedraw = true);
+
+    // True when the last pass presented, so the frame-latency waitable will fire.
+    bool WaitableArmed() const { return m_lastPresented; }
+    // After a pass that did not present: one period after the previous wakeup, or `nowNs`
+    // when that is already past.
+    static int64_t NextPassNs(int64_t lastWakeNs, int64_t periodNs, int64_t nowNs);
+
+    // Stats since the last call.
+    PresentPolicyStats TakeStats();
+
+private:
+    PresentPolicyConfig m_cfg;
+    bool m_forced{true};
+    bool m_lastPresented{true};
+    bool m_haveSequence{};
+    uint64_t m_lastSequence{};
+    int64_t m_lastPresentNs{};
+    PresentPolicyStats m_stats{};
+};
+
+inline bool Presents(PresentReason r) {
+    return r != PresentReason::Skip;
+}
+
+} // namespace rj
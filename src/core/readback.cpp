@@ -0,0 +1,163 @@
+#include "core/readback.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace rj {
+
+bool PlanReadback(uint32_t sourceW, uint32_t sourceH, const Rect& region, uint32_t downsample, ReadbackPlan& plan) {
+    Rect r{0, 0, static_cast<int32_t>(sourceW), static_cast<int32_t>(sourceH)};
+    if (!region.Empty()) {
+        r.left = std::max(region.left, 0);
+        r.top = std::max(region.top, 0);
+        r.right = std::min(region.right, r.right);
+        r.bottom = std::min(region.bottom, r.bottom);
+    }
+    if (r.Empty()) return false;
+    const uint32_t w = static_cast<uint32_t>(r.Width());
+    const uint32_t h = static_cast<uint32_t>(r.Height());
+    const uint32_t ds = std::min({std::max(downsample, 1u), w, h});
+    plan.downsample = ds;
+    plan.width = w / ds;
+    plan.height = h / ds;
+    plan.rect = Rect{r.left, r.top, r.left + static_cast<int32_t>(plan.width * ds), r.top + static_cast<int32_t>(plan.height * ds)};
+    return true;
+}
+
+void DownsampleBox(const uint8_t* src, uint32_t srcStride, const ReadbackPlan& plan, uint8_t* dst, uint32_t dstStride) {
+    const uint32_t ds = plan.downsample;
+    const uint8_t* origin = src + static_cast<size_t>(plan.rect.top) * srcStride + static_cast<size_t>(plan.rect.left) * 4u;
+    if (ds == 1) {
+        for (uint32_t y = 0; y < plan.height; y++) std::memcpy(dst + static_cast<size_t>(y) * dstStride, origin + static_cast<size_t>(y) * srcStride, plan.width * 4u);
+        return;
+    }
+    const uint32_t n = ds * ds;
+    for (uint32_t y = 0; y < plan.height; y++) {
+        uint8_t* out = dst + static_cast<size_t>(y) * dstStride;
+        for (uint32_t x = 0; x < plan.width; x++) {
+            uint32_t sum[4] = {};
+            const uint8_t* box = origin + static_cast<size_t>(y) * ds * srcStride + static_cast<size_t>(x) * ds * 4u;
+            for (uint32_t by = 0; by < ds; by++) {
+                const uint8_t* p = box + static_cast<size_t>(by) * srcStride;
+                for (uint32_t bx = 0; bx < ds; bx++, p += 4) {
+                    sum[0] += p[0];
+                    sum[1] += p[1];
+                    sum[2] += p[2];
+                    sum[3] += p[3];
+                }
+            }
+            for (int c = 0; c < 4; c++) out[x * 4u + c] = static_cast<uint8_t>((sum[c] + n / 2) / n);
+        }
+    }
+}
+
+ReadbackQueue::ReadbackQueue(IReadbackDevice& device, const ReadbackConfig& cfg) : m_device(device), m_cfg(cfg) {
+    m_cfg.slots = std::max(m_cfg.slots, 1u);
+    m_slots.resize(m_cfg.slots);
+}
+
+uint64_t ReadbackQueue::Request(uint32_t sourceW, uint32_t sourceH, const Rect& region, uint32_t downsample, uint64_t tag, int64_t nowNs) {
+    m_stats.requested++;
+    ReadbackPlan plan;
+    Slot* free = nullptr;
+    for (Slot& s : m_slots) {
+        if (s.state == SlotState::Free) {
+            free = &s;
+            break;
+        }
+    }
+    if (!free || !PlanReadback(sourceW, sourceH, region, downsample, plan) ||
+        !m_device.Copy(static_cast<uint32_t>(free - m_slots.data()), plan)) {
+        m_stats.dropped++;
+        return 0;
+    }
+    free->state = SlotState::Copying;
+    free->id = m_nextId++;
+    free->tag = tag;
+    free->plan = plan;
+    free->frame = m_frame;
+    free->requestNs = nowNs;
+    free->readyNs = 0;
+    free->mapping = ReadbackMapping{};
+    return free->id;
+}
+
+void ReadbackQueue::Poll(int64_t nowNs) {
+    m_frame++;
+    // Oldest first: the GPU finishes copies in order, so once one is busy the rest are too.
+    for (;;) {
+        Slot* next = nullptr;
+        for (Slot& s : m_slots) {
+            if (s.state == SlotState::Copying && (!next || s.id < next->id)) next = &s;
+        }
+        if (!next || m_frame - next->frame < m_cfg.mapDelayFrames) return;
+        const uint32_t slot = static_cast<uint32_t>(next - m_slots.data());
+        const ReadbackMapResult r = m_device.Map(slot, false, next->mapping);
+        if (r == ReadbackMapResult::Busy) {
+            m_stats.busyMaps++;
+            return;
+        }
+        if (r == ReadbackMapResult::Failed) {
+            m_stats.failedMaps++;
+            m_stats.dropped++;
+            next->state = SlotState::Free;
+            continue;
+        }
+        next->state = SlotState::Ready;
+        next->readyNs = nowNs;
+        const uint64_t frames = m_frame - next->frame;
+        const int64_t ns = nowNs - next->requestNs;
+        m_stats.completed++;
+        m_stats.latencyFramesSum += frames;
+        m_stats.latencyFramesMax = std::max(m_stats.latencyFramesMax, frames);
+        m_stats.latencyNsSum += ns;
+        m_stats.latencyNsMax = std::max(m_stats.latencyNsMax, ns);
+    }
+}
+
+bool ReadbackQueue::Take(ReadbackResult& out) {
+    Slot* oldest = nullptr;
+    for (Slot& s : m_slots) {
+        if (s.state == SlotState::Ready && (!oldest || s.id < oldest->id)) oldest = &s;
+    }
+    if (!oldest) return false;
+    oldest->state = SlotState::Taken;
+    out.id = oldest->id;
+    out.tag = oldest->tag;
+    out.plan = oldest->plan;
+    out.pixels = oldest->mapping.pixels;
+    out.strideBytes = oldest->mapping.strideBytes;
+    out.latencyFrames = m_frame - oldest->frame;
+    out.requestNs = oldest->requestNs;
+    out.readyNs = oldest->readyNs;
+    return true;
+}
+
+void ReadbackQueue::Release(uint64_t id) {
+    for (Slot& s : m_slots) {
+        if (s.id != id || s.state == SlotState::Free) continue;
+        if (s.state != SlotState::Copying) m_device.Unmap(static_cast<uint32_t>(&s - m_slots.data()));
+        s.state = SlotState::Free;
+    }
+}
+
+void ReadbackQueue::Reset() {
+    for (Slot& s : m_slots) {
+        if (s.state == SlotState::Ready || s.state == SlotState::Taken) m_device.Unmap(static_cast<uint32_t>(&s - m_slots.data()));
+        s.state = SlotState::Free;
+    }
+}
+
+uint32_t ReadbackQueue::InFlight() const {
+    uint32_t n = 0;
+    for (const Slot& s : m_slots) n += s.state != SlotState::Free;
+    return n;
+}
+
+ReadbackStats ReadbackQueue::TakeStats() {
+    const ReadbackStats s = m_stats;
+    m_stats = ReadbackStats{};
+    return s;
+}
+
+} // namespace rj
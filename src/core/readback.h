@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/frame.h"
+
+namespace rj {
+
+// What a readback copies: `rect` of the source (clamped, and trimmed so every output pixel
+// averages a whole `downsample` x `downsample` box), giving `width` x `height` pixels.
+struct ReadbackPlan {
+    Rect rect{};
+    uint32_t downsample = 1;
+    uint32_t width{};
+    uint32_t height{};
+};
+
+// Plans a read of `region` (empty: the whole source) of a sourceW x sourceH surface. A
+// region smaller than one box shrinks the box. False if the region misses the source.
+bool PlanReadback(uint32_t sourceW, uint32_t sourceH, const Rect& region, uint32_t downsample, ReadbackPlan& plan);
+
+// Box filter of 4-byte pixels, per channel rounded to nearest: the CPU reference for the
+// GPU downsample (a plain copy at downsample 1). `src` points at the source's origin.
+void DownsampleBox(const uint8_t* src, uint32_t srcStride, const ReadbackPlan& plan, uint8_t* dst, uint32_t dstStride);
+
+enum class ReadbackMapResult {
+    Mapped,
+    Busy,  // the copy has not finished; mapping now would stall
+    Failed,
+};
+
+struct ReadbackMapping {
+    const uint8_t* pixels{};
+    uint32_t strideBytes{};
+};
+
+// GPU side of the readbacks of one ReadbackQueue: a set of staging surfaces over the
+// device's current source (D3D11 staging textures in rj_span, MockReadbackDevice here).
+class IReadbackDevice {
+public:
+    virtual ~IReadbackDevice() = default;
+
+    // Queues the copy of `plan` from the current source into staging surface `slot`,
+    // (re)creating it at plan.width x plan.height. False if it can't.
+    virtual bool Copy(uint32_t slot, const ReadbackPlan& plan) = 0;
+    // Maps the slot's last copy. Without `wait`, a copy still in flight returns Busy.
+    virtual ReadbackMapResult Map(uint32_t slot, bool wait, ReadbackMapping& out) = 0;
+    virtual void Unmap(uint32_t slot) = 0;
+};
+
+struct ReadbackConfig {
+    // Staging surfaces. A result the caller holds keeps its surface.
+    uint32_t slots = 3;
+    // Frames (Poll() calls) between a copy and the first attempt to map it; by then the GPU
+    // has normally finished it, and if not the map is retried on the next frame.
+    uint32_t mapDelayFrames = 2;
+};
+
+struct ReadbackStats {
+    uint64_t requested{};
+    uint64_t completed{};
+    uint64_t dropped{};    // no free surface, or the copy failed
+    uint64_t busyMaps{};   // map attempts that found the copy unfinished: stalls avoided
+    uint64_t failedMaps{};
+    uint64_t latencyFramesSum{};  // copy to result, in frames
+    uint64_t latencyFramesMax{};
+    int64_t latencyNsSum{};
+    int64_t latencyNsMax{};
+};
+
+struct ReadbackResult {
+    uint64_t id{};
+    uint64_t tag{};
+    ReadbackPlan plan{};
+    const uint8_t* pixels{};  // plan.width x plan.height, valid until Release(id)
+    uint32_t strideBytes{};
+    uint64_t latencyFrames{};
+    int64_t requestNs{};
+    int64_t readyNs{};
+};
+
+// Ring of staging surfaces with delayed, non-blocking maps: Request() queues a GPU copy
+// (sub-rectangle and/or box-downsampled), Poll() once per frame maps the copies whose delay
+// is up and never waits for the GPU, Take() hands out results in request order. Requests
+// fail rather than wait when every surface is busy. One thread.
+class ReadbackQueue {
+public:
+    explicit ReadbackQueue(IReadbackDevice& device, const ReadbackConfig& cfg = ReadbackConfig{});
+
+    // Reads `region` (empty: all) of the device's current sourceW x sourceH source, averaged
+    // over `downsample` boxes. Returns the request id, or 0 if it was dropped.
+    uint64_t Request(uint32_t sourceW, uint32_t sourceH, const Rect& region, uint32_t downsample, uint64_t tag, int64_t nowNs);
+    // Counts a frame and maps the copies that are due.
+    void Poll(int64_t nowNs);
+    // The oldest mapped result, if any; it stays mapped until Release().
+    bool Take(ReadbackResult& out);
+    void Release(uint64_t id);
+    // Unmaps everything and forgets the copies in flight (device teardown).
+    void Reset();
+
+    uint32_t InFlight() const;
+    const ReadbackConfig& Config() const { return m_cfg; }
+    ReadbackStats Stats() const { return m_stats; }
+    ReadbackStats TakeStats();
+
+private:
+    enum class SlotState { Free, Copying, Ready, Taken };
+    struct Slot {
+        SlotState state = SlotState::Free;
+        uint64_t id{};
+        uint64_t tag{};
+        ReadbackPlan plan{};
+        uint64_t frame{};
+        int64_t requestNs{};
+        int64_t readyNs{};
+        ReadbackMapping mapping{};
+    };
+
+    IReadbackDevice& m_device;
+    ReadbackConfig m_cfg;
+    std::vector<Slot> m_slots;
+    uint64_t m_nextId{1};
+    uint64_t m_frame{};
+    ReadbackStats m_stats{};
+};
+
+} // namespace rj
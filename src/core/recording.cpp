@@ -0,0 +1,97 @@
+#include "core/recording.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace rj {
+
+namespace {
+
+// The record at `offset` fits before `limit` and is self-consistent.
+bool ValidRecord(const uint8_t* base, uint64_t offset, uint64_t limit) {
+    if (offset % 8 != 0 || offset < sizeof(RecordSegmentHeader) || offset + sizeof(RecordHeader) > limit) return false;
+    const RecordHeader* h = reinterpret_cast<const RecordHeader*>(base + offset);
+    if (h->magic != kRecordMagic || h->bytes < sizeof(RecordHeader) || h->bytes % 8 != 0 || offset + h->bytes > limit) return false;
+    const uint64_t body = sizeof(RecordHeader) + static_cast<uint64_t>(h->dirtyRectCount) * sizeof(Rect) + h->payloadBytes;
+    if (body > h->bytes) return false;
+    switch (static_cast<RecordPayload>(h->payload)) {
+        case RecordPayload::None:
+        case RecordPayload::Codec:
+            return true;
+        case RecordPayload::Raw: {
+            const uint64_t row = static_cast<uint64_t>(h->width) * BytesPerPixel(static_cast<PixelFormat>(h->format));
+            return row > 0 && h->strideBytes >= row && static_cast<uint64_t>(h->strideBytes) * h->height == h->payloadBytes;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+std::string RecordingSegmentPath(const std::string& base, uint32_t segment) {
+    char suffix[16];
+    snprintf(suffix, sizeof(suffix), "_%04u.rjr", segment);
+    return base + suffix;
+}
+
+bool RecordingReader::Open(const char* basePath) {
+    Close();
+    for (uint32_t segment = 0;; segment++) {
+        auto file = std::make_unique<MappedFile>();
+        if (!file->Open(RecordingSegmentPath(basePath, segment).c_str()) || !AddSegment(*file, segment)) break;
+        m_segments.push_back(std::move(file));
+    }
+    return !m_segments.empty();
+}
+
+void RecordingReader::Close() {
+    m_segments.clear();
+    m_frames.clear();
+    m_recovered = 0;
+}
+
+bool RecordingReader::AddSegment(const MappedFile& file, uint32_t segment) {
+    const uint8_t* base = file.Data();
+    const uint64_t size = file.Size();
+    if (size < sizeof(RecordSegmentHeader)) return false;
+    RecordSegmentHeader h{};
+    std::memcpy(&h, base, sizeof(h));
+    if (std::memcmp(h.magic, kRecordSegmentMagic, sizeof(h.magic)) != 0 || h.version != kRecordingVersion || h.segment != segment) return false;
+
+    const size_t first = m_frames.size();
+    if (h.indexOffset != 0) {
+        const uint64_t indexBytes = static_cast<uint64_t>(h.frameCount) * sizeof(RecordIndexEntry);
+        if (h.indexOffset % 8 != 0 || h.indexOffset > size || indexBytes > size - h.indexOffset) return false;
+        const RecordIndexEntry* index = reinterpret_cast<const RecordIndexEntry*>(base + h.indexOffset);
+        for (uint32_t i = 0; i < h.frameCount; i++) {
+            if (!ValidRecord(base, index[i].offset, h.indexOffset)) {
+                m_frames.resize(first);
+                return false;
+            }
+            m_frames.push_back(Entry{segment, index[i].offset});
+        }
+        return true;
+    }
+
+    // No index: the writer never closed this segment.
+    uint64_t offset = sizeof(RecordSegmentHeader);
+    while (ValidRecord(base, offset, size)) {
+        m_frames.push_back(Entry{segment, offset});
+        offset += reinterpret_cast<const RecordHeader*>(base + offset)->bytes;
+    }
+    m_recovered++;
+    return true;
+}
+
+RecordedFrame RecordingReader::Frame(size_t index) const {
+    const Entry& e = m_frames[index];
+    const uint8_t* p = m_segments[e.segment]->Data() + e.offset;
+    RecordedFrame f;
+    f.header = reinterpret_cast<const RecordHeader*>(p);
+    f.dirtyRects = f.header->dirtyRectCount ? reinterpret_cast<const Rect*>(p + sizeof(RecordHeader)) : nullptr;
+    f.payload = p + sizeof(RecordHeader) + static_cast<size_t>(f.header->dirtyRectCount) * sizeof(Rect);
+    f.segmentStart = index == 0 || m_frames[index - 1].segment != e.segment;
+    return f;
+}
+
+} // namespace rj
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/frame.h"
+#include "core/mapped_file.h"
+
+namespace rj {
+
+// On-disk layout of a capture recording (CaptureRecorder writes it, RecordingReader and
+// ReplaySource read it). A session is a series of segment files <base>_0000.rjr,
+// <base>_0001.rjr, ..., each created at its full size, filled front to back through a
+// mapping and cut to what was used when it is closed (little-endian):
+//   RecordSegmentHeader
+//   records, 8-byte aligned:  RecordHeader, Rect dirty[dirtyRectCount], payload
+//   RecordIndexEntry index[frameCount]     appended when the segment is closed
+// A record's header is stored after its body, so a segment left without an index (the
+// process died) is recovered by walking records up to the first zero header. Codec
+// payloads restart with a keyframe in every segment, so segments decode on their own.
+struct RecordSegmentHeader {
+    char magic[8];  // "RJREC001"
+    uint32_t version;
+    uint32_t segment;      // position in the session
+    uint64_t indexOffset;  // 0 until the segment is closed
+    uint32_t frameCount;   // valid with indexOffset
+    uint32_t reserved;
+};
+
+enum class RecordPayload : uint8_t {
+    None = 0,   // timing and damage only (GPU frames, or pixels off)
+    Raw = 1,    // rows of width * bytes-per-pixel, back to back
+    Codec = 2,  // one FrameEncoder frame
+};
+
+struct RecordHeader {
+    uint32_t magic;  // kRecordMagic
+    uint32_t bytes;  // whole record, this header included; multiple of 8
+    uint64_t sequence;
+    int64_t captureTimeNs;
+    int64_t acquireTimeNs;  // when the capture path got the frame
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;  // PixelFormat
+    uint32_t accumulatedFrames;
+    uint32_t dirtyRectCount;
+    uint32_t strideBytes;  // of Raw payload rows
+    uint32_t payloadBytes;
+    uint8_t payload;  // RecordPayload
+    uint8_t flags;    // kRecord*
+    uint16_t reserved;
+};
+
+struct RecordIndexEntry {
+    uint64_t offset;  // of the RecordHeader
+    int64_t acquireTimeNs;
+};
+
+inline constexpr char kRecordSegmentMagic[8] = {'R', 'J', 'R', 'E', 'C', '0', '0', '1'};
+constexpr uint32_t kRecordMagic = 0x52464A52u;  // "RJFR"
+constexpr uint32_t kRecordingVersion = 1;
+// The frame only moved the pointer (DD LastPresentTime == 0).
+constexpr uint8_t kRecordPointerOnly = 1;
+
+static_assert(sizeof(RecordSegmentHeader) == 32, "segment header layout");
+static_assert(sizeof(RecordHeader) == 64, "record header layout");
+static_assert(sizeof(RecordIndexEntry) == 16, "index entry layout");
+
+// <base>_NNNN.rjr
+std::string RecordingSegmentPath(const std::string& base, uint32_t segment);
+
+// One recorded frame, pointing into the mapped segment.
+struct RecordedFrame {
+    const RecordHeader* header{};
+    const Rect* dirtyRects{};
+    const uint8_t* payload{};
+    bool segmentStart{};  // first frame of its segment
+};
+
+// Maps every segment of a recording read-only and indexes its frames.
+class RecordingReader {
+public:
+    // Opens <base>_0000.rjr and the segments after it. Fails if there is no valid first
+    // segment; stops at the first missing or invalid one after that.
+    bool Open(const char* basePath);
+    void Close();
+
+    size_t FrameCount() const { return m_frames.size(); }
+    RecordedFrame Frame(size_t index) const;
+    uint32_t Segments() const { return static_cast<uint32_t>(m_segments.size()); }
+    // Segments that had no index and were recovered by walking their records.
+    uint32_t RecoveredSegments() const { return m_recovered; }
+
+private:
+    bool AddSegment(const MappedFile& file, uint32_t segment);
+
+    struct Entry {
+        uint32_t segment{};
+        uint64_t offset{};
+    };
+    std::vector<std::unique_ptr<MappedFile>> m_segments;
+    std::vector<Entry> m_frames;
+    uint32_t m_recovered{};
+};
+
+} // namespace rj
@@ -0,0 +1,165 @@
+#include "core/rect_coalescer.h"
+
+#include <algorithm>
+
+namespace rj {
+
+Rect IntersectRect(const Rect& a, const Rect& b) {
+    Rect r{std::max(a.left, b.left), std::max(a.top, b.top), std::min(a.right, b.right), std::min(a.bottom, b.bottom)};
+    if (r.Empty()) return Rect{};
+    return r;
+}
+
+Rect UnionRect(const Rect& a, const Rect& b) {
+    if (a.Empty()) return b;
+    if (b.Empty()) return a;
+    return Rect{std::min(a.left, b.left), std::min(a.top, b.top), std::max(a.right, b.right), std::max(a.bottom, b.bottom)};
+}
+
+namespace {
+
+struct Region {
+    Rect bounds;
+    uint64_t content{};  // changed pixels inside bounds (upper bound of the real count)
+};
+
+bool MergeIsCheap(const Region& a, const Region& b, float maxWaste, Region& merged) {
+    merged.bounds = UnionRect(a.bounds, b.bounds);
+    merged.content = a.content + b.content;
+    const uint64_t area = RectArea(merged.bounds);
+    return static_cast<double>(area) - static_cast<double>(merged.content) <= static_cast<double>(maxWaste) * static_cast<double>(area);
+}
+
+} // namespace
+
+RectCoalescer::RectCoalescer(const CoalescerConfig& cfg) : m_cfg(cfg) {
+    if (m_cfg.cellSize == 0) m_cfg.cellSize = 128;
+}
+
+void RectCoalescer::Resize(uint32_t width, uint32_t height) {
+    if (width == m_width && height == m_height) return;
+    m_width = width;
+    m_height = height;
+    m_cellsX = (width + m_cfg.cellSize - 1) / m_cfg.cellSize;
+    m_cellsY = (height + m_cfg.cellSize - 1) / m_cfg.cellSize;
+    m_cellBounds.assign(static_cast<size_t>(m_cellsX) * m_cellsY, Rect{});
+    m_touched.clear();
+}
+
+void RectCoalescer::MarkDirty(const Rect& rect) {
+    const Rect r = IntersectRect(rect, Rect{0, 0, static_cast<int32_t>(m_width), static_cast<int32_t>(m_height)});
+    if (r.Empty()) return;
+    const int32_t cs = static_cast<int32_t>(m_cfg.cellSize);
+    for (int32_t cy = r.top / cs; cy <= (r.bottom - 1) / cs; cy++) {
+        for (int32_t cx = r.left / cs; cx <= (r.right - 1) / cs; cx++) {
+            const Rect cell{cx * cs, cy * cs, (cx + 1) * cs, (cy + 1) * cs};
+            const size_t idx = static_cast<size_t>(cy) * m_cellsX + static_cast<size_t>(cx);
+            Rect& b = m_cellBounds[idx];
+            if (b.Empty()) m_touched.push_back(static_cast<uint32_t>(idx));
+            b = UnionRect(b, IntersectRect(cell, r));
+        }
+    }
+}
+
+// Greedy merge: cells into horizontal runs per grid row, then runs into the regions of the
+// previous row. Regions that stop growing are emitted.
+void RectCoalescer::EmitMergedCells() {
+    std::sort(m_touched.begin(), m_touched.end());
+
+    std::vector<Region> open;
+    std::vector<Region> next;
+    std::vector<Region> runs;
+    size_t t = 0;
+    for (uint32_t cy = 0; cy < m_cellsY; cy++) {
+        runs.clear();
+        const size_t rowEnd = static_cast<size_t>(cy + 1) * m_cellsX;
+        for (; t < m_touched.size() && m_touched[t] < rowEnd; t++) {
+            const Region cell{m_cellBounds[m_touched[t]], RectArea(m_cellBounds[m_touched[t]])};
+            Region merged;
+            if (!runs.empty() && MergeIsCheap(runs.back(), cell, m_cfg.mergeWaste, merged)) {
+                runs.back() = merged;
+            } else {
+                runs.push_back(cell);
+            }
+        }
+
+        next.clear();
+        for (const Region& run : runs) {
+            bool absorbed = false;
+            for (Region& o : open) {
+                if (o.bounds.Empty()) continue;
+                Region merged;
+                if (MergeIsCheap(o, run, m_cfg.mergeWaste, merged)) {
+                    next.push_back(merged);
+                    o.bounds = Rect{};
+                    absorbed = true;
+                    break;
+                }
+            }
+            if (!absorbed) next.push_back(run);
+        }
+        for (const Region& o : open) {
+            if (!o.bounds.Empty()) m_plan.copies.push_back(o.bounds);
+        }
+        open.swap(next);
+    }
+    for (const Region& o : open) m_plan.copies.push_back(o.bounds);
+}
+
+const CompositePlan& RectCoalescer::BuildFull() {
+    m_plan.moves.clear();
+    m_plan.copies.clear();
+    m_plan.fullCopy = true;
+    m_plan.surfacePixels = static_cast<uint64_t>(m_width) * m_height;
+    m_plan.copiedPixels = m_plan.surfacePixels;
+    return m_plan;
+}
+
+const CompositePlan& RectCoalescer::Build(const MoveRect* moves, uint32_t moveCount, const Rect* dirty, uint32_t dirtyCount) {
+    for (uint32_t idx : m_touched) m_cellBounds[idx] = Rect{};
+    m_touched.clear();
+    m_plan.moves.clear();
+    m_plan.copies.clear();
+    m_plan.fullCopy = false;
+    m_plan.surfacePixels = static_cast<uint64_t>(m_width) * m_height;
+    m_plan.copiedPixels = 0;
+
+    const Rect surface{0, 0, static_cast<int32_t>(m_width), static_cast<int32_t>(m_height)};
+    for (uint32_t i = 0; i < moveCount; i++) {
+        const MoveRect& mv = moves[i];
+        const Rect src{mv.srcX, mv.srcY, mv.srcX + mv.dst.Width(), mv.srcY + mv.dst.Height()};
+        const Rect srcClip = IntersectRect(src, surface);
+        const Rect dstClip = IntersectRect(mv.dst, surface);
+        if (srcClip.Empty() || dstClip.Empty()) continue;
+
+        // The texture is updated in place, so a move can't read pixels that this move or an
+        // earlier one already overwrote. Those become plain copies from the new frame.
+        bool demote = srcClip.Width() != src.Width() || srcClip.Height() != src.Height() || !IntersectRect(src, mv.dst).Empty();
+        for (const BlitOp& prev : m_plan.moves) {
+            if (demote) break;
+            const Rect prevDst{prev.dstX, prev.dstY, prev.dstX + prev.src.Width(), prev.dstY + prev.src.Height()};
+            demote = !IntersectRect(src, prevDst).Empty();
+        }
+        if (demote) {
+            MarkDirty(mv.dst);
+            continue;
+        }
+        m_plan.moves.push_back(BlitOp{src, mv.dst.left, mv.dst.top});
+        m_plan.copiedPixels += RectArea(src);
+    }
+
+    for (uint32_t i = 0; i < dirtyCount; i++) MarkDirty(dirty[i]);
+    EmitMergedCells();
+
+    uint64_t copyPixels = 0;
+    for (const Rect& r : m_plan.copies) copyPixels += RectArea(r);
+    m_plan.copiedPixels += copyPixels;
+
+    if (m_plan.copies.size() > m_cfg.maxCopies ||
+        static_cast<double>(m_plan.copiedPixels) > static_cast<double>(m_cfg.fullCopyFraction) * static_cast<double>(m_plan.surfacePixels)) {
+        return BuildFull();
+    }
+    return m_plan;
+}
+
+} // namespace rj
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/frame.h"
+
+namespace rj {
+
+// Same meaning as DXGI_OUTDUPL_MOVE_RECT: the pixels now at `dst` came from the rectangle of
+// the same size at (srcX, srcY) in the previous frame.
+struct MoveRect {
+    int32_t srcX{};
+    int32_t srcY{};
+    Rect dst{};
+};
+
+// One blit inside the composited texture (previous content -> new position).
+struct BlitOp {
+    Rect src{};
+    int32_t dstX{};
+    int32_t dstY{};
+};
+
+struct CoalescerConfig {
+    // Dirty rects are merged per grid cell of this size.
+    uint32_t cellSize = 128;
+
+    // Merge neighbouring regions when the merged rectangle wastes at most this fraction of
+    // its area on unchanged pixels. Fewer, larger copies beat many small ones.
+    float mergeWaste = 0.25f;
+
+    // Above this fraction of the surface, or this many copy ops, copy the whole surface.
+    float fullCopyFraction = 0.6f;
+    uint32_t maxCopies = 64;
+};
+
+// Copy plan for one duplicated surface. Apply `moves` in order first (they read the
+// texture's previous content), then copy `copies` from the newly acquired frame.
+struct CompositePlan {
+    bool fullCopy{};
+    std::vector<BlitOp> moves;
+    std::vector<Rect> copies;
+    uint64_t copiedPixels{};  // pixels written by moves + copies (the full surface when fullCopy)
+    uint64_t surfacePixels{};
+};
+
+// Turns Desktop Duplication dirty/move metadata into a small set of copy operations so only
+// changed regions of a monitor tile are copied into the wide texture.
+//
+// Moves whose source and destination overlap (scrolling) cannot be done as a single
+// in-texture copy; they are demoted to dirty regions and copied from the new frame.
+class RectCoalescer {
+public:
+    explicit RectCoalescer(const CoalescerConfig& cfg = CoalescerConfig{});
+
+    // Sets the surface size. Cheap when unchanged.
+    void Resize(uint32_t width, uint32_t height);
+
+    const CompositePlan& Build(const MoveRect* moves, uint32_t moveCount, const Rect* dirty, uint32_t dirtyCount);
+    const CompositePlan& BuildFull();
+
+    const CompositePlan& Plan() const { return m_plan; }
+
+private:
+    void MarkDirty(const Rect& r);
+    void EmitMergedCells();
+
+    CoalescerConfig m_cfg;
+    uint32_t m_width{};
+    uint32_t m_height{};
+    uint32_t m_cellsX{};
+    uint32_t m_cellsY{};
+    std::vector<Rect> m_cellBounds;  // per cell: union of dirty pixels inside it (empty if clean)
+    std::vector<uint32_t> m_touched;  // indices of cells with content, to reset cheaply
+    CompositePlan m_plan;
+};
+
+// Geometry helpers shared with the copy planners.
+Rect IntersectRect(const Rect& a, const Rect& b);
+Rect UnionRect(const Rect& a, const Rect& b);
+inline uint64_t RectArea(const Rect& r) {
+    return r.Empty() ? 0 : static_cast<uint64_t>(r.Width()) * static_cast<uint64_t>(r.Height());
+}
+
+} // namespace rj
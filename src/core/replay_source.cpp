@@ -0,0 +1,111 @@
+#include "core/replay_source.h"
+
+namespace rj {
+
+namespace {
+
+CodecConfig DecoderConfig(const ReplayConfig& cfg) {
+    CodecConfig c;
+    c.threads = cfg.threads;
+    return c;
+}
+
+} // namespace
+
+ReplaySource::ReplaySource(Clock& clock, const ReplayConfig& cfg) : m_clock(clock), m_cfg(cfg), m_decoder(DecoderConfig(cfg)) {}
+
+bool ReplaySource::Open(const char* basePath) {
+    m_current = nullptr;
+    m_next = 0;
+    m_replayed = 0;
+    m_loops = 0;
+    m_started = false;
+    m_decoder.Reset();
+    if (!m_reader.Open(basePath) || m_reader.FrameCount() == 0) return false;
+
+    const RecordHeader& first = *m_reader.Frame(0).header;
+    const RecordHeader& last = *m_reader.Frame(m_reader.FrameCount() - 1).header;
+    const int64_t recordedNs = last.acquireTimeNs - first.acquireTimeNs;
+    const size_t intervals = m_reader.FrameCount() - 1;
+    m_firstNs = first.acquireTimeNs;
+    m_loopSpanNs = recordedNs + (intervals > 0 ? recordedNs / static_cast<int64_t>(intervals) : kNsPerSec / 60);
+    m_sequenceSpan = last.sequence >= first.sequence ? last.sequence - first.sequence + 1 : m_reader.FrameCount();
+    return true;
+}
+
+void ReplaySource::Rewind() {
+    m_next = 0;
+    m_loops++;
+    m_startNs += m_loopSpanNs;
+    m_decoder.Reset();
+}
+
+AcquireResult ReplaySource::Acquire(uint32_t timeoutMs, FrameDesc& out) {
+    if (m_reader.FrameCount() == 0) return AcquireResult::Error;
+    int64_t now = m_clock.NowNs();
+    if (!m_started) {
+        m_startNs = now;
+        m_started = true;
+    }
+    if (m_next == m_reader.FrameCount()) {
+        if (!m_cfg.loop) {
+            if (timeoutMs > 0) m_clock.SleepForNs(static_cast<int64_t>(timeoutMs) * kNsPerMs);
+            return AcquireResult::Timeout;
+        }
+        Rewind();
+    }
+
+    const RecordedFrame f = m_reader.Frame(m_next);
+    const RecordHeader& h = *f.header;
+    bool fullDamage = m_next == 0 || f.segmentStart;
+    int64_t due = now;
+    if (m_cfg.timing == ReplayTiming::Original) {
+        due = m_startNs + (h.acquireTimeNs - m_firstNs);
+        if (now < due) {
+            if (timeoutMs == 0) return AcquireResult::Timeout;
+            const int64_t deadline = now + static_cast<int64_t>(timeoutMs) * kNsPerMs;
+            if (deadline < due) {
+                m_clock.SleepUntilNs(deadline);
+                return AcquireResult::Timeout;
+            }
+            m_clock.SleepUntilNs(due);
+        }
+    }
+    m_next++;
+
+    const PixelFormat format = static_cast<PixelFormat>(h.format);
+    out = FrameDesc{};
+    out.strideBytes = h.width * BytesPerPixel(format);
+    switch (static_cast<RecordPayload>(h.payload)) {
+        case RecordPayload::Codec:
+            if (!m_decoder.Decode(f.payload, h.payloadBytes) || m_decoder.Width() != h.width || m_decoder.Height() != h.height) {
+                return AcquireResult::Error;
+            }
+            out.pixels = m_decoder.Frame().data();
+            out.strideBytes = h.width * 4u;
+            fullDamage = fullDamage || m_decoder.Keyframe();
+            break;
+        case RecordPayload::Raw:
+            out.pixels = f.payload;
+            out.strideBytes = h.strideBytes;
+            break;
+        case RecordPayload::None:
+            break;
+    }
+
+    m_current = f.header;
+    m_replayed++;
+    out.sequence = h.sequence + m_loops * m_sequenceSpan;
+    out.captureTimeNs = due - (h.acquireTimeNs - h.captureTimeNs);
+    out.width = h.width;
+    out.height = h.height;
+    out.format = format;
+    if (!fullDamage) {
+        out.dirtyRects = f.dirtyRects;
+        out.dirtyRectCount = h.dirtyRectCount;
+    }
+    out.accumulatedFrames = h.accumulatedFrames;
+    return AcquireResult::NewFrame;
+}
+
+} // namespace rj
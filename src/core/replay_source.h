@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/capture_source.h"
+#include "core/clock.h"
+#include "core/frame_codec.h"
+#include "core/recording.h"
+
+namespace rj {
+
+enum class ReplayTiming {
+    // Each frame becomes available at its recorded acquire time, relative to the first
+    // Acquire(). A late caller gets the frames one by one, never folded, so every recorded
+    // frame reaches the pipeline.
+    Original,
+    // Every Acquire() returns the next frame at once.
+    AsFastAsPossible,
+};
+
+struct ReplayConfig {
+    ReplayTiming timing = ReplayTiming::Original;
+    // Start over after the last frame, one average frame interval later. Off: Acquire()
+    // times out once the recording is exhausted.
+    bool loop = false;
+    // Threads decoding coded frames.
+    uint32_t threads = 1;
+};
+
+// Capture source playing back a CaptureRecorder session on any clock, so recorded field
+// sessions run through the headless pipeline. Frames carry their recorded size, dirty rects
+// and accumulated count; capture timestamps keep their recorded distance to the acquire
+// time. Pixels (when recorded) stay valid until the next Acquire().
+//
+// The recorded dirty rects are relative to the frame before it in the recording, which a
+// consumer hasn't seen at the start of playback, after a loop, at a segment start or on a
+// keyframe. Those frames come without dirty rects, i.e. fully changed.
+class ReplaySource final : public ICaptureSource {
+public:
+    ReplaySource(Clock& clock, const ReplayConfig& cfg = ReplayConfig{});
+
+    // Maps the session at `basePath` (see RecordingReader::Open).
+    bool Open(const char* basePath);
+
+    const char* Name() const override { return "replay"; }
+    AcquireResult Acquire(uint32_t timeoutMs, FrameDesc& out) override;
+    void Release() override {}
+
+    const RecordingReader& Reader() const { return m_reader; }
+    uint64_t FramesReplayed() const { return m_replayed; }
+    uint64_t Loops() const { return m_loops; }
+    // Recorded header of the most recently acquired frame.
+    const RecordHeader* Current() const { return m_current; }
+
+private:
+    void Rewind();
+
+    Clock& m_clock;
+    ReplayConfig m_cfg;
+    RecordingReader m_reader;
+    FrameDecoder m_decoder;
+    const RecordHeader* m_current{};
+    size_t m_next{};
+    int64_t m_startNs{};     // clock time the first recorded frame maps to
+    int64_t m_firstNs{};     // recorded acquire time of the first frame
+    int64_t m_loopSpanNs{};  // recorded time between two passes
+    uint64_t m_sequenceSpan{};
+    uint64_t m_replayed{};
+    uint64_t m_loops{};
+    bool m_started{};
+};
+
+} // namespace rj
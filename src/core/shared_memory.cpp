@@ -0,0 +1,147 @@
+#include "core/shared_memory.h"
+
+#include <algorithm>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <sddl.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rj {
+
+namespace {
+
+#if defined(_WIN32)
+std::wstring MappingName(const char* name) {
+    std::wstring w = L"Global\\";
+    for (const char* p = name; *p; p++) w.push_back(static_cast<wchar_t>(*p));
+    return w;
+}
+#else
+std::string ShmName(const char* name) {
+    return std::string("/") + name;
+}
+#endif
+
+} // namespace
+
+SharedMemory::~SharedMemory() {
+    Close();
+}
+
+#if defined(_WIN32)
+
+bool SharedMemory::Create(const char* name, size_t bytes) {
+    Close();
+    SECURITY_ATTRIBUTES sa{};
+    sa.nLength = sizeof(sa);
+    PSECURITY_DESCRIPTOR sd = nullptr;
+    if (ConvertStringSecurityDescriptorToSecurityDescriptorW(kSharedObjectSddl, SDDL_REVISION_1, &sd, nullptr)) {
+        sa.lpSecurityDescriptor = sd;
+    }
+    const uint64_t size = bytes;
+    HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE,
+                                        sd ? &sa : nullptr,
+                                        PAGE_READWRITE,
+                                        static_cast<DWORD>(size >> 32),
+                                        static_cast<DWORD>(size & 0xFFFFFFFFu),
+                                        MappingName(name).c_str());
+    if (sd) LocalFree(sd);
+    if (!mapping) return false;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info{};
+    if (!view || VirtualQuery(view, &info, sizeof(info)) == 0 || info.RegionSize < bytes) {
+        if (view) UnmapViewOfFile(view);
+        CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+    m_data = view;
+    m_size = info.RegionSize;
+    return true;
+}
+
+bool SharedMemory::Open(const char* name) {
+    Close();
+    HANDLE mapping = OpenFileMappingW(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, MappingName(name).c_str());
+    if (!mapping) return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info{};
+    if (!view || VirtualQuery(view, &info, sizeof(info)) == 0) {
+        if (view) UnmapViewOfFile(view);
+        CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+    m_data = view;
+    m_size = info.RegionSize;
+    return true;
+}
+
+void SharedMemory::Close() {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(static_cast<HANDLE>(m_mapping));
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_size = 0;
+}
+
+void SharedMemory::Unlink(const char*) {}
+
+#else
+
+bool SharedMemory::Create(const char* name, size_t bytes) {
+    Close();
+    const int fd = shm_open(ShmName(name).c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) return false;
+    struct stat st{};
+    bool ok = fstat(fd, &st) == 0;
+    if (ok && static_cast<size_t>(st.st_size) < bytes) ok = ftruncate(fd, static_cast<off_t>(bytes)) == 0;
+    const size_t size = ok ? std::max(bytes, static_cast<size_t>(st.st_size)) : 0;
+    void* p = ok ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    m_data = p;
+    m_size = size;
+    return true;
+}
+
+bool SharedMemory::Open(const char* name) {
+    Close();
+    const int fd = shm_open(ShmName(name).c_str(), O_RDWR, 0);
+    if (fd < 0) return false;
+    struct stat st{};
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    m_data = p;
+    m_size = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void SharedMemory::Close() {
+    if (m_data) munmap(m_data, m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
+
+void SharedMemory::Unlink(const char* name) {
+    shm_unlink(ShmName(name).c_str());
+}
+
+#endif
+
+} // namespace rj
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rj {
+
+#if defined(_WIN32)
+// DACL for objects shared between the IDD driver host and desktop apps: SYSTEM, LocalService
+// (the UMDF host) and interactive users get full access, nobody else does.
+constexpr wchar_t kSharedObjectSddl[] = L"D:P(A;;GA;;;SY)(A;;GA;;;LS)(A;;GA;;;IU)";
+#endif
+
+// A named block of memory shared between processes: a file mapping in the global
+// namespace on Windows (the Global\ prefix, so a session-0 driver host and a desktop app can
+// meet), a POSIX shm object elsewhere. Mapped read/write for its whole lifetime.
+class SharedMemory {
+public:
+    SharedMemory() = default;
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    // Creates the block, or opens it if it already exists with at least `bytes`.
+    bool Create(const char* name, size_t bytes);
+    // Opens an existing block; Size() is what the creator asked for, rounded up to pages.
+    bool Open(const char* name);
+    void Close();
+
+    // Removes the name so later Open() calls fail; existing mappings stay valid. No-op on
+    // Windows, where the mapping goes away with its last handle.
+    static void Unlink(const char* name);
+
+    void* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+    bool Valid() const { return m_data != nullptr; }
+
+private:
+    void* m_data{};
+    size_t m_size{};
+#if defined(_WIN32)
+    void* m_mapping{};  // HANDLE
+#endif
+};
+
+} // namespace rj
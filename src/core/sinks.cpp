@@ -0,0 +1,59 @@
+#include "core/sinks.h"
+
+#include <cstring>
+#include <vector>
+
+#include "core/slicer.h"
+
+namespace rj {
+
+void NullSink::Present(const OutputSlice& slice) {
+    if (m_clock && m_presentCostNs > 0) m_clock->SleepForNs(m_presentCostNs);
+    m_presentCount++;
+    m_lastSequence = slice.frameSequence;
+}
+
+MemorySink::MemorySink(uint32_t width, uint32_t height)
+    : m_width(width), m_height(height), m_pixels(static_cast<size_t>(width) * height * 4u) {}
+
+void MemorySink::Present(const OutputSlice& slice) {
+    m_presentCount++;
+    m_lastSequence = slice.frameSequence;
+
+    const int32_t sw = slice.srcRect.Width();
+    const int32_t sh = slice.srcRect.Height();
+    if (!slice.hasContent || !slice.pixels || BytesPerPixel(slice.format) != 4 || sw <= 0 || sh <= 0) {
+        // Matches the 0.02 clear colour RenderFrame() uses before any capture arrived.
+        std::memset(m_pixels.data(), 5, m_pixels.size());
+        return;
+    }
+
+    // Exact 1/N slices go through the SIMD slicer; anything else (capture narrower than
+    // expected, scaled outputs) falls back to nearest-neighbour sampling of srcRect.
+    if (slice.sliceEnabled && CanSliceExact(slice.srcWidth, slice.srcHeight, m_width, m_height, slice.count)) {
+        std::vector<SliceTarget> targets(slice.count);
+        targets[slice.index] = SliceTarget{m_pixels.data(), m_width * 4u};
+        SliceParams params;
+        params.outputs = slice.count;
+        params.flipX = slice.flipX;
+        params.flipY = slice.flipY;
+        SliceFrame(slice.pixels, slice.strideBytes, slice.srcWidth, slice.srcHeight, m_width, m_height, params, targets.data());
+        return;
+    }
+
+    const size_t dstStride = static_cast<size_t>(m_width) * 4u;
+    for (uint32_t y = 0; y < m_height; y++) {
+        const uint32_t ly = slice.flipY ? (m_height - 1 - y) : y;
+        const int32_t sy = slice.srcRect.top + static_cast<int32_t>((static_cast<uint64_t>(ly) * sh) / m_height);
+        const uint8_t* srcRow = slice.pixels + static_cast<size_t>(sy) * slice.strideBytes;
+        uint8_t* dstRow = m_pixels.data() + y * dstStride;
+
+        for (uint32_t x = 0; x < m_width; x++) {
+            const uint32_t lx = slice.flipX ? (m_width - 1 - x) : x;
+            const int32_t sx = slice.srcRect.left + static_cast<int32_t>((static_cast<uint64_t>(lx) * sw) / m_width);
+            std::memcpy(dstRow + x * 4u, srcRow + static_cast<size_t>(sx) * 4u, 4);
+        }
+    }
+}
+
+} // namespace rj
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/clock.h"
+#include "core/output_sink.h"
+
+namespace rj {
+
+// Discards everything. Optionally burns simulated time per Present() so scheduling runs
+// can model a blocking swapchain.
+class NullSink final : public IOutputSink {
+public:
+    explicit NullSink(Clock* clock = nullptr, int64_t presentCostNs = 0) : m_clock(clock), m_presentCostNs(presentCostNs) {}
+
+    const char* Name() const override { return "null"; }
+    void Present(const OutputSlice& slice) override;
+
+    uint64_t PresentCount() const { return m_presentCount; }
+    uint64_t LastSequence() const { return m_lastSequence; }
+
+private:
+    Clock* m_clock;
+    int64_t m_presentCostNs;
+    uint64_t m_presentCount{};
+    uint64_t m_lastSequence{};
+};
+
+// Keeps the presented slice in system memory (a CPU "backbuffer" of width x height BGRA
+// pixels), sampling the wide frame the way the pixel shader does.
+class MemorySink final : public IOutputSink {
+public:
+    MemorySink(uint32_t width, uint32_t height);
+
+    const char* Name() const override { return "memory"; }
+    void Present(const OutputSlice& slice) override;
+
+    uint32_t Width() const { return m_width; }
+    uint32_t Height() const { return m_height; }
+    const std::vector<uint8_t>& Pixels() const { return m_pixels; }
+    uint64_t PresentCount() const { return m_presentCount; }
+    uint64_t LastSequence() const { return m_lastSequence; }
+
+private:
+    uint32_t m_width;
+    uint32_t m_height;
+    std::vector<uint8_t> m_pixels;
+    uint64_t m_presentCount{};
+    uint64_t m_lastSequence{};
+};
+
+} // namespace rj
@@ -0,0 +1,92 @@
+#include "core/slice_plan.h"
+
+#include <algorithm>
+
+namespace rj {
+
+bool CanSliceExact(uint32_t srcW, uint32_t srcH, uint32_t outW, uint32_t outH, uint32_t outputs) {
+    return outputs > 0 && outW > 0 && outH > 0 && srcH == outH && static_cast<uint64_t>(outW) * outputs == srcW;
+}
+
+bool SlicePlan::AllCopyable() const {
+    if (outputs == 0) return false;
+    for (uint32_t i = 0; i < outputs; i++) {
+        if (!regions[i].Copyable()) return false;
+    }
+    return true;
+}
+
+SlicePlan PlanSlices(uint32_t srcW, uint32_t srcH, const SlicePlanConfig& cfg) {
+    SlicePlan plan;
+    plan.srcWidth = srcW;
+    plan.srcHeight = srcH;
+    plan.outputs = std::min(cfg.outputs, kMaxSliceOutputs);
+    if (plan.outputs == 0 || srcW == 0 || srcH == 0) return plan;
+
+    const uint64_t n = plan.outputs;
+    const uint64_t expectedW = cfg.expectedWideW ? cfg.expectedWideW : (cfg.outputWidth ? uint64_t{cfg.outputWidth} * n : srcW);
+    plan.sliceEnabled = uint64_t{srcW} + cfg.slackPixels >= expectedW;
+
+    const uint32_t dstW = cfg.outputWidth ? cfg.outputWidth : (plan.sliceEnabled ? static_cast<uint32_t>(srcW / n) : srcW);
+    const uint32_t dstH = cfg.outputHeight ? cfg.outputHeight : srcH;
+    plan.exact = plan.sliceEnabled && CanSliceExact(srcW, srcH, dstW, dstH, plan.outputs);
+
+    for (uint32_t i = 0; i < plan.outputs; i++) {
+        SliceRegion& r = plan.regions[i];
+        if (plan.sliceEnabled) {
+            r.src = Rect{static_cast<int32_t>(i * uint64_t{srcW} / n), 0, static_cast<int32_t>((i + 1) * uint64_t{srcW} / n), static_cast<int32_t>(srcH)};
+        } else {
+            r.src = Rect{0, 0, static_cast<int32_t>(srcW), static_cast<int32_t>(srcH)};
+        }
+        r.dstWidth = dstW;
+        r.dstHeight = dstH;
+        r.flipX = cfg.flipX;
+        r.flipY = cfg.flipY;
+    }
+    return plan;
+}
+
+const char* BlitFallbackName(BlitFallback fallback) {
+    switch (fallback) {
+        case BlitFallback::None: return "copy";
+        case BlitFallback::NoSource: return "no-source";
+        case BlitFallback::Unsliced: return "unsliced";
+        case BlitFallback::Flipped: return "flipped";
+        case BlitFallback::Scaled: return "scaled";
+        case BlitFallback::Format: return "format";
+    }
+    return "?";
+}
+
+OutputBlit PlanOutputBlit(const SlicePlan& plan, uint32_t output, uint32_t dstW, uint32_t dstH, bool sameFormat) {
+    OutputBlit blit;
+    if (output >= plan.outputs || plan.srcWidth == 0 || plan.srcHeight == 0) return blit;
+    const SliceRegion& r = plan.regions[output];
+    if (!plan.sliceEnabled && plan.outputs > 1) {
+        blit.fallback = BlitFallback::Unsliced;
+    } else if (r.flipX || r.flipY) {
+        blit.fallback = BlitFallback::Flipped;
+    } else if (!CanSliceExact(plan.srcWidth, plan.srcHeight, dstW, dstH, plan.outputs)) {
+        // The shader maps the output onto 1/N of the frame's width, not onto the region, so
+        // a region that happens to match the target still differs when the frame is uneven.
+        blit.fallback = BlitFallback::Scaled;
+    } else if (!sameFormat) {
+        blit.fallback = BlitFallback::Format;
+    } else {
+        blit.fallback = BlitFallback::None;
+        blit.src = r.src;
+    }
+    return blit;
+}
+
+bool MapRectToSlice(const SliceRegion& region, const Rect& wide, Rect& local) {
+    const Rect clipped{std::max(wide.left, region.src.left),
+                       std::max(wide.top, region.src.top),
+                       std::min(wide.right, region.src.right),
+                       std::min(wide.bottom, region.src.bottom)};
+    if (clipped.Empty()) return false;
+    local = Rect{clipped.left - region.src.left, clipped.top - region.src.top, clipped.right - region.src.left, clipped.bottom - region.src.top};
+    return true;
+}
+
+} // namespace rj
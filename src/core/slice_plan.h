@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/frame.h"
+
+namespace rj {
+
+constexpr uint32_t kMaxSliceOutputs = 8;
+
+struct SlicePlanConfig {
+    uint32_t outputs = 3;
+    uint32_t outputWidth{};    // size of one output; 0 = an equal share of the frame
+    uint32_t outputHeight{};   // 0 = the frame height
+    uint32_t expectedWideW{};  // 0 = outputWidth * outputs
+    uint32_t slackPixels = 32; // frames this much narrower than expected still slice
+    bool flipX{};              // slice-local horizontal flip
+    bool flipY{};              // whole-frame vertical flip
+};
+
+// What one output shows: a column of the wide frame, scaled to the output and flipped.
+struct SliceRegion {
+    Rect src{};
+    uint32_t dstWidth{};
+    uint32_t dstHeight{};
+    bool flipX{};
+    bool flipY{};
+
+    // A plain sub-rectangle copy (CopySubresourceRegion) reproduces the slicing shader.
+    bool Copyable() const {
+        return !flipX && !flipY && static_cast<uint32_t>(src.Width()) == dstWidth && static_cast<uint32_t>(src.Height()) == dstHeight;
+    }
+};
+
+// Where each of N outputs samples the wide frame, matching kPsSrc (uv.x = (localX + i) / N).
+// Shared by FramePipeline, rj_span and the IDD driver, which writes the slices itself.
+struct SlicePlan {
+    uint32_t srcWidth{};
+    uint32_t srcHeight{};
+    uint32_t outputs{};
+    bool sliceEnabled{};  // the frame is ~N outputs wide; otherwise every output shows all of it
+    bool exact{};         // CanSliceExact(): every output is exactly 1/N of the frame at 1:1
+    SliceRegion regions[kMaxSliceOutputs]{};
+
+    bool AllCopyable() const;
+};
+
+// Why an output can't be presented with a plain copy and needs the slicing shader.
+enum class BlitFallback : uint8_t {
+    None,      // copy
+    NoSource,  // no captured frame, or the output has no region
+    Unsliced,  // the frame is not ~N outputs wide; each output shows all of it, scaled
+    Flipped,   // the shader flips the region
+    Scaled,    // the region and the target differ in size
+    Format,    // the source and the target formats differ (e.g. RGBA vs. BGRA, NV12)
+};
+
+const char* BlitFallbackName(BlitFallback fallback);
+
+// How one output presents its region of a frame.
+struct OutputBlit {
+    BlitFallback fallback{BlitFallback::NoSource};
+    Rect src{};  // with no fallback: the CopySubresourceRegion box, written at (0, 0)
+
+    bool Copy() const { return fallback == BlitFallback::None; }
+};
+
+// Copy path for output `output` into a dstW x dstH target when the frame splits 1:1 onto
+// targets of that size (CanSliceExact) with no flip and the formats match; otherwise the reason the shader has to draw it. A
+// single-output plan of a driver-side slice decides whether that slice is copied as is.
+OutputBlit PlanOutputBlit(const SlicePlan& plan, uint32_t output, uint32_t dstW, uint32_t dstH, bool sameFormat);
+
+// True when every output shows exactly 1/N of the frame at 1:1 scale, i.e. the case where
+// the shader's linear sample at each pixel centre lands exactly on one texel.
+bool CanSliceExact(uint32_t srcW, uint32_t srcH, uint32_t outW, uint32_t outH, uint32_t outputs);
+
+// Outputs beyond kMaxSliceOutputs are ignored. Column edges are i * srcW / N, so the regions
+// tile the frame without gaps when it is not a multiple of N wide.
+SlicePlan PlanSlices(uint32_t srcW, uint32_t srcH, const SlicePlanConfig& cfg);
+
+// Part of a wide-frame rectangle (e.g. a dirty rect) that lands in `region`, in the slice's
+// own coordinates for a copyable region. Returns false when they don't overlap.
+bool MapRectToSlice(const SliceRegion& region, const Rect& wide, Rect& local);
+
+} // namespace rj
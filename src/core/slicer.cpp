@@ -0,0 +1,68 @@
+#include "core/slicer.h"
+
+#include "core/slicer_impl.h"
+
+namespace rj {
+
+namespace detail {
+
+namespace {
+
+struct RowScalar {
+    template <bool FlipX, bool Swizzle>
+    static void Copy(uint8_t* dst, const uint8_t* src, uint32_t w) {
+        if (!FlipX && !Swizzle) {
+            std::memcpy(dst, src, static_cast<size_t>(w) * 4u);
+            return;
+        }
+        CopyPixelsScalar<FlipX, Swizzle>(dst, src, w, 0);
+    }
+};
+
+} // namespace
+
+SliceFn SelectSliceScalar(uint32_t outputs, bool flipX, bool flipY, bool swizzle) {
+    return SelectSlice<RowScalar>(outputs, flipX, flipY, swizzle);
+}
+
+} // namespace detail
+
+bool SliceFrame(const uint8_t* src,
+                uint32_t srcStride,
+                uint32_t srcW,
+                uint32_t srcH,
+                uint32_t outW,
+                uint32_t outH,
+                const SliceParams& params,
+                const SliceTarget* targets,
+                SimdLevel level) {
+    if (!src || !targets || !CanSliceExact(srcW, srcH, outW, outH, params.outputs)) return false;
+
+    const SimdLevel best = DetectSimdLevel();
+    if (static_cast<int>(level) > static_cast<int>(best)) level = best;
+
+    detail::SliceFn fn = nullptr;
+    switch (level) {
+        case SimdLevel::Avx2:
+            fn = detail::SelectSliceAvx2(params.outputs, params.flipX, params.flipY, params.swizzle);
+            break;
+        case SimdLevel::Sse41:
+            fn = detail::SelectSliceSse41(params.outputs, params.flipX, params.flipY, params.swizzle);
+            break;
+        default:
+            fn = detail::SelectSliceScalar(params.outputs, params.flipX, params.flipY, params.swizzle);
+            break;
+    }
+
+    detail::SliceJob job;
+    job.src = src;
+    job.srcStride = srcStride;
+    job.outW = outW;
+    job.outH = outH;
+    job.outputs = params.outputs;
+    job.targets = targets;
+    fn(job);
+    return true;
+}
+
+} // namespace rj
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/cpu_features.h"
+#include "core/slice_plan.h"
+
+namespace rj {
+
+// One output buffer the slicer writes into (width x height 4-byte pixels).
+struct SliceTarget {
+    uint8_t* pixels{};
+    uint32_t strideBytes{};
+};
+
+// Mirrors the kPsSrc constants that affect which texel lands where.
+struct SliceParams {
+    uint32_t outputs = 3;
+    bool flipX{};    // slice-local horizontal flip
+    bool flipY{};    // whole-frame vertical flip
+    bool swizzle{};  // isBgra: c = c.bgra (swap channels 0 and 2)
+};
+
+// CPU reference for the slicing pixel shader: splits a wide frame of 4-byte pixels into
+// `params.outputs` buffers of outW x outH, applying flips and swizzle the way kPsSrc does
+// (uv.x = (localX + sliceIndex) / N). `targets` holds one entry per output; entries with
+// null pixels are skipped. Returns false and writes nothing unless CanSliceExact().
+//
+// Flip/swizzle/output count are compile-time parameters of the kernels; this function
+// only picks the instantiation for `level` (clamped to what the CPU supports).
+bool SliceFrame(const uint8_t* src,
+                uint32_t srcStride,
+                uint32_t srcW,
+                uint32_t srcH,
+                uint32_t outW,
+                uint32_t outH,
+                const SliceParams& params,
+                const SliceTarget* targets,
+                SimdLevel level = DetectSimdLevel());
+
+} // namespace rj
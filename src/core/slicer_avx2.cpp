@@ -0,0 +1,69 @@
+// AVX2 slicer kernels. Built with -mavx2 (/arch:AVX2 on MSVC); only called after
+// DetectSimdLevel() reported AVX2.
+
+#include "core/slicer_impl.h"
+
+#if RJ_X86
+#include <immintrin.h>
+#endif
+
+namespace rj::detail {
+
+#if RJ_X86
+
+namespace {
+
+struct RowAvx2 {
+    // Output frames are far larger than the caches, so rows whose destination is 32-byte
+    // aligned are written with streaming stores to skip the read-for-ownership.
+    template <bool FlipX, bool Swizzle>
+    static void Copy(uint8_t* dst, const uint8_t* src, uint32_t w) {
+        if ((reinterpret_cast<uintptr_t>(dst) & 31u) == 0) {
+            CopyImpl<FlipX, Swizzle, true>(dst, src, w);
+        } else {
+            CopyImpl<FlipX, Swizzle, false>(dst, src, w);
+        }
+    }
+
+    template <bool FlipX, bool Swizzle, bool Stream>
+    static void CopyImpl(uint8_t* dst, const uint8_t* src, uint32_t w) {
+        const __m256i swz = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                             2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+        uint32_t x = 0;
+        for (; x + 8 <= w; x += 8) {
+            __m256i v;
+            if (FlipX) {
+                v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + static_cast<size_t>(w - x - 8) * 4u));
+                v = _mm256_permutevar8x32_epi32(v, rev);
+            } else {
+                v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + static_cast<size_t>(x) * 4u));
+            }
+            if (Swizzle) v = _mm256_shuffle_epi8(v, swz);
+            __m256i* d = reinterpret_cast<__m256i*>(dst + static_cast<size_t>(x) * 4u);
+            if (Stream) {
+                _mm256_stream_si256(d, v);
+            } else {
+                _mm256_storeu_si256(d, v);
+            }
+        }
+        if (Stream) _mm_sfence();
+        CopyPixelsScalar<FlipX, Swizzle>(dst, src, w, x);
+    }
+};
+
+} // namespace
+
+SliceFn SelectSliceAvx2(uint32_t outputs, bool flipX, bool flipY, bool swizzle) {
+    return SelectSlice<RowAvx2>(outputs, flipX, flipY, swizzle);
+}
+
+#else
+
+SliceFn SelectSliceAvx2(uint32_t outputs, bool flipX, bool flipY, bool swizzle) {
+    return SelectSliceScalar(outputs, flipX, flipY, swizzle);
+}
+
+#endif
+
+} // namespace rj::detail
@@ -0,0 +1,92 @@
+#pragma once
+
+// Internal to the slicer: shared row loop templates. Each kernel TU (scalar/SSE4.1/AVX2)
+// includes this with its own Row type, so every instantiation is compiled for that TU's ISA.
+
+#include <cstdint>
+#include <cstring>
+
+#include "core/slicer.h"
+
+namespace rj::detail {
+
+struct SliceJob {
+    const uint8_t* src{};
+    uint32_t srcStride{};
+    uint32_t outW{};
+    uint32_t outH{};
+    uint32_t outputs{};
+    const SliceTarget* targets{};
+};
+
+using SliceFn = void (*)(const SliceJob& job);
+
+SliceFn SelectSliceScalar(uint32_t outputs, bool flipX, bool flipY, bool swizzle);
+SliceFn SelectSliceSse41(uint32_t outputs, bool flipX, bool flipY, bool swizzle);
+SliceFn SelectSliceAvx2(uint32_t outputs, bool flipX, bool flipY, bool swizzle);
+
+inline uint32_t SwapRB(uint32_t p) {
+    return (p & 0xFF00FF00u) | ((p >> 16) & 0xFFu) | ((p & 0xFFu) << 16);
+}
+
+// Scalar pixels [xBegin, w) of one row; also the tail loop of the SIMD kernels.
+template <bool FlipX, bool Swizzle>
+inline void CopyPixelsScalar(uint8_t* dst, const uint8_t* src, uint32_t w, uint32_t xBegin) {
+    for (uint32_t x = xBegin; x < w; x++) {
+        uint32_t p;
+        std::memcpy(&p, src + static_cast<size_t>(FlipX ? (w - 1 - x) : x) * 4u, 4);
+        if (Swizzle) p = SwapRB(p);
+        std::memcpy(dst + static_cast<size_t>(x) * 4u, &p, 4);
+    }
+}
+
+// N == 0 means "runtime output count" for layouts beyond the specialized ones.
+template <class Row, uint32_t N, bool FlipX, bool FlipY, bool Swizzle>
+void SliceRows(const SliceJob& job) {
+    const uint32_t n = N ? N : job.outputs;
+    const size_t sliceBytes = static_cast<size_t>(job.outW) * 4u;
+    for (uint32_t i = 0; i < n; i++) {
+        const SliceTarget& t = job.targets[i];
+        if (!t.pixels) continue;
+        const uint8_t* srcBase = job.src + sliceBytes * i;
+        for (uint32_t y = 0; y < job.outH; y++) {
+            const uint32_t sy = FlipY ? (job.outH - 1 - y) : y;
+            Row::template Copy<FlipX, Swizzle>(t.pixels + static_cast<size_t>(y) * t.strideBytes,
+                                               srcBase + static_cast<size_t>(sy) * job.srcStride,
+                                               job.outW);
+        }
+    }
+}
+
+template <class Row, uint32_t N>
+SliceFn SelectForCount(bool flipX, bool flipY, bool swizzle) {
+    static constexpr SliceFn kTable[8] = {
+        &SliceRows<Row, N, false, false, false>,
+        &SliceRows<Row, N, false, false, true>,
+        &SliceRows<Row, N, false, true, false>,
+        &SliceRows<Row, N, false, true, true>,
+        &SliceRows<Row, N, true, false, false>,
+        &SliceRows<Row, N, true, false, true>,
+        &SliceRows<Row, N, true, true, false>,
+        &SliceRows<Row, N, true, true, true>,
+    };
+    return kTable[(flipX ? 4 : 0) | (flipY ? 2 : 0) | (swizzle ? 1 : 0)];
+}
+
+template <class Row>
+SliceFn SelectSlice(uint32_t outputs, bool flipX, bool flipY, bool swizzle) {
+    switch (outputs) {
+        case 1:
+            return SelectForCount<Row, 1>(flipX, flipY, swizzle);
+        case 2:
+            return SelectForCount<Row, 2>(flipX, flipY, swizzle);
+        case 3:
+            return SelectForCount<Row, 3>(flipX, flipY, swizzle);
+        case 4:
+            return SelectForCount<Row, 4>(flipX, flipY, swizzle);
+        default:
+            return SelectForCount<Row, 0>(flipX, flipY, swizzle);
+    }
+}
+
+} // namespace rj::detail
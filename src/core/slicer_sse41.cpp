@@ -0,0 +1,65 @@
+// SSE4.1 slicer kernels. Built with -msse4.1 on GCC/Clang (see CMakeLists.txt).
+
+#include "core/slicer_impl.h"
+
+#if RJ_X86
+#include <smmintrin.h>
+#endif
+
+namespace rj::detail {
+
+#if RJ_X86
+
+namespace {
+
+struct RowSse41 {
+    // Same streaming-store policy as the AVX2 kernel, at 16-byte granularity.
+    template <bool FlipX, bool Swizzle>
+    static void Copy(uint8_t* dst, const uint8_t* src, uint32_t w) {
+        if ((reinterpret_cast<uintptr_t>(dst) & 15u) == 0) {
+            CopyImpl<FlipX, Swizzle, true>(dst, src, w);
+        } else {
+            CopyImpl<FlipX, Swizzle, false>(dst, src, w);
+        }
+    }
+
+    template <bool FlipX, bool Swizzle, bool Stream>
+    static void CopyImpl(uint8_t* dst, const uint8_t* src, uint32_t w) {
+        const __m128i swz = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        uint32_t x = 0;
+        for (; x + 4 <= w; x += 4) {
+            __m128i v;
+            if (FlipX) {
+                v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + static_cast<size_t>(w - x - 4) * 4u));
+                v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+            } else {
+                v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + static_cast<size_t>(x) * 4u));
+            }
+            if (Swizzle) v = _mm_shuffle_epi8(v, swz);
+            __m128i* d = reinterpret_cast<__m128i*>(dst + static_cast<size_t>(x) * 4u);
+            if (Stream) {
+                _mm_stream_si128(d, v);
+            } else {
+                _mm_storeu_si128(d, v);
+            }
+        }
+        if (Stream) _mm_sfence();
+        CopyPixelsScalar<FlipX, Swizzle>(dst, src, w, x);
+    }
+};
+
+} // namespace
+
+SliceFn SelectSliceSse41(uint32_t outputs, bool flipX, bool flipY, bool swizzle) {
+    return SelectSlice<RowSse41>(outputs, flipX, flipY, swizzle);
+}
+
+#else
+
+SliceFn SelectSliceSse41(uint32_t outputs, bool flipX, bool flipY, bool swizzle) {
+    return SelectSliceScalar(outputs, flipX, flipY, swizzle);
+}
+
+#endif
+
+} // namespace rj::detail
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/triple_buffer.h"
+
+namespace rj {
+
+// Bounded lock-free single-producer / single-consumer FIFO. TryPush fails when full and
+// TryPop when empty; neither side blocks.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(uint32_t capacity = 0) { Reset(capacity); }
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Not thread-safe: only while neither side is running.
+    void Reset(uint32_t capacity) {
+        m_items.assign(static_cast<size_t>(capacity) + 1, T{});
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+    }
+
+    uint32_t Capacity() const { return static_cast<uint32_t>(m_items.size() - 1); }
+
+    // Producer.
+    bool TryPush(const T& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t next = Next(tail);
+        if (next == m_head.load(std::memory_order_acquire)) return false;
+        m_items[tail] = value;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer.
+    bool TryPop(T& out) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+        out = m_items[head];
+        m_head.store(Next(head), std::memory_order_release);
+        return true;
+    }
+
+    // Either side; exact only when the other side is idle.
+    uint32_t SizeApprox() const {
+        const size_t head = m_head.load(std::memory_order_acquire);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        return static_cast<uint32_t>(tail >= head ? tail - head : tail + m_items.size() - head);
+    }
+
+private:
+    size_t Next(size_t i) const { return i + 1 == m_items.size() ? 0 : i + 1; }
+
+    std::vector<T> m_items;
+    alignas(kCacheLineBytes) std::atomic<size_t> m_head{0};  // consumer
+    alignas(kCacheLineBytes) std::atomic<size_t> m_tail{0};  // producer
+};
+
+} // namespace rj
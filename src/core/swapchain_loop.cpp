@@ -0,0 +1,102 @@
+#include "core/swapchain_loop.h"
+
+#include <algorithm>
+
+namespace rj {
+
+SwapChainLoop::SwapChainLoop(ISwapChainPort& port, ISwapChainFrameSink& sink, const SwapChainLoopConfig& cfg)
+    : m_port(port), m_sink(sink), m_cfg(cfg) {}
+
+SwapChainExit SwapChainLoop::Run() {
+    while (Step()) {
+    }
+    return m_exit;
+}
+
+bool SwapChainLoop::Step() {
+    switch (m_state) {
+        case SwapChainState::Acquire: {
+            const int64_t start = m_port.NowNs();
+            m_stats.acquireCalls++;
+            SwapChainBuffer buffer;
+            switch (m_port.ReleaseAndAcquire(buffer)) {
+                case SwapChainAcquire::Acquired:
+                    m_buffer = buffer;
+                    m_timing = SwapChainFrameTiming{};
+                    m_timing.frameNumber = buffer.frameNumber;
+                    m_timing.presentNs = buffer.presentTimeNs;
+                    m_timing.wakeNs = m_wakeNs >= 0 ? m_wakeNs : start;
+                    m_timing.acquiredNs = m_port.NowNs();
+                    m_wakeNs = -1;
+                    m_state = SwapChainState::Process;
+                    break;
+                case SwapChainAcquire::Pending:
+                    m_stats.pendingAcquires++;
+                    m_wakeNs = -1;
+                    m_state = SwapChainState::Wait;
+                    break;
+                case SwapChainAcquire::Lost:
+                    m_exit = SwapChainExit::Lost;
+                    m_state = SwapChainState::Exit;
+                    break;
+            }
+            return true;
+        }
+        case SwapChainState::Wait:
+            switch (m_port.WaitForWork(m_cfg.idleTimeoutNs)) {
+                case SwapChainWait::NewFrame:
+                    m_stats.frameWakeups++;
+                    m_wakeNs = m_port.NowNs();
+                    m_state = SwapChainState::Acquire;
+                    break;
+                case SwapChainWait::Timeout:
+                    m_stats.idleWakeups++;
+                    m_sink.OnIdle(m_port.NowNs());
+                    break;
+                case SwapChainWait::Terminate:
+                    m_exit = SwapChainExit::Terminated;
+                    m_state = SwapChainState::Exit;
+                    break;
+                case SwapChainWait::Failed:
+                    m_exit = SwapChainExit::WaitFailed;
+                    m_state = SwapChainState::Exit;
+                    break;
+            }
+            return true;
+        case SwapChainState::Process:
+            m_timing.processStartNs = m_port.NowNs();
+            m_timing.status = m_sink.ProcessFrame(m_buffer) ? SwapChainFrameStatus::Completed : SwapChainFrameStatus::Dropped;
+            m_timing.processEndNs = m_port.NowNs();
+            m_state = SwapChainState::Finish;
+            return true;
+        case SwapChainState::Finish:
+            Finish();
+            return true;
+        case SwapChainState::Exit:
+            return false;
+    }
+    return false;
+}
+
+void SwapChainLoop::Finish() {
+    m_buffer.surface = nullptr;
+    if (!m_port.FinishedProcessing()) {
+        m_exit = SwapChainExit::FinishFailed;
+        m_state = SwapChainState::Exit;
+        return;
+    }
+    m_timing.finishedNs = m_port.NowNs();
+    m_port.ReportFrameStatistics(m_timing);
+
+    m_stats.frames++;
+    if (m_timing.status == SwapChainFrameStatus::Dropped) m_stats.dropped++;
+    m_stats.acquireSumNs += m_timing.AcquireNs();
+    m_stats.processSumNs += m_timing.ProcessNs();
+    m_stats.finishSumNs += m_timing.FinishNs();
+    m_stats.acquireMaxNs = std::max(m_stats.acquireMaxNs, m_timing.AcquireNs());
+    m_stats.processMaxNs = std::max(m_stats.processMaxNs, m_timing.ProcessNs());
+    m_stats.finishMaxNs = std::max(m_stats.finishMaxNs, m_timing.FinishNs());
+    m_state = SwapChainState::Acquire;
+}
+
+} // namespace rj
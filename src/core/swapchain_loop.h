@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/clock.h"
+
+namespace rj {
+
+// One surface handed out by the OS (IDDCX_METADATA without the IddCx types).
+struct SwapChainBuffer {
+    uint64_t frameNumber{};    // PresentationFrameNumber
+    int64_t presentTimeNs{};   // PresentDisplayQPCTime
+    uint32_t dirtyRectCount{};
+    uint32_t moveRegionCount{};
+    void* surface{};           // IDXGIResource* on Windows, owned by the port
+};
+
+enum class SwapChainAcquire {
+    Acquired,
+    Pending,  // E_PENDING: wait for the new-frame event
+    Lost,     // the swap-chain was abandoned (e.g. DXGI_ERROR_ACCESS_LOST)
+};
+
+enum class SwapChainWait {
+    NewFrame,   // the OS signalled that a surface is available
+    Timeout,
+    Terminate,  // the driver is tearing the swap-chain down
+    Failed,
+};
+
+enum class SwapChainFrameStatus {
+    Completed,
+    Dropped,  // the sink could not process it
+};
+
+// Per-frame timing the loop measures and reports back to the OS
+// (IddCxSwapChainReportFrameStatistics).
+struct SwapChainFrameTiming {
+    uint64_t frameNumber{};
+    SwapChainFrameStatus status{SwapChainFrameStatus::Completed};
+    int64_t presentNs{};       // when the OS presented it
+    int64_t wakeNs{};          // loop woke up for it (or started the acquire, if it didn't wait)
+    int64_t acquiredNs{};      // ReleaseAndAcquire returned it
+    int64_t processStartNs{};
+    int64_t processEndNs{};
+    int64_t finishedNs{};      // FinishedProcessing returned
+
+    int64_t AcquireNs() const { return acquiredNs - wakeNs; }
+    int64_t ProcessNs() const { return processEndNs - processStartNs; }
+    int64_t FinishNs() const { return finishedNs - processEndNs; }
+};
+
+// The IddCx calls the loop makes, plus the wait on the new-frame and terminate events. The
+// driver implements it over an IDDCX_SWAPCHAIN; MockSwapChain simulates one.
+class ISwapChainPort {
+public:
+    virtual ~ISwapChainPort() = default;
+
+    // Releases the previous surface and asks for the next one. `out.surface` stays valid
+    // until FinishedProcessing().
+    virtual SwapChainAcquire ReleaseAndAcquire(SwapChainBuffer& out) = 0;
+    // Blocks until the new-frame event or the terminate event; timeoutNs < 0 waits forever.
+    virtual SwapChainWait WaitForWork(int64_t timeoutNs) = 0;
+    virtual bool FinishedProcessing() = 0;
+    virtual void ReportFrameStatistics(const SwapChainFrameTiming& timing) = 0;
+    virtual int64_t NowNs() = 0;
+};
+
+// What the driver does with each frame (publish it to the frame channel).
+class ISwapChainFrameSink {
+public:
+    virtual ~ISwapChainFrameSink() = default;
+
+    // Returns false when the frame was dropped.
+    virtual bool ProcessFrame(const SwapChainBuffer& buffer) = 0;
+    // Called when no frame arrived for the idle timeout.
+    virtual void OnIdle(int64_t nowNs) { (void)nowNs; }
+};
+
+struct SwapChainLoopConfig {
+    // Longest the loop sleeps without a new-frame signal. Expiry only calls OnIdle() (the
+    // frame channel heartbeat); it never retries the acquire. < 0 sleeps until signalled.
+    int64_t idleTimeoutNs = 250 * kNsPerMs;
+};
+
+enum class SwapChainState {
+    Acquire,
+    Wait,
+    Process,
+    Finish,
+    Exit,
+};
+
+enum class SwapChainExit {
+    None,  // still running
+    Terminated,
+    Lost,
+    WaitFailed,
+    FinishFailed,
+};
+
+struct SwapChainLoopStats {
+    uint64_t frames{};
+    uint64_t dropped{};
+    uint64_t acquireCalls{};
+    uint64_t pendingAcquires{};  // acquire calls that found nothing
+    uint64_t frameWakeups{};
+    uint64_t idleWakeups{};
+    int64_t acquireSumNs{};
+    int64_t processSumNs{};
+    int64_t finishSumNs{};
+    int64_t acquireMaxNs{};
+    int64_t processMaxNs{};
+    int64_t finishMaxNs{};
+};
+
+// The driver's swap-chain processing loop as an explicit state machine:
+//
+//   Acquire --Acquired--> Process --> Finish --(report)--> Acquire
+//   Acquire --Pending---> Wait --NewFrame--> Acquire
+//                         Wait --Timeout---> OnIdle, Wait
+//   Acquire --Lost / Wait --Terminate/Failed / Finish failed --> Exit
+//
+// It only calls ReleaseAndAcquire after a frame was processed or the new-frame event fired,
+// so an idle desktop costs one wakeup per idle timeout and no IddCx calls.
+class SwapChainLoop {
+public:
+    SwapChainLoop(ISwapChainPort& port, ISwapChainFrameSink& sink, const SwapChainLoopConfig& cfg = {});
+
+    // Runs until Exit and returns why.
+    SwapChainExit Run();
+    // Performs one state transition. Returns false once in Exit.
+    bool Step();
+
+    SwapChainState State() const { return m_state; }
+    SwapChainExit ExitReason() const { return m_exit; }
+    const SwapChainLoopStats& Stats() const { return m_stats; }
+
+private:
+    void Finish();
+
+    ISwapChainPort& m_port;
+    ISwapChainFrameSink& m_sink;
+    SwapChainLoopConfig m_cfg;
+    SwapChainState m_state{SwapChainState::Acquire};
+    SwapChainExit m_exit{SwapChainExit::None};
+    SwapChainLoopStats m_stats{};
+    SwapChainBuffer m_buffer{};
+    SwapChainFrameTiming m_timing{};
+    int64_t m_wakeNs{-1};
+};
+
+} // namespace rj
@@ -0,0 +1,126 @@
+#include "core/synthetic_source.h"
+
+#include <algorithm>
+
+namespace rj {
+
+namespace {
+
+uint8_t UnormToByte(float v) {
+    v = std::min(std::max(v, 0.0f), 1.0f);
+    return static_cast<uint8_t>(v * 255.0f + 0.5f);
+}
+
+} // namespace
+
+SyntheticSource::SyntheticSource(Clock& clock, const SyntheticSourceConfig& cfg) : m_clock(clock), m_cfg(cfg) {
+    if (m_cfg.patternWidth == 0) m_cfg.patternWidth = m_cfg.width;
+    m_periodNs = kNsPerSec / static_cast<int64_t>(m_cfg.hz > 0 ? m_cfg.hz : 60);
+    if (m_cfg.cpuPixels) {
+        m_pixels.resize(static_cast<size_t>(m_cfg.width) * m_cfg.height * 4u);
+        PaintColumns(0, m_cfg.width, false);
+    }
+}
+
+void SyntheticSource::PaintColumns(uint32_t x0, uint32_t x1, bool band) {
+    if (m_pixels.empty()) return;
+    x1 = std::min(x1, m_cfg.width);
+    const size_t stride = static_cast<size_t>(m_cfg.width) * 4u;
+    const float invW = 1.0f / static_cast<float>(m_cfg.patternWidth);
+    const float invH = 1.0f / static_cast<float>(m_cfg.height);
+    const uint8_t blue = UnormToByte(0.15f);
+    for (uint32_t y = 0; y < m_cfg.height; y++) {
+        uint8_t* row = m_pixels.data() + y * stride;
+        const uint8_t g = UnormToByte((static_cast<float>(y) + 0.5f) * invH);
+        for (uint32_t x = x0; x < x1; x++) {
+            uint8_t* px = row + static_cast<size_t>(x) * 4u;
+            if (band) {
+                px[0] = 255;
+                px[1] = 255;
+                px[2] = 255;
+            } else {
+                px[0] = blue;
+                px[1] = g;
+                px[2] = UnormToByte((static_cast<float>(m_cfg.originX + x) + 0.5f) * invW);
+            }
+            px[3] = 255;
+        }
+    }
+}
+
+// Moves the band one step and records the columns that changed, in this source's
+// local coordinates.
+void SyntheticSource::AdvanceMotion() {
+    m_dirty.clear();
+    if (m_cfg.motionBandW == 0) return;
+
+    const uint32_t span = m_cfg.patternWidth;
+    auto repaint = [&](uint32_t gx, bool band) {
+        const int32_t l = std::max<int32_t>(0, static_cast<int32_t>(gx) - static_cast<int32_t>(m_cfg.originX));
+        const int32_t r = std::min<int32_t>(static_cast<int32_t>(m_cfg.width),
+                                            static_cast<int32_t>(std::min(span, gx + m_cfg.motionBandW)) - static_cast<int32_t>(m_cfg.originX));
+        if (r <= l) return;
+        PaintColumns(static_cast<uint32_t>(l), static_cast<uint32_t>(r), band);
+        m_dirty.push_back(Rect{l, 0, r, static_cast<int32_t>(m_cfg.height)});
+    };
+
+    // Restore the old band first, then paint the new one (they may overlap).
+    if (m_bandPainted) {
+        repaint(m_bandX, false);
+        m_bandX = (m_bandX + m_cfg.motionStepPx) % span;
+    }
+    repaint(m_bandX, true);
+    m_bandPainted = true;
+}
+
+AcquireResult SyntheticSource::Acquire(uint32_t timeoutMs, FrameDesc& out) {
+    int64_t now = m_clock.NowNs();
+    if (m_nextFrameNs == 0) m_nextFrameNs = now + m_cfg.phaseNs;
+    if (m_cfg.frameLimit > 0 && m_sequence >= m_cfg.frameLimit) {
+        if (timeoutMs > 0) m_clock.SleepForNs(static_cast<int64_t>(timeoutMs) * kNsPerMs);
+        return AcquireResult::Timeout;
+    }
+
+    if (now < m_nextFrameNs) {
+        if (timeoutMs == 0) return AcquireResult::Timeout;
+        const int64_t deadline = now + static_cast<int64_t>(timeoutMs) * kNsPerMs;
+        if (deadline < m_nextFrameNs) {
+            m_clock.SleepUntilNs(deadline);
+            return AcquireResult::Timeout;
+        }
+        m_clock.SleepUntilNs(m_nextFrameNs);
+        now = m_nextFrameNs;
+    }
+
+    // Like DD, frames that were due while nobody was acquiring are folded into one.
+    uint32_t accumulated = 1;
+    while (m_nextFrameNs + m_periodNs <= now) {
+        m_nextFrameNs += m_periodNs;
+        accumulated++;
+    }
+    m_skipped += accumulated - 1;
+
+    const int64_t captureTime = m_nextFrameNs;
+    m_nextFrameNs += m_periodNs;
+    m_sequence++;
+    AdvanceMotion();
+    if (m_sequence == 1) m_dirty.clear();  // the first frame is fully new
+    if (m_cfg.acquireCostNs > 0) m_clock.SleepForNs(m_cfg.acquireCostNs);
+
+    out = FrameDesc{};
+    out.sequence = m_sequence;
+    out.captureTimeNs = captureTime;
+    out.width = m_cfg.width;
+    out.height = m_cfg.height;
+    out.format = PixelFormat::Bgra8;
+    out.strideBytes = m_cfg.width * 4u;
+    out.pixels = m_pixels.empty() ? nullptr : m_pixels.data();
+    if (m_cfg.dirtyRects && !m_dirty.empty()) {
+        out.dirtyRects = m_dirty.data();
+        out.dirtyRectCount = static_cast<uint32_t>(m_dirty.size());
+    }
+    out.accumulatedFrames = accumulated;
+    return AcquireResult::NewFrame;
+}
+
+} // namespace rj
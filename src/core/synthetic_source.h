@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/capture_source.h"
+#include "core/clock.h"
+
+namespace rj {
+
+struct SyntheticSourceConfig {
+    uint32_t width = 7680;
+    uint32_t height = 1440;
+    uint32_t hz = 120;
+
+    // The pattern is laid out over a virtual desktop `patternWidth` wide; a source with
+    // originX > 0 renders one monitor tile of it (triple-composite simulation).
+    // 0 means patternWidth == width.
+    uint32_t patternWidth = 0;
+    uint32_t originX = 0;
+
+    // Fill CPU pixels. Off for pure scheduling runs where only descriptors matter.
+    bool cpuPixels = true;
+
+    // Width of a bright column that sweeps across the pattern so consecutive frames
+    // differ and carry dirty rects. 0 keeps the frame static.
+    uint32_t motionBandW = 64;
+    uint32_t motionStepPx = 64;
+    // Report the changed columns as dirty rects, like DD. Off models WGC and IDD frames,
+    // which come without them.
+    bool dirtyRects = true;
+
+    // Time Acquire() keeps the caller busy once a frame is due, modelling AcquireNextFrame
+    // plus the GPU copy. Slept on the clock, so it overlaps with other threads' work.
+    int64_t acquireCostNs = 0;
+
+    // Offset of this source's first frame from its first Acquire(): monitors at the same
+    // refresh rate still scan out at different vblank phases.
+    int64_t phaseNs = 0;
+
+    // Stop producing after this many frames, like an idle desktop. 0 means never.
+    uint64_t frameLimit = 0;
+};
+
+// Synthetic capture source producing the same gradient as the Ctrl+Alt+T test pattern
+// (R = u, G = v, B = 0.15) at a fixed refresh rate on the given clock.
+class SyntheticSource final : public ICaptureSource {
+public:
+    SyntheticSource(Clock& clock, const SyntheticSourceConfig& cfg);
+
+    const char* Name() const override { return "synthetic"; }
+    AcquireResult Acquire(uint32_t timeoutMs, FrameDesc& out) override;
+    void Release() override {}
+
+    uint64_t FramesProduced() const { return m_sequence; }
+    uint64_t FramesSkipped() const { return m_skipped; }
+
+    // Content of the most recently acquired frame (empty without cpuPixels).
+    const std::vector<uint8_t>& Pixels() const { return m_pixels; }
+
+private:
+    void PaintColumns(uint32_t x0, uint32_t x1, bool band);
+    void AdvanceMotion();
+
+    Clock& m_clock;
+    SyntheticSourceConfig m_cfg;
+    int64_t m_periodNs{};
+    int64_t m_nextFrameNs{};
+    uint64_t m_sequence{};
+    uint64_t m_skipped{};
+    uint32_t m_bandX{};
+    bool m_bandPainted{};
+    std::vector<uint8_t> m_pixels;
+    std::vector<Rect> m_dirty;
+};
+
+} // namespace rj
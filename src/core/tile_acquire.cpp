@@ -0,0 +1,110 @@
+#include "core/tile_acquire.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace rj {
+
+TileAcquireGroup::TileAcquireGroup(Clock& clock, const TileAcquireConfig& cfg)
+    : m_clock(clock), m_cfg(cfg), m_coherence(cfg.coherence) {}
+
+TileAcquireGroup::~TileAcquireGroup() {
+    Stop();
+}
+
+void TileAcquireGroup::Start(uint32_t tiles, AcquireFn acquire, ReleaseFn release) {
+    Stop();
+    m_acquire = std::move(acquire);
+    m_release = std::move(release);
+    {
+        std::scoped_lock lk(m_mutex);
+        m_coherence.Reset(tiles);
+        m_heldMask = 0;
+        m_droppedMask = 0;
+        m_running = true;
+        m_failed = false;
+        m_failure = AcquireResult::NewFrame;
+    }
+    for (uint32_t t = 0; t < m_coherence.TileCount(); t++) m_threads.emplace_back([this, t] { Worker(t); });
+}
+
+void TileAcquireGroup::Stop() {
+    {
+        std::scoped_lock lk(m_mutex);
+        m_running = false;
+    }
+    m_recycleCv.notify_all();
+    m_publishCv.notify_all();
+    for (std::thread& t : m_threads) t.join();
+    m_threads.clear();
+}
+
+void TileAcquireGroup::Worker(uint32_t tile) {
+    const uint32_t bit = 1u << tile;
+    for (;;) {
+        {
+            std::scoped_lock lk(m_mutex);
+            if (!m_running) return;
+        }
+
+        int64_t captureTimeNs = 0;
+        const AcquireResult r = m_acquire(tile, m_cfg.acquireTimeoutMs, captureTimeNs);
+        if (r == AcquireResult::Timeout) continue;
+        if (r != AcquireResult::NewFrame) {
+            std::scoped_lock lk(m_mutex);
+            m_failed = true;
+            m_failure = r;
+            m_publishCv.notify_all();
+            return;
+        }
+
+        {
+            std::unique_lock lk(m_mutex);
+            m_heldMask |= bit;
+            m_coherence.OnTileReady(tile, captureTimeNs, m_clock.NowNs());
+            m_publishCv.notify_all();
+            m_recycleCv.wait(lk, [&] { return !(m_heldMask & bit) || !m_running; });
+            if (m_heldMask & bit) m_droppedMask |= bit;
+            m_heldMask &= ~bit;
+        }
+        m_release(tile);
+    }
+}
+
+AcquireResult TileAcquireGroup::Collect(uint32_t timeoutMs, TilePublish& out) {
+    std::unique_lock lk(m_mutex);
+    const int64_t deadline = m_clock.NowNs() + static_cast<int64_t>(timeoutMs) * kNsPerMs;
+    for (;;) {
+        if (m_failed) return m_failure;
+        if (!m_running) return AcquireResult::Timeout;
+
+        const int64_t now = m_clock.NowNs();
+        int64_t wakeNs = 0;
+        if (m_coherence.ShouldPublish(now, wakeNs)) {
+            out = m_coherence.Publish(now);
+            return AcquireResult::NewFrame;
+        }
+        if (now >= deadline) return AcquireResult::Timeout;
+        m_publishCv.wait_for(lk, std::chrono::nanoseconds(std::min(wakeNs, deadline) - now));
+    }
+}
+
+void TileAcquireGroup::Recycle(uint32_t tileMask) {
+    {
+        std::scoped_lock lk(m_mutex);
+        m_heldMask &= ~tileMask;
+    }
+    m_recycleCv.notify_all();
+}
+
+uint32_t TileAcquireGroup::DroppedAtStop() {
+    std::scoped_lock lk(m_mutex);
+    return m_droppedMask;
+}
+
+TileSkewStats TileAcquireGroup::TakeStats() {
+    std::scoped_lock lk(m_mutex);
+    return m_coherence.TakeStats();
+}
+
+} // namespace rj
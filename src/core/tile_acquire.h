@@ -0,0 +1,81 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/capture_source.h"
+#include "core/clock.h"
+#include "core/tile_coherence.h"
+
+namespace rj {
+
+struct TileAcquireConfig {
+    // Timeout for each worker's blocking acquire. Also bounds how long Stop() takes.
+    uint32_t acquireTimeoutMs = 16;
+    CoherenceConfig coherence{};
+};
+
+// Acquires every tile of a composite on its own worker thread, so one slow output no longer
+// delays the others, and hands them to a single consumer (the capture thread) as decided
+// by TileCoherence.
+//
+// A worker keeps its frame acquired until the consumer has composited it (Recycle()), then
+// releases it and blocks for the next one. Like a DD duplication whose frame is held, the
+// source accumulates meanwhile. Between acquire and recycle the consumer may read the
+// tile's frame freely: the worker does not touch it.
+class TileAcquireGroup {
+public:
+    // Runs on tile `tile`'s worker. Waits up to `timeoutMs` for a frame and keeps it
+    // acquired; sets `captureTimeNs` (same time base for every tile; used for skew).
+    using AcquireFn = std::function<AcquireResult(uint32_t tile, uint32_t timeoutMs, int64_t& captureTimeNs)>;
+    // Runs on the worker once the frame has been recycled (or on Stop()).
+    using ReleaseFn = std::function<void(uint32_t tile)>;
+
+    // `clock` must be the real steady clock: waits use std::condition_variable.
+    explicit TileAcquireGroup(Clock& clock, const TileAcquireConfig& cfg = TileAcquireConfig{});
+    ~TileAcquireGroup();
+
+    TileAcquireGroup(const TileAcquireGroup&) = delete;
+    TileAcquireGroup& operator=(const TileAcquireGroup&) = delete;
+
+    void Start(uint32_t tiles, AcquireFn acquire, ReleaseFn release);
+    void Stop();
+    bool Running() const { return !m_threads.empty(); }
+
+    // Consumer. Waits up to `timeoutMs` for the policy to publish. On NewFrame, `out.tileMask`
+    // lists the tiles whose frames are ready; they stay valid until Recycle(). Returns
+    // AccessLost/Error once any worker failed.
+    AcquireResult Collect(uint32_t timeoutMs, TilePublish& out);
+    void Recycle(uint32_t tileMask);
+
+    // Tiles whose last acquired frame was never recycled because Stop() came first.
+    uint32_t DroppedAtStop();
+
+    TileSkewStats TakeStats();
+    const TileAcquireConfig& Config() const { return m_cfg; }
+
+private:
+    void Worker(uint32_t tile);
+
+    Clock& m_clock;
+    TileAcquireConfig m_cfg;
+    AcquireFn m_acquire;
+    ReleaseFn m_release;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_publishCv;  // consumer waits for tiles
+    std::condition_variable m_recycleCv;  // workers wait for their frame to be recycled
+    TileCoherence m_coherence;
+    uint32_t m_heldMask{};
+    uint32_t m_droppedMask{};
+    bool m_running{};
+    bool m_failed{};
+    AcquireResult m_failure{AcquireResult::NewFrame};
+};
+
+} // namespace rj
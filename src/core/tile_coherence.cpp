@@ -0,0 +1,131 @@
+#include "core/tile_coherence.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "core/clock.h"
+
+namespace rj {
+
+const char* CoherencePolicyName(CoherencePolicy p) {
+    switch (p) {
+        case CoherencePolicy::AllTiles:
+            return "all";
+        case CoherencePolicy::Window:
+            return "window";
+        case CoherencePolicy::Partial:
+            return "partial";
+    }
+    return "?";
+}
+
+bool ParseCoherencePolicy(const char* s, CoherencePolicy& out) {
+    if (!s) return false;
+    if (std::strcmp(s, "all") == 0) {
+        out = CoherencePolicy::AllTiles;
+    } else if (std::strcmp(s, "window") == 0) {
+        out = CoherencePolicy::Window;
+    } else if (std::strcmp(s, "partial") == 0) {
+        out = CoherencePolicy::Partial;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void TileSkewStats::Add(const TilePublish& p) {
+    publishes++;
+    if (!p.complete) incomplete++;
+    skewSumNs += p.skewNs;
+    skewMaxNs = std::max(skewMaxNs, p.skewNs);
+    waitSumNs += p.waitNs;
+    waitMaxNs = std::max(waitMaxNs, p.waitNs);
+}
+
+double TileSkewStats::AvgSkewUs() const {
+    return publishes ? NsToUs(skewSumNs) / static_cast<double>(publishes) : 0.0;
+}
+
+double TileSkewStats::AvgWaitUs() const {
+    return publishes ? NsToUs(waitSumNs) / static_cast<double>(publishes) : 0.0;
+}
+
+TileCoherence::TileCoherence(const CoherenceConfig& cfg) : m_cfg(cfg) {}
+
+void TileCoherence::Reset(uint32_t tiles) {
+    m_tiles.assign(std::min<uint32_t>(tiles, 32), TileState{});
+    m_pendingMask = 0;
+    m_firstPendingNs = 0;
+    m_last = TilePublish{};
+    m_stats = TileSkewStats{};
+}
+
+void TileCoherence::OnTileReady(uint32_t tile, int64_t captureTimeNs, int64_t nowNs) {
+    if (tile >= m_tiles.size()) return;
+    TileState& t = m_tiles[tile];
+    t.everSeen = true;
+    t.lastArrivalNs = nowNs;
+    t.captureTimeNs = captureTimeNs;
+    if (m_pendingMask == 0) m_firstPendingNs = nowNs;
+    m_pendingMask |= 1u << tile;
+}
+
+// Tiles worth waiting for: the ones that produced a frame recently. Pending tiles are
+// always active.
+uint32_t TileCoherence::ActiveMask(int64_t nowNs) const {
+    uint32_t mask = m_pendingMask;
+    for (uint32_t i = 0; i < m_tiles.size(); i++) {
+        const TileState& t = m_tiles[i];
+        if (t.everSeen && nowNs - t.lastArrivalNs < m_cfg.idleAfterNs) mask |= 1u << i;
+    }
+    return mask;
+}
+
+bool TileCoherence::ShouldPublish(int64_t nowNs, int64_t& wakeNs) const {
+    wakeNs = INT64_MAX;
+    if (m_pendingMask == 0) return false;
+    if (m_cfg.policy == CoherencePolicy::Partial) return true;
+    if ((ActiveMask(nowNs) & ~m_pendingMask) == 0) return true;
+
+    const int64_t limit = m_cfg.policy == CoherencePolicy::Window ? m_cfg.windowNs : m_cfg.maxWaitNs;
+    const int64_t deadline = m_firstPendingNs + limit;
+    if (nowNs >= deadline) return true;
+
+    // A missing tile may also turn idle before the deadline.
+    wakeNs = deadline;
+    for (uint32_t i = 0; i < m_tiles.size(); i++) {
+        const TileState& t = m_tiles[i];
+        if ((m_pendingMask & (1u << i)) || !t.everSeen || nowNs - t.lastArrivalNs >= m_cfg.idleAfterNs) continue;
+        wakeNs = std::min(wakeNs, t.lastArrivalNs + m_cfg.idleAfterNs);
+    }
+    return false;
+}
+
+const TilePublish& TileCoherence::Publish(int64_t nowNs) {
+    TilePublish p{};
+    p.tileMask = m_pendingMask;
+    p.complete = (ActiveMask(nowNs) & ~m_pendingMask) == 0;
+    p.waitNs = m_pendingMask ? nowNs - m_firstPendingNs : 0;
+    int64_t minT = INT64_MAX;
+    int64_t maxT = INT64_MIN;
+    for (uint32_t i = 0; i < m_tiles.size(); i++) {
+        if (!(m_pendingMask & (1u << i))) continue;
+        p.tileCount++;
+        minT = std::min(minT, m_tiles[i].captureTimeNs);
+        maxT = std::max(maxT, m_tiles[i].captureTimeNs);
+    }
+    p.skewNs = p.tileCount > 1 ? maxT - minT : 0;
+    m_pendingMask = 0;
+    m_last = p;
+    if (p.tileCount > 0) m_stats.Add(p);
+    return m_last;
+}
+
+TileSkewStats TileCoherence::TakeStats() {
+    const TileSkewStats s = m_stats;
+    m_stats = TileSkewStats{};
+    return s;
+}
+
+} // namespace rj
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rj {
+
+// When a composite of several independently captured tiles is published.
+enum class CoherencePolicy : uint8_t {
+    AllTiles,  // wait until every active tile has a new frame (bounded by maxWaitNs)
+    Window,    // wait for every active tile, but at most windowNs after the first one
+    Partial,   // publish as soon as any tile has a new frame
+};
+
+const char* CoherencePolicyName(CoherencePolicy p);
+
+// Parses "all", "window" or "partial"; returns false for anything else.
+bool ParseCoherencePolicy(const char* s, CoherencePolicy& out);
+
+struct CoherenceConfig {
+    CoherencePolicy policy = CoherencePolicy::Window;
+
+    // Window: how long after the first pending tile the composite is published anyway.
+    int64_t windowNs = 4000000;
+
+    // AllTiles: upper bound on the wait, so one stuck output cannot freeze the others.
+    int64_t maxWaitNs = 50000000;
+
+    // A tile with no frame for this long is idle (static desktop: DD only reports
+    // changes) and is not waited for until it produces a frame again.
+    int64_t idleAfterNs = 100000000;
+};
+
+// One published composite.
+struct TilePublish {
+    uint32_t tileMask{};    // tiles with a new frame in this composite
+    uint32_t tileCount{};   // popcount of tileMask
+    bool complete{};        // every active tile was included
+    int64_t skewNs{};       // spread of the included tiles' capture timestamps
+    int64_t waitNs{};       // first pending tile -> publish
+};
+
+// Aggregates over the publishes since the last TakeAndReset().
+struct TileSkewStats {
+    uint64_t publishes{};
+    uint64_t incomplete{};  // published before every active tile had a frame
+    int64_t skewSumNs{};
+    int64_t skewMaxNs{};
+    int64_t waitSumNs{};
+    int64_t waitMaxNs{};
+
+    void Add(const TilePublish& p);
+    double AvgSkewUs() const;
+    double AvgWaitUs() const;
+};
+
+// Decides when a composite of tiles that arrive independently (one DD duplication per
+// monitor, each acquired on its own thread) is published. Pure state machine driven by
+// the caller's timestamps, so it runs unchanged against simulated sources.
+//
+// `captureTimeNs` is only used for skew (tiles must share its time base); arrival times
+// (`nowNs`) drive the policy.
+class TileCoherence {
+public:
+    explicit TileCoherence(const CoherenceConfig& cfg = CoherenceConfig{});
+
+    void Reset(uint32_t tiles);
+    void SetConfig(const CoherenceConfig& cfg) { m_cfg = cfg; }
+    const CoherenceConfig& Config() const { return m_cfg; }
+    uint32_t TileCount() const { return static_cast<uint32_t>(m_tiles.size()); }
+
+    // Tile `tile` has a new frame waiting to be composited.
+    void OnTileReady(uint32_t tile, int64_t captureTimeNs, int64_t nowNs);
+
+    bool HasPending() const { return m_pendingMask != 0; }
+    uint32_t PendingMask() const { return m_pendingMask; }
+
+    // True when the pending tiles should be published now. Otherwise `wakeNs` is when to
+    // ask again if nothing else arrives (INT64_MAX when nothing is pending).
+    bool ShouldPublish(int64_t nowNs, int64_t& wakeNs) const;
+
+    // Publishes every pending tile and clears them.
+    const TilePublish& Publish(int64_t nowNs);
+
+    const TileSkewStats& Stats() const { return m_stats; }
+    TileSkewStats TakeStats();
+
+private:
+    struct TileState {
+        bool everSeen{};
+        int64_t lastArrivalNs{};
+        int64_t captureTimeNs{};
+    };
+
+    uint32_t ActiveMask(int64_t nowNs) const;
+
+    CoherenceConfig m_cfg;
+    std::vector<TileState> m_tiles;
+    uint32_t m_pendingMask{};
+    int64_t m_firstPendingNs{};
+    TilePublish m_last;
+    TileSkewStats m_stats;
+};
+
+} // namespace rj
@@ -0,0 +1,171 @@
+#include "core/tile_hash.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/tile_hash_impl.h"
+
+namespace rj {
+
+namespace detail {
+
+namespace {
+
+inline void AccumulateScalar(uint64_t* acc, const uint8_t* block, uint32_t b) {
+    uint64_t lane[kHashLanes];
+    std::memcpy(lane, block, kHashBlockBytes);
+    const uint64_t* key = kHashKeys.block + (b % kHashKeyBlocks) * kHashLanes;
+    for (uint32_t l = 0; l < kHashLanes; l++) {
+        const uint64_t dk = lane[l] ^ key[l];
+        acc[l] += lane[l ^ 1u] + (dk & 0xFFFFFFFFull) * (dk >> 32);
+    }
+}
+
+inline void ScrambleScalar(uint64_t* acc) {
+    for (uint32_t l = 0; l < kHashLanes; l++) acc[l] = (acc[l] ^ (acc[l] >> 47) ^ kHashKeys.row[l]) * kPrime32;
+}
+
+} // namespace
+
+// Walks the frame row by row (one accumulator set per tile of the band) so memory is read
+// in order.
+void HashTilesScalar(const TileHashJob& job) {
+    const uint32_t ts = job.tileSize;
+    for (uint32_t tr = job.rowBegin; tr < job.rowEnd; tr++) {
+        const uint32_t y0 = tr * ts;
+        const uint32_t tileH = std::min(ts, job.height - y0);
+        for (uint32_t c = 0; c < job.cols; c++) std::memcpy(job.acc + c * kHashLanes, kHashKeys.seed, sizeof(kHashKeys.seed));
+        for (uint32_t y = y0; y < y0 + tileH; y++) {
+            const uint8_t* row = job.pixels + static_cast<size_t>(y) * job.strideBytes;
+            for (uint32_t c = 0; c < job.cols; c++) {
+                const uint32_t x0 = c * ts;
+                const uint32_t bytes = std::min(ts, job.width - x0) * 4u;
+                const uint8_t* p = row + static_cast<size_t>(x0) * 4u;
+                uint64_t* acc = job.acc + c * kHashLanes;
+                uint32_t b = 0;
+                for (; (b + 1) * kHashBlockBytes <= bytes; b++) AccumulateScalar(acc, p + b * kHashBlockBytes, b);
+                if (b * kHashBlockBytes < bytes) {
+                    uint8_t block[kHashBlockBytes];
+                    LoadPartialBlock(block, p + b * kHashBlockBytes, bytes - b * kHashBlockBytes);
+                    AccumulateScalar(acc, block, b);
+                }
+                ScrambleScalar(acc);
+            }
+        }
+        for (uint32_t c = 0; c < job.cols; c++) {
+            job.hashes[static_cast<size_t>(tr) * job.cols + c] = Finish(job.acc + c * kHashLanes, std::min(ts, job.width - c * ts), tileH);
+        }
+    }
+}
+
+} // namespace detail
+
+namespace {
+
+detail::TileHashFn SelectKernel(SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(DetectSimdLevel())) level = DetectSimdLevel();
+    return level == SimdLevel::Avx2 ? detail::HashTilesAvx2 : detail::HashTilesScalar;
+}
+
+} // namespace
+
+void HashTiles(const uint8_t* pixels,
+               uint32_t strideBytes,
+               uint32_t width,
+               uint32_t height,
+               uint32_t tileSize,
+               uint32_t rowBegin,
+               uint32_t rowEnd,
+               uint64_t* hashes,
+               SimdLevel level) {
+    if (!pixels || !hashes || width == 0 || height == 0 || tileSize == 0) return;
+    std::vector<uint64_t> acc(static_cast<size_t>(TileCols(width, tileSize)) * detail::kHashLanes);
+    detail::TileHashJob job;
+    job.pixels = pixels;
+    job.strideBytes = strideBytes;
+    job.width = width;
+    job.height = height;
+    job.tileSize = tileSize;
+    job.cols = TileCols(width, tileSize);
+    job.rowBegin = rowBegin;
+    job.rowEnd = std::min(rowEnd, TileRows(height, tileSize));
+    job.hashes = hashes;
+    job.acc = acc.data();
+    SelectKernel(level)(job);
+}
+
+TileHasher::TileHasher(const TileHashConfig& cfg) : m_cfg(cfg), m_pool(cfg.threads) {
+    m_cfg.tileSize = std::max<uint32_t>(m_cfg.tileSize, 1);
+    m_scratch.resize(m_pool.Threads());
+}
+
+void TileHasher::Reset() {
+    m_valid = false;
+}
+
+void TileHasher::HashBand(const Job& job, uint32_t band) {
+    const uint32_t bands = static_cast<uint32_t>(m_scratch.size());
+    detail::TileHashJob k;
+    k.pixels = job.pixels;
+    k.strideBytes = job.strideBytes;
+    k.width = job.width;
+    k.height = job.height;
+    k.tileSize = m_cfg.tileSize;
+    k.cols = m_cols;
+    k.rowBegin = BandBegin(m_rows, band, bands);
+    k.rowEnd = BandBegin(m_rows, band + 1, bands);
+    k.hashes = m_hashes.data();
+    k.acc = m_scratch[band].data();
+    if (k.rowBegin < k.rowEnd) SelectKernel(m_cfg.level)(k);
+}
+
+uint32_t TileHasher::Update(const uint8_t* pixels, uint32_t strideBytes, uint32_t width, uint32_t height) {
+    if (!pixels || width == 0 || height == 0) return 0;
+    if (width != m_width || height != m_height) {
+        m_width = width;
+        m_height = height;
+        m_cols = TileCols(width, m_cfg.tileSize);
+        m_rows = TileRows(height, m_cfg.tileSize);
+        const size_t tiles = static_cast<size_t>(m_cols) * m_rows;
+        m_hashes.assign(tiles, 0);
+        m_previous.assign(tiles, 0);
+        m_changed.assign(tiles, 1);
+        for (auto& s : m_scratch) s.assign(static_cast<size_t>(m_cols) * detail::kHashLanes, 0);
+        m_valid = false;
+    }
+    std::swap(m_hashes, m_previous);
+
+    const Job job{pixels, strideBytes, width, height};
+    m_pool.Run([&](uint32_t band) { HashBand(job, band); });
+
+    uint32_t changed = 0;
+    for (size_t i = 0; i < m_hashes.size(); i++) {
+        m_changed[i] = !m_valid || m_hashes[i] != m_previous[i];
+        changed += m_changed[i];
+    }
+    m_valid = true;
+    return changed;
+}
+
+void TileHasher::ChangedRects(std::vector<Rect>& out) const {
+    out.clear();
+    const int32_t ts = static_cast<int32_t>(m_cfg.tileSize);
+    for (uint32_t r = 0; r < m_rows; r++) {
+        const uint8_t* row = m_changed.data() + static_cast<size_t>(r) * m_cols;
+        for (uint32_t c = 0; c < m_cols;) {
+            if (!row[c]) {
+                c++;
+                continue;
+            }
+            const uint32_t begin = c;
+            while (c < m_cols && row[c]) c++;
+            const int32_t top = static_cast<int32_t>(r) * ts;
+            out.push_back(Rect{static_cast<int32_t>(begin) * ts,
+                               top,
+                               std::min(static_cast<int32_t>(c) * ts, static_cast<int32_t>(m_width)),
+                               std::min(top + ts, static_cast<int32_t>(m_height))});
+        }
+    }
+}
+
+} // namespace rj
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/cpu_features.h"
+#include "core/frame.h"
+#include "core/worker_pool.h"
+
+namespace rj {
+
+// Content hash of every tileSize x tileSize tile of a frame of 4-byte pixels, row-major
+// (tiles at the right and bottom edge may be smaller). Hashes are 64-bit, sensitive to the
+// position of every byte inside the tile, and identical at every SIMD level; `level` is
+// clamped to what the CPU supports (SSE4.1 uses the scalar kernel). Hashes tile rows
+// [rowBegin, rowEnd) only; `hashes` holds TileCols() * TileRows() entries.
+void HashTiles(const uint8_t* pixels,
+               uint32_t strideBytes,
+               uint32_t width,
+               uint32_t height,
+               uint32_t tileSize,
+               uint32_t rowBegin,
+               uint32_t rowEnd,
+               uint64_t* hashes,
+               SimdLevel level = DetectSimdLevel());
+
+inline uint32_t TileCols(uint32_t width, uint32_t tileSize) {
+    return (width + tileSize - 1) / tileSize;
+}
+
+inline uint32_t TileRows(uint32_t height, uint32_t tileSize) {
+    return (height + tileSize - 1) / tileSize;
+}
+
+struct TileHashConfig {
+    uint32_t tileSize = 64;
+    // Threads hashing one frame, the caller included. Each takes a band of tile rows.
+    uint32_t threads = 1;
+    SimdLevel level = DetectSimdLevel();
+};
+
+// Change detection for frames that come without dirty rects (WGC, IDD, a CPU readback):
+// hashes each frame's tiles and compares them with the previous frame's.
+class TileHasher {
+public:
+    explicit TileHasher(const TileHashConfig& cfg = TileHashConfig{});
+    // Hashes `pixels` and returns the number of tiles that changed since the previous call.
+    // The first frame, and the first one after a size change or Reset(), changed everywhere.
+    uint32_t Update(const uint8_t* pixels, uint32_t strideBytes, uint32_t width, uint32_t height);
+    void Reset();
+
+    uint32_t Cols() const { return m_cols; }
+    uint32_t Rows() const { return m_rows; }
+    // One byte per tile, row-major: nonzero when it changed in the last Update().
+    const std::vector<uint8_t>& Changed() const { return m_changed; }
+    const std::vector<uint64_t>& Hashes() const { return m_hashes; }
+
+    // Changed tiles as rects in frame coordinates, horizontal runs merged (for
+    // OutputsTouched()).
+    void ChangedRects(std::vector<Rect>& out) const;
+
+private:
+    struct Job {
+        const uint8_t* pixels{};
+        uint32_t strideBytes{};
+        uint32_t width{};
+        uint32_t height{};
+    };
+
+    void HashBand(const Job& job, uint32_t band);
+
+    TileHashConfig m_cfg;
+    uint32_t m_width{};
+    uint32_t m_height{};
+    uint32_t m_cols{};
+    uint32_t m_rows{};
+    bool m_valid{};
+    std::vector<uint64_t> m_hashes;
+    std::vector<uint64_t> m_previous;
+    std::vector<uint8_t> m_changed;
+    std::vector<std::vector<uint64_t>> m_scratch;  // kernel accumulators, one set per band
+    WorkerPool m_pool;
+};
+
+} // namespace rj
@@ -0,0 +1,110 @@
+// AVX2 tile hash kernel. Built with -mavx2 (/arch:AVX2 on MSVC); only called after
+// DetectSimdLevel() reported AVX2.
+
+#include <algorithm>
+
+#include "core/cpu_features.h"
+#include "core/tile_hash_impl.h"
+
+#if RJ_X86
+#include <immintrin.h>
+#endif
+
+namespace rj::detail {
+
+#if RJ_X86
+
+namespace {
+
+inline __m256i BlockKey(uint32_t b) {
+    return _mm256_load_si256(reinterpret_cast<const __m256i*>(kHashKeys.block + (b % kHashKeyBlocks) * kHashLanes));
+}
+
+// One 32-byte block is exactly the four lanes; the 32x32->64 multiply is _mm256_mul_epu32.
+inline __m256i AccumulateKeyed(__m256i acc, __m256i data, __m256i key) {
+    const __m256i dk = _mm256_xor_si256(data, key);
+    const __m256i product = _mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32));
+    const __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm256_add_epi64(acc, _mm256_add_epi64(swapped, product));
+}
+
+inline __m256i Accumulate(__m256i acc, __m256i data, uint32_t b) {
+    return AccumulateKeyed(acc, data, BlockKey(b));
+}
+
+// acc * kPrime32 in 64-bit lanes, from two 32x32 products.
+inline __m256i Scramble(__m256i acc, __m256i rowKey, __m256i prime) {
+    acc = _mm256_xor_si256(_mm256_xor_si256(acc, _mm256_srli_epi64(acc, 47)), rowKey);
+    const __m256i lo = _mm256_mul_epu32(acc, prime);
+    const __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(acc, 32), prime);
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+}
+
+} // namespace
+
+void HashTilesAvx2(const TileHashJob& job) {
+    const uint32_t ts = job.tileSize;
+    const __m256i rowKey = _mm256_load_si256(reinterpret_cast<const __m256i*>(kHashKeys.row));
+    const __m256i seed = _mm256_load_si256(reinterpret_cast<const __m256i*>(kHashKeys.seed));
+    const __m256i prime = _mm256_set1_epi64x(static_cast<long long>(kPrime32));
+    const __m256i k0 = BlockKey(0);
+    const __m256i k1 = BlockKey(1);
+    const __m256i k2 = BlockKey(2);
+    const __m256i k3 = BlockKey(3);
+    const __m256i k4 = BlockKey(4);
+    const __m256i k5 = BlockKey(5);
+    const __m256i k6 = BlockKey(6);
+    const __m256i k7 = BlockKey(7);
+    for (uint32_t tr = job.rowBegin; tr < job.rowEnd; tr++) {
+        const uint32_t y0 = tr * ts;
+        const uint32_t tileH = std::min(ts, job.height - y0);
+        for (uint32_t c = 0; c < job.cols; c++) _mm256_storeu_si256(reinterpret_cast<__m256i*>(job.acc + c * kHashLanes), seed);
+        for (uint32_t y = y0; y < y0 + tileH; y++) {
+            const uint8_t* row = job.pixels + static_cast<size_t>(y) * job.strideBytes;
+            for (uint32_t c = 0; c < job.cols; c++) {
+                const uint32_t x0 = c * ts;
+                const uint32_t bytes = std::min(ts, job.width - x0) * 4u;
+                const uint8_t* p = row + static_cast<size_t>(x0) * 4u;
+                __m256i* accp = reinterpret_cast<__m256i*>(job.acc + c * kHashLanes);
+                __m256i acc = _mm256_loadu_si256(accp);
+                if (bytes == kHashKeyBlocks * kHashBlockBytes) {
+                    // Full 64-pixel tile row: unrolled, keys stay in registers.
+                    const __m256i* src = reinterpret_cast<const __m256i*>(p);
+                    acc = AccumulateKeyed(acc, _mm256_loadu_si256(src + 0), k0);
+                    acc = AccumulateKeyed(acc, _mm256_loadu_si256(src + 1), k1);
+                    acc = AccumulateKeyed(acc, _mm256_loadu_si256(src + 2), k2);
+                    acc = AccumulateKeyed(acc, _mm256_loadu_si256(src + 3), k3);
+                    acc = AccumulateKeyed(acc, _mm256_loadu_si256(src + 4), k4);
+                    acc = AccumulateKeyed(acc, _mm256_loadu_si256(src + 5), k5);
+                    acc = AccumulateKeyed(acc, _mm256_loadu_si256(src + 6), k6);
+                    acc = AccumulateKeyed(acc, _mm256_loadu_si256(src + 7), k7);
+                    _mm256_storeu_si256(accp, Scramble(acc, rowKey, prime));
+                    continue;
+                }
+                uint32_t b = 0;
+                for (; (b + 1) * kHashBlockBytes <= bytes; b++) {
+                    acc = Accumulate(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + b * kHashBlockBytes)), b);
+                }
+                if (b * kHashBlockBytes < bytes) {
+                    alignas(32) uint8_t block[kHashBlockBytes];
+                    LoadPartialBlock(block, p + b * kHashBlockBytes, bytes - b * kHashBlockBytes);
+                    acc = Accumulate(acc, _mm256_load_si256(reinterpret_cast<const __m256i*>(block)), b);
+                }
+                _mm256_storeu_si256(accp, Scramble(acc, rowKey, prime));
+            }
+        }
+        for (uint32_t c = 0; c < job.cols; c++) {
+            job.hashes[static_cast<size_t>(tr) * job.cols + c] = Finish(job.acc + c * kHashLanes, std::min(ts, job.width - c * ts), tileH);
+        }
+    }
+}
+
+#else
+
+void HashTilesAvx2(const TileHashJob& job) {
+    HashTilesScalar(job);
+}
+
+#endif
+
+} // namespace rj::detail
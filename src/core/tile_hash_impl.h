@@ -0,0 +1,92 @@
+#pragma once
+
+// Internal to the tile hasher: the hash definition shared by the kernel TUs. Every kernel
+// must produce the same values as the scalar one.
+//
+// A tile row is read as 32-byte blocks (the last one zero-padded), each four 64-bit lanes.
+// Per block, in the style of XXH3's accumulate step:
+//   dk = lane[l] ^ key[block % 8][l]
+//   acc[l] += lane[l ^ 1] + lo32(dk) * hi32(dk)
+// and after every pixel row acc[l] = (acc[l] ^ (acc[l] >> 47) ^ rowKey[l]) * kPrime32, so
+// blocks and rows can't trade places. Finish() folds the four lanes and the tile size.
+
+#include <cstdint>
+#include <cstring>
+
+namespace rj::detail {
+
+constexpr uint32_t kHashBlockBytes = 32;
+constexpr uint32_t kHashLanes = 4;
+constexpr uint32_t kHashKeyBlocks = 8;  // keys repeat every 8 blocks (64 pixels)
+constexpr uint64_t kPrime32 = 0x9E3779B1ull;
+constexpr uint64_t kPrime64a = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime64b = 0xC2B2AE3D27D4EB4Full;
+
+constexpr uint64_t SplitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+struct HashKeys {
+    uint64_t block[kHashKeyBlocks * kHashLanes];
+    uint64_t row[kHashLanes];
+    uint64_t seed[kHashLanes];
+};
+
+constexpr HashKeys MakeHashKeys() {
+    HashKeys k{};
+    for (uint32_t i = 0; i < kHashKeyBlocks * kHashLanes; i++) k.block[i] = SplitMix64(i + 1);
+    for (uint32_t l = 0; l < kHashLanes; l++) {
+        k.row[l] = SplitMix64(0x100 + l);
+        k.seed[l] = SplitMix64(0x200 + l);
+    }
+    return k;
+}
+
+// 32-byte aligned so the SIMD kernels can load keys directly.
+alignas(32) inline constexpr HashKeys kHashKeys = MakeHashKeys();
+
+struct TileHashJob {
+    const uint8_t* pixels{};
+    uint32_t strideBytes{};
+    uint32_t width{};
+    uint32_t height{};
+    uint32_t tileSize{};
+    uint32_t cols{};
+    uint32_t rowBegin{};
+    uint32_t rowEnd{};
+    uint64_t* hashes{};
+    uint64_t* acc{};  // scratch, cols * kHashLanes
+};
+
+using TileHashFn = void (*)(const TileHashJob& job);
+
+void HashTilesScalar(const TileHashJob& job);
+void HashTilesAvx2(const TileHashJob& job);
+
+inline uint64_t Rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t Finish(const uint64_t* acc, uint32_t tileW, uint32_t tileH) {
+    uint64_t h = ((static_cast<uint64_t>(tileW) << 32) | tileH) * kPrime64a;
+    for (uint32_t l = 0; l < kHashLanes; l++) {
+        h ^= Rotl64(acc[l] * kPrime64b, 31) * kPrime64a;
+        h = Rotl64(h, 27) * kPrime64a + kPrime64b;
+    }
+    h ^= h >> 33;
+    h *= kPrime64b;
+    h ^= h >> 29;
+    h *= kPrime64a;
+    return h ^ (h >> 32);
+}
+
+// Copies the last, partial block of a tile row into a zero-padded block.
+inline void LoadPartialBlock(uint8_t* block, const uint8_t* src, uint32_t bytes) {
+    std::memset(block, 0, kHashBlockBytes);
+    std::memcpy(block, src, bytes);
+}
+
+} // namespace rj::detail
@@ -0,0 +1,269 @@
+#include "core/trace_ring.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+
+namespace rj {
+
+namespace {
+
+constexpr char kDumpMagic[8] = {'R', 'J', 'T', 'R', 'A', 'C', 'E', '1'};
+constexpr uint32_t kDumpVersion = 1;
+constexpr size_t kThreadNameBytes = 32;
+
+struct DumpHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordBytes;
+    uint32_t threadCount;
+    uint32_t reserved;
+    uint64_t recordCount;
+};
+
+uint8_t CurrentThreadIndex() {
+    static std::atomic<uint32_t> s_next{0};
+    thread_local const uint8_t t_index = static_cast<uint8_t>(std::min<uint32_t>(s_next.fetch_add(1, std::memory_order_relaxed), TraceRing::kMaxThreads - 1));
+    return t_index;
+}
+
+uint64_t PackWord(const TraceRecord& r) {
+    return static_cast<uint64_t>(r.event) | (static_cast<uint64_t>(r.phase) << 8) | (static_cast<uint64_t>(r.thread) << 16) |
+           (static_cast<uint64_t>(r.arg) << 32);
+}
+
+void UnpackWord(uint64_t w, TraceRecord& r) {
+    r.event = static_cast<TraceEvent>(w & 0xFF);
+    r.phase = static_cast<TracePhase>((w >> 8) & 0xFF);
+    r.thread = static_cast<uint8_t>((w >> 16) & 0xFF);
+    r.arg = static_cast<uint32_t>(w >> 32);
+}
+
+const char* ArgName(TraceEvent e) {
+    switch (e) {
+        case TraceEvent::Acquire:
+        case TraceEvent::Copy:
+            return "tile";
+        case TraceEvent::Draw:
+        case TraceEvent::Present:
+            return "output";
+        case TraceEvent::Publish:
+            return "tiles";
+        default:
+            return "arg";
+    }
+}
+
+} // namespace
+
+namespace detail {
+
+bool TraceSlot::Claim(uint64_t index) {
+    uint64_t cur = seq.load(std::memory_order_relaxed);
+    do {
+        if ((cur & 1) != 0 || cur > 2 * index) return false;
+    } while (!seq.compare_exchange_weak(cur, 2 * index + 1, std::memory_order_relaxed));
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+}
+
+void TraceSlot::Publish(uint64_t index, const TraceRecord& r) {
+    words[0].store(static_cast<uint64_t>(r.timeNs), std::memory_order_relaxed);
+    words[1].store(r.frameId, std::memory_order_relaxed);
+    words[2].store(PackWord(r), std::memory_order_relaxed);
+    seq.store(2 * index + 2, std::memory_order_release);
+}
+
+bool TraceSlot::Read(uint64_t index, TraceRecord& out) const {
+    const uint64_t before = seq.load(std::memory_order_acquire);
+    if (before != 2 * index + 2) return false;  // still being written, or already overwritten
+    const uint64_t timeNs = words[0].load(std::memory_order_relaxed);
+    const uint64_t frameId = words[1].load(std::memory_order_relaxed);
+    const uint64_t packed = words[2].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq.load(std::memory_order_relaxed) != before) return false;
+    out.timeNs = static_cast<int64_t>(timeNs);
+    out.frameId = frameId;
+    UnpackWord(packed, out);
+    return true;
+}
+
+} // namespace detail
+
+const char* TraceEventName(TraceEvent e) {
+    switch (e) {
+        case TraceEvent::Frame:
+            return "Frame";
+        case TraceEvent::Wait:
+            return "Wait";
+        case TraceEvent::Acquire:
+            return "Acquire";
+        case TraceEvent::Copy:
+            return "Copy";
+        case TraceEvent::Draw:
+            return "Draw";
+        case TraceEvent::Present:
+            return "Present";
+        case TraceEvent::Publish:
+            return "Publish";
+        case TraceEvent::Dump:
+            return "Dump";
+        case TraceEvent::Count:
+            break;
+    }
+    return "?";
+}
+
+TraceRing::TraceRing(uint32_t capacity) {
+    uint32_t cap = 1;
+    while (cap < capacity && cap < (1u << 30)) cap <<= 1;
+    m_slots = std::make_unique<detail::TraceSlot[]>(cap);
+    m_mask = cap - 1;
+}
+
+void TraceRing::Record(TraceEvent event, TracePhase phase, uint64_t frameId, int64_t timeNs, uint32_t arg) {
+    TraceRecord r;
+    r.timeNs = timeNs;
+    r.frameId = frameId;
+    r.event = event;
+    r.phase = phase;
+    r.thread = CurrentThreadIndex();
+    r.arg = arg;
+
+    // A writer a full lap behind or ahead may hold the same slot; the claim makes sure only
+    // one of them writes it.
+    const uint64_t index = m_head.fetch_add(1, std::memory_order_relaxed);
+    detail::TraceSlot& slot = m_slots[index & m_mask];
+    if (!slot.Claim(index)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    slot.Publish(index, r);
+}
+
+void TraceRing::NameThread(const char* name) {
+    std::lock_guard<std::mutex> lock(m_namesMutex);
+    char* dst = m_threadNames[CurrentThreadIndex()];
+    std::strncpy(dst, name ? name : "", kThreadNameBytes - 1);
+    dst[kThreadNameBytes - 1] = '\0';
+}
+
+void TraceRing::Snapshot(std::vector<TraceRecord>& out) const {
+    out.clear();
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+    const uint64_t cap = static_cast<uint64_t>(m_mask) + 1;
+    const uint64_t begin = head > cap ? head - cap : 0;
+    out.reserve(static_cast<size_t>(head - begin));
+    TraceRecord r;
+    for (uint64_t i = begin; i < head; i++) {
+        if (m_slots[i & m_mask].Read(i, r)) out.push_back(r);
+    }
+}
+
+std::vector<std::string> TraceRing::ThreadNames() const {
+    std::vector<std::string> names(kMaxThreads);
+    std::lock_guard<std::mutex> lock(m_namesMutex);
+    for (uint32_t i = 0; i < kMaxThreads; i++) {
+        names[i] = m_threadNames[i][0] ? std::string(m_threadNames[i]) : "thread " + std::to_string(i);
+    }
+    return names;
+}
+
+bool WriteTraceDump(FILE* f, const std::vector<TraceRecord>& records, const std::vector<std::string>& threadNames) {
+    DumpHeader h{};
+    std::memcpy(h.magic, kDumpMagic, sizeof(h.magic));
+    h.version = kDumpVersion;
+    h.recordBytes = sizeof(TraceRecord);
+    h.threadCount = static_cast<uint32_t>(threadNames.size());
+    h.recordCount = records.size();
+    if (fwrite(&h, sizeof(h), 1, f) != 1) return false;
+    for (const std::string& name : threadNames) {
+        char buf[kThreadNameBytes]{};
+        std::strncpy(buf, name.c_str(), kThreadNameBytes - 1);
+        if (fwrite(buf, sizeof(buf), 1, f) != 1) return false;
+    }
+    return records.empty() || fwrite(records.data(), sizeof(TraceRecord), records.size(), f) == records.size();
+}
+
+bool ReadTraceDump(FILE* f, std::vector<TraceRecord>& records, std::vector<std::string>& threadNames) {
+    DumpHeader h{};
+    if (fread(&h, sizeof(h), 1, f) != 1) return false;
+    if (std::memcmp(h.magic, kDumpMagic, sizeof(h.magic)) != 0 || h.version != kDumpVersion || h.recordBytes != sizeof(TraceRecord)) return false;
+    if (h.threadCount > 256) return false;
+    threadNames.clear();
+    for (uint32_t i = 0; i < h.threadCount; i++) {
+        char buf[kThreadNameBytes]{};
+        if (fread(buf, sizeof(buf), 1, f) != 1) return false;
+        buf[kThreadNameBytes - 1] = '\0';
+        threadNames.emplace_back(buf);
+    }
+    // Read incrementally so a corrupt count cannot make us allocate blindly.
+    records.clear();
+    TraceRecord r;
+    for (uint64_t i = 0; i < h.recordCount; i++) {
+        if (fread(&r, sizeof(r), 1, f) != 1) return false;
+        if (r.event >= TraceEvent::Count || r.phase > TracePhase::Instant) return false;
+        records.push_back(r);
+    }
+    return true;
+}
+
+void WriteChromeTraceJson(FILE* f, const std::vector<TraceRecord>& records, const std::vector<std::string>& threadNames) {
+    // Records are in claim order, which can differ from timestamp order across threads by
+    // a few ns; use the earliest time so every ts is non-negative.
+    int64_t origin = records.empty() ? 0 : records.front().timeNs;
+    for (const TraceRecord& r : records) origin = std::min(origin, r.timeNs);
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    bool first = true;
+    auto separator = [&] {
+        if (!first) fputs(",\n", f);
+        first = false;
+    };
+
+    bool used[256]{};
+    for (const TraceRecord& r : records) used[r.thread] = true;
+    for (size_t t = 0; t < 256; t++) {
+        if (!used[t]) continue;
+        separator();
+        const std::string name = t < threadNames.size() ? threadNames[t] : "thread " + std::to_string(t);
+        fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"", t);
+        for (char c : name) {
+            if (c == '"' || c == '\\') fputc('\\', f);
+            if (static_cast<unsigned char>(c) >= 0x20) fputc(c, f);
+        }
+        fputs("\"}}", f);
+    }
+
+    // The ring overwrote the start of some spans; drop Ends whose Begin is gone so the
+    // per-thread stacks stay balanced.
+    std::vector<uint32_t> depth(256 * static_cast<size_t>(TraceEvent::Count), 0);
+    for (const TraceRecord& r : records) {
+        uint32_t& d = depth[r.thread * static_cast<size_t>(TraceEvent::Count) + static_cast<size_t>(r.event)];
+        const char* ph = "i";
+        if (r.phase == TracePhase::Begin) {
+            ph = "B";
+            d++;
+        } else if (r.phase == TracePhase::End) {
+            if (d == 0) continue;
+            ph = "E";
+            d--;
+        }
+        separator();
+        const int64_t rel = r.timeNs - origin;
+        fprintf(f,
+                "{\"name\":\"%s\",\"cat\":\"rj\",\"ph\":\"%s\",\"ts\":%" PRId64 ".%03d,\"pid\":1,\"tid\":%u,%s\"args\":{\"frame\":%" PRIu64 ",\"%s\":%u}}",
+                TraceEventName(r.event),
+                ph,
+                rel / 1000,
+                static_cast<int>(rel % 1000),
+                static_cast<unsigned>(r.thread),
+                r.phase == TracePhase::Instant ? "\"s\":\"t\"," : "",
+                r.frameId,
+                ArgName(r.event),
+                static_cast<unsigned>(r.arg));
+    }
+    fprintf(f, "\n]}\n");
+}
+
+} // namespace rj
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rj {
+
+// What a trace record marks. Spans are recorded as a Begin and an End with the same event.
+enum class TraceEvent : uint8_t {
+    Frame,     // one render loop iteration
+    Wait,      // blocked on the frame-latency waitable / vblank; arg = 1 for the late-latch sleep
+    Acquire,   // AcquireNextFrame / source Acquire(); arg = tile
+    Copy,      // capture copy into the frame the outputs sample; arg = tile or slot
+    Draw,      // per-output draw; arg = output index
+    Present,   // Present() call; arg = output index
+    Publish,   // instant: a composite was handed to the render thread; arg = tile mask
+    Dump,      // instant: the ring was dumped
+    Count,
+};
+
+enum class TracePhase : uint8_t {
+    Begin,
+    End,
+    Instant,
+};
+
+const char* TraceEventName(TraceEvent e);
+
+// One event as stored in dumps (little-endian, 24 bytes).
+struct TraceRecord {
+    int64_t timeNs{};
+    uint64_t frameId{};
+    TraceEvent event{};
+    TracePhase phase{};
+    uint8_t thread{};  // process-wide thread index (see TraceRing::NameThread)
+    uint8_t reserved{};
+    uint32_t arg{};
+};
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord is a dump format");
+
+namespace detail {
+
+// One ring slot: a seqlock over three words, so concurrent readers never read torn
+// non-atomic memory. seq is 2 * index + 1 while record `index` is written and
+// 2 * index + 2 once it is complete. It only grows, so each record has exactly one writer.
+struct TraceSlot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<uint64_t> words[3]{};
+
+    // Takes the slot for record `index` when it holds a complete, older record. False when
+    // another writer owns it or a newer record is already there.
+    bool Claim(uint64_t index);
+    // Writes the claimed record and marks it complete.
+    void Publish(uint64_t index, const TraceRecord& r);
+    // Copies record `index` if it is complete and wasn't overwritten during the copy.
+    bool Read(uint64_t index, TraceRecord& out) const;
+};
+
+} // namespace detail
+
+// Always-on, fixed-size ring of per-frame events. Any thread may record; the oldest events
+// are overwritten. Recording is lock-free and allocation-free: one fetch_add for an index,
+// then a CAS on the slot's sequence number (TraceSlot::Claim) so only one writer at a time
+// owns the slot. Snapshot() can run concurrently and simply skips slots that are being
+// overwritten.
+//
+// A writer that finds its slot still owned by a writer a full lap behind (preempted mid
+// record), or already taken by a newer one, drops its event instead of waiting.
+//
+// Times are whatever the caller passes (rj_span: QPC converted to ns; rj_core: Clock).
+class TraceRing {
+public:
+    static constexpr uint32_t kMaxThreads = 16;
+
+    // `capacity` is rounded up to a power of two.
+    explicit TraceRing(uint32_t capacity = 1u << 16);
+
+    TraceRing(const TraceRing&) = delete;
+    TraceRing& operator=(const TraceRing&) = delete;
+
+    void Record(TraceEvent event, TracePhase phase, uint64_t frameId, int64_t timeNs, uint32_t arg = 0);
+    void Begin(TraceEvent event, uint64_t frameId, int64_t timeNs, uint32_t arg = 0) { Record(event, TracePhase::Begin, frameId, timeNs, arg); }
+    void End(TraceEvent event, uint64_t frameId, int64_t timeNs, uint32_t arg = 0) { Record(event, TracePhase::End, frameId, timeNs, arg); }
+    void Instant(TraceEvent event, uint64_t frameId, int64_t timeNs, uint32_t arg = 0) { Record(event, TracePhase::Instant, frameId, timeNs, arg); }
+
+    // Names the calling thread in this ring's dumps. Threads get a process-wide index on
+    // their first event; unnamed ones show up as "thread N". Threads past kMaxThreads share
+    // the last index. Not for hot paths (takes a lock).
+    void NameThread(const char* name);
+
+    // Copies the events still in the ring, oldest first.
+    void Snapshot(std::vector<TraceRecord>& out) const;
+    std::vector<std::string> ThreadNames() const;
+
+    uint32_t Capacity() const { return m_mask + 1; }
+    uint64_t Recorded() const { return m_head.load(std::memory_order_relaxed); }
+    // Events dropped because their slot was owned by another writer.
+    uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<detail::TraceSlot[]> m_slots;
+    uint32_t m_mask{};
+    alignas(64) std::atomic<uint64_t> m_head{0};
+    std::atomic<uint64_t> m_dropped{0};
+    mutable std::mutex m_namesMutex;
+    char m_threadNames[kMaxThreads][32]{};
+};
+
+// Binary dump: a header, the thread names, then the records.
+bool WriteTraceDump(FILE* f, const std::vector<TraceRecord>& records, const std::vector<std::string>& threadNames);
+bool ReadTraceDump(FILE* f, std::vector<TraceRecord>& records, std::vector<std::string>& threadNames);
+
+// Chrome trace event JSON ("traceEvents"), loadable in chrome://tracing and Perfetto.
+void WriteChromeTraceJson(FILE* f, const std::vector<TraceRecord>& records, const std::vector<std::string>& threadNames);
+
+} // namespace rj
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace rj {
+
+constexpr size_t kCacheLineBytes = 64;
+
+// Wait-free single-producer / single-consumer "latest value" handoff.
+//
+// Three slots rotate between the producer (back), the consumer (front) and a shared middle
+// slot. Publishing swaps back <-> middle and reading swaps middle <-> front, each with one
+// atomic exchange, so neither side ever blocks or retries. Values the consumer doesn't pick
+// up in time are overwritten; the consumer always sees the newest complete value.
+//
+// T may own resources (e.g. a COM pointer). A slot is only touched by the side that
+// currently owns it, so T's copy/assignment doesn't need to be thread-safe.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer side.
+
+    // Slot the producer fills before calling Publish(). Contents are whatever was left there
+    // by an earlier round; overwrite every field.
+    T& WriteSlot() { return m_slots[m_back].value; }
+
+    void Publish() {
+        const uint8_t prev = m_state.exchange(static_cast<uint8_t>(m_back | kFreshBit), std::memory_order_acq_rel);
+        m_back = prev & kIndexMask;
+    }
+
+    void Write(const T& value) {
+        WriteSlot() = value;
+        Publish();
+    }
+
+    // Consumer side.
+
+    // True when a value newer than Read() has been published.
+    bool HasNew() const { return (m_state.load(std::memory_order_relaxed) & kFreshBit) != 0; }
+
+    // Makes the newest published value current. Returns false (and keeps the current value)
+    // when nothing was published since the last call.
+    bool Update() {
+        if (!HasNew()) return false;
+        const uint8_t prev = m_state.exchange(m_front, std::memory_order_acq_rel);
+        m_front = prev & kIndexMask;
+        return true;
+    }
+
+    // Current value; stable until the next Update().
+    const T& Read() const { return m_slots[m_front].value; }
+    T& ReadSlot() { return m_slots[m_front].value; }
+
+    // Either side, while neither is running: drops every slot's value (releasing what it
+    // owns) and anything published, so the next Read() is empty until a new Publish().
+    void Reset() {
+        for (Slot& s : m_slots) s.value = T{};
+        m_state.store(1, std::memory_order_release);
+        m_back = 0;
+        m_front = 2;
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFreshBit = 0x4;
+
+    struct alignas(kCacheLineBytes) Slot {
+        T value{};
+    };
+
+    Slot m_slots[3];
+    alignas(kCacheLineBytes) std::atomic<uint8_t> m_state{1};  // middle slot index | fresh bit
+    alignas(kCacheLineBytes) uint8_t m_back{0};                // producer-owned
+    alignas(kCacheLineBytes) uint8_t m_front{2};               // consumer-owned
+};
+
+} // namespace rj
@@ -0,0 +1,128 @@
+#include "core/virtual_display.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "core/edid.h"
+#include "core/slice_plan.h"
+
+namespace rj {
+
+namespace {
+
+constexpr uint32_t kMaxTextureDimension = 16384;
+constexpr uint32_t kMinRateHz = 24;
+constexpr uint32_t kMaxRateHz = 500;
+// DISPLAYCONFIG_RATIONAL carries the pixel clock in a 32-bit numerator.
+constexpr uint64_t kMaxPixelClockHz = 0xFFFFFFFFull;
+// Physical size reported in the EDID: a 27" 2560x1440 panel, ~109 pixels per inch.
+constexpr double kPixelsPerMm = 108.8 / 25.4;
+
+bool ReadNumber(const char*& p, uint32_t& value) {
+    char* end = nullptr;
+    const unsigned long v = strtoul(p, &end, 10);
+    if (end == p || v > 0xFFFFFFFFul) return false;
+    value = static_cast<uint32_t>(v);
+    p = end;
+    return true;
+}
+
+bool AddRate(VirtualDisplayConfig& cfg, uint32_t hz) {
+    if (hz < kMinRateHz || hz > kMaxRateHz) return false;
+    for (uint32_t i = 0; i < cfg.rateCount; i++) {
+        if (cfg.ratesHz[i] == hz) return true;
+    }
+    if (cfg.rateCount == kMaxVirtualDisplayRates) return true;
+    cfg.ratesHz[cfg.rateCount++] = hz;
+    return true;
+}
+
+} // namespace
+
+bool ParseVirtualDisplayConfig(const std::string& text, VirtualDisplayConfig& out) {
+    VirtualDisplayConfig cfg;
+    cfg.rateCount = 0;
+    const char* p = text.c_str();
+    if (!ReadNumber(p, cfg.panels) || *p++ != 'x') return false;
+    if (!ReadNumber(p, cfg.panelWidth) || *p++ != 'x') return false;
+    if (!ReadNumber(p, cfg.panelHeight) || *p++ != '@') return false;
+    for (;;) {
+        uint32_t hz = 0;
+        if (!ReadNumber(p, hz) || !AddRate(cfg, hz)) return false;
+        if (*p == '\0') break;
+        if (*p++ != ',') return false;
+    }
+    if (cfg.panels == 0 || cfg.panels > kMaxSliceOutputs || cfg.panelWidth < 640 || cfg.panelHeight < 480 ||
+        uint64_t{cfg.panels} * cfg.panelWidth > kMaxTextureDimension || cfg.panelHeight > kMaxTextureDimension) {
+        return false;
+    }
+    out = cfg;
+    return true;
+}
+
+std::string FormatVirtualDisplayConfig(const VirtualDisplayConfig& cfg) {
+    char buf[128];
+    int n = snprintf(buf, sizeof(buf), "%ux%ux%u@", cfg.panels, cfg.panelWidth, cfg.panelHeight);
+    for (uint32_t i = 0; i < cfg.rateCount && n > 0 && n < static_cast<int>(sizeof(buf)); i++) {
+        n += snprintf(buf + n, sizeof(buf) - static_cast<size_t>(n), i ? ",%u" : "%u", cfg.ratesHz[i]);
+    }
+    return buf;
+}
+
+std::vector<DisplayTiming> BuildVirtualDisplayModes(const VirtualDisplayConfig& cfg) {
+    std::vector<DisplayTiming> modes;
+    for (uint32_t i = 0; i < cfg.rateCount; i++) {
+        DisplayTiming t;
+        if (!ComputeCvtTiming(cfg.WideWidth(), cfg.panelHeight, cfg.ratesHz[i], CvtBlanking::ReducedV2, t)) continue;
+        QuantizePixelClock(t, 10000);
+        if (t.pixelClockHz > kMaxPixelClockHz) continue;
+        modes.push_back(t);
+    }
+    return modes;
+}
+
+std::vector<uint8_t> BuildVirtualDisplayEdid(const VirtualDisplayConfig& cfg) {
+    EdidIdentity id;
+    id.productCode = static_cast<uint16_t>(0x5300 | cfg.panels);
+    id.widthMm = static_cast<uint32_t>(cfg.WideWidth() / kPixelsPerMm + 0.5);
+    id.heightMm = static_cast<uint32_t>(cfg.panelHeight / kPixelsPerMm + 0.5);
+    const std::vector<DisplayTiming> modes = BuildVirtualDisplayModes(cfg);
+    return BuildEdid(id, modes.data(), modes.size());
+}
+
+bool DeriveVirtualDisplayConfig(const std::vector<PanelModes>& panels, VirtualDisplayConfig& out) {
+    if (panels.empty() || panels.size() > kMaxSliceOutputs) return false;
+    const PanelModes& first = panels[0];
+    std::vector<uint32_t> common;
+    for (uint32_t hz : first.ratesHz) common.push_back(hz);
+    common.push_back(first.currentHz);
+    for (const PanelModes& p : panels) {
+        if (p.width != first.width || p.height != first.height) return false;
+        common.erase(std::remove_if(common.begin(),
+                                    common.end(),
+                                    [&](uint32_t hz) {
+                                        return hz != p.currentHz && std::find(p.ratesHz.begin(), p.ratesHz.end(), hz) == p.ratesHz.end();
+                                    }),
+                     common.end());
+    }
+    std::sort(common.begin(), common.end(), [](uint32_t a, uint32_t b) { return a > b; });
+
+    VirtualDisplayConfig cfg;
+    cfg.panels = static_cast<uint32_t>(panels.size());
+    cfg.panelWidth = first.width;
+    cfg.panelHeight = first.height;
+    cfg.rateCount = 0;
+    for (uint32_t hz : common) AddRate(cfg, hz);
+    if (cfg.rateCount == 0) {
+        // No shared rate within 24..500 Hz: the slowest panel's current refresh.
+        uint32_t slowest = first.currentHz;
+        for (const PanelModes& p : panels) slowest = std::min(slowest, p.currentHz);
+        if (!AddRate(cfg, slowest)) return false;
+    }
+    if (uint64_t{cfg.panels} * cfg.panelWidth > kMaxTextureDimension) return false;
+    out = cfg;
+    return true;
+}
+
+} // namespace rj
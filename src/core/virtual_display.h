@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/display_timing.h"
+
+namespace rj {
+
+constexpr uint32_t kMaxVirtualDisplayRates = 8;
+
+// The wide virtual monitor the IDD driver exposes: `panels` physical monitors side by side,
+// offered at each refresh rate in `ratesHz`. ratesHz[0] is the preferred mode. Text form is
+// "3x2560x1440@144,120,60"; rj_span derives it from the physical monitors and the driver
+// reads it back from HKLM\SOFTWARE\RjSpan\VirtualDisplay, value "Config".
+struct VirtualDisplayConfig {
+    uint32_t panels = 3;
+    uint32_t panelWidth = 2560;
+    uint32_t panelHeight = 1440;
+    uint32_t rateCount = 2;
+    uint32_t ratesHz[kMaxVirtualDisplayRates] = {120, 60};
+
+    uint32_t WideWidth() const { return panels * panelWidth; }
+};
+
+// Rejects anything the driver couldn't expose: more than kMaxSliceOutputs panels, a wide
+// frame past the 16384 pixel D3D11 texture limit, or rates outside 24..500 Hz. Repeated rates
+// are dropped.
+bool ParseVirtualDisplayConfig(const std::string& text, VirtualDisplayConfig& out);
+std::string FormatVirtualDisplayConfig(const VirtualDisplayConfig& cfg);
+
+// One CVT-RB2 timing per configured rate, in config order, with the pixel clock rounded to
+// the 10 kHz EDID units so the mode list and the EDID describe identical timings. Rates whose
+// pixel clock doesn't fit the 32-bit DISPLAYCONFIG_RATIONAL numerator are left out.
+std::vector<DisplayTiming> BuildVirtualDisplayModes(const VirtualDisplayConfig& cfg);
+
+// EDID (base block plus DisplayID extensions) that advertises BuildVirtualDisplayModes().
+std::vector<uint8_t> BuildVirtualDisplayEdid(const VirtualDisplayConfig& cfg);
+
+// What one physical monitor can show at its current resolution.
+struct PanelModes {
+    uint32_t width{};
+    uint32_t height{};
+    uint32_t currentHz{};
+    std::vector<uint32_t> ratesHz;  // refresh rates offered at width x height
+};
+
+// Panels must share a resolution. The rates are those every panel supports, highest first,
+// so the preferred mode runs at the panels' best common refresh instead of a fixed 120 Hz.
+bool DeriveVirtualDisplayConfig(const std::vector<PanelModes>& panels, VirtualDisplayConfig& out);
+
+} // namespace rj
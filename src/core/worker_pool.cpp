@@ -0,0 +1,55 @@
+#include "core/worker_pool.h"
+
+#include <algorithm>
+
+namespace rj {
+
+WorkerPool::WorkerPool(uint32_t threads) {
+    threads = std::clamp<uint32_t>(threads, 1, 64);
+    for (uint32_t band = 1; band < threads; band++) m_threads.emplace_back([this, band] { WorkerLoop(band); });
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_startCv.notify_all();
+    for (auto& t : m_threads) t.join();
+}
+
+void WorkerPool::WorkerLoop(uint32_t band) {
+    uint64_t seen = 0;
+    for (;;) {
+        const std::function<void(uint32_t)>* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCv.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) return;
+            seen = m_generation;
+            job = m_job;
+        }
+        (*job)(band);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_pending == 0) m_doneCv.notify_one();
+    }
+}
+
+void WorkerPool::Run(const std::function<void(uint32_t band)>& job) {
+    if (m_threads.empty()) {
+        job(0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_pending = static_cast<uint32_t>(m_threads.size());
+        m_generation++;
+    }
+    m_startCv.notify_all();
+    job(0);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCv.wait(lock, [&] { return m_pending == 0; });
+}
+
+} // namespace rj
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rj {
+
+// Fork/join over a fixed set of threads for per-frame work split into bands (tile rows):
+// Run(job) calls job(band) for every band 0..Threads()-1, band 0 on the calling thread,
+// and returns once all of them finished. One Run() at a time.
+class WorkerPool {
+public:
+    // `threads` includes the caller; 1 runs everything inline.
+    explicit WorkerPool(uint32_t threads = 1);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    uint32_t Threads() const { return static_cast<uint32_t>(m_threads.size()) + 1; }
+    void Run(const std::function<void(uint32_t band)>& job);
+
+private:
+    void WorkerLoop(uint32_t band);
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_startCv;
+    std::condition_variable m_doneCv;
+    const std::function<void(uint32_t)>* m_job{};
+    uint64_t m_generation{};
+    uint32_t m_pending{};
+    bool m_stop{};
+};
+
+// Items [begin, end) of `count` that band `band` of `bands` takes.
+inline uint32_t BandBegin(uint32_t count, uint32_t band, uint32_t bands) {
+    return static_cast<uint32_t>(static_cast<uint64_t>(count) * band / bands);
+}
+
+} // namespace rj
@@ -16,6 +16,7 @@
 #include <d3d11.h>
 #include <d3d11_1.h>
 #include <d3d11_3.h>
+#include <d3d11_4.h>
 #include <d3dcompiler.h>
 #include <dxgi1_2.h>
 #include <dxgi1_3.h>
@@ -25,7 +26,9 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdint>
-#include <mutex>
+#include <deque>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include <winrt/base.h>
@@ -35,6 +38,28 @@
 #include <winrt/Windows.Graphics.DirectX.Direct3D11.h>
 #include <winrt/Windows.Security.Authorization.AppCapabilityAccess.h>
 
+#include "core/backend_probe.h"
+#include "core/capture_recorder.h"
+#include "core/capture_thread.h"
+#include "core/clock.h"
+#include "core/damage_ring.h"
+#include "core/frame_channel.h"
+#include "core/frame_stats.h"
+#include "core/held_frame.h"
+#include "core/instant_replay.h"
+#include "core/late_latch.h"
+#include "core/output_damage.h"
+#include "core/placeholder_detector.h"
+#include "core/present_policy.h"
+#include "core/readback.h"
+#include "core/rect_coalescer.h"
+#include "core/shared_memory.h"
+#include "core/slice_plan.h"
+#include "core/tile_acquire.h"
+#include "core/trace_ring.h"
+#include "core/triple_buffer.h"
+#include "core/virtual_display.h"
+
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "dxgi.lib")
 #pragma comment(lib, "d3dcompiler.lib")
@@ -45,6 +70,15 @@ constexpr int kHotkeyToggle = 1;
 constexpr int kHotkeyEmergencyStop = 2;
 constexpr int kHotkeyExit = 3;
 constexpr int kHotkeyTestPattern = 4;
+constexpr int kHotkeyTraceDump = 5;
+constexpr int kHotkeyLateLatch = 6;
+constexpr int kHotkeyIddSlices = 7;
+constexpr int kHotkeyBlitFastPath = 8;
+constexpr int kHotkeyDdZeroCopy = 9;
+constexpr int kHotkeyPresentOnChange = 10;
+constexpr int kHotkeyRecord = 11;
+constexpr int kHotkeyReplayRing = 12;
+constexpr int kHotkeyReplaySave = 13;
 
 struct MonitorDesc {
     HMONITOR handle{};
@@ -80,6 +114,8 @@ struct D3DState {
     ID3D11PixelShader* ps{};
     ID3D11Buffer* cb{};
     ID3D11SamplerState* sampler{};
+    ID3D11PixelShader* downsamplePs{};  // box filter for downsampled readbacks
+    ID3D11Buffer* downsampleCb{};
 };
 
 struct alignas(16) Constants {
@@ -106,7 +142,6 @@ std::atomic<bool> g_useTestPattern{false};
 std::vector<OutputWindow> g_outputs;
 D3DState g_d3d;
 
-std::mutex g_captureMutex;
 ID3D11ShaderResourceView* g_captureSrv{};
 ID3D11ShaderResourceView* g_captureSrvY{};
 ID3D11ShaderResourceView* g_captureSrvUV{};
@@ -117,14 +152,33 @@ ID3D11ShaderResourceView* g_captureSrvUV{};
 // - Copy directly into BGRA/RGBA (`g_captureTex` + `g_captureSrv`)
 // - Or copy NV12 and use the VideoProcessor to convert to BGRA (`g_captureNv12Tex` -> `g_captureRgbTex`)
 //
-// All of these are written from the capture thread and read from the render thread.
+// All of these are owned by the render thread. The WGC callback only publishes into
+// `g_wgcFrames`.
 ID3D11Texture2D* g_captureTex{}; // BGRA/RGBA output texture OR NV12 copy texture (when using plane SRVs)
 ID3D11Texture2D* g_captureNv12Tex{}; // NV12 copy texture used for VP conversion
 ID3D11Texture2D* g_captureRgbTex{};  // BGRA output of VP conversion
-winrt::com_ptr<ID3D11Texture2D> g_latestFrameTex;
 UINT g_captureW{};
 UINT g_captureH{};
 
+// Latest WGC frame, handed from FrameArrived (thread pool) to the render thread without a
+// lock so a slow callback can't stall a frame.
+struct WgcFrame {
+    winrt::com_ptr<ID3D11Texture2D> tex;
+    UINT width{};
+    UINT height{};
+    DXGI_FORMAT format{};
+    long long arrivedQpc{};
+    uint64_t sequence{};
+};
+rj::TripleBuffer<WgcFrame> g_wgcFrames;
+// FrameArrived callbacks running right now, and whether new ones may still run; both under
+// g_wgcCallbackLock. StopWgcCapture waits for the count to drain before the frame pool is
+// closed and the triple buffer is reset.
+SRWLOCK g_wgcCallbackLock = SRWLOCK_INIT;
+CONDITION_VARIABLE g_wgcCallbacksDrained = CONDITION_VARIABLE_INIT;
+int g_wgcCallbacksInFlight = 0;
+bool g_wgcStopping = false;
+
 winrt::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice g_winrtD3DDevice{nullptr};
 winrt::Windows::Graphics::Capture::GraphicsCaptureItem g_captureItem{nullptr};
 winrt::Windows::Graphics::Capture::Direct3D11CaptureFramePool g_framePool{nullptr};
@@ -140,8 +194,6 @@ std::atomic<uint32_t> g_captureOwnedFormat{0};
 std::atomic<bool> g_captureIsNv12{false};
 std::atomic<bool> g_captureUsingVp{false};
 
-ID3D11Texture2D* g_debugReadback1x1{};
-
 // Desktop Duplication path.
 //
 // When running in "3 monitor mode" we use Desktop Duplication on each physical monitor and
@@ -151,27 +203,261 @@ IDXGIOutputDuplication* g_ddDup[3]{};
 std::atomic<bool> g_useDesktopDuplication{false};
 std::atomic<bool> g_ddSingleWideMode{false};
 std::atomic<uint64_t> g_ddFrameCounter{0};
-uint32_t g_pxA = 0;
+MonitorDesc g_ddWideMon{};
+bool g_haveDdWideMon = false;
+
+// IDD frame channel path.
+//
+// When the IDD driver publishes the wide virtual display through the frame channel
+// (core/frame_channel.h), RenderFrame() samples the driver's shared slot textures directly
+// and Desktop Duplication is not started. The render thread holds the keyed mutexes of the
+// slot it samples until it moves to the next one.
+//
+// With driver-side slicing (Ctrl+Alt+I) each slot is one texture per output instead, which
+// the driver filled with that output's column (PlanSlices), and each output copies its own
+// straight into the backbuffer.
+struct IddSurface {
+    ID3D11Texture2D* tex{};
+    ID3D11ShaderResourceView* srv{};
+    IDXGIKeyedMutex* mutex{};
+};
+struct IddSlot {
+    IddSurface surfaces[rj::kMaxSliceOutputs];
+};
+constexpr int64_t kIddHeartbeatTimeoutNs = rj::kNsPerSec;
+// Where the IDD driver reads its mode config (see core/virtual_display.h).
+constexpr wchar_t kVirtualDisplayRegKey[] = L"SOFTWARE\\RjSpan\\VirtualDisplay";
+constexpr wchar_t kVirtualDisplayRegValue[] = L"Config";
+rj::SharedMemory g_iddMemory;
+rj::FrameChannelConsumer g_iddChannel;
+IddSlot g_iddSlots[rj::kFrameChannelSlots];
+uint32_t g_iddSurfaceGen = 0;     // generation the slot textures were opened for, 0 = none
+uint32_t g_iddSurfaceSlices = 0;  // per-output surfaces per slot in that generation, 0 = one wide
+int g_iddHeldSlot = -1;           // slot whose keyed mutexes the render thread holds
+std::atomic<bool> g_iddSlicing{false};
+std::atomic<bool> g_useIddChannel{false};
+MonitorDesc g_iddWideMon{};
+
+// Acquisition runs on its own thread: it blocks in AcquireNextFrame, copies the frame into
+// one of the ring slots below and queues it. RenderFrame() samples the newest slot, so
+// frame N+1 is acquired and copied while frame N is presented. The immediate context is
+// shared between both threads (multithread protection is enabled in InitD3D()).
+struct DdSlot {
+    ID3D11Texture2D* tex{};
+    ID3D11ShaderResourceView* srv{};
+    UINT width{};
+    UINT height{};
+    long long readyQpc{};
+};
+rj::SteadyClock g_ddClock;
+rj::CaptureThread g_ddThread(g_ddClock);
+std::vector<DdSlot> g_ddSlots;  // sized before the thread starts; textures owned by the thread
+
+// Zero-copy single_wide (Ctrl+Alt+Z): the capture thread keeps the acquired duplication frame
+// and the render thread samples it in place instead of a slot copy; rj::HeldFrameTracker
+// decides when it is released. A frame no output drew before its deadline is copied into a
+// slot as before. Off by default; needs a duplication texture that can be bound as a shader
+// resource.
+struct DdHeldFrame {
+    ID3D11Texture2D* tex{};  // referenced; `srv` was created for it
+    ID3D11ShaderResourceView* srv{};
+    UINT width{};
+    UINT height{};
+    DXGI_FORMAT format{};
+    long long readyQpc{};
+    uint64_t damageSeq{};  // see g_outputDamage
+};
+std::atomic<bool> g_ddZeroCopy{false};
+std::atomic<int64_t> g_ddHoldPeriodNs{rj::kNsPerSec / 60};
+rj::HeldFrameTracker g_ddHeld;
+DdHeldFrame g_ddHeldFrame;     // capture thread writes it before Publish(); render reads it while sampling
+uint64_t g_ddHeldFrameId = 0;  // capture thread
+uint64_t g_ddLastHeldFrameId = 0;   // render thread: last held frame counted as a new frame
+bool g_ddShowingHeldFrame = false;  // render thread: the newest content was sampled in place, not copied
+uint64_t g_ddSampledDamageSeq = 0;  // render thread: damage sequence of the DD content being sampled
+
+// Capture-thread state for triple_composite: only the regions DD reports as changed are
+// copied, per tile, into each slot (see rj::DamageRing).
+rj::DamageRing g_ddTileDamage[3];
+UINT g_ddTileW = 0;
+UINT g_ddTileH = 0;
+std::atomic<uint64_t> g_ddCopiedPixels{0};
+std::atomic<uint64_t> g_ddSurfacePixels{0};
+
+// triple_composite acquires each duplication on its own worker (rj::TileAcquireGroup), so one
+// slow monitor no longer delays the others; the capture thread composites whatever the
+// coherence policy publishes. Worker m fills g_ddTileFrames[m] and leaves it alone until
+// the capture thread recycles the tile.
+struct DdTileFrame {
+    DXGI_OUTDUPL_FRAME_INFO info{};
+    IDXGIResource* res{};
+    ID3D11Texture2D* tex{};
+};
+DdTileFrame g_ddTileFrames[3];
+rj::TileAcquireGroup g_ddTiles(g_ddClock);
+
+// Per-output partial update: the capture thread maps each DD frame's dirty and move rects
+// onto the output columns and stamps the frame with its damage sequence; RenderFrame only
+// redraws and presents the outputs whose column changed. WGC and IDD report no damage, so
+// every output redraws there.
+rj::OutputDamageTracker g_outputDamage;
+rj::SlicePlanConfig g_ddDamageSlices;   // set before the thread starts
+uint64_t g_ddDamageSeq = 0;             // capture thread
+bool g_ddFrameDamageWhole = false;      // capture thread: damage of the frame being filled,
+std::vector<rj::Rect> g_ddFrameDamage;  // in wide-frame coordinates
+
+// GPU side of a rj::ReadbackQueue: one staging texture per slot, filled from the source set
+// before each request either by a plain copy or, downsampled, by a box-filter draw into a
+// scratch render target. Render thread, between passes: the output draws rebind their own
+// render target, viewport and view. The downsample draw's SRV on the source is created once
+// and kept (holding a reference) until the source changes or Release().
+class D3dReadbackDevice final : public rj::IReadbackDevice {
+public:
+    void SetSource(ID3D11Texture2D* src);
+
+    bool Copy(uint32_t slot, const rj::ReadbackPlan& plan) override;
+    rj::ReadbackMapResult Map(uint32_t slot, bool wait, rj::ReadbackMapping& out) override;
+    void Unmap(uint32_t slot) override;
+
+    // Frees the textures; Reset() the queue first.
+    void Release();
+
+private:
+    struct Staging {
+        ID3D11Texture2D* tex{};
+        UINT width{};
+        UINT height{};
+    };
+
+    ID3D11Texture2D* m_src{};
+    ID3D11ShaderResourceView* m_srcSrv{};
+    std::vector<Staging> m_staging;
+    ID3D11Texture2D* m_scratch{};
+    ID3D11RenderTargetView* m_scratchRtv{};
+    UINT m_scratchW{};
+    UINT m_scratchH{};
+};
+
+// Content probe: each new frame the render thread samples is read back downsampled
+// kProbeDownsample times through its own readback ring (a 7680x1440 frame is 480x90), so
+// looking at content costs the frame a copy and a draw, never a wait. The newest result is
+// summarised in g_px*.
+constexpr uint32_t kProbeDownsample = 16;
+D3dReadbackDevice g_probeReadbackDevice;
+rj::ReadbackQueue g_probeReadbacks(g_probeReadbackDevice, rj::ReadbackConfig{3, 2});  // render thread
+uint64_t g_probeSequence = 0;
+
+uint32_t g_pxA = 0;  // first and centre pixel of the newest probe
 uint32_t g_pxB = 0;
-int g_pxUniqueCount = 0;
+int g_pxUniqueCount = 0;  // distinct colours among g_pxSampleCount of its pixels
 int g_pxSampleCount = 0;
 
+// WGC can hand out solid or tinted placeholder frames instead of the desktop (protected
+// content, a session it cannot see). Every probe is classified; once enough placeholders
+// arrive in a row the render thread switches capture to Desktop Duplication.
+rj::PlaceholderDetector g_placeholder;  // render thread
+uint64_t g_placeholderProbes = 0;       // probes classified as placeholders this stats window
+
+// Capture backend auto-selection. With a wide display and no IDD frame channel,
+// StartTakeover() runs Desktop Duplication and WGC of that display for a short window each
+// and keeps the cheaper one. The choice is remembered per display topology in
+// kBackendCachePath, so a known setup starts on it directly.
+constexpr char kBackendCachePath[] = "rj_span_backends.txt";
+rj::BackendProbe g_backendProbe;  // render thread
+rj::BackendChoiceCache g_backendCache;
+std::string g_topologyKey;  // of the running takeover
+MonitorDesc g_wideMon{};    // the display the probed backends capture
+// Copies of captured frames into sampled textures (DD capture thread, WGC on the render
+// thread) and their CPU time, for the probe.
+std::atomic<uint64_t> g_captureCopies{0};
+std::atomic<int64_t> g_captureCopyNs{0};
+
 std::atomic<float> g_dbgFlipX{0.0f};
 std::atomic<float> g_dbgFlipY{0.0f};
 
 std::atomic<long long> g_lastCopyQpc{0};
 long long g_qpcFreq = 0;
 
-// Latency display smoothing: show worst latency once per second (max over last 1s window).
-static long long g_latencyWindowStartQpc = 0;
-static float g_latencyWindowMaxMs = -1.0f;
-static float g_latencyPublishedMs = -1.0f;
-static long long g_latencyLastSeenCopyQpc = 0;
+// Always-on per-frame event ring (render thread, DD capture thread and tile workers).
+// Ctrl+Alt+D dumps it to the working directory; rj_trace converts the dump to Chrome trace
+// JSON.
+rj::TraceRing g_trace;
+
+// Late-latch scheduling (Ctrl+Alt+L): after the frame-latency wait, sleep until just before
+// the predicted next vblank of output 0 and only then take the newest capture. The
+// waitable firing is the vblank observation. Off by default; render thread only.
+bool g_lateLatchEnabled = false;
+
+// Passes without new content skip their draw and present (Ctrl+Alt+P, on by default); a
+// static desktop still presents once a second. Render thread.
+rj::PresentPolicy g_presentPolicy;
+
+// Capture recording (Ctrl+Alt+R): the DD capture thread records every frame it publishes to
+// rj_span_capture_<local time>_NNNN.rjr. DD frames are GPU textures, so only timing, damage
+// and frame info are kept; rj_bench pipeline --replay plays a session back headless.
+std::atomic<bool> g_recordWanted{false};  // UI thread sets, capture thread follows
+rj::CaptureRecorder g_recorder([] {
+    rj::RecorderConfig cfg;
+    cfg.segmentBytes = 64ull << 20;
+    cfg.pixels = false;
+    return cfg;
+}());
+
+// Instant replay (Ctrl+Alt+K arms it, off by default; Ctrl+Alt+W saves): the render thread
+// reads back what it samples, at most kReplayReadbackHz frames a second, into a ring keeping
+// the last 30 s in 1 GiB of RAM plus a 2 GiB spill file. Saves go to
+// rj_span_replay_<local time>_0000.rjr. A readback is only mapped once the GPU is done with
+// it and only lent to the ring once it is idle, so the render thread never waits on either.
+constexpr int64_t kReplayReadbackHz = 30;
+D3dReadbackDevice g_replayReadbackDevice;
+rj::ReadbackQueue g_replayReadbacks(g_replayReadbackDevice, rj::ReadbackConfig{3, 2});  // render thread
+std::deque<std::pair<uint64_t, int64_t>> g_replayCaptureNs;  // request id, capture time
+uint64_t g_replayLentId = 0;  // the readback g_replayRing is coding from
+uint64_t g_replayFedSequence = 0;
+int64_t g_replayNextNs = 0;
+rj::InstantReplayRing g_replayRing([] {
+    rj::InstantReplayConfig cfg;
+    cfg.windowNs = 30 * rj::kNsPerSec;
+    cfg.memoryBytes = 1ull << 30;
+    cfg.spillBytes = 2ull << 30;
+    cfg.spillPath = "rj_span_replay.spill";
+    cfg.keyframeInterval = static_cast<uint32_t>(kReplayReadbackHz);
+    cfg.codec.threads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 8u);
+    return cfg;
+}());
+rj::LateLatchScheduler g_lateLatch(rj::kNsPerSec / 60);
+int64_t g_outputPeriodNs = rj::kNsPerSec / 60;
+HANDLE g_latchTimer = nullptr;
+
+// Outputs whose region of the capture maps 1:1 onto their backbuffer are presented with
+// CopySubresourceRegion instead of the slicing shader (rj::PlanOutputBlit). Ctrl+Alt+B
+// turns it off to compare against the shader path.
+std::atomic<bool> g_blitFastPath{true};
+// WGC frame last copied into g_captureTex; the copy is only made when an output draws.
+uint64_t g_captureTexSequence = 0;
+
+// GPU time of the per-output copies and draws, from timestamp queries read back a few frames
+// later so the render thread never waits for them.
+struct GpuTimerFrame {
+    ID3D11Query* disjoint{};
+    ID3D11Query* begin{};
+    ID3D11Query* end{};
+    bool pending{};
+};
+constexpr size_t kGpuTimerFrames = 4;
+GpuTimerFrame g_gpuTimer[kGpuTimerFrames];
+size_t g_gpuTimerNext = 0;
+double g_gpuSumMs = 0.0;
+double g_gpuMaxMs = 0.0;
+uint64_t g_gpuFrames = 0;
 
 bool g_consoleReady{false};
 
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 void StopTakeover();
+static void ReleaseDdSlots();
+static void ReleaseReplayReadback();
+static void ReleaseProbeReadback();
 
 static void ToggleTestPattern() {
     const bool newVal = !g_useTestPattern.load(std::memory_order_relaxed);
@@ -182,12 +468,114 @@ static void ToggleTestPattern() {
         g_expectedWideH = 1440;
         g_expectedHz = 120;
     }
+    g_presentPolicy.Force();
     if (g_consoleReady) {
         printf("[rj_span] TestPattern=%d\n", newVal ? 1 : 0);
         fflush(stdout);
     }
 }
 
+static void ToggleLateLatch() {
+    g_lateLatchEnabled = !g_lateLatchEnabled;
+    g_lateLatch.Reset(g_outputPeriodNs);
+    if (g_consoleReady) {
+        printf("[rj_span] LateLatch=%d period(uS)=%.1f\n", g_lateLatchEnabled ? 1 : 0, rj::NsToUs(g_outputPeriodNs));
+        fflush(stdout);
+    }
+}
+
+static void ToggleIddSlices() {
+    const bool newVal = !g_iddSlicing.load(std::memory_order_relaxed);
+    g_iddSlicing.store(newVal, std::memory_order_relaxed);
+    if (g_consoleReady) {
+        printf("[rj_span] IddSlices=%d\n", newVal ? 1 : 0);
+        fflush(stdout);
+    }
+}
+
+static void ToggleDdZeroCopy() {
+    const bool newVal = !g_ddZeroCopy.load(std::memory_order_relaxed);
+    g_ddZeroCopy.store(newVal, std::memory_order_relaxed);
+    if (g_consoleReady) {
+        printf("[rj_span] DdZeroCopy=%d (single_wide only)\n", newVal ? 1 : 0);
+        fflush(stdout);
+    }
+}
+
+// Takes effect on the DD capture thread's next pass; WGC and IDD capture are not recorded.
+static void ToggleRecording() {
+    const bool newVal = !g_recordWanted.load(std::memory_order_relaxed);
+    g_recordWanted.store(newVal, std::memory_order_relaxed);
+    if (g_consoleReady) {
+        printf("[rj_span] Record=%d (DD capture only)\n", newVal ? 1 : 0);
+        fflush(stdout);
+    }
+}
+
+static void ToggleReplayRing() {
+    if (g_replayRing.Running()) {
+        g_replayRing.Stop();
+        if (g_consoleReady) {
+            printf("[rj_span] InstantReplay=0\n");
+            fflush(stdout);
+        }
+        return;
+    }
+    const bool ok = g_replayRing.Start();
+    if (g_consoleReady) {
+        const rj::InstantReplayConfig& cfg = g_replayRing.Config();
+        if (ok) {
+            printf("[rj_span] InstantReplay=1 last %.0f s at up to %lld fps, %llu MiB RAM + %llu MiB in %s; Ctrl+Alt+W saves\n",
+                   rj::NsToMs(cfg.windowNs) / 1000.0, static_cast<long long>(kReplayReadbackHz), static_cast<unsigned long long>(cfg.memoryBytes >> 20),
+                   static_cast<unsigned long long>(cfg.spillBytes >> 20), cfg.spillPath.c_str());
+        } else {
+            printf("[rj_span] InstantReplay: can't allocate the ring or create %s\n", cfg.spillPath.c_str());
+        }
+        fflush(stdout);
+    }
+}
+
+// The ring writes the file on its worker thread; the render thread prints the outcome.
+static void SaveReplay() {
+    if (!g_replayRing.Running()) {
+        if (g_consoleReady) {
+            printf("[rj_span] InstantReplay is off (Ctrl+Alt+K)\n");
+            fflush(stdout);
+        }
+        return;
+    }
+    SYSTEMTIME st{};
+    GetLocalTime(&st);
+    char base[MAX_PATH];
+    snprintf(base, sizeof(base), "rj_span_replay_%04u%02u%02u_%02u%02u%02u",
+             st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond);
+    const bool queued = g_replayRing.Save(base);
+    if (g_consoleReady) {
+        if (queued) printf("[rj_span] InstantReplay: saving -> %s\n", rj::RecordingSegmentPath(base, 0).c_str());
+        else printf("[rj_span] InstantReplay: a save is still running\n");
+        fflush(stdout);
+    }
+}
+
+static void TogglePresentOnChange() {
+    rj::PresentPolicyConfig cfg = g_presentPolicy.Config();
+    cfg.onNewContent = !cfg.onNewContent;
+    g_presentPolicy.SetConfig(cfg);
+    if (g_consoleReady) {
+        printf("[rj_span] PresentOnChange=%d keepalive(ms)=%.0f\n", cfg.onNewContent ? 1 : 0, rj::NsToMs(cfg.keepAliveNs));
+        fflush(stdout);
+    }
+}
+
+static void ToggleBlitFastPath() {
+    const bool newVal = !g_blitFastPath.load(std::memory_order_relaxed);
+    g_blitFastPath.store(newVal, std::memory_order_relaxed);
+    if (g_consoleReady) {
+        printf("[rj_span] BlitFastPath=%d\n", newVal ? 1 : 0);
+        fflush(stdout);
+    }
+}
+
 bool CheckHr(const HRESULT hr, const wchar_t* what) {
     if (SUCCEEDED(hr)) return true;
     wchar_t buf[512];
@@ -204,68 +592,57 @@ static void EnsureQpcInit() {
     }
 }
 
-static void MarkCopyTimestampQpc() {
-    EnsureQpcInit();
-    LARGE_INTEGER t{};
-    if (QueryPerformanceCounter(&t)) {
-        g_lastCopyQpc.store(t.QuadPart, std::memory_order_relaxed);
-    }
+static int64_t QpcToNs(long long qpc) {
+    if (g_qpcFreq <= 0) return 0;
+    return (qpc / g_qpcFreq) * rj::kNsPerSec + (qpc % g_qpcFreq) * rj::kNsPerSec / g_qpcFreq;
 }
 
-static double GetLatencyMsSinceLastCopy() {
-    EnsureQpcInit();
-    if (g_qpcFreq <= 0) return -1.0;
-    const long long copied = g_lastCopyQpc.load(std::memory_order_relaxed);
-    if (copied <= 0) return -1.0;
-    LARGE_INTEGER now{};
-    if (!QueryPerformanceCounter(&now)) return -1.0;
-    const long long dt = now.QuadPart - copied;
-    return (static_cast<double>(dt) * 1000.0) / static_cast<double>(g_qpcFreq);
+static long long NsToQpc(int64_t ns) {
+    return (ns / rj::kNsPerSec) * g_qpcFreq + (ns % rj::kNsPerSec) * g_qpcFreq / rj::kNsPerSec;
 }
 
-static float GetLatencyUsSinceLastCopyF() {
-    const double ms = GetLatencyMsSinceLastCopy();
-    if (ms < 0.0) return -1.0f;
-    const double us = ms * 1000.0;
-    if (us > 9999.0) return 9999.0f;
-    return static_cast<float>(us);
+// Timestamp for g_trace. EnsureQpcInit() has run before any thread records.
+static int64_t TraceNowNs() {
+    LARGE_INTEGER t{};
+    (void)QueryPerformanceCounter(&t);
+    return QpcToNs(t.QuadPart);
 }
 
-static float GetLatencyWorstOverLastSecondMs() {
-    EnsureQpcInit();
-    if (g_qpcFreq <= 0) return -1.0f;
-
-    LARGE_INTEGER now{};
-    if (!QueryPerformanceCounter(&now)) return g_latencyPublishedMs;
-
-    if (g_latencyWindowStartQpc == 0) {
-        g_latencyWindowStartQpc = now.QuadPart;
-        g_latencyWindowMaxMs = -1.0f;
-        g_latencyPublishedMs = -1.0f;
-    }
-
-    // Freeze-on-idle: only incorporate samples when a new frame was actually copied.
-    const long long copiedQpc = g_lastCopyQpc.load(std::memory_order_relaxed);
-    const bool newFrameCopied = (copiedQpc > 0 && copiedQpc != g_latencyLastSeenCopyQpc);
-    float cur = -1.0f;
-    if (newFrameCopied) {
-        g_latencyLastSeenCopyQpc = copiedQpc;
-        cur = GetLatencyUsSinceLastCopyF();
-        if (cur >= 0.0f) {
-            if (g_latencyWindowMaxMs < 0.0f || cur > g_latencyWindowMaxMs) g_latencyWindowMaxMs = cur;
+// Sleeps until `deadlineNs` (TraceNowNs() time base). A high-resolution waitable timer
+// covers most of the wait, the last stretch is spun, so the late-latch margin does not have
+// to absorb the 1-2 ms granularity of Sleep().
+static void SleepUntilNs(int64_t deadlineNs) {
+    constexpr int64_t kSpinNs = 200 * rj::kNsPerUs;
+    const int64_t now = TraceNowNs();
+    if (deadlineNs - now > kSpinNs) {
+        if (!g_latchTimer) {
+            g_latchTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        }
+        LARGE_INTEGER due{};
+        due.QuadPart = -((deadlineNs - now - kSpinNs) / 100);  // relative, 100 ns units
+        if (g_latchTimer && SetWaitableTimer(g_latchTimer, &due, 0, nullptr, nullptr, FALSE)) {
+            (void)WaitForSingleObject(g_latchTimer, INFINITE);
+        } else {
+            Sleep(static_cast<DWORD>((deadlineNs - now - kSpinNs) / rj::kNsPerMs));
         }
     }
+    while (TraceNowNs() < deadlineNs) YieldProcessor();
+}
 
-    const long long elapsed = now.QuadPart - g_latencyWindowStartQpc;
-    if (elapsed >= g_qpcFreq) {
-        g_latencyPublishedMs = g_latencyWindowMaxMs;
-        g_latencyWindowStartQpc = now.QuadPart;
-        // Start the next window with the most recent sample if we got one; otherwise keep it empty.
-        g_latencyWindowMaxMs = (cur >= 0.0f) ? cur : -1.0f;
+static void MarkCopyTimestampQpc() {
+    EnsureQpcInit();
+    LARGE_INTEGER t{};
+    if (QueryPerformanceCounter(&t)) {
+        g_lastCopyQpc.store(t.QuadPart, std::memory_order_relaxed);
     }
-    return g_latencyPublishedMs;
 }
 
+static void CountCaptureCopy(int64_t ns) {
+    g_captureCopies.fetch_add(1, std::memory_order_relaxed);
+    g_captureCopyNs.fetch_add(ns, std::memory_order_relaxed);
+}
+
+
 static const char* DxgiFormatName(uint32_t fmt) {
     switch (static_cast<DXGI_FORMAT>(fmt)) {
         case DXGI_FORMAT_UNKNOWN:
@@ -348,6 +725,63 @@ static bool TryDeriveExpectedTripleWideModeFromMonitors(const MonitorDesc mons[3
     return true;
 }
 
+// Refresh rates a monitor offers at w x h, from its full mode list.
+static std::vector<uint32_t> GetMonitorRates(HMONITOR mon, UINT w, UINT h) {
+    std::vector<uint32_t> rates;
+    MONITORINFOEXW mi{};
+    mi.cbSize = sizeof(mi);
+    if (!GetMonitorInfoW(mon, &mi)) return rates;
+    DEVMODEW dm{};
+    dm.dmSize = sizeof(dm);
+    for (DWORD i = 0; EnumDisplaySettingsExW(mi.szDevice, i, &dm, 0); i++) {
+        if (dm.dmPelsWidth != w || dm.dmPelsHeight != h || dm.dmDisplayFrequency <= 1) continue;
+        if (std::find(rates.begin(), rates.end(), dm.dmDisplayFrequency) == rates.end()) rates.push_back(dm.dmDisplayFrequency);
+    }
+    return rates;
+}
+
+// Derives the IDD virtual display config (panel size, common refresh rates) from the physical
+// outputs and stores it where the driver reads it. Writing HKLM needs an elevated rj_span; the
+// driver picks the new modes up after the virtual display device restarts.
+static void PublishVirtualDisplayConfig(const MonitorDesc mons[3]) {
+    std::vector<rj::PanelModes> panels;
+    for (int i = 0; i < 3; i++) {
+        rj::PanelModes p;
+        UINT w = 0, h = 0, hz = 0;
+        if (!TryGetMonitorCurrentMode(mons[i].handle, w, h, hz)) return;
+        p.width = w;
+        p.height = h;
+        p.currentHz = hz;
+        p.ratesHz = GetMonitorRates(mons[i].handle, w, h);
+        panels.push_back(std::move(p));
+    }
+    rj::VirtualDisplayConfig cfg;
+    if (!rj::DeriveVirtualDisplayConfig(panels, cfg)) return;
+    const std::string text = rj::FormatVirtualDisplayConfig(cfg);
+    const std::wstring wide(text.begin(), text.end());
+
+    wchar_t current[128] = {};
+    DWORD size = sizeof(current);
+    if (RegGetValueW(HKEY_LOCAL_MACHINE, kVirtualDisplayRegKey, kVirtualDisplayRegValue, RRF_RT_REG_SZ, nullptr, current, &size) == ERROR_SUCCESS &&
+        wide == current) {
+        return;
+    }
+    const LSTATUS st = RegSetKeyValueW(HKEY_LOCAL_MACHINE,
+                                       kVirtualDisplayRegKey,
+                                       kVirtualDisplayRegValue,
+                                       REG_SZ,
+                                       wide.c_str(),
+                                       static_cast<DWORD>((wide.size() + 1) * sizeof(wchar_t)));
+    if (g_consoleReady) {
+        if (st == ERROR_SUCCESS) {
+            printf("[rj_span] IDD virtual display config now %s; restart the virtual display device to apply\n", text.c_str());
+        } else {
+            printf("[rj_span] WARNING: could not store IDD virtual display config %s (error %ld); run elevated once to update it\n", text.c_str(), static_cast<long>(st));
+        }
+        fflush(stdout);
+    }
+}
+
 void SafeRelease(IUnknown*& p) {
     if (p) {
         p->Release();
@@ -355,6 +789,65 @@ void SafeRelease(IUnknown*& p) {
     }
 }
 
+void ReleaseGpuTimer() {
+    for (GpuTimerFrame& f : g_gpuTimer) {
+        IUnknown* q = f.disjoint;
+        SafeRelease(q);
+        q = f.begin;
+        SafeRelease(q);
+        q = f.end;
+        SafeRelease(q);
+        f = GpuTimerFrame{};
+    }
+    g_gpuTimerNext = 0;
+}
+
+// Reads every finished frame's timestamps. Frames the GPU hasn't reached yet stay pending;
+// a frame slot that is still pending when its turn comes again is skipped.
+void CollectGpuTimer() {
+    for (GpuTimerFrame& f : g_gpuTimer) {
+        if (!f.pending) continue;
+        D3D11_QUERY_DATA_TIMESTAMP_DISJOINT dj{};
+        if (g_d3d.ctx->GetData(f.disjoint, &dj, sizeof(dj), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) continue;
+        UINT64 t0 = 0;
+        UINT64 t1 = 0;
+        if (g_d3d.ctx->GetData(f.begin, &t0, sizeof(t0), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+            g_d3d.ctx->GetData(f.end, &t1, sizeof(t1), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) {
+            continue;
+        }
+        f.pending = false;
+        if (dj.Disjoint || dj.Frequency == 0 || t1 < t0) continue;
+        const double ms = static_cast<double>(t1 - t0) * 1000.0 / static_cast<double>(dj.Frequency);
+        g_gpuSumMs += ms;
+        g_gpuMaxMs = (std::max)(g_gpuMaxMs, ms);
+        g_gpuFrames++;
+    }
+}
+
+// Returns the frame to End, or nullptr when timing is unavailable this frame.
+GpuTimerFrame* BeginGpuTimer() {
+    GpuTimerFrame& f = g_gpuTimer[g_gpuTimerNext];
+    if (!f.disjoint) {
+        D3D11_QUERY_DESC qd{};
+        qd.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+        if (FAILED(g_d3d.device->CreateQuery(&qd, &f.disjoint))) return nullptr;
+        qd.Query = D3D11_QUERY_TIMESTAMP;
+        if (FAILED(g_d3d.device->CreateQuery(&qd, &f.begin)) || FAILED(g_d3d.device->CreateQuery(&qd, &f.end))) return nullptr;
+    }
+    if (f.pending) return nullptr;
+    g_gpuTimerNext = (g_gpuTimerNext + 1) % kGpuTimerFrames;
+    g_d3d.ctx->Begin(f.disjoint);
+    g_d3d.ctx->End(f.begin);
+    return &f;
+}
+
+void EndGpuTimer(GpuTimerFrame* f) {
+    if (!f) return;
+    g_d3d.ctx->End(f->end);
+    g_d3d.ctx->End(f->disjoint);
+    f->pending = true;
+}
+
 void ReleaseOutputResources(OutputWindow& ow) {
     IUnknown* rtv = ow.rtv;
     SafeRelease(rtv);
@@ -381,6 +874,7 @@ void DestroyD3D() {
     for (auto& ow : g_outputs) {
         ReleaseOutputResources(ow);
     }
+    ReleaseGpuTimer();
     IUnknown* cb = g_d3d.cb;
     SafeRelease(cb);
     g_d3d.cb = nullptr;
@@ -402,6 +896,12 @@ void DestroyD3D() {
     IUnknown* ps = g_d3d.ps;
     SafeRelease(ps);
     g_d3d.ps = nullptr;
+    IUnknown* downsamplePs = g_d3d.downsamplePs;
+    SafeRelease(downsamplePs);
+    g_d3d.downsamplePs = nullptr;
+    IUnknown* downsampleCb = g_d3d.downsampleCb;
+    SafeRelease(downsampleCb);
+    g_d3d.downsampleCb = nullptr;
     IUnknown* vs = g_d3d.vs;
     SafeRelease(vs);
     g_d3d.vs = nullptr;
@@ -410,9 +910,13 @@ void DestroyD3D() {
     SafeRelease(factory);
     g_d3d.factory = nullptr;
 
-    IUnknown* rb = g_debugReadback1x1;
-    SafeRelease(rb);
-    g_debugReadback1x1 = nullptr;
+    g_ddThread.Stop();
+    g_ddTiles.Stop();
+    g_recorder.Stop();
+    ReleaseDdSlots();
+
+    ReleaseReplayReadback();
+    ReleaseProbeReadback();
 
     for (auto& dd : g_ddDup) {
         IUnknown* p = dd;
@@ -421,18 +925,681 @@ void DestroyD3D() {
     }
     g_useDesktopDuplication.store(false, std::memory_order_relaxed);
 
-    IUnknown* ctx = g_d3d.ctx;
-    SafeRelease(ctx);
-    g_d3d.ctx = nullptr;
+    IUnknown* ctx = g_d3d.ctx;
+    SafeRelease(ctx);
+    g_d3d.ctx = nullptr;
+
+    IUnknown* dev = g_d3d.device;
+    SafeRelease(dev);
+    g_d3d.device = nullptr;
+}
+
+static void ReleaseDdHeldView() {
+    IUnknown* srv = g_ddHeldFrame.srv;
+    SafeRelease(srv);
+    IUnknown* tex = g_ddHeldFrame.tex;
+    SafeRelease(tex);
+    g_ddHeldFrame = DdHeldFrame{};
+}
+
+static void ReleaseDdSlots() {
+    for (auto& slot : g_ddSlots) {
+        IUnknown* srv = slot.srv;
+        SafeRelease(srv);
+        IUnknown* tex = slot.tex;
+        SafeRelease(tex);
+        slot = DdSlot{};
+    }
+    ReleaseDdHeldView();
+}
+
+// Capture thread. (Re)creates the slot texture when the capture size changes.
+static bool EnsureDdSlot(uint32_t index, UINT w, UINT h) {
+    DdSlot& slot = g_ddSlots[index];
+    if (slot.tex && slot.srv && slot.width == w && slot.height == h) return true;
+
+    IUnknown* oldSrv = slot.srv;
+    SafeRelease(oldSrv);
+    IUnknown* oldTex = slot.tex;
+    SafeRelease(oldTex);
+    slot = DdSlot{};
+
+    D3D11_TEXTURE2D_DESC sd{};
+    sd.Width = w;
+    sd.Height = h;
+    sd.MipLevels = 1;
+    sd.ArraySize = 1;
+    sd.SampleDesc.Count = 1;
+    sd.Usage = D3D11_USAGE_DEFAULT;
+    sd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    sd.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    if (FAILED(g_d3d.device->CreateTexture2D(&sd, nullptr, &slot.tex)) || !slot.tex) return false;
+    if (FAILED(g_d3d.device->CreateShaderResourceView(slot.tex, nullptr, &slot.srv)) || !slot.srv) {
+        IUnknown* tex = slot.tex;
+        SafeRelease(tex);
+        slot.tex = nullptr;
+        return false;
+    }
+    slot.width = w;
+    slot.height = h;
+    return true;
+}
+
+static void LogDdAcquireFailure(int m, HRESULT hr) {
+    static HRESULT s_lastDdAcquireHr[3] = {S_OK, S_OK, S_OK};
+    if (hr == s_lastDdAcquireHr[m]) return;
+    s_lastDdAcquireHr[m] = hr;
+    char buf[200];
+    snprintf(buf, sizeof(buf), "[rj_span] DD: AcquireNextFrame[%d] failed hr=0x%08X\n", m, static_cast<unsigned>(hr));
+    OutputDebugStringA(buf);
+    if (g_consoleReady) {
+        fputs(buf, stdout);
+        fflush(stdout);
+    }
+}
+
+// Capture thread: `r` (tile coordinates) of tile `m` changed in the frame being filled.
+static void DdAddTileDamage(int m, const rj::Rect& r) {
+    const int32_t x = static_cast<int32_t>(g_ddTileW) * m;
+    g_ddFrameDamage.push_back(rj::Rect{r.left + x, r.top, r.right + x, r.bottom});
+}
+
+// Capture thread, single_wide: reads what changed in the acquired frame into g_ddFrameDamage.
+static void DdReadFrameDamage(const DXGI_OUTDUPL_FRAME_INFO& info) {
+    static std::vector<uint8_t> s_metadata;
+    g_ddFrameDamage.clear();
+    // Pointer-only updates (LastPresentTime == 0) change nothing.
+    g_ddFrameDamageWhole = info.TotalMetadataBufferSize == 0 && info.LastPresentTime.QuadPart != 0;
+    if (info.TotalMetadataBufferSize == 0) return;
+    DXGI_OUTDUPL_DESC dupDesc{};
+    g_ddDup[0]->GetDesc(&dupDesc);
+    if (dupDesc.Rotation != DXGI_MODE_ROTATION_IDENTITY) {
+        g_ddFrameDamageWhole = true;
+        return;
+    }
+    if (s_metadata.size() < info.TotalMetadataBufferSize) s_metadata.resize(info.TotalMetadataBufferSize);
+    UINT moveBytes = 0;
+    UINT dirtyBytes = 0;
+    auto* moveBuf = reinterpret_cast<DXGI_OUTDUPL_MOVE_RECT*>(s_metadata.data());
+    HRESULT hr = g_ddDup[0]->GetFrameMoveRects(static_cast<UINT>(s_metadata.size()), moveBuf, &moveBytes);
+    RECT* dirtyBuf = reinterpret_cast<RECT*>(s_metadata.data() + moveBytes);
+    if (SUCCEEDED(hr)) hr = g_ddDup[0]->GetFrameDirtyRects(static_cast<UINT>(s_metadata.size()) - moveBytes, dirtyBuf, &dirtyBytes);
+    if (FAILED(hr)) {
+        g_ddFrameDamageWhole = true;
+        return;
+    }
+    for (UINT i = 0; i < moveBytes / sizeof(DXGI_OUTDUPL_MOVE_RECT); i++) {
+        const RECT& d = moveBuf[i].DestinationRect;
+        g_ddFrameDamage.push_back(rj::Rect{d.left, d.top, d.right, d.bottom});
+    }
+    for (UINT i = 0; i < dirtyBytes / sizeof(RECT); i++) {
+        g_ddFrameDamage.push_back(rj::Rect{dirtyBuf[i].left, dirtyBuf[i].top, dirtyBuf[i].right, dirtyBuf[i].bottom});
+    }
+}
+
+// Capture thread: records the outputs the frame just filled changed, before it is published.
+// Returns the frame's damage sequence.
+static uint64_t DdMarkFrameDamage(UINT wideW, UINT wideH) {
+    uint32_t mask = rj::AllOutputsMask(g_outputDamage.Outputs());
+    if (!g_ddFrameDamageWhole) {
+        mask = g_ddFrameDamage.empty()
+                   ? 0u
+                   : rj::OutputsTouched(rj::PlanSlices(wideW, wideH, g_ddDamageSlices), g_ddFrameDamage.data(), static_cast<uint32_t>(g_ddFrameDamage.size()));
+    }
+    const uint64_t seq = ++g_ddDamageSeq;
+    g_outputDamage.MarkChanged(seq, mask);
+    return seq;
+}
+
+// Capture thread: starts or stops the recording to match Ctrl+Alt+R.
+static void DdFollowRecordToggle() {
+    const bool wanted = g_recordWanted.load(std::memory_order_relaxed);
+    if (wanted == g_recorder.Recording()) return;
+    if (!wanted) {
+        g_recorder.Stop();
+        const rj::RecorderStats st = g_recorder.Stats();
+        if (g_consoleReady) {
+            printf("[rj_span] Record: %llu frames (%llu dropped) in %u segments -> %s_*.rjr%s\n",
+                   static_cast<unsigned long long>(st.frames), static_cast<unsigned long long>(st.dropped), st.segments,
+                   g_recorder.BasePath().c_str(), st.failed ? " (incomplete)" : "");
+            fflush(stdout);
+        }
+        return;
+    }
+    SYSTEMTIME st{};
+    GetLocalTime(&st);
+    char base[MAX_PATH];
+    snprintf(base, sizeof(base), "rj_span_capture_%04u%02u%02u_%02u%02u%02u",
+             st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond);
+    const bool ok = g_recorder.Start(base);
+    if (!ok) g_recordWanted.store(false, std::memory_order_relaxed);
+    if (g_consoleReady) {
+        if (ok) printf("[rj_span] Record: on -> %s_*.rjr (rj_bench pipeline --replay=%s)\n", base, base);
+        else printf("[rj_span] Record: failed to create %s\n", rj::RecordingSegmentPath(base, 0).c_str());
+        fflush(stdout);
+    }
+}
+
+// Capture thread: records the frame just published; `info` holds the DD frame info of
+// every monitor it was composed from. Call after DdMarkFrameDamage.
+static void DdRecordFrame(UINT wideW, UINT wideH, const DXGI_OUTDUPL_FRAME_INFO* info, int count, uint64_t seq) {
+    if (!g_recorder.Recording()) return;
+    LARGE_INTEGER now{};
+    (void)QueryPerformanceCounter(&now);
+    long long composedQpc = 0;
+    uint32_t accumulated = 0;
+    bool pointerOnly = count > 0;
+    for (int m = 0; m < count; m++) {
+        composedQpc = std::max(composedQpc, info[m].LastPresentTime.QuadPart);
+        accumulated = std::max(accumulated, static_cast<uint32_t>(info[m].AccumulatedFrames));
+        pointerOnly = pointerOnly && info[m].LastPresentTime.QuadPart == 0 && info[m].LastMouseUpdateTime.QuadPart != 0;
+    }
+    rj::FrameDesc f{};
+    f.width = wideW;
+    f.height = wideH;
+    f.format = rj::PixelFormat::Bgra8;
+    f.sequence = seq;
+    f.captureTimeNs = QpcToNs(composedQpc != 0 ? composedQpc : now.QuadPart);
+    f.accumulatedFrames = accumulated;
+    if (!g_ddFrameDamageWhole) {
+        f.dirtyRects = g_ddFrameDamage.data();
+        f.dirtyRectCount = static_cast<uint32_t>(g_ddFrameDamage.size());
+    }
+    g_recorder.Record(f, QpcToNs(now.QuadPart), pointerOnly ? rj::kRecordPointerOnly : 0);
+}
+
+// Capture thread, triple_composite: brings tile `m` of slot `slotIndex` up to date. `tex2d`
+// is the tile's new DD frame, or null when that monitor had nothing new.
+static void DdCompositeTile(uint32_t slotIndex, int m, ID3D11Texture2D* tex2d, const DXGI_OUTDUPL_FRAME_INFO& info) {
+    static std::vector<uint8_t> s_metadata;
+    static std::vector<rj::MoveRect> s_moves;
+    static std::vector<rj::Rect> s_dirty;
+
+    rj::DamageRing& damage = g_ddTileDamage[m];
+    const rj::SlotUpdatePlan* plan = nullptr;
+    if (!tex2d) {
+        plan = &damage.BuildIdle(slotIndex);
+    } else {
+        DXGI_OUTDUPL_DESC dupDesc{};
+        g_ddDup[m]->GetDesc(&dupDesc);
+        if (dupDesc.Rotation != DXGI_MODE_ROTATION_IDENTITY) {
+            plan = &damage.BuildFull(slotIndex);
+        } else if (info.TotalMetadataBufferSize == 0) {
+            // Pointer-only update (LastPresentTime == 0): the image did not change, but the
+            // slot may still lag behind the newest one.
+            plan = info.LastPresentTime.QuadPart == 0 ? &damage.Build(slotIndex, nullptr, 0, nullptr, 0) : &damage.BuildFull(slotIndex);
+        } else {
+            if (s_metadata.size() < info.TotalMetadataBufferSize) s_metadata.resize(info.TotalMetadataBufferSize);
+            UINT moveBytes = 0;
+            UINT dirtyBytes = 0;
+            auto* moveBuf = reinterpret_cast<DXGI_OUTDUPL_MOVE_RECT*>(s_metadata.data());
+            HRESULT hr = g_ddDup[m]->GetFrameMoveRects(static_cast<UINT>(s_metadata.size()), moveBuf, &moveBytes);
+            RECT* dirtyBuf = reinterpret_cast<RECT*>(s_metadata.data() + moveBytes);
+            if (SUCCEEDED(hr)) {
+                hr = g_ddDup[m]->GetFrameDirtyRects(static_cast<UINT>(s_metadata.size()) - moveBytes, dirtyBuf, &dirtyBytes);
+            }
+            if (FAILED(hr)) {
+                plan = &damage.BuildFull(slotIndex);
+            } else {
+                const UINT moveCount = moveBytes / sizeof(DXGI_OUTDUPL_MOVE_RECT);
+                const UINT dirtyCount = dirtyBytes / sizeof(RECT);
+                s_moves.resize(moveCount);
+                for (UINT i = 0; i < moveCount; i++) {
+                    const RECT& d = moveBuf[i].DestinationRect;
+                    s_moves[i] = rj::MoveRect{moveBuf[i].SourcePoint.x, moveBuf[i].SourcePoint.y, rj::Rect{d.left, d.top, d.right, d.bottom}};
+                }
+                s_dirty.resize(dirtyCount);
+                for (UINT i = 0; i < dirtyCount; i++) {
+                    s_dirty[i] = rj::Rect{dirtyBuf[i].left, dirtyBuf[i].top, dirtyBuf[i].right, dirtyBuf[i].bottom};
+                }
+                plan = &damage.Build(slotIndex, s_moves.data(), moveCount, s_dirty.data(), dirtyCount);
+            }
+        }
+    }
+
+    ID3D11Texture2D* dst = g_ddSlots[slotIndex].tex;
+    const UINT tileX = g_ddTileW * static_cast<UINT>(m);
+    if (plan->catchUp && plan->catchUpSlot >= 0) {
+        ID3D11Texture2D* from = g_ddSlots[static_cast<size_t>(plan->catchUpSlot)].tex;
+        if (from && plan->catchUp->fullCopy) {
+            D3D11_BOX box{tileX, 0, 0, tileX + g_ddTileW, g_ddTileH, 1};
+            g_d3d.ctx->CopySubresourceRegion(dst, 0, tileX, 0, 0, from, 0, &box);
+        } else if (from) {
+            for (const rj::Rect& r : plan->catchUp->copies) {
+                D3D11_BOX box{tileX + static_cast<UINT>(r.left), static_cast<UINT>(r.top), 0, tileX + static_cast<UINT>(r.right), static_cast<UINT>(r.bottom), 1};
+                g_d3d.ctx->CopySubresourceRegion(dst, 0, tileX + static_cast<UINT>(r.left), static_cast<UINT>(r.top), 0, from, 0, &box);
+            }
+        }
+    }
+    // Catch-up only replays changes of frames already published; the new ones are damage.
+    if (tex2d && plan->fullCopy) {
+        D3D11_BOX box{0, 0, 0, g_ddTileW, g_ddTileH, 1};
+        g_d3d.ctx->CopySubresourceRegion(dst, 0, tileX, 0, 0, tex2d, 0, &box);
+        DdAddTileDamage(m, rj::Rect{0, 0, static_cast<int32_t>(g_ddTileW), static_cast<int32_t>(g_ddTileH)});
+    } else if (tex2d && plan->fromSource) {
+        for (const rj::BlitOp& op : plan->fromSource->moves) {
+            D3D11_BOX box{tileX + static_cast<UINT>(op.src.left), static_cast<UINT>(op.src.top), 0,
+                          tileX + static_cast<UINT>(op.src.right), static_cast<UINT>(op.src.bottom), 1};
+            g_d3d.ctx->CopySubresourceRegion(dst, 0, tileX + static_cast<UINT>(op.dstX), static_cast<UINT>(op.dstY), 0, dst, 0, &box);
+            DdAddTileDamage(m, rj::Rect{op.dstX, op.dstY, op.dstX + op.src.Width(), op.dstY + op.src.Height()});
+        }
+        for (const rj::Rect& r : plan->fromSource->copies) {
+            D3D11_BOX box{static_cast<UINT>(r.left), static_cast<UINT>(r.top), 0, static_cast<UINT>(r.right), static_cast<UINT>(r.bottom), 1};
+            g_d3d.ctx->CopySubresourceRegion(dst, 0, tileX + static_cast<UINT>(r.left), static_cast<UINT>(r.top), 0, tex2d, 0, &box);
+            DdAddTileDamage(m, r);
+        }
+    }
+    g_ddCopiedPixels.fetch_add(plan->copiedPixels, std::memory_order_relaxed);
+    g_ddSurfacePixels.fetch_add(static_cast<uint64_t>(g_ddTileW) * g_ddTileH, std::memory_order_relaxed);
+}
+
+// Capture thread. Sizes slot `slotIndex` from the frames' textures and brings it up to date:
+// a full copy in single_wide, per-tile damage in triple_composite. `tex2d[m]` is null for
+// monitors without a new frame.
+static bool DdFillSlot(uint32_t slotIndex, int tiles, ID3D11Texture2D* const* tex2d, const DXGI_OUTDUPL_FRAME_INFO* info, rj::CapturedFrame& out) {
+    for (int m = 0; m < tiles; m++) {
+        if (!tex2d[m]) continue;
+        D3D11_TEXTURE2D_DESC td{};
+        tex2d[m]->GetDesc(&td);
+        g_captureSrcFormat.store(static_cast<uint32_t>(td.Format), std::memory_order_relaxed);
+        // Size everything from the actual duplication texture, never from window RECTs
+        // (they can be DPI-logical).
+        if (g_ddTileW != td.Width || g_ddTileH != td.Height) {
+            g_ddTileW = td.Width;
+            g_ddTileH = td.Height;
+            for (auto& d : g_ddTileDamage) d.Reset(static_cast<uint32_t>(g_ddSlots.size()), g_ddTileW, g_ddTileH);
+        }
+    }
+
+    const UINT wideW = g_ddTileW * static_cast<UINT>(tiles);
+    const UINT wideH = g_ddTileH;
+    if (wideW == 0 || !EnsureDdSlot(slotIndex, wideW, wideH)) return false;
+    const uint64_t traceFrame = g_ddThread.FramesCaptured() + 1;
+    const int64_t copyStartNs = TraceNowNs();
+    g_trace.Begin(rj::TraceEvent::Copy, traceFrame, copyStartNs, slotIndex);
+    if (tiles == 1) {
+        if (tex2d[0]) g_d3d.ctx->CopyResource(g_ddSlots[slotIndex].tex, tex2d[0]);
+    } else {
+        for (int m = 0; m < tiles; m++) DdCompositeTile(slotIndex, m, tex2d[m], info[m]);
+    }
+    const int64_t copyEndNs = TraceNowNs();
+    g_trace.End(rj::TraceEvent::Copy, traceFrame, copyEndNs, slotIndex);
+    CountCaptureCopy(copyEndNs - copyStartNs);
+    LARGE_INTEGER now{};
+    (void)QueryPerformanceCounter(&now);
+    g_ddSlots[slotIndex].readyQpc = now.QuadPart;
+
+    out.desc.width = wideW;
+    out.desc.height = wideH;
+    out.desc.format = rj::PixelFormat::Bgra8;
+    out.desc.handle = g_ddSlots[slotIndex].tex;
+    return true;
+}
+
+// Tile worker m (rj::TileAcquireGroup::AcquireFn). Keeps the frame acquired until the
+// capture thread has composited it and DdReleaseTile() runs.
+static rj::AcquireResult DdAcquireTile(uint32_t m, uint32_t timeoutMs, int64_t& captureTimeNs) {
+    static thread_local bool s_traceNamed = false;
+    if (!s_traceNamed) {
+        const char* names[3] = {"dd tile 0", "dd tile 1", "dd tile 2"};
+        g_trace.NameThread(names[m]);
+        s_traceNamed = true;
+    }
+
+    DdTileFrame& f = g_ddTileFrames[m];
+    f = DdTileFrame{};
+    const uint64_t traceFrame = g_ddThread.FramesCaptured() + 1;
+    g_trace.Begin(rj::TraceEvent::Acquire, traceFrame, TraceNowNs(), m);
+    HRESULT hr = g_ddDup[m]->AcquireNextFrame(timeoutMs, &f.info, &f.res);
+    g_trace.End(rj::TraceEvent::Acquire, traceFrame, TraceNowNs(), m);
+    if (hr == DXGI_ERROR_WAIT_TIMEOUT) return rj::AcquireResult::Timeout;
+    if (FAILED(hr)) {
+        LogDdAcquireFailure(static_cast<int>(m), hr);
+        return hr == DXGI_ERROR_ACCESS_LOST ? rj::AcquireResult::AccessLost : rj::AcquireResult::Timeout;
+    }
+    if (!f.res || FAILED(f.res->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&f.tex))) || !f.tex) {
+        if (f.res) f.res->Release();
+        f = DdTileFrame{};
+        g_ddDup[m]->ReleaseFrame();
+        return rj::AcquireResult::Timeout;
+    }
+
+    // LastPresentTime is 0 for pointer-only updates; those count as arriving now.
+    long long qpc = f.info.LastPresentTime.QuadPart;
+    if (qpc == 0) {
+        LARGE_INTEGER now{};
+        (void)QueryPerformanceCounter(&now);
+        qpc = now.QuadPart;
+    }
+    captureTimeNs = QpcToNs(qpc);
+    return rj::AcquireResult::NewFrame;
+}
+
+// Tile worker m (rj::TileAcquireGroup::ReleaseFn).
+static void DdReleaseTile(uint32_t m) {
+    DdTileFrame& f = g_ddTileFrames[m];
+    if (f.tex) f.tex->Release();
+    if (f.res) f.res->Release();
+    f = DdTileFrame{};
+    g_ddDup[m]->ReleaseFrame();
+}
+
+// Capture thread. Makes g_ddHeldFrame a view of `tex`, or returns false when the duplication
+// texture can't be bound as a shader resource.
+static bool DdEnsureHeldView(ID3D11Texture2D* tex) {
+    if (g_ddHeldFrame.tex == tex && g_ddHeldFrame.srv) return true;
+    ReleaseDdHeldView();
+    D3D11_TEXTURE2D_DESC td{};
+    tex->GetDesc(&td);
+    if (!(td.BindFlags & D3D11_BIND_SHADER_RESOURCE)) return false;
+    if (FAILED(g_d3d.device->CreateShaderResourceView(tex, nullptr, &g_ddHeldFrame.srv)) || !g_ddHeldFrame.srv) {
+        g_ddHeldFrame.srv = nullptr;
+        return false;
+    }
+    tex->AddRef();
+    g_ddHeldFrame.tex = tex;
+    g_ddHeldFrame.width = td.Width;
+    g_ddHeldFrame.height = td.Height;
+    g_ddHeldFrame.format = td.Format;
+    return true;
+}
+
+// Capture thread, zero-copy single_wide. Hands the acquired frame to the render thread and
+// holds it until every output drew it, or until one output period and a quarter after it
+// was composed: the next composition is deferred at most until shortly after it happened.
+// A frame that missed its deadline is copied into `slotIndex` first. The caller releases
+// the frame and then calls g_ddHeld.Released().
+static rj::AcquireResult DdHoldForRender(ID3D11Texture2D* tex, const DXGI_OUTDUPL_FRAME_INFO& info, uint32_t slotIndex, rj::CapturedFrame& out) {
+    LARGE_INTEGER now{};
+    (void)QueryPerformanceCounter(&now);
+    const long long composedQpc = info.LastPresentTime.QuadPart != 0 ? info.LastPresentTime.QuadPart : now.QuadPart;
+    const int64_t periodNs = g_ddHoldPeriodNs.load(std::memory_order_relaxed);
+    g_ddHeldFrame.readyQpc = now.QuadPart;
+    g_ddHeldFrame.damageSeq = DdMarkFrameDamage(g_ddHeldFrame.width, g_ddHeldFrame.height);
+    DdRecordFrame(g_ddHeldFrame.width, g_ddHeldFrame.height, &info, 1, g_ddHeldFrame.damageSeq);
+    if (!g_ddHeld.Publish(++g_ddHeldFrameId, QpcToNs(now.QuadPart), QpcToNs(composedQpc) + periodNs + periodNs / 4)) {
+        return rj::AcquireResult::Timeout;
+    }
+
+    rj::HoldDecision decision = rj::HoldDecision::Hold;
+    // Woken by the render thread's EndSample() once every output drew it, else at the deadline.
+    while ((decision = g_ddHeld.Wait(TraceNowNs())) == rj::HoldDecision::Hold) {}
+    if (decision == rj::HoldDecision::ReleaseDeadline && DdFillSlot(slotIndex, 1, &tex, &info, out)) {
+        out.desc.sequence = g_ddHeldFrame.damageSeq;
+        return rj::AcquireResult::NewFrame;
+    }
+    return rj::AcquireResult::Timeout;
+}
+
+// Render thread. Makes the slot the capture thread filled last the texture the outputs
+// sample; g_captureTex/g_captureSrv hold a reference to it until the next frame replaces it.
+static void DdSampleSlot(const rj::CapturedFrame& frame) {
+    DdSlot& slot = g_ddSlots[frame.slot];
+    if (slot.tex && slot.srv && slot.tex != g_captureTex) {
+        IUnknown* oldSrv = g_captureSrv;
+        SafeRelease(oldSrv);
+        IUnknown* oldTex = g_captureTex;
+        SafeRelease(oldTex);
+        slot.tex->AddRef();
+        slot.srv->AddRef();
+        g_captureTex = slot.tex;
+        g_captureSrv = slot.srv;
+        g_captureTexSequence = 0;
+        g_captureOwnedFormat.store(static_cast<uint32_t>(DXGI_FORMAT_B8G8R8A8_UNORM), std::memory_order_relaxed);
+    }
+    g_captureW = frame.desc.width;
+    g_captureH = frame.desc.height;
+    g_ddSampledDamageSeq = frame.desc.sequence;
+    const uint64_t ddCur = g_ddFrameCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+    g_lastCopyQpc.store(slot.readyQpc, std::memory_order_relaxed);
+    g_captureCopiedFrameCounter.store(ddCur, std::memory_order_relaxed);
+}
+
+// Render thread, zero-copy single_wide. A frame the capture thread holds is newer than any
+// slot: returns its id to sample it in place this pass, or 0 when none is held. Once it has
+// been released with nothing newer its content is gone (`contentGone`), and the outputs keep
+// showing their last present; g_presentPolicy won't redraw it.
+static uint64_t DdBeginHeldSample(bool tookSlot, bool& contentGone) {
+    const uint64_t id = g_ddHeld.BeginSample();
+    if (id != 0) {
+        g_captureW = g_ddHeldFrame.width;
+        g_captureH = g_ddHeldFrame.height;
+        if (id != g_ddLastHeldFrameId) {
+            g_ddLastHeldFrameId = id;
+            g_ddSampledDamageSeq = g_ddHeldFrame.damageSeq;
+            const uint64_t ddCur = g_ddFrameCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+            g_lastCopyQpc.store(g_ddHeldFrame.readyQpc, std::memory_order_relaxed);
+            g_captureCopiedFrameCounter.store(ddCur, std::memory_order_relaxed);
+        }
+        g_ddShowingHeldFrame = true;
+    } else if (tookSlot) {
+        g_ddShowingHeldFrame = false;
+    }
+    contentGone = id == 0 && g_ddShowingHeldFrame;
+    return id;
+}
+
+// Render thread, once every command that reads the sampled DD content is submitted. The
+// capture thread may release the held frame (`heldFrameId`, 0 for none) once `doneMask`
+// covers every output: drawn this pass, or not changed by it. The outputs in
+// `presentedMask` are clean up to the sampled damage.
+static void DdEndRenderSample(uint64_t heldFrameId, uint32_t doneMask, uint32_t presentedMask) {
+    if (heldFrameId != 0) g_ddHeld.EndSample(heldFrameId, doneMask);
+    if (presentedMask != 0) g_outputDamage.Drawn(presentedMask, g_ddSampledDamageSeq);
+}
+
+// Capture thread body (rj::CaptureThread::CaptureFn).
+static rj::AcquireResult DdCaptureIntoSlot(uint32_t timeoutMs, uint32_t slotIndex, rj::CapturedFrame& out) {
+    static thread_local bool s_traceNamed = false;
+    if (!s_traceNamed) {
+        g_trace.NameThread("dd capture");
+        s_traceNamed = true;
+    }
+    const uint64_t traceFrame = g_ddThread.FramesCaptured() + 1;
+    DdFollowRecordToggle();
+
+    if (g_ddSingleWideMode.load(std::memory_order_relaxed)) {
+        DXGI_OUTDUPL_FRAME_INFO info{};
+        IDXGIResource* res = nullptr;
+        g_trace.Begin(rj::TraceEvent::Acquire, traceFrame, TraceNowNs(), 0);
+        HRESULT hr = g_ddDup[0]->AcquireNextFrame(timeoutMs, &info, &res);
+        g_trace.End(rj::TraceEvent::Acquire, traceFrame, TraceNowNs(), 0);
+        if (hr == DXGI_ERROR_WAIT_TIMEOUT) return rj::AcquireResult::Timeout;
+        if (FAILED(hr)) {
+            LogDdAcquireFailure(0, hr);
+            return hr == DXGI_ERROR_ACCESS_LOST ? rj::AcquireResult::AccessLost : rj::AcquireResult::Timeout;
+        }
+        ID3D11Texture2D* tex = nullptr;
+        if (res) {
+            if (FAILED(res->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&tex)))) tex = nullptr;
+            res->Release();
+        }
+        rj::AcquireResult result = rj::AcquireResult::Timeout;
+        if (tex) DdReadFrameDamage(info);
+        if (tex && g_ddZeroCopy.load(std::memory_order_relaxed) && DdEnsureHeldView(tex)) {
+            result = DdHoldForRender(tex, info, slotIndex, out);
+        } else if (tex) {
+            if (g_ddZeroCopy.exchange(false, std::memory_order_relaxed) && g_consoleReady) {
+                printf("[rj_span] DD: the duplication texture can't be sampled in place; zero-copy off\n");
+                fflush(stdout);
+            }
+            if (DdFillSlot(slotIndex, 1, &tex, &info, out)) {
+                out.desc.sequence = DdMarkFrameDamage(out.desc.width, out.desc.height);
+                DdRecordFrame(out.desc.width, out.desc.height, &info, 1, out.desc.sequence);
+                result = rj::AcquireResult::NewFrame;
+            }
+        }
+        if (tex) tex->Release();
+        g_ddDup[0]->ReleaseFrame();
+        if (g_ddHeld.Holding()) g_ddHeld.Released(TraceNowNs());
+        return result;
+    }
+
+    // triple_composite: the tile workers acquire; composite whatever the policy publishes.
+    rj::TilePublish pub;
+    const rj::AcquireResult r = g_ddTiles.Collect(timeoutMs, pub);
+    if (r != rj::AcquireResult::NewFrame) return r;
+
+    ID3D11Texture2D* tex2d[3]{};
+    DXGI_OUTDUPL_FRAME_INFO info[3]{};
+    for (int m = 0; m < 3; m++) {
+        if (!(pub.tileMask & (1u << m))) continue;
+        tex2d[m] = g_ddTileFrames[m].tex;
+        info[m] = g_ddTileFrames[m].info;
+    }
+    g_trace.Instant(rj::TraceEvent::Publish, traceFrame, TraceNowNs(), pub.tileMask);
+    g_ddFrameDamage.clear();
+    g_ddFrameDamageWhole = false;
+    const bool filled = DdFillSlot(slotIndex, 3, tex2d, info, out);
+    if (filled) {
+        out.desc.sequence = DdMarkFrameDamage(out.desc.width, out.desc.height);
+        int count = 0;
+        DXGI_OUTDUPL_FRAME_INFO published[3]{};
+        for (int m = 0; m < 3; m++) {
+            if (pub.tileMask & (1u << m)) published[count++] = info[m];
+        }
+        DdRecordFrame(out.desc.width, out.desc.height, published, count, out.desc.sequence);
+    }
+    g_ddTiles.Recycle(pub.tileMask);
+    return filled ? rj::AcquireResult::NewFrame : rj::AcquireResult::Timeout;
+}
+
+// Called once the duplication objects exist.
+static void StartDdThread() {
+    g_ddSlots.assign(g_ddThread.SlotCount(), DdSlot{});
+    g_ddTileW = 0;
+    g_ddTileH = 0;
+    g_ddCopiedPixels.store(0, std::memory_order_relaxed);
+    g_ddSurfacePixels.store(0, std::memory_order_relaxed);
+    EnsureQpcInit();  // workers convert LastPresentTime
+    g_ddHeld.SetOutputs(static_cast<uint32_t>(g_outputs.size()));
+    // Damage maps onto the same columns the outputs show (see the blit plan in RenderFrame).
+    g_ddDamageSlices = rj::SlicePlanConfig{};
+    g_ddDamageSlices.outputs = static_cast<uint32_t>(g_outputs.size());
+    if (!g_outputs.empty()) {
+        g_ddDamageSlices.outputWidth = static_cast<uint32_t>(g_outputs[0].rc.right - g_outputs[0].rc.left);
+        g_ddDamageSlices.outputHeight = static_cast<uint32_t>(g_outputs[0].rc.bottom - g_outputs[0].rc.top);
+        g_ddDamageSlices.expectedWideW = g_haveExpectedMode ? g_expectedWideW : g_ddDamageSlices.outputWidth * g_ddDamageSlices.outputs;
+    }
+    g_ddDamageSeq = 0;
+    g_outputDamage.Reset(static_cast<uint32_t>(g_outputs.size()));
+    g_ddHoldPeriodNs.store(g_outputPeriodNs, std::memory_order_relaxed);
+    if (!g_ddSingleWideMode.load(std::memory_order_relaxed)) g_ddTiles.Start(3, DdAcquireTile, DdReleaseTile);
+    g_ddThread.Start(DdCaptureIntoSlot);
+}
+
+static uint32_t IddSurfacesPerSlot() {
+    return g_iddSurfaceSlices > 0 ? g_iddSurfaceSlices : 1;
+}
+
+static void ReleaseHeldIddSlot() {
+    if (g_iddHeldSlot >= 0) {
+        for (uint32_t i = 0; i < IddSurfacesPerSlot(); i++) {
+            IDXGIKeyedMutex* mutex = g_iddSlots[g_iddHeldSlot].surfaces[i].mutex;
+            if (mutex) (void)mutex->ReleaseSync(0);
+        }
+    }
+    g_iddHeldSlot = -1;
+}
+
+// Takes every surface of `slot`; all or nothing.
+static bool AcquireIddSlot(int slot) {
+    uint32_t locked = 0;
+    for (; locked < IddSurfacesPerSlot(); locked++) {
+        if (g_iddSlots[slot].surfaces[locked].mutex->AcquireSync(0, 100) != S_OK) break;
+    }
+    if (locked == IddSurfacesPerSlot()) {
+        g_iddHeldSlot = slot;
+        return true;
+    }
+    while (locked > 0) (void)g_iddSlots[slot].surfaces[--locked].mutex->ReleaseSync(0);
+    return false;
+}
+
+static void ReleaseIddSlots() {
+    ReleaseHeldIddSlot();
+    for (auto& slot : g_iddSlots) {
+        for (auto& surface : slot.surfaces) {
+            IUnknown* srv = surface.srv;
+            SafeRelease(srv);
+            IUnknown* mutex = surface.mutex;
+            SafeRelease(mutex);
+            IUnknown* tex = surface.tex;
+            SafeRelease(tex);
+            surface = IddSurface{};
+        }
+    }
+    g_iddSurfaceGen = 0;
+    g_iddSurfaceSlices = 0;
+}
+
+// Opens the driver's slot textures for `generation`, `slices` per-output textures per slot
+// or one wide one. Fails until the driver has created them (it does so on its first frame
+// after a restart, mode change or slicing change).
+static bool OpenIddSlots(uint32_t generation, uint32_t slices) {
+    ReleaseIddSlots();
+    if (!g_d3d.device1 || slices > rj::kMaxSliceOutputs) return false;
+    for (uint32_t i = 0; i < rj::kFrameChannelSlots; i++) {
+        for (uint32_t j = 0; j < (slices > 0 ? slices : 1); j++) {
+            const std::string name = slices > 0 ? rj::FrameChannelSliceSurfaceName(generation, i, j) : rj::FrameChannelSurfaceName(generation, i);
+            const std::wstring wname(name.begin(), name.end());
+            IddSurface& surface = g_iddSlots[i].surfaces[j];
+            HRESULT hr = g_d3d.device1->OpenSharedResourceByName(wname.c_str(),
+                                                                 DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE,
+                                                                 __uuidof(ID3D11Texture2D),
+                                                                 reinterpret_cast<void**>(&surface.tex));
+            if (SUCCEEDED(hr) && surface.tex) hr = surface.tex->QueryInterface(__uuidof(IDXGIKeyedMutex), reinterpret_cast<void**>(&surface.mutex));
+            if (SUCCEEDED(hr) && surface.tex) hr = g_d3d.device->CreateShaderResourceView(surface.tex, nullptr, &surface.srv);
+            if (FAILED(hr) || !surface.tex || !surface.mutex || !surface.srv) {
+                ReleaseIddSlots();
+                return false;
+            }
+        }
+    }
+    g_iddSurfaceGen = generation;
+    g_iddSurfaceSlices = slices;
+    return true;
+}
+
+static void StopIddChannel() {
+    ReleaseIddSlots();
+    g_iddChannel.Detach();
+    g_iddMemory.Close();
+    g_useIddChannel.store(false, std::memory_order_relaxed);
+}
 
-    IUnknown* dev = g_d3d.device;
-    SafeRelease(dev);
-    g_d3d.device = nullptr;
+// FrameArrived callbacks that start from here on return at once, and one already running
+// is waited for before the pool is closed, so the caller owns both sides of `g_wgcFrames`
+// afterwards.
+static void StopWgcCapture() {
+    AcquireSRWLockExclusive(&g_wgcCallbackLock);
+    g_wgcStopping = true;
+    while (g_wgcCallbacksInFlight != 0) SleepConditionVariableSRW(&g_wgcCallbacksDrained, &g_wgcCallbackLock, INFINITE, 0);
+    ReleaseSRWLockExclusive(&g_wgcCallbackLock);
+    try {
+        if (g_framePool) g_framePool.FrameArrived(g_frameArrivedToken);
+        if (g_session) g_session.Close();
+        if (g_framePool) g_framePool.Close();
+    } catch (...) {
+    }
+    g_session = nullptr;
+    g_framePool = nullptr;
+    g_captureItem = nullptr;
+    g_frameArrivedToken = {};
 }
 
 void StopCapture() {
+    StopIddChannel();
+    StopWgcCapture();
+
+    // The DD threads use the duplications and slot textures; stop them before releasing them.
+    // The capture thread goes first: it consumes the tile workers' frames.
+    g_ddThread.Stop();
+    g_ddTiles.Stop();
+    // Closes the session the capture thread was recording; the next start records a new one.
+    g_recorder.Stop();
+
     {
-        std::scoped_lock lk(g_captureMutex);
         IUnknown* srv = g_captureSrv;
         SafeRelease(srv);
         g_captureSrv = nullptr;
@@ -451,9 +1618,11 @@ void StopCapture() {
         IUnknown* rgb = g_captureRgbTex;
         SafeRelease(rgb);
         g_captureRgbTex = nullptr;
-        g_latestFrameTex = nullptr;
+        // WGC is stopped: release every slot's texture so a restart can't show a stale frame.
+        g_wgcFrames.Reset();
         g_captureW = 0;
         g_captureH = 0;
+        g_captureTexSequence = 0;
     }
 
     g_captureIsNv12.store(false, std::memory_order_relaxed);
@@ -466,6 +1635,7 @@ void StopCapture() {
             dd = nullptr;
         }
     }
+    ReleaseDdSlots();
     g_useDesktopDuplication.store(false, std::memory_order_relaxed);
     g_ddSingleWideMode.store(false, std::memory_order_relaxed);
     g_ddFrameCounter.store(0, std::memory_order_relaxed);
@@ -473,6 +1643,8 @@ void StopCapture() {
     g_pxB = 0;
     g_pxUniqueCount = 0;
     g_pxSampleCount = 0;
+    g_probeSequence = 0;
+    g_placeholder.Reset();
 }
 
 static bool StartDesktopDuplicationForMonitors(const MonitorDesc mons[3]) {
@@ -546,6 +1718,7 @@ static bool StartDesktopDuplicationForMonitors(const MonitorDesc mons[3]) {
     g_useDesktopDuplication.store(true, std::memory_order_relaxed);
     g_ddSingleWideMode.store(false, std::memory_order_relaxed);
     g_ddFrameCounter.store(0, std::memory_order_relaxed);
+    StartDdThread();
     return true;
 }
 
@@ -601,6 +1774,59 @@ static bool StartDesktopDuplicationForWideMonitor(const MonitorDesc& mon) {
     g_useDesktopDuplication.store(true, std::memory_order_relaxed);
     g_ddSingleWideMode.store(true, std::memory_order_relaxed);
     g_ddFrameCounter.store(0, std::memory_order_relaxed);
+    g_ddWideMon = mon;
+    g_haveDdWideMon = true;
+    StartDdThread();
+    return true;
+}
+
+// Consumes the wide virtual monitor straight from the IDD driver's frame channel. Fails (and
+// the caller falls back to Desktop Duplication) when the driver isn't publishing or renders
+// on a different adapter than ours.
+static bool StartIddChannel(const MonitorDesc& mon) {
+    if (!g_d3d.device || !g_d3d.device1) return false;
+
+    StopCapture();
+
+    LUID luid{};
+    {
+        IDXGIDevice* dxgiDevice = nullptr;
+        HRESULT hr = g_d3d.device->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgiDevice));
+        if (FAILED(hr) || !dxgiDevice) return false;
+        IDXGIAdapter* adapter = nullptr;
+        hr = dxgiDevice->GetAdapter(&adapter);
+        dxgiDevice->Release();
+        if (FAILED(hr) || !adapter) return false;
+        DXGI_ADAPTER_DESC ad{};
+        hr = adapter->GetDesc(&ad);
+        adapter->Release();
+        if (FAILED(hr)) return false;
+        luid = ad.AdapterLuid;
+    }
+    const uint64_t ourLuid = (static_cast<uint64_t>(static_cast<uint32_t>(luid.HighPart)) << 32) | luid.LowPart;
+
+    if (!g_iddMemory.Open(rj::kFrameChannelName) || !g_iddChannel.Attach(g_iddMemory.Data(), g_iddMemory.Size())) {
+        g_iddMemory.Close();
+        return false;
+    }
+    EnsureQpcInit();
+    const bool alive = g_iddChannel.ProducerAlive(TraceNowNs(), kIddHeartbeatTimeoutNs);
+    const bool sameAdapter = g_iddChannel.AdapterLuid() == ourLuid;
+    if (g_consoleReady) {
+        printf("[rj_span] IDD channel: gen=%u producer=%s adapter=%s\n",
+               g_iddChannel.Generation(),
+               alive ? "alive" : "stale",
+               sameAdapter ? "match" : "mismatch");
+        fflush(stdout);
+    }
+    if (!alive || !sameAdapter) {
+        StopIddChannel();
+        return false;
+    }
+
+    g_iddWideMon = mon;
+    g_ddFrameCounter.store(0, std::memory_order_relaxed);
+    g_useIddChannel.store(true, std::memory_order_relaxed);
     return true;
 }
 
@@ -621,13 +1847,12 @@ winrt::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice CreateWinRTD3DDev
     return out;
 }
 
-winrt::Windows::Graphics::Capture::GraphicsCaptureItem CreateCaptureItemForPrimaryMonitor() {
-    HMONITOR primary = MonitorFromWindow(GetDesktopWindow(), MONITOR_DEFAULTTOPRIMARY);
-    if (!primary) return nullptr;
+winrt::Windows::Graphics::Capture::GraphicsCaptureItem CreateCaptureItemForMonitor(HMONITOR mon) {
+    if (!mon) return nullptr;
 
     winrt::Windows::Graphics::Capture::GraphicsCaptureItem item{nullptr};
     auto interopFactory = winrt::get_activation_factory<winrt::Windows::Graphics::Capture::GraphicsCaptureItem, IGraphicsCaptureItemInterop>();
-    HRESULT hr = interopFactory->CreateForMonitor(primary, __uuidof(ABI::Windows::Graphics::Capture::IGraphicsCaptureItem), winrt::put_abi(item));
+    HRESULT hr = interopFactory->CreateForMonitor(mon, __uuidof(ABI::Windows::Graphics::Capture::IGraphicsCaptureItem), winrt::put_abi(item));
     if (FAILED(hr)) return nullptr;
     return item;
 }
@@ -687,6 +1912,13 @@ bool InitD3D() {
     (void)g_d3d.device->QueryInterface(__uuidof(ID3D11VideoDevice), reinterpret_cast<void**>(&g_d3d.videoDevice));
     (void)g_d3d.ctx->QueryInterface(__uuidof(ID3D11VideoContext), reinterpret_cast<void**>(&g_d3d.videoCtx));
 
+    // The Desktop Duplication thread copies on the immediate context as well.
+    ID3D11Multithread* multithread = nullptr;
+    if (SUCCEEDED(g_d3d.ctx->QueryInterface(__uuidof(ID3D11Multithread), reinterpret_cast<void**>(&multithread))) && multithread) {
+        (void)multithread->SetMultithreadProtected(TRUE);
+        multithread->Release();
+    }
+
     IDXGIDevice* dxgiDevice = nullptr;
     hr = g_d3d.device->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgiDevice));
     if (FAILED(hr)) return CheckHr(hr, L"QueryInterface(IDXGIDevice)");
@@ -698,23 +1930,6 @@ bool InitD3D() {
     adapter->Release();
     if (FAILED(hr)) return CheckHr(hr, L"IDXGIAdapter::GetParent");
 
-    // Diagnostics readback texture.
-    {
-        D3D11_TEXTURE2D_DESC rd{};
-        rd.Width = 1;
-        rd.Height = 1;
-        rd.MipLevels = 1;
-        rd.ArraySize = 1;
-        rd.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-        rd.SampleDesc.Count = 1;
-        rd.Usage = D3D11_USAGE_STAGING;
-        rd.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-        ID3D11Texture2D* t = nullptr;
-        if (SUCCEEDED(g_d3d.device->CreateTexture2D(&rd, nullptr, &t)) && t) {
-            g_debugReadback1x1 = t;
-        }
-    }
-
     // Shaders.
     //
     // We draw a single full-screen triangle (no vertex buffer) and compute UVs from
@@ -764,20 +1979,41 @@ bool InitD3D() {
         "  return c;"
         "}";
 
+    // Downsampled readbacks (D3dReadbackDevice): each target pixel is the mean of a
+    // factor x factor box of the source starting at origin, the same filter as
+    // rj::DownsampleBox. Drawn with the vertex shader above.
+    static const char* kDownsamplePsSrc =
+        "Texture2D src : register(t0);"
+        "cbuffer D : register(b0) { uint2 origin; uint factor; uint pad; }"
+        "struct PSIn { float4 pos : SV_Position; float2 uv : TEXCOORD0; };"
+        "float4 main(PSIn i) : SV_Target {"
+        "  int2 base = int2(origin) + int2(i.pos.xy) * int(factor);"
+        "  float4 sum = 0;"
+        "  for (uint y = 0; y < factor; y++)"
+        "    for (uint x = 0; x < factor; x++) sum += src.Load(int3(base + int2(x, y), 0));"
+        "  return sum / float(factor * factor);"
+        "}";
+
     ID3DBlob* vsBlob = nullptr;
     ID3DBlob* psBlob = nullptr;
+    ID3DBlob* downsampleBlob = nullptr;
     ID3DBlob* err = nullptr;
     hr = D3DCompile(kVsSrc, strlen(kVsSrc), nullptr, nullptr, nullptr, "main", "vs_5_0", 0, 0, &vsBlob, &err);
     if (FAILED(hr)) return CheckHr(hr, L"D3DCompile(VS)");
     hr = D3DCompile(kPsSrc, strlen(kPsSrc), nullptr, nullptr, nullptr, "main", "ps_5_0", 0, 0, &psBlob, &err);
     if (FAILED(hr)) return CheckHr(hr, L"D3DCompile(PS)");
+    hr = D3DCompile(kDownsamplePsSrc, strlen(kDownsamplePsSrc), nullptr, nullptr, nullptr, "main", "ps_5_0", 0, 0, &downsampleBlob, &err);
+    if (FAILED(hr)) return CheckHr(hr, L"D3DCompile(downsample PS)");
 
     hr = g_d3d.device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &g_d3d.vs);
     if (FAILED(hr)) return CheckHr(hr, L"CreateVertexShader");
     hr = g_d3d.device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &g_d3d.ps);
     if (FAILED(hr)) return CheckHr(hr, L"CreatePixelShader");
+    hr = g_d3d.device->CreatePixelShader(downsampleBlob->GetBufferPointer(), downsampleBlob->GetBufferSize(), nullptr, &g_d3d.downsamplePs);
+    if (FAILED(hr)) return CheckHr(hr, L"CreatePixelShader(downsample)");
     vsBlob->Release();
     psBlob->Release();
+    downsampleBlob->Release();
 
     D3D11_BUFFER_DESC cbd{};
     cbd.ByteWidth = (sizeof(Constants) + 15u) & ~15u;
@@ -786,6 +2022,9 @@ bool InitD3D() {
     cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
     hr = g_d3d.device->CreateBuffer(&cbd, nullptr, &g_d3d.cb);
     if (FAILED(hr)) return CheckHr(hr, L"CreateBuffer(CB)");
+    cbd.ByteWidth = 16;
+    hr = g_d3d.device->CreateBuffer(&cbd, nullptr, &g_d3d.downsampleCb);
+    if (FAILED(hr)) return CheckHr(hr, L"CreateBuffer(downsample CB)");
 
     D3D11_SAMPLER_DESC sd{};
     sd.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
@@ -805,8 +2044,8 @@ bool InitD3D() {
     return true;
 }
 
-bool StartCapturePrimary() {
-    // Minimal WGC capture start.
+// WGC capture of one monitor (the wide display).
+static bool StartWgcForMonitor(const MonitorDesc& mon) {
     StopCapture();
     g_captureFrameCounter.store(0, std::memory_order_relaxed);
     g_captureCopiedFrameCounter.store(0, std::memory_order_relaxed);
@@ -820,7 +2059,7 @@ bool StartCapturePrimary() {
     g_winrtD3DDevice = CreateWinRTD3DDeviceFromD3D11(g_d3d.device);
     if (!g_winrtD3DDevice) return false;
 
-    g_captureItem = CreateCaptureItemForPrimaryMonitor();
+    g_captureItem = CreateCaptureItemForMonitor(mon.handle);
     if (!g_captureItem) return false;
 
     auto sz = g_captureItem.Size();
@@ -839,7 +2078,22 @@ bool StartCapturePrimary() {
     } catch (...) {
     }
 
+    AcquireSRWLockExclusive(&g_wgcCallbackLock);
+    g_wgcStopping = false;
+    ReleaseSRWLockExclusive(&g_wgcCallbackLock);
     g_frameArrivedToken = g_framePool.FrameArrived([&](auto const& sender, auto const&) {
+        AcquireSRWLockExclusive(&g_wgcCallbackLock);
+        const bool stopping = g_wgcStopping;
+        if (!stopping) g_wgcCallbacksInFlight++;
+        ReleaseSRWLockExclusive(&g_wgcCallbackLock);
+        if (stopping) return;
+        struct InFlight {
+            ~InFlight() {
+                AcquireSRWLockExclusive(&g_wgcCallbackLock);
+                if (--g_wgcCallbacksInFlight == 0) WakeAllConditionVariable(&g_wgcCallbacksDrained);
+                ReleaseSRWLockExclusive(&g_wgcCallbackLock);
+            }
+        } inFlight;
         try {
             auto frame = sender.TryGetNextFrame();
             if (!frame) return;
@@ -860,13 +2114,16 @@ bool StartCapturePrimary() {
             tex->GetDesc(&td);
             g_captureSrcFormat.store(static_cast<uint32_t>(td.Format), std::memory_order_relaxed);
 
-            {
-                std::scoped_lock lk(g_captureMutex);
-                g_latestFrameTex = tex;
-                g_captureW = td.Width;
-                g_captureH = td.Height;
-            }
-            g_captureFrameCounter.fetch_add(1, std::memory_order_relaxed);
+            LARGE_INTEGER now{};
+            (void)QueryPerformanceCounter(&now);
+            WgcFrame& slot = g_wgcFrames.WriteSlot();
+            slot.tex = std::move(tex);
+            slot.width = td.Width;
+            slot.height = td.Height;
+            slot.format = td.Format;
+            slot.arrivedQpc = now.QuadPart;
+            slot.sequence = g_captureFrameCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+            g_wgcFrames.Publish();
         } catch (...) {
         }
     });
@@ -881,22 +2138,403 @@ bool StartCapturePrimary() {
     return true;
 }
 
+static bool StartCaptureBackend(rj::CaptureBackend b) {
+    switch (b) {
+    case rj::CaptureBackend::Wgc:
+        return StartWgcForMonitor(g_wideMon);
+    case rj::CaptureBackend::DdSingleWide:
+        return StartDesktopDuplicationForWideMonitor(g_wideMon);
+    case rj::CaptureBackend::DdTripleComposite:
+        return g_haveActiveMons && StartDesktopDuplicationForMonitors(g_activeMons);
+    }
+    return false;
+}
+
+static void LoadBackendCache() {
+    FILE* f = nullptr;
+    if (fopen_s(&f, kBackendCachePath, "rb") != 0 || !f) return;  // nothing probed yet
+    g_backendCache.Read(f);
+    fclose(f);
+}
+
+static void SaveBackendCache() {
+    FILE* f = nullptr;
+    bool ok = fopen_s(&f, kBackendCachePath, "wb") == 0 && f;
+    if (ok) {
+        ok = g_backendCache.Write(f);
+        ok = fclose(f) == 0 && ok;
+    }
+    if (!ok && g_consoleReady) {
+        printf("[rj_span] Backend probe: failed to write %s\n", kBackendCachePath);
+        fflush(stdout);
+    }
+}
+
+// Starts what g_backendProbe runs now, rejecting candidates that can't start. Once the probe
+// is done: its choice, cached for the topology, or Desktop Duplication when nothing could be
+// measured (a static desktop); that fallback is not cached. False when nothing started.
+static bool ApplyBackendProbe() {
+    while (g_backendProbe.Active()) {
+        const rj::CaptureBackend b = g_backendProbe.Current();
+        if (g_consoleReady) {
+            printf("[rj_span] Backend probe: trying %s\n", rj::CaptureBackendName(b));
+            fflush(stdout);
+        }
+        if (StartCaptureBackend(b)) return true;
+        g_backendProbe.Reject("start failed");
+        g_backendProbe.Advance(TraceNowNs());
+    }
+    if (g_consoleReady) {
+        for (const rj::BackendScore& s : g_backendProbe.Scores()) {
+            printf("[rj_span] Backend probe: %s frames=%llu hz=%.1f copy(uS)=%.1f c2p p50/p95(uS)=%.1f/%.1f cost(uS)=%.1f%s%s\n",
+                   rj::CaptureBackendName(s.backend),
+                   static_cast<unsigned long long>(s.frames),
+                   s.arrivalHz,
+                   s.copyAvgUs,
+                   s.latencyP50Us,
+                   s.latencyP95Us,
+                   s.costUs,
+                   s.rejected ? " rejected: " : "",
+                   s.rejected ? s.rejected : "");
+        }
+        fflush(stdout);
+    }
+    if (g_backendProbe.HasChoice()) {
+        const rj::CaptureBackend choice = g_backendProbe.Choice();
+        if (StartCaptureBackend(choice)) {
+            g_backendCache.Store(g_topologyKey, rj::BackendChoice{choice, static_cast<float>(g_backendProbe.ChosenScore()->costUs)});
+            SaveBackendCache();
+            if (g_consoleReady) {
+                printf("[rj_span] Backend probe: chose %s for %s\n", rj::CaptureBackendName(choice), g_topologyKey.c_str());
+                fflush(stdout);
+            }
+            return true;
+        }
+    }
+    if (g_consoleReady) {
+        printf("[rj_span] Backend probe: no choice, using %s\n", rj::CaptureBackendName(rj::CaptureBackend::DdSingleWide));
+        fflush(stdout);
+    }
+    return StartCaptureBackend(rj::CaptureBackend::DdSingleWide) || StartCaptureBackend(rj::CaptureBackend::Wgc);
+}
+
+// Capture of the wide display without the IDD frame channel: the backend cached for this
+// display topology, else a probe of Desktop Duplication and WGC that RenderFrame() runs.
+static bool StartWideCapture(const MonitorDesc& wide, const std::vector<MonitorDesc>& mons) {
+    g_wideMon = wide;
+    std::vector<rj::TopologyMonitor> topology;
+    for (const MonitorDesc& m : mons) {
+        rj::TopologyMonitor t;
+        t.x = m.rc.left;
+        t.y = m.rc.top;
+        UINT w = 0, h = 0, hz = 0;
+        if (TryGetMonitorCurrentMode(m.handle, w, h, hz)) {
+            t.width = w;
+            t.height = h;
+            t.hz = hz;
+        }
+        topology.push_back(t);
+    }
+    g_topologyKey = rj::TopologyKey(topology.data(), topology.size());
+
+    LoadBackendCache();
+    rj::BackendChoice cached;
+    if (g_backendCache.Find(g_topologyKey, cached)) {
+        if (StartCaptureBackend(cached.backend)) {
+            if (g_consoleReady) {
+                printf("[rj_span] Backend: %s (cached for this topology, delete %s to probe again)\n", rj::CaptureBackendName(cached.backend), kBackendCachePath);
+                fflush(stdout);
+            }
+            return true;
+        }
+        g_backendCache.Forget(g_topologyKey);
+        SaveBackendCache();
+    }
+    g_backendProbe.Begin({rj::CaptureBackend::DdSingleWide, rj::CaptureBackend::Wgc}, TraceNowNs());
+    return ApplyBackendProbe();
+}
+
+// True when an output window's client area no longer matches its swap-chain; the render
+// loop resizes the buffers on its next draw.
+static bool OutputsNeedResize() {
+    for (const auto& ow : g_outputs) {
+        if (!ow.swapchain) continue;
+        RECT cr{};
+        GetClientRect(ow.hwnd, &cr);
+        DXGI_SWAP_CHAIN_DESC1 scd{};
+        if (FAILED(ow.swapchain->GetDesc1(&scd))) continue;
+        if (scd.Width != static_cast<UINT>(cr.right - cr.left) || scd.Height != static_cast<UINT>(cr.bottom - cr.top)) return true;
+    }
+    return false;
+}
+
+static ID3D11Texture2D* CreateBgraTexture(UINT width, UINT height, bool staging) {
+    D3D11_TEXTURE2D_DESC td{};
+    td.Width = width;
+    td.Height = height;
+    td.MipLevels = 1;
+    td.ArraySize = 1;
+    td.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    td.SampleDesc.Count = 1;
+    td.Usage = staging ? D3D11_USAGE_STAGING : D3D11_USAGE_DEFAULT;
+    td.BindFlags = staging ? 0 : D3D11_BIND_RENDER_TARGET;
+    td.CPUAccessFlags = staging ? D3D11_CPU_ACCESS_READ : 0;
+    ID3D11Texture2D* tex = nullptr;
+    if (FAILED(g_d3d.device->CreateTexture2D(&td, nullptr, &tex))) return nullptr;
+    return tex;
+}
+
+void D3dReadbackDevice::SetSource(ID3D11Texture2D* src) {
+    if (src == m_src) return;
+    IUnknown* srv = m_srcSrv;
+    SafeRelease(srv);
+    m_srcSrv = nullptr;
+    m_src = src;
+}
+
+bool D3dReadbackDevice::Copy(uint32_t slot, const rj::ReadbackPlan& plan) {
+    if (!m_src || !g_d3d.device || !g_d3d.ctx) return false;
+    D3D11_TEXTURE2D_DESC sd{};
+    m_src->GetDesc(&sd);
+    if (sd.Format != DXGI_FORMAT_B8G8R8A8_UNORM || sd.SampleDesc.Count != 1) return false;
+    if (plan.downsample > 1 && (!(sd.BindFlags & D3D11_BIND_SHADER_RESOURCE) || !g_d3d.downsamplePs)) return false;
+
+    if (slot >= m_staging.size()) m_staging.resize(slot + 1);
+    Staging& st = m_staging[slot];
+    if (!st.tex || st.width != plan.width || st.height != plan.height) {
+        IUnknown* old = st.tex;
+        SafeRelease(old);
+        st = Staging{};
+        st.tex = CreateBgraTexture(plan.width, plan.height, true);
+        if (!st.tex) return false;
+        st.width = plan.width;
+        st.height = plan.height;
+    }
+
+    if (plan.downsample == 1) {
+        const D3D11_BOX box{static_cast<UINT>(plan.rect.left), static_cast<UINT>(plan.rect.top), 0, static_cast<UINT>(plan.rect.right),
+                            static_cast<UINT>(plan.rect.bottom), 1};
+        g_d3d.ctx->CopySubresourceRegion(st.tex, 0, 0, 0, 0, m_src, 0, &box);
+        return true;
+    }
+
+    // The scratch target only grows; the copy takes its top-left corner.
+    if (!m_scratch || m_scratchW < plan.width || m_scratchH < plan.height) {
+        IUnknown* rtv = m_scratchRtv;
+        SafeRelease(rtv);
+        IUnknown* tex = m_scratch;
+        SafeRelease(tex);
+        m_scratchRtv = nullptr;
+        m_scratch = CreateBgraTexture(std::max(plan.width, m_scratchW), std::max(plan.height, m_scratchH), false);
+        if (!m_scratch || FAILED(g_d3d.device->CreateRenderTargetView(m_scratch, nullptr, &m_scratchRtv))) {
+            IUnknown* failed = m_scratch;
+            SafeRelease(failed);
+            m_scratch = nullptr;
+            m_scratchRtv = nullptr;
+            m_scratchW = 0;
+            m_scratchH = 0;
+            return false;
+        }
+        D3D11_TEXTURE2D_DESC td{};
+        m_scratch->GetDesc(&td);
+        m_scratchW = td.Width;
+        m_scratchH = td.Height;
+    }
+    if (!m_srcSrv && FAILED(g_d3d.device->CreateShaderResourceView(m_src, nullptr, &m_srcSrv))) {
+        m_srcSrv = nullptr;
+        return false;
+    }
+    D3D11_MAPPED_SUBRESOURCE map{};
+    if (FAILED(g_d3d.ctx->Map(g_d3d.downsampleCb, 0, D3D11_MAP_WRITE_DISCARD, 0, &map))) return false;
+    const uint32_t constants[4] = {static_cast<uint32_t>(plan.rect.left), static_cast<uint32_t>(plan.rect.top), plan.downsample, 0};
+    memcpy(map.pData, constants, sizeof(constants));
+    g_d3d.ctx->Unmap(g_d3d.downsampleCb, 0);
+
+    D3D11_VIEWPORT vp{};
+    vp.Width = static_cast<float>(plan.width);
+    vp.Height = static_cast<float>(plan.height);
+    vp.MaxDepth = 1.0f;
+    g_d3d.ctx->OMSetRenderTargets(1, &m_scratchRtv, nullptr);
+    g_d3d.ctx->RSSetViewports(1, &vp);
+    g_d3d.ctx->PSSetShader(g_d3d.downsamplePs, nullptr, 0);
+    g_d3d.ctx->PSSetConstantBuffers(0, 1, &g_d3d.downsampleCb);
+    g_d3d.ctx->PSSetShaderResources(0, 1, &m_srcSrv);
+    g_d3d.ctx->Draw(3, 0);
+    // Back to the state InitD3D set for the output draws.
+    ID3D11ShaderResourceView* noSrv = nullptr;
+    g_d3d.ctx->PSSetShaderResources(0, 1, &noSrv);
+    g_d3d.ctx->OMSetRenderTargets(0, nullptr, nullptr);
+    g_d3d.ctx->PSSetShader(g_d3d.ps, nullptr, 0);
+    g_d3d.ctx->PSSetConstantBuffers(0, 1, &g_d3d.cb);
+
+    const D3D11_BOX box{0, 0, 0, plan.width, plan.height, 1};
+    g_d3d.ctx->CopySubresourceRegion(st.tex, 0, 0, 0, 0, m_scratch, 0, &box);
+    return true;
+}
+
+rj::ReadbackMapResult D3dReadbackDevice::Map(uint32_t slot, bool wait, rj::ReadbackMapping& out) {
+    if (slot >= m_staging.size() || !m_staging[slot].tex || !g_d3d.ctx) return rj::ReadbackMapResult::Failed;
+    D3D11_MAPPED_SUBRESOURCE mapped{};
+    const HRESULT hr = g_d3d.ctx->Map(m_staging[slot].tex, 0, D3D11_MAP_READ, wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING) return rj::ReadbackMapResult::Busy;
+    if (FAILED(hr)) return rj::ReadbackMapResult::Failed;
+    out.pixels = static_cast<const uint8_t*>(mapped.pData);
+    out.strideBytes = mapped.RowPitch;
+    return rj::ReadbackMapResult::Mapped;
+}
+
+void D3dReadbackDevice::Unmap(uint32_t slot) {
+    if (slot < m_staging.size() && m_staging[slot].tex && g_d3d.ctx) g_d3d.ctx->Unmap(m_staging[slot].tex, 0);
+}
+
+void D3dReadbackDevice::Release() {
+    for (Staging& st : m_staging) {
+        IUnknown* tex = st.tex;
+        SafeRelease(tex);
+    }
+    m_staging.clear();
+    IUnknown* rtv = m_scratchRtv;
+    SafeRelease(rtv);
+    IUnknown* scratch = m_scratch;
+    SafeRelease(scratch);
+    m_scratchRtv = nullptr;
+    m_scratch = nullptr;
+    m_scratchW = 0;
+    m_scratchH = 0;
+    IUnknown* srv = m_srcSrv;
+    SafeRelease(srv);
+    m_srcSrv = nullptr;
+    m_src = nullptr;
+}
+
+static void ReleaseReplayReadback() {
+    // The ring may still be coding from a mapped readback.
+    g_replayRing.WaitIdle();
+    g_replayReadbacks.Reset();
+    g_replayReadbackDevice.Release();
+    g_replayCaptureNs.clear();
+    g_replayLentId = 0;
+}
+
+static void ReleaseProbeReadback() {
+    g_probeReadbacks.Reset();
+    g_probeReadbackDevice.Release();
+}
+
+// Render thread: feeds the instant-replay ring. Requests a readback of `src` (BGRA; null when
+// this pass samples nothing the ring can take) when its content is new and the readback rate
+// allows, and lends the oldest finished readback to the ring once it is idle. A full readback
+// ring or a busy instant-replay ring skip frames rather than wait.
+static void FeedReplayRing(ID3D11Texture2D* src, uint64_t sequence, int64_t captureNs) {
+    rj::InstantReplaySave saved;
+    if (g_replayRing.TakeSaveResult(saved) && g_consoleReady) {
+        if (saved.ok) {
+            printf("[rj_span] InstantReplay: saved %llu frames (%.1f s, %.1f MB) -> %s (rj_bench pipeline --replay=%s)\n",
+                   static_cast<unsigned long long>(saved.frames), rj::NsToMs(saved.spanNs) / 1000.0, static_cast<double>(saved.bytes) / 1e6,
+                   rj::RecordingSegmentPath(saved.basePath, 0).c_str(), saved.basePath.c_str());
+        } else {
+            printf("[rj_span] InstantReplay: nothing saved to %s\n", rj::RecordingSegmentPath(saved.basePath, 0).c_str());
+        }
+        fflush(stdout);
+    }
+    if (!g_replayRing.Running()) {
+        ReleaseReplayReadback();
+        return;
+    }
+
+    const int64_t nowNs = TraceNowNs();
+    g_replayReadbacks.Poll(nowNs);
+    if (g_replayRing.Idle()) {
+        if (g_replayLentId != 0) g_replayReadbacks.Release(g_replayLentId);
+        g_replayLentId = 0;
+        rj::ReadbackResult r;
+        if (g_replayReadbacks.Take(r)) {
+            while (!g_replayCaptureNs.empty() && g_replayCaptureNs.front().first < r.id) g_replayCaptureNs.pop_front();
+            rj::FrameDesc f{};
+            f.sequence = r.tag;
+            f.captureTimeNs = !g_replayCaptureNs.empty() && g_replayCaptureNs.front().first == r.id ? g_replayCaptureNs.front().second : 0;
+            f.width = r.plan.width;
+            f.height = r.plan.height;
+            f.strideBytes = r.strideBytes;
+            f.format = rj::PixelFormat::Bgra8;
+            f.pixels = r.pixels;
+            if (g_replayRing.Submit(f, r.requestNs)) {
+                g_replayLentId = r.id;
+            } else {
+                g_replayReadbacks.Release(r.id);
+            }
+        }
+    }
+
+    if (!src || sequence == g_replayFedSequence || nowNs < g_replayNextNs) return;
+    D3D11_TEXTURE2D_DESC sd{};
+    src->GetDesc(&sd);
+    g_replayReadbackDevice.SetSource(src);
+    const uint64_t id = g_replayReadbacks.Request(sd.Width, sd.Height, rj::Rect{}, 1, sequence, nowNs);
+    if (id == 0) return;
+    g_replayCaptureNs.emplace_back(id, captureNs);
+    g_replayFedSequence = sequence;
+    g_replayNextNs = nowNs + rj::kNsPerSec / kReplayReadbackHz;
+}
+
+// Distinct colours (alpha ignored) among up to kProbeSamples pixels spread over the probe;
+// a flat or placeholder image has very few.
+static void SummarizeProbe(const rj::ReadbackResult& r) {
+    constexpr uint32_t kProbeSamples = 256;
+    auto at = [&](uint32_t x, uint32_t y) {
+        uint32_t v;
+        memcpy(&v, r.pixels + static_cast<size_t>(y) * r.strideBytes + x * 4u, sizeof(v));
+        return v & 0x00FFFFFFu;
+    };
+    g_pxA = at(0, 0);
+    g_pxB = at(r.plan.width / 2, r.plan.height / 2);
+    uint32_t seen[kProbeSamples];
+    uint32_t unique = 0;
+    uint32_t samples = 0;
+    const uint32_t pixels = r.plan.width * r.plan.height;
+    const uint32_t step = std::max(pixels / kProbeSamples, 1u);
+    for (uint32_t i = 0; i < pixels && samples < kProbeSamples; i += step, samples++) {
+        const uint32_t v = at(i % r.plan.width, i / r.plan.width);
+        if (std::find(seen, seen + unique, v) == seen + unique) seen[unique++] = v;
+    }
+    g_pxUniqueCount = static_cast<int>(unique);
+    g_pxSampleCount = static_cast<int>(samples);
+    if (rj::IsPlaceholder(g_placeholder.Update(r.pixels, r.strideBytes, r.plan.width, r.plan.height))) g_placeholderProbes++;
+}
+
+// Render thread: requests a downsampled readback of each new frame this pass samples and
+// summarises the finished ones. Copies the GPU has not finished are picked up on a later
+// frame; a full ring skips the frame.
+static void ProbeContent(ID3D11Texture2D* src, uint64_t sequence) {
+    const int64_t nowNs = TraceNowNs();
+    g_probeReadbacks.Poll(nowNs);
+    rj::ReadbackResult r;
+    while (g_probeReadbacks.Take(r)) {
+        SummarizeProbe(r);
+        g_probeReadbacks.Release(r.id);
+    }
+    if (!src || sequence == g_probeSequence) return;
+    D3D11_TEXTURE2D_DESC sd{};
+    src->GetDesc(&sd);
+    g_probeReadbackDevice.SetSource(src);
+    g_probeReadbacks.Request(sd.Width, sd.Height, rj::Rect{}, kProbeDownsample, sequence, nowNs);
+    g_probeSequence = sequence;
+}
+
 void RenderFrame() {
     if (!g_running || !g_d3d.device || !g_d3d.ctx) return;
 
-    static uint64_t lastSeenFrame = 0;
     static uint64_t s_renderFrameCounter = 0;
     static long long s_lastLatencySeenCopyQpc = 0;
     static float s_lastCopyToPresentUs = -1.0f;
-    static double s_accTotalMs = 0.0;
-    static double s_accCaptureMs = 0.0;
-    static double s_accRenderMs = 0.0;
-    static double s_accPresentBlockMs = 0.0;
-    static double s_maxPresentBlockMs = 0.0;
-    static double s_maxTotalMs = 0.0;
-    static double s_accWaitMs = 0.0;
-    static double s_maxWaitMs = 0.0;
-    static uint64_t s_accFrameCount = 0;
+    static rj::FrameStatsWindow s_stats;
+    static uint64_t s_blitOutputs = 0;
+    static uint64_t s_presentedOutputs = 0;
+    static uint64_t s_presentingPasses = 0;
+    static int64_t s_lastWaitNs = 0;
+    static bool s_primaryPresented = true;  // output 0 presented last pass, so its waitable fires
+    static uint64_t s_contentSequence = 0;  // what g_presentPolicy counts as content
+    static uint64_t s_arrivalSequence = 0;  // last copied frame counted as an arrival
     const float timeSeconds = static_cast<float>(GetTickCount64()) / 1000.0f;
 
     EnsureQpcInit();
@@ -906,15 +2544,43 @@ void RenderFrame() {
         if (g_qpcFreq <= 0) return 0.0;
         return (static_cast<double>(dtQpc) * 1000.0) / static_cast<double>(g_qpcFreq);
     };
+    const uint64_t traceFrame = s_renderFrameCounter + 1;
+    g_trace.Begin(rj::TraceEvent::Frame, traceFrame, QpcToNs(qpcFrameStart.QuadPart));
 
     double waitMsThisFrame = 0.0;
-    if (!g_outputs.empty() && g_outputs[0].frameLatencyWaitable) {
+    if (!g_presentPolicy.WaitableArmed() || !s_primaryPresented) {
+        // Output 0 did not present last pass, so its frame-latency waitable won't fire again
+        // until it does; pace on the output period instead.
+        const int64_t waitStartNs = TraceNowNs();
+        g_trace.Begin(rj::TraceEvent::Wait, traceFrame, waitStartNs);
+        s_lastWaitNs = rj::PresentPolicy::NextPassNs(s_lastWaitNs, g_outputPeriodNs, waitStartNs);
+        SleepUntilNs(s_lastWaitNs);
+        const int64_t waitEndNs = TraceNowNs();
+        g_trace.End(rj::TraceEvent::Wait, traceFrame, waitEndNs);
+        waitMsThisFrame = rj::NsToMs(waitEndNs - waitStartNs);
+    } else if (!g_outputs.empty() && g_outputs[0].frameLatencyWaitable) {
         LARGE_INTEGER qpcWaitA{};
         LARGE_INTEGER qpcWaitB{};
         (void)QueryPerformanceCounter(&qpcWaitA);
-        (void)WaitForSingleObject(g_outputs[0].frameLatencyWaitable, 100);
+        g_trace.Begin(rj::TraceEvent::Wait, traceFrame, QpcToNs(qpcWaitA.QuadPart));
+        const DWORD waitResult = WaitForSingleObject(g_outputs[0].frameLatencyWaitable, 100);
         (void)QueryPerformanceCounter(&qpcWaitB);
+        g_trace.End(rj::TraceEvent::Wait, traceFrame, QpcToNs(qpcWaitB.QuadPart));
         waitMsThisFrame = QpcToMs(qpcWaitB.QuadPart - qpcWaitA.QuadPart);
+        s_lastWaitNs = QpcToNs(qpcWaitB.QuadPart);
+        if (g_lateLatchEnabled && waitResult == WAIT_OBJECT_0) g_lateLatch.OnVblank(QpcToNs(qpcWaitB.QuadPart));
+    }
+
+    rj::LatchPlan latchPlan{};
+    int64_t latchedNs = 0;
+    if (g_lateLatchEnabled) {
+        const int64_t sleepStartNs = TraceNowNs();
+        latchPlan = g_lateLatch.Plan(sleepStartNs);
+        g_trace.Begin(rj::TraceEvent::Wait, traceFrame, sleepStartNs, 1);
+        SleepUntilNs(latchPlan.latchNs);
+        latchedNs = TraceNowNs();
+        g_trace.End(rj::TraceEvent::Wait, traceFrame, latchedNs, 1);
+        waitMsThisFrame += rj::NsToMs(latchedNs - sleepStartNs);
     }
 
     auto EnsureCaptureTexture = [&](UINT w, UINT h) {
@@ -929,7 +2595,6 @@ void RenderFrame() {
 
         if (!needCreate) return;
 
-        std::scoped_lock lk(g_captureMutex);
         IUnknown* oldSrv = g_captureSrv;
         SafeRelease(oldSrv);
         g_captureSrv = nullptr;
@@ -958,157 +2623,181 @@ void RenderFrame() {
         g_captureOwnedFormat.store(static_cast<uint32_t>(DXGI_FORMAT_B8G8R8A8_UNORM), std::memory_order_relaxed);
     };
 
+    // A probe window that ended switches the backend before this pass looks for frames.
+    if (g_backendProbe.Active()) {
+        const int64_t nowNs = TraceNowNs();
+        g_backendProbe.OnCopies(nowNs, g_captureCopies.exchange(0, std::memory_order_relaxed), g_captureCopyNs.exchange(0, std::memory_order_relaxed));
+        if (g_backendProbe.Advance(nowNs) && !ApplyBackendProbe()) StopCapture();
+    }
+
     // Pull latest frame and copy to our own shader-readable texture.
     // Prefer Desktop Duplication when enabled; otherwise use WGC.
     LARGE_INTEGER qpcAfterCapture{};
-    {
-        const bool useDd = g_useDesktopDuplication.load(std::memory_order_relaxed);
-        const bool singleWide = g_ddSingleWideMode.load(std::memory_order_relaxed);
-        if (useDd && singleWide && g_ddDup[0]) {
-            DXGI_OUTDUPL_FRAME_INFO info{};
-            IDXGIResource* res = nullptr;
-            HRESULT hr = g_ddDup[0]->AcquireNextFrame(0, &info, &res);
-            if (hr == DXGI_ERROR_WAIT_TIMEOUT) {
-                // No new frame this tick.
-            } else if (hr == DXGI_ERROR_ACCESS_LOST) {
-                // Let the caller recover by stopping takeover.
-            } else if (SUCCEEDED(hr) && res) {
-                ID3D11Texture2D* tex2d = nullptr;
-                hr = res->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&tex2d));
-                if (SUCCEEDED(hr) && tex2d) {
-                    D3D11_TEXTURE2D_DESC td{};
-                    tex2d->GetDesc(&td);
-                    g_captureSrcFormat.store(static_cast<uint32_t>(td.Format), std::memory_order_relaxed);
-                    {
-                        std::scoped_lock lk(g_captureMutex);
-                        g_captureW = td.Width;
-                        g_captureH = td.Height;
-                    }
-                    EnsureCaptureTexture(td.Width, td.Height);
-                    if (g_captureTex) {
-                        g_d3d.ctx->CopyResource(g_captureTex, tex2d);
-                        const uint64_t ddCur = g_ddFrameCounter.fetch_add(1, std::memory_order_relaxed) + 1;
-                        MarkCopyTimestampQpc();
-                        g_captureCopiedFrameCounter.store(ddCur, std::memory_order_relaxed);
-                    }
+    uint64_t heldFrameId = 0;  // zero-copy DD frame this pass samples in place
+    bool heldContentGone = false;
+    if (g_useIddChannel.load(std::memory_order_relaxed)) {
+        // Ask for per-output slices or the wide frame; the driver switches with a new
+        // generation. Reopen the slot textures after that, a driver restart or a mode change;
+        // until the driver has recreated them the previous frame stays on screen.
+        g_iddChannel.RequestSlices(g_iddSlicing.load(std::memory_order_relaxed) ? static_cast<uint32_t>(g_outputs.size()) : 0u);
+        const uint32_t gen = g_iddChannel.Generation();
+        if (gen != g_iddSurfaceGen) (void)OpenIddSlots(gen, g_iddChannel.SurfaceSlices());
+        if (g_iddSurfaceGen != 0 && g_iddChannel.Update()) {
+            const int s = static_cast<int>(g_iddChannel.Slot());
+            if (g_iddHeldSlot >= 0 && g_iddHeldSlot != s) ReleaseHeldIddSlot();
+            // The slot is ours now; the wait only covers the driver's copy still in flight on
+            // its device. A frame written before the last layout switch is skipped.
+            const bool layoutMatches = g_iddChannel.Current().sliceCount == g_iddSurfaceSlices;
+            if (layoutMatches && g_iddHeldSlot != s) (void)AcquireIddSlot(s);
+            if (g_iddHeldSlot == s) {
+                IddSurface& slot = g_iddSlots[s].surfaces[0];
+                if (g_iddSurfaceSlices == 0 && slot.tex != g_captureTex) {
+                    IUnknown* oldSrv = g_captureSrv;
+                    SafeRelease(oldSrv);
+                    IUnknown* oldTex = g_captureTex;
+                    SafeRelease(oldTex);
+                    slot.tex->AddRef();
+                    slot.srv->AddRef();
+                    g_captureTex = slot.tex;
+                    g_captureSrv = slot.srv;
+                    g_captureTexSequence = 0;
+                    g_captureOwnedFormat.store(static_cast<uint32_t>(g_iddChannel.Current().format), std::memory_order_relaxed);
                 }
-                if (tex2d) tex2d->Release();
-                res->Release();
-                (void)g_ddDup[0]->ReleaseFrame();
+                const rj::ChannelFrameInfo& info = g_iddChannel.Current();
+                g_captureW = info.width;
+                g_captureH = info.height;
+                g_ddFrameCounter.fetch_add(1, std::memory_order_relaxed);
+                g_lastCopyQpc.store(NsToQpc(info.publishTimeNs), std::memory_order_relaxed);
+                g_captureCopiedFrameCounter.store(info.frameId, std::memory_order_relaxed);
             }
-        } else if (useDd && g_ddDup[0] && g_ddDup[1] && g_ddDup[2]) {
-            // Composite 3 monitor frames into one wide texture.
-            // IMPORTANT: Don't use window RECT sizes here (they can be DPI-logical). Use the actual
-            // Desktop Duplication frame texture dimensions.
-            static UINT s_tileW = 0;
-            static UINT s_tileH = 0;
-
-            bool ddAccessLost = false;
-
-            bool anyFrame = false;
-            for (int m = 0; m < 3; m++) {
-                DXGI_OUTDUPL_FRAME_INFO info{};
-                IDXGIResource* res = nullptr;
-                HRESULT hr = g_ddDup[m]->AcquireNextFrame(0, &info, &res);
-                if (hr == DXGI_ERROR_WAIT_TIMEOUT) {
-                    continue;
-                }
-                if (hr == DXGI_ERROR_ACCESS_LOST) {
-                    ddAccessLost = true;
-                }
-                if (FAILED(hr) || !res) {
-                    static HRESULT s_lastDdAcquireHr[3] = {S_OK, S_OK, S_OK};
-                    if (hr != s_lastDdAcquireHr[m]) {
-                        s_lastDdAcquireHr[m] = hr;
-                        char buf[200];
-                        snprintf(buf, sizeof(buf), "[rj_span] DD: AcquireNextFrame[%d] failed hr=0x%08X\n", m, static_cast<unsigned>(hr));
-                        OutputDebugStringA(buf);
-                        if (g_consoleReady) {
-                            fputs(buf, stdout);
-                            fflush(stdout);
-                        }
-                    }
-                    continue;
-                }
-
-                ID3D11Texture2D* tex2d = nullptr;
-                hr = res->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&tex2d));
-                if (SUCCEEDED(hr) && tex2d) {
-                    D3D11_TEXTURE2D_DESC td{};
-                    tex2d->GetDesc(&td);
-                    if (s_tileW != td.Width || s_tileH != td.Height) {
-                        s_tileW = td.Width;
-                        s_tileH = td.Height;
-                    }
-
-                    const UINT wideW = s_tileW * 3;
-                    const UINT wideH = s_tileH;
-                    g_captureSrcFormat.store(static_cast<uint32_t>(td.Format), std::memory_order_relaxed);
-                    {
-                        std::scoped_lock lk(g_captureMutex);
-                        g_captureW = wideW;
-                        g_captureH = wideH;
-                    }
-                    EnsureCaptureTexture(wideW, wideH);
+        }
 
-                    if (g_captureTex) {
-                        D3D11_BOX srcBox{0, 0, 0, s_tileW, s_tileH, 1};
-                        g_d3d.ctx->CopySubresourceRegion(g_captureTex, 0, s_tileW * m, 0, 0, tex2d, 0, &srcBox);
-                        anyFrame = true;
-                    }
-                }
-                if (tex2d) tex2d->Release();
-                res->Release();
-                g_ddDup[m]->ReleaseFrame();
+        // The driver heartbeats even while the desktop is idle; silence means it is gone
+        // (device removed, adapter restarted). Fall back to Desktop Duplication.
+        if (!g_iddChannel.ProducerAlive(TraceNowNs(), kIddHeartbeatTimeoutNs)) {
+            if (g_consoleReady) {
+                printf("[rj_span] IDD channel: driver heartbeat lost, falling back to Desktop Duplication\n");
+                fflush(stdout);
+            }
+            const MonitorDesc wide = g_iddWideMon;
+            if (!StartDesktopDuplicationForWideMonitor(wide)) StopCapture();
+        }
+    }
+    {
+        const bool useDd = g_useDesktopDuplication.load(std::memory_order_relaxed);
+        const bool singleWide = g_ddSingleWideMode.load(std::memory_order_relaxed);
+        if (useDd && g_ddThread.Running()) {
+            rj::CapturedFrame frame;
+            const bool tookSlot = g_ddThread.TakeLatest(frame) && frame.slot < g_ddSlots.size();
+            if (tookSlot) DdSampleSlot(frame);
+            if (singleWide && g_ddZeroCopy.load(std::memory_order_relaxed)) {
+                heldFrameId = DdBeginHeldSample(tookSlot, heldContentGone);
+            } else {
+                g_ddShowingHeldFrame = false;
             }
 
             // Desktop Duplication can be invalidated by display mode changes (fullscreen apps,
-            // resolution/refresh changes, driver resets). Recover by recreating the duplication
-            // objects instead of exiting.
-            if (ddAccessLost && g_haveActiveMons) {
-                StopCapture();
-                if (!StartDesktopDuplicationForMonitors(g_activeMons)) {
+            // resolution/refresh changes, driver resets). The capture thread exits; recover by
+            // recreating the duplication objects instead of exiting.
+            if (g_ddThread.Failed()) {
+                bool restarted = false;
+                if (singleWide && g_haveDdWideMon) {
+                    const MonitorDesc wide = g_ddWideMon;
+                    restarted = StartDesktopDuplicationForWideMonitor(wide);
+                } else if (!singleWide && g_haveActiveMons) {
+                    restarted = StartDesktopDuplicationForMonitors(g_activeMons);
+                }
+                if (!restarted) {
+                    StopCapture();
                     g_useDesktopDuplication.store(false, std::memory_order_relaxed);
                 }
             }
-
-            if (anyFrame) {
-                const uint64_t ddCur = g_ddFrameCounter.fetch_add(1, std::memory_order_relaxed) + 1;
-                MarkCopyTimestampQpc();
-                g_captureCopiedFrameCounter.store(ddCur, std::memory_order_relaxed);
-            }
         }
 
-        if (!g_useDesktopDuplication.load(std::memory_order_relaxed)) {
-            winrt::com_ptr<ID3D11Texture2D> src;
-            UINT w = 0, h = 0;
-            {
-                std::scoped_lock lk(g_captureMutex);
-                src = g_latestFrameTex;
-                w = g_captureW;
-                h = g_captureH;
-            }
-
-            const uint64_t curFrame = g_captureFrameCounter.load(std::memory_order_relaxed);
-            if (src && curFrame != lastSeenFrame) {
-                EnsureCaptureTexture(w, h);
-                if (g_captureTex) {
-                    g_d3d.ctx->CopyResource(g_captureTex, src.get());
-                    MarkCopyTimestampQpc();
-                    g_captureCopiedFrameCounter.store(curFrame, std::memory_order_relaxed);
+        // A WGC session that keeps delivering placeholders is replaced by Desktop
+        // Duplication of the same display, and not chosen again for this topology. While
+        // probing, it is just a rejected candidate.
+        if (!g_useDesktopDuplication.load(std::memory_order_relaxed) && !g_useIddChannel.load(std::memory_order_relaxed) && g_placeholder.Fired()) {
+            if (g_backendProbe.Active()) {
+                g_backendProbe.Reject("placeholder frames");
+            } else {
+                if (g_consoleReady) {
+                    const rj::ContentStats& s = g_placeholder.LastStats();
+                    printf("[rj_span] WGC: %u placeholder frames in a row (%s, stddev %.1f), switching to Desktop Duplication\n",
+                           g_placeholder.Config().triggerFrames,
+                           rj::FrameContentName(g_placeholder.Last()),
+                           static_cast<double>(s.maxStddev));
+                    fflush(stdout);
                 }
-                lastSeenFrame = curFrame;
+                if (g_backendCache.Forget(g_topologyKey)) SaveBackendCache();
+                if (!StartDesktopDuplicationForWideMonitor(g_wideMon)) StopCapture();
+            }
+            g_placeholder.Reset();
+        }
+        // The WGC frame is copied into g_captureTex only when an output has to sample it
+        // (MaterializeWgcFrame); outputs on the copy path read the frame texture directly.
+        if (!g_useDesktopDuplication.load(std::memory_order_relaxed) && !g_useIddChannel.load(std::memory_order_relaxed) && g_wgcFrames.Update()) {
+            const WgcFrame& frame = g_wgcFrames.Read();
+            if (frame.tex) {
+                g_captureW = frame.width;
+                g_captureH = frame.height;
+                MarkCopyTimestampQpc();
+                g_captureCopiedFrameCounter.store(frame.sequence, std::memory_order_relaxed);
             }
         }
     }
+    const bool usingWgc = !g_useDesktopDuplication.load(std::memory_order_relaxed) && !g_useIddChannel.load(std::memory_order_relaxed);
+    const WgcFrame* wgcFrame = (usingWgc && g_wgcFrames.Read().tex) ? &g_wgcFrames.Read() : nullptr;
+    auto MaterializeWgcFrame = [&]() {
+        if (!wgcFrame || wgcFrame->sequence == g_captureTexSequence) return;
+        EnsureCaptureTexture(wgcFrame->width, wgcFrame->height);
+        if (!g_captureTex) return;
+        g_trace.Begin(rj::TraceEvent::Copy, traceFrame, TraceNowNs());
+        const int64_t copyStartNs = TraceNowNs();
+        g_d3d.ctx->CopyResource(g_captureTex, wgcFrame->tex.get());
+        const int64_t copyEndNs = TraceNowNs();
+        g_trace.End(rj::TraceEvent::Copy, traceFrame, copyEndNs);
+        CountCaptureCopy(copyEndNs - copyStartNs);
+        g_captureTexSequence = wgcFrame->sequence;
+    };
 
     (void)QueryPerformanceCounter(&qpcAfterCapture);
 
     const bool usingTestPattern = g_useTestPattern.load(std::memory_order_relaxed);
+    {
+        // The content probe and the instant-replay ring take what this pass samples: the
+        // held DD frame, the WGC frame (not copied into g_captureTex unless an output needs
+        // it) or g_captureTex.
+        ID3D11Texture2D* sampledSrc = nullptr;
+        if (!usingTestPattern) {
+            if (heldFrameId != 0) sampledSrc = g_ddHeldFrame.tex;
+            else if (wgcFrame) sampledSrc = wgcFrame->tex.get();
+            else if (!g_useIddChannel.load(std::memory_order_relaxed) || g_iddSurfaceSlices == 0) sampledSrc = g_captureTex;
+        }
+        const uint64_t sampledSequence = g_captureCopiedFrameCounter.load(std::memory_order_relaxed);
+        if (sampledSequence != s_arrivalSequence) {
+            s_arrivalSequence = sampledSequence;
+            g_backendProbe.OnFrame(TraceNowNs());
+        }
+        ProbeContent(sampledSrc, sampledSequence);
+        FeedReplayRing(sampledSrc, sampledSequence, QpcToNs(g_lastCopyQpc.load(std::memory_order_relaxed)));
+    }
+    // The test pattern animates; a resized output needs new backbuffers.
+    if (usingTestPattern || OutputsNeedResize()) g_presentPolicy.Force();
+    // Desktop Duplication says which outputs a frame changed; a frame that changed none is
+    // no new content. Everything else redraws every output.
+    const uint32_t allOutputs = rj::AllOutputsMask(static_cast<uint32_t>(g_outputs.size()));
+    const bool perOutput =
+        !usingTestPattern && g_useDesktopDuplication.load(std::memory_order_relaxed) && g_presentPolicy.Config().onNewContent;
+    const uint32_t damaged = perOutput ? g_outputDamage.Pending() & allOutputs : allOutputs;
+    if (damaged != 0) s_contentSequence = g_captureCopiedFrameCounter.load(std::memory_order_relaxed);
+    const rj::PresentReason presentReason = g_presentPolicy.Decide(TraceNowNs(), s_contentSequence, usingTestPattern || !heldContentGone);
+    const bool skipPresent = !rj::Presents(presentReason);
+    // Keep-alive, forced and always-present passes redraw every output.
+    const uint32_t drawMask = presentReason == rj::PresentReason::NewContent ? damaged : allOutputs;
     ID3D11ShaderResourceView* srvLocal = nullptr;
     if (!usingTestPattern) {
-        std::scoped_lock lk(g_captureMutex);
-        srvLocal = g_captureSrv;
+        srvLocal = heldFrameId != 0 ? g_ddHeldFrame.srv : g_captureSrv;
         if (srvLocal) srvLocal->AddRef();
     }
     ID3D11ShaderResourceView* srvs[1] = {srvLocal};
@@ -1124,14 +2813,11 @@ void RenderFrame() {
             const ULONGLONG prevLogMs = lastLogMs;
             lastLogMs = nowMs;
             const bool usingDd = g_useDesktopDuplication.load(std::memory_order_relaxed);
+            const bool usingIdd = g_useIddChannel.load(std::memory_order_relaxed);
             const bool ddSingleWide = g_ddSingleWideMode.load(std::memory_order_relaxed);
             const bool usingTest = g_useTestPattern.load(std::memory_order_relaxed);
-            UINT w = 0, h = 0;
-            {
-                std::scoped_lock lk(g_captureMutex);
-                w = g_captureW;
-                h = g_captureH;
-            }
+            UINT w = g_captureW;
+            UINT h = g_captureH;
 
             if (usingTest) {
                 w = 7680;
@@ -1146,61 +2832,82 @@ void RenderFrame() {
             }
             lastRenderedForFps = rendered;
 
-            const float fps = lastFps;
-            const float latencyUs = s_lastCopyToPresentUs;
-
-            double avgTotalMs = 0.0;
-            double avgCaptureMs = 0.0;
-            double avgRenderMs = 0.0;
-            double avgPresentMs = 0.0;
-            double avgWaitMs = 0.0;
-            double maxPresentMs = 0.0;
-            double maxWaitMs = 0.0;
-            double maxTotalMs = 0.0;
-            if (s_accFrameCount > 0) {
-                const double denom = static_cast<double>(s_accFrameCount);
-                avgTotalMs = s_accTotalMs / denom;
-                avgCaptureMs = s_accCaptureMs / denom;
-                avgRenderMs = s_accRenderMs / denom;
-                avgPresentMs = s_accPresentBlockMs / denom;
-                avgWaitMs = s_accWaitMs / denom;
-                maxPresentMs = s_maxPresentBlockMs;
-                maxWaitMs = s_maxWaitMs;
-                maxTotalMs = s_maxTotalMs;
+            rj::StatsLineInfo info;
+            info.backend = usingTest ? "TEST" : (usingIdd ? "IDD" : (usingDd ? "DD" : "WGC"));
+            info.ddMode = usingDd ? (ddSingleWide ? "single_wide" : "triple_composite") : "-";
+            info.fps = lastFps;
+            info.latencyUs = s_lastCopyToPresentUs;
+            info.width = w;
+            info.height = h;
+            info.expectedW = g_haveExpectedMode ? g_expectedWideW : 0;
+            info.expectedH = g_haveExpectedMode ? g_expectedWideH : 0;
+            info.expectedHz = g_haveExpectedMode ? g_expectedHz : 0;
+            info.summary = s_stats.TakeAndReset();
+            const uint64_t ddCopied = g_ddCopiedPixels.exchange(0, std::memory_order_relaxed);
+            const uint64_t ddSurface = g_ddSurfacePixels.exchange(0, std::memory_order_relaxed);
+            if (usingDd && !ddSingleWide && ddSurface > 0) {
+                info.copyPercent = static_cast<float>(100.0 * static_cast<double>(ddCopied) / static_cast<double>(ddSurface));
+            }
+            const rj::TileSkewStats skew = g_ddTiles.TakeStats();
+            if (usingDd && !ddSingleWide && skew.publishes > 0) {
+                info.tileSkewAvgUs = static_cast<float>(skew.AvgSkewUs());
+                info.tileSkewMaxUs = static_cast<float>(rj::NsToUs(skew.skewMaxNs));
+            }
+            const rj::LateLatchStats latch = g_lateLatch.TakeStats();
+            if (g_lateLatchEnabled) {
+                info.latchMarginUs = static_cast<float>(rj::NsToUs(latch.marginNs));
+                info.latchSlackMinUs = static_cast<float>(rj::NsToUs(latch.slackMinNs));
+                info.latchMisses = latch.misses;
+            }
+            if (usingIdd) {
+                const rj::ChannelProducerStats assign = g_iddChannel.ProducerStats();
+                if (assign.firstFrameNs > 0) {
+                    info.assignFirstFrameMs = static_cast<float>(rj::NsToMs(assign.firstFrameNs));
+                    info.assignDeviceMs = static_cast<float>(rj::NsToMs(assign.deviceAcquireNs));
+                    info.assignments = assign.assignments;
+                    info.deviceReuses = assign.deviceReuses;
+                }
+            }
+            if (s_presentingPasses > 0) {
+                info.blitOutputsAvg = static_cast<float>(static_cast<double>(s_blitOutputs) / static_cast<double>(s_presentingPasses));
+                info.presentOutputsAvg = static_cast<float>(static_cast<double>(s_presentedOutputs) / static_cast<double>(s_presentingPasses));
+                info.outputs = static_cast<uint32_t>(g_outputs.size());
+            }
+            s_blitOutputs = 0;
+            s_presentedOutputs = 0;
+            s_presentingPasses = 0;
+            CollectGpuTimer();
+            if (g_gpuFrames > 0) {
+                info.gpuAvgMs = static_cast<float>(g_gpuSumMs / static_cast<double>(g_gpuFrames));
+                info.gpuMaxMs = static_cast<float>(g_gpuMaxMs);
             }
-            s_accTotalMs = 0.0;
-            s_accCaptureMs = 0.0;
-            s_accRenderMs = 0.0;
-            s_accPresentBlockMs = 0.0;
-            s_maxPresentBlockMs = 0.0;
-            s_accWaitMs = 0.0;
-            s_maxWaitMs = 0.0;
-            s_maxTotalMs = 0.0;
-            s_accFrameCount = 0;
-
-            const char* ddModeStr = usingDd ? (ddSingleWide ? "single_wide" : "triple_composite") : "-";
-            char buf[520];
-            snprintf(
-                buf,
-                sizeof(buf),
-                "[rj_span] backend=%s ddmode=%s fps=%.1f Latency(uS)=%.0f size=%ux%u expected=%ux%u@%u avg(ms) total=%.2f wait=%.2f cap=%.2f render=%.2f present=%.2f max(ms) wait=%.2f present=%.2f total=%.2f\n",
-                usingTest ? "TEST" : (usingDd ? "DD" : "WGC"),
-                ddModeStr,
-                static_cast<double>(fps),
-                static_cast<double>(latencyUs),
-                static_cast<unsigned>(w),
-                static_cast<unsigned>(h),
-                static_cast<unsigned>(g_haveExpectedMode ? g_expectedWideW : 0),
-                static_cast<unsigned>(g_haveExpectedMode ? g_expectedWideH : 0),
-                static_cast<unsigned>(g_haveExpectedMode ? g_expectedHz : 0),
-                avgTotalMs,
-                avgWaitMs,
-                avgCaptureMs,
-                avgRenderMs,
-                avgPresentMs,
-                maxWaitMs,
-                maxPresentMs,
-                maxTotalMs);
+            g_gpuSumMs = 0.0;
+            g_gpuMaxMs = 0.0;
+            g_gpuFrames = 0;
+            const rj::HeldFrameStats held = g_ddHeld.TakeStats();
+            if (usingDd && ddSingleWide && g_ddZeroCopy.load(std::memory_order_relaxed)) {
+                info.holdMaxMs = static_cast<float>(rj::NsToMs(held.maxHoldNs));
+                info.holdDrawn = held.releasedDrawn;
+                info.holdCopied = held.releasedDeadline;
+                info.holdOverruns = held.overruns;
+            }
+            const rj::PresentPolicyStats present = g_presentPolicy.TakeStats();
+            info.presents = present.presents;
+            info.passes = present.passes;
+            info.keepAlives = present.keepAlives;
+            const rj::ReadbackStats probe = g_probeReadbacks.TakeStats();
+            if (probe.completed > 0) {
+                info.readbacks = probe.completed;
+                info.readbackLatencyAvg = static_cast<float>(static_cast<double>(probe.latencyFramesSum) / static_cast<double>(probe.completed));
+                info.readbackLatencyMax = probe.latencyFramesMax;
+                info.readbackDrops = probe.dropped;
+                info.probeColors = static_cast<uint32_t>(g_pxUniqueCount);
+                info.placeholderProbes = g_placeholderProbes;
+            }
+            g_placeholderProbes = 0;
+
+            char buf[rj::kStatsLineBytes];
+            rj::FormatStatsLine(buf, sizeof(buf), info);
             OutputDebugStringA(buf);
             if (g_consoleReady) {
                 fputs(buf, stdout);
@@ -1213,8 +2920,40 @@ void RenderFrame() {
     (void)QueryPerformanceCounter(&qpcRenderStart);
     double presentBlockMsThisFrame = 0.0;
 
+    // Wide source an output can copy its column from: the WGC frame itself, or the DD / IDD
+    // slot the capture already samples. Columns follow the shader's slicing.
+    ID3D11Texture2D* blitSource = nullptr;
+    DXGI_FORMAT blitSourceFormat = DXGI_FORMAT_UNKNOWN;
+    if (!usingTestPattern && g_blitFastPath.load(std::memory_order_relaxed) && g_captureCopiedFrameCounter.load(std::memory_order_relaxed) > 0) {
+        if (wgcFrame) {
+            blitSource = wgcFrame->tex.get();
+            blitSourceFormat = wgcFrame->format;
+        } else if (heldFrameId != 0) {
+            blitSource = g_ddHeldFrame.tex;
+            blitSourceFormat = g_ddHeldFrame.format;
+        } else if (!usingWgc && !(g_useIddChannel.load(std::memory_order_relaxed) && g_iddSurfaceSlices > 0)) {
+            blitSource = g_captureTex;
+            blitSourceFormat = static_cast<DXGI_FORMAT>(g_captureOwnedFormat.load(std::memory_order_relaxed));
+        }
+    }
+    rj::SlicePlan blitPlan{};
+    if (blitSource && !g_outputs.empty()) {
+        rj::SlicePlanConfig cfg;
+        cfg.outputs = static_cast<uint32_t>(g_outputs.size());
+        const UINT outW = static_cast<UINT>(g_outputs[0].rc.right - g_outputs[0].rc.left);
+        cfg.expectedWideW = g_haveExpectedMode ? g_expectedWideW : outW * cfg.outputs;
+        blitPlan = rj::PlanSlices(g_captureW, g_captureH, cfg);
+    }
+    uint32_t blitOutputsThisFrame = 0;
+    uint32_t presentedMask = 0;
+    uint32_t heldDrawnMask = 0;
+    bool latencySampled = false;
+    GpuTimerFrame* gpuTimer = skipPresent ? nullptr : BeginGpuTimer();
+
     for (auto& ow : g_outputs) {
+        if (skipPresent) break;
         if (!ow.swapchain || !ow.rtv) continue;
+        if (!(drawMask & (1u << ow.sliceIndex))) continue;
 
         RECT cr{};
         GetClientRect(ow.hwnd, &cr);
@@ -1245,14 +2984,47 @@ void RenderFrame() {
         // Use backbuffer size for viewport to avoid mismatches that can manifest as corner-cropping.
         UINT bbW = clientW;
         UINT bbH = clientH;
-        {
-            ID3D11Texture2D* back = nullptr;
-            if (SUCCEEDED(ow.swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&back))) && back) {
-                D3D11_TEXTURE2D_DESC bd{};
-                back->GetDesc(&bd);
-                bbW = bd.Width;
-                bbH = bd.Height;
-                back->Release();
+        DXGI_FORMAT bbFormat = DXGI_FORMAT_UNKNOWN;
+        ID3D11Texture2D* back = nullptr;
+        if (SUCCEEDED(ow.swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&back))) && back) {
+            D3D11_TEXTURE2D_DESC bd{};
+            back->GetDesc(&bd);
+            bbW = bd.Width;
+            bbH = bd.Height;
+            bbFormat = bd.Format;
+        }
+
+        // Driver-side slicing: this output's column of the frame is its own surface. When it
+        // already matches the backbuffer it is copied as is (flips are forced off below),
+        // otherwise drawn unsliced. Without slices, the output's column of the wide source is
+        // copied when it maps 1:1 onto the backbuffer.
+        const IddSurface* iddSlice = nullptr;
+        if (!usingTestPattern && g_useIddChannel.load(std::memory_order_relaxed) && g_iddHeldSlot >= 0 &&
+            static_cast<uint32_t>(ow.sliceIndex) < g_iddSurfaceSlices) {
+            iddSlice = &g_iddSlots[g_iddHeldSlot].surfaces[ow.sliceIndex];
+        }
+        rj::OutputBlit blit{};
+        ID3D11Texture2D* blitFrom = nullptr;
+        if (iddSlice && back) {
+            D3D11_TEXTURE2D_DESC sd{};
+            iddSlice->tex->GetDesc(&sd);
+            rj::SlicePlanConfig one;
+            one.outputs = 1;
+            blit = rj::PlanOutputBlit(rj::PlanSlices(sd.Width, sd.Height, one), 0, bbW, bbH, sd.Format == bbFormat);
+            blitFrom = iddSlice->tex;
+        } else if (blitSource && back) {
+            blit = rj::PlanOutputBlit(blitPlan, static_cast<uint32_t>(ow.sliceIndex), bbW, bbH, blitSourceFormat == bbFormat);
+            blitFrom = blitSource;
+        }
+        const bool copyOutput = blit.Copy();
+        if (copyOutput) blitOutputsThisFrame++;
+        if (!copyOutput && !iddSlice && wgcFrame) {
+            MaterializeWgcFrame();
+            if (!usingTestPattern && srvLocal != g_captureSrv) {
+                IUnknown* old = srvLocal;
+                SafeRelease(old);
+                srvLocal = g_captureSrv;
+                if (srvLocal) srvLocal->AddRef();
             }
         }
 
@@ -1273,12 +3045,13 @@ void RenderFrame() {
             clear[3] = 1.0f;
         }
         g_d3d.ctx->OMSetRenderTargets(1, &ow.rtv, nullptr);
-        g_d3d.ctx->ClearRenderTargetView(ow.rtv, clear);
+        if (!copyOutput) g_d3d.ctx->ClearRenderTargetView(ow.rtv, clear);
 
         D3D11_MAPPED_SUBRESOURCE map{};
         if (SUCCEEDED(g_d3d.ctx->Map(g_d3d.cb, 0, D3D11_MAP_WRITE_DISCARD, 0, &map))) {
             auto* c = reinterpret_cast<Constants*>(map.pData);
-            const bool usingDd = g_useDesktopDuplication.load(std::memory_order_relaxed);
+            // The IDD channel carries the same desktop surface DD returns for the virtual monitor.
+            const bool usingDd = g_useDesktopDuplication.load(std::memory_order_relaxed) || g_useIddChannel.load(std::memory_order_relaxed);
             const bool usingTest = g_useTestPattern.load(std::memory_order_relaxed);
 
             // When using the 3-monitor compositor, we already place monitors left-to-right in the
@@ -1292,15 +3065,13 @@ void RenderFrame() {
             // DD composite orientation controls (slice-local flipX in shader).
             c->flipY = usingDd ? 1.0f : 0.0f;
 
-            // Only slice when the captured surface is actually ~3 monitors wide.
-            UINT capW = 0;
-            {
-                std::scoped_lock lk(g_captureMutex);
-                capW = g_captureW;
-            }
+            // Only slice when the captured surface is actually ~3 monitors wide. A driver-side
+            // slice is already this output's column; flips then apply to it slice-locally,
+            // as they would have to its column of the wide frame.
+            const UINT capW = g_captureW;
             const UINT outW = static_cast<UINT>(ow.rc.right - ow.rc.left);
             const UINT expectedW = g_haveExpectedMode ? g_expectedWideW : (outW * 3);
-            const bool sliceEnabled = usingTest ? true : (capW >= (expectedW - 32));
+            const bool sliceEnabled = usingTest ? true : (!iddSlice && capW >= (expectedW - 32));
             c->sliceEnabled = sliceEnabled ? 1.0f : 0.0f;
 
             // Provide viewport size so PS can compute UV from SV_Position robustly.
@@ -1321,21 +3092,40 @@ void RenderFrame() {
             g_d3d.ctx->Unmap(g_d3d.cb, 0);
         }
 
-        g_d3d.ctx->Draw(3, 0);
+        const uint32_t traceOutput = static_cast<uint32_t>(ow.sliceIndex);
+        g_trace.Begin(rj::TraceEvent::Draw, traceFrame, TraceNowNs(), traceOutput);
+        if (copyOutput) {
+            const D3D11_BOX box{static_cast<UINT>(blit.src.left), static_cast<UINT>(blit.src.top), 0, static_cast<UINT>(blit.src.right), static_cast<UINT>(blit.src.bottom), 1};
+            g_d3d.ctx->CopySubresourceRegion(back, 0, 0, 0, 0, blitFrom, 0, &box);
+        } else {
+            ID3D11ShaderResourceView* outputSrv = iddSlice ? iddSlice->srv : srvLocal;
+            g_d3d.ctx->PSSetShaderResources(0, 1, &outputSrv);
+            g_d3d.ctx->Draw(3, 0);
+        }
+        if (heldFrameId != 0 && !usingTestPattern) heldDrawnMask |= 1u << ow.sliceIndex;
+        g_trace.End(rj::TraceEvent::Draw, traceFrame, TraceNowNs(), traceOutput);
+        if (back) back->Release();
         if (ow.sliceIndex == 0) {
             LARGE_INTEGER qpcBeforePresent{};
             LARGE_INTEGER qpcAfterPresent{};
             (void)QueryPerformanceCounter(&qpcBeforePresent);
+            g_trace.Begin(rj::TraceEvent::Present, traceFrame, QpcToNs(qpcBeforePresent.QuadPart), traceOutput);
             ow.swapchain->Present(1, 0);
             (void)QueryPerformanceCounter(&qpcAfterPresent);
+            g_trace.End(rj::TraceEvent::Present, traceFrame, QpcToNs(qpcAfterPresent.QuadPart), traceOutput);
             presentBlockMsThisFrame += QpcToMs(qpcAfterPresent.QuadPart - qpcBeforePresent.QuadPart);
         } else {
+            g_trace.Begin(rj::TraceEvent::Present, traceFrame, TraceNowNs(), traceOutput);
             ow.swapchain->Present(0, 0);
+            g_trace.End(rj::TraceEvent::Present, traceFrame, TraceNowNs(), traceOutput);
         }
+        presentedMask |= 1u << ow.sliceIndex;
 
-        // Measure copy-to-present latency for the most recent copied frame.
-        // We only update this when a new copy was observed (so idle periods don't spike the metric).
-        if (ow.sliceIndex == 0) {
+        // Measure copy-to-present latency for the most recent copied frame at the first output
+        // that presents it. We only update this when a new copy was observed (so idle periods
+        // don't spike the metric).
+        if (!latencySampled) {
+            latencySampled = true;
             EnsureQpcInit();
             const long long copyQpc = g_lastCopyQpc.load(std::memory_order_relaxed);
             if (copyQpc > 0 && copyQpc != s_lastLatencySeenCopyQpc && g_qpcFreq > 0) {
@@ -1347,25 +3137,33 @@ void RenderFrame() {
                     if (us > 50000.0) us = 50000.0;
                     s_lastCopyToPresentUs = static_cast<float>(us);
                     s_lastLatencySeenCopyQpc = copyQpc;
+                    s_stats.AddCopyToPresent(static_cast<int64_t>(dt) * rj::kNsPerSec / g_qpcFreq);
+                    g_backendProbe.OnPresent(QpcToNs(now.QuadPart), static_cast<int64_t>(dt) * rj::kNsPerSec / g_qpcFreq);
                 }
             }
         }
     }
 
+    EndGpuTimer(gpuTimer);
+    DdEndRenderSample(heldFrameId, heldDrawnMask | (allOutputs & ~damaged), perOutput ? presentedMask : 0);
+    if (!skipPresent) {
+        s_blitOutputs += blitOutputsThisFrame;
+        for (uint32_t m = presentedMask; m != 0; m &= m - 1) s_presentedOutputs++;
+        s_presentingPasses++;
+        s_primaryPresented = (presentedMask & 1u) != 0;
+    }
+
     LARGE_INTEGER qpcFrameEnd{};
     (void)QueryPerformanceCounter(&qpcFrameEnd);
-    const double captureMs = QpcToMs(qpcAfterCapture.QuadPart - qpcFrameStart.QuadPart);
-    const double renderMs = QpcToMs(qpcFrameEnd.QuadPart - qpcRenderStart.QuadPart);
-    const double totalMs = QpcToMs(qpcFrameEnd.QuadPart - qpcFrameStart.QuadPart);
-    s_accCaptureMs += captureMs;
-    s_accRenderMs += renderMs;
-    s_accTotalMs += totalMs;
-    s_accPresentBlockMs += presentBlockMsThisFrame;
-    s_accWaitMs += waitMsThisFrame;
-    if (presentBlockMsThisFrame > s_maxPresentBlockMs) s_maxPresentBlockMs = presentBlockMsThisFrame;
-    if (waitMsThisFrame > s_maxWaitMs) s_maxWaitMs = waitMsThisFrame;
-    if (totalMs > s_maxTotalMs) s_maxTotalMs = totalMs;
-    s_accFrameCount++;
+    g_trace.End(rj::TraceEvent::Frame, traceFrame, QpcToNs(qpcFrameEnd.QuadPart));
+    if (g_lateLatchEnabled && !skipPresent) g_lateLatch.OnSubmitted(latchPlan, latchedNs, QpcToNs(qpcFrameEnd.QuadPart));
+    rj::FrameTimings timings;
+    timings.waitMs = waitMsThisFrame;
+    timings.captureMs = QpcToMs(qpcAfterCapture.QuadPart - qpcFrameStart.QuadPart);
+    timings.renderMs = QpcToMs(qpcFrameEnd.QuadPart - qpcRenderStart.QuadPart);
+    timings.presentMs = presentBlockMsThisFrame;
+    timings.totalMs = QpcToMs(qpcFrameEnd.QuadPart - qpcFrameStart.QuadPart);
+    s_stats.Add(timings);
 
     s_renderFrameCounter++;
 
@@ -1423,7 +3221,8 @@ bool StartTakeover() {
         for (size_t i = 0; i < mons.size(); i++) {
             UINT w = 0, h = 0, hz = 0;
             if (!TryGetMonitorCurrentMode(mons[i].handle, w, h, hz)) continue;
-            if (w >= 7600 && h == 1440) {
+            // Three or more panels side by side: at least 4.5:1 (3x16:10 is 4.8:1).
+            if (h > 0 && w * 2 >= h * 9) {
                 wideIdx = static_cast<int>(i);
                 g_haveExpectedMode = true;
                 g_expectedWideW = w;
@@ -1460,6 +3259,7 @@ bool StartTakeover() {
     g_activeMons[1] = outs[1];
     g_activeMons[2] = outs[2];
     g_haveActiveMons = true;
+    PublishVirtualDisplayConfig(g_activeMons);
 
     if (!InitD3D()) {
         DestroyD3D();
@@ -1489,9 +3289,19 @@ bool StartTakeover() {
     }
 
     const MonitorDesc outArr[3] = {outs[0], outs[1], outs[2]};
+
+    // Output 0's refresh drives the frame-latency waitable and the late-latch prediction.
+    {
+        UINT w = 0, h = 0, hz = 0;
+        g_outputPeriodNs = rj::kNsPerSec / ((TryGetMonitorCurrentMode(outArr[0].handle, w, h, hz) && hz > 1) ? hz : 60);
+        g_lateLatch.Reset(g_outputPeriodNs);
+    }
     if (wideIdx >= 0) {
-        if (!StartDesktopDuplicationForWideMonitor(mons[static_cast<size_t>(wideIdx)])) {
-            MessageBoxW(nullptr, L"Failed to start Desktop Duplication for wide monitor.", L"rj_span", MB_OK | MB_ICONERROR);
+        // Prefer the driver's frame channel; Desktop Duplication of the virtual monitor is the
+        // fallback when the driver isn't publishing.
+        const MonitorDesc& wide = mons[static_cast<size_t>(wideIdx)];
+        if (!StartIddChannel(wide) && !StartWideCapture(wide, mons)) {
+            MessageBoxW(nullptr, L"Failed to start capture of the wide monitor.", L"rj_span", MB_OK | MB_ICONERROR);
             StopTakeover();
             return false;
         }
@@ -1516,6 +3326,7 @@ bool StartTakeover() {
         }
     }
 
+    g_presentPolicy.Force();
     g_running = true;
     return true;
 }
@@ -1524,6 +3335,7 @@ void StopTakeover() {
     if (!g_running) return;
     g_running = false;
     g_haveActiveMons = false;
+    g_backendProbe.Cancel();
     StopCapture();
     DestroyOutputs();
     DestroyD3D();
@@ -1551,6 +3363,33 @@ LRESULT CALLBACK OutputWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam
     return DefWindowProcW(hwnd, msg, wParam, lParam);
 }
 
+// Writes the trace ring to rj_span_trace_<local time>.rjtrace. Runs on the UI thread; the
+// snapshot does not stop the capture threads from recording.
+void DumpTrace() {
+    std::vector<rj::TraceRecord> records;
+    EnsureQpcInit();
+    g_trace.Instant(rj::TraceEvent::Dump, 0, TraceNowNs());
+    g_trace.Snapshot(records);
+
+    SYSTEMTIME st{};
+    GetLocalTime(&st);
+    char path[MAX_PATH];
+    snprintf(path, sizeof(path), "rj_span_trace_%04u%02u%02u_%02u%02u%02u.rjtrace",
+             st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond);
+
+    FILE* f = nullptr;
+    bool ok = fopen_s(&f, path, "wb") == 0 && f;
+    if (ok) {
+        ok = rj::WriteTraceDump(f, records, g_trace.ThreadNames());
+        ok = fclose(f) == 0 && ok;
+    }
+    if (g_consoleReady) {
+        if (ok) printf("[rj_span] Trace: %zu events -> %s (rj_trace %s)\n", records.size(), path, path);
+        else printf("[rj_span] Trace: failed to write %s\n", path);
+        fflush(stdout);
+    }
+}
+
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
         case WM_HOTKEY: {
@@ -1563,6 +3402,42 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 ToggleTestPattern();
                 return 0;
             }
+            if (wParam == kHotkeyTraceDump) {
+                DumpTrace();
+                return 0;
+            }
+            if (wParam == kHotkeyLateLatch) {
+                ToggleLateLatch();
+                return 0;
+            }
+            if (wParam == kHotkeyDdZeroCopy) {
+                ToggleDdZeroCopy();
+                return 0;
+            }
+            if (wParam == kHotkeyBlitFastPath) {
+                ToggleBlitFastPath();
+                return 0;
+            }
+            if (wParam == kHotkeyPresentOnChange) {
+                TogglePresentOnChange();
+                return 0;
+            }
+            if (wParam == kHotkeyRecord) {
+                ToggleRecording();
+                return 0;
+            }
+            if (wParam == kHotkeyReplayRing) {
+                ToggleReplayRing();
+                return 0;
+            }
+            if (wParam == kHotkeyReplaySave) {
+                SaveReplay();
+                return 0;
+            }
+            if (wParam == kHotkeyIddSlices) {
+                ToggleIddSlices();
+                return 0;
+            }
             if (wParam == kHotkeyEmergencyStop) {
                 StopTakeover();
                 return 0;
@@ -1682,6 +3557,44 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR, int) {
         MessageBoxW(nullptr, L"Failed to register Ctrl+Alt+T hotkey.", L"rj_span", MB_OK | MB_ICONERROR);
         return 1;
     }
+    // Diagnostics only: run without it rather than refuse to start.
+    if (!RegisterHotKey(g_hiddenHwnd, kHotkeyTraceDump, MOD_CONTROL | MOD_ALT, 'D') && g_consoleReady) {
+        printf("[rj_span] Ctrl+Alt+D (trace dump) unavailable: another app owns it\n");
+        fflush(stdout);
+    }
+    if (!RegisterHotKey(g_hiddenHwnd, kHotkeyLateLatch, MOD_CONTROL | MOD_ALT, 'L') && g_consoleReady) {
+        printf("[rj_span] Ctrl+Alt+L (late latch) unavailable: another app owns it\n");
+        fflush(stdout);
+    }
+    if (!RegisterHotKey(g_hiddenHwnd, kHotkeyIddSlices, MOD_CONTROL | MOD_ALT, 'I') && g_consoleReady) {
+        printf("[rj_span] Ctrl+Alt+I (IDD slices) unavailable: another app owns it\n");
+        fflush(stdout);
+    }
+    if (!RegisterHotKey(g_hiddenHwnd, kHotkeyBlitFastPath, MOD_CONTROL | MOD_ALT, 'B') && g_consoleReady) {
+        printf("[rj_span] Ctrl+Alt+B (blit fast path) unavailable: another app owns it\n");
+        fflush(stdout);
+    }
+    if (!RegisterHotKey(g_hiddenHwnd, kHotkeyDdZeroCopy, MOD_CONTROL | MOD_ALT, 'Z') && g_consoleReady) {
+        printf("[rj_span] Ctrl+Alt+Z (DD zero-copy) unavailable: another app owns it\n");
+        fflush(stdout);
+    }
+    if (!RegisterHotKey(g_hiddenHwnd, kHotkeyPresentOnChange, MOD_CONTROL | MOD_ALT, 'P') && g_consoleReady) {
+        printf("[rj_span] Ctrl+Alt+P (present on change) unavailable: another app owns it\n");
+        fflush(stdout);
+    }
+    if (!RegisterHotKey(g_hiddenHwnd, kHotkeyRecord, MOD_CONTROL | MOD_ALT, 'R') && g_consoleReady) {
+        printf("[rj_span] Ctrl+Alt+R (capture recording) unavailable: another app owns it\n");
+        fflush(stdout);
+    }
+    if (!RegisterHotKey(g_hiddenHwnd, kHotkeyReplayRing, MOD_CONTROL | MOD_ALT, 'K') && g_consoleReady) {
+        printf("[rj_span] Ctrl+Alt+K (instant replay) unavailable: another app owns it\n");
+        fflush(stdout);
+    }
+    if (!RegisterHotKey(g_hiddenHwnd, kHotkeyReplaySave, MOD_CONTROL | MOD_ALT, 'W') && g_consoleReady) {
+        printf("[rj_span] Ctrl+Alt+W (save instant replay) unavailable: another app owns it\n");
+        fflush(stdout);
+    }
+    g_trace.NameThread("render");
 
     MSG msg{};
     for (;;) {
@@ -1691,13 +3604,25 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR, int) {
                 UnregisterHotKey(g_hiddenHwnd, kHotkeyEmergencyStop);
                 UnregisterHotKey(g_hiddenHwnd, kHotkeyTestPattern);
                 UnregisterHotKey(g_hiddenHwnd, kHotkeyExit);
+                UnregisterHotKey(g_hiddenHwnd, kHotkeyTraceDump);
+                UnregisterHotKey(g_hiddenHwnd, kHotkeyLateLatch);
+                UnregisterHotKey(g_hiddenHwnd, kHotkeyIddSlices);
+                UnregisterHotKey(g_hiddenHwnd, kHotkeyBlitFastPath);
+                UnregisterHotKey(g_hiddenHwnd, kHotkeyDdZeroCopy);
+                UnregisterHotKey(g_hiddenHwnd, kHotkeyPresentOnChange);
+                UnregisterHotKey(g_hiddenHwnd, kHotkeyRecord);
+                UnregisterHotKey(g_hiddenHwnd, kHotkeyReplayRing);
+                UnregisterHotKey(g_hiddenHwnd, kHotkeyReplaySave);
+                if (g_latchTimer) CloseHandle(g_latchTimer);
                 return static_cast<int>(msg.wParam);
             }
             TranslateMessage(&msg);
             DispatchMessageW(&msg);
         }
 
+        // While running, RenderFrame() blocks on the frame-latency waitable and Present(1);
+        // capture happens on the DD thread, so there is nothing to poll here.
         RenderFrame();
-        Sleep(g_running ? 0 : 10);
+        if (!g_running) Sleep(10);
     }
 }
@@ -0,0 +1,215 @@
+// rj_codec: lossless frame codec on raw frame files. A .bgra file is frames of
+// width * height * 4 bytes back to back; a .rjc file is a codec stream.
+//
+// Usage: rj_codec encode <in.bgra> <out.rjc> --width=<w> --height=<h> [--threads=<n>] [--keyframe-interval=<n>]
+//        rj_codec decode <in.rjc> <out.bgra> [--threads=<n>]
+//        rj_codec info <in.rjc> [--frames]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "core/frame_codec.h"
+
+namespace {
+
+const char* ArgStr(int argc, char** argv, const char* name, const char* fallback) {
+    const size_t n = strlen(name);
+    for (int i = 0; i < argc; i++) {
+        if (strncmp(argv[i], name, n) == 0 && argv[i][n] == '=') return argv[i] + n + 1;
+    }
+    return fallback;
+}
+
+uint32_t ArgU32(int argc, char** argv, const char* name, uint32_t fallback) {
+    const char* v = ArgStr(argc, argv, name, nullptr);
+    return v ? static_cast<uint32_t>(strtoul(v, nullptr, 10)) : fallback;
+}
+
+bool ArgFlag(int argc, char** argv, const char* name) {
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+double NowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void PrintUsage() {
+    printf("usage: rj_codec encode <in.bgra> <out.rjc> --width=<w> --height=<h> [--threads=<n>] [--keyframe-interval=<n>]\n");
+    printf("       rj_codec decode <in.rjc> <out.bgra> [--threads=<n>]\n");
+    printf("       rj_codec info <in.rjc> [--frames]\n");
+}
+
+int Encode(const char* inPath, const char* outPath, int argc, char** argv) {
+    const uint32_t w = ArgU32(argc, argv, "--width", 0);
+    const uint32_t h = ArgU32(argc, argv, "--height", 0);
+    if (w == 0 || h == 0) {
+        printf("[rj_codec] encode needs --width and --height\n");
+        return 1;
+    }
+    rj::CodecConfig cfg;
+    cfg.threads = ArgU32(argc, argv, "--threads", 1);
+    cfg.keyframeInterval = ArgU32(argc, argv, "--keyframe-interval", 0);
+
+    FILE* in = fopen(inPath, "rb");
+    if (!in) {
+        printf("[rj_codec] cannot open %s\n", inPath);
+        return 1;
+    }
+    FILE* out = fopen(outPath, "wb");
+    if (!out) {
+        fclose(in);
+        printf("[rj_codec] cannot write %s\n", outPath);
+        return 1;
+    }
+    rj::FrameEncoder encoder(cfg);
+    std::vector<uint8_t> px(static_cast<size_t>(w) * h * 4u);
+    std::vector<uint8_t> data;
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    double encodeMs = 0.0;
+    bool ok = rj::WriteCodecStreamHeader(out);
+    while (ok && fread(px.data(), px.size(), 1, in) == 1) {
+        const double t0 = NowMs();
+        ok = encoder.Encode(px.data(), w * 4u, w, h, data);
+        encodeMs += NowMs() - t0;
+        ok = ok && rj::WriteCodecFrame(out, data);
+        frames++;
+        bytes += data.size();
+    }
+    fclose(in);
+    if (fclose(out) != 0 || !ok) {
+        printf("[rj_codec] failed writing %s\n", outPath);
+        return 1;
+    }
+    const double rawBytes = static_cast<double>(px.size()) * static_cast<double>(frames);
+    printf("[rj_codec] %llu frames %ux%u -> %s, ratio %.2f, encode %.3f ms/frame\n",
+           static_cast<unsigned long long>(frames),
+           w,
+           h,
+           outPath,
+           bytes ? rawBytes / static_cast<double>(bytes) : 0.0,
+           frames ? encodeMs / static_cast<double>(frames) : 0.0);
+    return 0;
+}
+
+int Decode(const char* inPath, const char* outPath, int argc, char** argv) {
+    rj::CodecConfig cfg;
+    cfg.threads = ArgU32(argc, argv, "--threads", 1);
+    FILE* in = fopen(inPath, "rb");
+    if (!in) {
+        printf("[rj_codec] cannot open %s\n", inPath);
+        return 1;
+    }
+    if (!rj::ReadCodecStreamHeader(in)) {
+        fclose(in);
+        printf("[rj_codec] %s is not a codec stream\n", inPath);
+        return 1;
+    }
+    FILE* out = fopen(outPath, "wb");
+    if (!out) {
+        fclose(in);
+        printf("[rj_codec] cannot write %s\n", outPath);
+        return 1;
+    }
+    rj::FrameDecoder decoder(cfg);
+    std::vector<uint8_t> data;
+    uint64_t frames = 0;
+    double decodeMs = 0.0;
+    bool ok = true;
+    while (ok && rj::ReadCodecFrame(in, data)) {
+        const double t0 = NowMs();
+        ok = decoder.Decode(data.data(), data.size());
+        decodeMs += NowMs() - t0;
+        if (!ok) {
+            printf("[rj_codec] frame %llu is not valid\n", static_cast<unsigned long long>(frames));
+            break;
+        }
+        ok = fwrite(decoder.Frame().data(), decoder.Frame().size(), 1, out) == 1;
+        frames++;
+    }
+    fclose(in);
+    if (fclose(out) != 0 || !ok) {
+        printf("[rj_codec] failed decoding %s\n", inPath);
+        return 1;
+    }
+    printf("[rj_codec] %llu frames %ux%u -> %s, decode %.3f ms/frame\n",
+           static_cast<unsigned long long>(frames),
+           decoder.Width(),
+           decoder.Height(),
+           outPath,
+           frames ? decodeMs / static_cast<double>(frames) : 0.0);
+    return 0;
+}
+
+int Info(const char* inPath, bool perFrame) {
+    FILE* in = fopen(inPath, "rb");
+    if (!in) {
+        printf("[rj_codec] cannot open %s\n", inPath);
+        return 1;
+    }
+    if (!rj::ReadCodecStreamHeader(in)) {
+        fclose(in);
+        printf("[rj_codec] %s is not a codec stream\n", inPath);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    rj::CodecFrameInfo info;
+    uint64_t frames = 0;
+    uint64_t keyframes = 0;
+    uint64_t bytes = 0;
+    uint64_t tiles = 0;
+    uint64_t skipped = 0;
+    uint64_t raw = 0;
+    double rawBytes = 0.0;
+    bool ok = true;
+    while (rj::ReadCodecFrame(in, data)) {
+        if (!rj::ReadCodecFrameInfo(data.data(), data.size(), info)) {
+            ok = false;
+            printf("[rj_codec] frame %llu is not valid\n", static_cast<unsigned long long>(frames));
+            break;
+        }
+        if (perFrame) {
+            printf("%6llu %s %ux%u tiles=%u skipped=%u raw=%u bytes=%zu\n",
+                   static_cast<unsigned long long>(frames),
+                   info.keyframe ? "key  " : "delta",
+                   info.width,
+                   info.height,
+                   info.tiles,
+                   info.skipped,
+                   info.raw,
+                   data.size());
+        }
+        frames++;
+        keyframes += info.keyframe;
+        bytes += data.size();
+        tiles += info.tiles;
+        skipped += info.skipped;
+        raw += info.raw;
+        rawBytes += static_cast<double>(info.width) * info.height * 4.0;
+    }
+    fclose(in);
+    printf("frames=%llu keyframes=%llu bytes=%llu ratio=%.2f skipped=%.1f%% raw=%.1f%% of tiles\n",
+           static_cast<unsigned long long>(frames),
+           static_cast<unsigned long long>(keyframes),
+           static_cast<unsigned long long>(bytes),
+           bytes ? rawBytes / static_cast<double>(bytes) : 0.0,
+           tiles ? 100.0 * static_cast<double>(skipped) / static_cast<double>(tiles) : 0.0,
+           tiles ? 100.0 * static_cast<double>(raw) / static_cast<double>(tiles) : 0.0);
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 4 && strcmp(argv[1], "encode") == 0) return Encode(argv[2], argv[3], argc - 4, argv + 4);
+    if (argc >= 4 && strcmp(argv[1], "decode") == 0) return Decode(argv[2], argv[3], argc - 4, argv + 4);
+    if (argc >= 3 && strcmp(argv[1], "info") == 0) return Info(argv[2], ArgFlag(argc - 3, argv + 3, "--frames"));
+    PrintUsage();
+    return 1;
+}
@@ -0,0 +1,115 @@
+// rj_trace: converts an rj_span trace dump (Ctrl+Alt+D, or rj_bench pipeline --trace) to
+// Chrome trace event JSON for chrome://tracing or https://ui.perfetto.dev.
+//
+// Usage: rj_trace <dump.rjtrace> [--out=<file.json>] [--summary]
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/latency_histogram.h"
+#include "core/trace_ring.h"
+
+namespace {
+
+const char* ArgStr(int argc, char** argv, const char* name, const char* fallback) {
+    const size_t n = strlen(name);
+    for (int i = 0; i < argc; i++) {
+        if (strncmp(argv[i], name, n) == 0 && argv[i][n] == '=') return argv[i] + n + 1;
+    }
+    return fallback;
+}
+
+bool ArgFlag(int argc, char** argv, const char* name) {
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+// Per-event span durations. Begin/End pairs are matched per thread and event, so nested
+// spans of different events (Frame > Present) are fine.
+void PrintSummary(const std::vector<rj::TraceRecord>& records) {
+    constexpr size_t kEvents = static_cast<size_t>(rj::TraceEvent::Count);
+    std::vector<std::vector<int64_t>> open(256 * kEvents);
+    std::vector<std::unique_ptr<rj::LatencyHistogram>> hist(kEvents);
+    std::vector<uint64_t> instants(kEvents, 0);
+    for (const rj::TraceRecord& r : records) {
+        const size_t e = static_cast<size_t>(r.event);
+        std::vector<int64_t>& stack = open[r.thread * kEvents + e];
+        if (r.phase == rj::TracePhase::Begin) {
+            stack.push_back(r.timeNs);
+        } else if (r.phase == rj::TracePhase::End) {
+            if (stack.empty()) continue;
+            if (!hist[e]) hist[e] = std::make_unique<rj::LatencyHistogram>();
+            hist[e]->Record(r.timeNs - stack.back());
+            stack.pop_back();
+        } else {
+            instants[e]++;
+        }
+    }
+
+    const int64_t spanNs = records.size() > 1 ? records.back().timeNs - records.front().timeNs : 0;
+    printf("events=%zu span=%.3f s\n", records.size(), static_cast<double>(spanNs) / 1e9);
+    printf("%-8s %8s %10s %10s %10s %10s %10s  (us)\n", "event", "count", "avg", "p50", "p99", "p99.9", "max");
+    for (size_t e = 0; e < kEvents; e++) {
+        const char* name = rj::TraceEventName(static_cast<rj::TraceEvent>(e));
+        if (hist[e]) {
+            const rj::LatencyPercentiles p = rj::SummarizeLatency(*hist[e]);
+            printf("%-8s %8llu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                   name,
+                   static_cast<unsigned long long>(p.count),
+                   p.avgUs,
+                   p.p50Us,
+                   p.p99Us,
+                   p.p999Us,
+                   p.maxUs);
+        } else if (instants[e]) {
+            printf("%-8s %8llu (instant)\n", name, static_cast<unsigned long long>(instants[e]));
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        printf("usage: rj_trace <dump.rjtrace> [--out=<file.json>] [--summary]\n");
+        return 1;
+    }
+    const char* inPath = argv[1];
+    const char* outArg = ArgStr(argc - 2, argv + 2, "--out", nullptr);
+    const std::string outPath = outArg ? outArg : std::string(inPath) + ".json";
+    const bool summary = ArgFlag(argc - 2, argv + 2, "--summary");
+
+    std::vector<rj::TraceRecord> records;
+    std::vector<std::string> threadNames;
+    FILE* in = fopen(inPath, "rb");
+    if (!in) {
+        printf("[rj_trace] cannot open %s\n", inPath);
+        return 1;
+    }
+    const bool read = rj::ReadTraceDump(in, records, threadNames);
+    fclose(in);
+    if (!read) {
+        printf("[rj_trace] %s is not a valid trace dump\n", inPath);
+        return 1;
+    }
+
+    FILE* out = fopen(outPath.c_str(), "w");
+    if (!out) {
+        printf("[rj_trace] cannot write %s\n", outPath.c_str());
+        return 1;
+    }
+    rj::WriteChromeTraceJson(out, records, threadNames);
+    if (fclose(out) != 0) {
+        printf("[rj_trace] failed writing %s\n", outPath.c_str());
+        return 1;
+    }
+    printf("[rj_trace] %zu events -> %s\n", records.size(), outPath.c_str());
+
+    if (summary) PrintSummary(records);
+    return 0;
+}